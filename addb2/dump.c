@@ -1069,6 +1069,9 @@ struct m0_addb2__id_intrp ids[] = {
 	  .ii_spec   = &fom_state_counter },
 	{ M0_AVI_ALLOC,           "alloc",           { &dec, &ptr },
 	  { "size", "addr" } },
+	{ M0_AVI_SLAB,            "slab",            { &ptr, &dec, &dec, &dec,
+						       &dec },
+	  { "slab", "alloc", "hit", "sys-alloc", "sys-free" } },
 	{ M0_AVI_FOM_DESCR,       "fom-descr",       { FID, &hex0x, &rpcop,
 						       &rpcop, &bol, &dec,
 						       &dec, &dec },
@@ -1123,6 +1126,8 @@ struct m0_addb2__id_intrp ids[] = {
 	  { &dec, &dec, &dec, &dec }, { "id", "opcode", "xid", "session_id" } },
 	{ M0_AVI_RPC_ITEM_ID_FETCH, "rpc-item-id-fetch",
 	  { &dec, &dec, &dec, &dec }, { "id", "opcode", "xid", "session_id" } },
+	{ M0_AVI_RPC_FRM_PACKET,  "rpc-frm-packet",
+	  { &ptr, &dec, &dec, &duration }, { NULL, "items", "size", "delay" } },
 	{ M0_AVI_BE_TX_STATE,     "tx-state",        { &tx_state, SKIP2  } },
 	{ M0_AVI_BE_TX_COUNTER,   "",
 	  .ii_repeat = M0_AVI_BE_TX_COUNTER_END - M0_AVI_BE_TX_COUNTER,
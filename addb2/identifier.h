@@ -103,6 +103,8 @@ enum m0_addb2_value_id {
 	M0_AVI_LIB_RANGE_START     = 0x3000,
 	/** Measurement: memory allocation. */
 	M0_AVI_ALLOC,
+	/** Measurement: object cache statistics, see lib/slab.h. */
+	M0_AVI_SLAB,
 
 	M0_AVI_RM_RANGE_START      = 0x4000,
 	M0_AVI_M0T1FS_RANGE_START  = 0x5000,
@@ -87,6 +87,17 @@ static inline int btree_insert_sync(struct m0_be_btree  *tree,
 	                         bo_u.u_btree.t_rc);
 }
 
+static inline int btree_load_sync(struct m0_be_btree  *tree,
+				  struct m0_be_tx     *tx,
+				  const struct m0_buf *key,
+				  const struct m0_buf *val,
+				  m0_bcount_t          nr)
+{
+	return M0_BE_OP_SYNC_RET(op,
+				 m0_be_btree_load(tree, tx, &op, key, val, nr),
+	                         bo_u.u_btree.t_rc);
+}
+
 static inline int btree_update_sync(struct m0_be_btree  *tree,
 			       struct m0_be_tx     *tx,
 			       const struct m0_buf *key,
@@ -451,6 +462,7 @@ static void balloc_fini_internal(struct m0_balloc *bal)
 
 	m0_be_btree_fini(&bal->cb_db_group_extents);
 	m0_be_btree_fini(&bal->cb_db_group_desc);
+	m0_be_seg_unpin(bal->cb_be_seg, bal, sizeof *bal);
 
 	M0_LEAVE();
 }
@@ -621,31 +633,56 @@ static int balloc_sb_write(struct m0_balloc            *bal,
 	return M0_RC(rc);
 }
 
+enum {
+	/** Number of groups written to a tree in a transaction. */
+	BALLOC_GROUPS_BATCH     = 0x100,
+#ifdef __SPARE_SPACE__
+	/** Free extents of a new group: non-spare and spare. */
+	BALLOC_GROUP_EXTENTS_NR = 2,
+#else
+	BALLOC_GROUP_EXTENTS_NR = 1,
+#endif
+};
+
+/** Trees written by balloc_groups_write(), a tx_bulk partition each. */
+enum balloc_groups_tree {
+	BGT_EXTENTS,
+	BGT_DESC,
+	BGT_NR
+};
+
 struct balloc_group_write_cfg {
-	struct m0_balloc *bgc_bal;
-	m0_bcount_t       bgc_i;
+	struct m0_balloc        *bgc_bal;
+	enum balloc_groups_tree  bgc_tree;
+	/** First group, for BGT_DESC an index in bgs_order[]. */
+	m0_bcount_t              bgc_i;
+	m0_bcount_t              bgc_nr;
 };
 
 struct balloc_groups_write_cfg {
 	struct balloc_group_write_cfg *bgs_bgc;
 	struct m0_balloc              *bgs_bal;
 	m0_bcount_t                    bgs_max;
+	/** Group numbers in the order of group descriptor keys. */
+	m0_bindex_t                   *bgs_order;
 	int                            bgs_rc;
 	struct m0_mutex                bgs_lock;
 };
 
 static void
-balloc_group_write_credit(struct m0_balloc               *bal,
-                          struct m0_be_tx_bulk           *tb,
-                          struct balloc_groups_write_cfg *bgs,
-                          struct m0_be_tx_credit         *credit)
-{
-	m0_be_btree_insert_credit(&bal->cb_db_group_extents, 2,
-		M0_MEMBER_SIZE(struct m0_ext, e_start),
-		M0_MEMBER_SIZE(struct m0_ext, e_end), credit);
-	m0_be_btree_insert_credit(&bal->cb_db_group_desc, 2,
-		M0_MEMBER_SIZE(struct m0_balloc_group_desc, bgd_groupno),
-		sizeof(struct m0_balloc_group_desc), credit);
+balloc_group_write_credit(struct m0_balloc              *bal,
+                          struct balloc_group_write_cfg *bgc,
+                          struct m0_be_tx_credit        *credit)
+{
+	if (bgc->bgc_tree == BGT_EXTENTS)
+		m0_be_btree_load_credit(&bal->cb_db_group_extents,
+			BALLOC_GROUP_EXTENTS_NR * bgc->bgc_nr,
+			M0_MEMBER_SIZE(struct m0_ext, e_start),
+			M0_MEMBER_SIZE(struct m0_ext, e_end), credit);
+	else
+		m0_be_btree_load_credit(&bal->cb_db_group_desc, bgc->bgc_nr,
+			M0_MEMBER_SIZE(struct m0_balloc_group_desc, bgd_groupno),
+			sizeof(struct m0_balloc_group_desc), credit);
 }
 
 static void balloc_group_work_put(struct m0_balloc               *bal,
@@ -654,6 +691,7 @@ static void balloc_group_work_put(struct m0_balloc               *bal,
 {
 	struct balloc_group_write_cfg *bgc;
 	struct m0_be_tx_credit         credit;
+	m0_bcount_t                    first;
 	m0_bcount_t                    i;
 	bool                           put_successful;
 	int                            rc;
@@ -664,21 +702,136 @@ static void balloc_group_work_put(struct m0_balloc               *bal,
 		m0_mutex_unlock(&bgs->bgs_lock);
 		if (rc != 0)
 			break;
+		first = i / BGT_NR * BALLOC_GROUPS_BATCH;
 		bgc  = &bgs->bgs_bgc[i];
 		*bgc = (struct balloc_group_write_cfg){
-			.bgc_bal = bgs->bgs_bal,
-			.bgc_i   = i,
+			.bgc_bal  = bgs->bgs_bal,
+			.bgc_tree = i % BGT_NR,
+			.bgc_i    = first,
+			.bgc_nr   = min_check(bal->cb_sb.bsb_groupcount - first,
+					      (m0_bcount_t)BALLOC_GROUPS_BATCH),
 		};
 		credit = M0_BE_TX_CREDIT(0, 0);
-		balloc_group_write_credit(bal, tb, bgs, &credit);
+		balloc_group_write_credit(bal, bgc, &credit);
 		M0_BE_OP_SYNC(op, put_successful =
-			      m0_be_tx_bulk_put(tb, &op, &credit, 0, 0, bgc));
+			      m0_be_tx_bulk_put(tb, &op, &credit, 0,
+						bgc->bgc_tree, bgc));
 		if (!put_successful)
 			break;
 	}
 	m0_be_tx_bulk_end(tb);
 }
 
+/** Inserts free extents of groups [start, start + nr). */
+static int balloc_group_extents_load(struct m0_balloc *bal,
+				     struct m0_be_tx  *tx,
+				     m0_bcount_t       start,
+				     m0_bcount_t       nr)
+{
+	struct m0_balloc_super_block *sb = &bal->cb_sb;
+	struct m0_ext                *ext;
+	struct m0_buf                *key;
+	struct m0_buf                *val;
+	m0_bcount_t                   rec_nr = BALLOC_GROUP_EXTENTS_NR * nr;
+	m0_bcount_t                   spare_size;
+	m0_bcount_t                   i;
+	m0_bcount_t                   j;
+	int                           rc;
+
+	M0_ALLOC_ARR(ext, rec_nr);
+	M0_ALLOC_ARR(key, rec_nr);
+	M0_ALLOC_ARR(val, rec_nr);
+	if (ext == NULL || key == NULL || val == NULL) {
+		rc = M0_ERR(-ENOMEM);
+		goto out;
+	}
+	spare_size = m0_stob_ad_spares_calc(sb->bsb_groupsize);
+	for (i = start, j = 0; i < start + nr; ++i) {
+		M0_LOG(M0_DEBUG, "creating group_extents for group %llu",
+		       (unsigned long long)i);
+		/* Non-spare extent. */
+		ext[j].e_start = i << sb->bsb_gsbits;
+		ext[j].e_end = ext[j].e_start + sb->bsb_groupsize - spare_size;
+		m0_ext_init(&ext[j]);
+		balloc_debug_dump_extent("create...", &ext[j]);
+		++j;
+#ifdef __SPARE_SPACE__
+		/* Extent reserved for spare. */
+		ext[j].e_start = (i << sb->bsb_gsbits) + sb->bsb_groupsize -
+			spare_size;
+		ext[j].e_end = ext[j].e_start + spare_size;
+		m0_ext_init(&ext[j]);
+		++j;
+#endif
+	}
+	for (j = 0; j < rec_nr; ++j) {
+		key[j] = (struct m0_buf)M0_BUF_INIT_PTR(&ext[j].e_end);
+		val[j] = (struct m0_buf)M0_BUF_INIT_PTR(&ext[j].e_start);
+	}
+	rc = btree_load_sync(&bal->cb_db_group_extents, tx, key, val, rec_nr);
+	if (rc != 0)
+		M0_LOG(M0_ERROR, "insert extents failed: groups=[%llu, %llu) "
+		       "rc=%d", (unsigned long long)start,
+		       (unsigned long long)(start + nr), rc);
+out:
+	m0_free(val);
+	m0_free(key);
+	m0_free(ext);
+	return rc;
+}
+
+/** Inserts descriptors of groups order[0], ..., order[nr - 1]. */
+static int balloc_group_desc_load(struct m0_balloc  *bal,
+				  struct m0_be_tx   *tx,
+				  const m0_bindex_t *order,
+				  m0_bcount_t        nr)
+{
+	struct m0_balloc_super_block *sb = &bal->cb_sb;
+	struct m0_balloc_group_desc  *gd;
+	struct m0_buf                *key;
+	struct m0_buf                *val;
+	m0_bcount_t                   spare_size;
+	m0_bcount_t                   j;
+	int                           rc;
+
+	M0_ALLOC_ARR(gd, nr);
+	M0_ALLOC_ARR(key, nr);
+	M0_ALLOC_ARR(val, nr);
+	if (gd == NULL || key == NULL || val == NULL) {
+		rc = M0_ERR(-ENOMEM);
+		goto out;
+	}
+	spare_size = m0_stob_ad_spares_calc(sb->bsb_groupsize);
+	for (j = 0; j < nr; ++j) {
+		M0_LOG(M0_DEBUG, "creating group_desc for group %llu",
+		       (unsigned long long)order[j]);
+		gd[j].bgd_groupno = order[j];
+#ifdef __SPARE_SPACE__
+		gd[j].bgd_spare_freeblocks = sb->bsb_sparesize;
+		gd[j].bgd_sparestart = (order[j] << sb->bsb_gsbits) +
+			sb->bsb_groupsize - sb->bsb_sparesize;
+		gd[j].bgd_spare_frags = 1;
+		gd[j].bgd_spare_maxchunk = sb->bsb_sparesize;
+#endif
+		gd[j].bgd_freeblocks = sb->bsb_groupsize - spare_size;
+		gd[j].bgd_maxchunk   = sb->bsb_groupsize - spare_size;
+		gd[j].bgd_fragments  = 1;
+		m0_balloc_group_desc_init(&gd[j]);
+		key[j] = (struct m0_buf)M0_BUF_INIT_PTR(&gd[j].bgd_groupno);
+		val[j] = (struct m0_buf)M0_BUF_INIT_PTR(&gd[j]);
+	}
+	rc = btree_load_sync(&bal->cb_db_group_desc, tx, key, val, nr);
+	if (rc != 0)
+		M0_LOG(M0_ERROR, "insert gd failed: group=%llu nr=%llu rc=%d",
+		       (unsigned long long)order[0], (unsigned long long)nr,
+		       rc);
+out:
+	m0_free(val);
+	m0_free(key);
+	m0_free(gd);
+	return rc;
+}
+
 static void balloc_group_write_do(struct m0_be_tx_bulk *tb,
                                   struct m0_be_tx      *tx,
                                   struct m0_be_op      *op,
@@ -689,72 +842,16 @@ static void balloc_group_write_do(struct m0_be_tx_bulk *tb,
 {
 	struct balloc_groups_write_cfg *bgs = datum;
 	struct balloc_group_write_cfg  *bgc = user;
-	struct m0_balloc               *bal = bgc->bgc_bal;
-	struct m0_balloc_group_desc     gd;
-	struct m0_balloc_super_block   *sb = &bal->cb_sb;
-	struct m0_ext                   ext;
-	struct m0_buf                   key;
-	struct m0_buf                   val;
-	m0_bcount_t                     i = bgc->bgc_i;
-	m0_bcount_t                     spare_size;
 	int                             rc;
 
 	m0_be_op_active(op);
-
-	M0_LOG(M0_DEBUG, "creating group_extents for group %llu",
-	       (unsigned long long)i);
-	spare_size = m0_stob_ad_spares_calc(sb->bsb_groupsize);
-	/* Insert non-spare extents. */
-	ext.e_start = i << sb->bsb_gsbits;
-	ext.e_end = ext.e_start + sb->bsb_groupsize - spare_size;
-	m0_ext_init(&ext);
-	balloc_debug_dump_extent("create...", &ext);
-
-	key = (struct m0_buf)M0_BUF_INIT_PTR(&ext.e_end);
-	val = (struct m0_buf)M0_BUF_INIT_PTR(&ext.e_start);
-	rc = btree_insert_sync(&bal->cb_db_group_extents, tx, &key, &val);
-	if (rc != 0) {
-		M0_LOG(M0_ERROR, "insert extent failed: group=%llu "
-				 "rc=%d", (unsigned long long)i, rc);
-		goto out;
-	}
-#ifdef __SPARE_SPACE__
-	/* Insert extents reserved for spare. */
-	ext.e_start = (i << sb->bsb_gsbits) + sb->bsb_groupsize -
-		spare_size;
-	ext.e_end = ext.e_start + spare_size;
-	key = (struct m0_buf)M0_BUF_INIT_PTR(&ext.e_end);
-	val = (struct m0_buf)M0_BUF_INIT_PTR(&ext.e_start);
-	rc = btree_insert_sync(&bal->cb_db_group_extents, tx, &key, &val);
-	if (rc != 0) {
-		M0_LOG(M0_ERROR, "insert extent failed for spares: group=%llu "
-				 "rc=%d", (unsigned long long)i, rc);
-		goto out;
-	}
-#endif
-	M0_LOG(M0_DEBUG, "creating group_desc for group %llu",
-	       (unsigned long long)i);
-	gd.bgd_groupno = i;
-#ifdef __SPARE_SPACE__
-	gd.bgd_spare_freeblocks = sb->bsb_sparesize;
-	gd.bgd_sparestart = (i << sb->bsb_gsbits) + sb->bsb_groupsize -
-				sb->bsb_sparesize;
-	gd.bgd_spare_frags = 1;
-	gd.bgd_spare_maxchunk = sb->bsb_sparesize;
-#endif
-	gd.bgd_freeblocks = sb->bsb_groupsize - spare_size;
-	gd.bgd_maxchunk   = sb->bsb_groupsize - spare_size;
-	gd.bgd_fragments  = 1;
-	m0_balloc_group_desc_init(&gd);
-	key = (struct m0_buf)M0_BUF_INIT_PTR(&gd.bgd_groupno);
-	val = (struct m0_buf)M0_BUF_INIT_PTR(&gd);
-
-	rc = btree_insert_sync(&bal->cb_db_group_desc, tx, &key, &val);
-	if (rc != 0) {
-		M0_LOG(M0_ERROR, "insert gd failed: group=%llu rc=%d",
-			(unsigned long long)i, rc);
-	}
-out:
+	if (bgc->bgc_tree == BGT_EXTENTS)
+		rc = balloc_group_extents_load(bgc->bgc_bal, tx, bgc->bgc_i,
+					       bgc->bgc_nr);
+	else
+		rc = balloc_group_desc_load(bgc->bgc_bal, tx,
+					    &bgs->bgs_order[bgc->bgc_i],
+					    bgc->bgc_nr);
 	if (rc != 0) {
 		m0_mutex_lock(&bgs->bgs_lock);
 		bgs->bgs_rc = rc;
@@ -793,6 +890,7 @@ static int balloc_groups_write(struct m0_balloc *bal)
 	struct m0_balloc_super_block   *sb = &bal->cb_sb;
 	struct m0_be_tx_bulk_cfg        tb_cfg;
 	struct m0_be_tx_bulk            tb = {};
+	m0_bcount_t                     i;
 	int                             rc;
 
 	M0_ENTRY();
@@ -803,22 +901,39 @@ static int balloc_groups_write(struct m0_balloc *bal)
 	}
 	bgs = (struct balloc_groups_write_cfg) {
 		.bgs_bal     = bal,
-		.bgs_max     = sb->bsb_groupcount,
+		.bgs_max     = BGT_NR * ((sb->bsb_groupcount +
+					  BALLOC_GROUPS_BATCH - 1) /
+					 BALLOC_GROUPS_BATCH),
 		.bgs_rc      = 0,
 	};
 	M0_ALLOC_ARR(bgs.bgs_bgc, bgs.bgs_max);
-	if (bgs.bgs_bgc == NULL) {
+	M0_ALLOC_ARR(bgs.bgs_order, sb->bsb_groupcount);
+	if (bgs.bgs_bgc == NULL || bgs.bgs_order == NULL) {
+		m0_free(bgs.bgs_order);
+		m0_free(bgs.bgs_bgc);
 		m0_free0(&bal->cb_group_info);
 		return M0_ERR(-ENOMEM);
 	}
+	/*
+	 * m0_be_btree_load() takes records in key order, and group descriptor
+	 * keys are compared as bytes, not as numbers.
+	 */
+	for (i = 0; i < sb->bsb_groupcount; ++i)
+		bgs.bgs_order[i] = i;
+	qsort(bgs.bgs_order, sb->bsb_groupcount, sizeof bgs.bgs_order[0],
+	      &gd_tree_cmp);
 	m0_mutex_init(&bgs.bgs_lock);
+	/*
+	 * Each tree is a partition with a single worker, which loads it in
+	 * key order, batch after batch; the trees are written in parallel.
+	 */
 	tb_cfg = (struct m0_be_tx_bulk_cfg){
 		.tbc_q_cfg                 = {
 			.bqc_q_size_max       = 0x100,
 			.bqc_producers_nr_max = 1,
 		},
-		.tbc_workers_nr            = 0x40,
-		.tbc_partitions_nr         = 1,
+		.tbc_workers_nr            = BGT_NR,
+		.tbc_partitions_nr         = BGT_NR,
 		.tbc_work_items_per_tx_max = 1,
 		.tbc_dom                   = bal->cb_be_seg->bs_domain,
 		.tbc_datum                 = &bgs,
@@ -836,6 +951,7 @@ static int balloc_groups_write(struct m0_balloc *bal)
 		m0_be_tx_bulk_fini(&tb);
 	}
 	m0_mutex_fini(&bgs.bgs_lock);
+	m0_free(bgs.bgs_order);
 	m0_free(bgs.bgs_bgc);
 	if (bgs.bgs_rc != 0)
 		rc = bgs.bgs_rc;
@@ -961,6 +1077,8 @@ static int balloc_init_internal(struct m0_balloc *bal,
 
 	M0_ENTRY();
 
+	/* Mutex and group info are volatile, keep them resident. */
+	m0_be_seg_pin(seg, bal, sizeof *bal);
 	bal->cb_be_seg = seg;
 	bal->cb_group_info = NULL;
 	m0_mutex_init(&bal->cb_sb_mutex.bm_u.mutex);
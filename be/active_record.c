@@ -100,6 +100,8 @@ m0_be_active_record_domain_init(struct m0_be_active_record_domain *dom,
 {
 	struct m0_be_active_record_domain_subsystem *sub;
 
+	/* ard_seg, rds_lock and rds_chan are volatile, keep them resident. */
+	m0_be_seg_pin(seg, dom, sizeof *dom);
 	dom->ard_seg = seg;
 
 	sub = ard_be_list_head(&dom->ard_list);
@@ -108,6 +110,7 @@ m0_be_active_record_domain_init(struct m0_be_active_record_domain *dom,
 
 	for (;;) {
 		M0_ASSERT(ard_be_list_is_empty(&sub->rds_list));
+		m0_be_seg_pin(seg, sub, sizeof *sub);
 		m0_mutex_init(&sub->rds_lock);
 		m0_chan_init(&sub->rds_chan, &sub->rds_lock);
 
@@ -123,18 +126,15 @@ m0_be_active_record_domain_fini(struct m0_be_active_record_domain *dom)
 	struct m0_be_active_record_domain_subsystem *sub;
 
 	sub = ard_be_list_head(&dom->ard_list);
-	if (sub == NULL)
-		return;
-
-	for (;;) {
+	while (sub != NULL) {
 		M0_ASSERT(rds_be_list_is_empty(&sub->rds_list));
 		m0_chan_fini_lock(&sub->rds_chan);
 		m0_mutex_fini(&sub->rds_lock);
+		m0_be_seg_unpin(dom->ard_seg, sub, sizeof *sub);
 
 		sub = ard_be_list_next(&dom->ard_list, sub);
-		if (sub == NULL)
-			break;
 	}
+	m0_be_seg_unpin(dom->ard_seg, dom, sizeof *dom);
 }
 
 M0_INTERNAL bool
@@ -31,6 +31,8 @@
 #include "lib/memory.h"         /* m0_addr_is_aligned */
 #include "lib/errno.h"          /* ENOSPC */
 #include "lib/misc.h"           /* memset, M0_BITS, m0_forall */
+#include "lib/processor.h"      /* m0_processor_id_get */
+#include "lib/finject.h"        /* M0_FI_ENABLED */
 #include "motr/magic.h"
 #include "be/domain.h"          /* m0_be_domain */
 
@@ -167,10 +169,46 @@
  * - allocator credit includes 2 * size requested for alignment shift greater
  *   than M0_BE_ALLOC_SHIFT_MIN;
  * - it is not truly O(1) allocator; see m0_be_fl documentation for explanation;
- * - there is one big allocator lock that protects all allocations/deallocation.
+ * - there is one big allocator lock that protects all allocations/deallocation
+ *   which are not served by magazines.
  *
  * Locks
- * Allocator lock (m0_mutex) is used to protect all allocator data.
+ * Allocator lock (m0_mutex) is used to protect all allocator data except
+ * magazines. Each magazine has its own lock, which is taken before the
+ * allocator lock when a magazine is refilled or drained.
+ *
+ * Allocation magazines
+ * --------------------
+ *
+ * Small allocations with default alignment in M0_BAP_NORMAL zone are served
+ * from per-locality magazines of pre-carved chunks. Magazine is selected by
+ * processor id, the same way m0_locality_get() selects a locality.
+ *
+ * Each magazine has M0_BE_ALLOC_MAG_CLASS_NR size classes. A size class is
+ * assigned to the (aligned) size of the allocation request which missed the
+ * magazine, if the class is empty. This way magazines adapt to the hottest
+ * allocation sizes (btree nodes, CAS records) without configuration.
+ *
+ * Chunks in a magazine are used chunks from the free lists point of view.
+ * They are linked into m0_be_alloc_mag_class::bmc_chunks through
+ * be_alloc_chunk::bac_linkage_free, which is unused for used chunks. The
+ * lists reside in the magazine table (m0_be_alloc_mag_tab), the first chunk of
+ * the zone, so cached chunks are not lost on restart and the allocator header
+ * is the same with and without magazines. Magazines are disabled for a segment
+ * which has no magazine table.
+ *
+ * - allocation hit takes a chunk from the magazine under the magazine lock
+ *   only;
+ * - allocation miss carves M0_BE_ALLOC_MAG_BATCH chunks under the allocator
+ *   lock in the same transaction, returns the first one to the user and puts
+ *   the rest into the magazine;
+ * - free puts the chunk into the magazine if it has a class of the chunk
+ *   size. If the class is full, M0_BE_ALLOC_MAG_BATCH chunks are returned
+ *   to the free lists under the allocator lock first.
+ *
+ * Call statistics of magazine hits are accumulated in m0_be_alloc_mag and
+ * folded into the zone statistics on refill and drain. Space held by
+ * magazines, hits and misses are volatile, see m0_be_alloc_mag_stats().
  *
  * Space reservation for DIX recovery
  * ----------------------------------
@@ -219,6 +257,12 @@ M0_BE_LIST_DESCR_DEFINE(chunks_all, "list of all chunks in m0_be_allocator",
 			M0_BE_ALLOC_ALL_LINK_MAGIC, M0_BE_ALLOC_ALL_MAGIC);
 M0_BE_LIST_DEFINE(chunks_all, static, struct be_alloc_chunk);
 
+M0_BE_LIST_DESCR_DEFINE(chunks_mag, "magazine of chunks in m0_be_allocator",
+			static, struct be_alloc_chunk, bac_linkage_free,
+			bac_magic_free, M0_BE_ALLOC_MAG_LINK_MAGIC,
+			M0_BE_ALLOC_MAG_MAGIC);
+M0_BE_LIST_DEFINE(chunks_mag, static, struct be_alloc_chunk);
+
 static const char *be_alloc_zone_name(enum m0_be_alloc_zone_type type)
 {
 	static const char *zone_names[] = {
@@ -339,6 +383,44 @@ static void be_allocator_stats_update(struct m0_be_allocator_stats *stats,
 	}
 }
 
+/**
+ * Accounts chunk of given size as moved to (cache == true) or from a magazine
+ * by refill or drain.
+ */
+static void
+be_allocator_stats_cache_update(struct m0_be_allocator_stats *stats,
+				m0_bcount_t                   size,
+				bool                          cache)
+{
+	m0_bcount_t space_change = size + stats->bas_chunk_overhead;
+
+	if (cache) {
+		stats->bas_space_used += space_change;
+		stats->bas_space_free -= space_change;
+	} else {
+		stats->bas_space_used -= space_change;
+		stats->bas_space_free += space_change;
+	}
+}
+
+static void
+be_allocator_call_stat_add(struct m0_be_allocator_call_stat       *dst,
+			   const struct m0_be_allocator_call_stat *src)
+{
+	be_allocator_call_stat_update(dst, src->bcs_nr, src->bcs_size);
+}
+
+static void
+be_allocator_call_stats_add(struct m0_be_allocator_call_stats       *dst,
+			    const struct m0_be_allocator_call_stats *src)
+{
+	be_allocator_call_stat_add(&dst->bacs_alloc_success,
+				   &src->bacs_alloc_success);
+	be_allocator_call_stat_add(&dst->bacs_alloc_failure,
+				   &src->bacs_alloc_failure);
+	be_allocator_call_stat_add(&dst->bacs_free, &src->bacs_free);
+}
+
 static void be_allocator_stats_capture(struct m0_be_allocator *a,
 				       enum m0_be_alloc_zone_type ztype,
 				       struct m0_be_tx *tx)
@@ -716,6 +798,464 @@ static bool be_alloc_chunk_trymerge(struct m0_be_allocator *a,
 	return chunks_were_merged;
 }
 
+/**
+ * Returns chunk to the free lists and merges it with adjacent free chunks.
+ *
+ * Allocator statistics should be updated by the caller.
+ */
+static struct be_alloc_chunk *
+be_alloc_chunk_release(struct m0_be_allocator *a,
+		       enum m0_be_alloc_zone_type ztype,
+		       struct m0_be_tx *tx,
+		       struct be_alloc_chunk *c)
+{
+	struct be_alloc_chunk *prev;
+	struct be_alloc_chunk *next;
+
+	M0_PRE(m0_mutex_is_locked(&a->ba_lock));
+
+	be_alloc_chunk_mark_free(a, ztype, tx, c);
+	prev = be_alloc_chunk_prev(a, ztype, c);
+	next = be_alloc_chunk_next(a, ztype, c);
+	if (be_alloc_chunk_trymerge(a, ztype, tx, prev, c))
+		c = prev;
+	be_alloc_chunk_trymerge(a, ztype, tx, c, next);
+	return c;
+}
+
+static struct m0_be_alloc_mag_class *
+be_alloc_mag_class(struct m0_be_allocator *a, int mag, int cls)
+{
+	M0_PRE(mag < M0_BE_ALLOC_MAG_NR);
+	M0_PRE(cls < M0_BE_ALLOC_MAG_CLASS_NR);
+	M0_PRE(a->ba_mag[mag].bam_hdr != NULL);
+
+	return &a->ba_mag[mag].bam_hdr->bmh_class[cls];
+}
+
+/**
+ * Returns the magazine table if the first chunk of M0_BAP_NORMAL zone is one.
+ */
+static struct m0_be_alloc_mag_tab *be_alloc_mag_tab(struct m0_be_allocator *a)
+{
+	struct m0_be_alloc_mag_tab *tab;
+	struct be_alloc_chunk      *c;
+
+	M0_PRE(m0_mutex_is_locked(&a->ba_lock));
+
+	c = chunks_all_be_list_head(&a->ba_h[M0_BAP_NORMAL]->bah_chunks);
+	if (c == NULL || c->bac_free || c->bac_size < sizeof *tab)
+		return NULL;
+	tab = (struct m0_be_alloc_mag_tab *)&c->bac_mem;
+	return tab->bmt_magic == M0_BE_ALLOC_MAG_TAB_MAGIC ? tab : NULL;
+}
+
+static int be_alloc_mag_index(void)
+{
+	return m0_processor_id_get() % M0_BE_ALLOC_MAG_NR;
+}
+
+/**
+ * Finds the magazine table and counts chunks in the magazine lists after
+ * segment is opened.
+ */
+static void be_alloc_mag_load(struct m0_be_allocator *a, int mag)
+{
+	struct m0_be_alloc_mag     *m = &a->ba_mag[mag];
+	struct m0_be_alloc_mag_tab *tab;
+	struct be_alloc_chunk      *c;
+	int                         i;
+
+	M0_PRE(m0_mutex_is_locked(&m->bam_lock));
+
+	if (m->bam_loaded)
+		return;
+	m0_mutex_lock(&a->ba_lock);
+	tab = be_alloc_mag_tab(a);
+	m0_mutex_unlock(&a->ba_lock);
+	m->bam_hdr = tab == NULL ? NULL : &tab->bmt_mag[mag];
+	m->bam_stats.bms_space_cached = 0;
+	M0_SET_ARR0(m->bam_nr);
+	for (i = 0; m->bam_hdr != NULL && i < M0_BE_ALLOC_MAG_CLASS_NR; ++i) {
+		m0_be_list_for(chunks_mag,
+			       &be_alloc_mag_class(a, mag, i)->bmc_chunks, c) {
+			++m->bam_nr[i];
+			m->bam_stats.bms_space_cached += c->bac_size + sizeof *c;
+		} m0_be_list_endfor;
+		M0_ASSERT(m->bam_nr[i] <= M0_BE_ALLOC_MAG_ROUNDS);
+	}
+	m->bam_loaded = true;
+}
+
+/**
+ * Finds size class for allocation of the given aligned size.
+ *
+ * If there is no such class, then an empty class is returned, unassigned
+ * classes are preferred. Returns M0_BE_ALLOC_MAG_CLASS_NR if all classes are
+ * busy with other sizes.
+ */
+static int be_alloc_mag_class_find(struct m0_be_allocator *a,
+				   int                     mag,
+				   m0_bcount_t             size)
+{
+	struct m0_be_alloc_mag *m = &a->ba_mag[mag];
+	m0_bcount_t             csize;
+	int                     empty = M0_BE_ALLOC_MAG_CLASS_NR;
+	int                     i;
+
+	for (i = 0; i < M0_BE_ALLOC_MAG_CLASS_NR; ++i) {
+		csize = be_alloc_mag_class(a, mag, i)->bmc_size;
+		if (csize == size)
+			return i;
+		if (m->bam_nr[i] == 0 &&
+		    (empty == M0_BE_ALLOC_MAG_CLASS_NR || csize == 0))
+			empty = i;
+	}
+	return empty;
+}
+
+/**
+ * Finds size class the chunk can be cached in.
+ *
+ * be_alloc_chunk_split() may leave up to sizeof(struct be_alloc_chunk) bytes
+ * more than requested in the chunk, such chunks belong to the class too.
+ */
+static int be_alloc_mag_class_of(struct m0_be_allocator      *a,
+				 int                          mag,
+				 const struct be_alloc_chunk *c)
+{
+	m0_bcount_t csize;
+	int         i;
+
+	for (i = 0; i < M0_BE_ALLOC_MAG_CLASS_NR; ++i) {
+		csize = be_alloc_mag_class(a, mag, i)->bmc_size;
+		if (csize != 0 && csize <= c->bac_size &&
+		    c->bac_size - csize <= sizeof *c)
+			break;
+	}
+	return i;
+}
+
+static void be_alloc_mag_call_update(struct m0_be_alloc_mag *m,
+				     m0_bcount_t             size,
+				     bool                    alloc)
+{
+	m0_bcount_t space = size + sizeof(struct be_alloc_chunk);
+
+	/* Boundary is the same as m0_be_allocator_stats::bas_stat0_boundary */
+	be_allocator_call_stats_update(&m->bam_total, size, alloc, false);
+	be_allocator_call_stats_update(size <= M0_BE_ALLOCATOR_STATS_BOUNDARY ?
+				       &m->bam_stat0 : &m->bam_stat1,
+				       size, alloc, false);
+	if (alloc)
+		m->bam_stats.bms_space_cached -= space;
+	else
+		m->bam_stats.bms_space_cached += space;
+}
+
+static void be_alloc_mag_stats_fold(struct m0_be_allocator_stats *stats,
+				    const struct m0_be_alloc_mag *m)
+{
+	be_allocator_call_stats_add(&stats->bas_total, &m->bam_total);
+	be_allocator_call_stats_add(&stats->bas_stat0, &m->bam_stat0);
+	be_allocator_call_stats_add(&stats->bas_stat1, &m->bam_stat1);
+}
+
+/**
+ * Moves accumulated magazine statistics into the zone statistics.
+ * Should be called under the allocator lock.
+ */
+static void be_alloc_mag_stats_flush(struct m0_be_allocator *a,
+				     struct m0_be_alloc_mag *m,
+				     struct m0_be_tx        *tx)
+{
+	M0_PRE(m0_mutex_is_locked(&a->ba_lock));
+
+	be_alloc_mag_stats_fold(&a->ba_h[M0_BAP_NORMAL]->bah_stats, m);
+	be_allocator_call_stats_init(&m->bam_total);
+	be_allocator_call_stats_init(&m->bam_stat0);
+	be_allocator_call_stats_init(&m->bam_stat1);
+	be_allocator_stats_capture(a, M0_BAP_NORMAL, tx);
+}
+
+/**
+ * Carves up to M0_BE_ALLOC_MAG_BATCH chunks of the given size.
+ *
+ * The first chunk is returned to the caller, the rest is put into the
+ * magazine size class.
+ */
+static struct be_alloc_chunk *be_alloc_mag_refill(struct m0_be_allocator *a,
+						  struct m0_be_tx        *tx,
+						  int                     mag,
+						  int                     cls,
+						  m0_bcount_t             size)
+{
+	struct m0_be_allocator_header *h  = a->ba_h[M0_BAP_NORMAL];
+	struct m0_be_alloc_mag        *m  = &a->ba_mag[mag];
+	struct m0_be_alloc_mag_class  *mc = be_alloc_mag_class(a, mag, cls);
+	struct be_alloc_chunk         *result = NULL;
+	struct be_alloc_chunk         *c;
+	int                            i;
+
+	M0_PRE(m0_mutex_is_locked(&m->bam_lock));
+	M0_PRE(m->bam_nr[cls] == 0);
+
+	m0_mutex_lock(&a->ba_lock);
+	M0_PRE_EX(m0_be_allocator__invariant(a));
+
+	if (mc->bmc_size != size) {
+		mc->bmc_size = size;
+		M0_BE_TX_CAPTURE_PTR(a->ba_seg, tx, &mc->bmc_size);
+	}
+	for (i = 0; i < M0_BE_ALLOC_MAG_BATCH; ++i) {
+		c = m0_be_fl_pick(&h->bah_fl, size);
+		if (c == NULL)
+			break;
+		c = be_alloc_chunk_trysplit(a, M0_BAP_NORMAL, tx, c, size,
+					    M0_BE_ALLOC_SHIFT_MIN);
+		M0_ASSERT(c != NULL);
+		if (result == NULL) {
+			result = c;
+			be_allocator_stats_update(&h->bah_stats, c->bac_size,
+						  true, false);
+		} else {
+			chunks_mag_be_tlink_create(c, tx);
+			chunks_mag_be_list_add(&mc->bmc_chunks, tx, c);
+			++m->bam_nr[cls];
+			m->bam_stats.bms_space_cached += c->bac_size + sizeof *c;
+			be_allocator_stats_cache_update(&h->bah_stats,
+							c->bac_size, true);
+		}
+	}
+	be_alloc_mag_stats_flush(a, m, tx);
+	M0_LOG(M0_DEBUG, "allocator=%p mag=%d class=%d size=%"PRIu64" "
+	       "carved=%d", a, mag, cls, size, i);
+
+	M0_POST_EX(m0_be_allocator__invariant(a));
+	m0_mutex_unlock(&a->ba_lock);
+	return result;
+}
+
+/** Returns nr least recently cached chunks of the class to the free lists. */
+static void be_alloc_mag_drain(struct m0_be_allocator *a,
+			       struct m0_be_tx        *tx,
+			       int                     mag,
+			       int                     cls,
+			       uint32_t                nr)
+{
+	struct m0_be_allocator_header *h  = a->ba_h[M0_BAP_NORMAL];
+	struct m0_be_alloc_mag        *m  = &a->ba_mag[mag];
+	struct m0_be_alloc_mag_class  *mc = be_alloc_mag_class(a, mag, cls);
+	struct be_alloc_chunk         *c;
+	uint32_t                       i;
+
+	M0_PRE(m0_mutex_is_locked(&m->bam_lock));
+	M0_PRE(nr <= m->bam_nr[cls]);
+
+	m0_mutex_lock(&a->ba_lock);
+	M0_PRE_EX(m0_be_allocator__invariant(a));
+
+	for (i = 0; i < nr; ++i) {
+		c = chunks_mag_be_list_tail(&mc->bmc_chunks);
+		M0_ASSERT(c != NULL);
+		M0_ASSERT(be_alloc_chunk_invariant(a, c));
+		chunks_mag_be_list_del(&mc->bmc_chunks, tx, c);
+		chunks_mag_be_tlink_destroy(c, tx);
+		--m->bam_nr[cls];
+		m->bam_stats.bms_space_cached -= c->bac_size + sizeof *c;
+		be_allocator_stats_cache_update(&h->bah_stats, c->bac_size,
+						false);
+		be_alloc_chunk_release(a, M0_BAP_NORMAL, tx, c);
+	}
+	be_alloc_mag_stats_flush(a, m, tx);
+
+	M0_POST_EX(m0_be_allocator__invariant(a));
+	m0_mutex_unlock(&a->ba_lock);
+}
+
+/**
+ * Tries to serve allocation from the magazine of the current locality.
+ *
+ * @return NULL if the allocation can't be served from magazines or if there
+ *         is not enough space. In the latter case the regular allocation
+ *         path accounts the failure.
+ */
+static struct be_alloc_chunk *be_alloc_mag_get(struct m0_be_allocator *a,
+					       struct m0_be_tx        *tx,
+					       m0_bcount_t             size,
+					       unsigned                shift,
+					       uint64_t                zonemask)
+{
+	struct m0_be_alloc_mag_class *mc;
+	struct m0_be_alloc_mag       *m;
+	struct be_alloc_chunk        *c = NULL;
+	int                           mag;
+	int                           cls;
+
+	if (shift != M0_BE_ALLOC_SHIFT_MIN ||
+	    zonemask != M0_BITS(M0_BAP_NORMAL) ||
+	    size == 0 || size > M0_BE_ALLOC_MAG_SIZE_MAX)
+		return NULL;
+
+	size = m0_align(size, 1UL << M0_BE_ALLOC_SHIFT_MIN);
+	mag  = be_alloc_mag_index();
+	m    = &a->ba_mag[mag];
+
+	m0_mutex_lock(&m->bam_lock);
+	be_alloc_mag_load(a, mag);
+	cls = m->bam_hdr == NULL ? M0_BE_ALLOC_MAG_CLASS_NR :
+		be_alloc_mag_class_find(a, mag, size);
+	if (cls < M0_BE_ALLOC_MAG_CLASS_NR) {
+		mc = be_alloc_mag_class(a, mag, cls);
+		if (m->bam_nr[cls] > 0) {
+			c = chunks_mag_be_list_head(&mc->bmc_chunks);
+			M0_ASSERT(c != NULL);
+			M0_ASSERT(!c->bac_free && c->bac_size >= size);
+			chunks_mag_be_list_del(&mc->bmc_chunks, tx, c);
+			chunks_mag_be_tlink_destroy(c, tx);
+			--m->bam_nr[cls];
+			++m->bam_stats.bms_hit_nr;
+			be_alloc_mag_call_update(m, c->bac_size, true);
+		} else {
+			++m->bam_stats.bms_miss_nr;
+			c = be_alloc_mag_refill(a, tx, mag, cls, size);
+		}
+	}
+	m0_mutex_unlock(&m->bam_lock);
+	return c;
+}
+
+/**
+ * Tries to put the chunk being freed into the magazine of the current
+ * locality.
+ *
+ * @return false if the chunk should be freed the regular way.
+ */
+static bool be_alloc_mag_put(struct m0_be_allocator *a,
+			     struct m0_be_tx        *tx,
+			     struct be_alloc_chunk  *c)
+{
+	struct m0_be_alloc_mag *m;
+	int                     mag;
+	int                     cls;
+
+	if (c->bac_zone != M0_BAP_NORMAL ||
+	    c->bac_size > M0_BE_ALLOC_MAG_SIZE_MAX + sizeof *c)
+		return false;
+
+	mag = be_alloc_mag_index();
+	m   = &a->ba_mag[mag];
+
+	m0_mutex_lock(&m->bam_lock);
+	be_alloc_mag_load(a, mag);
+	cls = m->bam_hdr == NULL ? M0_BE_ALLOC_MAG_CLASS_NR :
+		be_alloc_mag_class_of(a, mag, c);
+	if (cls < M0_BE_ALLOC_MAG_CLASS_NR) {
+		if (m->bam_nr[cls] == M0_BE_ALLOC_MAG_ROUNDS)
+			be_alloc_mag_drain(a, tx, mag, cls,
+					   M0_BE_ALLOC_MAG_BATCH);
+		chunks_mag_be_tlink_create(c, tx);
+		chunks_mag_be_list_add(&be_alloc_mag_class(a, mag,
+							   cls)->bmc_chunks,
+				       tx, c);
+		++m->bam_nr[cls];
+		be_alloc_mag_call_update(m, c->bac_size, false);
+	}
+	m0_mutex_unlock(&m->bam_lock);
+	return cls < M0_BE_ALLOC_MAG_CLASS_NR;
+}
+
+/**
+ * Allocates the magazine table as the first chunk of M0_BAP_NORMAL zone.
+ * Magazines stay disabled if the zone is too small for the table.
+ */
+static void be_alloc_mag_create(struct m0_be_allocator *a,
+				struct m0_be_tx        *tx)
+{
+	struct m0_be_allocator_header *h = a->ba_h[M0_BAP_NORMAL];
+	struct m0_be_alloc_mag_class  *mc;
+	struct m0_be_alloc_mag_tab    *tab;
+	struct be_alloc_chunk         *c;
+	int                            i;
+	int                            j;
+
+	M0_PRE(m0_mutex_is_locked(&a->ba_lock));
+
+	for (i = 0; i < M0_BE_ALLOC_MAG_NR; ++i)
+		a->ba_mag[i].bam_loaded = false;
+	if (M0_FI_ENABLED("no_tab"))
+		return;
+	c = m0_be_fl_pick(&h->bah_fl, sizeof *tab);
+	if (c == NULL)
+		return;
+	c = be_alloc_chunk_trysplit(a, M0_BAP_NORMAL, tx, c, sizeof *tab,
+				    M0_BE_ALLOC_SHIFT_MIN);
+	M0_ASSERT(c != NULL);
+	M0_ASSERT(c == chunks_all_be_list_head(&h->bah_chunks));
+	be_allocator_stats_update(&h->bah_stats, c->bac_size, true, false);
+	be_allocator_stats_capture(a, M0_BAP_NORMAL, tx);
+
+	tab = (struct m0_be_alloc_mag_tab *)&c->bac_mem;
+	tab->bmt_magic = M0_BE_ALLOC_MAG_TAB_MAGIC;
+	for (i = 0; i < M0_BE_ALLOC_MAG_NR; ++i) {
+		for (j = 0; j < M0_BE_ALLOC_MAG_CLASS_NR; ++j) {
+			mc = &tab->bmt_mag[i].bmh_class[j];
+			mc->bmc_size = 0;
+			chunks_mag_be_list_create(&mc->bmc_chunks, tx);
+		}
+	}
+	M0_BE_TX_CAPTURE_PTR(a->ba_seg, tx, tab);
+}
+
+/** Frees the magazine table. Magazines should be drained. */
+static void be_alloc_mag_destroy(struct m0_be_allocator *a,
+				 struct m0_be_tx        *tx)
+{
+	struct m0_be_allocator_header *h = a->ba_h[M0_BAP_NORMAL];
+	struct m0_be_alloc_mag_tab    *tab;
+	struct be_alloc_chunk         *c;
+	int                            i;
+	int                            j;
+
+	M0_PRE(m0_mutex_is_locked(&a->ba_lock));
+
+	tab = be_alloc_mag_tab(a);
+	if (tab == NULL)
+		return;
+	for (i = 0; i < M0_BE_ALLOC_MAG_NR; ++i) {
+		a->ba_mag[i].bam_loaded = false;
+		for (j = 0; j < M0_BE_ALLOC_MAG_CLASS_NR; ++j)
+			chunks_mag_be_list_destroy(
+				&tab->bmt_mag[i].bmh_class[j].bmc_chunks, tx);
+	}
+	tab->bmt_magic = 0;
+	M0_BE_TX_CAPTURE_PTR(a->ba_seg, tx, &tab->bmt_magic);
+	c = be_alloc_chunk_addr(tab);
+	be_allocator_stats_update(&h->bah_stats, c->bac_size, false, false);
+	be_alloc_chunk_release(a, M0_BAP_NORMAL, tx, c);
+	be_allocator_stats_capture(a, M0_BAP_NORMAL, tx);
+}
+
+/** Returns all cached chunks to the free lists. */
+static void be_alloc_mag_drain_all(struct m0_be_allocator *a,
+				   struct m0_be_tx        *tx)
+{
+	struct m0_be_alloc_mag *m;
+	int                     i;
+	int                     j;
+
+	for (i = 0; i < M0_BE_ALLOC_MAG_NR; ++i) {
+		m = &a->ba_mag[i];
+		m0_mutex_lock(&m->bam_lock);
+		be_alloc_mag_load(a, i);
+		for (j = 0; j < M0_BE_ALLOC_MAG_CLASS_NR; ++j) {
+			if (m->bam_nr[j] > 0)
+				be_alloc_mag_drain(a, tx, i, j, m->bam_nr[j]);
+		}
+		m0_mutex_unlock(&m->bam_lock);
+	}
+}
+
 M0_INTERNAL int m0_be_allocator_init(struct m0_be_allocator *a,
 				     struct m0_be_seg *seg)
 {
@@ -730,6 +1270,9 @@ M0_INTERNAL int m0_be_allocator_init(struct m0_be_allocator *a,
 	/* See comment in m0_be_btree_init(). */
 	M0_SET0(&a->ba_lock);
 	m0_mutex_init(&a->ba_lock);
+	M0_SET_ARR0(a->ba_mag);
+	for (i = 0; i < M0_BE_ALLOC_MAG_NR; ++i)
+		m0_mutex_init(&a->ba_mag[i].bam_lock);
 
 	a->ba_seg = seg;
 	seg_hdr = (struct m0_be_seg_hdr *)seg->bs_addr;
@@ -750,6 +1293,8 @@ M0_INTERNAL void m0_be_allocator_fini(struct m0_be_allocator *a)
 
 	for (i = 0; i < M0_BAP_NR; ++i)
 		be_allocator_stats_print(&a->ba_h[i]->bah_stats);
+	for (i = 0; i < M0_BE_ALLOC_MAG_NR; ++i)
+		m0_mutex_fini(&a->ba_mag[i].bam_lock);
 	m0_mutex_fini(&a->ba_lock);
 
 	M0_LEAVE();
@@ -867,6 +1412,7 @@ M0_INTERNAL int m0_be_allocator_create(struct m0_be_allocator *a,
 		rc = be_allocator_header_create(a, i, tx, 0, 0);
 		M0_ASSERT(rc == 0);
 	}
+	be_alloc_mag_create(a, tx);
 
 	M0_LOG(M0_DEBUG, "free_space=%"PRIu64, free_space);
 	for (i = 0; i < zones_nr; ++i)
@@ -887,9 +1433,12 @@ M0_INTERNAL void m0_be_allocator_destroy(struct m0_be_allocator *a,
 
 	M0_ENTRY("a=%p tx=%p", a, tx);
 
+	be_alloc_mag_drain_all(a, tx);
+
 	m0_mutex_lock(&a->ba_lock);
 	M0_PRE_EX(m0_be_allocator__invariant(a));
 
+	be_alloc_mag_destroy(a, tx);
 	for (z = 0; z < M0_BAP_NR; ++z)
 		be_allocator_header_destroy(a, z, tx);
 
@@ -924,8 +1473,20 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 	struct m0_be_tx_credit         cred_free_flag;
 	struct m0_be_tx_credit         cred_chunk_size;
 	struct m0_be_tx_credit         stats_credit;
+	struct m0_be_tx_credit         cred_release = {};
+	struct m0_be_tx_credit         cred_mag_get = {};
+	struct m0_be_tx_credit         cred_mag_put = {};
+	struct m0_be_tx_credit         cred_mag_refill = {};
+	struct m0_be_tx_credit         cred_mag_drain = {};
+	struct m0_be_tx_credit         cred_mag_class;
+	struct m0_be_tx_credit         cred_mag_tab;
 	struct m0_be_tx_credit         tmp;
+	struct m0_be_tx_credit         tmp_mag;
 	struct be_alloc_chunk          chunk;
+	struct m0_be_alloc_mag_class   mag_class;
+	struct m0_be_alloc_mag_tab    *mag_tab = NULL;
+	const int                      mag_class_nr = M0_BE_ALLOC_MAG_NR *
+						      M0_BE_ALLOC_MAG_CLASS_NR;
 
 	chunk_credit    = M0_BE_TX_CREDIT_TYPE(struct be_alloc_chunk);
 	cred_free_flag  = M0_BE_TX_CREDIT_PTR(&chunk.bac_free);
@@ -974,6 +1535,29 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 	m0_be_tx_credit_add(&cred_mark_free, &cred_free_flag);
 	m0_be_fl_credit(&h->bah_fl, M0_BFL_ADD, &cred_mark_free);
 
+	m0_be_tx_credit_add(&cred_release, &cred_mark_free);
+	m0_be_tx_credit_mac(&cred_release, &chunk_trymerge_credit, 2);
+
+	cred_mag_class = M0_BE_TX_CREDIT_PTR(&mag_class.bmc_size);
+	cred_mag_tab   = M0_BE_TX_CREDIT_PTR(mag_tab);
+	chunks_mag_be_list_credit(M0_BLO_DEL,           1, &cred_mag_get);
+	chunks_mag_be_list_credit(M0_BLO_TLINK_DESTROY, 1, &cred_mag_get);
+	chunks_mag_be_list_credit(M0_BLO_TLINK_CREATE,  1, &cred_mag_put);
+	chunks_mag_be_list_credit(M0_BLO_ADD,           1, &cred_mag_put);
+
+	m0_be_tx_credit_mac(&cred_mag_refill, &cred_split,
+			    M0_BE_ALLOC_MAG_BATCH);
+	m0_be_tx_credit_mac(&cred_mag_refill, &cred_mag_put,
+			    M0_BE_ALLOC_MAG_BATCH - 1);
+	m0_be_tx_credit_add(&cred_mag_refill, &cred_mag_class);
+	m0_be_tx_credit_add(&cred_mag_refill, &stats_credit);
+
+	m0_be_tx_credit_mac(&cred_mag_drain, &cred_mag_get,
+			    M0_BE_ALLOC_MAG_BATCH);
+	m0_be_tx_credit_mac(&cred_mag_drain, &cred_release,
+			    M0_BE_ALLOC_MAG_BATCH);
+	m0_be_tx_credit_add(&cred_mag_drain, &stats_credit);
+
 	switch (optype) {
 		case M0_BAO_CREATE:
 			tmp = M0_BE_TX_CREDIT(0, 0);
@@ -983,6 +1567,14 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 			m0_be_tx_credit_add(&tmp, &cred_allocator);
 			m0_be_tx_credit_add(&tmp, &stats_credit);
 			m0_be_tx_credit_mac(accum, &tmp, M0_BAP_NR);
+			/* magazine table */
+			tmp = M0_BE_TX_CREDIT(0, 0);
+			chunks_mag_be_list_credit(M0_BLO_CREATE, mag_class_nr,
+						  &tmp);
+			m0_be_tx_credit_add(&tmp, &cred_mag_tab);
+			m0_be_tx_credit_add(&tmp, &cred_split);
+			m0_be_tx_credit_add(&tmp, &stats_credit);
+			m0_be_tx_credit_add(accum, &tmp);
 			break;
 		case M0_BAO_DESTROY:
 			tmp = M0_BE_TX_CREDIT(0, 0);
@@ -990,20 +1582,49 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 			m0_be_tx_credit_add(&tmp, &chunk_del_fini_credit);
 			m0_be_tx_credit_mac(&tmp, &cred_list_destroy, 2);
 			m0_be_tx_credit_mac(accum, &tmp, M0_BAP_NR);
+			/* magazine table */
+			tmp = M0_BE_TX_CREDIT(0, 0);
+			chunks_mag_be_list_credit(M0_BLO_DESTROY, mag_class_nr,
+						  &tmp);
+			m0_be_tx_credit_add(&tmp,
+				&M0_BE_TX_CREDIT_PTR(&mag_tab->bmt_magic));
+			m0_be_tx_credit_add(&tmp, &cred_release);
+			m0_be_tx_credit_add(&tmp, &stats_credit);
+			m0_be_tx_credit_add(accum, &tmp);
+			/* all magazines are drained before destruction */
+			tmp = M0_BE_TX_CREDIT(0, 0);
+			m0_be_tx_credit_add(&tmp, &cred_mag_get);
+			m0_be_tx_credit_add(&tmp, &cred_release);
+			m0_be_tx_credit_mac(accum, &tmp,
+					    mag_class_nr * M0_BE_ALLOC_MAG_ROUNDS);
+			m0_be_tx_credit_mac(accum, &stats_credit, mag_class_nr);
 			break;
 		case M0_BAO_ALLOC_ALIGNED:
-			m0_be_tx_credit_add(accum, &cred_split);
+			tmp = M0_BE_TX_CREDIT(0, 0);
+			m0_be_tx_credit_add(&tmp, &cred_split);
+			m0_be_tx_credit_add(&tmp, &stats_credit);
+			if (size <= M0_BE_ALLOC_MAG_SIZE_MAX &&
+			    shift == M0_BE_ALLOC_SHIFT_MIN) {
+				m0_be_tx_credit_max(&tmp_mag, &cred_mag_get,
+						    &cred_mag_refill);
+				m0_be_tx_credit_max(&tmp, &tmp, &tmp_mag);
+			}
+			m0_be_tx_credit_add(accum, &tmp);
 			m0_be_tx_credit_add(accum, &mem_zero_credit);
-			m0_be_tx_credit_add(accum, &stats_credit);
 			break;
 		case M0_BAO_ALLOC:
 			m0_be_allocator_credit(a, M0_BAO_ALLOC_ALIGNED, size,
 					       M0_BE_ALLOC_SHIFT_MIN, accum);
 			break;
 		case M0_BAO_FREE_ALIGNED:
-			m0_be_tx_credit_add(accum, &cred_mark_free);
-			m0_be_tx_credit_mac(accum, &chunk_trymerge_credit, 2);
-			m0_be_tx_credit_add(accum, &stats_credit);
+			tmp = M0_BE_TX_CREDIT(0, 0);
+			m0_be_tx_credit_add(&tmp, &cred_release);
+			m0_be_tx_credit_add(&tmp, &stats_credit);
+			tmp_mag = M0_BE_TX_CREDIT(0, 0);
+			m0_be_tx_credit_add(&tmp_mag, &cred_mag_put);
+			m0_be_tx_credit_add(&tmp_mag, &cred_mag_drain);
+			m0_be_tx_credit_max(&tmp, &tmp, &tmp_mag);
+			m0_be_tx_credit_add(accum, &tmp);
 			break;
 		case M0_BAO_FREE:
 			m0_be_allocator_credit(a, M0_BAO_FREE_ALIGNED, size,
@@ -1036,6 +1657,21 @@ M0_INTERNAL void m0_be_alloc_aligned(struct m0_be_allocator *a,
 
 	m0_be_op_active(op);
 
+	c = be_alloc_mag_get(a, tx, size, shift, zonemask);
+	if (c != NULL) {
+		M0_ASSERT(c->bac_zone == M0_BAP_NORMAL);
+		memset(&c->bac_mem, 0, size);
+		m0_be_tx_capture(tx, &M0_BE_REG(a->ba_seg, size, &c->bac_mem));
+		*ptr = &c->bac_mem;
+		M0_LOG(M0_DEBUG, "allocator=%p size=%"PRIu64" c=%p "
+		       "c->bac_size=%"PRIu64" ptr=%p (magazine)",
+		       a, size, c, c->bac_size, *ptr);
+		M0_POST(c->bac_size >= size);
+		M0_POST(m0_addr_is_aligned(&c->bac_mem, shift));
+		m0_be_op_done(op);
+		return;
+	}
+
 	m0_mutex_lock(&a->ba_lock);
 	M0_PRE_EX(m0_be_allocator__invariant(a));
 
@@ -1105,9 +1741,6 @@ M0_INTERNAL void m0_be_free_aligned(struct m0_be_allocator *a,
 {
 	enum m0_be_alloc_zone_type  ztype;
 	struct be_alloc_chunk      *c;
-	struct be_alloc_chunk      *prev;
-	struct be_alloc_chunk      *next;
-	bool		            chunks_were_merged;
 
 	M0_PRE(ptr != NULL);
 	M0_PRE(m0_reduce(z, M0_BAP_NR, 0,
@@ -1115,27 +1748,27 @@ M0_INTERNAL void m0_be_free_aligned(struct m0_be_allocator *a,
 
 	m0_be_op_active(op);
 
+	c = be_alloc_chunk_addr(ptr);
+	M0_PRE(c->bac_magic0 == M0_BE_ALLOC_MAGIC0 &&
+	       c->bac_magic1 == M0_BE_ALLOC_MAGIC1);
+	M0_PRE(!c->bac_free);
+	M0_LOG(M0_DEBUG, "allocator=%p c=%p c->bac_size=%"PRIu64" zone=%d "
+			"data=%p", a, c, c->bac_size, c->bac_zone, &c->bac_mem);
+	if (be_alloc_mag_put(a, tx, c)) {
+		m0_be_op_done(op);
+		return;
+	}
+
 	m0_mutex_lock(&a->ba_lock);
 	M0_PRE_EX(m0_be_allocator__invariant(a));
 
-	c = be_alloc_chunk_addr(ptr);
 	M0_PRE(be_alloc_chunk_invariant(a, c));
-	M0_PRE(!c->bac_free);
 	ztype = c->bac_zone;
-	M0_LOG(M0_DEBUG, "allocator=%p c=%p c->bac_size=%"PRIu64" zone=%d "
-			"data=%p", a, c, c->bac_size, c->bac_zone, &c->bac_mem);
 	/* algorithm starts here */
-	be_alloc_chunk_mark_free(a, ztype, tx, c);
 	/* update stats before c->bac_size gets modified due to merge */
 	be_allocator_stats_update(&a->ba_h[ztype]->bah_stats,
 			c->bac_size, false, false);
-	prev = be_alloc_chunk_prev(a, ztype, c);
-	next = be_alloc_chunk_next(a, ztype, c);
-	chunks_were_merged = be_alloc_chunk_trymerge(a, ztype, tx,
-			prev, c);
-	if (chunks_were_merged)
-		c = prev;
-	be_alloc_chunk_trymerge(a, ztype, tx, c, next);
+	c = be_alloc_chunk_release(a, ztype, tx, c);
 	be_allocator_stats_capture(a, ztype, tx);
 	/* and ends here */
 	M0_POST(c->bac_free);
@@ -1159,10 +1792,35 @@ M0_INTERNAL void m0_be_free(struct m0_be_allocator *a,
 M0_INTERNAL void m0_be_alloc_stats(struct m0_be_allocator *a,
 				   struct m0_be_allocator_stats *out)
 {
+	int i;
+
+	for (i = 0; i < M0_BE_ALLOC_MAG_NR; ++i)
+		m0_mutex_lock(&a->ba_mag[i].bam_lock);
 	m0_mutex_lock(&a->ba_lock);
 	M0_PRE_EX(m0_be_allocator__invariant(a));
 	*out = a->ba_h[M0_BAP_NORMAL]->bah_stats;
+	for (i = 0; i < M0_BE_ALLOC_MAG_NR; ++i)
+		be_alloc_mag_stats_fold(out, &a->ba_mag[i]);
 	m0_mutex_unlock(&a->ba_lock);
+	for (i = M0_BE_ALLOC_MAG_NR - 1; i >= 0; --i)
+		m0_mutex_unlock(&a->ba_mag[i].bam_lock);
+}
+
+M0_INTERNAL void m0_be_alloc_mag_stats(struct m0_be_allocator *a,
+				       struct m0_be_alloc_mag_stats *out)
+{
+	struct m0_be_alloc_mag *m;
+	int                     i;
+
+	M0_SET0(out);
+	for (i = 0; i < M0_BE_ALLOC_MAG_NR; ++i) {
+		m = &a->ba_mag[i];
+		m0_mutex_lock(&m->bam_lock);
+		out->bms_space_cached += m->bam_stats.bms_space_cached;
+		out->bms_hit_nr       += m->bam_stats.bms_hit_nr;
+		out->bms_miss_nr      += m->bam_stats.bms_miss_nr;
+		m0_mutex_unlock(&m->bam_lock);
+	}
 }
 
 M0_INTERNAL void m0_be_alloc_stats_credit(struct m0_be_allocator *a,
@@ -47,6 +47,21 @@ enum {
 	M0_BE_ALLOC_SHIFT_MIN  = 3,
 };
 
+enum {
+	/** Number of per-locality allocation magazines. */
+	M0_BE_ALLOC_MAG_NR       = 16,
+	/** Number of size classes cached by each magazine. */
+	M0_BE_ALLOC_MAG_CLASS_NR = 4,
+	/** Maximum number of chunks cached in one size class of a magazine. */
+	M0_BE_ALLOC_MAG_ROUNDS   = 8,
+	/** Number of chunks carved or released by one refill or drain. */
+	M0_BE_ALLOC_MAG_BATCH    = 4,
+	/** Allocations larger than this are never served from magazines. */
+	M0_BE_ALLOC_MAG_SIZE_MAX = 0x2000,
+};
+
+M0_BASSERT(M0_BE_ALLOC_MAG_BATCH <= M0_BE_ALLOC_MAG_ROUNDS);
+
 struct m0_be_allocator_call_stat {
 	unsigned long bcs_nr;
 	m0_bcount_t   bcs_size;
@@ -126,7 +141,47 @@ struct m0_be_allocator_stats {
 	unsigned long                     bas_print_index;
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 
+/** Statistics of allocation magazines, see m0_be_alloc_mag_stats(). */
+struct m0_be_alloc_mag_stats {
+	/**
+	 * Space (including chunk overhead) held in allocation magazines.
+	 * It is accounted in m0_be_allocator_stats::bas_space_used.
+	 */
+	m0_bcount_t bms_space_cached;
+	/** Number of allocations served from magazines. */
+	uint64_t    bms_hit_nr;
+	/** Number of magazine refills. */
+	uint64_t    bms_miss_nr;
+};
+
 struct m0_be_allocator_header;
+struct m0_be_alloc_mag_hdr;
+
+/**
+ * @brief Per-locality allocation magazine.
+ *
+ * Volatile part of a magazine. Cached chunks themselves are kept in
+ * m0_be_alloc_mag_class lists of the magazine table inside the segment (see
+ * m0_be_alloc_mag_tab), so they survive restarts and are never leaked.
+ *
+ * Statistics of the calls served by the magazine are accumulated here and
+ * folded into m0_be_allocator_header::bah_stats on the next refill or drain.
+ * Magazine statistics are volatile.
+ */
+struct m0_be_alloc_mag {
+	/** Protects magazine and its m0_be_alloc_mag_class lists. */
+	struct m0_mutex                   bam_lock;
+	/** bam_hdr and bam_nr[] have been initialised from the segment. */
+	bool                              bam_loaded;
+	/** Persistent part, NULL if the segment has no magazine table. */
+	struct m0_be_alloc_mag_hdr       *bam_hdr;
+	/** Number of chunks in each size class. */
+	uint32_t                          bam_nr[M0_BE_ALLOC_MAG_CLASS_NR];
+	struct m0_be_allocator_call_stats bam_total;
+	struct m0_be_allocator_call_stats bam_stat0;
+	struct m0_be_allocator_call_stats bam_stat1;
+	struct m0_be_alloc_mag_stats      bam_stats;
+};
 
 /** @brief Allocator */
 struct m0_be_allocator {
@@ -143,6 +198,11 @@ struct m0_be_allocator {
 	struct m0_mutex		       ba_lock;
 	/** Internal allocator data. It is stored inside the segment. */
 	struct m0_be_allocator_header *ba_h[M0_BAP_NR];
+	/**
+	 * Allocation magazines for M0_BAP_NORMAL zone.
+	 * Lock ordering: m0_be_alloc_mag::bam_lock, then ba_lock.
+	 */
+	struct m0_be_alloc_mag         ba_mag[M0_BE_ALLOC_MAG_NR];
 };
 
 /**
@@ -307,6 +367,10 @@ M0_INTERNAL void m0_be_free(struct m0_be_allocator *a,
 M0_INTERNAL void m0_be_alloc_stats(struct m0_be_allocator *a,
 				   struct m0_be_allocator_stats *out);
 
+/** Sums statistics of allocation magazines. */
+M0_INTERNAL void m0_be_alloc_mag_stats(struct m0_be_allocator *a,
+				       struct m0_be_alloc_mag_stats *out);
+
 M0_INTERNAL void m0_be_alloc_stats_credit(struct m0_be_allocator *a,
                                           struct m0_be_tx_credit *accum);
 M0_INTERNAL void m0_be_alloc_stats_capture(struct m0_be_allocator *a,
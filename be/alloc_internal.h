@@ -94,6 +94,40 @@ struct m0_be_alloc_zone {
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 
 
+/**
+ * @brief Size class of an allocation magazine.
+ *
+ * Contains used (from the free lists point of view) chunks of size at least
+ * bmc_size. Chunks are linked through be_alloc_chunk::bac_linkage_free.
+ *
+ * @see m0_be_alloc_mag.
+ */
+struct m0_be_alloc_mag_class {
+	/** Size of allocations served from this class, 0 if unassigned. */
+	m0_bcount_t       bmc_size;
+	struct m0_be_list bmc_chunks;
+};
+
+/** @brief Persistent part of an allocation magazine. */
+struct m0_be_alloc_mag_hdr {
+	struct m0_be_alloc_mag_class bmh_class[M0_BE_ALLOC_MAG_CLASS_NR];
+};
+
+/**
+ * @brief Table of allocation magazines.
+ *
+ * The table is the first chunk of M0_BAP_NORMAL zone. It is allocated by
+ * m0_be_allocator_create() and is looked up by bmt_magic when a magazine is
+ * used for the first time. The table is not a part of m0_be_allocator_header,
+ * so the segment header layout does not depend on magazines, and a segment
+ * created without the table is served without magazines.
+ */
+struct m0_be_alloc_mag_tab {
+	/** M0_BE_ALLOC_MAG_TAB_MAGIC */
+	uint64_t                   bmt_magic;
+	struct m0_be_alloc_mag_hdr bmt_mag[M0_BE_ALLOC_MAG_NR];
+};
+
 /**
  * @brief Allocator header.
  *
@@ -608,6 +608,155 @@ static void be_btree_insert_newkey(struct m0_be_btree      *btree,
 	M0_POST_EX(btree_node_subtree_invariant(btree, btree->bb_root));
 }
 
+/* ------------------------------------------------------------------
+ * Bulk load
+ * ------------------------------------------------------------------ */
+
+/**
+ * Right edge of the tree being loaded.
+ *
+ * Records with increasing keys are appended to the rightmost leaf. When a node
+ * on the edge becomes full, it is left as is and a new empty node starts at
+ * its level; the record which did not fit goes to the parent as a separator.
+ * This fills nodes completely, unlike be_btree_split_child(), which leaves
+ * both halves half-empty when keys arrive in order.
+ */
+struct btree_load {
+	struct m0_be_btree *bl_tree;
+	struct m0_be_tx    *bl_tx;
+	/** The rightmost node on every level, bl_edge[0] is a leaf. */
+	struct m0_be_bnode *bl_edge[BTREE_HEIGHT_MAX + 1];
+	/** Level of the root. */
+	unsigned int        bl_top;
+};
+
+static void btree_load_node_update(struct btree_load  *bl,
+				   struct m0_be_bnode *node)
+{
+	m0_format_footer_update(node);
+	btree_node_update(node, bl->bl_tree, bl->bl_tx);
+}
+
+static void btree_load_init(struct btree_load  *bl,
+			    struct m0_be_btree *tree,
+			    struct m0_be_tx    *tx)
+{
+	struct m0_be_bnode *node = tree->bb_root;
+	int                 level;
+
+	bl->bl_tree = tree;
+	bl->bl_tx   = tx;
+	bl->bl_top  = node->bt_level;
+	for (level = bl->bl_top; level >= 0; --level) {
+		M0_ASSERT(node->bt_level == level);
+		bl->bl_edge[level] = node;
+		if (!node->bt_isleaf)
+			node = node->bt_child_arr[node->bt_num_active_key];
+	}
+	M0_ASSERT(bl->bl_edge[0]->bt_isleaf);
+}
+
+/**
+ * Appends @kv to the rightmost node at the @level. For a non-leaf level,
+ * @child becomes the rightmost child of the node.
+ */
+static void btree_load_append(struct btree_load       *bl,
+			      unsigned int             level,
+			      struct be_btree_key_val *kv,
+			      struct m0_be_bnode      *child)
+{
+	struct m0_be_bnode *node = bl->bl_edge[level];
+	struct m0_be_bnode *root;
+	struct m0_be_bnode *next;
+
+	M0_PRE((level == 0) == (child == NULL));
+
+	if (node->bt_num_active_key < KV_NR) {
+		node->bt_kv_arr[node->bt_num_active_key] = *kv;
+		if (child != NULL)
+			node->bt_child_arr[node->bt_num_active_key + 1] = child;
+		node->bt_num_active_key++;
+		return;
+	}
+	if (level == bl->bl_top) {
+		M0_ASSERT(level < BTREE_HEIGHT_MAX);
+		root = be_btree_node_alloc(bl->bl_tree, bl->bl_tx);
+		be_btree_set_node_params(root, 0, level + 1, false);
+		root->bt_child_arr[0] = node;
+		btree_root_set(bl->bl_tree, root);
+		bl->bl_edge[++bl->bl_top] = root;
+	}
+	next = be_btree_node_alloc(bl->bl_tree, bl->bl_tx);
+	be_btree_set_node_params(next, 0, level, child == NULL);
+	next->bt_child_arr[0] = child;
+	btree_load_node_update(bl, node);
+	bl->bl_edge[level] = next;
+	btree_load_append(bl, level + 1, kv, next);
+}
+
+/**
+ * Moves @nr keys (and children) to the rightmost node at the @level from its
+ * left sibling, through the separator in the parent.
+ */
+static void btree_load_rotate(struct btree_load *bl,
+			      unsigned int       level,
+			      unsigned int       nr)
+{
+	struct m0_be_bnode *node   = bl->bl_edge[level];
+	struct m0_be_bnode *parent = bl->bl_edge[level + 1];
+	unsigned int        p      = parent->bt_num_active_key;
+	struct m0_be_bnode *left;
+	unsigned int        ln;
+	int                 i;
+
+	M0_PRE(p > 0 && parent->bt_child_arr[p] == node);
+	left = parent->bt_child_arr[p - 1];
+	ln   = left->bt_num_active_key;
+	M0_PRE(ln >= nr + BTREE_FAN_OUT - 1);
+
+	for (i = (int)node->bt_num_active_key - 1; i >= 0; --i)
+		node->bt_kv_arr[i + nr] = node->bt_kv_arr[i];
+	node->bt_kv_arr[nr - 1] = parent->bt_kv_arr[p - 1];
+	for (i = 0; i < nr - 1; ++i)
+		node->bt_kv_arr[i] = left->bt_kv_arr[ln - nr + 1 + i];
+	if (!node->bt_isleaf) {
+		for (i = node->bt_num_active_key; i >= 0; --i)
+			node->bt_child_arr[i + nr] = node->bt_child_arr[i];
+		for (i = 0; i < nr; ++i)
+			node->bt_child_arr[i] =
+				left->bt_child_arr[ln - nr + 1 + i];
+	}
+	parent->bt_kv_arr[p - 1] = left->bt_kv_arr[ln - nr];
+	node->bt_num_active_key += nr;
+	left->bt_num_active_key = ln - nr;
+	btree_load_node_update(bl, left);
+}
+
+/**
+ * Brings nodes on the right edge to the minimal occupancy, top-down, so that
+ * a parent has keys to rotate through by the time its child is fixed, and
+ * captures the edge.
+ *
+ * The left sibling of a new edge node is always full: a node is left behind
+ * only when it cannot take another key.
+ */
+static void btree_load_fini(struct btree_load *bl)
+{
+	struct m0_be_bnode *node;
+	int                 level;
+
+	for (level = bl->bl_top - 1; level >= 0; --level) {
+		node = bl->bl_edge[level];
+		if (node->bt_num_active_key < BTREE_FAN_OUT - 1)
+			btree_load_rotate(bl, level, BTREE_FAN_OUT - 1 -
+					  node->bt_num_active_key);
+	}
+	for (level = 0; level <= bl->bl_top; ++level)
+		btree_load_node_update(bl, bl->bl_edge[level]);
+	mem_update(bl->bl_tree, bl->bl_tx, bl->bl_tree,
+		   sizeof(struct m0_be_btree));
+}
+
 /**
 *   Get maxinimum key position in btree.
 *
@@ -1492,6 +1641,8 @@ M0_INTERNAL void m0_be_btree_init(struct m0_be_btree *tree,
 	M0_ENTRY("tree=%p seg=%p", tree, seg);
 	M0_PRE(ops != NULL);
 
+	/* bb_lock and bb_seg are volatile, keep them resident. */
+	m0_be_seg_pin(seg, tree, sizeof *tree);
 	m0_rwlock_init(btree_rwlock(tree));
 	tree->bb_ops = ops;
 	tree->bb_seg = seg;
@@ -1507,6 +1658,8 @@ M0_INTERNAL void m0_be_btree_fini(struct m0_be_btree *tree)
 	M0_PRE(ergo(tree->bb_root != NULL && tree->bb_header.hd_magic != 0,
 		    btree_invariant(tree)));
 	m0_rwlock_fini(btree_rwlock(tree));
+	if (tree->bb_seg != NULL)
+		m0_be_seg_unpin(tree->bb_seg, tree, sizeof *tree);
 	M0_LEAVE();
 }
 
@@ -1738,6 +1891,34 @@ M0_INTERNAL void m0_be_btree_insert_credit2(const struct m0_be_btree *tree,
 	M0_BE_CREDIT_INC(nr, M0_BE_CU_BTREE_INSERT, accum);
 }
 
+M0_INTERNAL void m0_be_btree_load_credit(const struct m0_be_btree *tree,
+					 m0_bcount_t               nr,
+					 m0_bcount_t               ksize,
+					 m0_bcount_t               vsize,
+					 struct m0_be_tx_credit   *accum)
+{
+	struct m0_be_tx_credit cred = {};
+	m0_bcount_t            nodes_nr;
+
+	/*
+	 * All but the edge nodes are full, and every level has at most 1/2 of
+	 * the nodes of the level below. Edge nodes and their left siblings are
+	 * updated once more in btree_load_fini().
+	 */
+	nodes_nr = 2 * (nr / KV_NR + 1) + BTREE_HEIGHT_MAX + 1;
+	btree_node_alloc_credit(tree, &cred);
+	btree_node_update_credit(&cred, 1);
+	m0_be_tx_credit_mul(&cred, nodes_nr);
+	btree_node_update_credit(&cred, BTREE_HEIGHT_MAX + 1);
+	m0_be_tx_credit_add(&cred,
+			    &M0_BE_TX_CREDIT(1, sizeof(struct m0_be_btree)));
+	m0_be_tx_credit_add(accum, &cred);
+
+	cred = M0_BE_TX_CREDIT(0, 0);
+	kv_insert_credit(tree, ksize, vsize, &cred);
+	m0_be_tx_credit_mac(accum, &cred, nr);
+}
+
 M0_INTERNAL void m0_be_btree_delete_credit(const struct m0_be_btree     *tree,
 						 m0_bcount_t             nr,
 						 m0_bcount_t             ksize,
@@ -1939,6 +2120,58 @@ M0_INTERNAL void m0_be_btree_insert(struct m0_be_btree *tree,
 	be_btree_insert(tree, tx, op, key, val, NULL, M0_BITS(M0_BAP_NORMAL));
 }
 
+M0_INTERNAL void m0_be_btree_load(struct m0_be_btree  *tree,
+				  struct m0_be_tx     *tx,
+				  struct m0_be_op     *op,
+				  const struct m0_buf *key,
+				  const struct m0_buf *val,
+				  m0_bcount_t          nr)
+{
+	struct btree_load        bl;
+	struct be_btree_key_val  kv;
+	void                    *max;
+	m0_bcount_t              ksz;
+	m0_bcount_t              i;
+
+	M0_ENTRY("tree=%p nr=%"PRIu64, tree, nr);
+	M0_PRE(tree->bb_root != NULL && tree->bb_ops != NULL);
+	M0_PRE(m0_forall(j, nr,
+			 key[j].b_nob == be_btree_ksize(tree, key[j].b_addr) &&
+			 val[j].b_nob == be_btree_vsize(tree, val[j].b_addr)));
+
+	btree_op_fill(op, tree, tx, M0_BBO_INSERT, NULL);
+	m0_be_op_active(op);
+	m0_rwlock_write_lock(btree_rwlock(tree));
+	max = be_btree_get_max_key(tree);
+	if (nr > 0 && ((max != NULL && !key_gt(tree, key[0].b_addr, max)) ||
+		       !m0_forall(j, nr - 1, key_gt(tree, key[j + 1].b_addr,
+						    key[j].b_addr)))) {
+		op_tree(op)->t_rc = M0_ERR(-EINVAL);
+		goto out;
+	}
+	btree_load_init(&bl, tree, tx);
+	for (i = 0; i < nr; ++i) {
+		ksz = m0_align(key[i].b_nob, sizeof(void*));
+		kv.btree_key = mem_alloc(tree, tx, ksz + val[i].b_nob,
+					 M0_BITS(M0_BAP_NORMAL));
+		kv.btree_val = kv.btree_key + ksz;
+		memcpy(kv.btree_key, key[i].b_addr, key[i].b_nob);
+		memset(kv.btree_key + key[i].b_nob, 0, ksz - key[i].b_nob);
+		memcpy(kv.btree_val, val[i].b_addr, val[i].b_nob);
+		mem_update(tree, tx, kv.btree_key, ksz + val[i].b_nob);
+		btree_load_append(&bl, 0, &kv, NULL);
+	}
+	btree_load_fini(&bl);
+
+	M0_POST(btree_invariant(tree));
+	M0_POST(btree_node_invariant(tree, tree->bb_root, true));
+	M0_POST_EX(btree_node_subtree_invariant(tree, tree->bb_root));
+out:
+	m0_rwlock_write_unlock(btree_rwlock(tree));
+	m0_be_op_done(op);
+	M0_LEAVE("tree=%p rc=%d", tree, op_tree(op)->t_rc);
+}
+
 M0_INTERNAL void m0_be_btree_update(struct m0_be_btree *tree,
 				    struct m0_be_tx *tx,
 				    struct m0_be_op *op,
@@ -289,6 +289,23 @@ M0_INTERNAL void m0_be_btree_insert_credit2(const struct m0_be_btree *tree,
 					    m0_bcount_t vsize,
 					    struct m0_be_tx_credit *accum);
 
+/**
+ * Calculates credits for m0_be_btree_load() of @nr records.
+ *
+ * Unlike nr times m0_be_btree_insert_credit(), node credits grow with the
+ * number of nodes the records fill rather than with the tree height per
+ * record.
+ *
+ * @param nr     Number of records.
+ * @param ksize  Key data size.
+ * @param vsize  Value data size.
+ */
+M0_INTERNAL void m0_be_btree_load_credit(const struct m0_be_btree *tree,
+					 m0_bcount_t               nr,
+					 m0_bcount_t               ksize,
+					 m0_bcount_t               vsize,
+					 struct m0_be_tx_credit   *accum);
+
 /**
  * Calculates how many internal resources of tx_engine, described by
  * m0_be_tx_credit, is needed to perform the delete operation over the @tree.
@@ -378,6 +395,27 @@ M0_INTERNAL void m0_be_btree_save(struct m0_be_btree  *tree,
 				  const struct m0_buf *val,
 				  bool                 overwrite);
 
+/**
+ * Bulk-loads @nr records into btree. Operation is asynchronous.
+ *
+ * Keys in @key[] must be in ascending order and greater than the maximal key
+ * of the tree; otherwise -EINVAL is set to @op->bo_u.u_btree.t_rc and the
+ * tree is not changed. Records are appended along the right edge of the tree,
+ * so that nodes are filled completely and every node is captured about once,
+ * instead of a search and a possible split per record. The tree satisfies
+ * btree invariants after every call, so a large tree is built by a sequence
+ * of calls in separate transactions, e.g. from be/tx_bulk.
+ *
+ * Credits for this operation should be calculated by
+ * m0_be_btree_load_credit().
+ */
+M0_INTERNAL void m0_be_btree_load(struct m0_be_btree  *tree,
+				  struct m0_be_tx     *tx,
+				  struct m0_be_op     *op,
+				  const struct m0_buf *key,
+				  const struct m0_buf *val,
+				  m0_bcount_t          nr);
+
 /**
  * Updates the @value at the @key in btree. Operation is asynchronous.
  *
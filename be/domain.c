@@ -237,8 +237,15 @@ static int be_domain_seg_open(struct m0_be_domain *dom,
 	if (rc == 0) {
 		m0_be_seg_init(seg, stob, dom, M0_BE_SEG_FAKE_ID);
 		m0_stob_put(stob);
+		seg->bs_pg_budget = dom->bd_cfg.bc_pg_budget;
+		seg->bs_pg_shift  = dom->bd_cfg.bc_pg_shift;
+		seg->bs_huge      = dom->bd_cfg.bc_seg_huge;
 		rc = m0_be_seg_open(seg);
 		if (rc == 0) {
+			if (dom->bd_cfg.bc_seg_warmup_size > 0)
+				m0_be_seg_warmup(seg,
+					dom->bd_cfg.bc_seg_warmup_size,
+					dom->bd_cfg.bc_seg_warmup_thread_nr);
 			(void)m0_be_allocator_init(m0_be_seg_allocator(seg),
 						   seg);
 			m0_be_seg_dict_init(seg);
@@ -458,6 +465,40 @@ M0_INTERNAL struct m0_be_tx *m0_be_domain_tx_find(struct m0_be_domain *dom,
 	return m0_be_engine__tx_find(m0_be_domain_engine(dom), id);
 }
 
+M0_INTERNAL void m0_be_domain__pg_scan(struct m0_be_domain *dom)
+{
+	struct m0_be_seg *seg;
+	uint64_t          clean;
+	bool              evict = false;
+	bool              stall = false;
+
+	if (dom->bd_cfg.bc_pg_budget == 0)
+		return;
+	clean = m0_be_engine__pg_clean(&dom->bd_engine);
+	be_domain_lock(dom);
+	m0_tl_for(seg, &dom->bd_segs, seg) {
+		if (m0_be_seg__pg_scan(seg, clean)) {
+			evict = true;
+			stall |= m0_be_seg__pg_over(seg);
+		}
+	} m0_tl_endfor;
+	be_domain_unlock(dom);
+	if (evict)
+		m0_be_engine__pg_evict(&dom->bd_engine, stall);
+}
+
+M0_INTERNAL void m0_be_domain__pg_evict(struct m0_be_domain *dom,
+					uint64_t clean)
+{
+	struct m0_be_seg *seg;
+
+	be_domain_lock(dom);
+	m0_tl_for(seg, &dom->bd_segs, seg) {
+		m0_be_seg__pg_evict(seg, clean);
+	} m0_tl_endfor;
+	be_domain_unlock(dom);
+}
+
 M0_INTERNAL struct m0_be_engine *m0_be_domain_engine(struct m0_be_domain *dom)
 {
 	return &dom->bd_engine;
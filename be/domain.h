@@ -101,6 +101,30 @@ struct m0_be_domain_cfg {
 	 * The sum of all array elements should be 100.
 	 */
 	uint32_t                     bc_zone_pcnt[M0_BAP_NR];
+	/**
+	 * Resident memory budget of every segment except seg0, in bytes.
+	 * When it is exceeded, clean segment pages are dropped and re-read from
+	 * the segment stob on the next access. 0 means no limit.
+	 *
+	 * @see m0_be_seg_pg
+	 */
+	m0_bcount_t                  bc_pg_budget;
+	/**
+	 * Page size shift of the segment page manager,
+	 * M0_BE_SEG_PG_SHIFT_DEFAULT if 0.
+	 */
+	unsigned                     bc_pg_shift;
+	/**
+	 * Number of bytes of every segment except seg0 to prefetch when the
+	 * segment is opened, 0 disables the warm-up.
+	 *
+	 * @see m0_be_seg_warmup()
+	 */
+	m0_bcount_t                  bc_seg_warmup_size;
+	/** Number of warm-up threads, M0_BE_SEG_WARMUP_THREAD_NR if 0. */
+	unsigned                     bc_seg_warmup_thread_nr;
+	/** Back segments except seg0 with transparent huge pages. */
+	bool                         bc_seg_huge;
 
 	/*
 	 * Next fields are for mkfs mode only.
@@ -198,6 +222,18 @@ m0_be_domain_cleanup_by_location(const char *stob_domain_location);
 M0_INTERNAL struct m0_be_tx *m0_be_domain_tx_find(struct m0_be_domain *dom,
 						  uint64_t id);
 
+/**
+ * Scans pages of the domain segments after a transaction group is placed and
+ * asks the engine to drop clean pages if a segment exceeds its budget.
+ */
+M0_INTERNAL void m0_be_domain__pg_scan(struct m0_be_domain *dom);
+/**
+ * Drops the clean pages found by m0_be_domain__pg_scan(). Called by the engine
+ * when there are no active transactions.
+ */
+M0_INTERNAL void m0_be_domain__pg_evict(struct m0_be_domain *dom,
+					uint64_t clean);
+
 M0_INTERNAL struct m0_be_engine *m0_be_domain_engine(struct m0_be_domain *dom);
 M0_INTERNAL
 struct m0_be_seg *m0_be_domain_seg0_get(struct m0_be_domain *dom);
@@ -52,6 +52,11 @@ M0_TL_DESCR_DEFINE(egr, "m0_be_engine::eng_groups[]", static,
 		   M0_BE_TX_MAGIC /* XXX */, M0_BE_TX_ENGINE_MAGIC /* XXX */);
 M0_TL_DEFINE(egr, static, struct m0_be_tx_group);
 
+M0_TL_DESCR_DEFINE(efc, "m0_be_engine::eng_tx_first_capture", static,
+		   struct m0_be_tx, t_first_capture_linkage, t_magic,
+		   M0_BE_TX_MAGIC, M0_BE_TX_ENGINE_MAGIC);
+M0_TL_DEFINE(efc, static, struct m0_be_tx);
+
 static bool be_engine_is_locked(const struct m0_be_engine *en);
 static void be_engine_tx_group_open(struct m0_be_engine   *en,
 				    struct m0_be_tx_group *gr);
@@ -158,6 +163,11 @@ M0_INTERNAL int m0_be_engine_init(struct m0_be_engine     *en,
 	m0_semaphore_init(&en->eng_recovery_wait_sem, 0);
 	en->eng_recovery_finished = false;
 
+	efc_tlist_init(&en->eng_tx_first_capture);
+	m0_atomic64_set(&en->eng_pg_seq, 0);
+	en->eng_pg_evict = false;
+	en->eng_pg_stall = false;
+
 	M0_POST(m0_be_engine__invariant(en));
 	return M0_RC(0);
  err_service_fini:
@@ -187,6 +197,7 @@ M0_INTERNAL void m0_be_engine_fini(struct m0_be_engine *en)
 
 	m0_semaphore_fini(&en->eng_recovery_wait_sem);
 
+	efc_tlist_fini(&en->eng_tx_first_capture);
 	m0_forall(i, ARRAY_SIZE(en->eng_txs),
 		  (etx_tlist_fini(&en->eng_txs[i]), true));
 	for (i = 0; i < en->eng_group_nr; ++i) {
@@ -469,6 +480,8 @@ static int be_engine_tx_trygroup(struct m0_be_engine *en,
 		}
 		if (m0_be_tx__is_exclusive(tx) && m0_be_tx_group_tx_nr(gr) > 0) {
 			rc = -EBUSY;
+		} else if (en->eng_pg_stall) {
+			rc = -ENOSPC;
 		} else if (etx_tlist_length(&en->eng_txs[M0_BTS_ACTIVE]) >=
 			   en->eng_cfg->bec_tx_active_max) {
 			rc = -ENOSPC;
@@ -579,6 +592,38 @@ static void be_engine_got_tx_grouping(struct m0_be_engine *en)
 		 */
 	}
 }
+
+static uint64_t be_engine_pg_clean(struct m0_be_engine *en)
+{
+	struct m0_be_tx *tx;
+
+	M0_PRE(be_engine_is_locked(en));
+
+	tx = efc_tlist_head(&en->eng_tx_first_capture);
+	return tx == NULL ? m0_atomic64_get(&en->eng_pg_seq) :
+			    tx->t_first_capture_seq - 1;
+}
+
+/**
+ * Drops clean segment pages if it was requested and there are no active
+ * transactions, i.e. nobody can modify segment memory before capturing it.
+ */
+static void be_engine_pg_tryevict(struct m0_be_engine *en)
+{
+	bool stalled = en->eng_pg_stall;
+
+	M0_PRE(be_engine_is_locked(en));
+
+	if (!en->eng_pg_evict ||
+	    !etx_tlist_is_empty(&en->eng_txs[M0_BTS_ACTIVE]))
+		return;
+	m0_be_domain__pg_evict(en->eng_domain, be_engine_pg_clean(en));
+	en->eng_pg_evict = false;
+	en->eng_pg_stall = false;
+	if (stalled)
+		be_engine_got_tx_grouping(en);
+}
+
 static void be_engine_got_tx_closed(struct m0_be_engine *en,
 				    struct m0_be_tx     *tx)
 {
@@ -588,10 +633,20 @@ static void be_engine_got_tx_closed(struct m0_be_engine *en,
 
 	M0_CNT_DEC(gr->tg_nr_unclosed);
 	m0_be_tx_group_tx_closed(gr, tx);
+	be_engine_pg_tryevict(en);
 	be_engine_got_tx_grouping(en);
 	be_engine_group_tryclose(en, gr);
 }
 
+static void be_engine_got_tx_placed(struct m0_be_engine *en,
+				    struct m0_be_tx     *tx)
+{
+	M0_PRE(be_engine_is_locked(en));
+
+	if (efc_tlink_is_in(tx))
+		efc_tlist_del(tx);
+}
+
 static void be_engine_got_tx_done(struct m0_be_engine *en, struct m0_be_tx *tx)
 {
 	struct m0_be_tx_group *gr = tx->t_group;
@@ -625,6 +680,8 @@ M0_INTERNAL void m0_be_engine__tx_init(struct m0_be_engine *en,
 				       enum m0_be_tx_state  state)
 {
 	etx_tlink_init(tx);
+	efc_tlink_init(tx);
+	tx->t_first_capture_seq = 0;
 	m0_be_engine__tx_state_set(en, tx, state);
 }
 
@@ -633,6 +690,61 @@ M0_INTERNAL void m0_be_engine__tx_fini(struct m0_be_engine *en,
 {
 	be_engine_lock(en);
 	etx_tlink_del_fini(tx);
+	if (efc_tlink_is_in(tx))
+		efc_tlist_del(tx);
+	efc_tlink_fini(tx);
+	be_engine_unlock(en);
+}
+
+M0_INTERNAL uint64_t m0_be_engine__tx_capture(struct m0_be_engine *en,
+					      struct m0_be_tx     *tx)
+{
+	uint64_t seq;
+
+	/*
+	 * The first capture of a transaction takes the lock, so that
+	 * eng_tx_first_capture is sorted by m0_be_tx::t_first_capture_seq.
+	 */
+	if (tx->t_first_capture_seq != 0)
+		return m0_atomic64_add_return(&en->eng_pg_seq, 1);
+	be_engine_lock(en);
+	seq = m0_atomic64_add_return(&en->eng_pg_seq, 1);
+	tx->t_first_capture_seq = seq;
+	efc_tlist_add_tail(&en->eng_tx_first_capture, tx);
+	be_engine_unlock(en);
+	return seq;
+}
+
+M0_INTERNAL uint64_t m0_be_engine__pg_clean(struct m0_be_engine *en)
+{
+	uint64_t clean;
+
+	be_engine_lock(en);
+	clean = be_engine_pg_clean(en);
+	be_engine_unlock(en);
+	return clean;
+}
+
+M0_INTERNAL uint32_t m0_be_engine_log_used_pct(struct m0_be_engine *en)
+{
+	m0_bcount_t size = m0_be_log_store_buf_size(&en->eng_log.lg_store);
+	m0_bcount_t free;
+
+	be_engine_lock(en);
+	free = en->eng_log.lg_free;
+	be_engine_unlock(en);
+	return size == 0 ? 0 : (size - min_check(free, size)) * 100 / size;
+}
+
+M0_INTERNAL void m0_be_engine__pg_evict(struct m0_be_engine *en, bool stall)
+{
+	be_engine_lock(en);
+	/* Recovery writes segment memory without captures. */
+	if (en->eng_recovery_finished) {
+		en->eng_pg_evict  = true;
+		en->eng_pg_stall |= stall;
+		be_engine_pg_tryevict(en);
+	}
 	be_engine_unlock(en);
 }
 
@@ -665,6 +777,9 @@ M0_INTERNAL void m0_be_engine__tx_state_set(struct m0_be_engine *en,
 	case M0_BTS_CLOSED:
 		be_engine_got_tx_closed(en, tx);
 		break;
+	case M0_BTS_PLACED:
+		be_engine_got_tx_placed(en, tx);
+		break;
 	case M0_BTS_DONE:
 		be_engine_got_tx_done(en, tx);
 		break;
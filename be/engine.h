@@ -27,6 +27,7 @@
 #define __MOTR_BE_ENGINE_H__
 
 #include "lib/types.h"          /* bool */
+#include "lib/atomic.h"         /* m0_atomic64 */
 #include "lib/mutex.h"          /* m0_mutex */
 #include "lib/tlist.h"          /* m0_tl */
 #include "lib/semaphore.h"      /* m0_semaphore */
@@ -118,6 +119,25 @@ struct m0_be_engine {
 	struct m0_be_domain       *eng_domain;
 	struct m0_semaphore        eng_recovery_wait_sem;
 	bool                       eng_recovery_finished;
+	/**
+	 * Transactions which captured something and are not placed yet, in
+	 * the order of their first capture.
+	 *
+	 * Used by the segment page manager to find out which pages are clean.
+	 * Only captures to segments with a memory budget are tracked.
+	 *
+	 * @see m0_be_seg_pg, m0_be_engine__pg_clean()
+	 */
+	struct m0_tl               eng_tx_first_capture;
+	/** Last capture sequence number. */
+	struct m0_atomic64         eng_pg_seq;
+	/** Clean segment pages are to be dropped. */
+	bool                       eng_pg_evict;
+	/**
+	 * New transactions are not activated until clean segment pages are
+	 * dropped.
+	 */
+	bool                       eng_pg_stall;
 };
 
 M0_INTERNAL bool m0_be_engine__invariant(struct m0_be_engine *en);
@@ -138,6 +158,32 @@ M0_INTERNAL void m0_be_engine__tx_init(struct m0_be_engine *en,
 M0_INTERNAL void m0_be_engine__tx_fini(struct m0_be_engine *en,
 				       struct m0_be_tx     *tx);
 
+/** Returns capture sequence number for a capture made by the transaction. */
+M0_INTERNAL uint64_t m0_be_engine__tx_capture(struct m0_be_engine *en,
+					      struct m0_be_tx     *tx);
+/**
+ * Returns the capture sequence number such that all captures with smaller or
+ * equal numbers have been placed.
+ */
+M0_INTERNAL uint64_t m0_be_engine__pg_clean(struct m0_be_engine *en);
+/**
+ * Asks the engine to drop clean segment pages once there are no active
+ * transactions.
+ *
+ * @param stall don't activate new transactions until the pages are dropped.
+ *
+ * @see m0_be_domain__pg_evict()
+ */
+M0_INTERNAL void m0_be_engine__pg_evict(struct m0_be_engine *en, bool stall);
+/**
+ * Returns the part of the log which is not yet discarded, in percents of the
+ * log size.
+ *
+ * Background activities, such as index garbage collection, use this to back
+ * off before transactions start to wait for log space.
+ */
+M0_INTERNAL uint32_t m0_be_engine_log_used_pct(struct m0_be_engine *en);
+
 M0_INTERNAL void m0_be_engine__tx_state_set(struct m0_be_engine *en,
 					    struct m0_be_tx     *tx,
 					    enum m0_be_tx_state  state);
@@ -237,6 +237,11 @@ m0_be_emap_init(struct m0_be_emap *map, struct m0_be_seg *db)
 		.ot_type    = M0_FORMAT_TYPE_BE_EMAP,
 		.ot_footer_offset = offsetof(struct m0_be_emap, em_footer)
 	});
+	/*
+	 * Lock, cursor buffers and version are volatile. Pin before they are
+	 * written, so that the page is not dropped in between.
+	 */
+	m0_be_seg_pin(db, map, sizeof *map);
 	m0_rwlock_init(emap_rwlock(map));
 	m0_buf_init(&map->em_key_buf, &map->em_key, sizeof map->em_key);
 	m0_buf_init(&map->em_val_buf, &map->em_rec, sizeof map->em_rec);
@@ -253,6 +258,7 @@ M0_INTERNAL void m0_be_emap_fini(struct m0_be_emap *map)
 	map->em_version = 0;
 	m0_be_btree_fini(&map->em_mapping);
 	m0_rwlock_fini(emap_rwlock(map));
+	m0_be_seg_unpin(map->em_seg, map, sizeof *map);
 }
 
 M0_INTERNAL void m0_be_emap_create(struct m0_be_emap   *map,
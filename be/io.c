@@ -25,9 +25,11 @@
 
 #include "be/io.h"
 
+#include <stdlib.h>              /* qsort */
 #include <unistd.h>              /* fdatasync */
 
 #include "lib/memory.h"          /* m0_alloc */
+#include "lib/arith.h"           /* M0_3WAY, min64u */
 #include "lib/errno.h"           /* ENOMEM */
 #include "lib/ext.h"             /* m0_ext_are_overlapping */
 #include "lib/locality.h"        /* m0_locality0_get */
@@ -747,6 +749,40 @@ M0_INTERNAL bool m0_be_io_intersect(const struct m0_be_io *bio1,
 	return false;
 }
 
+M0_INTERNAL bool m0_be_io_merged_intersect(const struct m0_be_io *bio1,
+					   const struct m0_be_io *bio2)
+{
+	const struct m0_indexvec *iv1;
+	const struct m0_indexvec *iv2;
+	uint32_t                  a;
+	uint32_t                  b;
+	int                       i;
+	int                       j;
+
+	for (i = 0; i < bio1->bio_stob_nr; ++i)
+		for (j = 0; j < bio2->bio_stob_nr; ++j) {
+			if (bio1->bio_part[i].bip_stob !=
+			    bio2->bio_part[j].bip_stob)
+				continue;
+			iv1 = &bio1->bio_part[i].bip_sio.si_stob;
+			iv2 = &bio2->bio_part[j].bip_sio.si_stob;
+			a = 0;
+			b = 0;
+			while (a < iv1->iv_vec.v_nr && b < iv2->iv_vec.v_nr) {
+				if (iv1->iv_index[a] + iv1->iv_vec.v_count[a] <=
+				    iv2->iv_index[b])
+					++a;
+				else if (iv2->iv_index[b] +
+					 iv2->iv_vec.v_count[b] <=
+					 iv1->iv_index[a])
+					++b;
+				else
+					return true;
+			}
+		}
+	return false;
+}
+
 /** @note only one part and only one buffer in bufvec is supported atm. */
 M0_INTERNAL bool m0_be_io_ptr_user_is_eq(const struct m0_be_io *bio1,
 					 const struct m0_be_io *bio2)
@@ -779,6 +815,143 @@ M0_INTERNAL bool m0_be_io_offset_stob_is_eq(const struct m0_be_io *bio1,
 	       iv1->iv_index[0] == iv2->iv_index[0];
 }
 
+M0_INTERNAL int m0_be_io_merge_init(struct m0_be_io_merge *bim,
+				    uint64_t               reg_nr_max)
+{
+	M0_ALLOC_ARR(bim->bim_reg, reg_nr_max);
+	M0_ALLOC_ARR(bim->bim_active, reg_nr_max);
+	if (bim->bim_reg == NULL || bim->bim_active == NULL) {
+		m0_be_io_merge_fini(bim);
+		return M0_ERR(-ENOMEM);
+	}
+	bim->bim_reg_nr_max = reg_nr_max;
+	return 0;
+}
+
+M0_INTERNAL void m0_be_io_merge_fini(struct m0_be_io_merge *bim)
+{
+	m0_free0(&bim->bim_active);
+	m0_free0(&bim->bim_reg);
+}
+
+static int be_io_reg_cmp(const void *a, const void *b)
+{
+	const struct m0_be_io_reg *r0 = a;
+	const struct m0_be_io_reg *r1 = b;
+
+	return M0_3WAY((uintptr_t)r0->bir_stob, (uintptr_t)r1->bir_stob) ?:
+	       M0_3WAY(r0->bir_offset, r1->bir_offset) ?:
+	       M0_3WAY(r0->bir_seq, r1->bir_seq);
+}
+
+static m0_bindex_t be_io_reg_end(const struct m0_be_io_reg *reg)
+{
+	return reg->bir_offset + reg->bir_size;
+}
+
+/* Collects non-empty regions of the I/Os, unpacked, in src[] order. */
+static uint64_t be_io_merge_collect(struct m0_be_io_merge  *bim,
+				    struct m0_be_io *const *src,
+				    uint32_t                src_nr)
+{
+	const struct m0_be_io_part *bip;
+	const struct m0_stob_io    *sio;
+	struct m0_be_io_reg        *reg;
+	uint64_t                    nr = 0;
+	uint32_t                    bshift;
+	uint32_t                    i;
+	uint32_t                    k;
+	unsigned                    part;
+
+	for (k = 0; k < src_nr; ++k) {
+		for (part = 0; part < src[k]->bio_stob_nr; ++part) {
+			bip    = &src[k]->bio_part[part];
+			sio    = &bip->bip_sio;
+			bshift = bip->bip_bshift;
+			for (i = 0; i < sio->si_stob.iv_vec.v_nr; ++i) {
+				M0_ASSERT(nr < bim->bim_reg_nr_max);
+				reg  = &bim->bim_reg[nr];
+				*reg = (struct m0_be_io_reg){
+					.bir_stob   = bip->bip_stob,
+					.bir_offset = be_io_size_unpack(
+						sio->si_stob.iv_index[i],
+						bshift),
+					.bir_size   = be_io_size_unpack(
+						sio->si_stob.iv_vec.v_count[i],
+						bshift),
+					.bir_ptr    = m0_stob_addr_open(
+						sio->si_user.ov_buf[i], bshift),
+					.bir_seq    = nr,
+				};
+				nr += reg->bir_size > 0;
+			}
+		}
+	}
+	return nr;
+}
+
+M0_INTERNAL uint64_t m0_be_io_merge(struct m0_be_io_merge  *bim,
+				    struct m0_be_io        *dst,
+				    struct m0_be_io *const *src,
+				    uint32_t                src_nr)
+{
+	struct m0_be_io_reg  *reg = bim->bim_reg;
+	struct m0_be_io_reg **act = bim->bim_active;
+	struct m0_be_io_reg  *win;
+	struct m0_stob       *stob;
+	m0_bindex_t           pos;
+	m0_bindex_t           next;
+	uint64_t              act_nr;
+	uint64_t              nr;
+	uint64_t              i;
+	uint64_t              j;
+	bool                  more;
+
+	M0_PRE(m0_be_io_is_empty(dst));
+
+	nr = be_io_merge_collect(bim, src, src_nr);
+	qsort(reg, nr, sizeof reg[0], &be_io_reg_cmp);
+	/*
+	 * Sweep over each stob in offset order. act[] holds the regions that
+	 * cover pos; the latest of them provides data up to the next point
+	 * where a region starts or ends.
+	 */
+	for (i = 0; i < nr; ) {
+		stob   = reg[i].bir_stob;
+		pos    = reg[i].bir_offset;
+		act_nr = 0;
+		while (true) {
+			while (i < nr && reg[i].bir_stob == stob &&
+			       reg[i].bir_offset <= pos)
+				act[act_nr++] = &reg[i++];
+			win  = NULL;
+			next = M0_BINDEX_MAX;
+			for (j = 0; j < act_nr; ) {
+				if (be_io_reg_end(act[j]) <= pos) {
+					act[j] = act[--act_nr];
+					continue;
+				}
+				if (win == NULL ||
+				    act[j]->bir_seq > win->bir_seq)
+					win = act[j];
+				next = min64u(next, be_io_reg_end(act[j]));
+				++j;
+			}
+			more = i < nr && reg[i].bir_stob == stob;
+			if (more)
+				next = min64u(next, reg[i].bir_offset);
+			if (win != NULL)
+				m0_be_io_add(dst, stob, win->bir_ptr +
+					     (pos - win->bir_offset),
+					     pos, next - pos);
+			else if (!more)
+				break;
+			pos = next;
+		}
+	}
+	return nr;
+}
+
 M0_INTERNAL void m0_be_io_credit_add(struct m0_be_io_credit       *iocred0,
 				     const struct m0_be_io_credit *iocred1)
 {
@@ -188,12 +188,62 @@ M0_INTERNAL int m0_be_io_single(struct m0_stob         *stob,
 M0_INTERNAL bool m0_be_io_intersect(const struct m0_be_io *bio1,
 				    const struct m0_be_io *bio2);
 
+/**
+ * The same as m0_be_io_intersect(), but for I/Os filled by m0_be_io_merge().
+ * Runs in linear time.
+ */
+M0_INTERNAL bool m0_be_io_merged_intersect(const struct m0_be_io *bio1,
+					   const struct m0_be_io *bio2);
+
 M0_INTERNAL bool m0_be_io_ptr_user_is_eq(const struct m0_be_io *bio1,
 					 const struct m0_be_io *bio2);
 M0_INTERNAL bool m0_be_io_offset_stob_is_eq(const struct m0_be_io *bio1,
 					    const struct m0_be_io *bio2);
 
 
+/** Region of a m0_be_io, as seen by m0_be_io_merge(). */
+struct m0_be_io_reg {
+	struct m0_stob *bir_stob;
+	m0_bindex_t     bir_offset;
+	m0_bcount_t     bir_size;
+	char           *bir_ptr;
+	/** Position of the region in the merged I/Os, later ones win. */
+	uint64_t        bir_seq;
+};
+
+/** Preallocated memory for m0_be_io_merge(). */
+struct m0_be_io_merge {
+	struct m0_be_io_reg  *bim_reg;
+	/** Regions covering the current position during the sweep. */
+	struct m0_be_io_reg **bim_active;
+	uint64_t              bim_reg_nr_max;
+};
+
+/**
+ * @param reg_nr_max maximal total number of regions in the I/Os merged.
+ */
+M0_INTERNAL int m0_be_io_merge_init(struct m0_be_io_merge *bim,
+				    uint64_t               reg_nr_max);
+M0_INTERNAL void m0_be_io_merge_fini(struct m0_be_io_merge *bim);
+
+/**
+ * Adds regions of src[0], ..., src[src_nr - 1] to dst, sorted by stob and
+ * offset within the stob.
+ *
+ * Where regions overlap, only data of the region added later wins: a region
+ * of src[i] overrides regions of src[j] for j < i. This makes the result the
+ * same as of executing the writes one by one in src[] order. Regions
+ * adjacent both in the stob and in memory are coalesced, so dst needs at
+ * most 2 * (number of regions in src) credit and usually much less.
+ *
+ * @pre m0_be_io_is_empty(dst)
+ * @return number of regions in src.
+ */
+M0_INTERNAL uint64_t m0_be_io_merge(struct m0_be_io_merge  *bim,
+				    struct m0_be_io        *dst,
+				    struct m0_be_io *const *src,
+				    uint32_t                src_nr);
+
 /** iocred0 += iocred1 */
 M0_INTERNAL void m0_be_io_credit_add(struct m0_be_io_credit       *iocred0,
 				     const struct m0_be_io_credit *iocred1);
@@ -33,6 +33,9 @@
 #include "be/io_sched.h"
 
 #include "lib/ext.h"            /* m0_ext */
+#include "lib/memory.h"         /* M0_ALLOC_ARR */
+#include "lib/misc.h"           /* m0_forall */
+#include "lib/errno.h"          /* ENOMEM */
 
 #include "be/op.h"              /* m0_be_op */
 #include "be/io.h"              /* m0_be_io_launch */
@@ -47,12 +50,103 @@ M0_TL_DESCR_DEFINE(sched_io, "be log scheduler IOs", static,
 		   M0_BE_IO_SCHED_MAGIC, M0_BE_IO_SCHED_HEAD_MAGIC);
 M0_TL_DEFINE(sched_io, static, struct m0_be_io);
 
+enum be_io_sched_batch_state {
+	BSB_FREE,
+	/* taken from the queue, waits for a conflicting batch to finish */
+	BSB_READY,
+	BSB_INFLIGHT,
+};
+
+/** Batch of queued I/Os launched together, @see m0_be_io_sched. */
+struct m0_be_io_sched_batch {
+	struct m0_be_io_sched         *bsb_sched;
+	enum be_io_sched_batch_state   bsb_state;
+	/** Queued I/Os in the batch, in m0_ext order. */
+	struct m0_be_io              **bsb_ios;
+	uint32_t                       bsb_nr;
+	/** The only I/O of the batch is launched as is, without merging. */
+	bool                           bsb_direct;
+	/** Merged I/O, if !bsb_direct. */
+	struct m0_be_io                bsb_io;
+	struct m0_be_io_merge          bsb_merge;
+	struct m0_be_op                bsb_op;
+};
+
+static void be_io_sched_batch_fini(struct m0_be_io_sched *sched, uint32_t nr)
+{
+	struct m0_be_io_sched_batch *batch;
+	uint32_t                     i;
+
+	for (i = 0; i < nr; ++i) {
+		batch = &sched->bis_batch[i];
+		M0_ASSERT(batch->bsb_state == BSB_FREE);
+		m0_be_io_merge_fini(&batch->bsb_merge);
+		m0_be_io_deallocate(&batch->bsb_io);
+		m0_be_io_fini(&batch->bsb_io);
+		m0_free(batch->bsb_ios);
+	}
+	m0_free0(&sched->bis_batch);
+}
+
+static int be_io_sched_batch_init(struct m0_be_io_sched *sched)
+{
+	struct m0_be_io_sched_cfg   *cfg = &sched->bis_cfg;
+	struct m0_be_io_sched_batch *batch;
+	uint32_t                     i;
+	int                          rc = 0;
+
+	M0_PRE(cfg->bisc_batch_inflight_max > 0);
+
+	M0_ALLOC_ARR(sched->bis_batch, cfg->bisc_batch_inflight_max);
+	if (sched->bis_batch == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < cfg->bisc_batch_inflight_max; ++i) {
+		batch = &sched->bis_batch[i];
+		batch->bsb_sched = sched;
+		batch->bsb_state = BSB_FREE;
+		M0_ALLOC_ARR(batch->bsb_ios, cfg->bisc_batch_max);
+		if (batch->bsb_ios == NULL) {
+			rc = M0_ERR(-ENOMEM);
+			break;
+		}
+		rc = m0_be_io_init(&batch->bsb_io) ?:
+		     m0_be_io_allocate(&batch->bsb_io,
+				       &cfg->bisc_batch_io_credit);
+		if (rc != 0) {
+			m0_free(batch->bsb_ios);
+			break;
+		}
+		/* Merged I/Os use at most a half of the credit, see below. */
+		rc = m0_be_io_merge_init(&batch->bsb_merge,
+				cfg->bisc_batch_io_credit.bic_reg_nr / 2 + 1);
+		if (rc != 0) {
+			m0_be_io_deallocate(&batch->bsb_io);
+			m0_free(batch->bsb_ios);
+			break;
+		}
+	}
+	if (rc != 0)
+		be_io_sched_batch_fini(sched, i);
+	return M0_RC(rc);
+}
 
 M0_INTERNAL int m0_be_io_sched_init(struct m0_be_io_sched     *sched,
 				    struct m0_be_io_sched_cfg *cfg)
 {
+	int rc;
+
 	if (cfg != NULL)
 		sched->bis_cfg = *cfg;
+	sched->bis_batch          = NULL;
+	sched->bis_batch_ready    = NULL;
+	sched->bis_batch_inflight = 0;
+	M0_SET0(&sched->bis_stats);
+	if (sched->bis_cfg.bisc_batch_max > 0) {
+		rc = be_io_sched_batch_init(sched);
+		if (rc != 0)
+			return M0_RC(rc);
+	}
+
 	m0_mutex_init(&sched->bis_lock);
 	sched_io_tlist_init(&sched->bis_ios);
 	sched->bis_io_in_progress = false;
@@ -63,6 +157,11 @@ M0_INTERNAL int m0_be_io_sched_init(struct m0_be_io_sched     *sched,
 
 M0_INTERNAL void m0_be_io_sched_fini(struct m0_be_io_sched *sched)
 {
+	M0_PRE(sched->bis_batch_ready == NULL);
+
+	if (sched->bis_batch != NULL)
+		be_io_sched_batch_fini(sched,
+				       sched->bis_cfg.bisc_batch_inflight_max);
 	sched_io_tlist_fini(&sched->bis_ios);
 	m0_mutex_fini(&sched->bis_lock);
 }
@@ -90,12 +189,23 @@ static bool be_io_sched_invariant(struct m0_be_io_sched *sched)
 		    sched_io_tlist_next(&sched->bis_ios, io)->bio_ext.e_start);
 }
 
+static bool be_io_sched_io_is_read(struct m0_be_io *io)
+{
+	return !m0_be_io_is_empty(io) && m0_be_io_opcode(io) == SIO_READ;
+}
+
+static void be_io_sched_batch_launch_next(struct m0_be_io_sched *sched);
+
 static void be_io_sched_launch_next(struct m0_be_io_sched *sched)
 {
 	struct m0_be_io *io;
 
 	M0_PRE(m0_be_io_sched_is_locked(sched));
 
+	if (sched->bis_batch != NULL) {
+		be_io_sched_batch_launch_next(sched);
+		return;
+	}
 	if (!sched->bis_io_in_progress) {
 		io = sched_io_tlist_head(&sched->bis_ios);
 		M0_ASSERT(ergo(io != NULL,
@@ -140,6 +250,172 @@ static void be_io_sched_cb(struct m0_be_op *op, void *param)
 	be_io_sched_launch_next_locked(sched);
 }
 
+static struct m0_be_io_sched_batch *
+be_io_sched_batch_free(struct m0_be_io_sched *sched)
+{
+	uint32_t i;
+
+	for (i = 0; i < sched->bis_cfg.bisc_batch_inflight_max; ++i) {
+		if (sched->bis_batch[i].bsb_state == BSB_FREE)
+			return &sched->bis_batch[i];
+	}
+	return NULL;
+}
+
+/*
+ * Takes the run of consecutive I/Os at the current position from the queue
+ * and merges them. Returns NULL if there is no such run or no free batch.
+ */
+static struct m0_be_io_sched_batch *
+be_io_sched_batch_form(struct m0_be_io_sched *sched)
+{
+	struct m0_be_io_sched_cfg   *cfg = &sched->bis_cfg;
+	struct m0_be_io_sched_stats *stats = &sched->bis_stats;
+	struct m0_be_io_sched_batch *batch;
+	struct m0_be_io_credit       cred = M0_BE_IO_CREDIT(0, 0, 0);
+	struct m0_be_io             *io;
+	struct m0_be_io             *next;
+	bool                         sync = false;
+	uint32_t                     i;
+
+	M0_PRE(m0_be_io_sched_is_locked(sched));
+
+	io = sched_io_tlist_head(&sched->bis_ios);
+	if (io == NULL || io->bio_ext.e_start != sched->bis_pos)
+		return NULL;
+	batch = be_io_sched_batch_free(sched);
+	if (batch == NULL)
+		return NULL;
+	M0_ASSERT(batch->bsb_nr == 0);
+	while (io != NULL && io->bio_ext.e_start == sched->bis_pos &&
+	       batch->bsb_nr < cfg->bisc_batch_max) {
+		if (be_io_sched_io_is_read(io) && batch->bsb_nr > 0)
+			break;
+		/* Regions may be split in two when merged, hence 2 * reg_nr. */
+		m0_be_io_credit_add(&cred,
+				    &M0_BE_IO_CREDIT(2 * io->bio_used.bic_reg_nr,
+						     io->bio_used.bic_reg_size,
+						     io->bio_used.bic_part_nr));
+		if (batch->bsb_nr > 0 &&
+		    !m0_be_io_credit_le(&cred, &cfg->bisc_batch_io_credit))
+			break;
+		next = sched_io_tlist_next(&sched->bis_ios, io);
+		sched_io_tlink_del_fini(io);
+		batch->bsb_ios[batch->bsb_nr++] = io;
+		sched->bis_pos = io->bio_ext.e_end;
+		sync = sync || m0_be_io_sync_is_enabled(io);
+		if (be_io_sched_io_is_read(io))
+			break;
+		io = next;
+	}
+	batch->bsb_direct = batch->bsb_nr == 1;
+	batch->bsb_state  = BSB_READY;
+	stats->biss_io_nr += batch->bsb_nr;
+	if (!batch->bsb_direct) {
+		m0_be_io_reset(&batch->bsb_io);
+		stats->biss_reg_in += m0_be_io_merge(&batch->bsb_merge,
+						     &batch->bsb_io,
+						     batch->bsb_ios,
+						     batch->bsb_nr);
+		m0_be_io_configure(&batch->bsb_io, SIO_WRITE);
+		if (sync)
+			m0_be_io_sync_enable(&batch->bsb_io);
+		for (i = 0; i < batch->bsb_nr; ++i)
+			stats->biss_size_in += m0_be_io_size(batch->bsb_ios[i]);
+		stats->biss_size_out += m0_be_io_size(&batch->bsb_io);
+		stats->biss_reg_out  += batch->bsb_io.bio_vec_pos;
+		++stats->biss_batch_nr;
+	}
+	M0_LOG(M0_DEBUG, "sched=%p batch=%p nr=%"PRIu32" direct=%d pos=%"PRIu64,
+	       sched, batch, batch->bsb_nr, !!batch->bsb_direct,
+	       sched->bis_pos);
+	return batch;
+}
+
+/*
+ * Direct batches run alone, merged ones run together unless they write to
+ * the same place: stob I/Os may complete in any order.
+ */
+static bool be_io_sched_batch_can_launch(struct m0_be_io_sched       *sched,
+					 struct m0_be_io_sched_batch *batch)
+{
+	struct m0_be_io_sched_batch *b;
+
+	if (batch->bsb_direct)
+		return sched->bis_batch_inflight == 0;
+	return m0_forall(i, sched->bis_cfg.bisc_batch_inflight_max,
+			 b = &sched->bis_batch[i],
+			 b->bsb_state != BSB_INFLIGHT ||
+			 (!b->bsb_direct &&
+			  !m0_be_io_merged_intersect(&b->bsb_io,
+						     &batch->bsb_io)));
+}
+
+static void be_io_sched_batch_cb(struct m0_be_op *op, void *param)
+{
+	struct m0_be_io_sched_batch *batch = param;
+	struct m0_be_io_sched       *sched = batch->bsb_sched;
+	uint32_t                     i;
+
+	M0_LOG(M0_DEBUG, "sched=%p batch=%p nr=%"PRIu32,
+	       sched, batch, batch->bsb_nr);
+
+	m0_be_op_fini(op);
+	/* The batch is not FREE yet, nobody else touches it. */
+	for (i = 0; i < batch->bsb_nr; ++i)
+		m0_be_op_done(&batch->bsb_ios[i]->bio_sched_op);
+
+	m0_be_io_sched_lock(sched);
+	M0_ASSERT(batch->bsb_state == BSB_INFLIGHT);
+	batch->bsb_state = BSB_FREE;
+	batch->bsb_nr    = 0;
+	--sched->bis_batch_inflight;
+	be_io_sched_launch_next(sched);
+	m0_be_io_sched_unlock(sched);
+}
+
+static void be_io_sched_batch_launch(struct m0_be_io_sched       *sched,
+				     struct m0_be_io_sched_batch *batch)
+{
+	uint32_t i;
+
+	M0_PRE(m0_be_io_sched_is_locked(sched));
+	M0_PRE(batch->bsb_state == BSB_READY);
+
+	batch->bsb_state = BSB_INFLIGHT;
+	++sched->bis_batch_inflight;
+	M0_SET0(&batch->bsb_op);
+	m0_be_op_init(&batch->bsb_op);
+	m0_be_op_callback_set(&batch->bsb_op, &be_io_sched_batch_cb,
+			      batch, M0_BOS_GC);
+	for (i = 0; i < batch->bsb_nr; ++i)
+		m0_be_op_active(&batch->bsb_ios[i]->bio_sched_op);
+	m0_be_io_launch(batch->bsb_direct ? batch->bsb_ios[0] : &batch->bsb_io,
+			&batch->bsb_op);
+}
+
+static void be_io_sched_batch_launch_next(struct m0_be_io_sched *sched)
+{
+	struct m0_be_io_sched_batch *batch;
+
+	M0_PRE(m0_be_io_sched_is_locked(sched));
+
+	while (true) {
+		if (sched->bis_batch_ready == NULL)
+			sched->bis_batch_ready = be_io_sched_batch_form(sched);
+		batch = sched->bis_batch_ready;
+		if (batch == NULL || !be_io_sched_batch_can_launch(sched, batch))
+			break;
+		sched->bis_batch_ready = NULL;
+		be_io_sched_batch_launch(sched, batch);
+	}
+}
+
+static void be_io_sched_batch_io_gc(struct m0_be_op *op, void *param)
+{
+	m0_be_op_fini(op);
+}
+
 static void be_io_sched_insert(struct m0_be_io_sched *sched,
                                struct m0_be_io       *io)
 {
@@ -187,7 +463,7 @@ M0_INTERNAL void m0_be_io_sched_add(struct m0_be_io_sched *sched,
 		    ext == NULL));
 
 	io->bio_sched = sched;
-	if (!m0_be_io_is_empty(io) && m0_be_io_opcode(io) == SIO_READ) {
+	if (be_io_sched_io_is_read(io)) {
 		io_last = sched_io_tlist_tail(&sched->bis_ios);
 		io->bio_ext.e_start = io_last == NULL ? sched->bis_pos :
 				      io_last->bio_ext.e_end;
@@ -199,7 +475,8 @@ M0_INTERNAL void m0_be_io_sched_add(struct m0_be_io_sched *sched,
 	be_io_sched_insert(sched, io);
 	M0_SET0(&io->bio_sched_op);
 	m0_be_op_init(&io->bio_sched_op);
-	m0_be_op_callback_set(&io->bio_sched_op, &be_io_sched_cb,
+	m0_be_op_callback_set(&io->bio_sched_op, sched->bis_batch == NULL ?
+			      &be_io_sched_cb : &be_io_sched_batch_io_gc,
 			      io, M0_BOS_GC);
 	m0_be_op_set_add(op, &io->bio_sched_op);
 	be_io_sched_launch_next(sched);
@@ -35,13 +35,44 @@
 #include "lib/tlist.h"          /* m0_tl */
 #include "lib/mutex.h"          /* m0_mutex */
 
+#include "be/io.h"              /* m0_be_io_credit */
+
 struct m0_be_op;
 struct m0_be_io;
 struct m0_ext;
+struct m0_be_io_sched_batch;
 
 struct m0_be_io_sched_cfg {
 	/** start position for m0_be_io_sched::bis_pos */
-	m0_bcount_t bisc_pos_start;
+	m0_bcount_t            bisc_pos_start;
+	/**
+	 * Maximal number of queued write I/Os merged into one batch.
+	 * 0 disables batching.
+	 */
+	uint32_t               bisc_batch_max;
+	/** Maximal number of batches in flight. */
+	uint32_t               bisc_batch_inflight_max;
+	/**
+	 * Credit of the merged I/O of a batch. A batch is cut when the queued
+	 * I/Os don't fit in it, counting m0_be_io_credit::bic_reg_nr twice
+	 * (see m0_be_io_merge()); a queued I/O which doesn't fit alone is
+	 * launched as is.
+	 */
+	struct m0_be_io_credit bisc_batch_io_credit;
+};
+
+/** Batching statistics. */
+struct m0_be_io_sched_stats {
+	/** Number of queued I/Os launched. */
+	uint64_t    biss_io_nr;
+	/** Number of merged I/Os launched. */
+	uint64_t    biss_batch_nr;
+	/** Number of regions of the queued I/Os that were merged. */
+	uint64_t    biss_reg_in;
+	/** Number of regions (stob I/O vector entries) of the merged I/Os. */
+	uint64_t    biss_reg_out;
+	m0_bcount_t biss_size_in;
+	m0_bcount_t biss_size_out;
 };
 
 /*
@@ -60,15 +91,40 @@ struct m0_be_io_sched_cfg {
  *   - doesn't have m0_ext assigned (subject to change);
  *   - is launched after the last write I/O (at the time the read I/O is added
  *     to the scheduler's queue) from the queue is finished.
+ *
+ * Batching (m0_be_io_sched_cfg::bisc_batch_max != 0) works like an elevator
+ * for segment placement. When the scheduler is ready to launch, it takes the
+ * whole run of consecutive queued write I/Os starting at the current position
+ * (up to bisc_batch_max of them) and merges their regions into one I/O with
+ * m0_be_io_merge(): regions are sorted by stob offset, data overwritten by a
+ * later I/O is written only once and adjacent regions become contiguous
+ * writes. Up to bisc_batch_inflight_max merged I/Os are in flight, provided
+ * they don't overlap in the stobs. Queued I/Os of a batch are reported as
+ * started in the m0_ext order when the batch is launched and as finished
+ * when it completes. Runs of a single I/O and read I/Os are launched as is,
+ * when nothing else is in flight.
+ *
+ * I/Os accumulate in the queue while earlier batches are in flight, so the
+ * more I/Os are allowed to wait for placement (e.g. tx groups), the larger
+ * the batches.
  */
 struct m0_be_io_sched {
-	struct m0_be_io_sched_cfg bis_cfg;
+	struct m0_be_io_sched_cfg    bis_cfg;
 	/** list of m0_be_io-s under scheduler's control */
-	struct m0_tl              bis_ios;
-	struct m0_mutex           bis_lock;
-	bool                      bis_io_in_progress;
-	/** position for the next I/O */
-	m0_bcount_t               bis_pos;
+	struct m0_tl                 bis_ios;
+	struct m0_mutex              bis_lock;
+	bool                         bis_io_in_progress;
+	/**
+	 * position for the next I/O. With batching it's the end of the last
+	 * batch taken from the queue.
+	 */
+	m0_bcount_t                  bis_pos;
+	/** bisc_batch_inflight_max batches, NULL if batching is disabled */
+	struct m0_be_io_sched_batch *bis_batch;
+	/** Batch taken from the queue, but not launched yet. */
+	struct m0_be_io_sched_batch *bis_batch_ready;
+	uint32_t                     bis_batch_inflight;
+	struct m0_be_io_sched_stats  bis_stats;
 };
 
 M0_INTERNAL int m0_be_io_sched_init(struct m0_be_io_sched     *sched,
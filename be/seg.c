@@ -30,6 +30,7 @@
 #include "lib/errno.h"        /* ENOMEM */
 #include "lib/time.h"         /* m0_time_now */
 #include "lib/atomic.h"       /* m0_atomic64 */
+#include "lib/thread.h"       /* M0_THREAD_INIT */
 
 #include "motr/version.h"     /* m0_build_info_get */
 
@@ -321,6 +322,292 @@ static void be_seg_madvise(struct m0_be_seg *seg, m0_bcount_t dump_limit,
 
 }
 
+static void be_seg_pg_range(const struct m0_be_seg *seg,
+			    const void *addr, m0_bcount_t size,
+			    uint64_t *first, uint64_t *last)
+{
+	m0_bindex_t off = addr - seg->bs_addr;
+
+	*first = off >> seg->bs_pg_shift;
+	*last  = min64u(off + size - 1, seg->bs_size - 1) >> seg->bs_pg_shift;
+}
+
+static void *be_seg_pg_addr(const struct m0_be_seg *seg, uint64_t i)
+{
+	return seg->bs_addr + (i << seg->bs_pg_shift);
+}
+
+static m0_bcount_t be_seg_pg_size(const struct m0_be_seg *seg, uint64_t i)
+{
+	return min64u(1ULL << seg->bs_pg_shift,
+		      seg->bs_size - (i << seg->bs_pg_shift));
+}
+
+static int be_seg_pg_init(struct m0_be_seg *seg)
+{
+	unsigned sys_shift = m0_log2(m0_pagesize_get());
+
+	if (seg->bs_pg_budget == 0)
+		return 0;
+	if (seg->bs_pg_shift == 0)
+		seg->bs_pg_shift = M0_BE_SEG_PG_SHIFT_DEFAULT;
+	seg->bs_pg_shift = max_check(seg->bs_pg_shift, sys_shift);
+	/* Don't let eviction split huge pages. */
+	if (seg->bs_huge)
+		seg->bs_pg_shift = max_check(seg->bs_pg_shift,
+					     (unsigned)M0_BE_SEG_HUGE_SHIFT);
+	seg->bs_pg_nr = (seg->bs_size + (1ULL << seg->bs_pg_shift) - 1) >>
+			seg->bs_pg_shift;
+	M0_ALLOC_ARR(seg->bs_pg, seg->bs_pg_nr);
+	if (seg->bs_pg == NULL)
+		return M0_ERR(-ENOMEM);
+	m0_mutex_init(&seg->bs_pg_lock);
+	seg->bs_pg_hand     = 0;
+	seg->bs_pg_resident = 0;
+	seg->bs_pg_marked   = 0;
+	seg->bs_pg_evicted  = 0;
+	M0_LOG(M0_INFO, "seg=%p budget=%"PRIu64" pg_shift=%u pg_nr=%"PRIu64,
+	       seg, seg->bs_pg_budget, seg->bs_pg_shift, seg->bs_pg_nr);
+	return 0;
+}
+
+static void be_seg_pg_fini(struct m0_be_seg *seg)
+{
+	if (seg->bs_pg == NULL)
+		return;
+	M0_LOG(M0_INFO, "seg=%p resident=%"PRIu64" evicted=%"PRIu64,
+	       seg, seg->bs_pg_resident, seg->bs_pg_evicted);
+	m0_mutex_fini(&seg->bs_pg_lock);
+	m0_free0(&seg->bs_pg);
+}
+
+/** Segment warm-up state shared by the warm-up threads. */
+struct be_seg_warmup {
+	struct m0_be_seg   *sw_seg;
+	m0_bcount_t         sw_size;
+	/** Index of the next chunk to read. */
+	struct m0_atomic64  sw_next;
+};
+
+static void be_seg_warmup_thread(struct be_seg_warmup *w)
+{
+	m0_bcount_t    sys_size = m0_pagesize_get();
+	m0_bcount_t    off;
+	m0_bcount_t    size;
+	m0_bcount_t    i;
+	volatile char *p;
+
+	while (true) {
+		off = (m0_atomic64_add_return(&w->sw_next, 1) - 1) *
+			M0_BE_SEG_WARMUP_CHUNK;
+		if (off >= w->sw_size)
+			break;
+		size = min64u(M0_BE_SEG_WARMUP_CHUNK, w->sw_size - off);
+		p = w->sw_seg->bs_addr + off;
+		/* Read the whole chunk at once, then map its pages. */
+		(void)madvise((void *)p, size, MADV_WILLNEED);
+		for (i = 0; i < size; i += sys_size)
+			(void)p[i];
+	}
+}
+
+M0_INTERNAL void m0_be_seg_warmup(struct m0_be_seg *seg, m0_bcount_t size,
+				  unsigned thread_nr)
+{
+	struct be_seg_warmup  w = {
+		.sw_seg  = seg,
+		.sw_size = min64u(size, seg->bs_size),
+	};
+	struct m0_thread     *threads;
+	m0_time_t             start = m0_time_now();
+	m0_time_t             elapsed;
+	unsigned              nr;
+	unsigned              i;
+	int                   rc;
+
+	M0_ENTRY("seg=%p size=%"PRIu64" thread_nr=%u", seg, size, thread_nr);
+	M0_PRE(seg->bs_state == M0_BSS_OPENED);
+
+	if (thread_nr == 0)
+		thread_nr = M0_BE_SEG_WARMUP_THREAD_NR;
+	thread_nr = min64u(thread_nr, (w.sw_size + M0_BE_SEG_WARMUP_CHUNK - 1) /
+			   M0_BE_SEG_WARMUP_CHUNK);
+	m0_atomic64_set(&w.sw_next, 0);
+	M0_ALLOC_ARR(threads, thread_nr);
+	for (nr = 0; threads != NULL && nr < thread_nr; ++nr) {
+		rc = M0_THREAD_INIT(&threads[nr], struct be_seg_warmup *, NULL,
+				    &be_seg_warmup_thread, &w, "be_warmup%u",
+				    nr);
+		if (rc != 0) {
+			M0_LOG(M0_WARN, "thread %u: rc=%d", nr, rc);
+			break;
+		}
+	}
+	/* Help the threads, or do it all alone if they couldn't start. */
+	be_seg_warmup_thread(&w);
+	for (i = 0; i < nr; ++i) {
+		m0_thread_join(&threads[i]);
+		m0_thread_fini(&threads[i]);
+	}
+	m0_free(threads);
+	elapsed = m0_time_sub(m0_time_now(), start);
+	M0_LOG(M0_INFO, "seg=%p warmed up %"PRIu64" bytes in %"PRIu64" ms "
+	       "with %u threads", seg, w.sw_size,
+	       elapsed / M0_TIME_ONE_MSEC, nr + 1);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_be_seg_pin(struct m0_be_seg *seg,
+			       const void *addr, m0_bcount_t size)
+{
+	uint64_t first;
+	uint64_t last;
+	uint64_t i;
+
+	if (seg->bs_pg == NULL || !m0_be_seg_contains(seg, addr))
+		return;
+	be_seg_pg_range(seg, addr, size, &first, &last);
+	m0_mutex_lock(&seg->bs_pg_lock);
+	for (i = first; i <= last; ++i)
+		seg->bs_pg[i].sp_pin++;
+	m0_mutex_unlock(&seg->bs_pg_lock);
+}
+
+M0_INTERNAL void m0_be_seg_unpin(struct m0_be_seg *seg,
+				 const void *addr, m0_bcount_t size)
+{
+	uint64_t first;
+	uint64_t last;
+	uint64_t i;
+
+	if (seg->bs_pg == NULL || !m0_be_seg_contains(seg, addr))
+		return;
+	be_seg_pg_range(seg, addr, size, &first, &last);
+	m0_mutex_lock(&seg->bs_pg_lock);
+	for (i = first; i <= last; ++i) {
+		if (seg->bs_pg[i].sp_pin > 0)
+			seg->bs_pg[i].sp_pin--;
+	}
+	m0_mutex_unlock(&seg->bs_pg_lock);
+}
+
+M0_INTERNAL void m0_be_seg__pg_capture(struct m0_be_seg       *seg,
+				       const struct m0_be_reg *reg,
+				       uint64_t                seq)
+{
+	int64_t  *pseq;
+	uint64_t  first;
+	uint64_t  last;
+	uint64_t  i;
+	int64_t   old;
+
+	if (seg->bs_pg == NULL)
+		return;
+	be_seg_pg_range(seg, reg->br_addr, reg->br_size, &first, &last);
+	for (i = first; i <= last; ++i) {
+		/* Captures of different localities race, keep the maximum. */
+		pseq = &seg->bs_pg[i].sp_seq;
+		do {
+			old = *(volatile int64_t *)pseq;
+		} while (old < (int64_t)seq && !m0_atomic64_cas(pseq, old, seq));
+		seg->bs_pg[i].sp_private = true;
+	}
+}
+
+M0_INTERNAL bool m0_be_seg__pg_scan(struct m0_be_seg *seg, uint64_t clean)
+{
+	struct m0_be_seg_pg *pg;
+	m0_bcount_t          size;
+	int64_t              seq;
+	bool                 used;
+	bool                 evict;
+	bool                 want;
+	int                  n;
+
+	if (seg->bs_pg == NULL)
+		return false;
+	m0_mutex_lock(&seg->bs_pg_lock);
+	for (n = 0; n < min64u(M0_BE_SEG_PG_SCAN_NR, seg->bs_pg_nr); ++n) {
+		pg   = &seg->bs_pg[seg->bs_pg_hand];
+		size = be_seg_pg_size(seg, seg->bs_pg_hand);
+		/*
+		 * There are no reference bits in user space: a page which has
+		 * been captured since the previous scan is considered used.
+		 */
+		seq  = pg->sp_seq;
+		used = seq != pg->sp_scan_seq;
+		evict = pg->sp_pin == 0 && pg->sp_private && !used &&
+			seq <= (int64_t)clean;
+		if (pg->sp_private != pg->sp_resident) {
+			if (pg->sp_private)
+				seg->bs_pg_resident += size;
+			else
+				seg->bs_pg_resident -= size;
+			pg->sp_resident = pg->sp_private;
+		}
+		seg->bs_pg_marked  += (int)evict - (int)pg->sp_evict;
+		pg->sp_evict    = evict;
+		pg->sp_scan_seq = seq;
+		seg->bs_pg_hand = (seg->bs_pg_hand + 1) % seg->bs_pg_nr;
+	}
+	want = seg->bs_pg_resident > seg->bs_pg_budget && seg->bs_pg_marked > 0;
+	m0_mutex_unlock(&seg->bs_pg_lock);
+	return want;
+}
+
+M0_INTERNAL bool m0_be_seg__pg_over(struct m0_be_seg *seg)
+{
+	bool over;
+
+	if (seg->bs_pg == NULL)
+		return false;
+	m0_mutex_lock(&seg->bs_pg_lock);
+	over = seg->bs_pg_resident > seg->bs_pg_budget + seg->bs_pg_budget / 8;
+	m0_mutex_unlock(&seg->bs_pg_lock);
+	return over;
+}
+
+M0_INTERNAL void m0_be_seg__pg_evict(struct m0_be_seg *seg, uint64_t clean)
+{
+	struct m0_be_seg_pg *pg;
+	m0_bcount_t          target;
+	uint64_t             nr = 0;
+	uint64_t             i;
+	int                  rc;
+
+	if (seg->bs_pg == NULL)
+		return;
+	m0_mutex_lock(&seg->bs_pg_lock);
+	/* Leave some headroom, so that eviction doesn't run too often. */
+	target = seg->bs_pg_budget - seg->bs_pg_budget / 8;
+	for (i = 0; i < seg->bs_pg_nr && seg->bs_pg_marked > 0 &&
+		    seg->bs_pg_resident > target; ++i) {
+		pg = &seg->bs_pg[i];
+		if (!pg->sp_evict)
+			continue;
+		pg->sp_evict = false;
+		seg->bs_pg_marked--;
+		if (pg->sp_pin > 0 || pg->sp_seq > (int64_t)clean)
+			continue;
+		rc = madvise(be_seg_pg_addr(seg, i), be_seg_pg_size(seg, i),
+			     MADV_DONTNEED);
+		if (rc != 0) {
+			M0_LOG(M0_ERROR, "madvise(%p, MADV_DONTNEED) = %d",
+			       be_seg_pg_addr(seg, i), -errno);
+			continue;
+		}
+		if (pg->sp_resident)
+			seg->bs_pg_resident -= be_seg_pg_size(seg, i);
+		pg->sp_private  = false;
+		pg->sp_resident = false;
+		++nr;
+	}
+	seg->bs_pg_evicted += nr;
+	m0_mutex_unlock(&seg->bs_pg_lock);
+	M0_LOG(M0_DEBUG, "seg=%p evicted=%"PRIu64" resident=%"PRIu64,
+	       seg, nr, seg->bs_pg_resident);
+}
+
 M0_INTERNAL int m0_be_seg_open(struct m0_be_seg *seg)
 {
 	const struct m0_be_seg_geom *g;
@@ -373,16 +660,18 @@ M0_INTERNAL int m0_be_seg_open(struct m0_be_seg *seg)
 	}
 
 	/* rc = be_seg_read_all(seg, &hdr); */
-	rc = 0;
+	seg->bs_reserved = be_seg_hdr_size();
+	seg->bs_size     = g->sg_size;
+	seg->bs_addr     = g->sg_addr;
+	seg->bs_offset   = g->sg_offset;
+	seg->bs_gen	 = g->sg_gen;
+	rc = be_seg_pg_init(seg);
 	if (rc == 0) {
-		seg->bs_reserved = be_seg_hdr_size();
-		seg->bs_size     = g->sg_size;
-		seg->bs_addr     = g->sg_addr;
-		seg->bs_offset   = g->sg_offset;
-		seg->bs_gen	 = g->sg_gen;
 		seg->bs_state    = M0_BSS_OPENED;
 		be_seg_madvise(seg, M0_BE_SEG_CORE_DUMP_LIMIT, MADV_DONTDUMP);
 		be_seg_madvise(seg,                      0ULL, MADV_DONTFORK);
+		if (seg->bs_huge)
+			be_seg_madvise(seg, 0ULL, MADV_HUGEPAGE);
 	} else {
 		munmap(g->sg_addr, g->sg_size);
 	}
@@ -396,6 +685,7 @@ M0_INTERNAL void m0_be_seg_close(struct m0_be_seg *seg)
 	M0_ENTRY("seg=%p", seg);
 	M0_PRE(seg->bs_state == M0_BSS_OPENED);
 
+	be_seg_pg_fini(seg);
 	munmap(seg->bs_addr, seg->bs_size);
 	seg->bs_state = M0_BSS_CLOSED;
 	M0_LEAVE();
@@ -27,6 +27,7 @@
 #include "be/alloc.h"           /* m0_be_allocator */
 #include "be/seg_dict.h"        /* m0_be_seg_dict_init */       /* XXX */
 
+#include "lib/mutex.h"          /* m0_mutex */
 #include "lib/tlist.h"          /* m0_tlink */
 #include "lib/types.h"          /* m0_bcount_t */
 
@@ -58,11 +59,58 @@ enum {
 	M0_BE_SEG_FAKE_ID = ~0,
 	/** Segments' addr, size, offset has to be aligned by this boundary */
 	M0_BE_SEG_PAGE_SIZE = 1ULL << 12,
+	/** Default size of a page tracked by the segment page manager. */
+	M0_BE_SEG_PG_SHIFT_DEFAULT = 20,
+	/** Number of pages looked at by a single m0_be_seg__pg_scan(). */
+	M0_BE_SEG_PG_SCAN_NR = 64,
+	/** Transparent huge page size shift. */
+	M0_BE_SEG_HUGE_SHIFT = 21,
+	/** Size of a read issued by m0_be_seg_warmup(). */
+	M0_BE_SEG_WARMUP_CHUNK = 1ULL << 24,
+	/** Default number of m0_be_seg_warmup() threads. */
+	M0_BE_SEG_WARMUP_THREAD_NR = 8,
 };
 
 #define M0_BE_SEG_PG_PRESENT       0x8000000000000000ULL
 #define M0_BE_SEG_PG_PIN_CNT_MASK  (~M0_BE_SEG_PG_PRESENT)
 
+/**
+ * Page of the segment page manager.
+ *
+ * The segment is mapped MAP_PRIVATE. Pages which are only read map the page
+ * cache of the segment stob and are reclaimed by the kernel as needed, but
+ * every page written by a transaction becomes private anonymous memory which
+ * is never given back. When the private memory of the segment exceeds
+ * m0_be_seg::bs_pg_budget, the page manager drops written pages which are
+ * clean with madvise(MADV_DONTNEED). The next access to a dropped page faults
+ * it in again from the segment stob.
+ *
+ * A page is clean when every transaction which captured a region in it has
+ * been placed, i.e. its sp_seq is not greater than the capture sequence
+ * number returned by m0_be_engine__pg_clean(). Pages containing volatile
+ * state which is never captured (locks, cached pointers) are pinned with
+ * m0_be_seg_pin() and are never dropped.
+ *
+ * The page size is a multiple of the system page size, m0_be_seg::bs_pg_shift.
+ */
+struct m0_be_seg_pg {
+	/**
+	 * Capture sequence number of the last capture into the page, updated
+	 * with m0_atomic64_cas().
+	 */
+	int64_t  sp_seq;
+	/** sp_seq as seen by the previous scan. */
+	int64_t  sp_scan_seq;
+	/** Number of m0_be_seg_pin() calls not matched by m0_be_seg_unpin(). */
+	uint32_t sp_pin;
+	/** The page has been captured since it was mapped or dropped. */
+	bool     sp_private;
+	/** The page is accounted in m0_be_seg::bs_pg_resident. */
+	bool     sp_resident;
+	/** The page can be dropped, as seen by the last scan. */
+	bool     sp_evict;
+};
+
 struct m0_be_seg {
 	uint64_t               bs_id;
 	struct m0_stob        *bs_stob;
@@ -83,6 +131,32 @@ struct m0_be_seg {
 	int                    bs_state;
 	uint64_t               bs_magic;
 	struct m0_tlink        bs_linkage;
+	/**
+	 * Resident memory budget of the segment, in bytes. 0 means that pages
+	 * are never dropped and no page state is tracked. It is set before
+	 * m0_be_seg_open().
+	 */
+	m0_bcount_t            bs_pg_budget;
+	/** Page size shift of the page manager, set before m0_be_seg_open(). */
+	unsigned               bs_pg_shift;
+	/** Pages, NULL if bs_pg_budget is 0. */
+	struct m0_be_seg_pg   *bs_pg;
+	uint64_t               bs_pg_nr;
+	/** Protects page pins, scan and eviction state. */
+	struct m0_mutex        bs_pg_lock;
+	/** Next page to be looked at by m0_be_seg__pg_scan(). */
+	uint64_t               bs_pg_hand;
+	/** Private memory of the segment, as seen by the scans, in bytes. */
+	m0_bcount_t            bs_pg_resident;
+	/** Number of pages marked for eviction by the scans. */
+	uint64_t               bs_pg_marked;
+	/** Number of pages dropped so far. */
+	uint64_t               bs_pg_evicted;
+	/**
+	 * Back the segment mapping with transparent huge pages, set before
+	 * m0_be_seg_open().
+	 */
+	bool                   bs_huge;
 };
 
 /* helper for m0_be_seg__create_multiple() */
@@ -187,6 +261,52 @@ M0_INTERNAL unsigned long m0_be_reg_gen_idx(const struct m0_be_reg *reg);
 M0_INTERNAL bool m0_be_seg_contains_stob(struct m0_be_seg        *seg,
                                          const struct m0_stob_id *stob_id);
 
+/**
+ * Prefetches the first size bytes of an opened segment (the whole segment if
+ * size is not less than its size), so that the first accesses after the
+ * segment is opened don't wait for page faults to be served one by one.
+ *
+ * The range is read by thread_nr threads (M0_BE_SEG_WARMUP_THREAD_NR if 0),
+ * M0_BE_SEG_WARMUP_CHUNK bytes at a time. The pages are mapped read-only, so
+ * that they stay shared with the page cache until written.
+ */
+M0_INTERNAL void m0_be_seg_warmup(struct m0_be_seg *seg, m0_bcount_t size,
+				  unsigned thread_nr);
+
+/**
+ * Pins pages of the segment containing [addr, addr + size), so that they are
+ * never dropped by the page manager. It is a no-op if the memory is not in
+ * the segment or the segment has no memory budget.
+ *
+ * Used for segment memory which holds volatile state.
+ */
+M0_INTERNAL void m0_be_seg_pin(struct m0_be_seg *seg,
+			       const void *addr, m0_bcount_t size);
+M0_INTERNAL void m0_be_seg_unpin(struct m0_be_seg *seg,
+				 const void *addr, m0_bcount_t size);
+
+/** Marks pages of the region as captured with sequence number seq. */
+M0_INTERNAL void m0_be_seg__pg_capture(struct m0_be_seg       *seg,
+				       const struct m0_be_reg *reg,
+				       uint64_t                seq);
+/**
+ * Looks at the next M0_BE_SEG_PG_SCAN_NR pages, updates the private memory
+ * of the segment and marks for eviction unpinned private pages which are clean
+ * (sp_seq <= clean) and have not been captured since the previous scan.
+ *
+ * Returns true iff the segment exceeds its budget and has pages to drop.
+ */
+M0_INTERNAL bool m0_be_seg__pg_scan(struct m0_be_seg *seg, uint64_t clean);
+/** Returns true iff the segment exceeds its budget by more than 1/8. */
+M0_INTERNAL bool m0_be_seg__pg_over(struct m0_be_seg *seg);
+/**
+ * Drops pages marked by m0_be_seg__pg_scan() which are still clean.
+ *
+ * Must be called when no transaction can capture, i.e. when there are no
+ * active transactions.
+ */
+M0_INTERNAL void m0_be_seg__pg_evict(struct m0_be_seg *seg, uint64_t clean);
+
 /** @} end of be group */
 #endif /* __MOTR_BE_SEG_H__ */
 
@@ -175,7 +175,9 @@ enum action_opcode {
 	AO_DONE       = 2,
 	AO_CTG        = 3,
 	AO_COB        = 4,
-	AO_EMAP_FIRST = 5,
+	/** Sorted batches of catalogue records, see ctg_load_flush(). */
+	AO_CTG_LOAD   = 5,
+	AO_EMAP_FIRST = 6,
 	AO_NR         = 30
 };
 
@@ -217,6 +219,8 @@ struct action_ops {
 };
 
 enum { CACHE_SIZE = 1000000 };
+/** Maximal number of catalogue records in one m0_be_btree_load() call. */
+enum { CTG_LOAD_BATCH = 256 };
 enum { NV_OFFSET_SAVE_DELTA_IN_BYTES = 0x40000000 }; /* 1G */
 enum { NV_OFFSET_SAVE_ACT_DELTA = 1000 };
 
@@ -224,6 +228,8 @@ struct cache_slot {
         struct m0_fid       cs_fid;
         uint64_t            cs_flags;
         struct m0_be_btree *cs_tree;
+        /** Records of this catalogue buffered for bulk load. */
+        struct ctg_load    *cs_load;
 };
 
 /**
@@ -275,6 +281,8 @@ struct builder {
 	struct m0_mutex            b_emaplock[AO_NR - AO_EMAP_FIRST];
 	struct m0_mutex            b_coblock;
 	struct m0_mutex            b_ctglock;
+	/** List of catalogues with buffered records, see ctg_buffer(). */
+	struct ctg_load           *b_ctg_load;
 };
 
 struct emap_action {
@@ -385,6 +393,13 @@ static bool           isqempty(struct queue *q);
 static int  ctg_proc(struct scanner *s, struct btype *b,
 		     struct m0_be_bnode *node, off_t node_offset);
 static int ctg_pver_fid_get(struct m0_fid *fid);
+static bool ctg_buffer(struct builder *b, struct action *act);
+static bool ctg_load_flush(struct m0_be_tx_bulk *tb, struct builder *b);
+static void ctg_load_free(struct builder *b);
+static int  ctg_load_prep(struct action *act, struct m0_be_tx_credit *accum);
+static bool builder_act_put(struct m0_be_tx_bulk   *tb,
+			    struct action          *act,
+			    struct m0_be_tx_credit *credit);
 
 static void test(void);
 
@@ -414,6 +429,7 @@ static const struct recops seghdrops;
 
 static const struct action_ops done_ops;
 static const struct action_ops ctg_ops;
+static const struct action_ops ctg_load_ops;
 static const struct action_ops cob_ops;
 
 #define _FT(name) M0_FORMAT_TYPE_ ## name
@@ -514,6 +530,35 @@ struct ctg_action {
 	struct cache_slot *cta_slot;
 };
 
+/**
+ * Records of one catalogue, collected by the builder thread for
+ * m0_be_btree_load(). Records are sorted in ctg_load_flush() and then
+ * consumed from cl_pos by ctg_load actions in key order.
+ */
+struct ctg_load {
+	/** Fid of the catalogue btree. */
+	struct m0_fid       cl_fid;
+	/** Buffered records, sorted by key after ctg_load_flush(). */
+	struct ctg_action **cl_rec;
+	uint64_t            cl_nr;
+	uint64_t            cl_alloc;
+	/** Index of the next record to be loaded. */
+	uint64_t            cl_pos;
+	/** Maximal key and value sizes, used for credit calculation. */
+	m0_bcount_t         cl_ksize;
+	m0_bcount_t         cl_vsize;
+	struct ctg_load    *cl_next;
+};
+
+/** Loads the next cla_nr records of a catalogue in one transaction. */
+struct ctg_load_action {
+	struct action       cla_act;
+	struct ctg_load    *cla_load;
+	uint64_t            cla_nr;
+	/** Index of the first record loaded, set by ctg_load_act(). */
+	uint64_t            cla_first;
+};
+
 static struct scanner beck_scanner;
 static struct builder beck_builder;
 static struct gen g[MAX_GEN] = {};
@@ -1480,6 +1525,13 @@ static int emap_prep(struct action *act, struct m0_be_tx_credit *credit)
 	return 0;
 }
 
+/**
+ * Reserves the extent in balloc and pastes it into the emap of the stob.
+ *
+ * Emap records are not bulk loaded: a recovered segment is pasted over the
+ * hole inserted for the object, which splits existing segments, and the
+ * balloc extent is reserved in the same transaction.
+ */
 static void emap_act(struct action *act, struct m0_be_tx *tx)
 {
 	struct emap_action   	 *emap_ac =  M0_AMB(emap_ac, act, emap_act);
@@ -1837,36 +1889,45 @@ static void builder_done(struct m0_be_tx_bulk   *tb,
 	}
 }
 
+static bool builder_act_put(struct m0_be_tx_bulk   *tb,
+			    struct action          *act,
+			    struct m0_be_tx_credit *credit)
+{
+	struct part_info *pinfo = &nv_off_info.noi_pinfo;
+	bool              put_successful;
+
+	M0_BE_OP_SYNC(op, put_successful =
+		      m0_be_tx_bulk_put(tb, &op, credit, 0, act->a_opc, act));
+	if (put_successful) {
+		pinfo->pi_act_added[act->a_opc]++;
+		/* save offset of first bnode in partitions */
+		if (pinfo->pi_act_added[act->a_opc] == 1)
+			pinfo->pi_1st_bnode_offset[act->a_opc] =
+				act->a_node_offset;
+	}
+	return put_successful;
+}
+
 static void builder_work_put(struct m0_be_tx_bulk *tb, struct builder *b)
 {
 	struct action          *act;
 	struct m0_be_tx_credit  credit;
-	struct part_info       *pinfo;
-	bool                    put_successful;
 	int                     rc;
 
-	do {
+	while (true) {
 		act = qget(b->b_q);
-		if (act->a_opc != AO_DONE) {
-			credit = M0_BE_TX_CREDIT(0, 0);
-			act->a_builder = b;
-			rc = act->a_ops->o_prep(act, &credit);
-			if (rc != 0)
-				continue;
-			M0_BE_OP_SYNC(op, put_successful =
-				      m0_be_tx_bulk_put(tb, &op, &credit, 0,
-							act->a_opc, act));
-			if (!put_successful)
-				break;
-
-			pinfo = &nv_off_info.noi_pinfo;
-			pinfo->pi_act_added[act->a_opc]++;
-			/* save offset of first bnode in partitions */
-			if (pinfo->pi_act_added[act->a_opc] == 1)
-				pinfo->pi_1st_bnode_offset[act->a_opc] =
-					act->a_node_offset;
+		if (act->a_opc == AO_DONE) {
+			(void)ctg_load_flush(tb, b);
+			break;
 		}
-	} while (act->a_opc != AO_DONE);
+		credit = M0_BE_TX_CREDIT(0, 0);
+		act->a_builder = b;
+		rc = act->a_ops->o_prep(act, &credit);
+		if (rc != 0 || ctg_buffer(b, act))
+			continue;
+		if (!builder_act_put(tb, act, &credit))
+			break;
+	}
 	m0_be_tx_bulk_end(tb);
 }
 
@@ -1891,6 +1952,7 @@ static void builder_thread(struct builder *b)
 		rc = m0_be_tx_bulk_status(&tb);
 		m0_be_tx_bulk_fini(&tb);
 	}
+	ctg_load_free(b);
 
 	/**
 	 * Below clean up used as m0_be_ut_backend_fini()  fails because of
@@ -2435,6 +2497,7 @@ static struct cache_slot *cache_insert(struct cache *c,
 	slot->cs_fid   = *fid;
 	slot->cs_flags =  0;
 	slot->cs_tree  =  NULL;
+	slot->cs_load  =  NULL;
 
 	if (++c->c_head == CACHE_SIZE)
 		c->c_head = 0;
@@ -2655,6 +2718,30 @@ static struct m0_cas_ctg *ctg_create_meta(struct ctg_action *ca,
 	return cas_ctg;
 }
 
+/**
+ * Finds the catalogue of @ca. A missing catalogue is created in @tx, unless
+ * @tx is NULL. Called under b_ctglock.
+ */
+static struct m0_cas_ctg *ctg_get(struct ctg_action *ca, struct m0_be_tx *tx)
+{
+	struct m0_cas_ctg *cc;
+	int                rc;
+
+	rc = m0_ctg_meta_find_ctg(m0_ctg_meta(),
+				  &M0_FID_TINIT('T', ca->cta_fid.f_container,
+						ca->cta_fid.f_key),
+				  &cc);
+	if (rc == -ENOENT && tx != NULL) {
+		cc = ctg_create_meta(ca, tx);
+	} else if (rc != 0) {
+		M0_LOG(M0_DEBUG, "Btree not found rc=%d", rc);
+		return NULL;
+	}
+	if (cc != NULL)
+		m0_ctg_try_init(cc);
+	return cc;
+}
+
 static void ctg_act(struct action *act, struct m0_be_tx *tx)
 {
 	struct ctg_action *ca = M0_AMB(ca, act, cta_act);
@@ -2663,22 +2750,9 @@ static void ctg_act(struct action *act, struct m0_be_tx *tx)
 
 	m0_mutex_lock(&beck_builder.b_ctglock);
 	if (ca->cta_slot->cs_tree == NULL) {
-		rc = m0_ctg_meta_find_ctg(m0_ctg_meta(),
-					  &M0_FID_TINIT('T',
-							ca->cta_fid.f_container,
-							ca->cta_fid.f_key),
-					  &cc);
-		if (rc == -ENOENT) {
-			cc = ctg_create_meta(ca, tx);
-		} else if (rc != 0) {
-			M0_LOG(M0_DEBUG, "Btree not found rc=%d", rc);
-			m0_mutex_unlock(&beck_builder.b_ctglock);
-			return;
-		}
-		if (cc != NULL) {
-			m0_ctg_try_init(cc);
+		cc = ctg_get(ca, tx);
+		if (cc != NULL)
 			ca->cta_slot->cs_tree = &cc->cc_tree;
-		}
 	}
 	if (!ca->cta_ismeta && ca->cta_slot->cs_tree != NULL) {
 		rc = M0_BE_OP_SYNC_RET(op,
@@ -2713,6 +2787,276 @@ static const struct action_ops ctg_ops = {
 	.o_fini = &ctg_fini
 };
 
+/**
+ * Buffers a record of a component catalogue for ctg_load_flush().
+ *
+ * Records are recovered in device-scan order, which is not the key order of
+ * the catalogue, so m0_be_btree_load() cannot be used before the whole
+ * segment is scanned. Meta and ctidx records keep incremental insertion:
+ * they create the catalogues, which must exist before their records are
+ * loaded, and there is one such record per catalogue. Cob and emap records
+ * keep it too, see cob_act() and emap_act().
+ *
+ * @retval true  the record is buffered, it is put to tx_bulk later.
+ * @retval false the record goes to tx_bulk as is.
+ */
+static bool ctg_buffer(struct builder *b, struct action *act)
+{
+	struct ctg_action  *ca    = M0_AMB(ca, act, cta_act);
+	struct part_info   *pinfo = &nv_off_info.noi_pinfo;
+	struct ctg_load    *cl;
+	struct ctg_action **rec;
+	uint64_t            alloc;
+
+	if (act->a_opc != AO_CTG || ca->cta_ismeta)
+		return false;
+	cl = ca->cta_slot->cs_load;
+	if (cl == NULL) {
+		/* New catalogue, or its slot was evicted from the cache. */
+		for (cl = b->b_ctg_load;
+		     cl != NULL && !m0_fid_eq(&cl->cl_fid, &ca->cta_fid);
+		     cl = cl->cl_next)
+			;
+		if (cl == NULL) {
+			M0_ALLOC_PTR(cl);
+			M0_ASSERT(cl != NULL); /* Can we handle this? */
+			cl->cl_fid    = ca->cta_fid;
+			cl->cl_next   = b->b_ctg_load;
+			b->b_ctg_load = cl;
+		}
+		ca->cta_slot->cs_load = cl;
+	}
+	if (cl->cl_nr == cl->cl_alloc) {
+		alloc = max64u(2 * cl->cl_alloc, CTG_LOAD_BATCH);
+		M0_ALLOC_ARR(rec, alloc);
+		M0_ASSERT(rec != NULL); /* Can we handle this? */
+		if (cl->cl_nr > 0)
+			memcpy(rec, cl->cl_rec, cl->cl_nr * sizeof rec[0]);
+		m0_free(cl->cl_rec);
+		cl->cl_rec   = rec;
+		cl->cl_alloc = alloc;
+	}
+	cl->cl_rec[cl->cl_nr++] = ca;
+	cl->cl_ksize = max64u(cl->cl_ksize, ca->cta_key.b_nob);
+	cl->cl_vsize = max64u(cl->cl_vsize, ca->cta_val.b_nob);
+	/*
+	 * Buffered records are not in tx_bulk yet. Account them as a single
+	 * incomplete action of AO_CTG_LOAD partition, so that an interrupted
+	 * run is resumed from the first buffered record. ctg_load_flush() drops
+	 * this placeholder.
+	 */
+	if (pinfo->pi_act_added[AO_CTG_LOAD] == 0) {
+		pinfo->pi_act_added[AO_CTG_LOAD] = 1;
+		pinfo->pi_1st_bnode_offset[AO_CTG_LOAD] = act->a_node_offset;
+	}
+	return true;
+}
+
+static int ctg_rec_cmp(const void *a, const void *b)
+{
+	const struct ctg_action *ca0 = *(const struct ctg_action **)a;
+	const struct ctg_action *ca1 = *(const struct ctg_action **)b;
+
+	return m0_ctg_btree_ops()->ko_compare(ca0->cta_key.b_addr,
+					      ca1->cta_key.b_addr) ?:
+		M0_3WAY(ca0->cta_act.a_node_offset, ca1->cta_act.a_node_offset);
+}
+
+/**
+ * Sorts buffered catalogue records and puts them to tx_bulk.
+ *
+ * Duplicate keys are dropped, the record found first is kept. Records with
+ * keys not greater than the maximal key of the catalogue (the catalogue is
+ * not empty when an interrupted run is resumed) go through regular ctg
+ * actions. The rest are loaded by ctg_load actions in AO_CTG_LOAD partition,
+ * CTG_LOAD_BATCH records per transaction. The partition is served by several
+ * workers, so a ctg_load action takes the next records from cl_pos only when
+ * it is executed under b_ctglock, and batches reach m0_be_btree_load() in key
+ * order whatever order the actions are executed in.
+ *
+ * b_ctglock is not held while actions are put: tx_bulk_put() waits for the
+ * workers, which take b_ctglock.
+ */
+static bool ctg_load_flush(struct m0_be_tx_bulk *tb, struct builder *b)
+{
+	const struct m0_be_btree_kv_ops *ops   = m0_ctg_btree_ops();
+	struct part_info                *pinfo = &nv_off_info.noi_pinfo;
+	off_t                            offset;
+	struct ctg_load                 *cl;
+	struct ctg_load_action          *cla;
+	struct ctg_action               *ca;
+	struct m0_cas_ctg               *cc;
+	struct m0_be_tx_credit           credit;
+	struct m0_be_btree               tree = {};
+	struct m0_buf                    max;
+	uint64_t                         nr;
+	uint64_t                         i;
+	bool                             put_successful = true;
+
+	offset = pinfo->pi_1st_bnode_offset[AO_CTG_LOAD];
+	for (cl = b->b_ctg_load; cl != NULL && put_successful;
+	     cl = cl->cl_next) {
+		qsort(cl->cl_rec, cl->cl_nr, sizeof cl->cl_rec[0],
+		      &ctg_rec_cmp);
+		for (nr = 0, i = 0; i < cl->cl_nr; i++) {
+			ca = cl->cl_rec[i];
+			if (nr > 0 &&
+			    ops->ko_compare(cl->cl_rec[nr - 1]->cta_key.b_addr,
+					    ca->cta_key.b_addr) == 0) {
+				M0_LOG(M0_DEBUG, "Duplicate record at offset "
+				       "%"PRId64, (uint64_t)
+				       ca->cta_act.a_node_offset);
+				ctg_fini(&ca->cta_act);
+				m0_free(ca);
+			} else
+				cl->cl_rec[nr++] = ca;
+		}
+		cl->cl_nr = nr;
+
+		m0_mutex_lock(&b->b_ctglock);
+		cc = ctg_get(cl->cl_rec[0], NULL);
+		if (cc != NULL &&
+		    M0_BE_OP_SYNC_RET(op, m0_be_btree_maxkey(&cc->cc_tree,
+							     &op, &max),
+				      bo_u.u_btree.t_rc) == 0) {
+			while (cl->cl_pos < cl->cl_nr &&
+			       ops->ko_compare(cl->cl_rec[cl->cl_pos]->
+					       cta_key.b_addr, max.b_addr) <= 0)
+				cl->cl_pos++;
+		}
+		for (i = 0; i < cl->cl_pos; i++) {
+			ca = cl->cl_rec[i];
+			ca->cta_slot = cache_lookup(&b->b_cache, &ca->cta_fid);
+			if (ca->cta_slot == NULL)
+				ca->cta_slot = cache_insert(&b->b_cache,
+							    &ca->cta_fid);
+		}
+		m0_mutex_unlock(&b->b_ctglock);
+
+		for (i = 0; i < cl->cl_pos && put_successful; i++) {
+			ca = cl->cl_rec[i];
+			cl->cl_rec[i] = NULL;
+			credit = M0_BE_TX_CREDIT(0, 0);
+			m0_be_btree_insert_credit(&tree, 1, ca->cta_key.b_nob,
+						  ca->cta_val.b_nob, &credit);
+			put_successful = builder_act_put(tb, &ca->cta_act,
+							 &credit);
+		}
+		for (i = cl->cl_pos; i < cl->cl_nr && put_successful; i += nr) {
+			nr  = min64u(cl->cl_nr - i, CTG_LOAD_BATCH);
+			cla = builder_action(b, sizeof *cla, AO_CTG_LOAD,
+					     &ctg_load_ops);
+			cla->cla_load = cl;
+			cla->cla_nr   = nr;
+			cla->cla_act.a_node_offset = offset;
+			credit = M0_BE_TX_CREDIT(0, 0);
+			(void)ctg_load_prep(&cla->cla_act, &credit);
+			put_successful = builder_act_put(tb, &cla->cla_act,
+							 &credit);
+		}
+	}
+	if (pinfo->pi_act_added[AO_CTG_LOAD] > 0)
+		pinfo->pi_act_added[AO_CTG_LOAD]--;
+	return put_successful;
+}
+
+static int ctg_load_prep(struct action *act, struct m0_be_tx_credit *accum)
+{
+	struct ctg_load_action *cla  = M0_AMB(cla, act, cla_act);
+	struct ctg_load        *cl   = cla->cla_load;
+	struct m0_be_btree      tree = {};
+
+	/* The action executed first creates a missing catalogue. */
+	m0_ctg_create_credit(accum);
+	m0_ctg_ctidx_insert_credits(&cl->cl_rec[cl->cl_pos]->cta_cid, accum);
+	m0_be_btree_load_credit(&tree, cla->cla_nr, cl->cl_ksize,
+				cl->cl_vsize, accum);
+	return 0;
+}
+
+static void ctg_load_act(struct action *act, struct m0_be_tx *tx)
+{
+	struct ctg_load_action *cla = M0_AMB(cla, act, cla_act);
+	struct ctg_load        *cl  = cla->cla_load;
+	struct ctg_action      *ca;
+	struct m0_cas_ctg      *cc;
+	struct m0_buf          *key;
+	struct m0_buf          *val;
+	uint64_t                i;
+	int                     rc;
+
+	M0_ALLOC_ARR(key, cla->cla_nr);
+	M0_ALLOC_ARR(val, cla->cla_nr);
+	m0_mutex_lock(&beck_builder.b_ctglock);
+	M0_ASSERT(cl->cl_pos + cla->cla_nr <= cl->cl_nr);
+	cla->cla_first = cl->cl_pos;
+	cl->cl_pos += cla->cla_nr;
+	cc = ctg_get(cl->cl_rec[cla->cla_first], tx);
+	if (key == NULL || val == NULL)
+		rc = -ENOMEM;
+	else if (cc == NULL)
+		rc = -ENOENT;
+	else {
+		for (i = 0; i < cla->cla_nr; i++) {
+			ca = cl->cl_rec[cla->cla_first + i];
+			key[i] = ca->cta_key;
+			val[i] = ca->cta_val;
+		}
+		rc = M0_BE_OP_SYNC_RET(op,
+				       m0_be_btree_load(&cc->cc_tree, tx, &op,
+							key, val, cla->cla_nr),
+				       bo_u.u_btree.t_rc);
+		for (i = 0; rc == 0 && i < cla->cla_nr; i++)
+			m0_ctg_state_inc_update(tx, key[i].b_nob -
+						M0_CAS_CTG_KV_HDR_SIZE +
+						val[i].b_nob);
+	}
+	m0_mutex_unlock(&beck_builder.b_ctglock);
+	if (rc != 0)
+		M0_LOG(M0_DEBUG, "Failed to load %"PRIu64" records rc=%d",
+		       cla->cla_nr, rc);
+	m0_free(key);
+	m0_free(val);
+}
+
+static void ctg_load_fini(struct action *act)
+{
+	struct ctg_load_action *cla = M0_AMB(cla, act, cla_act);
+	struct ctg_load        *cl  = cla->cla_load;
+	uint64_t                i;
+
+	for (i = cla->cla_first; i < cla->cla_first + cla->cla_nr; i++) {
+		ctg_fini(&cl->cl_rec[i]->cta_act);
+		m0_free(cl->cl_rec[i]);
+		cl->cl_rec[i] = NULL;
+	}
+}
+
+static const struct action_ops ctg_load_ops = {
+	.o_prep = &ctg_load_prep,
+	.o_act  = &ctg_load_act,
+	.o_fini = &ctg_load_fini
+};
+
+/** Frees buffered catalogue records, which were not loaded. */
+static void ctg_load_free(struct builder *b)
+{
+	struct ctg_load *cl;
+	uint64_t         i;
+
+	while ((cl = b->b_ctg_load) != NULL) {
+		b->b_ctg_load = cl->cl_next;
+		for (i = 0; i < cl->cl_nr; i++) {
+			if (cl->cl_rec[i] != NULL) {
+				ctg_fini(&cl->cl_rec[i]->cta_act);
+				m0_free(cl->cl_rec[i]);
+			}
+		}
+		m0_free(cl->cl_rec);
+		m0_free(cl);
+	}
+}
+
 static bool qinvariant(const struct queue *q)
 {
 	return  _0C((q->q_nr == 0) == (q->q_head == NULL &&
@@ -2971,6 +3315,13 @@ static int cob_prep(struct action *act, struct m0_be_tx_credit *accum)
 /**
  * Inserts the valid cob namespace key and records to cob namepace and object
  * index btree.
+ *
+ * Cob records keep incremental insertion rather than m0_be_btree_load():
+ * m0_cob_name_add() also inserts into the object index, whose key order
+ * differs from the namespace order, and the emap of the stob is updated in
+ * the same transaction. The cob domain itself is created by
+ * m0_cob_domain_mkfs(), which inserts only the root records.
+ *
  * @param[in] act builder action.
  * @param[in] tx  backend transaction.
  */
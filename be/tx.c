@@ -319,6 +319,11 @@ M0_INTERNAL void m0_be_tx_capture(struct m0_be_tx        *tx,
 	be_tx_make_reg_d(tx, &rd, reg);
 	rd.rd_gen_idx = m0_be_reg_gen_idx(reg);
 	m0_be_reg_area_capture(&tx->t_reg_area, &rd);
+	if (rd.rd_reg.br_seg->bs_pg != NULL) {
+		m0_be_seg__pg_capture(rd.rd_reg.br_seg, &rd.rd_reg,
+				      m0_be_engine__tx_capture(tx->t_engine,
+							       tx));
+	}
 }
 
 M0_INTERNAL void
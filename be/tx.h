@@ -389,10 +389,12 @@ struct m0_be_tx {
 	/** @see m0_be_engine::eng_tx_first_capture */
 	struct m0_tlink        t_first_capture_linkage;
 	/**
-	 * Minimal generation index for all captured regions.
+	 * Sequence number of the first capture to a segment with a memory
+	 * budget, 0 if there was no such capture.
 	 *
 	 * This field is set and managed by engine.
 	 */
+	uint64_t               t_first_capture_seq;
 	bool                   t_recovering;
 	/**
 	 * Set by engine when tx is grouped. Prevents the tx from grouping
@@ -26,10 +26,11 @@
 #include "be/alloc.h"
 
 #include "lib/memory.h"         /* m0_addr_is_aligned */
-#include "lib/misc.h"           /* M0_SET_ARR0 */
+#include "lib/misc.h"           /* M0_SET_ARR0, m0_strtou32 */
 #include "lib/thread.h"         /* m0_thread */
 #include "lib/arith.h"          /* m0_rnd64 */
 #include "lib/finject.h"        /* m0_fi_enable_once */
+#include "lib/ub.h"             /* m0_ub_set */
 
 #include "ut/ut.h"              /* M0_UT_ASSERT */
 
@@ -396,6 +397,238 @@ M0_INTERNAL void m0_be_ut_alloc_spare(void)
 	M0_LEAVE();
 }
 
+enum {
+	BE_UT_ALLOC_MAG_SIZE = 0x40,
+	BE_UT_ALLOC_MAG_NR   = 0x10,
+};
+
+static void be_ut_alloc_mag_alloc_free(struct m0_be_allocator *a,
+				       void                  **ptrs,
+				       int                     nr,
+				       bool                    alloc)
+{
+	int i;
+
+	M0_BE_UT_TRANSACT(&be_ut_alloc_backend, tx, cred,
+		(m0_be_allocator_credit(a, alloc ? M0_BAO_ALLOC : M0_BAO_FREE,
+					BE_UT_ALLOC_MAG_SIZE, 0, &cred),
+		 m0_be_tx_credit_mul(&cred, nr)),
+		({
+			for (i = 0; i < nr; ++i) {
+				if (alloc) {
+					M0_BE_OP_SYNC(op,
+					      m0_be_alloc(a, tx, &op, &ptrs[i],
+							  BE_UT_ALLOC_MAG_SIZE));
+					M0_UT_ASSERT(ptrs[i] != NULL);
+				} else {
+					M0_BE_OP_SYNC(op,
+					      m0_be_free(a, tx, &op, ptrs[i]));
+					ptrs[i] = NULL;
+				}
+			}
+		}));
+}
+
+M0_INTERNAL void m0_be_ut_alloc_mag(void)
+{
+	struct m0_be_allocator_stats  before;
+	struct m0_be_allocator_stats  after;
+	struct m0_be_alloc_mag_stats  mbefore;
+	struct m0_be_alloc_mag_stats  mafter;
+	struct m0_be_allocator       *a;
+	struct m0_be_ut_seg           ut_seg;
+	void                         *ptrs[BE_UT_ALLOC_MAG_NR] = {};
+	int                           rc;
+	int                           i;
+
+	m0_be_ut_backend_init(&be_ut_alloc_backend);
+	m0_be_ut_seg_init(&ut_seg, &be_ut_alloc_backend, BE_UT_ALLOC_SEG_SIZE);
+	m0_be_ut_seg_allocator_init(&ut_seg, &be_ut_alloc_backend);
+	a = m0_be_seg_allocator(ut_seg.bus_seg);
+
+	m0_be_alloc_stats(a, &before);
+	m0_be_alloc_mag_stats(a, &mbefore);
+	be_ut_alloc_mag_alloc_free(a, ptrs, ARRAY_SIZE(ptrs), true);
+	m0_be_alloc_stats(a, &after);
+	m0_be_alloc_mag_stats(a, &mafter);
+	/* Every allocation is either a magazine hit or a refill. */
+	M0_UT_ASSERT(mafter.bms_hit_nr + mafter.bms_miss_nr -
+		     mbefore.bms_hit_nr - mbefore.bms_miss_nr ==
+		     ARRAY_SIZE(ptrs));
+	M0_UT_ASSERT(mafter.bms_hit_nr > mbefore.bms_hit_nr);
+	M0_UT_ASSERT(after.bas_total.bacs_alloc_success.bcs_nr -
+		     before.bas_total.bacs_alloc_success.bcs_nr ==
+		     ARRAY_SIZE(ptrs));
+	for (i = 0; i < ARRAY_SIZE(ptrs); ++i) {
+		M0_UT_ASSERT(m0_forall(j, i, ptrs[j] != ptrs[i]));
+		M0_UT_ASSERT(m0_addr_is_aligned(ptrs[i],
+						M0_BE_ALLOC_SHIFT_MIN));
+	}
+
+	be_ut_alloc_mag_alloc_free(a, ptrs, ARRAY_SIZE(ptrs), false);
+	m0_be_alloc_stats(a, &after);
+	m0_be_alloc_mag_stats(a, &mafter);
+	M0_UT_ASSERT(after.bas_total.bacs_free.bcs_nr -
+		     before.bas_total.bacs_free.bcs_nr == ARRAY_SIZE(ptrs));
+	/* Freed chunks are cached, not returned to the free lists. */
+	M0_UT_ASSERT(mafter.bms_space_cached > 0);
+	M0_UT_ASSERT(after.bas_space_used - mafter.bms_space_cached ==
+		     before.bas_space_used - mbefore.bms_space_cached);
+
+	/* Cached chunks are found in the segment after allocator restart. */
+	m0_be_allocator_fini(a);
+	rc = m0_be_allocator_init(a, ut_seg.bus_seg);
+	M0_UT_ASSERT(rc == 0);
+	/* Magazine statistics are volatile. */
+	m0_be_alloc_mag_stats(a, &mbefore);
+	M0_UT_ASSERT(mbefore.bms_hit_nr == 0 && mbefore.bms_miss_nr == 0);
+	be_ut_alloc_mag_alloc_free(a, ptrs, ARRAY_SIZE(ptrs), true);
+	be_ut_alloc_mag_alloc_free(a, ptrs, ARRAY_SIZE(ptrs), false);
+
+	/* Destroy drains magazines, otherwise it fails on the chunks list. */
+	m0_be_ut_seg_allocator_fini(&ut_seg, &be_ut_alloc_backend);
+	m0_be_ut_seg_fini(&ut_seg);
+	m0_be_ut_backend_fini(&be_ut_alloc_backend);
+	M0_SET0(&be_ut_alloc_backend);
+}
+
+/*
+ * Segment without magazine table, as created before magazines were added:
+ * the allocator header layout is the same, allocations bypass magazines.
+ */
+M0_INTERNAL void m0_be_ut_alloc_mag_notab(void)
+{
+	struct m0_be_allocator_stats  before;
+	struct m0_be_allocator_stats  after;
+	struct m0_be_alloc_mag_stats  mstats;
+	struct m0_be_allocator       *a;
+	struct m0_be_ut_seg           ut_seg;
+	void                         *ptrs[BE_UT_ALLOC_MAG_NR] = {};
+	int                           rc;
+
+	m0_be_ut_backend_init(&be_ut_alloc_backend);
+	m0_be_ut_seg_init(&ut_seg, &be_ut_alloc_backend, BE_UT_ALLOC_SEG_SIZE);
+	m0_fi_enable_once("be_alloc_mag_create", "no_tab");
+	m0_be_ut_seg_allocator_init(&ut_seg, &be_ut_alloc_backend);
+	a = m0_be_seg_allocator(ut_seg.bus_seg);
+	m0_be_allocator_fini(a);
+	rc = m0_be_allocator_init(a, ut_seg.bus_seg);
+	M0_UT_ASSERT(rc == 0);
+
+	m0_be_alloc_stats(a, &before);
+	be_ut_alloc_mag_alloc_free(a, ptrs, ARRAY_SIZE(ptrs), true);
+	be_ut_alloc_mag_alloc_free(a, ptrs, ARRAY_SIZE(ptrs), false);
+	m0_be_alloc_stats(a, &after);
+	m0_be_alloc_mag_stats(a, &mstats);
+	M0_UT_ASSERT(mstats.bms_hit_nr == 0 && mstats.bms_miss_nr == 0 &&
+		     mstats.bms_space_cached == 0);
+	M0_UT_ASSERT(after.bas_total.bacs_alloc_success.bcs_nr -
+		     before.bas_total.bacs_alloc_success.bcs_nr ==
+		     ARRAY_SIZE(ptrs));
+	M0_UT_ASSERT(after.bas_space_used == before.bas_space_used);
+
+	m0_be_ut_seg_allocator_fini(&ut_seg, &be_ut_alloc_backend);
+	m0_be_ut_seg_fini(&ut_seg);
+	m0_be_ut_backend_fini(&be_ut_alloc_backend);
+	M0_SET0(&be_ut_alloc_backend);
+}
+
+enum {
+	BE_UB_ALLOC_THR_NR = 0x8,
+	BE_UB_ALLOC_OP_NR  = 0x40,
+	BE_UB_ALLOC_ITER   = 0x20,
+	BE_UB_ALLOC_SEG    = 1 << 24,
+};
+
+static struct m0_be_ut_seg be_ub_alloc_seg;
+static int                 be_ub_alloc_thr_nr = BE_UB_ALLOC_THR_NR;
+
+static void be_ub_alloc_thread(int index)
+{
+	struct m0_be_allocator *a = m0_be_seg_allocator(be_ub_alloc_seg.bus_seg);
+	void                   *ptrs[BE_UB_ALLOC_OP_NR];
+	uint64_t                seed = index;
+	m0_bcount_t             size;
+	int                     i;
+
+	/* Two most popular sizes, similar to btree nodes and CAS records. */
+	size = m0_rnd64(&seed) % 2 == 0 ? 0x40 : 0x100;
+	M0_BE_UT_TRANSACT(&be_ut_alloc_backend, tx, cred,
+		(m0_be_allocator_credit(a, M0_BAO_ALLOC, size, 0, &cred),
+		 m0_be_allocator_credit(a, M0_BAO_FREE, size, 0, &cred),
+		 m0_be_tx_credit_mul(&cred, BE_UB_ALLOC_OP_NR)),
+		({
+			for (i = 0; i < BE_UB_ALLOC_OP_NR; ++i)
+				M0_BE_OP_SYNC(op, m0_be_alloc(a, tx, &op,
+							      &ptrs[i], size));
+			for (i = 0; i < BE_UB_ALLOC_OP_NR; ++i)
+				M0_BE_OP_SYNC(op, m0_be_free(a, tx, &op,
+							     ptrs[i]));
+		}));
+	m0_be_ut_backend_thread_exit(&be_ut_alloc_backend);
+}
+
+static void be_ub_alloc_round(int iter)
+{
+	struct m0_thread *thr;
+	int               rc;
+	int               i;
+
+	M0_ALLOC_ARR(thr, be_ub_alloc_thr_nr);
+	M0_UB_ASSERT(thr != NULL);
+	for (i = 0; i < be_ub_alloc_thr_nr; ++i) {
+		rc = M0_THREAD_INIT(&thr[i], int, NULL, &be_ub_alloc_thread, i,
+				    "be_ub_alloc%d", i);
+		M0_UB_ASSERT(rc == 0);
+	}
+	for (i = 0; i < be_ub_alloc_thr_nr; ++i) {
+		m0_thread_join(&thr[i]);
+		m0_thread_fini(&thr[i]);
+	}
+	m0_free(thr);
+}
+
+static int be_ub_alloc_init(const char *opts)
+{
+	if (opts != NULL)
+		be_ub_alloc_thr_nr = max32(m0_strtou32(opts, NULL, 10), 1);
+	m0_be_ut_backend_init(&be_ut_alloc_backend);
+	m0_be_ut_seg_init(&be_ub_alloc_seg, &be_ut_alloc_backend,
+			  BE_UB_ALLOC_SEG);
+	m0_be_ut_seg_allocator_init(&be_ub_alloc_seg, &be_ut_alloc_backend);
+	return 0;
+}
+
+static void be_ub_alloc_fini(void)
+{
+	struct m0_be_alloc_mag_stats stats;
+
+	m0_be_alloc_mag_stats(m0_be_seg_allocator(be_ub_alloc_seg.bus_seg),
+			      &stats);
+	M0_LOG(M0_ALWAYS, "threads=%d mag_hit=%"PRIu64" mag_miss=%"PRIu64,
+	       be_ub_alloc_thr_nr, stats.bms_hit_nr, stats.bms_miss_nr);
+	m0_be_ut_seg_allocator_fini(&be_ub_alloc_seg, &be_ut_alloc_backend);
+	m0_be_ut_seg_fini(&be_ub_alloc_seg);
+	m0_be_ut_backend_fini(&be_ut_alloc_backend);
+	M0_SET0(&be_ut_alloc_backend);
+}
+
+/**
+ * Multi-threaded alloc/free throughput.
+ * Number of threads can be given via `-o', e.g. "m0ub -t be-alloc-ub -o 32".
+ */
+struct m0_ub_set m0_be_alloc_ub = {
+	.us_name = "be-alloc-ub",
+	.us_init = be_ub_alloc_init,
+	.us_fini = be_ub_alloc_fini,
+	.us_run  = {
+		{ .ub_name  = "alloc-free",
+		  .ub_iter  = BE_UB_ALLOC_ITER,
+		  .ub_round = be_ub_alloc_round },
+
+		{ .ub_name = NULL }
+	}
+};
 
 #undef M0_TRACE_SUBSYSTEM
 
@@ -25,6 +25,7 @@
 
 #include "be/tx_group_fom.h"
 #include "be/btree.h"
+#include "be/btree_internal.h" /* m0_be_bnode */
 #include "lib/types.h"     /* m0_uint128_eq */
 #include "lib/misc.h"      /* M0_BITS, M0_IN */
 #include "lib/memory.h"    /* M0_ALLOC_PTR */
@@ -63,6 +64,8 @@ enum {
 	INSERT_KSIZE  = 7,
 	INSERT_VSIZE  = 11,
 	TXN_OPS_NR = 7,
+	/* Enough for the second level of non-leaf nodes. */
+	LOAD_COUNT = 4 * BTREE_FAN_OUT * BTREE_FAN_OUT + 1000,
 };
 
 static void check(struct m0_be_btree *tree);
@@ -138,6 +141,47 @@ void m0_be_ut_btree_create_destroy(void)
 	M0_LEAVE();
 }
 
+static int btree_load(struct m0_be_btree *t, int from, int nr)
+{
+	struct m0_be_tx_credit  cred = {};
+	struct m0_be_tx        *tx;
+	struct m0_be_op         op = {};
+	struct m0_buf          *key;
+	struct m0_buf          *val;
+	char                   *kv;
+	char                   *k;
+	int                     i;
+	int                     rc;
+
+	M0_ALLOC_ARR(key, nr);
+	M0_ALLOC_ARR(val, nr);
+	M0_ALLOC_ARR(kv, nr * (INSERT_KSIZE + INSERT_VSIZE));
+	M0_ALLOC_PTR(tx);
+	M0_UT_ASSERT(key != NULL && val != NULL && kv != NULL && tx != NULL);
+	for (i = 0; i < nr; ++i) {
+		k = kv + i * (INSERT_KSIZE + INSERT_VSIZE);
+		sprintf(k, "%0*d", INSERT_KSIZE - 1, from + i);
+		sprintf(k + INSERT_KSIZE, "%0*d", INSERT_VSIZE - 1, from + i);
+		m0_buf_init(&key[i], k, INSERT_KSIZE);
+		m0_buf_init(&val[i], k + INSERT_KSIZE, INSERT_VSIZE);
+	}
+	m0_be_btree_load_credit(t, nr, INSERT_KSIZE, INSERT_VSIZE, &cred);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_UT_ASSERT(rc == 0);
+	rc = M0_BE_OP_SYNC_RET_WITH(&op,
+				    m0_be_btree_load(t, tx, &op, key, val, nr),
+				    bo_u.u_btree.t_rc);
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+	m0_free(tx);
+	m0_free(kv);
+	m0_free(val);
+	m0_free(key);
+	return rc;
+}
+
 static int
 btree_insert(struct m0_be_btree *t, struct m0_buf *k, struct m0_buf *v,
 	     int nr_left)
@@ -176,6 +220,98 @@ btree_insert(struct m0_be_btree *t, struct m0_buf *k, struct m0_buf *v,
 	return M0_RC(rc);
 }
 
+void m0_be_ut_btree_load(void)
+{
+	static const int           batch[] = { 1, BTREE_FAN_OUT - 1, 7,
+					       3 * BTREE_FAN_OUT + 1 };
+	static struct m0_be_btree_cursor *cursor;
+	struct m0_be_tx_credit     cred = {};
+	struct m0_be_btree        *tree;
+	struct m0_be_tx           *tx;
+	struct m0_be_op            op = {};
+	struct m0_buf              key;
+	struct m0_buf              val;
+	char                       k[INSERT_KSIZE];
+	char                       v[INSERT_VSIZE];
+	int                        nr;
+	int                        i;
+	int                        j;
+	int                        rc;
+
+	M0_ALLOC_PTR(ut_be);
+	M0_ALLOC_PTR(ut_seg);
+	M0_ALLOC_PTR(tx);
+	M0_ALLOC_PTR(cursor);
+	M0_UT_ASSERT(ut_be != NULL && ut_seg != NULL && tx != NULL &&
+		     cursor != NULL);
+	m0_be_ut_backend_init(ut_be);
+	m0_be_ut_seg_init(ut_seg, ut_be, 1ULL << 24);
+	seg = ut_seg->bus_seg;
+
+	{
+		struct m0_be_btree t = { .bb_seg = seg };
+		m0_be_btree_create_credit(&t, 1, &cred);
+	}
+	M0_BE_ALLOC_CREDIT_PTR(tree, seg, &cred);
+	m0_be_ut_tx_init(tx, ut_be);
+	m0_be_tx_prep(tx, &cred);
+	rc = m0_be_tx_open_sync(tx);
+	M0_UT_ASSERT(rc == 0);
+	M0_BE_ALLOC_PTR_SYNC(tree, seg, tx);
+	m0_be_btree_init(tree, seg, &kv_ops);
+	M0_BE_OP_SYNC_WITH(&op,
+		   m0_be_btree_create(tree, tx, &op, &M0_FID_TINIT('b', 0, 2)));
+	m0_be_tx_close_sync(tx);
+	m0_be_tx_fini(tx);
+	m0_free(tx);
+
+	M0_LOG(M0_INFO, "Loading...");
+	for (i = 0, j = 0; i < LOAD_COUNT; i += nr, ++j) {
+		nr = min_check(batch[j % ARRAY_SIZE(batch)], LOAD_COUNT - i);
+		rc = btree_load(tree, i, nr);
+		M0_UT_ASSERT(rc == 0);
+	}
+	/* Keys not above the maximum are rejected. */
+	rc = btree_load(tree, LOAD_COUNT - 1, 2);
+	M0_UT_ASSERT(rc == -EINVAL);
+	rc = btree_load(tree, 0, 1);
+	M0_UT_ASSERT(rc == -EINVAL);
+
+	m0_be_ut_seg_reload(ut_seg);
+	m0_be_btree_init(tree, seg, &kv_ops);
+	M0_UT_ASSERT(tree->bb_root->bt_level == 2);
+
+	m0_be_btree_cursor_init(cursor, tree);
+	rc = m0_be_btree_cursor_first_sync(cursor);
+	for (i = 0; rc == 0; ++i) {
+		m0_be_btree_cursor_kv_get(cursor, &key, &val);
+		sprintf(k, "%0*d", INSERT_KSIZE - 1, i);
+		sprintf(v, "%0*d", INSERT_VSIZE - 1, i);
+		M0_UT_ASSERT(strcmp(key.b_addr, k) == 0);
+		M0_UT_ASSERT(strcmp(val.b_addr, v) == 0);
+		rc = m0_be_btree_cursor_next_sync(cursor);
+	}
+	M0_UT_ASSERT(rc == -ENOENT);
+	M0_UT_ASSERT(i == LOAD_COUNT);
+	m0_be_btree_cursor_fini(cursor);
+	m0_free(cursor);
+
+	/* Regular insertion works on the loaded tree. */
+	sprintf(k, "%0*d", INSERT_KSIZE - 1, LOAD_COUNT);
+	sprintf(v, "%0*d", INSERT_VSIZE - 1, LOAD_COUNT);
+	m0_buf_init(&key, k, INSERT_KSIZE);
+	m0_buf_init(&val, v, INSERT_VSIZE);
+	rc = btree_insert(tree, &key, &val, 0);
+	M0_UT_ASSERT(rc == 0);
+
+	/* The tree goes away with the segment. */
+	m0_be_btree_fini(tree);
+	m0_be_ut_seg_fini(ut_seg);
+	m0_be_ut_backend_fini(ut_be);
+	m0_free(ut_seg);
+	m0_free(ut_be);
+}
+
 static int
 btree_insert_inplace(struct m0_be_btree *t, struct m0_buf *k, int v,
 		     int nr_left)
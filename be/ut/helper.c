@@ -335,6 +335,12 @@ void m0_be_ut_backend_cfg_default(struct m0_be_domain_cfg *cfg)
 		.bc_seg_nr		   = 0,
 		.bc_pd_cfg = {
 			.bpdc_seg_io_nr = 0x2,
+			.bpdc_sched = {
+				.bisc_batch_max          = 0x8,
+				.bisc_batch_inflight_max = 0x2,
+				.bisc_batch_io_credit    =
+					M0_BE_IO_CREDIT(1 << 16, 1 << 28, 0x10),
+			},
 		},
 		.bc_log_discard_cfg = {
 			.ldsc_items_max         = 0x100,
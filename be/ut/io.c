@@ -20,10 +20,108 @@
  */
 
 
+#include "be/io.h"
+
+#include "lib/misc.h"   /* ARRAY_SIZE */
+#include "ut/ut.h"      /* M0_UT_ASSERT */
+
 void m0_be_ut_io(void)
 {
 }
 
+enum {
+	BE_UT_IO_MERGE_REG_NR = 0x10,
+	BE_UT_IO_MERGE_SIZE   = 0x40,
+};
+
+void m0_be_ut_io_merge(void)
+{
+	static char            mem[3][BE_UT_IO_MERGE_SIZE];
+	struct m0_be_io_credit cred = M0_BE_IO_CREDIT(BE_UT_IO_MERGE_REG_NR,
+						      BE_UT_IO_MERGE_SIZE, 1);
+	struct m0_be_io_merge  bim;
+	struct m0_be_io        src[3];
+	struct m0_be_io       *srcp[3] = { &src[0], &src[1], &src[2] };
+	struct m0_be_io        dst;
+	struct m0_be_io        other;
+	struct m0_stob_io     *sio;
+	uint64_t               nr;
+	int                    rc;
+	int                    i;
+	/* stob offset, size and expected user buffer of the merged regions */
+	const struct {
+		m0_bindex_t  offset;
+		m0_bcount_t  size;
+		char        *ptr;
+	} exp[] = {
+		{ .offset = 0,  .size = 5,  .ptr = &mem[0][0]  },
+		{ .offset = 5,  .size = 3,  .ptr = &mem[1][0]  },
+		{ .offset = 8,  .size = 1,  .ptr = &mem[2][0]  },
+		{ .offset = 9,  .size = 6,  .ptr = &mem[1][4]  },
+		{ .offset = 20, .size = 10, .ptr = &mem[0][10] },
+	};
+
+	rc = m0_be_io_merge_init(&bim, BE_UT_IO_MERGE_REG_NR);
+	M0_UT_ASSERT(rc == 0);
+	for (i = 0; i < ARRAY_SIZE(src); ++i) {
+		rc = m0_be_io_init(&src[i]) ?: m0_be_io_allocate(&src[i], &cred);
+		M0_UT_ASSERT(rc == 0);
+	}
+	rc = m0_be_io_init(&dst) ?: m0_be_io_allocate(&dst, &cred);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_be_io_init(&other) ?: m0_be_io_allocate(&other, &cred);
+	M0_UT_ASSERT(rc == 0);
+
+	/* the later I/O overrides the earlier ones where they overlap */
+	m0_be_io_add_nostob(&src[0], &mem[0][0],  0,  10);
+	m0_be_io_add_nostob(&src[0], &mem[0][10], 20, 10);
+	m0_be_io_add_nostob(&src[1], &mem[1][0],  5,  10);
+	m0_be_io_add_nostob(&src[2], &mem[2][0],  8,  1);
+	nr = m0_be_io_merge(&bim, &dst, srcp, ARRAY_SIZE(srcp));
+	M0_UT_ASSERT(nr == 4);
+	M0_UT_ASSERT(dst.bio_stob_nr == 1);
+	sio = &dst.bio_part[0].bip_sio;
+	M0_UT_ASSERT(sio->si_stob.iv_vec.v_nr == ARRAY_SIZE(exp));
+	for (i = 0; i < ARRAY_SIZE(exp); ++i) {
+		M0_UT_ASSERT(sio->si_stob.iv_index[i] == exp[i].offset);
+		M0_UT_ASSERT(sio->si_stob.iv_vec.v_count[i] == exp[i].size);
+		M0_UT_ASSERT(sio->si_user.ov_buf[i] == exp[i].ptr);
+	}
+	M0_UT_ASSERT(m0_be_io_size(&dst) == 25);
+
+	/* the gap between the regions doesn't intersect */
+	m0_be_io_add_nostob(&other, &mem[2][0], 15, 5);
+	M0_UT_ASSERT(!m0_be_io_merged_intersect(&dst, &other));
+	m0_be_io_add_nostob(&other, &mem[2][5], 29, 1);
+	M0_UT_ASSERT(m0_be_io_merged_intersect(&dst, &other));
+	M0_UT_ASSERT(m0_be_io_merged_intersect(&other, &dst));
+
+	/* adjacent regions are coalesced */
+	m0_be_io_reset(&dst);
+	for (i = 0; i < ARRAY_SIZE(src); ++i)
+		m0_be_io_reset(&src[i]);
+	m0_be_io_add_nostob(&src[0], &mem[0][0], 0, 10);
+	m0_be_io_add_nostob(&src[1], &mem[0][5], 5, 10);
+	m0_be_io_add_nostob(&src[2], &mem[0][9], 9, 1);
+	nr = m0_be_io_merge(&bim, &dst, srcp, ARRAY_SIZE(srcp));
+	M0_UT_ASSERT(nr == 3);
+	sio = &dst.bio_part[0].bip_sio;
+	M0_UT_ASSERT(sio->si_stob.iv_vec.v_nr == 1);
+	M0_UT_ASSERT(sio->si_stob.iv_index[0] == 0);
+	M0_UT_ASSERT(sio->si_stob.iv_vec.v_count[0] == 15);
+	M0_UT_ASSERT(sio->si_user.ov_buf[0] == &mem[0][0]);
+
+	m0_be_io_deallocate(&other);
+	m0_be_io_fini(&other);
+	m0_be_io_deallocate(&dst);
+	m0_be_io_fini(&dst);
+	for (i = 0; i < ARRAY_SIZE(src); ++i) {
+		m0_be_io_deallocate(&src[i]);
+		m0_be_io_fini(&src[i]);
+	}
+	m0_be_io_merge_fini(&bim);
+}
+
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
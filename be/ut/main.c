@@ -65,6 +65,7 @@ extern void m0_be_ut_fmt_group_size_max(void);
 extern void m0_be_ut_fmt_group_size_max_rnd(void);
 
 extern void m0_be_ut_io(void);
+extern void m0_be_ut_io_merge(void);
 extern void m0_be_ut_io_sched(void);
 
 extern void m0_be_ut_log_store_create_simple(void);
@@ -88,12 +89,15 @@ extern void m0_be_ut_log_multi(void);
 extern void m0_be_ut_recovery(void);
 
 extern void m0_be_ut_pd_usecase(void);
+extern void m0_be_ut_pd_usecase_batch(void);
 
 extern void m0_be_ut_seg_open_close(void);
 extern void m0_be_ut_seg_io(void);
 extern void m0_be_ut_seg_multiple(void);
 extern void m0_be_ut_seg_large(void);
 extern void m0_be_ut_seg_large_multiple(void);
+extern void m0_be_ut_seg_pg(void);
+extern void m0_be_ut_seg_warmup(void);
 
 extern void m0_be_ut_group_format(void);
 
@@ -140,10 +144,13 @@ extern void m0_be_ut_alloc_concurrent(void);
 extern void m0_be_ut_alloc_oom(void);
 extern void m0_be_ut_alloc_info(void);
 extern void m0_be_ut_alloc_spare(void);
+extern void m0_be_ut_alloc_mag(void);
+extern void m0_be_ut_alloc_mag_notab(void);
 
 extern void m0_be_ut_list(void);
 extern void m0_be_ut_btree_create_destroy(void);
 extern void m0_be_ut_btree_create_truncate(void);
+extern void m0_be_ut_btree_load(void);
 extern void m0_be_ut_emap(void);
 extern void m0_be_ut_seg_dict(void);
 extern void m0_be_ut_seg0_test(void);
@@ -196,6 +203,7 @@ struct m0_ut_suite be_ut = {
 		{ "fmt-group_size_max",      m0_be_ut_fmt_group_size_max      },
 		{ "fmt-group_size_max_rnd",  m0_be_ut_fmt_group_size_max_rnd  },
 		{ "io-noop",                 m0_be_ut_io                      },
+		{ "io-merge",                m0_be_ut_io_merge                },
 		{ "io_sched",                m0_be_ut_io_sched                },
 		{ "log_store-create_simple", m0_be_ut_log_store_create_simple },
 		{ "log_store-create_random", m0_be_ut_log_store_create_random },
@@ -215,11 +223,14 @@ struct m0_ut_suite be_ut = {
 */
 		{ "recovery",                m0_be_ut_recovery                },
 		{ "pd-usecase",              m0_be_ut_pd_usecase              },
+		{ "pd-usecase-batch",        m0_be_ut_pd_usecase_batch        },
 		{ "seg-open",                m0_be_ut_seg_open_close          },
 		{ "seg-io",                  m0_be_ut_seg_io                  },
 		{ "seg-multiple",            m0_be_ut_seg_multiple            },
 		{ "seg-large",               m0_be_ut_seg_large               },
 		{ "seg-large-multiple",      m0_be_ut_seg_large_multiple      },
+		{ "seg-pg",                  m0_be_ut_seg_pg                  },
+		{ "seg-warmup",              m0_be_ut_seg_warmup              },
 		{ "group_format",            m0_be_ut_group_format            },
 		{ "mkfs",                    m0_be_ut_mkfs                    },
 		{ "mkfs-multiseg",           m0_be_ut_mkfs_multiseg           },
@@ -260,12 +271,15 @@ struct m0_ut_suite be_ut = {
 		{ "alloc-oom",               m0_be_ut_alloc_oom               },
 		{ "alloc-info",              m0_be_ut_alloc_info              },
 		{ "alloc-spare",             m0_be_ut_alloc_spare             },
+		{ "alloc-mag",               m0_be_ut_alloc_mag               },
+		{ "alloc-mag-notab",         m0_be_ut_alloc_mag_notab         },
 		{ "obj",                     m0_be_ut_obj_test                },
 		{ "actrec",                  m0_be_ut_actrec_test             },
 #endif /* __KERNEL__ */
 		{ "list",                    m0_be_ut_list                    },
 		{ "btree-create_destroy",    m0_be_ut_btree_create_destroy    },
 		{ "btree-create_truncate",   m0_be_ut_btree_create_truncate   },
+		{ "btree-load",              m0_be_ut_btree_load              },
 		{ "seg_dict",                m0_be_ut_seg_dict                },
 #ifndef __KERNEL__
 		{ "seg0",                    m0_be_ut_seg0_test               },
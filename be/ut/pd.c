@@ -49,6 +49,7 @@ enum {
 	BE_UT_PD_USECASE_REG_NR    = 0x10,
 	BE_UT_PD_USECASE_THREAD_NR = 0x10,
 	BE_UT_PD_USECASE_ITER_NR   = 0x10,
+	BE_UT_PD_USECASE_BATCH_MAX = 0x8,
 };
 
 struct be_ut_pd_usecase_test {
@@ -89,7 +90,13 @@ static void be_ut_pd_usecase_thread(void *param)
 		for (i = 0; i < test->bput_pd_io_nr; ++i) {
 			bio = m0_be_pd_io_be_io(pdio[i]);
 			for (j = 0; j < test->bput_pd_reg_nr; ++j) {
-				offset = (i * test->bput_pd_reg_nr + j) * 2;
+				/*
+				 * Writers overwrite the same regions, so
+				 * every merged batch drops some of them.
+				 */
+				offset = test->bput_read ?
+					 i * test->bput_pd_reg_nr : 0;
+				offset = (offset + j) * 2;
 				m0_be_io_add(bio, test->bput_stob,
 				             &mem[offset], offset, 1);
 			}
@@ -116,11 +123,20 @@ static void be_ut_pd_usecase_thread(void *param)
 
 M0_UT_THREADS_DEFINE(be_ut_pd_usecase, &be_ut_pd_usecase_thread);
 
-void m0_be_ut_pd_usecase(void)
+static void be_ut_pd_usecase(bool batch)
 {
 	struct m0_be_pd_cfg           pd_cfg = {
 		.bpdc_sched = {
-			.bisc_pos_start = BE_UT_PD_USECASE_POS_START,
+			.bisc_pos_start          = BE_UT_PD_USECASE_POS_START,
+			.bisc_batch_max          =
+				batch ? BE_UT_PD_USECASE_BATCH_MAX : 0,
+			.bisc_batch_inflight_max = 2,
+			.bisc_batch_io_credit    = M0_BE_IO_CREDIT(
+				2 * BE_UT_PD_USECASE_BATCH_MAX *
+				BE_UT_PD_USECASE_REG_NR,
+				BE_UT_PD_USECASE_BATCH_MAX *
+				BE_UT_PD_USECASE_REG_NR,
+				BE_UT_PD_USECASE_BATCH_MAX),
 		},
 		.bpdc_seg_io_nr = BE_UT_PD_USECASE_PD_IO_NR * 2 *
 				  BE_UT_PD_USECASE_THREAD_NR,
@@ -162,12 +178,33 @@ void m0_be_ut_pd_usecase(void)
 			    tests);
 	M0_UT_THREADS_STOP(be_ut_pd_usecase);
 
+	if (batch) {
+		M0_UT_ASSERT(pd->bpd_sched.bis_stats.biss_io_nr ==
+			     BE_UT_PD_USECASE_THREAD_NR * 2 *
+			     BE_UT_PD_USECASE_ITER_NR *
+			     BE_UT_PD_USECASE_PD_IO_NR);
+		M0_UT_ASSERT(pd->bpd_sched.bis_stats.biss_size_out <=
+			     pd->bpd_sched.bis_stats.biss_size_in);
+		M0_UT_ASSERT(pd->bpd_sched.bis_stats.biss_batch_nr > 0);
+		M0_UT_ASSERT(pd->bpd_sched.bis_stats.biss_reg_out <
+			     pd->bpd_sched.bis_stats.biss_reg_in);
+	}
 	m0_be_pd_fini(pd);
 	m0_free(tests);
 	m0_free(pd);
 	m0_ut_stob_put(stob, true);
 }
 
+void m0_be_ut_pd_usecase(void)
+{
+	be_ut_pd_usecase(false);
+}
+
+void m0_be_ut_pd_usecase_batch(void)
+{
+	be_ut_pd_usecase(true);
+}
+
 
 #undef M0_TRACE_SUBSYSTEM
 
@@ -422,6 +422,113 @@ void m0_be_ut_seg_large_multiple(void)
 	m0_ut_stob_put(stob, true);
 }
 
+enum {
+	BE_UT_SEG_PG_SHIFT  = 16,
+	BE_UT_SEG_PG_NR     = 16,
+	BE_UT_SEG_PG_BUDGET = 4,
+};
+
+void m0_be_ut_seg_pg(void)
+{
+	struct m0_be_ut_seg ut_seg;
+	struct m0_be_seg   *seg;
+	struct m0_be_reg    reg;
+	m0_bcount_t         pg_size = 1ULL << BE_UT_SEG_PG_SHIFT;
+	m0_bcount_t         size;
+	char               *addr;
+	char               *data;
+	uint64_t            clean = 0;
+	uint64_t            i;
+	int                 rc;
+
+	m0_be_ut_seg_init(&ut_seg, NULL, BE_UT_SEG_PG_NR * pg_size);
+	seg = ut_seg.bus_seg;
+	m0_be_seg_close(seg);
+	seg->bs_pg_budget = BE_UT_SEG_PG_BUDGET * pg_size;
+	seg->bs_pg_shift  = BE_UT_SEG_PG_SHIFT;
+	rc = m0_be_seg_open(seg);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(seg->bs_pg != NULL);
+	M0_UT_ASSERT(seg->bs_pg_nr == BE_UT_SEG_PG_NR);
+
+	/* The first page holds the segment header, leave it alone. */
+	addr = seg->bs_addr + pg_size;
+	size = (BE_UT_SEG_PG_NR - 1) * pg_size;
+	data = m0_alloc(size);
+	M0_UT_ASSERT(data != NULL);
+	for (i = 0; i < size; ++i)
+		data[i] = i % 251;
+	/* Write every page as a transaction would and place it. */
+	for (i = 0; i < BE_UT_SEG_PG_NR - 1; ++i) {
+		reg = M0_BE_REG(seg, pg_size, addr + i * pg_size);
+		memcpy(reg.br_addr, data + i * pg_size, pg_size);
+		m0_be_seg__pg_capture(seg, &reg, ++clean);
+		rc = m0_be_seg__write(&reg, reg.br_addr);
+		M0_UT_ASSERT(rc == 0);
+	}
+	m0_be_seg_pin(seg, addr, 1);
+
+	/* Pages captured since the previous scan are not dropped. */
+	M0_UT_ASSERT(!m0_be_seg__pg_scan(seg, clean));
+	M0_UT_ASSERT(seg->bs_pg_resident == size);
+	M0_UT_ASSERT(seg->bs_pg_marked == 0);
+	M0_UT_ASSERT(m0_be_seg__pg_scan(seg, clean));
+	M0_UT_ASSERT(m0_be_seg__pg_over(seg));
+	M0_UT_ASSERT(seg->bs_pg_marked == BE_UT_SEG_PG_NR - 2);
+
+	/* Pages which are not placed yet are not dropped. */
+	m0_be_seg__pg_evict(seg, 0);
+	M0_UT_ASSERT(seg->bs_pg_evicted == 0);
+	M0_UT_ASSERT(seg->bs_pg_resident == size);
+
+	M0_UT_ASSERT(m0_be_seg__pg_scan(seg, clean));
+	m0_be_seg__pg_evict(seg, clean);
+	M0_UT_ASSERT(seg->bs_pg_evicted > 0);
+	M0_UT_ASSERT(seg->bs_pg_resident <= seg->bs_pg_budget);
+	M0_UT_ASSERT(seg->bs_pg[1].sp_private);
+	M0_UT_ASSERT(!m0_be_seg__pg_over(seg));
+
+	/* Dropped pages are read again from the stob. */
+	M0_UT_ASSERT(memcmp(addr, data, size) == 0);
+
+	m0_be_seg_unpin(seg, addr, 1);
+	m0_free(data);
+	m0_be_ut_seg_fini(&ut_seg);
+}
+
+void m0_be_ut_seg_warmup(void)
+{
+	struct m0_be_ut_seg ut_seg;
+	struct m0_be_seg   *seg;
+	struct m0_be_reg    reg;
+	m0_bcount_t         size = 4 * M0_BE_SEG_WARMUP_CHUNK;
+	char               *data;
+	uint64_t            i;
+	int                 rc;
+
+	m0_be_ut_seg_init(&ut_seg, NULL, size);
+	seg = ut_seg.bus_seg;
+	/* Skip the segment header. */
+	reg = M0_BE_REG(seg, size / 2, seg->bs_addr + size / 4);
+	data = m0_alloc(reg.br_size);
+	M0_UT_ASSERT(data != NULL);
+	for (i = 0; i < reg.br_size; ++i)
+		data[i] = i % 253;
+	rc = m0_be_seg__write(&reg, data);
+	M0_UT_ASSERT(rc == 0);
+	m0_be_seg_close(seg);
+	seg->bs_huge = true;
+	rc = m0_be_seg_open(seg);
+	M0_UT_ASSERT(rc == 0);
+
+	m0_be_seg_warmup(seg, size / 2, 0);
+	m0_be_seg_warmup(seg, M0_BCOUNT_MAX, 3);
+	M0_UT_ASSERT(memcmp(reg.br_addr, data, reg.br_size) == 0);
+
+	m0_free(data);
+	m0_be_ut_seg_fini(&ut_seg);
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /*
@@ -63,7 +63,8 @@ static int cas_fops_init(const struct m0_sm_conf           *sm_conf,
 			 .xt        = m0_cas_op_xc,
 			 .fom_ops   = fom_ops,
 			 .sm        = sm_conf,
-			 .svc_type  = svctype);
+			 .svc_type  = svctype,
+			 .data_cache = true);
 	M0_FOP_TYPE_INIT(&cas_put_fopt,
 			 .name      = "cas-put",
 			 .opcode    = M0_CAS_PUT_FOP_OPCODE,
@@ -72,7 +73,8 @@ static int cas_fops_init(const struct m0_sm_conf           *sm_conf,
 			 .xt        = m0_cas_op_xc,
 			 .fom_ops   = fom_ops,
 			 .sm        = sm_conf,
-			 .svc_type  = svctype);
+			 .svc_type  = svctype,
+			 .data_cache = true);
 	M0_FOP_TYPE_INIT(&cas_del_fopt,
 			 .name      = "cas-del",
 			 .opcode    = M0_CAS_DEL_FOP_OPCODE,
@@ -81,7 +83,8 @@ static int cas_fops_init(const struct m0_sm_conf           *sm_conf,
 			 .xt        = m0_cas_op_xc,
 			 .fom_ops   = fom_ops,
 			 .sm        = sm_conf,
-			 .svc_type  = svctype);
+			 .svc_type  = svctype,
+			 .data_cache = true);
 	M0_FOP_TYPE_INIT(&cas_cur_fopt,
 			 .name      = "cas-cur",
 			 .opcode    = M0_CAS_CUR_FOP_OPCODE,
@@ -89,13 +92,15 @@ static int cas_fops_init(const struct m0_sm_conf           *sm_conf,
 			 .xt        = m0_cas_op_xc,
 			 .fom_ops   = fom_ops,
 			 .sm        = sm_conf,
-			 .svc_type  = svctype);
+			 .svc_type  = svctype,
+			 .data_cache = true);
 	M0_FOP_TYPE_INIT(&cas_rep_fopt,
 			 .name      = "cas-rep",
 			 .opcode    = M0_CAS_REP_FOP_OPCODE,
 			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY,
 			 .xt        = m0_cas_rep_xc,
-			 .svc_type  = svctype);
+			 .svc_type  = svctype,
+			 .data_cache = true);
 	M0_FOP_TYPE_INIT(&cas_gc_fopt,
 			 .name      = "cas-gc-wait",
 			 .opcode    = M0_CAS_GCW_FOP_OPCODE,
@@ -249,7 +249,22 @@ enum m0_cas_op_flags {
 	 * For PUT/DEL operation, instructs it to delay reply from CAS service
 	 * until BE transaction is persisted.
 	 */
-	COF_SYNC_WAIT = 1 << 7
+	COF_SYNC_WAIT = 1 << 7,
+	/**
+	 * For NEXT operation, instructs it to return keys only. Values are not
+	 * placed in the reply.
+	 */
+	COF_KEYS_ONLY = 1 << 8,
+	/**
+	 * For NEXT operation, instructs it to stop iteration before the first
+	 * key which is greater than or equal to m0_cas_op::cg_bound.
+	 */
+	COF_END_KEY   = 1 << 9,
+	/**
+	 * For NEXT operation, instructs it to stop iteration at the first key
+	 * which does not start with m0_cas_op::cg_bound.
+	 */
+	COF_PREFIX    = 1 << 10
 };
 
 enum m0_cas_opcode {
@@ -301,6 +316,30 @@ struct m0_cas_op {
 	 * It's a bitmask of flags from m0_cas_op_flags enumeration.
 	 */
 	uint32_t           cg_flags;
+
+	/**
+	 * For CAS-CUR, the end key (COF_END_KEY) or the key prefix
+	 * (COF_PREFIX) bounding iteration from every start key. Iteration
+	 * stopped by the bound ends with -ENOENT record, the same way as at
+	 * the end of the catalogue. Empty otherwise.
+	 *
+	 * The bound is checked against catalogue keys only, it is ignored for
+	 * the meta catalogue.
+	 */
+	struct m0_buf      cg_bound;
+
+	/**
+	 * For CAS-CUR, the maximal number of key and value bytes in the reply.
+	 * 0 means no limit.
+	 *
+	 * The budget is checked before a record is placed in the reply, so the
+	 * reply has at least one record and can exceed the budget by the size
+	 * of the last record. The record at which the budget is exhausted has
+	 * -EOVERFLOW return code, the rest of the request is not processed.
+	 * The client can continue iteration from the last returned key with
+	 * COF_EXCLUDE_START_KEY.
+	 */
+	uint64_t           cg_budget;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
 /**
@@ -185,6 +185,7 @@ static void creq_op_free(struct m0_cas_op *op)
 {
 	if (op != NULL) {
 		m0_free(op->cg_rec.cr_rec);
+		m0_buf_free(&op->cg_bound);
 		m0_free(op);
 	}
 }
@@ -492,10 +493,12 @@ static int cas_rep__validate(const struct m0_fop_type *ftype,
 			return M0_ERR(-EPROTO);
 		for (i = 0; i < rep->cgr_rep.cr_nr; i++) {
 			rec = &rep->cgr_rep.cr_rec[i];
+			/* Values are not sent for COF_KEYS_ONLY. */
 			if ((int32_t)rec->cr_rc > 0 &&
 			    (!m0_rpc_at_is_set(&rec->cr_key) ||
-			     !cas_rep_val_is_valid(&rec->cr_val,
-						   &op->cg_id.ci_fid)))
+			     (!(op->cg_flags & COF_KEYS_ONLY) &&
+			      !cas_rep_val_is_valid(&rec->cr_val,
+						    &op->cg_id.ci_fid))))
 				rec->cr_rc = M0_ERR(-EPROTO);
 		}
 	} else {
@@ -581,6 +584,7 @@ static void cas_fop_send(struct m0_cas_req *req)
 	req->ccr_sent_recs_nr += op->cg_rec.cr_nr;
 	item = cas_req_to_item(req);
 	creq_item_prepare(req, item, &cas_item_ops);
+	item->ri_deadline = req->ccr_deadline;
 	rc = m0_rpc_post(item);
 	cas_to_rpc_map(req, item);
 	M0_LOG(M0_NOTICE, "RPC post returned %d", rc);
@@ -808,6 +812,11 @@ static int nreq_asmbl_prep(struct m0_cas_req *req, struct m0_cas_op *op)
 
 	M0_PRE(op->cg_rec.cr_nr == orig->cg_rec.cr_nr);
 	op->cg_id = orig->cg_id;
+	op->cg_flags = orig->cg_flags;
+	op->cg_budget = orig->cg_budget;
+	rc = m0_buf_copy(&op->cg_bound, &orig->cg_bound);
+	if (rc != 0)
+		return M0_ERR(rc);
 	for (i = 0; i < orig->cg_rec.cr_nr; i++) {
 		rec = &op->cg_rec.cr_rec[i];
 		M0_ASSERT(M0_IS0(rec));
@@ -1761,8 +1770,10 @@ M0_INTERNAL int m0_cas_next(struct m0_cas_req *req,
 	M0_PRE(start_keys != NULL);
 	M0_PRE(m0_cas_req_is_locked(req));
 	M0_PRE(m0_cas_id_invariant(index));
-	/* Only slant and exclude start key flags are allowed. */
-	M0_PRE((flags & ~(COF_SLANT | COF_EXCLUDE_START_KEY)) == 0);
+	M0_PRE((flags & ~(COF_SLANT | COF_EXCLUDE_START_KEY | COF_KEYS_ONLY |
+			  COF_END_KEY | COF_PREFIX)) == 0);
+	M0_PRE((flags & (COF_END_KEY | COF_PREFIX)) !=
+	       (COF_END_KEY | COF_PREFIX));
 
 	for (i = 0; i < start_keys->ov_vec.v_nr; i++)
 		max_replies_nr += recs_nr[i];
@@ -1772,6 +1783,12 @@ M0_INTERNAL int m0_cas_next(struct m0_cas_req *req,
 		return M0_ERR(rc);
 	for (i = 0; i < start_keys->ov_vec.v_nr; i++)
 		op->cg_rec.cr_rec[i].cr_rc = recs_nr[i];
+	op->cg_budget = req->ccr_next_budget;
+	if (flags & (COF_END_KEY | COF_PREFIX)) {
+		rc = m0_buf_copy(&op->cg_bound, &req->ccr_next_bound);
+		if (rc != 0)
+			return M0_ERR(rc);
+	}
 	req->ccr_keys = start_keys;
 	rc = creq_fop_create_and_prepare(req, &cas_cur_fopt, op,
 					 &next_state);
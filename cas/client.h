@@ -123,6 +123,25 @@ enum m0_cas_req_state {
 struct m0_cas_req {
 	/** CAS request state machine. */
 	struct m0_sm            ccr_sm;
+	/**
+	 * Deadline of the request fop, see m0_rpc_item::ri_deadline. Fops
+	 * with a deadline in the future wait in rpc formation queue to be
+	 * packed with other fops going to the same service. 0 (the default)
+	 * sends the fop at once. Set after m0_cas_req_init().
+	 */
+	m0_time_t               ccr_deadline;
+	/**
+	 * End key or key prefix of m0_cas_next() iteration, used with
+	 * COF_END_KEY or COF_PREFIX flag. Copied by m0_cas_next(). Set after
+	 * m0_cas_req_init().
+	 */
+	struct m0_buf           ccr_next_bound;
+	/**
+	 * Maximal number of key and value bytes in m0_cas_next() reply, see
+	 * m0_cas_op::cg_budget. 0 (the default) means no limit. Set after
+	 * m0_cas_req_init().
+	 */
+	m0_bcount_t             ccr_next_budget;
 
 	/* Private fields. */
 
@@ -500,11 +519,21 @@ M0_INTERNAL void m0_cas_get_rep(const struct m0_cas_req *req,
  * start key may be not found in the index. In this case iteration starts with
  * the smallest key following the start key.
  *
+ * Iteration can be bounded on the service side: with COF_END_KEY it stops
+ * before the first key >= req->ccr_next_bound, with COF_PREFIX it stops at the
+ * first key not starting with req->ccr_next_bound. In both cases the last
+ * record of the range has -ENOENT return code, as at the end of the index.
+ * COF_KEYS_ONLY skips values, m0_cas_next_rep() returns empty values then.
+ * If req->ccr_next_budget is set, the service stops after that many key and
+ * value bytes and marks the next record with -EOVERFLOW.
+ *
  * 'Flags' argument is a bitmask of m0_cas_op_flags values.
  *
  * @pre start_keys.ov_vec.v_nr > 0
  * @pre m0_forall(i, start_keys.ov_vec.v_nr, start_keys.ov_buf[i] != NULL)
- * @pre	M0_PRE((flags & ~(COF_SLANT | COF_EXCLUDE_START_KEY)) == 0)
+ * @pre (flags & ~(COF_SLANT | COF_EXCLUDE_START_KEY | COF_KEYS_ONLY |
+ *                 COF_END_KEY | COF_PREFIX)) == 0
+ * @pre (flags & (COF_END_KEY | COF_PREFIX)) != (COF_END_KEY | COF_PREFIX)
  * @pre m0_cas_req_is_locked(req)
  * @see m0_cas_next_rep()
  */
@@ -28,6 +28,12 @@
 #include "lib/assert.h"
 #include "lib/errno.h"               /* ENOMEM, EPROTO */
 #include "lib/ext.h"                 /* m0_ext */
+#include "lib/hash.h"                /* m0_htable */
+#include "lib/hash_fnc.h"            /* m0_hash_fnc_city */
+#include "lib/rwlock.h"
+#include "lib/cond.h"
+#include "lib/thread.h"              /* M0_THREAD_INIT */
+#include "motr/magic.h"
 #include "be/domain.h"               /* m0_be_domain_seg_first */
 #include "be/op.h"
 #include "module/instance.h"
@@ -75,6 +81,44 @@ struct m0_ctg_store {
 	 * Flag indicating whether catalogue store is initialised or not.
 	 */
 	bool                 cs_initialised;
+
+	/** Negative lookup filters of ordinary catalogues, ctg_filter. */
+	struct m0_htable     cs_filters;
+
+	/** Protects cs_filters. */
+	struct m0_rwlock     cs_filter_lock;
+
+	/** Builds filters, see ctg_filter_thread(). */
+	struct m0_thread     cs_filter_thread;
+
+	/** Protects cs_filter_queue, cs_filter_cur and cs_filter_stop. */
+	struct m0_mutex      cs_filter_qlock;
+
+	/** Signalled when the queue, cs_filter_cur or cs_filter_stop change. */
+	struct m0_cond       cs_filter_qcond;
+
+	/** Filters to be counted or filled, ctg_filter_queue. */
+	struct m0_tl         cs_filter_queue;
+
+	/** Filter processed by the builder, if any. */
+	struct ctg_filter   *cs_filter_cur;
+
+	/** The builder is asked to exit. */
+	bool                 cs_filter_stop;
+
+	/**
+	 * cs_filters is initialised. Catalogues are also created without the
+	 * store, by be/tool/beck.c.
+	 */
+	bool                 cs_filter_inited;
+
+	/** Memory used by filter bits. */
+	struct m0_atomic64   cs_filter_nob;
+
+	/** Statistics, see m0_ctg_filter_stats. */
+	struct m0_atomic64   cs_filter_lookup_nr;
+	struct m0_atomic64   cs_filter_negative_nr;
+	struct m0_atomic64   cs_filter_build_nr;
 };
 
 enum cursor_phase {
@@ -122,6 +166,10 @@ static int  ctg_exec         (struct m0_ctg_op    *ctg_op,
 			      int                  next_phase);
 static void ctg_store_release(struct m0_ref *ref);
 
+static int  ctg_filters_init (void);
+static void ctg_filters_fini (void);
+static void ctg_filter_remove(const struct m0_cas_ctg *ctg);
+
 static m0_bcount_t ctg_ksize (const void *key);
 static m0_bcount_t ctg_vsize (const void *val);
 static int         ctg_cmp   (const void *key0, const void *key1);
@@ -246,6 +294,8 @@ static void ctg_init(struct m0_cas_ctg *ctg, struct m0_be_seg *seg)
 		.ot_footer_offset = offsetof(struct m0_cas_ctg, cc_foot)
 	});
 	M0_ENTRY();
+	/* Channel, locks and cc_inited are volatile, keep them resident. */
+	m0_be_seg_pin(seg, ctg, sizeof *ctg);
 	m0_be_btree_init(&ctg->cc_tree, seg, &cas_btree_ops);
 	m0_long_lock_init(m0_ctg_lock(ctg));
 	m0_mutex_init(&ctg->cc_chan_guard.bm_u.mutex);
@@ -257,7 +307,9 @@ static void ctg_init(struct m0_cas_ctg *ctg, struct m0_be_seg *seg)
 static void ctg_fini(struct m0_cas_ctg *ctg)
 {
 	M0_ENTRY("ctg=%p", ctg);
+	ctg_filter_remove(ctg);
 	ctg->cc_inited = false;
+	m0_be_seg_unpin(ctg->cc_tree.bb_seg, ctg, sizeof *ctg);
 	m0_be_btree_fini(&ctg->cc_tree);
 	m0_long_lock_fini(m0_ctg_lock(ctg));
 	m0_chan_fini_lock(&ctg->cc_chan.bch_chan);
@@ -548,6 +600,7 @@ static int ctg_store__init(struct m0_be_seg *seg, struct m0_cas_state *state)
 	M0_ENTRY();
 
 	ctg_store.cs_state = state;
+	m0_be_seg_pin(seg, state, sizeof *state);
 	m0_mutex_init(&state->cs_ctg_init_mutex.bm_u.mutex);
 	ctg_init(state->cs_meta, seg);
 
@@ -636,6 +689,7 @@ static int ctg_store_create(struct m0_be_seg *seg)
 	M0_BE_TX_CAPTURE_PTR(seg, &tx, dead_index);
 	m0_format_footer_update(state);
 	M0_BE_TX_CAPTURE_PTR(seg, &tx, state);
+	m0_be_seg_pin(seg, state, sizeof *state);
 	ctg_store.cs_state = state;
 	ctg_store.cs_ctidx = ctidx;
 	ctg_store.cs_dead_index = dead_index;
@@ -674,6 +728,9 @@ M0_INTERNAL int m0_ctg_store_init(struct m0_be_domain *dom)
 		goto end;
 	}
 
+	result = ctg_filters_init();
+	if (result != 0)
+		goto end;
 	/**
 	 * @todo Use 0type.
 	 */
@@ -698,7 +755,8 @@ M0_INTERNAL int m0_ctg_store_init(struct m0_be_domain *dom)
 		m0_ref_init(&ctg_store.cs_ref, 1, ctg_store_release);
 		ctg_store.cs_be_domain = dom;
 		ctg_store.cs_initialised = true;
-	}
+	} else
+		ctg_filters_fini();
 end:
 	m0_mutex_unlock(&cs_init_guard);
 	return M0_RC(result);
@@ -710,9 +768,14 @@ static void ctg_store_release(struct m0_ref *ref)
 
 	M0_ENTRY();
 	m0_mutex_fini(&ctg_store->cs_state_mutex);
+	if (ctg_store->cs_state != NULL)
+		m0_be_seg_unpin(cas_seg(ctg_store->cs_be_domain),
+				ctg_store->cs_state,
+				sizeof *ctg_store->cs_state);
 	ctg_store->cs_state = NULL;
 	ctg_store->cs_ctidx = NULL;
 	m0_long_lock_fini(&ctg_store->cs_del_lock);
+	ctg_filters_fini();
 	ctg_store->cs_initialised = false;
 }
 
@@ -821,6 +884,672 @@ static bool ctg_is_ordinary(const struct m0_cas_ctg *ctg)
 			    m0_ctg_meta()));
 }
 
+/**
+ * @name Negative lookup filters.
+ *
+ * m0_cas_ctg is persistent, so filters are kept aside in
+ * m0_ctg_store::cs_filters, keyed by the catalogue address. Filters are built
+ * by a dedicated thread, ctg_filter_thread(), and lookups bypass a filter
+ * until it is ready. A lookup which finds the filter missing queues it for
+ * counting: the builder scans the catalogue to count the keys and, if a filter
+ * of the configured false positive rate for twice as many keys fits into the
+ * memory budget, allocates it. The next lookup queues the filter for filling
+ * and the builder scans the catalogue once more to set the bits of all keys.
+ * A build that does not fit is retried after CTG_FILTER_RETRY lookups.
+ *
+ * The builder takes no catalogue lock. Each step of its scan is a separate
+ * btree lookup (ctg_filter_scan_next()), so the scan tolerates concurrent
+ * updates of the tree. CAS service takes the catalogue long lock for reading
+ * on lookup and for writing on insert and delete, DIX copy packets take it for
+ * writing on insert. Once the filter is being filled, insert sets the key bits
+ * before the btree insert. Filling is started by a lookup, under the read
+ * lock, when no insert is in progress. Hence every key is either in the tree
+ * before the fill scan starts or sets its bits itself.
+ *
+ * Bits cannot be cleared on delete, so the filter is dropped when more than
+ * half of its keys were deleted or when it is over capacity, and the next
+ * lookup rebuilds it.
+ *
+ * ctg_filter::cf_lock serialises lookups, updates and the builder. The builder
+ * holds neither cs_filter_lock nor cf_lock across the scan.
+ *
+ * @{
+ */
+
+enum {
+	CTG_FILTER_BUCKET_NR = 64,
+	/** Minimal filter capacity, in keys. */
+	CTG_FILTER_MIN_KEYS  = 1024,
+	CTG_FILTER_HASH_MAX  = 16,
+	/** Lookups bypassing the filter after a failed build. */
+	CTG_FILTER_RETRY     = 1024,
+	/** Default false positive rate, in parts per million. */
+	CTG_FILTER_FPR       = 10000,
+	/** Initial size of the scan key buffer. */
+	CTG_FILTER_KEY_NOB   = 256
+};
+
+enum ctg_filter_state {
+	/** There is no filter. */
+	CFS_NONE,
+	/** Queued for ctg_filter_count() or being counted. */
+	CFS_COUNT,
+	/** Bits are allocated, a lookup is to start filling. */
+	CFS_COUNTED,
+	/** Queued for ctg_filter_fill() or being filled. */
+	CFS_FILL,
+	/** The filter answers lookups. */
+	CFS_READY
+};
+
+struct ctg_filter {
+	/** Catalogue of the filter, hash table key. */
+	const struct m0_cas_ctg *cf_ctg;
+	struct m0_hlink          cf_hlink;
+	uint64_t                 cf_magic;
+	/** Tree of the catalogue, scanned by the builder. */
+	struct m0_be_btree      *cf_tree;
+	/** Linkage to m0_ctg_store::cs_filter_queue. */
+	struct m0_tlink          cf_qlink;
+	uint64_t                 cf_qmagic;
+	/** Protects the fields below. */
+	struct m0_mutex          cf_lock;
+	enum ctg_filter_state    cf_state;
+	/** Filter bits, NULL in CFS_NONE and CFS_COUNT. */
+	uint64_t                *cf_bits;
+	uint64_t                 cf_bits_nr;
+	uint32_t                 cf_hash_nr;
+	/** Number of keys the filter is sized for. */
+	uint64_t                 cf_cap;
+	/** Keys in the filter, including overwritten ones. */
+	uint64_t                 cf_key_nr;
+	/** Keys deleted since the build. */
+	uint64_t                 cf_del_nr;
+	/** Lookups to bypass the filter before the next build. */
+	uint32_t                 cf_skip;
+};
+
+/** State of a catalogue scan by the filter builder. */
+struct ctg_filter_scan {
+	struct m0_be_btree *fs_tree;
+	/** Current key in the catalogue format, of fs_nob bytes. */
+	void               *fs_buf;
+	/** Size of fs_buf. */
+	m0_bcount_t         fs_size;
+	/** Size of the current key, 0 before the first step. */
+	m0_bcount_t         fs_nob;
+};
+
+static uint64_t ctg_filter_hash(const struct m0_htable *htable, const void *k)
+{
+	return m0_hash((uint64_t)*(const struct m0_cas_ctg **)k) %
+		htable->h_bucket_nr;
+}
+
+static bool ctg_filter_key_eq(const void *key0, const void *key1)
+{
+	return *(const struct m0_cas_ctg **)key0 ==
+		*(const struct m0_cas_ctg **)key1;
+}
+
+M0_HT_DESCR_DEFINE(ctg_filter, "Negative lookup filters", static,
+		   struct ctg_filter, cf_hlink, cf_magic,
+		   M0_CAS_FILTER_MAGIC, M0_CAS_FILTER_HEAD_MAGIC,
+		   cf_ctg, ctg_filter_hash, ctg_filter_key_eq);
+
+M0_HT_DEFINE(ctg_filter, static, struct ctg_filter, const struct m0_cas_ctg *);
+
+M0_TL_DESCR_DEFINE(ctg_filter_queue, "Filters to build", static,
+		   struct ctg_filter, cf_qlink, cf_qmagic,
+		   M0_CAS_FILTER_QUEUE_MAGIC, M0_CAS_FILTER_QUEUE_HEAD_MAGIC);
+
+M0_TL_DEFINE(ctg_filter_queue, static, struct ctg_filter);
+
+/** Disabled until m0_ctg_filter_cfg_set(). */
+static struct m0_ctg_filter_cfg ctg_filter_cfg = {};
+
+static void ctg_filter_thread(struct m0_ctg_store *cs);
+
+static int ctg_filters_init(void)
+{
+	struct m0_ctg_store *cs = &ctg_store;
+	int                  rc;
+
+	rc = ctg_filter_htable_init(&cs->cs_filters, CTG_FILTER_BUCKET_NR);
+	if (rc != 0)
+		return M0_ERR(rc);
+	m0_rwlock_init(&cs->cs_filter_lock);
+	m0_mutex_init(&cs->cs_filter_qlock);
+	m0_cond_init(&cs->cs_filter_qcond, &cs->cs_filter_qlock);
+	ctg_filter_queue_tlist_init(&cs->cs_filter_queue);
+	cs->cs_filter_cur  = NULL;
+	cs->cs_filter_stop = false;
+	rc = M0_THREAD_INIT(&cs->cs_filter_thread, struct m0_ctg_store *, NULL,
+			    &ctg_filter_thread, cs, "ctg_filter");
+	if (rc != 0) {
+		ctg_filter_queue_tlist_fini(&cs->cs_filter_queue);
+		m0_cond_fini(&cs->cs_filter_qcond);
+		m0_mutex_fini(&cs->cs_filter_qlock);
+		m0_rwlock_fini(&cs->cs_filter_lock);
+		ctg_filter_htable_fini(&cs->cs_filters);
+		return M0_ERR(rc);
+	}
+	m0_atomic64_set(&cs->cs_filter_nob, 0);
+	m0_atomic64_set(&cs->cs_filter_lookup_nr, 0);
+	m0_atomic64_set(&cs->cs_filter_negative_nr, 0);
+	m0_atomic64_set(&cs->cs_filter_build_nr, 0);
+	cs->cs_filter_inited = true;
+	return M0_RC(0);
+}
+
+static void ctg_filter_bits_free(struct ctg_filter *f)
+{
+	if (f->cf_bits != NULL) {
+		m0_atomic64_sub(&ctg_store.cs_filter_nob, f->cf_bits_nr / 8);
+		m0_free(f->cf_bits);
+		f->cf_bits = NULL;
+	}
+}
+
+/** Discards the filter bits, the filter is rebuilt after "skip" lookups. */
+static void ctg_filter_drop(struct ctg_filter *f, uint32_t skip)
+{
+	M0_PRE(m0_mutex_is_locked(&f->cf_lock));
+	ctg_filter_bits_free(f);
+	f->cf_state = CFS_NONE;
+	f->cf_skip  = skip;
+}
+
+static void ctg_filter_enqueue(struct ctg_filter *f)
+{
+	struct m0_ctg_store *cs = &ctg_store;
+
+	m0_mutex_lock(&cs->cs_filter_qlock);
+	if (!ctg_filter_queue_tlink_is_in(f)) {
+		ctg_filter_queue_tlist_add_tail(&cs->cs_filter_queue, f);
+		m0_cond_signal(&cs->cs_filter_qcond);
+	}
+	m0_mutex_unlock(&cs->cs_filter_qlock);
+}
+
+static void ctg_filter_free(struct ctg_filter *f)
+{
+	struct m0_ctg_store *cs = &ctg_store;
+
+	m0_mutex_lock(&f->cf_lock);
+	ctg_filter_drop(f, 0);
+	m0_mutex_unlock(&f->cf_lock);
+	/* The builder stops at the next key once the filter is dropped. */
+	m0_mutex_lock(&cs->cs_filter_qlock);
+	if (ctg_filter_queue_tlink_is_in(f))
+		ctg_filter_queue_tlist_del(f);
+	while (cs->cs_filter_cur == f)
+		m0_cond_wait(&cs->cs_filter_qcond);
+	m0_mutex_unlock(&cs->cs_filter_qlock);
+	ctg_filter_htable_del(&cs->cs_filters, f);
+	ctg_filter_tlink_fini(f);
+	ctg_filter_queue_tlink_fini(f);
+	m0_mutex_fini(&f->cf_lock);
+	m0_free(f);
+}
+
+static void ctg_filters_clear(void)
+{
+	struct ctg_filter *f;
+
+	m0_rwlock_write_lock(&ctg_store.cs_filter_lock);
+	m0_htable_for(ctg_filter, f, &ctg_store.cs_filters) {
+		ctg_filter_free(f);
+	} m0_htable_endfor;
+	m0_rwlock_write_unlock(&ctg_store.cs_filter_lock);
+}
+
+static void ctg_filters_fini(void)
+{
+	struct m0_ctg_store *cs = &ctg_store;
+
+	ctg_filters_clear();
+	cs->cs_filter_inited = false;
+	m0_mutex_lock(&cs->cs_filter_qlock);
+	cs->cs_filter_stop = true;
+	m0_cond_signal(&cs->cs_filter_qcond);
+	m0_mutex_unlock(&cs->cs_filter_qlock);
+	m0_thread_join(&cs->cs_filter_thread);
+	m0_thread_fini(&cs->cs_filter_thread);
+	M0_ASSERT(m0_atomic64_get(&cs->cs_filter_nob) == 0);
+	ctg_filter_queue_tlist_fini(&cs->cs_filter_queue);
+	m0_cond_fini(&cs->cs_filter_qcond);
+	m0_mutex_fini(&cs->cs_filter_qlock);
+	m0_rwlock_fini(&cs->cs_filter_lock);
+	ctg_filter_htable_fini(&cs->cs_filters);
+}
+
+static void ctg_filter_remove(const struct m0_cas_ctg *ctg)
+{
+	struct ctg_filter *f;
+
+	if (!ctg_store.cs_filter_inited)
+		return;
+	m0_rwlock_write_lock(&ctg_store.cs_filter_lock);
+	f = ctg_filter_htable_lookup(&ctg_store.cs_filters, &ctg);
+	if (f != NULL)
+		ctg_filter_free(f);
+	m0_rwlock_write_unlock(&ctg_store.cs_filter_lock);
+}
+
+/**
+ * Returns the filter of the catalogue, with cs_filter_lock held for reading.
+ * If the tree of the catalogue is given, a missing filter is created.
+ */
+static struct ctg_filter *ctg_filter_get(const struct m0_cas_ctg *ctg,
+					 struct m0_be_btree      *tree)
+{
+	struct m0_htable  *ht = &ctg_store.cs_filters;
+	struct ctg_filter *f;
+
+	m0_rwlock_read_lock(&ctg_store.cs_filter_lock);
+	f = ctg_filter_htable_lookup(ht, &ctg);
+	if (f == NULL && tree != NULL) {
+		m0_rwlock_read_unlock(&ctg_store.cs_filter_lock);
+		m0_rwlock_write_lock(&ctg_store.cs_filter_lock);
+		if (ctg_filter_htable_lookup(ht, &ctg) == NULL) {
+			M0_ALLOC_PTR(f);
+			if (f != NULL) {
+				f->cf_ctg  = ctg;
+				f->cf_tree = tree;
+				m0_mutex_init(&f->cf_lock);
+				ctg_filter_tlink_init(f);
+				ctg_filter_queue_tlink_init(f);
+				ctg_filter_htable_add(ht, f);
+			}
+		}
+		m0_rwlock_write_unlock(&ctg_store.cs_filter_lock);
+		m0_rwlock_read_lock(&ctg_store.cs_filter_lock);
+		f = ctg_filter_htable_lookup(ht, &ctg);
+	}
+	return f;
+}
+
+static void ctg_filter_put(void)
+{
+	m0_rwlock_read_unlock(&ctg_store.cs_filter_lock);
+}
+
+static bool ctg_filter_enabled(const struct m0_cas_ctg *ctg)
+{
+	return ctg_filter_cfg.cfc_budget != 0 && ctg_is_ordinary(ctg);
+}
+
+/**
+ * Bit i of the key is (h1 + i * h2) mod bits_nr, h2 is odd. See "Less Hashing,
+ * Same Performance: Building a Better Bloom Filter" by Kirsch and Mitzenmacher.
+ */
+static void ctg_filter_key_hash(const struct m0_buf *key,
+				uint64_t *h1, uint64_t *h2)
+{
+	*h1 = m0_hash_fnc_city(key->b_addr, key->b_nob);
+	*h2 = m0_hash(*h1) | 1;
+}
+
+static void ctg_filter_bits_set(uint64_t *bits, uint64_t bits_nr,
+				uint32_t hash_nr, const struct m0_buf *key)
+{
+	uint64_t h1;
+	uint64_t h2;
+	uint64_t bit;
+	uint32_t i;
+
+	ctg_filter_key_hash(key, &h1, &h2);
+	for (i = 0; i < hash_nr; ++i) {
+		bit = (h1 + i * h2) % bits_nr;
+		bits[bit / 64] |= 1ULL << (bit % 64);
+	}
+}
+
+static bool ctg_filter_bits_test(const struct ctg_filter *f,
+				 const struct m0_buf     *key)
+{
+	uint64_t h1;
+	uint64_t h2;
+	uint64_t bit;
+	uint32_t i;
+
+	ctg_filter_key_hash(key, &h1, &h2);
+	for (i = 0; i < f->cf_hash_nr; ++i) {
+		bit = (h1 + i * h2) % f->cf_bits_nr;
+		if (!(f->cf_bits[bit / 64] & (1ULL << (bit % 64))))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * For the false positive rate p, the optimal number of hash functions is
+ * log2(1/p) and the filter takes log2(1/p) / ln(2) bits per key.
+ */
+static void ctg_filter_geometry(uint32_t *bits_per_key, uint32_t *hash_nr)
+{
+	uint64_t ppm = ctg_filter_cfg.cfc_fpr_ppm ?: CTG_FILTER_FPR;
+	uint32_t k;
+
+	for (k = 1; k < CTG_FILTER_HASH_MAX && (ppm << k) < 1000000; ++k)
+		;
+	*hash_nr = k;
+	*bits_per_key = (k * 1443 + 999) / 1000;
+}
+
+static bool ctg_filter_is(struct ctg_filter *f, enum ctg_filter_state state)
+{
+	bool result;
+
+	m0_mutex_lock(&f->cf_lock);
+	result = f->cf_state == state;
+	m0_mutex_unlock(&f->cf_lock);
+	return result;
+}
+
+/** Grows the scan buffer to at least nob bytes, keeping its contents. */
+static int ctg_filter_scan_grow(struct ctg_filter_scan *s, m0_bcount_t nob)
+{
+	void *buf;
+
+	if (nob <= s->fs_size)
+		return 0;
+	nob = max64u(nob, 2 * s->fs_size);
+	buf = m0_alloc(nob);
+	if (buf == NULL)
+		return M0_ERR(-ENOMEM);
+	if (s->fs_buf != NULL)
+		memcpy(buf, s->fs_buf, s->fs_size);
+	m0_free(s->fs_buf);
+	s->fs_buf  = buf;
+	s->fs_size = nob;
+	return 0;
+}
+
+/**
+ * Moves the scan to the next key of the catalogue and returns it in "ukey".
+ * Returns -ENOENT after the last key.
+ *
+ * The next key is found by a slant lookup of the current key with a zero byte
+ * appended, which is the smallest key after it in ctg_cmp() order. The lookup
+ * copies the found key out under the btree lock, so nothing refers to the tree
+ * between the steps.
+ */
+static int ctg_filter_scan_next(struct ctg_filter_scan *s, struct m0_buf *ukey)
+{
+	struct m0_buf key;
+	struct m0_buf val;
+	uint64_t      dummy;
+	m0_bcount_t   nob;
+	int           rc;
+
+	nob = max64u(s->fs_nob + 1, M0_CAS_CTG_KV_HDR_SIZE);
+	rc = ctg_filter_scan_grow(s, max64u(nob, CTG_FILTER_KEY_NOB));
+	if (rc != 0)
+		return M0_ERR(rc);
+	if (s->fs_nob == 0)
+		*(uint64_t *)s->fs_buf = 0;
+	else {
+		((char *)s->fs_buf)[s->fs_nob] = 0;
+		++*(uint64_t *)s->fs_buf;
+	}
+	while (true) {
+		key = M0_BUF_INIT(s->fs_size, s->fs_buf);
+		val = M0_BUF_INIT(0, &dummy);
+		rc = M0_BE_OP_SYNC_RET(op,
+			       m0_be_btree_lookup_slant(s->fs_tree, &op,
+							&key, &val),
+			       bo_u.u_btree.t_rc);
+		if (rc != 0)
+			return rc;
+		nob = ctg_ksize(s->fs_buf);
+		if (nob <= s->fs_size)
+			break;
+		/*
+		 * The key is truncated. Its copied prefix is not smaller than
+		 * the looked up key, so it is looked up again.
+		 */
+		*(uint64_t *)s->fs_buf = s->fs_size - M0_CAS_CTG_KV_HDR_SIZE;
+		rc = ctg_filter_scan_grow(s, nob);
+		if (rc != 0)
+			return M0_ERR(rc);
+	}
+	s->fs_nob = nob;
+	return ctg_buf(&M0_BUF_INIT(nob, s->fs_buf), ukey);
+}
+
+static void ctg_filter_scan_fini(struct ctg_filter_scan *s)
+{
+	m0_free(s->fs_buf);
+}
+
+/** Counts the keys of the catalogue and allocates the filter bits. */
+static void ctg_filter_count(struct ctg_filter *f)
+{
+	struct ctg_filter_scan  s      = { .fs_tree = f->cf_tree };
+	struct m0_buf           ukey;
+	struct m0_atomic64     *nob    = &ctg_store.cs_filter_nob;
+	m0_bcount_t             budget = ctg_filter_cfg.cfc_budget;
+	uint64_t               *bits   = NULL;
+	uint64_t                bits_nr = 0;
+	uint64_t                key_nr  = 0;
+	uint64_t                cap     = 0;
+	uint64_t                max;
+	uint32_t                bpk;
+	uint32_t                hash_nr;
+	int                     rc;
+
+	M0_ENTRY("ctg=%p", f->cf_ctg);
+	ctg_filter_geometry(&bpk, &hash_nr);
+	/* Do not count beyond the keys which can fit into the budget. */
+	max = (budget - min64u(budget, m0_atomic64_get(nob))) * 8 / bpk / 2;
+	while ((rc = ctg_filter_scan_next(&s, &ukey)) == 0 &&
+	       ++key_nr <= max && ctg_filter_is(f, CFS_COUNT))
+		;
+	ctg_filter_scan_fini(&s);
+	if (rc == -ENOENT) {
+		cap     = max64u(2 * key_nr, CTG_FILTER_MIN_KEYS);
+		bits_nr = m0_round_up(cap * bpk, 64);
+		if (m0_atomic64_add_return(nob, bits_nr / 8) <= budget)
+			bits = m0_alloc(bits_nr / 8);
+		if (bits == NULL)
+			m0_atomic64_sub(nob, bits_nr / 8);
+	}
+	m0_mutex_lock(&f->cf_lock);
+	if (f->cf_state == CFS_COUNT) {
+		if (bits != NULL) {
+			f->cf_state   = CFS_COUNTED;
+			f->cf_bits    = bits;
+			f->cf_bits_nr = bits_nr;
+			f->cf_hash_nr = hash_nr;
+			f->cf_cap     = cap;
+			f->cf_key_nr  = key_nr;
+			f->cf_del_nr  = 0;
+			bits = NULL;
+		} else
+			ctg_filter_drop(f, CTG_FILTER_RETRY);
+	}
+	m0_mutex_unlock(&f->cf_lock);
+	if (bits != NULL) {
+		m0_free(bits);
+		m0_atomic64_sub(nob, bits_nr / 8);
+	}
+	M0_LEAVE("keys=%"PRIu64" bits=%"PRIu64" rc=%d", key_nr, bits_nr, rc);
+}
+
+/** Sets the bits of all keys of the catalogue. */
+static void ctg_filter_fill(struct ctg_filter *f)
+{
+	struct ctg_filter_scan s    = { .fs_tree = f->cf_tree };
+	struct m0_buf          ukey;
+	bool                   fill = true;
+	int                    rc   = 0;
+
+	M0_ENTRY("ctg=%p", f->cf_ctg);
+	while (fill && (rc = ctg_filter_scan_next(&s, &ukey)) == 0) {
+		m0_mutex_lock(&f->cf_lock);
+		fill = f->cf_state == CFS_FILL;
+		if (fill)
+			ctg_filter_bits_set(f->cf_bits, f->cf_bits_nr,
+					    f->cf_hash_nr, &ukey);
+		m0_mutex_unlock(&f->cf_lock);
+	}
+	ctg_filter_scan_fini(&s);
+	m0_mutex_lock(&f->cf_lock);
+	if (f->cf_state == CFS_FILL) {
+		if (rc == -ENOENT) {
+			f->cf_state = CFS_READY;
+			m0_atomic64_inc(&ctg_store.cs_filter_build_nr);
+		} else
+			/* A filter missing some keys would lose records. */
+			ctg_filter_drop(f, CTG_FILTER_RETRY);
+	}
+	m0_mutex_unlock(&f->cf_lock);
+	M0_LEAVE("rc=%d", rc);
+}
+
+/** Counts or fills the filters queued by lookups. */
+static void ctg_filter_thread(struct m0_ctg_store *cs)
+{
+	struct ctg_filter *f;
+
+	m0_mutex_lock(&cs->cs_filter_qlock);
+	while (!cs->cs_filter_stop) {
+		f = ctg_filter_queue_tlist_pop(&cs->cs_filter_queue);
+		if (f == NULL) {
+			m0_cond_wait(&cs->cs_filter_qcond);
+			continue;
+		}
+		cs->cs_filter_cur = f;
+		m0_mutex_unlock(&cs->cs_filter_qlock);
+		if (ctg_filter_is(f, CFS_COUNT))
+			ctg_filter_count(f);
+		else if (ctg_filter_is(f, CFS_FILL))
+			ctg_filter_fill(f);
+		m0_mutex_lock(&cs->cs_filter_qlock);
+		cs->cs_filter_cur = NULL;
+		m0_cond_broadcast(&cs->cs_filter_qcond);
+	}
+	m0_mutex_unlock(&cs->cs_filter_qlock);
+}
+
+/**
+ * Returns true iff the key is definitely absent from the catalogue. Queues the
+ * filter for the builder if needed, and bypasses it until it is ready. Called
+ * under the catalogue read lock.
+ */
+static bool ctg_filter_miss(struct m0_cas_ctg *ctg, const struct m0_buf *key)
+{
+	struct ctg_filter *f;
+	bool               queue = false;
+	bool               found = true;
+
+	if (!ctg_filter_enabled(ctg))
+		return false;
+	f = ctg_filter_get(ctg, &ctg->cc_tree);
+	if (f != NULL) {
+		m0_mutex_lock(&f->cf_lock);
+		switch (f->cf_state) {
+		case CFS_NONE:
+			if (f->cf_skip > 0)
+				--f->cf_skip;
+			else {
+				f->cf_state = CFS_COUNT;
+				queue = true;
+			}
+			break;
+		case CFS_COUNTED:
+			/* No insert is in progress, see the comment above. */
+			f->cf_state = CFS_FILL;
+			queue = true;
+			break;
+		case CFS_READY:
+			found = ctg_filter_bits_test(f, key);
+			m0_atomic64_inc(&ctg_store.cs_filter_lookup_nr);
+			if (!found)
+				m0_atomic64_inc(
+					&ctg_store.cs_filter_negative_nr);
+			break;
+		default:
+			break;
+		}
+		m0_mutex_unlock(&f->cf_lock);
+		if (queue)
+			ctg_filter_enqueue(f);
+	}
+	ctg_filter_put();
+	return !found;
+}
+
+/** Adds the key to the filter. Called under the catalogue write lock. */
+static void ctg_filter_insert(const struct m0_cas_ctg *ctg,
+			      const struct m0_buf     *key)
+{
+	struct ctg_filter *f;
+
+	if (!ctg_filter_enabled(ctg))
+		return;
+	f = ctg_filter_get(ctg, NULL);
+	if (f != NULL) {
+		m0_mutex_lock(&f->cf_lock);
+		if (M0_IN(f->cf_state, (CFS_FILL, CFS_READY))) {
+			if (++f->cf_key_nr > f->cf_cap)
+				ctg_filter_drop(f, 0);
+			else
+				ctg_filter_bits_set(f->cf_bits, f->cf_bits_nr,
+						    f->cf_hash_nr, key);
+		}
+		m0_mutex_unlock(&f->cf_lock);
+	}
+	ctg_filter_put();
+}
+
+/** Accounts a deleted key. Called under the catalogue write lock. */
+static void ctg_filter_delete(const struct m0_cas_ctg *ctg)
+{
+	struct ctg_filter *f;
+
+	if (!ctg_filter_enabled(ctg))
+		return;
+	f = ctg_filter_get(ctg, NULL);
+	if (f != NULL) {
+		m0_mutex_lock(&f->cf_lock);
+		if (M0_IN(f->cf_state, (CFS_FILL, CFS_READY)) &&
+		    ++f->cf_del_nr > f->cf_key_nr / 2)
+			ctg_filter_drop(f, 0);
+		m0_mutex_unlock(&f->cf_lock);
+	}
+	ctg_filter_put();
+}
+
+M0_INTERNAL void m0_ctg_filter_cfg_set(const struct m0_ctg_filter_cfg *cfg)
+{
+	M0_ENTRY("budget=%"PRIu64" fpr=%"PRIu32,
+		 cfg->cfc_budget, cfg->cfc_fpr_ppm);
+	m0_mutex_lock(&cs_init_guard);
+	ctg_filter_cfg = *cfg;
+	if (ctg_store.cs_initialised)
+		ctg_filters_clear();
+	m0_mutex_unlock(&cs_init_guard);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_ctg_filter_stats_get(struct m0_ctg_filter_stats *stats)
+{
+	*stats = (struct m0_ctg_filter_stats) {
+		.cfs_lookup_nr   = m0_atomic64_get(
+				&ctg_store.cs_filter_lookup_nr),
+		.cfs_negative_nr = m0_atomic64_get(
+				&ctg_store.cs_filter_negative_nr),
+		.cfs_build_nr    = m0_atomic64_get(
+				&ctg_store.cs_filter_build_nr),
+		.cfs_nob         = m0_atomic64_get(&ctg_store.cs_filter_nob)
+	};
+}
+
+/** @} */
+
 static bool ctg_op_cb(struct m0_clink *clink)
 {
 	struct m0_ctg_op *ctg_op   = M0_AMB(ctg_op, clink, co_clink);
@@ -860,8 +1589,10 @@ static bool ctg_op_cb(struct m0_clink *clink)
 			}
 			break;
 		case CTG_OP_COMBINE(CO_DEL, CT_BTREE):
-			if (ctg_is_ordinary(ctg_op->co_ctg))
+			if (ctg_is_ordinary(ctg_op->co_ctg)) {
 				ctg_state_dec_update(tx, 0);
+				ctg_filter_delete(ctg_op->co_ctg);
+			}
 			/* Fall through. */
 		case CTG_OP_COMBINE(CO_DEL, CT_META):
 		case CTG_OP_COMBINE(CO_PUT, CT_DEAD_INDEX):
@@ -1210,6 +1941,14 @@ static int ctg_exec(struct m0_ctg_op    *ctg_op,
 	ctg_op->co_ctg = ctg;
 	ctg_op->co_ct = CT_BTREE;
 
+	if (ctg_op->co_opcode == CO_GET && ctg_filter_miss(ctg, key)) {
+		/* No btree lookup, hence no BE operation to wait for. */
+		ctg_op->co_rc = -ENOENT;
+		m0_fom_phase_set(ctg_op->co_fom, next_phase);
+		return ret;
+	}
+	if (ctg_op->co_opcode == CO_PUT)
+		ctg_filter_insert(ctg, key);
 	if (!M0_IN(ctg_op->co_opcode, (CO_MIN, CO_TRUNC, CO_DROP)) &&
 	    (ctg_op->co_opcode != CO_CUR ||
 	     ctg_op->co_cur_phase != CPH_NEXT))
@@ -1543,10 +2282,12 @@ M0_INTERNAL void m0_ctg_drop_credit(struct m0_fom          *fom,
 	m0_bcount_t            records_ok;
 	struct m0_be_tx_credit record_cred;
 	struct m0_be_tx_credit nodes_cred = {};
+	m0_bcount_t            bound;
 
 	m0_be_btree_clear_credit(&ctg->cc_tree, &nodes_cred, &record_cred,
 				 &records_nr);
 	records_nr = records_nr ?: 1;
+	bound = *limit == 0 ? records_nr : min_check(*limit, records_nr);
 	for (records_ok = 0;
 	     /**
 	      * Take only a half of maximum number of credits, and rely on the
@@ -1555,7 +2296,7 @@ M0_INTERNAL void m0_ctg_drop_credit(struct m0_fom          *fom,
 	      * for the credits required for nodes deletion.
 	      */
 	     !m0_be_should_break_half(m0_fom_tx(fom)->t_engine, accum,
-				      &record_cred) && records_ok < records_nr;
+				      &record_cred) && records_ok < bound;
 	     records_ok++)
 		m0_be_tx_credit_add(accum, &record_cred);
 
@@ -605,12 +605,17 @@ M0_INTERNAL void m0_ctg_ctidx_insert_credits(struct m0_cas_id       *cid,
 					     struct m0_be_tx_credit *accum);
 
 /**
- * Calculates credits for destroying catalogue records.
+ * Calculates credits for destroying catalogue records by the next
+ * m0_ctg_truncate() of the catalogue.
  *
  * If it's not possible to destroy the catalogue in one BE transaction, then
  * 'accum' contains credits that are necessary to delete 'limit' number of
- * records. 'limit' is a maximum number of records that can be deleted in one BE
- * transaction.
+ * records.
+ *
+ * @param[in,out] limit On input, maximum number of records to delete in the
+ *                      transaction, 0 for no limit other than the transaction
+ *                      size. On output, number of records covered by the
+ *                      credits.
  */
 M0_INTERNAL void m0_ctg_drop_credit(struct m0_fom          *fom,
 				    struct m0_be_tx_credit *accum,
@@ -762,6 +767,44 @@ M0_INTERNAL const struct m0_be_btree_kv_ops *m0_ctg_btree_ops(void);
 /** Update number of records and record size in cas state. */
 M0_INTERNAL void m0_ctg_state_inc_update(struct m0_be_tx *tx, uint64_t size);
 
+/**
+ * Configuration of negative lookup filters.
+ *
+ * When enabled, m0_ctg_lookup() in an ordinary catalogue consults an in-memory
+ * Bloom filter of the catalogue keys and completes with -ENOENT without a
+ * btree lookup if the key is definitely absent. Filters are volatile. They are
+ * built by a background scan of the catalogue, started by the first lookup,
+ * and lookups bypass a filter until it is built.
+ */
+struct m0_ctg_filter_cfg {
+	/** Memory for all filters, in bytes. 0 disables filters. */
+	m0_bcount_t cfc_budget;
+	/**
+	 * Target false positive rate, in parts per million. 0 selects the
+	 * default of 1%.
+	 */
+	uint32_t    cfc_fpr_ppm;
+};
+
+struct m0_ctg_filter_stats {
+	/** Lookups answered by a filter. */
+	uint64_t    cfs_lookup_nr;
+	/** Lookups completed with -ENOENT without a btree lookup. */
+	uint64_t    cfs_negative_nr;
+	/** Filter builds. */
+	uint64_t    cfs_build_nr;
+	/** Memory used by filters. */
+	m0_bcount_t cfs_nob;
+};
+
+/**
+ * Sets filter configuration. Existing filters are discarded and are rebuilt
+ * with the new configuration when needed.
+ */
+M0_INTERNAL void m0_ctg_filter_cfg_set(const struct m0_ctg_filter_cfg *cfg);
+
+M0_INTERNAL void m0_ctg_filter_stats_get(struct m0_ctg_filter_stats *stats);
+
 /** @} end of cas-ctg-store group */
 #endif /* __MOTR_CAS_CTG_STORE_H__ */
 
@@ -26,12 +26,17 @@
 #include "lib/memory.h"
 #include "lib/assert.h"
 #include "lib/cond.h"          /* m0_cond */
+#include "lib/atomic.h"
+#include "lib/finject.h"       /* M0_FI_ENABLED */
+#include "be/domain.h"         /* m0_be_domain_engine */
+#include "be/engine.h"         /* m0_be_engine_log_used_pct */
 #include "fop/fop.h"           /* M0_FOP_TYPE_INIT */
 #include "fop/fom_long_lock.h"
 #include "fop/fom_generic.h"
 #include "rpc/rpc_opcodes.h"
 #include "rpc/item.h"          /* M0_RPC_ITEM_TYPE_REQUEST */
 #include "cas/ctg_store.h"
+#include "cas/index_gc.h"
 #include "motr/setup.h"
 
 /**
@@ -51,6 +56,12 @@
  *                M0_FOPH_AUTHORISATION
  *                          |
  *                          V
+ *                     CGC_THROTTLE<--+
+ *                          |         | BE log is busy
+ *                          |         | (sleep gcc_pause,
+ *                          |         | gcc_pause_max times at most)
+ *                          |---------+
+ *                          V
  *                      CGC_LOOKUP
  *                          |
  *                          V
@@ -87,6 +98,22 @@
  *                          V
  *                       SUCCESS
  * @endverbatim
+ *
+ * @subsection cgc-lspec-pacing Pacing
+ *
+ * A large index is destroyed by a sequence of foms, each truncating at most
+ * m0_cas_gc_cfg::gcc_batch_max records in its own transaction and
+ * re-starting the collector (see cgc_retry()) if the tree is not empty yet.
+ * Progress is persistent: every committed transaction leaves a smaller tree,
+ * and an index which is still referenced by the "dead index" catalogue at
+ * start-up is picked up again by m0_cas_gc_start().
+ *
+ * Each fom first waits in CGC_THROTTLE while BE log usage is above
+ * m0_cas_gc_cfg::gcc_log_used_max, so that the collector does not compete
+ * with foreground requests for log space. The wait is bounded by
+ * m0_cas_gc_cfg::gcc_pause_max back-offs: under sustained foreground load the
+ * collector still deletes a batch every gcc_pause_max * gcc_pause, instead of
+ * postponing destruction indefinitely.
  */
 
 
@@ -105,6 +132,7 @@ enum cgc_fom_phase {
 	CGC_LOCK_DEAD_INDEX,
 	CGC_RM_FROM_DEAD_INDEX,
 	CGC_SUCCESS,
+	CGC_THROTTLE,
 	CGC_NR
 };
 
@@ -119,6 +147,9 @@ struct cgc_fom {
 	struct m0_buf              cg_ctg_key;
 	struct m0_reqh            *cg_reqh;
 	m0_bcount_t                cg_del_limit;
+	struct m0_fom_timeout      cg_timeout;
+	/** Number of back-offs in CGC_THROTTLE. */
+	uint32_t                   cg_pause_nr;
 };
 
 struct cgc_context {
@@ -127,10 +158,23 @@ struct cgc_context {
 	int              cgc_running;
 	bool             cgc_waiting;
 	struct m0_be_op *cgc_op;
+	/** BE domain of the catalogue store, set by m0_cas_gc_start(). */
+	struct m0_be_domain *cgc_dom;
+	struct m0_atomic64   cgc_tx_nr;
+	struct m0_atomic64   cgc_pause_nr;
+	struct m0_atomic64   cgc_forced_nr;
+	struct m0_atomic64   cgc_index_nr;
 };
 
 static struct cgc_context gc;
 
+static struct m0_cas_gc_cfg gc_cfg = {
+	.gcc_batch_max    = M0_CAS_GC_BATCH_MAX,
+	.gcc_log_used_max = M0_CAS_GC_LOG_USED_MAX,
+	.gcc_pause        = 100 * M0_TIME_ONE_MSEC,
+	.gcc_pause_max    = M0_CAS_GC_PAUSE_MAX
+};
+
 static const struct m0_fom_ops cgc_fom_ops = {
 	.fo_fini          = &cgc_fom_fini,
 	.fo_tick          = &cgc_fom_tick,
@@ -144,6 +188,10 @@ static const struct m0_fom_type_ops cgc_fom_type_ops = {
 };
 
 static struct m0_sm_state_descr cgc_fom_phases[] = {
+	[CGC_THROTTLE] = {
+		.sd_name      = "cgc-throttle",
+		.sd_allowed   = M0_BITS(CGC_LOOKUP)
+	},
 	[CGC_LOOKUP] = {
 		.sd_name      = "cgc-lookup",
 		.sd_allowed   = M0_BITS(CGC_INDEX_FOUND)
@@ -180,7 +228,8 @@ static struct m0_sm_state_descr cgc_fom_phases[] = {
 
 struct m0_sm_trans_descr cgc_fom_trans[] = {
 	[ARRAY_SIZE(m0_generic_phases_trans)] =
-	{ "cgc-starting",     M0_FOPH_TXN_INIT,        CGC_LOOKUP },
+	{ "cgc-starting",     M0_FOPH_TXN_INIT,        CGC_THROTTLE },
+	{ "cgc-log-ready",    CGC_THROTTLE,            CGC_LOOKUP },
 	{ "cgc-index-lookup", CGC_LOOKUP,              CGC_INDEX_FOUND },
 	{ "cgc-start-txn",    CGC_INDEX_FOUND,         M0_FOPH_TXN_INIT },
 	{ "cgc-no-job",       CGC_INDEX_FOUND,         M0_FOPH_SUCCESS },
@@ -207,6 +256,44 @@ static size_t cgc_fom_home_locality(const struct m0_fom *fom)
 	return 0;
 }
 
+static bool cgc_log_is_busy(void)
+{
+	if (M0_FI_ENABLED("log_busy"))
+		return true;
+	return gc.cgc_dom != NULL &&
+		m0_be_engine_log_used_pct(m0_be_domain_engine(gc.cgc_dom)) >
+		gc_cfg.gcc_log_used_max;
+}
+
+/**
+ * Arms a back-off timeout and returns true if the fom has to wait for BE log
+ * space, see @ref cgc-lspec-pacing.
+ */
+static bool cgc_throttle(struct cgc_fom *fom)
+{
+	int rc;
+
+	if (!cgc_log_is_busy())
+		return false;
+	if (fom->cg_pause_nr >= gc_cfg.gcc_pause_max) {
+		M0_LOG(M0_DEBUG, "BE log is busy, minimum-rate pass");
+		m0_atomic64_inc(&gc.cgc_forced_nr);
+		return false;
+	}
+	/* Timer has to be re-initialised before re-arming. */
+	m0_fom_timeout_fini(&fom->cg_timeout);
+	m0_fom_timeout_init(&fom->cg_timeout);
+	rc = m0_fom_timeout_wait_on(&fom->cg_timeout, &fom->cg_fom,
+				    m0_time_add(m0_time_now(),
+						gc_cfg.gcc_pause));
+	if (rc != 0)
+		return false;
+	M0_LOG(M0_DEBUG, "BE log is busy, back off");
+	m0_atomic64_inc(&gc.cgc_pause_nr);
+	fom->cg_pause_nr++;
+	return true;
+}
+
 static int cgc_fom_tick(struct m0_fom *fom0)
 {
 	struct cgc_fom   *fom    = M0_AMB(fom, fom0, cg_fom);
@@ -252,7 +339,7 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 				result = M0_FSO_AGAIN;
 				break;
 			}
-			m0_fom_phase_set(fom0, CGC_LOOKUP);
+			m0_fom_phase_set(fom0, CGC_THROTTLE);
 		}
 		/*
 		 * Intercept generic fom control flow control after transaction
@@ -268,6 +355,13 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 		if (phase == M0_FOPH_TXN_COMMIT)
 			m0_fom_phase_set(fom0, M0_FOPH_TXN_COMMIT_WAIT);
 		break;
+	case CGC_THROTTLE:
+		if (cgc_throttle(fom)) {
+			result = M0_FSO_WAIT;
+			break;
+		}
+		m0_fom_phase_set(fom0, CGC_LOOKUP);
+		break;
 	case CGC_LOOKUP:
 		m0_ctg_op_init(ctg_op, fom0, 0);
 		fom->cg_ctg_op_initialized = true;
@@ -330,6 +424,7 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 		 * Must calculate credits now, after transaction init but before
 		 * its open in the generic fom.
 		 */
+		fom->cg_del_limit = gc_cfg.gcc_batch_max;
 		m0_ctg_dead_clean_credit(&fom0->fo_tx.tx_betx_cred);
 		m0_ctg_drop_credit(fom0, &fom0->fo_tx.tx_betx_cred,
 				   fom->cg_ctg, &fom->cg_del_limit);
@@ -347,6 +442,7 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 		 */
 		m0_ctg_op_init(ctg_op, fom0, 0);
 		fom->cg_ctg_op_initialized = true;
+		m0_atomic64_inc(&gc.cgc_tx_nr);
 		result = m0_ctg_truncate(ctg_op, fom->cg_ctg,
 					 fom->cg_del_limit,
 					 CGC_TREE_DROP);
@@ -399,6 +495,7 @@ static int cgc_fom_tick(struct m0_fom *fom0)
 			       &fom->cg_dead_index);
 		m0_ctg_op_fini(ctg_op);
 		fom->cg_ctg_op_initialized = false;
+		m0_atomic64_inc(&gc.cgc_index_nr);
 		/*
 		 * Retry: maybe, have more trees to drop.
 		 */
@@ -429,12 +526,17 @@ M0_INTERNAL void m0_cas_gc_init(void)
 	m0_sm_conf_extend(m0_generic_conf.scf_state, cgc_fom_phases,
 			  m0_generic_conf.scf_nr_states);
 	m0_sm_conf_trans_extend(&m0_generic_conf, &cgc_sm_conf);
-	cgc_fom_phases[M0_FOPH_TXN_INIT].sd_allowed |= M0_BITS(CGC_LOOKUP);
+	cgc_fom_phases[M0_FOPH_TXN_INIT].sd_allowed |= M0_BITS(CGC_THROTTLE);
 	cgc_fom_phases[M0_FOPH_TXN_OPEN].sd_allowed |= M0_BITS(CGC_CREDITS);
 	m0_sm_conf_init(&cgc_sm_conf);
 	m0_mutex_init(&gc.cgc_mutex);
 	m0_cond_init(&gc.cgc_cond, &gc.cgc_mutex);
 	gc.cgc_running = 0;
+	gc.cgc_dom = NULL;
+	m0_atomic64_set(&gc.cgc_tx_nr, 0);
+	m0_atomic64_set(&gc.cgc_pause_nr, 0);
+	m0_atomic64_set(&gc.cgc_forced_nr, 0);
+	m0_atomic64_set(&gc.cgc_index_nr, 0);
 
 	/*
 	 * Actually we do not need a fop. But generic fom wants it, and it must
@@ -489,6 +591,7 @@ static void cgc_start_fom(struct m0_fom *fom0, struct m0_fop *fop)
 		    &cgc_fom_ops, fop, NULL, fom->cg_reqh);
 	fom0->fo_local = true;
 	fom->cg_ctg_op_initialized = false;
+	m0_fom_timeout_init(&fom->cg_timeout);
 	m0_long_lock_link_init(&fom->cg_dead_index, fom0,
 			       &fom->cg_dead_index_addb2);
 	m0_fom_queue(fom0);
@@ -521,6 +624,7 @@ static void cgc_fom_fini(struct m0_fom *fom0)
 	fom0->fo_fop = NULL;
 	m0_fom_fini(fom0);
 	m0_long_lock_link_fini(&fom->cg_dead_index);
+	m0_fom_timeout_fini(&fom->cg_timeout);
 	/*
 	 * If have more job to do, start another fom using current fom memory.
 	 */
@@ -578,6 +682,7 @@ M0_INTERNAL void m0_cas_gc_start(struct m0_reqh_service *service)
 			if (rc == 0)
 				m0_ctg_store_fini();
 		} else {
+			gc.cgc_dom = dom;
 			fom->cg_reqh = reqh;
 			cgc_start_fom(&fom->cg_fom, &fom->cg_fop);
 			gc.cgc_running++;
@@ -614,6 +719,28 @@ M0_INTERNAL void m0_cas_gc_wait_async(struct m0_be_op *beop)
 	M0_LEAVE();
 }
 
+M0_INTERNAL void m0_cas_gc_cfg_set(const struct m0_cas_gc_cfg *cfg)
+{
+	m0_mutex_lock(&gc.cgc_mutex);
+	gc_cfg = *cfg;
+	m0_mutex_unlock(&gc.cgc_mutex);
+}
+
+M0_INTERNAL void m0_cas_gc_cfg_get(struct m0_cas_gc_cfg *cfg)
+{
+	m0_mutex_lock(&gc.cgc_mutex);
+	*cfg = gc_cfg;
+	m0_mutex_unlock(&gc.cgc_mutex);
+}
+
+M0_INTERNAL void m0_cas_gc_stats_get(struct m0_cas_gc_stats *stats)
+{
+	stats->gcs_tx_nr     = m0_atomic64_get(&gc.cgc_tx_nr);
+	stats->gcs_pause_nr  = m0_atomic64_get(&gc.cgc_pause_nr);
+	stats->gcs_forced_nr = m0_atomic64_get(&gc.cgc_forced_nr);
+	stats->gcs_index_nr  = m0_atomic64_get(&gc.cgc_index_nr);
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /*
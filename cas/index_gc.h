@@ -25,10 +25,53 @@
 #ifndef __MOTR_CAS_INDEX_GC_H__
 #define __MOTR_CAS_INDEX_GC_H__
 
+#include "lib/types.h"
+#include "lib/time.h"          /* m0_time_t */
+
 /* Import */
 struct m0_reqh;
 struct m0_be_op;
 
+/**
+ * Index garbage collector pacing.
+ *
+ * An index is destroyed by a sequence of transactions, each deleting at most
+ * gcc_batch_max records. Before each transaction the collector checks BE log
+ * usage and, while it is above gcc_log_used_max percents, sleeps for
+ * gcc_pause, so that destruction of a large index leaves log space to the
+ * foreground requests. After gcc_pause_max consecutive back-offs the
+ * transaction is started anyway, so that the collector makes progress at
+ * least at the minimum rate of gcc_batch_max records per
+ * gcc_pause_max * gcc_pause.
+ */
+struct m0_cas_gc_cfg {
+	/** Maximum number of records deleted in a transaction, 0: no limit. */
+	uint64_t  gcc_batch_max;
+	/** BE log usage, in percents, above which the collector backs off. */
+	uint32_t  gcc_log_used_max;
+	/** Back-off interval. */
+	m0_time_t gcc_pause;
+	/** Maximum number of consecutive back-offs, 0: no back-offs. */
+	uint32_t  gcc_pause_max;
+};
+
+enum {
+	M0_CAS_GC_BATCH_MAX    = 8192,
+	M0_CAS_GC_LOG_USED_MAX = 50,
+	M0_CAS_GC_PAUSE_MAX    = 50
+};
+
+struct m0_cas_gc_stats {
+	/** Number of truncation transactions. */
+	uint64_t gcs_tx_nr;
+	/** Number of back-offs because of BE log usage. */
+	uint64_t gcs_pause_nr;
+	/** Number of transactions started after gcc_pause_max back-offs. */
+	uint64_t gcs_forced_nr;
+	/** Number of destroyed indices. */
+	uint64_t gcs_index_nr;
+};
+
 /** Initialises index garbage collector. */
 M0_INTERNAL void m0_cas_gc_init(void);
 
@@ -63,6 +106,15 @@ M0_INTERNAL void m0_cas_gc_wait_async(struct m0_be_op *beop);
  */
 M0_INTERNAL void m0_cas_gc_wait_sync(void);
 
+/**
+ * Sets garbage collector pacing. Takes effect from the next transaction.
+ */
+M0_INTERNAL void m0_cas_gc_cfg_set(const struct m0_cas_gc_cfg *cfg);
+
+M0_INTERNAL void m0_cas_gc_cfg_get(struct m0_cas_gc_cfg *cfg);
+
+M0_INTERNAL void m0_cas_gc_stats_get(struct m0_cas_gc_stats *stats);
+
 #endif /* __MOTR_CAS_INDEX_GC_H__ */
 
 /*
@@ -30,6 +30,7 @@
 #include "lib/misc.h"                /* M0_IN */
 #include "lib/errno.h"               /* ENOMEM, EPROTO */
 #include "lib/ext.h"
+#include "lib/slab.h"
 #include "fop/fom_long_lock.h"
 #include "fop/fom_generic.h"
 #include "fop/fom_interpose.h"
@@ -328,6 +329,15 @@ struct cas_fom {
 	bool                      cf_op_checked;
 	uint64_t                  cf_curpos;
 	bool                      cf_startkey_excluded;
+	/**
+	 * CAS-CUR iteration from the current start key is stopped by the
+	 * iteration bound or by the reply budget.
+	 */
+	bool                      cf_cur_end;
+	/** CAS-CUR reply budget is exhausted, see m0_cas_op::cg_budget. */
+	bool                      cf_out_full;
+	/** Number of key and value bytes placed in CAS-CUR reply. */
+	m0_bcount_t               cf_out_nob;
 	/**
 	 * Key/value pairs from incoming FOP.
 	 * They are loaded once from incoming RPC AT buffers
@@ -502,9 +512,13 @@ static const struct m0_fom_ops               cas_fom_ops;
 static const struct m0_fom_type_ops          cas_fom_type_ops;
 static       struct m0_sm_conf               cas_sm_conf;
 static       struct m0_sm_state_descr        cas_fom_phases[];
+/** Cache of cas foms, see lib/slab.h. */
+static       struct m0_slab                  cas_fom_slab;
 
 M0_INTERNAL void m0_cas_svc_init(void)
 {
+	m0_slab_init(&cas_fom_slab, "cas-fom", sizeof(struct cas_fom),
+		     NULL, NULL);
 	m0_sm_conf_extend(m0_generic_conf.scf_state, cas_fom_phases,
 			  m0_generic_conf.scf_nr_states);
 	m0_sm_conf_trans_extend(&m0_generic_conf, &cas_sm_conf);
@@ -522,6 +536,7 @@ M0_INTERNAL void m0_cas_svc_fini(void)
 	m0_cas_gc_fini();
 	m0_reqh_service_type_unregister(&m0_cas_service_type);
 	m0_sm_conf_fini(&cas_sm_conf);
+	m0_slab_fini(&cas_fom_slab);
 }
 
 M0_INTERNAL void m0_cas_svc_fop_args(struct m0_sm_conf            **sm_conf,
@@ -560,6 +575,10 @@ static int cas_service_start(struct m0_reqh_service *svc)
 	service->c_be_domain = ut_dom != NULL ?
 			       ut_dom : svc->rs_reqh_ctx->rc_beseg->bs_domain;
 	rc = m0_ctg_store_init(service->c_be_domain);
+	if (rc == 0 && ut_dom == NULL)
+		m0_ctg_filter_cfg_set(&(struct m0_ctg_filter_cfg) {
+			.cfc_budget  = svc->rs_reqh_ctx->rc_cas_filter_budget,
+			.cfc_fpr_ppm = svc->rs_reqh_ctx->rc_cas_filter_fpr });
 	if (rc == 0) {
 		/*
 		 * Start deleted index garbage collector at boot to continue
@@ -637,7 +656,7 @@ static int cas_fom_create(struct m0_fop *fop,
 	if (!cas_service_started(fop, reqh))
 		return M0_ERR(-EAGAIN);
 
-	M0_ALLOC_PTR(fom);
+	fom = m0_slab_alloc(&cas_fom_slab);
 	/**
 	 * @todo Validity (cas_is_valid()) of input records is not checked here,
 	 * so "out_nr" can be bogus. Cannot check validity at this point,
@@ -688,7 +707,7 @@ static int cas_fom_create(struct m0_fop *fop,
 		m0_free(ikv);
 		m0_free(repfop);
 		m0_free(repv);
-		m0_free(fom);
+		m0_slab_free(&cas_fom_slab, fom);
 		return M0_ERR(-ENOMEM);
 	}
 }
@@ -964,6 +983,36 @@ static bool cas_key_need_to_send(struct cas_fom *fom, enum m0_cas_opcode opc,
 	return key_send;
 }
 
+/**
+ * Checks whether CAS-CUR iteration stops at the current cursor position,
+ * because of the reply budget or the iteration bound (see m0_cas_op::cg_budget
+ * and m0_cas_op::cg_bound). Returns return code of the reply record at the
+ * stop position or 0 if iteration continues.
+ */
+static int cas_cur_stop(struct cas_fom *fom, enum m0_cas_type ct,
+			const struct m0_cas_op *op)
+{
+	const struct m0_buf *bound = &op->cg_bound;
+	struct m0_buf        key;
+	struct m0_buf        val;
+
+	if (op->cg_budget != 0 && fom->cf_out_nob >= op->cg_budget) {
+		fom->cf_out_full = true;
+		fom->cf_cur_end = true;
+		return -EOVERFLOW;
+	}
+	if (ct != CT_BTREE || !(op->cg_flags & (COF_END_KEY | COF_PREFIX)))
+		return 0;
+	m0_ctg_cursor_kv_get(&fom->cf_ctg_op, &key, &val);
+	if ((op->cg_flags & COF_END_KEY) && m0_buf_cmp(&key, bound) >= 0)
+		fom->cf_cur_end = true;
+	if ((op->cg_flags & COF_PREFIX) &&
+	    (key.b_nob < bound->b_nob ||
+	     memcmp(key.b_addr, bound->b_addr, bound->b_nob) != 0))
+		fom->cf_cur_end = true;
+	return fom->cf_cur_end ? -ENOENT : 0;
+}
+
 static void cas_fom_cleanup(struct cas_fom *fom, bool ctg_op_fini)
 {
 	struct m0_ctg_op  *ctg_op     = &fom->cf_ctg_op;
@@ -1348,8 +1397,10 @@ static int cas_fom_tick(struct m0_fom *fom0)
 			fom->cf_ipos = ++ipos;
 		/* If all input has been processed... */
 		if (ipos == op->cg_rec.cr_nr ||
-		    /* ... or all output has been generated. */
-		    fom->cf_opos == rep->cgr_rep.cr_nr) {
+		    /* ... or all output has been generated... */
+		    fom->cf_opos == rep->cgr_rep.cr_nr ||
+		    /* ... or CAS-CUR reply budget is exhausted. */
+		    fom->cf_out_full) {
 			/*
 			 * Check reply payload size against max RPC item payload
 			 * size.
@@ -1534,6 +1585,8 @@ static int cas_fom_tick(struct m0_fom *fom0)
 		M0_ASSERT(rec != NULL);
 		if (rec->cr_rc == 0) {
 			rec->cr_rc = m0_ctg_op_rc(ctg_op);
+			if (rec->cr_rc == 0 && opc == CO_CUR)
+				rec->cr_rc = cas_cur_stop(fom, ct, op);
 			if (rec->cr_rc == 0) {
 				if (cas_key_need_to_send(fom, opc, ct, op,
 							 ipos)){
@@ -1567,7 +1620,8 @@ static int cas_fom_tick(struct m0_fom *fom0)
 		m0_fom_phase_set(fom0, CAS_SEND_VAL);
 		break;
 	case CAS_SEND_VAL:
-		if (ct == CT_BTREE && M0_IN(opc, (CO_GET, CO_CUR)))
+		if (ct == CT_BTREE && (opc == CO_GET ||
+		    (opc == CO_CUR && !(op->cg_flags & COF_KEYS_ONLY))))
 			result = cas_val_send(fom, op, opc, rep, CAS_VAL_SENT);
 		else
 			m0_fom_phase_set(fom0, CAS_DONE);
@@ -1613,7 +1667,7 @@ static void cas_fom_fini(struct m0_fom *fom0)
 	m0_long_lock_link_fini(&fom->cf_dead_index);
 	m0_long_lock_link_fini(&fom->cf_del_lock);
 	m0_fom_fini(fom0);
-	m0_free(fom);
+	m0_slab_free(&cas_fom_slab, fom);
 	if (cas_in_ut() && cas__ut_cb_fini != NULL)
 		cas__ut_cb_fini(fom0);
 }
@@ -2271,9 +2325,13 @@ static int cas_prep_send(struct cas_fom *fom, enum m0_cas_opcode opc,
 	case CTG_OP_COMBINE(CO_CUR, CT_META):
 		m0_ctg_cursor_kv_get(ctg_op, &key, &val);
 		rc = cas_place(&fom->cf_out_key, &key, rpc_cutoff);
-		if (ct == CT_BTREE && rc == 0)
+		if (ct == CT_BTREE && rc == 0 &&
+		    !(cas_op(&fom->cf_fom)->cg_flags & COF_KEYS_ONLY))
 			rc = cas_place(&fom->cf_out_val, &val,
 				       rpc_cutoff);
+		if (rc == 0)
+			fom->cf_out_nob += fom->cf_out_key.b_nob +
+					   fom->cf_out_val.b_nob;
 		break;
 	}
 
@@ -2299,7 +2357,7 @@ static int cas_done(struct cas_fom *fom, struct m0_cas_op *op,
 		if (rc == 0 && ctg_rc == 0)
 			rc = fom->cf_startkey_excluded ?
 				fom->cf_curpos - 1 : fom->cf_curpos;
-		if (ctg_rc == 0 &&
+		if (ctg_rc == 0 && !fom->cf_cur_end &&
 		    ((fom->cf_curpos < rec->cr_rc) ||
 		     (fom->cf_startkey_excluded &&
 		      (fom->cf_curpos < rec->cr_rc + 1)))) {
@@ -2314,6 +2372,7 @@ static int cas_done(struct cas_fom *fom, struct m0_cas_op *op,
 			m0_ctg_cursor_put(&fom->cf_ctg_op);
 			fom->cf_curpos = 0;
 			fom->cf_startkey_excluded = false;
+			fom->cf_cur_end = false;
 		}
 	} else
 		m0_ctg_op_fini(&fom->cf_ctg_op);
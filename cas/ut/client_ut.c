@@ -36,6 +36,7 @@
 #include "ut/ut.h"
 #include "cas/client.h"
 #include "cas/ctg_store.h"             /* m0_ctg_recs_nr */
+#include "lib/byteorder.h"             /* m0_byteorder_cpu_to_be64 */
 #include "lib/finject.h"
 
 #define SERVER_LOG_FILE_NAME       "cas_server.log"
@@ -522,13 +523,15 @@ static void ut_next_rep_clear(struct m0_cas_next_reply *rep, uint64_t nr)
 	}
 }
 
-static int ut_next_rec(struct cl_ctx            *cctx,
-		       struct m0_cas_id         *index,
-		       struct m0_bufvec         *start_keys,
-		       uint32_t                 *recs_nr,
-		       struct m0_cas_next_reply *rep,
-		       uint64_t                 *count,
-		       uint32_t                  flags)
+static int ut_next_rec_bounded(struct cl_ctx            *cctx,
+			       struct m0_cas_id         *index,
+			       struct m0_bufvec         *start_keys,
+			       uint32_t                 *recs_nr,
+			       struct m0_cas_next_reply *rep,
+			       uint64_t                 *count,
+			       uint32_t                  flags,
+			       const struct m0_buf      *bound,
+			       m0_bcount_t               budget)
 {
 	struct m0_cas_req  req;
 	struct m0_chan    *chan;
@@ -539,6 +542,9 @@ static int ut_next_rec(struct cl_ctx            *cctx,
 	M0_SET0(&req);
 	m0_cas_req_init(&req, &cctx->cl_rpc_ctx.rcx_session,
 			m0_locality0_get()->lo_grp);
+	if (bound != NULL)
+		req.ccr_next_bound = *bound;
+	req.ccr_next_budget = budget;
 	chan = &req.ccr_sm.sm_chan;
 	M0_UT_ASSERT(chan != NULL);
 	m0_clink_init(&cctx->cl_wait.aw_clink, NULL);
@@ -570,6 +576,18 @@ static int ut_next_rec(struct cl_ctx            *cctx,
 	return rc;
 }
 
+static int ut_next_rec(struct cl_ctx            *cctx,
+		       struct m0_cas_id         *index,
+		       struct m0_bufvec         *start_keys,
+		       uint32_t                 *recs_nr,
+		       struct m0_cas_next_reply *rep,
+		       uint64_t                 *count,
+		       uint32_t                  flags)
+{
+	return ut_next_rec_bounded(cctx, index, start_keys, recs_nr, rep,
+				   count, flags, NULL, 0);
+}
+
 static int ut_rec_del(struct cl_ctx           *cctx,
 		      struct m0_cas_id        *index,
 		      struct m0_bufvec        *keys,
@@ -1376,6 +1394,114 @@ static void next_fail(void)
 	casc_ut_fini(&casc_ut_sctx, &casc_ut_cctx);
 }
 
+/**
+ * Checks iteration bounded by the end key, by the key prefix and by the reply
+ * budget. Keys are big-endian, so that their order in the catalogue is the
+ * numeric one, and i-th key shares 7-byte prefix with keys of the same i / 8.
+ */
+static void next_bounded(void)
+{
+	struct m0_cas_rec_reply  rep[COUNT];
+	struct m0_cas_next_reply next_rep[COUNT];
+	const struct m0_fid      ifid = IFID(2, 3);
+	struct m0_cas_id         index = {};
+	struct m0_bufvec         keys;
+	struct m0_bufvec         values;
+	struct m0_bufvec         start_key;
+	uint64_t                 bound_key;
+	struct m0_buf            bound;
+	uint32_t                 recs_nr;
+	uint64_t                 rep_count;
+	int                      rc;
+	int                      i;
+
+	casc_ut_init(&casc_ut_sctx, &casc_ut_cctx);
+
+	M0_SET_ARR0(rep);
+	M0_SET_ARR0(next_rep);
+	rc = m0_bufvec_alloc(&keys, COUNT, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_bufvec_alloc(&values, COUNT, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	for (i = 0; i < COUNT; i++) {
+		*(uint64_t *)keys.ov_buf[i] =
+			m0_byteorder_cpu_to_be64((i / 8) << 8 | i % 8);
+		*(uint64_t *)values.ov_buf[i] = i * i;
+	}
+	rc = ut_idx_create(&casc_ut_cctx, &ifid, 1, rep);
+	M0_UT_ASSERT(rc == 0);
+	index.ci_fid = ifid;
+	rc = ut_rec_put(&casc_ut_cctx, &index, &keys, &values, rep, 0);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, COUNT, rep[i].crr_rc == 0));
+	rc = m0_bufvec_alloc(&start_key, 1, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	*(uint64_t *)start_key.ov_buf[0] = *(uint64_t *)keys.ov_buf[0];
+	recs_nr = COUNT;
+
+	/* Iteration stops before the end key. */
+	bound_key = *(uint64_t *)keys.ov_buf[10];
+	bound = M0_BUF_INIT_PTR(&bound_key);
+	rc = ut_next_rec_bounded(&casc_ut_cctx, &index, &start_key, &recs_nr,
+				 next_rep, &rep_count, COF_END_KEY, &bound, 0);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, 10, next_rep[i].cnp_rc == 0 &&
+			       next_rep_equals(&next_rep[i], keys.ov_buf[i],
+					       values.ov_buf[i])));
+	M0_UT_ASSERT(next_rep[10].cnp_rc == -ENOENT);
+	ut_next_rep_clear(next_rep, rep_count);
+
+	/* Iteration stops at the first key without the prefix. */
+	bound = M0_BUF_INIT(7, keys.ov_buf[8]);
+	*(uint64_t *)start_key.ov_buf[0] = *(uint64_t *)keys.ov_buf[9];
+	rc = ut_next_rec_bounded(&casc_ut_cctx, &index, &start_key, &recs_nr,
+				 next_rep, &rep_count,
+				 COF_PREFIX | COF_KEYS_ONLY, &bound, 0);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, 7, next_rep[i].cnp_rc == 0 &&
+			       next_rep[i].cnp_val.b_nob == 0 &&
+			       memcmp(next_rep[i].cnp_key.b_addr,
+				      keys.ov_buf[i + 9],
+				      sizeof(uint64_t)) == 0));
+	M0_UT_ASSERT(next_rep[7].cnp_rc == -ENOENT);
+	ut_next_rep_clear(next_rep, rep_count);
+
+	/*
+	 * Iteration stops after the record which exhausts the budget, the next
+	 * record reports truncation.
+	 */
+	*(uint64_t *)start_key.ov_buf[0] = *(uint64_t *)keys.ov_buf[0];
+	rc = ut_next_rec_bounded(&casc_ut_cctx, &index, &start_key, &recs_nr,
+				 next_rep, &rep_count, 0, NULL,
+				 2 * sizeof(uint64_t) * 3 - 1);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_forall(i, 3, next_rep[i].cnp_rc == 0 &&
+			       next_rep_equals(&next_rep[i], keys.ov_buf[i],
+					       values.ov_buf[i])));
+	M0_UT_ASSERT(next_rep[3].cnp_rc == -EOVERFLOW);
+	ut_next_rep_clear(next_rep, rep_count);
+
+	/* Continue from the last returned key. */
+	*(uint64_t *)start_key.ov_buf[0] = *(uint64_t *)keys.ov_buf[2];
+	rc = ut_next_rec_bounded(&casc_ut_cctx, &index, &start_key, &recs_nr,
+				 next_rep, &rep_count,
+				 COF_EXCLUDE_START_KEY | COF_KEYS_ONLY, NULL,
+				 sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(next_rep[0].cnp_rc == 0);
+	M0_UT_ASSERT(memcmp(next_rep[0].cnp_key.b_addr, keys.ov_buf[3],
+			    sizeof(uint64_t)) == 0);
+	M0_UT_ASSERT(next_rep[1].cnp_rc == -EOVERFLOW);
+	ut_next_rep_clear(next_rep, rep_count);
+
+	rc = ut_idx_delete(&casc_ut_cctx, &ifid, 1, rep);
+	M0_UT_ASSERT(rc == 0);
+	m0_bufvec_free(&start_key);
+	m0_bufvec_free(&keys);
+	m0_bufvec_free(&values);
+	casc_ut_fini(&casc_ut_sctx, &casc_ut_cctx);
+}
+
 static void next_multi_common(struct m0_bufvec *keys, struct m0_bufvec *values)
 {
 	struct m0_cas_rec_reply  rep[COUNT];
@@ -2624,6 +2750,7 @@ struct m0_ut_suite cas_client_ut = {
 		{ "idx-list-fail",          idx_list_fail,          "Leonid" },
 		{ "next",                   next,                   "Leonid" },
 		{ "next-fail",              next_fail,              "Leonid" },
+		{ "next-bounded",           next_bounded,           "Leonid" },
 		{ "next-multi",             next_multi,             "Egor"   },
 		{ "next-bulk",              next_bulk,              "Leonid" },
 		{ "next-multi-bulk",        next_multi_bulk,        "Leonid" },
@@ -34,6 +34,7 @@
 #include "lib/finject.h"
 #include "lib/semaphore.h"
 #include "lib/byteorder.h"
+#include "lib/time.h"                     /* m0_nanosleep */
 #include "fop/fop.h"
 #include "reqh/reqh.h"
 #include "reqh/reqh_service.h"
@@ -41,6 +42,8 @@
 
 #include "cas/cas.h"
 #include "cas/cas_xc.h"
+#include "cas/ctg_store.h"                /* m0_ctg_filter_cfg_set */
+#include "cas/index_gc.h"                 /* m0_cas_gc_cfg_set */
 #include "rpc/at.h"
 #include "fdmi/fdmi.h"
 #include "rpc/rpc_machine.h"
@@ -1141,6 +1144,81 @@ static void lookup_N(void)
 	fini();
 }
 
+/** Issues lookups until the negative lookup filter is built. */
+static void filter_build_wait(struct m0_fid *index)
+{
+	struct m0_ctg_filter_stats st0;
+	struct m0_ctg_filter_stats st;
+	int                        i;
+
+	m0_ctg_filter_stats_get(&st0);
+	for (i = 0; i < 10000; ++i) {
+		index_op(&cas_get_fopt, index, CB(1), NOVAL);
+		m0_ctg_filter_stats_get(&st);
+		if (st.cfs_build_nr > st0.cfs_build_nr)
+			break;
+		m0_nanosleep(M0_TIME_ONE_MSEC, NULL);
+	}
+	M0_UT_ASSERT(st.cfs_build_nr == st0.cfs_build_nr + 1);
+}
+
+/**
+ * Test lookups with the negative lookup filter: lookups are correct while the
+ * filter is built in the background, absent keys are answered by the filter,
+ * inserted keys are always found, the filter is rebuilt after deletions.
+ */
+static void lookup_filter(void)
+{
+	struct m0_ctg_filter_stats st0;
+	struct m0_ctg_filter_stats st;
+	uint64_t                   neg;
+	int                        i;
+
+	m0_ctg_filter_cfg_set(&(struct m0_ctg_filter_cfg) {
+			.cfc_budget = 1 << 20 });
+	init();
+	meta_fid_submit(&cas_put_fopt, &ifid);
+	insert_odd(&ifid);
+	/* The first lookups start the build and bypass the filter. */
+	lookup_all(&ifid);
+	filter_build_wait(&ifid);
+	m0_ctg_filter_stats_get(&st0);
+	lookup_all(&ifid);
+	m0_ctg_filter_stats_get(&st);
+	M0_UT_ASSERT(st.cfs_build_nr == st0.cfs_build_nr);
+	M0_UT_ASSERT(st.cfs_lookup_nr == st0.cfs_lookup_nr + INSERTS - 1);
+	neg = st.cfs_negative_nr - st0.cfs_negative_nr;
+	M0_UT_ASSERT(neg <= INSERTS / 2 && neg >= INSERTS / 2 * 9 / 10);
+	M0_UT_ASSERT(st.cfs_nob > 0);
+	/* Keys inserted after the build are found. */
+	for (i = 2; i < INSERTS; i += 2) {
+		index_op(&cas_put_fopt, &ifid, CB(i), i*i);
+		M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	}
+	m0_ctg_filter_stats_get(&st0);
+	for (i = 1; i < INSERTS; ++i) {
+		index_op(&cas_get_fopt, &ifid, CB(i), NOVAL);
+		M0_UT_ASSERT(rep_check(0, 0, BUNSET, BSET));
+	}
+	m0_ctg_filter_stats_get(&st);
+	M0_UT_ASSERT(st.cfs_negative_nr == st0.cfs_negative_nr);
+	/* Deletions drop the filter, lookups rebuild it. */
+	for (i = 1; i < INSERTS; ++i) {
+		index_op(&cas_del_fopt, &ifid, CB(i), NOVAL);
+		M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	}
+	filter_build_wait(&ifid);
+	m0_ctg_filter_stats_get(&st0);
+	for (i = 1; i < INSERTS; ++i) {
+		index_op(&cas_get_fopt, &ifid, CB(i), NOVAL);
+		M0_UT_ASSERT(rep_check(0, -ENOENT, BUNSET, BUNSET));
+	}
+	m0_ctg_filter_stats_get(&st);
+	M0_UT_ASSERT(st.cfs_negative_nr == st0.cfs_negative_nr + INSERTS - 1);
+	fini();
+	m0_ctg_filter_cfg_set(&(struct m0_ctg_filter_cfg) {});
+}
+
 /**
  * Test lookup after restart.
  */
@@ -1943,6 +2021,98 @@ static void create_insert_drop_fail()
 	create_insert_drop_with_fail(true);
 }
 
+/**
+ * Index GC destroys a big index by bounded transactions and backs off while
+ * BE log is busy.
+ */
+static void drop_batched(void)
+{
+	struct m0_cas_id       nonce = { .ci_fid = IFID(2, 3) };
+	struct m0_cas_gc_cfg   cfg0;
+	struct m0_cas_gc_stats st0;
+	struct m0_cas_gc_stats st;
+	int                    i;
+
+	m0_cas_gc_cfg_get(&cfg0);
+	m0_cas_gc_cfg_set(&(struct m0_cas_gc_cfg) {
+			.gcc_batch_max    = 32,
+			.gcc_log_used_max = cfg0.gcc_log_used_max,
+			.gcc_pause        = M0_TIME_ONE_MSEC,
+			.gcc_pause_max    = cfg0.gcc_pause_max });
+	_init(true, false);
+	meta_fop_submit(&cas_put_fopt, (struct meta_rec[]) {{ .cid = nonce }},
+			1);
+	M0_UT_ASSERT(rep.cgr_rc == 0);
+	for (i = 0; i < BIG_ROWS_NUMBER; ++i) {
+		index_op(&cas_put_fopt, &nonce.ci_fid, i + 1, i + 2);
+		M0_UT_ASSERT(rep.cgr_rc == 0);
+		M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	}
+	m0_cas_gc_stats_get(&st0);
+	/* Pretend that BE log is busy for the first two checks. */
+	m0_fi_enable_off_n_on_m("cgc_log_is_busy", "log_busy", 0, 2);
+	meta_fop_submit(&cas_del_fopt, (struct meta_rec[]) {{ .cid = nonce }},
+			1);
+	M0_UT_ASSERT(rep.cgr_rc == 0);
+	meta_fop_submit(&cas_gc_fopt, (struct meta_rec[]) {{ .cid = nonce }},
+			1);
+	m0_fi_disable("cgc_log_is_busy", "log_busy");
+	m0_cas_gc_stats_get(&st);
+	M0_UT_ASSERT(st.gcs_index_nr == st0.gcs_index_nr + 1);
+	M0_UT_ASSERT(st.gcs_tx_nr - st0.gcs_tx_nr >= BIG_ROWS_NUMBER / 32);
+	M0_UT_ASSERT(st.gcs_pause_nr == st0.gcs_pause_nr + 2);
+	meta_fop_submit(&cas_get_fopt, (struct meta_rec[]) {{ .cid = nonce }},
+			1);
+	M0_UT_ASSERT(rep_check(0, -ENOENT, BUNSET, BUNSET));
+	fini();
+	m0_cas_gc_cfg_set(&cfg0);
+}
+
+/**
+ * Index GC progresses at the minimum rate when BE log stays busy: each
+ * transaction is started after gcc_pause_max back-offs.
+ */
+static void drop_throttled(void)
+{
+	struct m0_cas_id       nonce = { .ci_fid = IFID(2, 3) };
+	struct m0_cas_gc_cfg   cfg0;
+	struct m0_cas_gc_stats st0;
+	struct m0_cas_gc_stats st;
+	int                    i;
+
+	m0_cas_gc_cfg_get(&cfg0);
+	m0_cas_gc_cfg_set(&(struct m0_cas_gc_cfg) {
+			.gcc_batch_max    = BIG_ROWS_NUMBER / 4,
+			.gcc_log_used_max = cfg0.gcc_log_used_max,
+			.gcc_pause        = M0_TIME_ONE_MSEC,
+			.gcc_pause_max    = 2 });
+	_init(true, false);
+	meta_fop_submit(&cas_put_fopt, (struct meta_rec[]) {{ .cid = nonce }},
+			1);
+	M0_UT_ASSERT(rep.cgr_rc == 0);
+	for (i = 0; i < BIG_ROWS_NUMBER; ++i) {
+		index_op(&cas_put_fopt, &nonce.ci_fid, i + 1, i + 2);
+		M0_UT_ASSERT(rep.cgr_rc == 0);
+		M0_UT_ASSERT(rep_check(0, 0, BUNSET, BUNSET));
+	}
+	m0_cas_gc_stats_get(&st0);
+	m0_fi_enable("cgc_log_is_busy", "log_busy");
+	meta_fop_submit(&cas_del_fopt, (struct meta_rec[]) {{ .cid = nonce }},
+			1);
+	M0_UT_ASSERT(rep.cgr_rc == 0);
+	meta_fop_submit(&cas_gc_fopt, (struct meta_rec[]) {{ .cid = nonce }},
+			1);
+	m0_fi_disable("cgc_log_is_busy", "log_busy");
+	m0_cas_gc_stats_get(&st);
+	M0_UT_ASSERT(st.gcs_index_nr == st0.gcs_index_nr + 1);
+	M0_UT_ASSERT(st.gcs_forced_nr - st0.gcs_forced_nr >=
+		     st.gcs_tx_nr - st0.gcs_tx_nr);
+	M0_UT_ASSERT(st.gcs_pause_nr - st0.gcs_pause_nr ==
+		     2 * (st.gcs_forced_nr - st0.gcs_forced_nr));
+	fini();
+	m0_cas_gc_cfg_set(&cfg0);
+}
+
 static void init_cgc_fail_fini(void)
 {
 	m0_fi_enable_once("cgc_fom_tick", "fail_in_cgc_generic_phase");
@@ -1991,6 +2161,7 @@ struct m0_ut_suite cas_service_ut = {
 		{ "delete-2",                &delete_2,              "Nikita" },
 		{ "lookup-N",                &lookup_N,              "Nikita" },
 		{ "lookup-restart",          &lookup_restart,        "Nikita" },
+		{ "lookup-filter",           &lookup_filter,         "Leonid" },
 		{ "cur-N",                   &cur_N,                 "Nikita" },
 		{ "meta-mt",                 &meta_mt,               "Nikita" },
 		{ "meta-insert-fail",        &meta_insert_fail,      "Leonid" },
@@ -2009,6 +2180,8 @@ struct m0_ut_suite cas_service_ut = {
 		{ "multi-create-drop",       &multi_create_drop,     "Eugene" },
 		{ "create-insert-drop",      &create_insert_drop,    "Eugene" },
 		{ "create-insert-drop-fail", &create_insert_drop_fail, "Hua"  },
+		{ "drop-batched",            &drop_batched,          "Eugene" },
+		{ "drop-throttled",          &drop_throttled,        "Eugene" },
 		{ "init-cgc-fail-fini",      &init_cgc_fail_fini,    "Hua"    },
 		{ "cctg-create",             &cctg_create,           "Sergey" },
 		{ "cctg-create-lookup",      &cctg_create_lookup,    "Sergey" },
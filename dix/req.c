@@ -1708,6 +1708,8 @@ static int dix_cas_rops_send(struct m0_dix_req *req)
 		M0_ASSERT(cas_svc->sc_type == M0_CST_CAS);
 		m0_cas_req_init(creq, &cas_svc->sc_rlink.rlk_sess,
 				dix_req_smgrp(req));
+		creq->ccr_deadline = req->dr_deadline;
+		creq->ccr_next_bound = req->dr_next_bound;
 		dix_to_cas_map(req, creq);
 		m0_clink_init(&cas_rop->crp_clink, dix_cas_rop_clink_cb);
 		m0_clink_add(&creq->ccr_sm.sm_chan, &cas_rop->crp_clink);
@@ -2322,8 +2324,10 @@ M0_INTERNAL int m0_dix_next(struct m0_dix_req      *req,
 	uint32_t i;
 	int      rc;
 
-	/* Only slant and exclude start key flags are allowed. */
-	M0_PRE((flags & ~(COF_SLANT | COF_EXCLUDE_START_KEY)) == 0);
+	M0_PRE((flags & ~(COF_SLANT | COF_EXCLUDE_START_KEY | COF_KEYS_ONLY |
+			  COF_END_KEY | COF_PREFIX)) == 0);
+	M0_PRE((flags & (COF_END_KEY | COF_PREFIX)) !=
+	       (COF_END_KEY | COF_PREFIX));
 	M0_PRE(keys_nr != 0);
 
 	rc = dix_req_indices_copy(req, index, 1);
@@ -258,6 +258,17 @@ struct m0_dix_req {
 
 	/** Datum used to update client SYNC records. */
 	void                         *dr_sync_datum;
+	/**
+	 * Deadline of CAS fops of a record operation, see
+	 * m0_cas_req::ccr_deadline. 0 sends them at once.
+	 */
+	m0_time_t                     dr_deadline;
+	/**
+	 * End key or key prefix of m0_dix_next() iteration, see
+	 * m0_cas_req::ccr_next_bound. Not copied, should be accessible until
+	 * the request is processed.
+	 */
+	struct m0_buf                 dr_next_bound;
 };
 
 /**
@@ -443,10 +454,16 @@ M0_INTERNAL int m0_dix_del(struct m0_dix_req      *req,
  * start key may be not found in the index. In this case iteration starts with
  * the smallest key following the start key.
  *
+ * COF_END_KEY and COF_PREFIX bound iteration by req->dr_next_bound, and
+ * COF_KEYS_ONLY skips values, see m0_cas_next(). Reply byte budget is not
+ * supported: component catalogues are merged and truncation of one of them
+ * would produce a gap in the merged result.
+ *
  * 'Flags' argument is a bitmask of m0_cas_op_flags values.
  *
  * @pre keys_nr != 0
- * @pre (flags & ~(COF_SLANT | COF_EXCLUDE_START_KEY)) == 0
+ * @pre (flags & ~(COF_SLANT | COF_EXCLUDE_START_KEY | COF_KEYS_ONLY |
+ *                 COF_END_KEY | COF_PREFIX)) == 0
  */
 M0_INTERNAL int m0_dix_next(struct m0_dix_req      *req,
 			    const struct m0_dix    *index,
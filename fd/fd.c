@@ -105,10 +105,11 @@ static void inverse_permuted_idx_get(struct m0_pdclust_instance *pi,
 				     uint64_t *rel_idx);
 /**
  * Returns the permutation cache associated with a node from the pdclust
- * instance.
+ * instance, for the tile omega.
  */
 static struct m0_fd_perm_cache *cache_get(struct m0_pdclust_instance *pi,
-					  struct m0_fd_tree_node *node);
+					  struct m0_fd_tree_node *node,
+					  uint64_t omega);
 /** Permutes the permutation cache. **/
 static void fd_permute(struct m0_fd_perm_cache *cache,
 		       struct m0_uint128 *seed, struct m0_fid *gfid,
@@ -835,34 +836,32 @@ pool_ver_get(const struct m0_pdclust_instance *pd_instance)
 	return pd_instance->pi_base.li_l->l_pver;
 }
 
-M0_INTERNAL void m0_fd_fwd_map(struct m0_pdclust_instance *pi,
-			       const struct m0_pdclust_src_addr *src,
-			       struct m0_pdclust_tgt_addr *tgt)
+/** Returns the number of leaves under a node at level 1 of the tile tree. */
+static uint64_t fd_tile_children(const struct m0_fd_tile *tile)
+{
+	uint64_t children;
+	uint64_t i;
+
+	for (i = 1, children = 1; i < tile->ft_depth; ++i)
+		children *= tile->ft_child[i];
+	return children;
+}
+
+static void fd_fwd_map(struct m0_pdclust_instance *pi,
+		       const struct m0_fd_tile *tile, uint64_t children,
+		       const struct m0_pdclust_src_addr *src,
+		       struct m0_pdclust_tgt_addr *tgt)
 {
-	struct m0_fd_tile          *tile;
-	struct m0_pool_version     *pver;
 	struct m0_pdclust_src_addr  src_base;
 	uint64_t                    rel_vidx[M0_CONF_PVER_HEIGHT];
 	uint64_t                    omega;
-	uint64_t                    children;
 	uint64_t                    C;
-	uint64_t                    tree_depth;
 	uint64_t                    i;
 	uint64_t                    vidx;
 
-	M0_PRE(pi != NULL);
-	M0_PRE(src != NULL && tgt != NULL);
-
-	pver = pool_ver_get(pi);
-	tile = &pver->pv_fd_tile;
-	M0_ASSERT(tile != NULL);
 	/* Get location in fault-tolerant permutation. */
 	m0_fd_src_to_tgt(tile, src, tgt);
-	tree_depth = pver->pv_fd_tile.ft_depth;
-	for (i = 1, children = 1; i < tree_depth; ++i) {
-		children *= tile->ft_child[i];
-	}
-	for (i = 1, vidx = tgt->ta_obj; i <= tree_depth; ++i) {
+	for (i = 1, vidx = tgt->ta_obj; i <= tile->ft_depth; ++i) {
 		rel_vidx[i]  = vidx / children;
 		vidx        %= children;
 		children    /= tile->ft_child[i];
@@ -873,6 +872,38 @@ M0_INTERNAL void m0_fd_fwd_map(struct m0_pdclust_instance *pi,
 	permuted_tgt_get(pi, omega, rel_vidx, &tgt->ta_obj);
 }
 
+M0_INTERNAL void m0_fd_fwd_map(struct m0_pdclust_instance *pi,
+			       const struct m0_pdclust_src_addr *src,
+			       struct m0_pdclust_tgt_addr *tgt)
+{
+	struct m0_fd_tile *tile;
+
+	M0_PRE(pi != NULL);
+	M0_PRE(src != NULL && tgt != NULL);
+
+	tile = &pool_ver_get(pi)->pv_fd_tile;
+	M0_ASSERT(tile != NULL);
+	fd_fwd_map(pi, tile, fd_tile_children(tile), src, tgt);
+}
+
+M0_INTERNAL void m0_fd_fwd_map_nr(struct m0_pdclust_instance *pi,
+				  uint64_t group, uint64_t nr,
+				  struct m0_pdclust_tgt_addr *tgt)
+{
+	struct m0_fd_tile          *tile;
+	struct m0_pdclust_src_addr  src;
+	uint64_t                    children;
+
+	M0_PRE(pi != NULL && tgt != NULL);
+
+	tile = &pool_ver_get(pi)->pv_fd_tile;
+	children = fd_tile_children(tile);
+	for (src.sa_group = group; src.sa_group < group + nr; ++src.sa_group) {
+		for (src.sa_unit = 0; src.sa_unit < tile->ft_G; ++src.sa_unit)
+			fd_fwd_map(pi, tile, children, &src, tgt++);
+	}
+}
+
 static void permuted_tgt_get(struct m0_pdclust_instance *pi, uint64_t omega,
 			     uint64_t *rel_vidx, uint64_t *tgt_idx)
 {
@@ -894,9 +925,10 @@ static void permuted_tgt_get(struct m0_pdclust_instance *pi, uint64_t omega,
 	gfid = &pi->pi_base.li_gfid;
 	attr = &pool_ver_get(pi)->pv_attr;
 
+	m0_mutex_lock(&pi->pi_mutex);
 	for (depth = 1; depth <= tree->ft_depth; ++depth) {
 		rel_idx = rel_vidx[depth];
-		cache = cache_get(pi, node);
+		cache = cache_get(pi, node, omega);
 		fd_permute(cache, &attr->pa_seed, gfid, omega);
 		M0_ASSERT(rel_idx < cache->fpc_len);
 		perm_idx = cache->fpc_permute[rel_idx];
@@ -905,19 +937,41 @@ static void permuted_tgt_get(struct m0_pdclust_instance *pi, uint64_t omega,
 		node = *(m0_fd__tree_cursor_get(&cursor));
 		M0_ASSERT(node != NULL);
 	}
+	m0_mutex_unlock(&pi->pi_mutex);
 	*tgt_idx = node->ftn_abs_idx;
 }
 
 static struct m0_fd_perm_cache *cache_get(struct m0_pdclust_instance *pi,
-					  struct m0_fd_tree_node *node)
+					  struct m0_fd_tree_node *node,
+					  uint64_t omega)
 {
-	uint64_t i;
-	uint64_t cache_len;
+	struct m0_fd_perm_cache *cache;
+	struct m0_fd_perm_cache *lru = NULL;
+	uint64_t                 i;
+	uint64_t                 k;
+
+	M0_PRE(m0_mutex_is_locked(&pi->pi_mutex));
 
-	cache_len = node->ftn_child_nr;
-	for (i = 0; i < pi->pi_cache_nr; ++i)
-		if (pi->pi_perm_cache[i].fpc_len == cache_len)
-			return &pi->pi_perm_cache[i];
+	for (i = 0; i < pi->pi_cache_nr; ++i) {
+		cache = &pi->pi_perm_cache[i * M0_PDCLUST_TILE_CACHE_NR];
+		if (cache->fpc_len != node->ftn_child_nr)
+			continue;
+		/*
+		 * Pick the cache of this length holding the permutation for
+		 * the tile, or the least recently used one, which fd_permute()
+		 * then recomputes.
+		 */
+		for (k = 0; k < M0_PDCLUST_TILE_CACHE_NR; ++k, ++cache) {
+			if (is_cache_valid(cache, omega, &pi->pi_base.li_gfid))
+				break;
+			if (lru == NULL || cache->fpc_stamp < lru->fpc_stamp)
+				lru = cache;
+		}
+		if (k == M0_PDCLUST_TILE_CACHE_NR)
+			cache = lru;
+		cache->fpc_stamp = ++pi->pi_tile_clock;
+		return cache;
+	}
 	return NULL;
 }
 
@@ -1026,13 +1080,15 @@ static void inverse_permuted_idx_get(struct m0_pdclust_instance *pi,
 	perm_idx = cursor.ftc_child_idx;
 	node = cursor.ftc_node;
 	M0_ASSERT(node != NULL);
+	m0_mutex_lock(&pi->pi_mutex);
 	for (depth = tree->ft_depth; depth > 0; --depth) {
-		cache = cache_get(pi, node);
+		cache = cache_get(pi, node, omega);
 		fd_permute(cache, &attr->pa_seed, gfid, omega);
 		rel_idx[depth] = cache->fpc_inverse[perm_idx];
 		perm_idx = node->ftn_rel_idx;
 		node = node->ftn_parent;
 	}
+	m0_mutex_unlock(&pi->pi_mutex);
 }
 
 #undef M0_TRACE_SUBSYSTEM
@@ -154,6 +154,11 @@ struct m0_fd_perm_cache {
 	struct m0_fid   fpc_gfid;
 	/* Length of a permutation. */
 	uint32_t        fpc_len;
+	/**
+	 * Value of m0_pdclust_instance::pi_tile_clock when the cache was last
+	 * used, for the LRU replacement among the caches of the same length.
+	 */
+	uint64_t        fpc_stamp;
 	/**
 	 * Lehmer code of permutation.
 	 * This array of m0_fd_permgrp_cache::fpc_count elements is used to
@@ -319,6 +324,15 @@ M0_INTERNAL void m0_fd_fwd_map(struct m0_pdclust_instance *pi,
 			       const struct m0_pdclust_src_addr *src,
 			       struct m0_pdclust_tgt_addr *tgt);
 
+/**
+ * Maps all units of nr parity groups starting from the group "group", see
+ * m0_pdclust_instance_map_nr() for the layout of tgt[]. Equivalent to
+ * m0_fd_fwd_map() for every unit, with per-layout computations done once.
+ */
+M0_INTERNAL void m0_fd_fwd_map_nr(struct m0_pdclust_instance *pi,
+				  uint64_t group, uint64_t nr,
+				  struct m0_pdclust_tgt_addr *tgt);
+
 /**
  * Maps a target and frame from the pool version, to appropriate
  * parity group and its unit.
@@ -188,6 +188,40 @@ static uint64_t pool_width_calc(struct m0_fd_tree *tree)
 	return P;
 }
 
+/**
+ * Checks that batch mapping agrees with m0_fd_fwd_map() for the groups of two
+ * tiles, mapped in an order which switches between the tiles.
+ */
+static void fd_mapping_nr_check(struct m0_pdclust_instance *pi,
+				struct m0_pool_version *pv, uint64_t omega)
+{
+	struct m0_pdclust_tgt_addr *tgt;
+	struct m0_pdclust_tgt_addr  tgt1;
+	struct m0_pdclust_src_addr  src;
+	uint64_t                    C;
+	uint64_t                    G;
+	uint64_t                    i;
+	uint64_t                    idx;
+	uint64_t                    first;
+
+	G = pv->pv_fd_tile.ft_G;
+	C = (pv->pv_fd_tile.ft_rows * pv->pv_fd_tile.ft_cols) / G;
+	M0_ALLOC_ARR(tgt, 2 * C * G);
+	M0_UT_ASSERT(tgt != NULL);
+	first = omega * C + C / 2;
+	m0_fd_fwd_map_nr(pi, first, 2 * C, tgt);
+	for (i = 0; i < 2 * C * G; ++i) {
+		/* Alternate between the groups of both tiles. */
+		src.sa_group = first + (i % 2 == 0 ? i / G : 2 * C - 1 - i / G);
+		src.sa_unit  = i % G;
+		m0_fd_fwd_map(pi, &src, &tgt1);
+		idx = (src.sa_group - first) * G + src.sa_unit;
+		M0_UT_ASSERT(tgt1.ta_obj == tgt[idx].ta_obj);
+		M0_UT_ASSERT(tgt1.ta_frame == tgt[idx].ta_frame);
+	}
+	m0_free(tgt);
+}
+
 static void fd_mapping_check(struct m0_pool_version *pv)
 {
 	struct m0_pdclust_instance pi;
@@ -221,6 +255,7 @@ static void fd_mapping_check(struct m0_pool_version *pv)
 			M0_UT_ASSERT(src.sa_unit == src_new.sa_unit);
 		}
 	}
+	fd_mapping_nr_check(&pi, pv, omega);
 	/* Sanity check for unmapped targets. */
 	unmapped = 0;
 	tgt.ta_frame = omega * pv->pv_fd_tile.ft_rows;
@@ -26,6 +26,7 @@
 #include "lib/memory.h"
 #include "lib/misc.h"            /* M0_SET0 */
 #include "lib/errno.h"
+#include "lib/slab.h"
 #include "motr/magic.h"
 #include "rpc/rpc_machine.h"     /* m0_rpc_machine, m0_rpc_machine_lock */
 #include "rpc/addb2.h"
@@ -45,6 +46,8 @@
 
 static struct m0_mutex fop_types_lock;
 static struct m0_tl    fop_types_list;
+/** Cache of struct m0_fop objects allocated by m0_fop_obj_alloc(). */
+static struct m0_slab  fop_slab;
 
 M0_TL_DESCR_DEFINE(ft, "fop types", static, struct m0_fop_type,
 		   ft_linkage,	ft_magix,
@@ -72,7 +75,9 @@ M0_INTERNAL int m0_fop_data_alloc(struct m0_fop *fop)
 {
 	M0_PRE(fop->f_data.fd_data == NULL && fop->f_type != NULL);
 
-	fop->f_data.fd_data = m0_alloc(fop_data_size(fop));
+	fop->f_data.fd_data = fop->f_type->ft_data_slab != NULL ?
+		m0_slab_alloc(fop->f_type->ft_data_slab) :
+		m0_alloc(fop_data_size(fop));
 	return fop->f_data.fd_data == NULL ? -ENOMEM : 0;
 }
 
@@ -100,7 +105,7 @@ struct m0_fop *m0_fop_alloc(struct m0_fop_type *fopt, void *data,
 
 	M0_PRE(mach != NULL);
 
-	M0_ALLOC_PTR(fop);
+	fop = m0_fop_obj_alloc();
 	if (fop == NULL)
 		return NULL;
 
@@ -109,7 +114,7 @@ struct m0_fop *m0_fop_alloc(struct m0_fop_type *fopt, void *data,
 		int rc = m0_fop_data_alloc(fop);
 		if (rc != 0) {
 			m0_fop_fini(fop);
-			m0_free(fop);
+			m0_slab_free(&fop_slab, fop);
 			return NULL;
 		}
 	}
@@ -133,14 +138,34 @@ struct m0_fop *m0_fop_reply_alloc(struct m0_fop *req,
 }
 M0_EXPORTED(m0_fop_reply_alloc);
 
+/**
+ * Frees sub-objects of cached fop data, leaving the top level object to
+ * m0_fop_fini().
+ */
+static void fop_data_free(struct m0_xcode_cursor *it)
+{
+	if (it->xcu_depth > 0)
+		m0_xcode_free_default(it);
+}
+
 M0_INTERNAL void m0_fop_fini(struct m0_fop *fop)
 {
+	struct m0_slab     *slab;
+	struct m0_xcode_ctx ctx;
+
 	M0_PRE(fop != NULL);
 	M0_ENTRY("fop: %p %s", fop, m0_fop_name(fop));
 	M0_PRE(M0_IN(m0_ref_read(&fop->f_ref), (0, 1)));
 
 	m0_rpc_item_fini(&fop->f_item);
-	if (fop->f_data.fd_data != NULL)
+	slab = fop->f_type->ft_data_slab;
+	if (fop->f_data.fd_data != NULL && slab != NULL) {
+		M0_SET0(&ctx);
+		m0_xcode_ctx_init(&ctx, &M0_FOP_XCODE_OBJ(fop));
+		ctx.xcx_free = fop_data_free;
+		m0_xcode_free(&ctx);
+		m0_slab_free(slab, fop->f_data.fd_data);
+	} else if (fop->f_data.fd_data != NULL)
 		m0_xcode_free_obj(&M0_FOP_XCODE_OBJ(fop));
 	M0_LEAVE();
 }
@@ -154,7 +179,7 @@ M0_INTERNAL void m0_fop_release(struct m0_ref *ref)
 
 	fop = container_of(ref, struct m0_fop, f_ref);
 	m0_fop_fini(fop);
-	m0_free(fop);
+	m0_slab_free(&fop_slab, fop);
 
 	M0_LEAVE();
 }
@@ -223,6 +248,11 @@ void *m0_fop_data(const struct m0_fop *fop)
 }
 M0_EXPORTED(m0_fop_data);
 
+M0_INTERNAL struct m0_fop *m0_fop_obj_alloc(void)
+{
+	return m0_slab_alloc(&fop_slab);
+}
+
 uint32_t m0_fop_opcode(const struct m0_fop *fop)
 {
 	return fop->f_type->ft_rpc_item_type.rit_opcode;
@@ -241,6 +271,10 @@ void m0_fop_type_fini(struct m0_fop_type *fopt)
 		fopt->ft_magix = 0;
 	}
 	m0_mutex_unlock(&fop_types_lock);
+	if (fopt->ft_data_slab != NULL) {
+		m0_slab_fini(fopt->ft_data_slab);
+		m0_free0(&fopt->ft_data_slab);
+	}
 }
 M0_EXPORTED(m0_fop_type_fini);
 
@@ -265,6 +299,14 @@ void m0_fop_type_init(struct m0_fop_type *ft,
 	ft->ft_name = args->name;
 	ft->ft_xt   = xt;
 	ft->ft_ops  = args->fop_ops;
+	ft->ft_data_slab = NULL;
+	if (args->data_cache && xt != NULL) {
+		/* The cache is an optimisation: do without it on ENOMEM. */
+		M0_ALLOC_PTR(ft->ft_data_slab);
+		if (ft->ft_data_slab != NULL)
+			m0_slab_init(ft->ft_data_slab, args->name,
+				     xt->xct_sizeof, NULL, NULL);
+	}
 
 	rpc_type->rit_opcode = args->opcode;
 	rpc_type->rit_flags  = args->rpc_flags;
@@ -317,6 +359,7 @@ M0_INTERNAL int m0_fops_init(void)
 	m0_sm_conf_init(&fom_states_conf);
 	ft_tlist_init(&fop_types_list);
 	m0_mutex_init(&fop_types_lock);
+	m0_slab_init(&fop_slab, "fop", sizeof(struct m0_fop), NULL, NULL);
 	m0_fom_ll_global_init();
 
 	m0_fop_fol_frag_type.rpt_xt  = m0_fop_fol_frag_xc;
@@ -328,6 +371,7 @@ M0_INTERNAL int m0_fops_init(void)
 
 M0_INTERNAL void m0_fops_fini(void)
 {
+	m0_slab_fini(&fop_slab);
 	m0_mutex_fini(&fop_types_lock);
 	/* Do not finalise fop_types_list, it can be validly non-empty. */
 	m0_fol_frag_type_deregister(&m0_fop_fol_frag_type);
@@ -60,6 +60,7 @@
 struct m0_fol;
 struct m0_db_tx;
 struct m0_xcode_type;
+struct m0_slab;
 
 /* export */
 struct m0_fop_data;
@@ -161,10 +162,18 @@ struct m0_fop *m0_fop_reply_alloc(struct m0_fop *req,
  * m0_fop_init() when fop is not embedded in any other object.
  */
 M0_INTERNAL void m0_fop_release(struct m0_ref *ref);
+
+/**
+ * Allocates zeroed memory for a fop from the fop object cache. Such fop is
+ * freed by m0_fop_release() or m0_free().
+ */
+M0_INTERNAL struct m0_fop *m0_fop_obj_alloc(void);
 void *m0_fop_data(const struct m0_fop *fop);
 
 /**
    Allocate top level fop data
+
+   Data are taken from m0_fop_type::ft_data_slab when the fop type has one.
  */
 M0_INTERNAL int m0_fop_data_alloc(struct m0_fop *fop);
 
@@ -233,6 +242,11 @@ struct m0_fop_type {
 	/** The rpc_item_type associated with rpc_item
 	    embedded with this fop. */
 	struct m0_rpc_item_type           ft_rpc_item_type;
+	/**
+	 * Cache of top level fop data objects, non-NULL iff the type was
+	 * initialised with __m0_fop_type_init_args::data_cache set.
+	 */
+	struct m0_slab                   *ft_data_slab;
 	uint64_t                          ft_magix;
 };
 
@@ -293,6 +307,12 @@ struct __m0_fop_type_init_args {
 	const struct m0_rpc_item_type_ops *rpc_ops;
 	const struct m0_sm_conf           *sm;
 	const struct m0_reqh_service_type *svc_type;
+	/**
+	 * Allocate top level data of fops of this type from a per-type object
+	 * cache (lib/slab.h) instead of m0_alloc(). For hot request and reply
+	 * types.
+	 */
+	bool                               data_cache;
 };
 
 void m0_fop_type_init(struct m0_fop_type *ft,
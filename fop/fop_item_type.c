@@ -74,13 +74,16 @@ m0_fop_item_type_default_decode(const struct m0_rpc_item_type *item_type,
 	/*
 	 * Decoding in xcode is different from sunrpc xdr where top object is
 	 * allocated by caller; in xcode, even the top object is allocated,
-	 * so we don't need to allocate the fop->f_data->fd_data.
+	 * so we don't need to allocate the fop->f_data->fd_data, unless the
+	 * fop type caches it. If the cache fails, xcode allocates the data.
 	 */
-	M0_ALLOC_PTR(fop);
+	fop = m0_fop_obj_alloc();
 	if (fop == NULL)
 		return M0_ERR(-ENOMEM);
 
 	m0_fop_init(fop, ftype, NULL, m0_fop_release);
+	if (ftype->ft_data_slab != NULL)
+		(void)m0_fop_data_alloc(fop);
 	item = m0_fop_to_rpc_item(fop);
 	rc = m0_fop_item_encdec(item, cur, M0_XCODE_DECODE);
 	*item_out = item;
@@ -238,6 +238,12 @@ static void usage()
 	printf("    set_write_tier <fid> <tier>\n\n");
 	printf("  <fid> parameter format is [hi:]lo. "
 	                  "(hi == 0 if not specified.)\n");
+	printf("  For copy, move, stage and archive, <fid> can also be "
+	       "@<file>, to process\n"
+	       "  all objects listed in <file>, one fid per line.\n");
+	printf("  Options: -v (more verbose), -q (quieter), "
+	       "-d <depth> (blocks in flight\n"
+	       "  when copying data, default %d).\n", HSM_COPY_DEPTH);
 	printf("  The numbers are read in decimal, hexadecimal "
 	                              "(when prefixed with `0x')\n"
 	       "  or octal (when prefixed with `0') formats.\n");
@@ -343,8 +349,9 @@ static int parse_release_subopt(char *opts, enum hsm_rls_flags *flags)
 static const struct option option_tab[] = {
 	{"quiet", no_argument, NULL, 'q'},
 	{"verbose", required_argument, NULL, 'v'},
+	{"depth", required_argument, NULL, 'd'},
 };
-#define SHORT_OPT "qv"
+#define SHORT_OPT "qvd:"
 
 static int parse_cmd_options(int argc, char **argv)
 {
@@ -361,6 +368,13 @@ static int parse_cmd_options(int argc, char **argv)
 			if (hsm_options.trace_level < LOG_DEBUG)
 				hsm_options.trace_level++;
 			break;
+		case 'd':
+			hsm_options.copy_depth = atoi(optarg);
+			if (hsm_options.copy_depth < 2) {
+				fprintf(stderr, "Copy depth must be >= 2\n");
+				return -EINVAL;
+			}
+			break;
 		case ':':
 		case '?':
 		default:
@@ -374,9 +388,136 @@ static int parse_cmd_options(int argc, char **argv)
 int m0hsm_test_write(struct m0_uint128 id, off_t offset, size_t len, int seed);
 int m0hsm_test_read(struct m0_uint128 id, off_t offset, size_t len);
 
+/**
+ * Read a list of FIDs from a file, one per line.
+ * Return the number of FIDs read, or -1 on error.
+ */
+static int read_fid_list(const char *path, struct m0_uint128 **ids)
+{
+	FILE *f;
+	char line[256];
+	struct m0_uint128 *tmp;
+	int nr = 0;
+	int alloc = 0;
+
+	f = fopen(path, "r");
+	if (f == NULL) {
+		fprintf(stderr, "m0hsm: error on opening %s: %s\n", path,
+			strerror(errno));
+		return -1;
+	}
+	*ids = NULL;
+	while (fgets(line, sizeof line, f) != NULL) {
+		if (nr == alloc) {
+			alloc = alloc * 2 ?: 64;
+			tmp = realloc(*ids, alloc * sizeof (*ids)[0]);
+			if (tmp == NULL) {
+				fprintf(stderr, "m0hsm: allocation error\n");
+				goto err;
+			}
+			*ids = tmp;
+		}
+		(*ids)[nr] = M0_ID_APP;
+		if (read_fid(line, &(*ids)[nr]) <= 0) {
+			fprintf(stderr, "m0hsm: invalid fid in %s: %s", path,
+				line);
+			goto err;
+		}
+		nr++;
+	}
+	fclose(f);
+	return nr;
+ err:
+	fclose(f);
+	free(*ids);
+	*ids = NULL;
+	return -1;
+}
+
+/** Arguments of the copy, move, stage and archive actions */
+struct copy_args {
+	enum hsm_batch_action	action;
+	off_t			offset;
+	size_t			len;
+	int			src_tier;
+	int			tgt_tier;
+	enum hsm_cp_flags	flags;
+};
+
+/** Tell if action copies data between tiers, and how */
+static bool is_copy_action(const char *action, enum hsm_batch_action *batch)
+{
+	if (m0_streq(action, "copy") || m0_streq(action, "move"))
+		*batch = HSM_BATCH_COPY;
+	else if (m0_streq(action, "stage"))
+		*batch = HSM_BATCH_STAGE;
+	else if (m0_streq(action, "archive"))
+		*batch = HSM_BATCH_ARCHIVE;
+	else
+		return false;
+	return true;
+}
+
+/**
+ * Parse the arguments of copy, move, stage and archive actions:
+ * <offset> <len> [<src_tier>] <tgt_tier> [options].
+ * The source tier is only given to copy and move.
+ */
+static int parse_copy_args(const char *action, enum hsm_batch_action batch,
+			   int argc, char **argv, struct copy_args *args)
+{
+	int nargs;
+
+	args->action = batch;
+	nargs = batch == HSM_BATCH_COPY ? 4 : 3;
+	if (optind > argc - nargs) {
+		usage();
+		return -1;
+	}
+	args->offset = read_arg64(argv[optind++]);
+	args->len = read_arg64(argv[optind++]);
+	args->src_tier = 0;
+	if (batch == HSM_BATCH_COPY)
+		args->src_tier = atoi(argv[optind++]);
+	args->tgt_tier = atoi(argv[optind++]);
+	if (args->src_tier > HSM_TIER_MAX || args->tgt_tier > HSM_TIER_MAX) {
+		fprintf(stderr, "Max tier index: %u\n", HSM_TIER_MAX);
+		return -1;
+	}
+	args->flags = 0;
+	if (optind < argc)
+		if (parse_copy_subopt(argv[optind], &args->flags))
+			 return -1;
+
+	/* force move flag for 'move' action */
+	if (m0_streq(action, "move"))
+		args->flags |= HSM_MOVE;
+	return 0;
+}
+
+/** Run copy, move, stage or archive on a list of objects */
+static int run_batch_cmd(const char *action, int argc, char **argv,
+			 const struct m0_uint128 *ids, int nr)
+{
+	enum hsm_batch_action batch;
+	struct copy_args args;
+
+	if (!is_copy_action(action, &batch)) {
+		fprintf(stderr, "A list of objects is not supported by %s\n",
+			action);
+		return -1;
+	}
+	if (parse_copy_args(action, batch, argc, argv, &args))
+		return -1;
+
+	return m0hsm_batch(args.action, ids, nr, args.src_tier, args.tgt_tier,
+			   args.offset, args.len, args.flags);
+}
+
 static int run_cmd(int argc, char **argv)
 {
 	struct m0_uint128 id;
+	enum hsm_batch_action batch;
 	const char *action;
 	int rc = 0;
 
@@ -394,6 +535,18 @@ static int run_cmd(int argc, char **argv)
 	action = argv[optind];
 
 	optind++;
+	if (argv[optind][0] == '@') {
+		struct m0_uint128 *ids;
+		int nr;
+
+		nr = read_fid_list(argv[optind] + 1, &ids);
+		if (nr <= 0)
+			return -1;
+		optind++;
+		rc = run_batch_cmd(action, argc, argv, ids, nr);
+		free(ids);
+		return rc;
+	}
 	id = M0_ID_APP;
 	rc = read_fid(argv[optind], &id);
 	if (rc <= 0) {
@@ -465,94 +618,26 @@ static int run_cmd(int argc, char **argv)
 
 		rc = m0hsm_test_read(id, offset, len);
 
-	} else if (m0_streq(action, "copy") ||
-		   m0_streq(action, "move")) {
-		off_t offset;
-		size_t len;
-		int src_tier;
-		int tgt_tier;
-		enum hsm_cp_flags flags = 0;
+	} else if (is_copy_action(action, &batch)) {
+		struct copy_args args;
 
-		/* at least 4 arguments */
-		if (optind > argc - 4) {
-			usage();
+		if (parse_copy_args(action, batch, argc, argv, &args))
 			return -1;
-		}
-		offset = read_arg64(argv[optind]);
-		optind++;
-		len = read_arg64(argv[optind]);
-		optind++;
-		src_tier = atoi(argv[optind]);
-		optind++;
-		tgt_tier = atoi(argv[optind]);
-		optind++;
-		if (src_tier > HSM_TIER_MAX || tgt_tier > HSM_TIER_MAX) {
-			fprintf(stderr, "Max tier index: %u\n", HSM_TIER_MAX);
-			return -1;
-		}
-		if (optind < argc)
-			if (parse_copy_subopt(argv[optind], &flags))
-				 return -1;
-
-		/* force move flag for 'move' action */
-		if (m0_streq(action, "move"))
-			flags |= HSM_MOVE;
-
-		rc = m0hsm_copy(id, src_tier, tgt_tier, offset, len, flags);
-
-	} else if (m0_streq(action, "stage")) {
-		off_t offset;
-		size_t len;
-		int tgt_tier;
-		enum hsm_cp_flags flags = 0;
 
-		/* at least 3 arguments */
-		if (optind > argc - 3) {
-			usage();
-			return -1;
-		}
-		offset = read_arg64(argv[optind]);
-		optind++;
-		len = read_arg64(argv[optind]);
-		optind++;
-		tgt_tier = atoi(argv[optind]);
-		optind++;
-		if (tgt_tier > HSM_TIER_MAX) {
-			fprintf(stderr, "Max tier index: %u\n", HSM_TIER_MAX);
-			return -1;
-		}
-		if (optind < argc)
-			if (parse_copy_subopt(argv[optind], &flags))
-				 return -1;
-
-		rc = m0hsm_stage(id, tgt_tier, offset, len, flags);
-
-	} else if (m0_streq(action, "archive")) {
-		off_t offset;
-		size_t len;
-		int tgt_tier;
-		enum hsm_cp_flags flags = 0;
-
-		/* at least 3 arguments */
-		if (optind > argc - 3) {
-			usage();
-			return -1;
-		}
-		offset = read_arg64(argv[optind]);
-		optind++;
-		len = read_arg64(argv[optind]);
-		optind++;
-		tgt_tier = atoi(argv[optind]);
-		optind++;
-		if (tgt_tier > HSM_TIER_MAX) {
-			fprintf(stderr, "Max tier index: %u\n", HSM_TIER_MAX);
-			return -1;
+		switch (args.action) {
+		case HSM_BATCH_COPY:
+			rc = m0hsm_copy(id, args.src_tier, args.tgt_tier,
+					args.offset, args.len, args.flags);
+			break;
+		case HSM_BATCH_STAGE:
+			rc = m0hsm_stage(id, args.tgt_tier, args.offset,
+					 args.len, args.flags);
+			break;
+		case HSM_BATCH_ARCHIVE:
+			rc = m0hsm_archive(id, args.tgt_tier, args.offset,
+					   args.len, args.flags);
+			break;
 		}
-		if (optind < argc)
-			if (parse_copy_subopt(argv[optind], &flags))
-				 return -1;
-
-		rc = m0hsm_archive(id, tgt_tier, offset, len, flags);
 
 	} else if (m0_streq(action, "release") ||
 		   m0_streq(action, "multi_release")) {
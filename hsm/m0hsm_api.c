@@ -1862,12 +1862,16 @@ uint64_t get_optimal_bs(struct m0_obj *obj, uint64_t obj_sz)
 	VERB("usz=%lu pool="FID_F" (N,K,P)=(%u,%u,%u) max_bs=%"PRId64"\n", usz,
 	     FID_P(&pver->pv_pool->po_id), pa->pa_N, pa->pa_K, pa->pa_P, max_bs);
 
+	/* keep I/O aligned to parity groups, to avoid read-modify-write */
+	max_bs = max_bs > gsz ? max_bs / gsz * gsz : gsz;
+
 	if (obj_sz >= max_bs)
 		return max_bs;
 	else if (obj_sz <= gsz)
 		return gsz;
 	else
-		return roundup_power2(obj_sz);
+		return MIN(max_bs, roundup_power2(obj_sz / gsz +
+						  !!(obj_sz % gsz)) * gsz);
 }
 
 /**
@@ -2106,85 +2110,314 @@ int m0hsm_test_read(struct m0_uint128 id, off_t offset, size_t len)
 	RETURN(rc);
 }
 
-/** copy an extent from one (flat) object to another */
+/** Cumulated statistics of copy operations, reported as progress */
+struct copy_stats {
+	/** bytes written to the target tier */
+	size_t		copied;
+	/** bytes found already present in the target tier */
+	size_t		skipped;
+	/** total bytes to be copied, for progress reporting */
+	size_t		total;
+	m0_time_t	start;
+	m0_time_t	last_report;
+};
+
+static struct copy_stats copy_stats;
+
+/** Interval between two progress reports */
+#define HSM_PROGRESS_INTERVAL	M0_MKTIME(5, 0)
+
+static void copy_stats_reset(void)
+{
+	memset(&copy_stats, 0, sizeof(copy_stats));
+	copy_stats.start = m0_time_now();
+	copy_stats.last_report = copy_stats.start;
+}
+
+/** Throughput in MB/s since the beginning of the copy */
+static double copy_stats_rate(m0_time_t now)
+{
+	double sec = (double)m0_time_sub(now, copy_stats.start) /
+		     M0_TIME_ONE_SECOND;
+
+	return sec > 0 ? copy_stats.copied / sec / (1024 * 1024) : 0;
+}
+
+static void copy_stats_progress(void)
+{
+	m0_time_t now = m0_time_now();
+
+	if (m0_time_sub(now, copy_stats.last_report) < HSM_PROGRESS_INTERVAL)
+		return;
+	copy_stats.last_report = now;
+	INFO("Progress: %zu/%zu bytes copied, %zu already present "
+	     "(%.1f MB/s)\n", copy_stats.copied, copy_stats.total,
+	     copy_stats.skipped, copy_stats_rate(now));
+}
+
+static void copy_stats_report(void)
+{
+	m0_time_t now = m0_time_now();
+
+	if (copy_stats.copied == 0 && copy_stats.skipped == 0)
+		return;
+	INFO("%zu bytes copied, %zu already present, in %.3f s "
+	     "(%.1f MB/s)\n", copy_stats.copied, copy_stats.skipped,
+	     (double)m0_time_sub(now, copy_stats.start) / M0_TIME_ONE_SECOND,
+	     copy_stats_rate(now));
+}
+
+/** Block transfer in the copy pipeline */
+struct copy_slot {
+	enum {
+		SLOT_IDLE,
+		SLOT_READ,
+		SLOT_WRITE,
+	}		 state;
+	struct io_ctx	 io;
+	struct m0_op	*op;
+	off_t		 off;
+	size_t		 len;
+};
+
+/**
+ * Copy pipeline between two (flat) objects.
+ * Up to 'depth' blocks are in flight, each one being read from the source
+ * then written to the target with the same buffer. While a block is being
+ * written, the next ones are already being read.
+ */
+struct copy_engine {
+	struct m0_obj		 src_obj;
+	struct m0_obj		 tgt_obj;
+	/** block size, a multiple of the target parity group size */
+	size_t			 bsize;
+	/** next offset to be copied */
+	off_t			 pos;
+	off_t			 end;
+	/** extents already present in the target, or NULL */
+	struct m0_tl		*present;
+	int			 depth;
+	struct copy_slot	*slots;
+	/** in-flight slots, in the order they were launched */
+	struct copy_slot       **fifo;
+	int			 head;
+	int			 nr;
+};
+
+/**
+ * Get the next region to copy, skipping the parts already present in the
+ * target. Regions do not cross block boundaries. They are full-group writes
+ * to the target only between such boundaries: a region starting or ending
+ * where the copied range or a present extent does is shorter, and its
+ * partial groups are read-modify-written by the target.
+ * @return false when the whole range has been processed.
+ */
+static bool copy_next_chunk(struct copy_engine *eng, off_t *off, size_t *len)
+{
+	struct m0_composite_extent *ext;
+	off_t pos = eng->pos;
+	off_t limit = eng->end;
+
+	if (eng->present != NULL) {
+		/* extent lists are sorted by offset */
+		m0_tl_for(cext, eng->present, ext) {
+			off_t ext_end = ext->ce_off + ext->ce_len;
+
+			if (ext_end <= pos)
+				continue;
+			if (ext->ce_off <= pos) {
+				if (pos < eng->end)
+					copy_stats.skipped +=
+						MIN(ext_end, eng->end) - pos;
+				pos = ext_end;
+				continue;
+			}
+			limit = MIN(limit, ext->ce_off);
+			break;
+		} m0_tl_endfor;
+	}
+	if (pos >= eng->end) {
+		eng->pos = eng->end;
+		return false;
+	}
+	limit = MIN(limit, (pos / eng->bsize + 1) * eng->bsize);
+	*off = pos;
+	*len = limit - pos;
+	eng->pos = limit;
+	return true;
+}
+
+static int copy_slot_launch(struct copy_engine *eng, struct copy_slot *slot,
+			    int state)
+{
+	struct m0_obj *obj;
+	int rc;
+
+	obj = state == SLOT_READ ? &eng->src_obj : &eng->tgt_obj;
+	slot->op = NULL;
+	rc = m0_obj_op(obj, state == SLOT_READ ? M0_OC_READ : M0_OC_WRITE,
+		       &slot->io.ext, &slot->io.data, &slot->io.attr, 0, 0,
+		       &slot->op);
+	if (rc) {
+		ERROR("m0_obj_op() failed: rc=%d\n", rc);
+		slot->state = SLOT_IDLE;
+		return rc;
+	}
+	m0_op_launch(&slot->op, 1);
+	slot->state = state;
+	eng->fifo[(eng->head + eng->nr) % eng->depth] = slot;
+	eng->nr++;
+	return 0;
+}
+
+/** Wait for the oldest in-flight block */
+static struct copy_slot *copy_slot_wait(struct copy_engine *eng, int *rc)
+{
+	struct copy_slot *slot = eng->fifo[eng->head];
+
+	eng->head = (eng->head + 1) % eng->depth;
+	eng->nr--;
+	*rc = m0_op_wait(slot->op, M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+			 M0_TIME_NEVER) ?: m0_rc(slot->op);
+	m0_op_fini(slot->op);
+	m0_op_free(slot->op);
+	slot->op = NULL;
+	return slot;
+}
+
+/** Start reading next blocks, as long as there are idle slots */
+static int copy_engine_fill(struct copy_engine *eng)
+{
+	struct copy_slot *slot;
+	off_t off;
+	size_t len;
+	int i;
+	int rc;
+
+	for (i = 0; i < eng->depth; i++) {
+		slot = &eng->slots[i];
+		if (slot->state != SLOT_IDLE)
+			continue;
+		if (!copy_next_chunk(eng, &off, &len))
+			break;
+
+		rc = prepare_io_ctx(&slot->io, 1, len, true);
+		if (rc) {
+			ERROR("prepare_io_ctx() failed: rc=%d\n", rc);
+			return rc;
+		}
+		rc = map_io_ctx(&slot->io, 1, len, off, NULL);
+		if (rc) {
+			ERROR("map_io_ctx() failed: rc=%d\n", rc);
+			return rc;
+		}
+		slot->off = off;
+		slot->len = len;
+		rc = copy_slot_launch(eng, slot, SLOT_READ);
+		if (rc)
+			return rc;
+	}
+	return 0;
+}
+
+/**
+ * Copy an extent from one (flat) object to another.
+ * @param present  Extents already present in the target object (may be
+ *                 NULL). They are not copied again.
+ */
 static int copy_extent_data(struct m0_uint128 src_id,
 			    struct m0_uint128 tgt_id,
-		            const struct extent *range)
+			    const struct extent *range,
+			    struct m0_tl *present)
 {
-	struct m0_obj src_obj = {};
-	struct m0_obj tgt_obj = {};
-	size_t block_size;
-	struct io_ctx ctx = {};
-	size_t rest = range->len;
-	off_t start = range->off;
+	struct copy_engine eng = {};
+	struct copy_slot *slot;
+	size_t copied = copy_stats.copied;
+	int i;
 	int rc;
+	int rc2;
 	ENTRY;
 
-	m0_obj_init(&src_obj, m0_uber_realm, &src_id,
+	m0_obj_init(&eng.src_obj, m0_uber_realm, &src_id,
 			   m0_client_layout_id(m0_instance));
-	m0_obj_init(&tgt_obj, m0_uber_realm, &tgt_id,
+	m0_obj_init(&eng.tgt_obj, m0_uber_realm, &tgt_id,
 			   m0_client_layout_id(m0_instance));
 
 	/* open the entities */
-	rc = open_entity(&src_obj.ob_entity);
+	rc = open_entity(&eng.src_obj.ob_entity);
 	if (rc)
 		RETURN(rc);
-	rc = open_entity(&tgt_obj.ob_entity);
+	rc = open_entity(&eng.tgt_obj.ob_entity);
 	if (rc)
 		goto out_close_src;
 
-	block_size = get_optimal_bs(&tgt_obj, rest);
-	if (block_size == 0) {
+	eng.bsize = get_optimal_bs(&eng.tgt_obj, range->len);
+	if (eng.bsize == 0) {
 		ERROR("Could not get the optimal block size for the object\n");
 		rc = -EINVAL;
 		goto fini;
 	}
+	eng.depth = options.copy_depth ?: HSM_COPY_DEPTH;
+	/* at least 2 buffers, for reads and writes to overlap */
+	eng.depth = MAX(eng.depth, 2);
+	/* don't allocate more than 2 buffers of the max size */
+	eng.depth = MIN(eng.depth, MAX(2 * MAX_M0_BUFSZ / eng.bsize, 2));
+	eng.pos = range->off;
+	eng.end = range->off + range->len;
+	eng.present = present;
+	copy_stats.total += range->len;
+
+	VERB("Using I/O block size of %zu bytes, %d blocks in flight\n",
+	     eng.bsize, eng.depth);
+
+	eng.slots = calloc(eng.depth, sizeof eng.slots[0]);
+	eng.fifo = calloc(eng.depth, sizeof eng.fifo[0]);
+	if (eng.slots == NULL || eng.fifo == NULL) {
+		rc = -ENOMEM;
+		goto free;
+	}
 
-	VERB("Using I/O block size of %zu bytes\n", block_size);
-
-	for (; rest > 0; rest -= block_size, start += block_size) {
-		if (rest < block_size)
-			/* non full block */
-			block_size = rest;
-
-		rc = prepare_io_ctx(&ctx, 1, block_size, true);
-		if (rc) {
-			ERROR("prepare_io_ctx() failed: rc=%d\n", rc);
-			goto fini;
-		}
-
-		rc = map_io_ctx(&ctx, 1, block_size, start, NULL);
-		if (rc) {
-			ERROR("map_io_ctx() failed: rc=%d\n", rc);
-			break;
+	/* Launch reads, turn completed reads into writes. On error, no new
+	 * block is started and in-flight blocks are drained. */
+	rc = copy_engine_fill(&eng);
+	while (eng.nr > 0) {
+		slot = copy_slot_wait(&eng, &rc2);
+		if (rc2) {
+			ERROR("%s failed at offset %#"PRIx64": rc=%d\n",
+			      slot->state == SLOT_READ ? "read" : "write",
+			      slot->off, rc2);
+			rc = rc ?: rc2;
 		}
-
-		/* read blocks */
-		rc = read_blocks(&src_obj, &ctx);
-		if (rc) {
-			ERROR("read_blocks() failed: rc=%d\n", rc);
-			break;
+		if (rc == 0 && slot->state == SLOT_READ) {
+			/* now write data to the target object */
+			rc = copy_slot_launch(&eng, slot, SLOT_WRITE);
+			continue;
 		}
-
-		/* now write data to the target object */
-		rc = write_blocks(&tgt_obj, &ctx);
-		if (rc) {
-			ERROR("write_blocks() failed: rc=%d\n", rc);
-			break;
+		if (rc2 == 0 && slot->state == SLOT_WRITE) {
+			copy_stats.copied += slot->len;
+			copy_stats_progress();
 		}
+		slot->state = SLOT_IDLE;
+		if (rc == 0)
+			rc = copy_engine_fill(&eng);
 	}
 
+ free:
 	/* Free bufvec's and indexvec's */
-	free_io_ctx(&ctx, true);
+	for (i = 0; eng.slots != NULL && i < eng.depth; i++)
+		if (eng.slots[i].io.curr_blocks != 0)
+			free_io_ctx(&eng.slots[i].io, true);
+	free(eng.slots);
+	free(eng.fifo);
  fini:
-	m0_entity_fini(&tgt_obj.ob_entity);
+	m0_entity_fini(&eng.tgt_obj.ob_entity);
  out_close_src:
-	m0_entity_fini(&src_obj.ob_entity);
+	m0_entity_fini(&eng.src_obj.ob_entity);
 
 	if (rc == 0)
 		INFO("%zu bytes successfully copied from subobj "
 		     "<%#"PRIx64":%#"PRIx64"> to <%#"PRIx64":%#"PRIx64">"
-	             " at offset %#"PRIx64"\n", range->len,
+	             " at offset %#"PRIx64"\n", copy_stats.copied - copied,
 		     src_id.u_hi, src_id.u_lo, tgt_id.u_hi, tgt_id.u_lo,
 		     range->off);
 
@@ -2546,6 +2779,7 @@ static int copy_cb(void *cb_arg, struct m0_client_layout *layout,
 		   bool *stop)
 {
 	struct m0_composite_layer *tgt_layer;
+	struct m0_tl *present = NULL;
 	struct m0_obj subobj = {};
 	struct m0_uint128 subobj_id;
 	int tgt_prio, w_prio;
@@ -2621,7 +2855,8 @@ static int copy_cb(void *cb_arg, struct m0_client_layout *layout,
 			break;
 		case EM_PARTIAL:
 			VERB("Extent already been partially copied to target tier\n");
-			/* TODO only copy missing parts */
+			/* only copy missing parts */
+			present = &tgt_layer->ccr_rd_exts;
 			break;
 		case EM_FULL:
 			/* TODO implement 'force' copy? */
@@ -2632,7 +2867,7 @@ static int copy_cb(void *cb_arg, struct m0_client_layout *layout,
 	}
 
 	/* 3: copy data (from subojbect to subobject) */
-	rc = copy_extent_data(src_layer->ccr_subobj, subobj_id, match);
+	rc = copy_extent_data(src_layer->ccr_subobj, subobj_id, match, present);
 	if (rc) {
 		ERROR("copy_extent_data() failed: rc=%d\n", rc);
 		goto fini;
@@ -2715,8 +2950,13 @@ static int copy_cb(void *cb_arg, struct m0_client_layout *layout,
 	RETURN(rc);
 }
 
-int m0hsm_copy(struct m0_uint128 id, uint8_t src_tier, uint8_t tgt_tier,
-	      off_t offset, size_t len, enum hsm_cp_flags flags)
+/**
+ * Copy matching extents of an object, using the given callback.
+ * @param match_tier  Tier of the layers to be matched.
+ */
+static int copy_obj(struct m0_uint128 id, match_layer_cb_t cb,
+		    uint8_t match_tier, uint8_t tgt_tier,
+		    off_t offset, size_t len, enum hsm_cp_flags flags)
 {
 	struct m0_client_layout	*layout = NULL;
 	struct copy_cb_ctx ctx = {0};
@@ -2733,21 +2973,32 @@ int m0hsm_copy(struct m0_uint128 id, uint8_t src_tier, uint8_t tgt_tier,
 
 	/* prepare context to be passed to callback functions */
 	ctx.obj_id = id;
-	ctx.src_tier = src_tier;
+	ctx.src_tier = match_tier;
 	ctx.tgt_tier = tgt_tier;
 	ctx.flags = flags;
 
-	/* Check there is matching data in the source tier and get
+	/* Check there is matching data in the source tier(s) and get
 	 * the corresponding layer */
 	ext.off = offset;
 	ext.len = len;
 
-	rc = match_layer_foreach(layout, src_tier, &ext, copy_cb, &ctx, false);
+	rc = match_layer_foreach(layout, match_tier, &ext, cb, &ctx, false);
 	if (rc == 0 && ctx.found == 0)
 		ERROR("No matching extent found\n");
 	RETURN(rc);
 }
 
+int m0hsm_copy(struct m0_uint128 id, uint8_t src_tier, uint8_t tgt_tier,
+	      off_t offset, size_t len, enum hsm_cp_flags flags)
+{
+	int rc;
+
+	copy_stats_reset();
+	rc = copy_obj(id, copy_cb, src_tier, tgt_tier, offset, len, flags);
+	copy_stats_report();
+	return rc;
+}
+
 /**
  * This callback is called for eaching match extent for staging
  */
@@ -2776,35 +3027,14 @@ static int stage_cb(void *cb_arg, struct m0_client_layout *layout,
 int m0hsm_stage(struct m0_uint128 id, uint8_t tgt_tier,
 		off_t offset, size_t length, enum hsm_cp_flags flags)
 {
-	struct m0_client_layout	*layout = NULL;
-	struct copy_cb_ctx ctx = {0};
-	struct extent ext;
 	int rc;
 
-	/* prepare context to be passed to callback functions */
-	ctx.obj_id = id;
-	ctx.src_tier = HSM_ANY_TIER;
-	ctx.tgt_tier = tgt_tier;
-	ctx.flags = flags;
-
-	ENTRY;
-
-	/* get layout once for all, it will be useful in next steps */
-	rc = layout_get(id, &layout);
-	if (rc)
-		RETURN(rc);
-	M0_ASSERT(layout != NULL);
-
-	ext.off = offset;
-	ext.len = length;
-
 	/* for each layer > target_tier, move the data to the target tier */
-	rc = match_layer_foreach(layout, HSM_ANY_TIER, &ext, stage_cb,
-				 &ctx, false);
-
-	if (rc == 0 && ctx.found == 0)
-		ERROR("No matching extent found\n");
-	RETURN(rc);
+	copy_stats_reset();
+	rc = copy_obj(id, stage_cb, HSM_ANY_TIER, tgt_tier, offset, length,
+		      flags);
+	copy_stats_report();
+	return rc;
 }
 
 /**
@@ -2834,38 +3064,64 @@ static int archive_cb(void *cb_arg, struct m0_client_layout *layout,
 int m0hsm_archive(struct m0_uint128 id, uint8_t tgt_tier,
 		off_t offset, size_t length, enum hsm_cp_flags flags)
 {
-	struct m0_client_layout	*layout = NULL;
-	struct copy_cb_ctx ctx = {0};
-	struct extent ext;
 	int rc;
 
-	/* prepare context to be passed to callback functions */
-	ctx.obj_id = id;
-	ctx.src_tier = HSM_ANY_TIER;
-	ctx.tgt_tier = tgt_tier;
-	ctx.flags = flags;
+	/* for each layer < target_tier, move the data to the target tier */
+	copy_stats_reset();
+	rc = copy_obj(id, archive_cb, HSM_ANY_TIER, tgt_tier, offset, length,
+		      flags);
+	copy_stats_report();
+	return rc;
+}
 
+int m0hsm_batch(enum hsm_batch_action action, const struct m0_uint128 *ids,
+		int nr, uint8_t src_tier, uint8_t tgt_tier, off_t offset,
+		size_t length, enum hsm_cp_flags flags)
+{
+	match_layer_cb_t cb;
+	uint8_t match_tier;
+	int failed = 0;
+	int rc = 0;
+	int rc2;
+	int i;
 	ENTRY;
 
-	/* get layout once for all, it will be useful in next steps */
-	rc = layout_get(id, &layout);
-	if (rc)
-		RETURN(rc);
-	M0_ASSERT(layout != NULL);
-
-	ext.off = offset;
-	ext.len = length;
-
-	/* for each layer > target_tier, move the data to the target tier */
-	rc = match_layer_foreach(layout, HSM_ANY_TIER, &ext, archive_cb,
-				 &ctx, false);
+	switch (action) {
+	case HSM_BATCH_COPY:
+		cb = copy_cb;
+		match_tier = src_tier;
+		break;
+	case HSM_BATCH_STAGE:
+		cb = stage_cb;
+		match_tier = HSM_ANY_TIER;
+		break;
+	case HSM_BATCH_ARCHIVE:
+		cb = archive_cb;
+		match_tier = HSM_ANY_TIER;
+		break;
+	default:
+		ERROR("Unexpected batch action %d\n", action);
+		RETURN(-EINVAL);
+	}
 
-	if (rc == 0 && ctx.found == 0)
-		ERROR("No matching extent found\n");
+	copy_stats_reset();
+	for (i = 0; i < nr; i++) {
+		VERB("Processing object %d/%d <%#"PRIx64":%#"PRIx64">\n",
+		     i + 1, nr, ids[i].u_hi, ids[i].u_lo);
+		rc2 = copy_obj(ids[i], cb, match_tier, tgt_tier, offset,
+			       length, flags);
+		if (rc2) {
+			ERROR("Object <%#"PRIx64":%#"PRIx64"> failed: "
+			      "rc=%d\n", ids[i].u_hi, ids[i].u_lo, rc2);
+			failed++;
+			rc = rc ?: rc2;
+		}
+	}
+	copy_stats_report();
+	INFO("%d objects processed, %d failed\n", nr, failed);
 	RETURN(rc);
 }
 
-
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
@@ -56,8 +56,14 @@ struct m0hsm_options {
 	FILE		  *log_stream;
 	/** rc-file with config params */
 	FILE		  *rcfile;
+	/** number of blocks in flight when copying data between tiers
+	 * (default HSM_COPY_DEPTH, minimum 2) */
+	int		   copy_depth;
 };
 
+/** Default number of blocks in flight when copying data */
+enum {HSM_COPY_DEPTH = 4};
+
 /** Max Object Store I/O buffer size */
 enum {MAX_M0_BUFSZ = 128*1024*1024};
 
@@ -202,6 +208,33 @@ int m0hsm_multi_release(struct m0_uint128 obj_id, uint8_t max_tier,
 			off_t offset, size_t length, enum hsm_rls_flags flags);
 
 
+/** Actions which can be applied to a batch of objects */
+enum hsm_batch_action {
+	HSM_BATCH_COPY,
+	HSM_BATCH_STAGE,
+	HSM_BATCH_ARCHIVE,
+};
+
+/**
+ * Copy, stage or archive the same region of several objects.
+ * Objects are processed one after another. Errors are reported per object
+ * and do not stop the batch. Progress and throughput are reported for the
+ * whole batch.
+ * @param action	What to do with each object.
+ * @param ids		Ids of the objects.
+ * @param nr		Number of objects.
+ * @param src_tier	Source tier index, for HSM_BATCH_COPY only.
+ * @param tgt_tier	Target tier index.
+ * @param offset	Start offset of the region.
+ * @param length	Size of the region.
+ * @param flags		Set of OR'ed hsm_cp_flags.
+ * @return 0 if all objects were processed successfully, else the error of
+ *	   the first failed object.
+ */
+int m0hsm_batch(enum hsm_batch_action action, const struct m0_uint128 *ids,
+		int nr, uint8_t src_tier, uint8_t tgt_tier, off_t offset,
+		size_t length, enum hsm_cp_flags flags);
+
 /**
  * Dump HSM information about a composite object.
  * @param stream   FILE* to write information to.
@@ -48,6 +48,9 @@ enum m0_avi_ios_io_labels {
 	M0_AVI_IOS_IO_ATTR_FOMCOB_GFID_KEY,
 	M0_AVI_IOS_IO_ATTR_FOMCOB_CFID_CONT,
 	M0_AVI_IOS_IO_ATTR_FOMCOB_CFID_KEY,
+
+	M0_AVI_IOS_IO_ATTR_FOMCRW_AHEAD_NR,
+	M0_AVI_IOS_IO_ATTR_FOMCRW_NBUF_MAX,
 } M0_XCA_ENUM;
 
 /** @} end of io_foms group */
@@ -27,6 +27,7 @@
 #include "lib/assert.h"
 #include "lib/misc.h"    /* M0_BITS */
 #include "lib/finject.h"
+#include "lib/slab.h"
 #include "net/net_internal.h"
 #include "net/buffer_pool.h"
 #include "fop/fop.h"
@@ -391,6 +392,39 @@
    If buffer_pool reached to low threshold, Bulk I/O service may expand pool
    size. This can be done later to minimize waiting time for network buffer.
 
+   @subsection DLD-bulk-server-lspec-pipeline Pipelined Batches
+
+   When a fop has more than one descriptor and
+   m0_reqh_io_service::rios_pipeline is set, the I/O FOM splits descriptors
+   into batches of at most m0_io_fom_cob_rw::fcrw_pipe_batch descriptors (up
+   to IO_FOM_PIPE_STAGES batches) and works on two batches at once:
+
+   - read: once zero-copy of batch k is initiated, buffers for batch k + 1
+     are acquired and its stob I/O is launched (read_ahead()). Both complete
+     while the FOM waits in M0_FOPH_IO_ZERO_COPY_WAIT;
+
+   - write: once stob I/O of batch k is launched, buffers for batch k + 1
+     are acquired and zero-copy into them is initiated (write_ahead()). Both
+     complete while the FOM waits in M0_FOPH_IO_STOB_WAIT.
+
+   The buffers of the ahead batch are kept in
+   m0_io_fom_cob_rw::fcrw_ahead_list. After batch k buffers are released,
+   ahead_switch() makes batch k + 1 current and moves the FOM directly to the
+   phase waiting for its completion, M0_FOPH_IO_STOB_WAIT for read and
+   M0_FOPH_IO_ZERO_COPY_WAIT for write.
+
+   Buffers of the ahead batch are taken from the pool without waiting: when
+   the pool is short of buffers the batch is processed after the current one,
+   as without pipelining. Hence a FOM holds at most 2 * fcrw_pipe_batch
+   buffers and never waits for buffers while holding some. When the FOM fails
+   while an operation on the ahead batch is in flight, it waits in
+   M0_FOPH_FAILURE for the operation to complete before releasing buffers and
+   stob.
+
+   The number of batches processed ahead and the maximal number of buffers
+   held are reported as M0_AVI_IOS_IO_ATTR_FOMCRW_AHEAD_NR and
+   M0_AVI_IOS_IO_ATTR_FOMCRW_NBUF_MAX attributes of the FOM.
+
    @subsection DLD-bulk-server-lspec-service-registration Service Registration
 
    - Service Type Declaration
@@ -609,6 +643,10 @@ static int zero_copy_initiate(struct m0_fom *);
 static int zero_copy_finish(struct m0_fom *);
 static int net_buffer_release(struct m0_fom *);
 static int nbuf_release_done(struct m0_fom *fom, int still_required);
+static int stob_io_launch(struct m0_fom *fom, struct m0_file *file,
+			  struct m0_tl *bufs, uint32_t index);
+static void read_ahead(struct m0_fom *fom);
+static void write_ahead(struct m0_fom *fom);
 
 static void io_fom_addb2_descr(struct m0_fom *fom);
 
@@ -758,6 +796,8 @@ struct m0_sm_state_descr io_phases[] = {
 	[M0_FOPH_IO_BUFFER_RELEASE] = {
 		.sd_name      = "network-buffer-release",
 		.sd_allowed   = M0_BITS(M0_FOPH_IO_FOM_BUFFER_ACQUIRE,
+					M0_FOPH_IO_STOB_WAIT,
+					M0_FOPH_IO_ZERO_COPY_WAIT,
 					M0_FOPH_SUCCESS)
 	},
 	[M0_FOPH_IO_SYNC] = {
@@ -808,6 +848,10 @@ struct m0_sm_trans_descr io_phases_trans[] = {
 	{"zero-copy-wait-failed", M0_FOPH_IO_ZERO_COPY_WAIT, M0_FOPH_FAILURE},
 	{"network-buffer-released",
 	 M0_FOPH_IO_BUFFER_RELEASE, M0_FOPH_IO_FOM_BUFFER_ACQUIRE},
+	{"network-buffer-released-stobio-ahead",
+	 M0_FOPH_IO_BUFFER_RELEASE, M0_FOPH_IO_STOB_WAIT},
+	{"network-buffer-released-zerocopy-ahead",
+	 M0_FOPH_IO_BUFFER_RELEASE, M0_FOPH_IO_ZERO_COPY_WAIT},
 	{"tx-wait", M0_FOPH_QUEUE_REPLY, M0_FOPH_IO_SYNC },
 	{"tx-wait-more", M0_FOPH_IO_SYNC, M0_FOPH_IO_SYNC },
 	{"tx-wait-done", M0_FOPH_IO_SYNC, M0_FOPH_QUEUE_REPLY },
@@ -832,6 +876,10 @@ static bool m0_io_fom_cob_rw_invariant(const struct m0_io_fom_cob_rw *io)
 		_0C(io->fcrw_curr_desc_index <= rwfop->crw_desc.id_nr) &&
 		_0C(M0_CHECK_EX(m0_tlist_invariant(&netbufs_tl,
 						   &io->fcrw_netbuf_list))) &&
+		_0C(M0_CHECK_EX(m0_tlist_invariant(&netbufs_tl,
+						   &io->fcrw_ahead_list))) &&
+		_0C(ergo(io->fcrw_pipe_batch == 0,
+			 netbufs_tlist_is_empty(&io->fcrw_ahead_list))) &&
 		_0C(io->fcrw_batch_size ==
 		    netbufs_tlist_length(&io->fcrw_netbuf_list)) &&
 		_0C(io->fcrw_req_count >= io->fcrw_count) &&
@@ -840,7 +888,8 @@ static bool m0_io_fom_cob_rw_invariant(const struct m0_io_fom_cob_rw *io)
 		    stobio_tlist_length(&io->fcrw_stio_list)) &&
 		_0C(ergo(io->fcrw_num_stobio_launched <
 			 stobio_tlist_length(&io->fcrw_stio_list),
-			 m0_fom_phase(&io->fcrw_gen) == M0_FOPH_IO_STOB_WAIT));
+			 m0_fom_phase(&io->fcrw_gen) == M0_FOPH_IO_STOB_WAIT ||
+			 !netbufs_tlist_is_empty(&io->fcrw_ahead_list)));
 }
 
 static bool m0_stob_io_desc_invariant(const struct m0_stob_io_desc *stobio_desc)
@@ -854,6 +903,9 @@ static bool m0_stob_io_desc_invariant(const struct m0_stob_io_desc *stobio_desc)
  * list for completed STOB I/O. After completion of all STOB I/O it
  * sends signal to FOM so that it can again put into run queue.
  *
+ * STOB I/O of an ahead batch (read) completes while the FOM waits for
+ * zero-copy, in which case the FOM is not woken up.
+ *
  * @param cb fom callback for completed STOB I/O entry
  */
 static void stobio_complete_cb(struct m0_fom_callback *cb)
@@ -863,15 +915,38 @@ static void stobio_complete_cb(struct m0_fom_callback *cb)
 	struct m0_stob_io_desc  *stio_desc;
 
 	M0_PRE(m0_fom_group_is_locked(fom));
-	M0_ASSERT(m0_fom_phase(fom) == M0_FOPH_IO_STOB_WAIT);
 	stio_desc = container_of(cb, struct m0_stob_io_desc, siod_fcb);
 	M0_ASSERT(m0_stob_io_desc_invariant(stio_desc));
 
 	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
 	M0_ASSERT(m0_io_fom_cob_rw_invariant(fom_obj));
+	M0_ASSERT(m0_fom_phase(fom) == M0_FOPH_IO_STOB_WAIT ||
+		  !netbufs_tlist_is_empty(&fom_obj->fcrw_ahead_list));
 
 	M0_CNT_DEC(fom_obj->fcrw_num_stobio_launched);
-	if (fom_obj->fcrw_num_stobio_launched == 0)
+	if (fom_obj->fcrw_num_stobio_launched == 0 &&
+	    M0_IN(m0_fom_phase(fom), (M0_FOPH_IO_STOB_WAIT, M0_FOPH_FAILURE)))
+		m0_fom_ready(fom);
+}
+
+/**
+ * Call back function invoked on completion of zero-copy of an ahead batch
+ * (write). Wakes the FOM up if it waits for this zero-copy.
+ *
+ * @see write_ahead(), ahead_switch()
+ */
+static void ahead_zero_copy_cb(struct m0_fom_callback *cb)
+{
+	struct m0_fom           *fom = cb->fc_fom;
+	struct m0_io_fom_cob_rw *fom_obj;
+
+	M0_PRE(m0_fom_group_is_locked(fom));
+
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	M0_ASSERT(fom_obj->fcrw_ahead_busy);
+	fom_obj->fcrw_ahead_busy = false;
+	if (M0_IN(m0_fom_phase(fom), (M0_FOPH_IO_ZERO_COPY_WAIT,
+				      M0_FOPH_FAILURE)))
 		m0_fom_ready(fom);
 }
 
@@ -880,6 +955,12 @@ enum {
 	 * @see io_fom_cob_rw_fid2stob_map(), io_fom_cob_rw_stob2fid_map().
 	 */
 	IO_FOM_STOB_KEY_MAX = 0x10000000ULL,
+	/**
+	 * Maximal number of batches descriptors of a fop are split into when
+	 * batches are pipelined.
+	 * @see DLD-bulk-server-lspec-pipeline
+	 */
+	IO_FOM_PIPE_STAGES  = 4,
 };
 
 M0_INTERNAL int m0_io_cob_create(struct m0_cob_domain *cdom,
@@ -1114,6 +1195,42 @@ static int stob_object_find(struct m0_fom *fom)
 	return rc;
 }
 
+/**
+ * Returns the maximal number of descriptors in a batch when batches of the
+ * fom are pipelined, 0 if they are not.
+ *
+ * @see DLD-bulk-server-lspec-pipeline
+ */
+static uint32_t io_pipe_batch(const struct m0_fom *fom)
+{
+	struct m0_reqh_io_service *serv_obj;
+	uint32_t                   ndesc;
+	uint32_t                   stages;
+
+	ndesc = io_rw_get(fom->fo_fop)->crw_desc.id_nr;
+	if (fom->fo_service == NULL || ndesc < 2)
+		return 0;
+	serv_obj = container_of(fom->fo_service, struct m0_reqh_io_service,
+				rios_gen);
+	if (!serv_obj->rios_pipeline)
+		return 0;
+	stages = min32u(ndesc, IO_FOM_PIPE_STAGES);
+	return (ndesc + stages - 1) / stages;
+}
+
+static struct m0_slab io_fom_slab;
+
+M0_INTERNAL void m0_io_foms_init(void)
+{
+	m0_slab_init(&io_fom_slab, "io-fom", sizeof(struct m0_io_fom_cob_rw),
+		     NULL, NULL);
+}
+
+M0_INTERNAL void m0_io_foms_fini(void)
+{
+	m0_slab_fini(&io_fom_slab);
+}
+
 /**
  * Create and initiate I/O FOM and return generic struct m0_fom
  * Find the corresponding fom_type and associate it with m0_fom.
@@ -1140,7 +1257,7 @@ M0_INTERNAL int m0_io_fom_cob_rw_create(struct m0_fop *fop, struct m0_fom **out,
 
 	M0_ENTRY("fop=%p", fop);
 
-	M0_ALLOC_PTR(fom_obj);
+	fom_obj = m0_slab_alloc(&io_fom_slab);
 	if (fom_obj == NULL)
 		return M0_RC(-ENOMEM);
 
@@ -1148,7 +1265,7 @@ M0_INTERNAL int m0_io_fom_cob_rw_create(struct m0_fop *fop, struct m0_fom **out,
 		    m0_fop_reply_alloc(fop, &m0_fop_cob_readv_rep_fopt) :
 		    m0_fop_reply_alloc(fop, &m0_fop_cob_writev_rep_fopt);
 	if (rep_fop == NULL) {
-		m0_free(fom_obj);
+		m0_slab_free(&io_fom_slab, fom_obj);
 		return M0_RC(-ENOMEM);
 	}
 
@@ -1172,9 +1289,17 @@ M0_INTERNAL int m0_io_fom_cob_rw_create(struct m0_fop *fop, struct m0_fom **out,
 	fom_obj->fcrw_bp                  = NULL;
 	fom_obj->fcrw_flags               = rwfop->crw_flags;
 
+	fom_obj->fcrw_pipe_batch          = io_pipe_batch(fom);
+	fom_obj->fcrw_ahead_busy          = false;
+	fom_obj->fcrw_ahead_nr            = 0;
+	fom_obj->fcrw_nbuf_max            = 0;
+
 	netbufs_tlist_init(&fom_obj->fcrw_netbuf_list);
+	netbufs_tlist_init(&fom_obj->fcrw_ahead_list);
 	stobio_tlist_init(&fom_obj->fcrw_stio_list);
 	stobio_tlist_init(&fom_obj->fcrw_done_list);
+	m0_fom_callback_init(&fom_obj->fcrw_ahead_cb);
+	fom_obj->fcrw_ahead_cb.fc_bottom = ahead_zero_copy_cb;
 
 	M0_LOG(M0_DEBUG, "fom=%p : op=%s, desc=%d gfid"FID_F"cob fid"FID_F
 	       "pver"FID_F, fom, m0_is_read_fop(fop) ? "READ" : "WRITE",
@@ -1333,6 +1458,9 @@ static int net_buffer_acquire(struct m0_fom *fom)
 
 	acquired_net_bufs = netbufs_tlist_length(&fom_obj->fcrw_netbuf_list);
 	required_net_bufs = fom_obj->fcrw_ndesc - fom_obj->fcrw_curr_desc_index;
+	if (fom_obj->fcrw_pipe_batch > 0)
+		required_net_bufs = min32(required_net_bufs,
+					  fom_obj->fcrw_pipe_batch);
 
 	/*
 	 * Acquire as many net buffers as to process all descriptors.
@@ -1343,38 +1471,50 @@ static int net_buffer_acquire(struct m0_fom *fom)
 	while (acquired_net_bufs < required_net_bufs) {
 	    struct m0_net_buffer *nb;
 
-	    m0_net_buffer_pool_lock(pool);
-	    nb = m0_net_buffer_pool_get(pool, colour);
-
-	    if (nb == NULL && acquired_net_bufs == 0) {
-		    struct m0_rios_buffer_pool *bpdesc;
-
-		    /*
-		     * Network buffer is not available. At least one
-		     * buffer is need for zero-copy. Registers FOM clink
-		     * with buffer pool wait channel to get buffer
-		     * pool non-empty signal.
-		     */
-		    bpdesc = container_of(pool, struct m0_rios_buffer_pool,
-					  rios_bp);
-		    m0_fom_wait_on(fom, &bpdesc->rios_bp_wait, &fom->fo_cb);
-		    m0_fom_phase_set(fom, M0_FOPH_IO_FOM_BUFFER_WAIT);
+	    /*
+	     * The colour cache doesn't need the pool lock. The lock is taken
+	     * when the cache is empty, and for the last buffer to signal the
+	     * next waiter.
+	     */
+	    nb = m0_net_buffer_pool_cache_get(pool, colour);
+	    if (nb == NULL || acquired_net_bufs + 1 == required_net_bufs) {
+		    m0_net_buffer_pool_lock(pool);
+		    if (nb == NULL)
+			    nb = m0_net_buffer_pool_get(pool, colour);
+
+		    if (nb == NULL && acquired_net_bufs == 0) {
+			    struct m0_rios_buffer_pool *bpdesc;
+
+			    /*
+			     * Network buffer is not available. At least one
+			     * buffer is need for zero-copy. Registers FOM clink
+			     * with buffer pool wait channel to get buffer
+			     * pool non-empty signal.
+			     */
+			    bpdesc = container_of(pool,
+						  struct m0_rios_buffer_pool,
+						  rios_bp);
+			    m0_fom_wait_on(fom, &bpdesc->rios_bp_wait,
+					   &fom->fo_cb);
+			    m0_fom_phase_set(fom, M0_FOPH_IO_FOM_BUFFER_WAIT);
+			    m0_net_buffer_pool_unlock(pool);
+			    M0_LEAVE();
+			    return M0_FSO_WAIT;
+		    } else if (nb == NULL) {
+			    m0_net_buffer_pool_unlock(pool);
+			    /*
+			     * Some network buffers are available for zero copy
+			     * init. FOM can continue with available buffers.
+			     */
+			    break;
+		    }
+		    /* Signal next possible waiter for buffers. */
+		    if (acquired_net_bufs + 1 == required_net_bufs &&
+			pool->nbp_free > 0)
+			    pool->nbp_ops->nbpo_not_empty(pool);
 		    m0_net_buffer_pool_unlock(pool);
-		    M0_LEAVE();
-		    return M0_FSO_WAIT;
-	    } else if (nb == NULL) {
-		    m0_net_buffer_pool_unlock(pool);
-		    /*
-		     * Some network buffers are available for zero copy
-		     * init. FOM can continue with available buffers.
-		     */
-		    break;
 	    }
 	    acquired_net_bufs++;
-	    /* Signal next possible waiter for buffers. */
-	    if (acquired_net_bufs == required_net_bufs && pool->nbp_free > 0)
-			pool->nbp_ops->nbpo_not_empty(pool);
-	    m0_net_buffer_pool_unlock(pool);
 
 	    if (m0_is_read_fop(fop))
 		   nb->nb_qtype = M0_NET_QT_ACTIVE_BULK_SEND;
@@ -1389,6 +1529,8 @@ static int net_buffer_acquire(struct m0_fom *fom)
 	}
 
 	fom_obj->fcrw_batch_size = acquired_net_bufs;
+	fom_obj->fcrw_nbuf_max = max32u(fom_obj->fcrw_nbuf_max,
+					acquired_net_bufs);
 	M0_LOG(M0_DEBUG, "required=%d acquired=%d", required_net_bufs,
 	       acquired_net_bufs);
 
@@ -1419,6 +1561,12 @@ static int net_buffer_release(struct m0_fom *fom)
 	M0_ENTRY("fom=%p", fom);
 
 	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	if (!netbufs_tlist_is_empty(&fom_obj->fcrw_ahead_list)) {
+		/* The next batch has its own buffers, see ahead_switch(). */
+		nbuf_release_done(fom, 0);
+		M0_LEAVE();
+		return M0_FSO_AGAIN;
+	}
 	still_required = fom_obj->fcrw_ndesc - fom_obj->fcrw_curr_desc_index;
 
 	nbuf_release_done(fom, still_required);
@@ -1457,18 +1605,16 @@ static int nbuf_release_done(struct m0_fom *fom, int still_required)
 					   &fom_obj->fcrw_netbuf_list));
 	acquired = netbufs_tlist_length(&fom_obj->fcrw_netbuf_list);
 
-	m0_net_buffer_pool_lock(fom_obj->fcrw_bp);
 	while (acquired > still_required) {
 		struct m0_net_buffer *nb;
 
 		nb = netbufs_tlist_tail(&fom_obj->fcrw_netbuf_list);
 		M0_ASSERT(nb != NULL);
-		m0_net_buffer_pool_put(fom_obj->fcrw_bp, nb, colour);
 		netbufs_tlink_del_fini(nb);
+		m0_net_buffer_pool_cache_put(fom_obj->fcrw_bp, nb, colour);
 		--acquired;
 		++released;
 	}
-	m0_net_buffer_pool_unlock(fom_obj->fcrw_bp);
 
 	fom_obj->fcrw_batch_size = acquired;
 	M0_LOG(M0_DEBUG, "Released %d network buffer(s), batch_size = %d.",
@@ -1478,6 +1624,59 @@ static int nbuf_release_done(struct m0_fom *fom, int still_required)
 	return M0_FSO_AGAIN;
 }
 
+/**
+ * Adds network buffers to m0_io_fom_cob_rw::fcrw_bulk, matching them with
+ * fop descriptors starting from m0_io_fom_cob_rw::fcrw_curr_desc_index,
+ * which is advanced past the added buffers.
+ */
+static int zero_copy_bufs_add(struct m0_fom *fom, struct m0_tl *bufs)
+{
+	int                      rc;
+	struct m0_fop           *fop = fom->fo_fop;
+	struct m0_io_fom_cob_rw *fom_obj;
+	struct m0_fop_cob_rw    *rwfop;
+	struct m0_net_buffer    *nb;
+	struct m0_net_domain    *dom;
+	m0_bcount_t              max_seg_size;
+
+	fom_obj      = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	rwfop        = io_rw_get(fop);
+	dom          = m0_fop_domain_get(fop);
+	max_seg_size = m0_net_domain_get_max_buffer_segment_size(dom);
+
+	/* Create rpc bulk bufs list using available net buffers */
+	m0_tl_for(netbufs, bufs, nb) {
+		uint32_t                segs_nr = 0;
+		struct m0_rpc_bulk_buf *rb_buf;
+		m0_bcount_t             used_size;
+
+		used_size = rwfop->crw_desc.id_descs[fom_obj->
+						fcrw_curr_desc_index].bdd_used;
+#ifdef ENABLE_LUSTRE
+		segs_nr = used_size / max_seg_size;
+#else
+		segs_nr = 1;
+		(void)max_seg_size;
+#endif
+		M0_LOG(M0_DEBUG, "segs_nr %d", segs_nr);
+
+		/*
+		 * @todo : Since passing only number of segments, supports full
+		 *         stripe I/Os. Should set exact count for last segment
+		 *         of network buffer. Also need to reset last segment
+		 *         count to original since buffers are reused by other
+		 *         I/O requests.
+		 */
+		rc = m0_rpc_bulk_buf_add(&fom_obj->fcrw_bulk, segs_nr,
+					 used_size, dom, nb, &rb_buf);
+		if (rc != 0)
+			return M0_RC(rc);
+
+		fom_obj->fcrw_curr_desc_index++;
+	} m0_tl_endfor;
+	return 0;
+}
+
 /**
  * Initiate zero-copy
  * Initiates zero-copy for batch of descriptors.
@@ -1496,11 +1695,8 @@ static int zero_copy_initiate(struct m0_fom *fom)
 	struct m0_io_fom_cob_rw     *fom_obj;
 	struct m0_fop_cob_rw        *rwfop;
 	struct m0_rpc_bulk          *rbulk;
-	struct m0_net_buffer        *nb;
 	struct m0_net_buf_desc_data *nbd_data;
-	struct m0_net_domain        *dom;
-	uint32_t                     buffers_added = 0;
-	m0_bcount_t                  max_seg_size;
+	uint32_t                     buffers_added;
 
 	M0_PRE(fom != NULL);
 	M0_PRE(m0_is_io_fop(fom->fo_fop));
@@ -1520,47 +1716,19 @@ static int zero_copy_initiate(struct m0_fom *fom)
 
 	M0_INVARIANT_EX(m0_tlist_invariant(&netbufs_tl,
 					   &fom_obj->fcrw_netbuf_list));
-	dom          = m0_fop_domain_get(fop);
-	max_seg_size = m0_net_domain_get_max_buffer_segment_size(dom);
-	nbd_data     = &rwfop->crw_desc.id_descs[fom_obj->
-						 fcrw_curr_desc_index];
+	nbd_data      = &rwfop->crw_desc.id_descs[fom_obj->
+						  fcrw_curr_desc_index];
+	buffers_added = fom_obj->fcrw_curr_desc_index;
 
-	/* Create rpc bulk bufs list using available net buffers */
-	m0_tl_for(netbufs, &fom_obj->fcrw_netbuf_list, nb) {
-		uint32_t                segs_nr = 0;
-		struct m0_rpc_bulk_buf *rb_buf;
-		m0_bcount_t             used_size;
-
-		used_size = rwfop->crw_desc.id_descs[fom_obj->
-						fcrw_curr_desc_index].bdd_used;
-#ifdef ENABLE_LUSTRE
-		segs_nr = used_size / max_seg_size;
-#else
-		segs_nr = 1;
-		(void)max_seg_size;
-#endif
-		M0_LOG(M0_DEBUG, "segs_nr %d", segs_nr);
-
-		/*
-		 * @todo : Since passing only number of segments, supports full
-		 *         stripe I/Os. Should set exact count for last segment
-		 *         of network buffer. Also need to reset last segment
-		 *         count to original since buffers are reused by other
-		 *         I/O requests.
-		 */
-		rc = m0_rpc_bulk_buf_add(rbulk, segs_nr, used_size,
-					 dom, nb, &rb_buf);
-		if (rc != 0) {
-			if (!M0_FI_ENABLED("keep-net-buffers"))
-				nbuf_release_done(fom, 0);
-			m0_fom_phase_move(fom, rc, M0_FOPH_FAILURE);
-			M0_LEAVE();
-			return M0_FSO_AGAIN;
-		}
-
-		fom_obj->fcrw_curr_desc_index++;
-		buffers_added++;
-	} m0_tl_endfor;
+	rc = zero_copy_bufs_add(fom, &fom_obj->fcrw_netbuf_list);
+	if (rc != 0) {
+		if (!M0_FI_ENABLED("keep-net-buffers"))
+			nbuf_release_done(fom, 0);
+		m0_fom_phase_move(fom, rc, M0_FOPH_FAILURE);
+		M0_LEAVE();
+		return M0_FSO_AGAIN;
+	}
+	buffers_added = fom_obj->fcrw_curr_desc_index - buffers_added;
 
 	M0_ASSERT(buffers_added == fom_obj->fcrw_batch_size);
 
@@ -1593,11 +1761,218 @@ static int zero_copy_initiate(struct m0_fom *fom)
 	}
 	M0_LOG(M0_DEBUG, "Zero-copy initiated. Added buffers %d",
 	       buffers_added);
+	if (m0_is_read_fop(fop))
+		read_ahead(fom);
 
 	M0_LEAVE();
 	return M0_FSO_WAIT;
 }
 
+/**
+ * Acquires, without waiting, network buffers for the batch of descriptors
+ * following the current one. Returns the number of acquired buffers.
+ *
+ * @see DLD-bulk-server-lspec-pipeline
+ */
+static uint32_t ahead_buffers_acquire(struct m0_fom *fom)
+{
+	struct m0_io_fom_cob_rw *fom_obj;
+	struct m0_net_buffer    *nb;
+	uint32_t                 colour;
+	uint32_t                 required;
+	uint32_t                 acquired = 0;
+
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	M0_PRE(fom_obj->fcrw_bp != NULL);
+	M0_PRE(netbufs_tlist_is_empty(&fom_obj->fcrw_ahead_list));
+
+	colour   = m0_net_tm_colour_get(m0_fop_tm_get(fom->fo_fop));
+	required = min32u(fom_obj->fcrw_ndesc - fom_obj->fcrw_curr_desc_index,
+			  fom_obj->fcrw_pipe_batch);
+	for (; acquired < required; ++acquired) {
+		nb = m0_net_buffer_pool_cache_get(fom_obj->fcrw_bp, colour);
+		if (nb == NULL)
+			break;
+		nb->nb_qtype = m0_is_read_fop(fom->fo_fop) ?
+			M0_NET_QT_ACTIVE_BULK_SEND : M0_NET_QT_ACTIVE_BULK_RECV;
+		netbufs_tlink_init(nb);
+		netbufs_tlist_add(&fom_obj->fcrw_ahead_list, nb);
+	}
+
+	fom_obj->fcrw_nbuf_max = max32u(fom_obj->fcrw_nbuf_max,
+					acquired + fom_obj->fcrw_batch_size);
+	M0_LOG(M0_DEBUG, "fom=%p ahead required=%u acquired=%u", fom,
+	       required, acquired);
+	return acquired;
+}
+
+/** Returns buffers of the ahead batch to the pool. */
+static void ahead_buffers_release(struct m0_fom *fom)
+{
+	struct m0_io_fom_cob_rw *fom_obj;
+	struct m0_net_buffer    *nb;
+	uint32_t                 colour;
+
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	colour  = m0_net_tm_colour_get(m0_fop_tm_get(fom->fo_fop));
+	m0_tl_teardown(netbufs, &fom_obj->fcrw_ahead_list, nb) {
+		netbufs_tlink_fini(nb);
+		m0_net_buffer_pool_cache_put(fom_obj->fcrw_bp, nb, colour);
+	}
+}
+
+/**
+ * Launches stob I/O of the batch following the one zero-copy of which has
+ * just been initiated (read).
+ *
+ * Errors are recorded in m0_io_fom_cob_rw::fcrw_rc and reported by
+ * io_finish() of the ahead batch.
+ *
+ * @see DLD-bulk-server-lspec-pipeline
+ */
+static void read_ahead(struct m0_fom *fom)
+{
+	int                      rc;
+	struct m0_io_fom_cob_rw *fom_obj;
+	struct m0_file          *file = NULL;
+
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	if (fom_obj->fcrw_pipe_batch == 0 ||
+	    fom_obj->fcrw_curr_desc_index == fom_obj->fcrw_ndesc ||
+	    ahead_buffers_acquire(fom) == 0)
+		return;
+
+	M0_ASSERT(fom_obj->fcrw_num_stobio_launched == 0);
+	rc = io_fom_cob2file(fom, &io_rw_get(fom->fo_fop)->crw_fid, &file);
+	if (rc == 0) {
+		rc = stob_io_launch(fom, file, &fom_obj->fcrw_ahead_list,
+				    fom_obj->fcrw_curr_desc_index);
+		m0_cob_put(container_of(file, struct m0_cob, co_file));
+	}
+	if (rc != 0)
+		fom_obj->fcrw_rc = fom_obj->fcrw_rc ?: rc;
+	M0_LOG(M0_DEBUG, "fom=%p read ahead launched=%u rc=%d", fom,
+	       fom_obj->fcrw_num_stobio_launched, rc);
+}
+
+/**
+ * Initiates zero-copy of the batch following the one stob I/O of which has
+ * just been launched (write).
+ *
+ * If zero-copy cannot be initiated, buffers of the ahead batch are released
+ * and the batch is processed after the current one, as without pipelining.
+ *
+ * @see DLD-bulk-server-lspec-pipeline
+ */
+static void write_ahead(struct m0_fom *fom)
+{
+	int                          rc;
+	struct m0_io_fom_cob_rw     *fom_obj;
+	struct m0_rpc_bulk          *rbulk;
+	struct m0_fop               *fop = fom->fo_fop;
+	struct m0_net_buf_desc_data *nbd_data;
+	int                          index;
+
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	if (fom_obj->fcrw_pipe_batch == 0 ||
+	    fom_obj->fcrw_curr_desc_index == fom_obj->fcrw_ndesc ||
+	    ahead_buffers_acquire(fom) == 0)
+		return;
+
+	index    = fom_obj->fcrw_curr_desc_index;
+	nbd_data = &io_rw_get(fop)->crw_desc.id_descs[index];
+	rbulk    = &fom_obj->fcrw_bulk;
+	m0_rpc_bulk_init(rbulk);
+	rc = zero_copy_bufs_add(fom, &fom_obj->fcrw_ahead_list);
+	if (rc == 0) {
+		fom_obj->fcrw_ahead_busy = true;
+		m0_mutex_lock(&rbulk->rb_mutex);
+		m0_fom_callback_arm(fom, &rbulk->rb_chan,
+				    &fom_obj->fcrw_ahead_cb);
+		m0_mutex_unlock(&rbulk->rb_mutex);
+		M0_ADDB2_ADD(M0_AVI_FOM_TO_BULK,
+			     m0_sm_id_get(&fom->fo_sm_phase), rbulk->rb_id);
+		rc = m0_rpc_bulk_load(rbulk, fop->f_item.ri_session->s_conn,
+				      nbd_data, &m0_rpc__buf_bulk_cb);
+		if (rc != 0) {
+			m0_mutex_lock(&rbulk->rb_mutex);
+			m0_fom_callback_cancel(&fom_obj->fcrw_ahead_cb);
+			m0_mutex_unlock(&rbulk->rb_mutex);
+			fom_obj->fcrw_ahead_busy = false;
+		}
+	}
+	if (rc != 0) {
+		M0_LOG(M0_DEBUG, "fom=%p write ahead failed rc=%d", fom, rc);
+		m0_rpc_bulk_buflist_empty(rbulk);
+		m0_rpc_bulk_fini(rbulk);
+		ahead_buffers_release(fom);
+		fom_obj->fcrw_curr_desc_index = index;
+	}
+}
+
+/**
+ * Makes the ahead batch current, after buffers of the current batch have
+ * been released, and moves the FOM to the phase waiting for completion of
+ * the operation in flight on it.
+ *
+ * @pre m0_fom_phase(fom) == M0_FOPH_IO_BUFFER_RELEASE
+ */
+static int ahead_switch(struct m0_fom *fom)
+{
+	struct m0_io_fom_cob_rw *fom_obj;
+	struct m0_net_buffer    *nb;
+	bool                     busy;
+
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	M0_PRE(m0_fom_phase(fom) == M0_FOPH_IO_BUFFER_RELEASE);
+	M0_PRE(netbufs_tlist_is_empty(&fom_obj->fcrw_netbuf_list));
+	M0_PRE(!netbufs_tlist_is_empty(&fom_obj->fcrw_ahead_list));
+
+	m0_tl_teardown(netbufs, &fom_obj->fcrw_ahead_list, nb)
+		netbufs_tlist_add_tail(&fom_obj->fcrw_netbuf_list, nb);
+	fom_obj->fcrw_batch_size =
+		netbufs_tlist_length(&fom_obj->fcrw_netbuf_list);
+	++fom_obj->fcrw_ahead_nr;
+
+	if (m0_is_read_fop(fom->fo_fop)) {
+		busy = fom_obj->fcrw_num_stobio_launched > 0;
+		m0_fom_phase_set(fom, M0_FOPH_IO_STOB_WAIT);
+	} else {
+		busy = fom_obj->fcrw_ahead_busy;
+		m0_fom_phase_set(fom, M0_FOPH_IO_ZERO_COPY_WAIT);
+	}
+	return busy ? M0_FSO_WAIT : M0_FSO_AGAIN;
+}
+
+/** Whether an operation on the ahead batch is in flight. */
+static bool ahead_is_busy(const struct m0_io_fom_cob_rw *fom_obj)
+{
+	return fom_obj->fcrw_ahead_busy ||
+		fom_obj->fcrw_num_stobio_launched > 0;
+}
+
+/**
+ * Drops the ahead batch of a failed FOM, once operations on it completed.
+ */
+static void ahead_fini(struct m0_fom *fom)
+{
+	struct m0_io_fom_cob_rw *fom_obj;
+	struct m0_stob_io_desc  *stio_desc;
+
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	M0_PRE(!ahead_is_busy(fom_obj));
+
+	if (m0_is_read_fop(fom->fo_fop)) {
+		m0_tl_teardown(stobio, &fom_obj->fcrw_stio_list, stio_desc)
+			stobio_tlist_add(&fom_obj->fcrw_done_list, stio_desc);
+	} else {
+		M0_ASSERT(rpcbulkbufs_tlist_is_empty(
+				  &fom_obj->fcrw_bulk.rb_buflist));
+		m0_rpc_bulk_fini(&fom_obj->fcrw_bulk);
+	}
+	ahead_buffers_release(fom);
+}
+
 /**
  * Zero-copy Finish
  * Check for zero-copy result.
@@ -1667,75 +2042,24 @@ M0_INTERNAL uint64_t m0_io_size(struct m0_stob_io *sio, uint32_t bshift)
 }
 
 /**
- * Launch STOB I/O
- * Helper function to launch STOB I/O.
- * This function initiates STOB I/O for all index vecs.
- * STOB I/O signaled on channel in m0_stob_io::si_wait.
- * There is a clink for each STOB I/O waiting on respective
- * m0_stob_io::si_wait. For every STOB I/O completion call-back
- * is launched to check its results and mark complete. After
- * all STOB I/O completes call-back function send signal to FOM
- * so that FOM gets out of wait-queue and placed in run-queue.
- *
- * @param fom file operation machine
+ * Launches stob I/O for network buffers, matching them with fop descriptors
+ * starting from index.
  *
- * @pre fom != NULL
- * @pre m0_fom_phase(fom) == M0_FOPH_IO_STOB_INIT
+ * Launched stob I/O is added to m0_io_fom_cob_rw::fcrw_stio_list and counted
+ * in m0_io_fom_cob_rw::fcrw_num_stobio_launched. On error the buffers
+ * following the failed one are not launched.
  */
-static int io_launch(struct m0_fom *fom)
+static int stob_io_launch(struct m0_fom *fom, struct m0_file *file,
+			  struct m0_tl *bufs, uint32_t index)
 {
-	int                      rc;
-	struct m0_fop           *fop;
+	int                      rc = 0;
+	struct m0_fop           *fop = fom->fo_fop;
 	struct m0_io_fom_cob_rw *fom_obj;
 	struct m0_net_buffer    *nb;
-	struct m0_fop_cob_rw    *rwfop;
-	struct m0_file          *file = NULL;
-	uint32_t                 index;
-
-	M0_PRE(fom != NULL);
-	M0_PRE(m0_is_io_fop(fom->fo_fop));
-	M0_PRE(m0_fom_phase(fom) == M0_FOPH_IO_STOB_INIT);
-
-	M0_ENTRY("fom=%p", fom);
+	struct m0_fop_cob_rw    *rwfop = io_rw_get(fop);
 
 	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
-	M0_ASSERT(m0_io_fom_cob_rw_invariant(fom_obj));
-	M0_ASSERT(fom_obj->fcrw_num_stobio_launched == 0);
-	M0_ASSERT(fom_obj->fcrw_io.si_stob.iv_vec.v_nr > 0);
-
-	fom_obj->fcrw_phase_start_time = m0_time_now();
-
-	fop   = fom->fo_fop;
-	rwfop = io_rw_get(fop);
-
-	rc = io_fom_cob2file(fom, &rwfop->crw_fid, &file);
-	if (rc != 0)
-		goto out;
-
-	/*
-	  Since the upper layer IO block size could differ with IO block size
-	  of storage object, the block alignment and mapping is necessary.
-	 */
-	fom_obj->fcrw_bshift = m0_stob_block_shift(fom_obj->fcrw_stob);
-
-	M0_INVARIANT_EX(m0_tlist_invariant(&netbufs_tl,
-					   &fom_obj->fcrw_netbuf_list));
-	M0_INVARIANT_EX(m0_tlist_invariant(&stobio_tl,
-					   &fom_obj->fcrw_stio_list));
-
-	index = fom_obj->fcrw_curr_desc_index;
-	/*
-	 * During write, zero copy is performed before stob I/O is launched.
-	 * For zero copy processing fcrw_curr_desc_index is
-	 * incremented for each processed net buffer. Whereas for read, first
-	 * stob I/O is launched and then zero copy is performed. So index is
-	 * decremented by value of number of net buffers to process in case of
-	 * write operation.
-	 */
-	index -= m0_is_write_fop(fop) ?
-		netbufs_tlist_length(&fom_obj->fcrw_netbuf_list) : 0;
-
-	m0_tl_for(netbufs, &fom_obj->fcrw_netbuf_list, nb) {
+	m0_tl_for(netbufs, bufs, nb) {
 		struct m0_indexvec     *mem_ivec;
 		struct m0_stob_io_desc *stio_desc;
 		struct m0_stob_io      *stio;
@@ -1848,6 +2172,78 @@ static int io_launch(struct m0_fom *fom)
 
 		stobio_tlist_add(&fom_obj->fcrw_stio_list, stio_desc);
 	} m0_tl_endfor;
+	return rc;
+}
+
+/**
+ * Launch STOB I/O
+ * Helper function to launch STOB I/O.
+ * This function initiates STOB I/O for all index vecs.
+ * STOB I/O signaled on channel in m0_stob_io::si_wait.
+ * There is a clink for each STOB I/O waiting on respective
+ * m0_stob_io::si_wait. For every STOB I/O completion call-back
+ * is launched to check its results and mark complete. After
+ * all STOB I/O completes call-back function send signal to FOM
+ * so that FOM gets out of wait-queue and placed in run-queue.
+ *
+ * @param fom file operation machine
+ *
+ * @pre fom != NULL
+ * @pre m0_fom_phase(fom) == M0_FOPH_IO_STOB_INIT
+ */
+static int io_launch(struct m0_fom *fom)
+{
+	int                      rc;
+	struct m0_fop           *fop;
+	struct m0_io_fom_cob_rw *fom_obj;
+	struct m0_fop_cob_rw    *rwfop;
+	struct m0_file          *file = NULL;
+	uint32_t                 index;
+
+	M0_PRE(fom != NULL);
+	M0_PRE(m0_is_io_fop(fom->fo_fop));
+	M0_PRE(m0_fom_phase(fom) == M0_FOPH_IO_STOB_INIT);
+
+	M0_ENTRY("fom=%p", fom);
+
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	M0_ASSERT(m0_io_fom_cob_rw_invariant(fom_obj));
+	M0_ASSERT(fom_obj->fcrw_num_stobio_launched == 0);
+	M0_ASSERT(fom_obj->fcrw_io.si_stob.iv_vec.v_nr > 0);
+
+	fom_obj->fcrw_phase_start_time = m0_time_now();
+
+	fop   = fom->fo_fop;
+	rwfop = io_rw_get(fop);
+
+	rc = io_fom_cob2file(fom, &rwfop->crw_fid, &file);
+	if (rc != 0)
+		goto out;
+
+	/*
+	  Since the upper layer IO block size could differ with IO block size
+	  of storage object, the block alignment and mapping is necessary.
+	 */
+	fom_obj->fcrw_bshift = m0_stob_block_shift(fom_obj->fcrw_stob);
+
+	M0_INVARIANT_EX(m0_tlist_invariant(&netbufs_tl,
+					   &fom_obj->fcrw_netbuf_list));
+	M0_INVARIANT_EX(m0_tlist_invariant(&stobio_tl,
+					   &fom_obj->fcrw_stio_list));
+
+	index = fom_obj->fcrw_curr_desc_index;
+	/*
+	 * During write, zero copy is performed before stob I/O is launched.
+	 * For zero copy processing fcrw_curr_desc_index is
+	 * incremented for each processed net buffer. Whereas for read, first
+	 * stob I/O is launched and then zero copy is performed. So index is
+	 * decremented by value of number of net buffers to process in case of
+	 * write operation.
+	 */
+	index -= m0_is_write_fop(fop) ?
+		netbufs_tlist_length(&fom_obj->fcrw_netbuf_list) : 0;
+
+	rc = stob_io_launch(fom, file, &fom_obj->fcrw_netbuf_list, index);
 
 	m0_cob_put(container_of(file, struct m0_cob, co_file));
 
@@ -1858,6 +2254,8 @@ static int io_launch(struct m0_fom *fom)
 	if (fom_obj->fcrw_num_stobio_launched > 0) {
 		M0_LOG(M0_DEBUG, "STOB I/O launched, io_descs = %d",
 		       fom_obj->fcrw_num_stobio_launched);
+		if (m0_is_write_fop(fop) && fom_obj->fcrw_rc == 0)
+			write_ahead(fom);
 		M0_LEAVE();
 		return M0_FSO_WAIT;
 	}
@@ -2127,6 +2525,26 @@ static void stob_be_credit(struct m0_fom *fom)
 }
 
 
+/**
+ * Puts the stob and sets operation status in the reply fop when the FOM
+ * ends.
+ */
+static void io_fom_done(struct m0_fom *fom)
+{
+	struct m0_io_fom_cob_rw    *fom_obj;
+	struct m0_fop_cob_rw_reply *rwrep;
+
+	fom_obj = container_of(fom, struct m0_io_fom_cob_rw, fcrw_gen);
+	if (fom_obj->fcrw_stob != NULL)
+		m0_storage_dev_stob_put(m0_cs_storage_devs_get(),
+					fom_obj->fcrw_stob);
+	rwrep = io_rw_rep_get(fom->fo_rep_fop);
+	rwrep->rwr_rc    = m0_fom_rc(fom);
+	rwrep->rwr_count = fom_obj->fcrw_count << fom_obj->fcrw_bshift;
+	/* Information about the transaction for this update op. */
+	m0_fom_mod_rep_fill(&rwrep->rwr_mod_rep, fom);
+}
+
 /**
  * State Transition function for I/O operation that executes
  * on data server.
@@ -2142,7 +2560,6 @@ static int m0_io_fom_cob_rw_tick(struct m0_fom *fom)
 	struct m0_io_fom_cob_rw                  *fom_obj;
 	struct m0_io_fom_cob_rw_state_transition  st;
 	struct m0_fop_cob_rw                     *rwfop;
-	struct m0_fop_cob_rw_reply               *rwrep;
 
 	M0_PRE(fom != NULL);
 	M0_PRE(m0_is_io_fop(fom->fo_fop));
@@ -2166,6 +2583,15 @@ static int m0_io_fom_cob_rw_tick(struct m0_fom *fom)
 			return M0_RC(M0_FSO_AGAIN);
 		}
 	}
+	if (phase == M0_FOPH_FAILURE &&
+	    !netbufs_tlist_is_empty(&fom_obj->fcrw_ahead_list)) {
+		/* Wait for the ahead batch before releasing resources. */
+		if (ahead_is_busy(fom_obj))
+			return M0_RC(M0_FSO_WAIT);
+		ahead_fini(fom);
+		io_fom_done(fom);
+		return M0_RC(M0_FSO_AGAIN);
+	}
 	if (phase < M0_FOPH_NR && m0_is_write_fop(fom->fo_fop)) {
 		if (phase == M0_FOPH_TXN_OPEN) {
 			struct m0_be_tx_credit *accum;
@@ -2231,16 +2657,14 @@ static int m0_io_fom_cob_rw_tick(struct m0_fom *fom)
 	/* Set operation status in reply fop if FOM ends.*/
 	if (m0_fom_phase(fom) == M0_FOPH_SUCCESS ||
 	    m0_fom_phase(fom) == M0_FOPH_FAILURE) {
-		if (fom_obj->fcrw_stob != NULL)
-			m0_storage_dev_stob_put(m0_cs_storage_devs_get(),
-						fom_obj->fcrw_stob);
-		rwrep = io_rw_rep_get(fom->fo_rep_fop);
-		rwrep->rwr_rc    = m0_fom_rc(fom);
-		rwrep->rwr_count = fom_obj->fcrw_count << fom_obj->fcrw_bshift;
-		/* Information about the transaction for this update op. */
-		m0_fom_mod_rep_fill(&rwrep->rwr_mod_rep, fom);
+		/* With an ahead batch, this is done once it is dropped. */
+		if (netbufs_tlist_is_empty(&fom_obj->fcrw_ahead_list))
+			io_fom_done(fom);
 		return M0_RC(rc);
 	}
+	if (m0_fom_phase(fom) == M0_FOPH_IO_BUFFER_RELEASE &&
+	    !netbufs_tlist_is_empty(&fom_obj->fcrw_ahead_list))
+		return M0_RC(ahead_switch(fom));
 
 	if (m0_is_write_fop(fom->fo_fop) &&
 	    m0_fom_phase(fom) == M0_FOPH_IO_ZERO_COPY_WAIT &&
@@ -2302,6 +2726,12 @@ static void m0_io_fom_cob_rw_fini(struct m0_fom *fom)
 	M0_ADDB2_ADD(M0_AVI_ATTR, m0_sm_id_get(&fom->fo_sm_phase),
                      M0_AVI_IOS_IO_ATTR_FOMCRW_BYTES,
                      fom_obj->fcrw_count << fom_obj->fcrw_bshift);
+	M0_ADDB2_ADD(M0_AVI_ATTR, m0_sm_id_get(&fom->fo_sm_phase),
+		     M0_AVI_IOS_IO_ATTR_FOMCRW_AHEAD_NR,
+		     fom_obj->fcrw_ahead_nr);
+	M0_ADDB2_ADD(M0_AVI_ATTR, m0_sm_id_get(&fom->fo_sm_phase),
+		     M0_AVI_IOS_IO_ATTR_FOMCRW_NBUF_MAX,
+		     fom_obj->fcrw_nbuf_max);
 
 	tm     = m0_fop_tm_get(fop);
 	colour = m0_net_tm_colour_get(tm);
@@ -2309,15 +2739,17 @@ static void m0_io_fom_cob_rw_fini(struct m0_fom *fom)
 	if (fom_obj->fcrw_bp != NULL) {
 		M0_INVARIANT_EX(m0_tlist_invariant(&netbufs_tl,
 						   &fom_obj->fcrw_netbuf_list));
-		m0_net_buffer_pool_lock(fom_obj->fcrw_bp);
 		m0_tl_for (netbufs, &fom_obj->fcrw_netbuf_list, nb) {
-			m0_net_buffer_pool_put(fom_obj->fcrw_bp, nb, colour);
 			netbufs_tlink_del_fini(nb);
+			m0_net_buffer_pool_cache_put(fom_obj->fcrw_bp, nb,
+						     colour);
 		} m0_tl_endfor;
-		m0_net_buffer_pool_unlock(fom_obj->fcrw_bp);
 		netbufs_tlist_fini(&fom_obj->fcrw_netbuf_list);
 	}
 
+	netbufs_tlist_fini(&fom_obj->fcrw_ahead_list);
+	m0_fom_callback_fini(&fom_obj->fcrw_ahead_cb);
+
 	m0_tl_teardown(stobio, &fom_obj->fcrw_done_list, stio_desc)
 		stio_desc_fini(stio_desc);
 	stobio_tlist_fini(&fom_obj->fcrw_done_list);
@@ -2327,7 +2759,7 @@ static void m0_io_fom_cob_rw_fini(struct m0_fom *fom)
 	if (fom_obj->fcrw_stio != NULL)
 		stob_io_destroy(fom);
 	m0_fom_fini(fom);
-	m0_free(fom_obj);
+	m0_slab_free(&io_fom_slab, fom_obj);
 }
 
 /**
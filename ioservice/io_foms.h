@@ -232,6 +232,25 @@ struct m0_io_fom_cob_rw {
 	m0_time_t                        fcrw_io_launch_time;
 	/** The flags from m0_fop_cob_rw::crw_flags */
 	uint64_t                         fcrw_flags;
+	/**
+	 * Maximal number of descriptors in a batch when stob I/O and
+	 * zero-copy of successive batches overlap, 0 if they do not.
+	 * @see DLD-bulk-server-lspec-pipeline
+	 */
+	uint32_t                         fcrw_pipe_batch;
+	/**
+	 * Network buffers of the batch processed ahead of the batch in
+	 * fcrw_netbuf_list.
+	 */
+	struct m0_tl                     fcrw_ahead_list;
+	/** Zero-copy of the ahead batch completion callback (write). */
+	struct m0_fom_callback           fcrw_ahead_cb;
+	/** True while zero-copy of the ahead batch is in progress. */
+	bool                             fcrw_ahead_busy;
+	/** Number of batches processed ahead. */
+	uint32_t                         fcrw_ahead_nr;
+	/** Maximal number of network buffers held at once. */
+	uint32_t                         fcrw_nbuf_max;
 };
 
 /**
@@ -291,6 +310,10 @@ M0_INTERNAL int m0_io_cob_stob_create(struct m0_fom *fom,
 
 M0_INTERNAL uint64_t m0_io_size(struct m0_stob_io *sio, uint32_t bshift);
 
+/** Initialises the cache of read-write foms, see lib/slab.h. */
+M0_INTERNAL void m0_io_foms_init(void);
+M0_INTERNAL void m0_io_foms_fini(void);
+
 /** @} end of io_foms */
 
 #endif /* __MOTR_IOSERVICE_IO_FOMS_H__ */
@@ -310,7 +310,8 @@ M0_INTERNAL int m0_ioservice_fop_init(void)
 			 .sm        = &io_conf,
 			 .svc_type  = &m0_ios_type,
 #endif
-			 .rpc_ops   = &io_item_type_ops);
+			 .rpc_ops   = &io_item_type_ops,
+			 .data_cache = true);
 
 	M0_FOP_TYPE_INIT(&m0_fop_cob_writev_fopt,
 			 .name      = "write",
@@ -323,19 +324,22 @@ M0_INTERNAL int m0_ioservice_fop_init(void)
 			 .sm        = &io_conf,
 			 .svc_type  = &m0_ios_type,
 #endif
-			 .rpc_ops   = &io_item_type_ops);
+			 .rpc_ops   = &io_item_type_ops,
+			 .data_cache = true);
 
 	M0_FOP_TYPE_INIT(&m0_fop_cob_readv_rep_fopt,
 			 .name      = "read-reply",
 			 .opcode    = M0_IOSERVICE_READV_REP_OPCODE,
 			 .xt        = m0_fop_cob_readv_rep_xc,
-			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY);
+			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY,
+			 .data_cache = true);
 
 	M0_FOP_TYPE_INIT(&m0_fop_cob_writev_rep_fopt,
 			 .name      = "write-reply",
 			 .opcode    = M0_IOSERVICE_WRITEV_REP_OPCODE,
 			 .xt        = m0_fop_cob_writev_rep_xc,
-			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY);
+			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY,
+			 .data_cache = true);
 
 	M0_FOP_TYPE_INIT(&m0_fop_cob_create_fopt,
 			 .name      = "cob-create",
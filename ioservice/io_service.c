@@ -39,6 +39,7 @@
 #include "reqh/reqh_service.h"
 #include "reqh/reqh.h"
 #include "ioservice/io_fops.h"
+#include "ioservice/io_foms.h"       /* m0_io_foms_init */
 #include "ioservice/io_service.h"
 #include "ioservice/ios_start_sm.h"
 #include "pool/pool.h"
@@ -162,6 +163,7 @@ M0_INTERNAL int m0_ios_register(void)
 	rc = m0_ioservice_fop_init();
 	if (rc != 0)
 		return M0_ERR_INFO(rc, "Unable to initialize fops");
+	m0_io_foms_init();
 	m0_reqh_service_type_register(&m0_ios_type);
 	m0_get()->i_ios_cdom_key = m0_reqh_lockers_allot();
 	ios_mds_conn_key = m0_reqh_lockers_allot();
@@ -177,6 +179,7 @@ M0_INTERNAL void m0_ios_unregister(void)
 	m0_reqh_lockers_free(m0_get()->i_ios_cdom_key);
 
 	m0_reqh_service_type_unregister(&m0_ios_type);
+	m0_io_foms_fini();
 	m0_ioservice_fop_fini();
 }
 
@@ -334,6 +337,7 @@ static int ios_allocate(struct m0_reqh_service **service,
 
 	bufferpools_tlist_init(&ios->rios_buffer_pools);
 	ios->rios_magic = M0_IOS_REQH_SVC_MAGIC;
+	ios->rios_pipeline = true;
 
 	*service = &ios->rios_gen;
 	(*service)->rs_ops = &ios_ops;
@@ -109,6 +109,11 @@ struct m0_reqh_io_service {
 
 	/** FOM to be notified about asynchronous start completion */
 	struct m0_fom               *rios_fom;
+	/**
+	 * Whether I/O foms overlap stob I/O and zero-copy of successive
+	 * batches of descriptors.
+	 */
+	bool                         rios_pipeline;
 	/** magic to check io service object */
 	uint64_t                     rios_magic;
 };
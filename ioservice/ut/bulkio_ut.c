@@ -1149,6 +1149,16 @@ static const struct m0_fom_ops bulkio_server_read_fom_ops = {
 	.fo_home_locality = m0_io_fom_cob_rw_locality_get
 };
 
+/*
+ * Phase checks in the ticks above expect batches of descriptors to be
+ * processed one after another.
+ */
+static void io_fom_serial_set(struct m0_fom *fom)
+{
+	container_of(fom, struct m0_io_fom_cob_rw,
+		     fcrw_gen)->fcrw_pipe_batch = 0;
+}
+
 static int io_fop_stob_create_fom_create(struct m0_fop  *fop,
 					 struct m0_fom **m,
 					 struct m0_reqh *reqh)
@@ -1173,6 +1183,7 @@ static int io_fop_server_write_fom_create(struct m0_fop  *fop,
 
 	rc = m0_io_fom_cob_rw_create(fop, &fom, reqh);
 	M0_UT_ASSERT(rc == 0);
+	io_fom_serial_set(fom);
 	fom->fo_ops = &bulkio_server_write_fom_ops;
 	*m = fom;
 	M0_UT_ASSERT(fom->fo_fop != 0);
@@ -1200,6 +1211,7 @@ static int ut_io_fom_cob_rw_create(struct m0_fop *fop, struct m0_fom **m,
 	             fom->fo_type != NULL &&
 	             fom->fo_ops != NULL);
 
+	io_fom_serial_set(fom);
 	fom->fo_ops = &ut_io_fom_cob_rw_ops;
 	*m = fom;
 	M0_UT_ASSERT(fom->fo_fop != 0);
@@ -1215,6 +1227,7 @@ static int io_fop_server_read_fom_create(struct m0_fop  *fop,
 
 	rc = m0_io_fom_cob_rw_create(fop, &fom, reqh);
 	M0_UT_ASSERT(rc == 0);
+	io_fom_serial_set(fom);
 	fom->fo_ops = &bulkio_server_read_fom_ops;
 	*m = fom;
 	M0_UT_ASSERT(fom->fo_fop != 0);
@@ -1713,7 +1726,45 @@ static void fop_create_populate(int index, enum M0_RPC_OPCODES op, int buf_nr)
 		bp->bp_offsets[i] = IO_SEG_START_OFFSET;
 }
 
-static void bulkio_server_read_write_multiple_nb(void)
+/** Number of batches processed ahead by the finished I/O foms. */
+static struct m0_atomic64 io_ahead_nr;
+
+static void io_ahead_fom_fini(struct m0_fom *fom)
+{
+	m0_atomic64_add(&io_ahead_nr,
+			container_of(fom, struct m0_io_fom_cob_rw,
+				     fcrw_gen)->fcrw_ahead_nr);
+	m0_io_fom_cob_rw_fini(fom);
+}
+
+static const struct m0_fom_ops io_ahead_fom_ops = {
+	.fo_fini          = io_ahead_fom_fini,
+	.fo_tick          = m0_io_fom_cob_rw_tick,
+	.fo_home_locality = m0_io_fom_cob_rw_locality_get,
+	.fo_addb2_descr   = io_fom_addb2_descr
+};
+
+/* Real I/O fom, which reports fcrw_ahead_nr to the UT when finalised. */
+static int io_ahead_fom_create(struct m0_fop *fop, struct m0_fom **m,
+			       struct m0_reqh *reqh)
+{
+	int rc;
+
+	rc = m0_io_fom_cob_rw_create(fop, m, reqh);
+	M0_UT_ASSERT(rc == 0);
+	(*m)->fo_ops = &io_ahead_fom_ops;
+	return rc;
+}
+
+static const struct m0_fom_type_ops io_ahead_fomt_ops = {
+	.fto_create = io_ahead_fom_create,
+};
+
+/*
+ * Writes then reads back buffers of several descriptors with the real I/O
+ * fom. Returns the number of batches the foms processed ahead.
+ */
+static uint64_t server_read_write_multiple_nb(void)
 {
 	int		    i;
 	int		    j;
@@ -1722,6 +1773,7 @@ static void bulkio_server_read_write_multiple_nb(void)
 	struct m0_bufvec   *buf;
 	struct m0_reqh     *reqh;
 
+	m0_atomic64_set(&io_ahead_nr, 0);
 	buf_nr = IO_FOPS_NR / 4;
 	for (i = 0; i < buf_nr; ++i) {
 		buf = &bp->bp_iobuf[i]->nb_buffer;
@@ -1732,6 +1784,7 @@ static void bulkio_server_read_write_multiple_nb(void)
 	op = M0_IOSERVICE_WRITEV_OPCODE;
 	fop_create_populate(0, op, buf_nr);
 	bp->bp_wfops[0]->if_fop.f_type->ft_ops = &io_fop_rwv_ops;
+	bp->bp_wfops[0]->if_fop.f_type->ft_fom_type.ft_ops = &io_ahead_fomt_ops;
 	io_fops_submit(0, op);
 	io_fops_destroy(bp);
 	reqh = m0_cs_reqh_get(&bp->bp_sctx->rsx_motr_ctx);
@@ -1746,9 +1799,35 @@ static void bulkio_server_read_write_multiple_nb(void)
 	op = M0_IOSERVICE_READV_OPCODE;
 	fop_create_populate(0, op, buf_nr);
 	bp->bp_rfops[0]->if_fop.f_type->ft_ops = &io_fop_rwv_ops;
+	bp->bp_rfops[0]->if_fop.f_type->ft_fom_type.ft_ops = &io_ahead_fomt_ops;
 	io_fops_submit(0, op);
 	io_fops_destroy(bp);
 	m0_reqh_idle_wait(reqh);
+	return m0_atomic64_get(&io_ahead_nr);
+}
+
+static void bulkio_server_read_write_multiple_nb(void)
+{
+	/* Batches of descriptors are pipelined. */
+	M0_UT_ASSERT(server_read_write_multiple_nb() > 0);
+}
+
+/*
+ * Same as bulkio_server_read_write_multiple_nb(), with batches of
+ * descriptors processed one after another.
+ */
+static void bulkio_server_read_write_multiple_nb_serial(void)
+{
+	struct m0_reqh_io_service *ios;
+	struct m0_reqh            *reqh;
+
+	reqh = m0_cs_reqh_get(&bp->bp_sctx->rsx_motr_ctx);
+	ios  = container_of(m0_reqh_service_find(&m0_ios_type, reqh),
+			    struct m0_reqh_io_service, rios_gen);
+	M0_UT_ASSERT(ios->rios_pipeline);
+	ios->rios_pipeline = false;
+	M0_UT_ASSERT(server_read_write_multiple_nb() == 0);
+	ios->rios_pipeline = true;
 }
 
 static void bulkio_init(void)
@@ -1830,6 +1909,8 @@ struct m0_ut_suite bulkio_server_ut = {
 		   bulkio_server_fsync_multiple_read_write},
 		{ "bulkio_server_rw_multiple_nb_server",
 		   bulkio_server_read_write_multiple_nb},
+		{ "bulkio_server_rw_multiple_nb_serial",
+		   bulkio_server_read_write_multiple_nb_serial},
 		{ "bulkio_server_rw_state_transition_test",
 		   bulkio_server_rw_state_transition_test},
 /** @todo: MOTR-1502: When HA will be in place we no longer require
@@ -33,6 +33,9 @@
 #include "fid/fid.h"
 #include "motr/magic.h"
 #include "iscservice/isc.h"
+#ifndef __KERNEL__
+#include "iscservice/scan.h"         /* m0_isc_scan_comp */
+#endif
 
 static int iscs_allocate(struct m0_reqh_service **service,
                          const struct m0_reqh_service_type *stype);
@@ -149,6 +152,15 @@ static int iscs_start(struct m0_reqh_service *service)
 	rc = m0_isc_htable_init(m0_isc_htable_get(), ISC_HT_BUCKET_NR);
 	if (rc != 0)
 		return M0_ERR(rc);
+#ifndef __KERNEL__
+	/* Built-in computations, unregistered by iscs_stop(). */
+	rc = m0_isc_comp_register(&m0_isc_scan_comp, "isc-scan",
+				  &m0_isc_scan_fid);
+	if (rc != 0) {
+		m0_isc_htable_fini(m0_isc_htable_get());
+		return M0_ERR(rc);
+	}
+#endif
 	M0_LEAVE();
 	return rc;
 }
@@ -0,0 +1,815 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_ISCS
+#include "lib/trace.h"
+
+#include <float.h>                  /* DBL_MAX */
+
+#include "lib/errno.h"
+#include "lib/memory.h"
+#include "lib/misc.h"               /* M0_SET0 */
+#include "lib/arith.h"              /* min64u, m0_is_po2 */
+#include "lib/vec.h"                /* M0_0VEC_SHIFT */
+#include "xcode/xcode.h"
+#include "fop/fom.h"
+#include "stob/io.h"
+#include "stob/stob.h"
+#include "ioservice/fid_convert.h"  /* m0_fid_convert_cob2stob */
+#include "ioservice/storage_dev.h"  /* m0_storage_dev_stob_find */
+#include "motr/setup.h"             /* m0_cs_storage_devs_get */
+#include "iscservice/isc.h"
+#include "iscservice/scan.h"
+#include "iscservice/scan_xc.h"
+
+/**
+ * @addtogroup isc-scan
+ * @{
+ */
+
+const struct m0_fid m0_isc_scan_fid = M0_FID_INIT(0x6973632d7363616e, 1);
+
+static uint32_t scan_type_size(uint32_t type)
+{
+	return M0_IN(type, (M0_ISC_SCAN_U32, M0_ISC_SCAN_I32)) ? 4 : 8;
+}
+
+static bool scan_is_column(uint32_t kernel)
+{
+	return M0_IN(kernel, (M0_ISC_SCAN_COUNT, M0_ISC_SCAN_MIN_MAX_SUM));
+}
+
+M0_INTERNAL int m0_isc_scan_args_check(const struct m0_isc_scan_args *args)
+{
+	uint32_t size;
+
+	if (args->sa_kernel >= M0_ISC_SCAN_KERNEL_NR)
+		return M0_ERR_INFO(-EINVAL, "kernel=%u", args->sa_kernel);
+	if (scan_is_column(args->sa_kernel)) {
+		if (args->sa_type >= M0_ISC_SCAN_TYPE_NR ||
+		    args->sa_cmp >= M0_ISC_SCAN_CMP_NR)
+			return M0_ERR_INFO(-EINVAL, "type=%u cmp=%u",
+					   args->sa_type, args->sa_cmp);
+		size = scan_type_size(args->sa_type);
+		if (args->sa_rec_size == 0 || !m0_is_po2(args->sa_rec_size) ||
+		    args->sa_rec_size > M0_ISC_SCAN_CHUNK ||
+		    args->sa_col_off % size != 0 ||
+		    args->sa_col_off + size > args->sa_rec_size ||
+		    args->sa_count % args->sa_rec_size != 0)
+			return M0_ERR_INFO(-EINVAL, "rec_size=%u col_off=%u "
+					   "count=%"PRIu64, args->sa_rec_size,
+					   args->sa_col_off, args->sa_count);
+	}
+	if (args->sa_kernel == M0_ISC_SCAN_SEARCH &&
+	    (args->sa_pattern.b_nob == 0 ||
+	     args->sa_pattern.b_nob > M0_ISC_SCAN_PATTERN_MAX))
+		return M0_ERR_INFO(-EINVAL, "pattern nob=%"PRIu64,
+				   args->sa_pattern.b_nob);
+	return 0;
+}
+
+M0_INTERNAL void m0_isc_scan_ctx_init(struct m0_isc_scan_ctx *ctx,
+				      const struct m0_isc_scan_args *args)
+{
+	M0_PRE(m0_isc_scan_args_check(args) == 0);
+
+	M0_SET0(ctx);
+	ctx->sc_args = args;
+	if (!scan_is_column(args->sa_kernel))
+		return;
+	ctx->sc_stride = args->sa_rec_size / scan_type_size(args->sa_type);
+	if (args->sa_kernel != M0_ISC_SCAN_MIN_MAX_SUM)
+		return;
+	switch (args->sa_type) {
+	case M0_ISC_SCAN_U32:
+		ctx->sc_min.sv_u = UINT32_MAX;
+		break;
+	case M0_ISC_SCAN_I32:
+		ctx->sc_min.sv_i = INT32_MAX;
+		ctx->sc_max.sv_i = INT32_MIN;
+		break;
+	case M0_ISC_SCAN_U64:
+		ctx->sc_min.sv_u = UINT64_MAX;
+		break;
+	case M0_ISC_SCAN_I64:
+		ctx->sc_min.sv_i = INT64_MAX;
+		ctx->sc_max.sv_i = INT64_MIN;
+		break;
+	case M0_ISC_SCAN_F64:
+		ctx->sc_min.sv_f =  DBL_MAX;
+		ctx->sc_max.sv_f = -DBL_MAX;
+		break;
+	}
+}
+
+/*
+ * Column kernels.
+ *
+ * A kernel is generated for every column type. The predicate is switched on
+ * outside of the loop, so that each loop is a branch-free strided pass the
+ * compiler can vectorise. Values not matching the predicate are replaced by
+ * the neutral elements of the reductions rather than skipped. The stride is
+ * taken from the context: gcc does not vectorise the gather when it can see
+ * the stride being derived from a 32-bit record size.
+ */
+
+#define SCAN_CMP_SWITCH(cmp, loop)					\
+({									\
+	switch (cmp) {							\
+	case M0_ISC_SCAN_ALL: loop(((void)v, true)); break;		\
+	case M0_ISC_SCAN_LT:  loop(v <  op);   break;			\
+	case M0_ISC_SCAN_LE:  loop(v <= op);   break;			\
+	case M0_ISC_SCAN_EQ:  loop(v == op);   break;			\
+	case M0_ISC_SCAN_NE:  loop(v != op);   break;			\
+	case M0_ISC_SCAN_GE:  loop(v >= op);   break;			\
+	case M0_ISC_SCAN_GT:  loop(v >  op);   break;			\
+	default:              M0_IMPOSSIBLE("cmp=%u", (cmp));		\
+	}								\
+})
+
+#define SCAN_COUNT_LOOP(pred)						\
+	for (i = 0; i < nr; ++i) {					\
+		scan_t v = col[i * stride];				\
+									\
+		cnt += (pred) ? 1 : 0;					\
+	}
+
+#define SCAN_AGG_LOOP(pred)						\
+	for (i = 0; i < nr; ++i) {					\
+		scan_t v = col[i * stride];				\
+		bool   m = (pred);					\
+		scan_t a = m ? v : hi;					\
+		scan_t b = m ? v : lo;					\
+									\
+		cnt += m ? 1 : 0;					\
+		sum += m ? v : 0;					\
+		mn   = a < mn ? a : mn;					\
+		mx   = b > mx ? b : mx;					\
+	}
+
+#define SCAN_COLUMN_DEFINE(name, T, acc_t, field, lo_val, hi_val)	\
+static void scan_column_ ## name(struct m0_isc_scan_ctx *ctx,		\
+				 const char *buf, uint64_t nr)		\
+{									\
+	typedef T scan_t;						\
+	const struct m0_isc_scan_args *args = ctx->sc_args;		\
+	const union m0_isc_scan_val    opv  = {				\
+		.sv_u = args->sa_operand				\
+	};								\
+	const T *col    = (const T *)(buf + args->sa_col_off);		\
+	uint64_t stride = ctx->sc_stride;				\
+	uint64_t cnt    = 0;						\
+	uint64_t i;							\
+	const T  op     = (T)opv.field;					\
+	const T  lo     = lo_val;					\
+	const T  hi     = hi_val;					\
+	T        mn     = (T)ctx->sc_min.field;				\
+	T        mx     = (T)ctx->sc_max.field;				\
+	acc_t    sum    = 0;						\
+									\
+	if (args->sa_kernel == M0_ISC_SCAN_COUNT)			\
+		SCAN_CMP_SWITCH(args->sa_cmp, SCAN_COUNT_LOOP);		\
+	else {								\
+		SCAN_CMP_SWITCH(args->sa_cmp, SCAN_AGG_LOOP);		\
+		ctx->sc_min.field  = mn;				\
+		ctx->sc_max.field  = mx;				\
+		ctx->sc_sum.field += sum;				\
+	}								\
+	ctx->sc_count += cnt;						\
+}
+
+SCAN_COLUMN_DEFINE(u32, uint32_t, uint64_t, sv_u, 0,         UINT32_MAX)
+SCAN_COLUMN_DEFINE(i32, int32_t,  int64_t,  sv_i, INT32_MIN, INT32_MAX)
+SCAN_COLUMN_DEFINE(u64, uint64_t, uint64_t, sv_u, 0,         UINT64_MAX)
+SCAN_COLUMN_DEFINE(i64, int64_t,  int64_t,  sv_i, INT64_MIN, INT64_MAX)
+SCAN_COLUMN_DEFINE(f64, double,   double,   sv_f, -DBL_MAX,  DBL_MAX)
+
+#undef SCAN_COLUMN_DEFINE
+#undef SCAN_AGG_LOOP
+#undef SCAN_COUNT_LOOP
+#undef SCAN_CMP_SWITCH
+
+static void scan_column(struct m0_isc_scan_ctx *ctx,
+			const char *buf, m0_bcount_t nob)
+{
+	static void (*kernel[M0_ISC_SCAN_TYPE_NR])(struct m0_isc_scan_ctx *,
+						   const char *, uint64_t) = {
+		[M0_ISC_SCAN_U32] = &scan_column_u32,
+		[M0_ISC_SCAN_I32] = &scan_column_i32,
+		[M0_ISC_SCAN_U64] = &scan_column_u64,
+		[M0_ISC_SCAN_I64] = &scan_column_i64,
+		[M0_ISC_SCAN_F64] = &scan_column_f64
+	};
+	uint64_t nr = nob / ctx->sc_args->sa_rec_size;
+
+	M0_PRE(nob % ctx->sc_args->sa_rec_size == 0);
+	kernel[ctx->sc_args->sa_type](ctx, buf, nr);
+	ctx->sc_rec_nr += nr;
+}
+
+/*
+ * Checksum kernel.
+ *
+ * With A = sum(x[i]) and B = sum(A[i]) over the running sums A[i], B can be
+ * computed as sum((n - i) * x[i]), which has no loop-carried dependency
+ * besides the reductions. Checksums of consecutive pieces are combined as
+ * A = A1 + A2, B = B1 + B2 + n2 * A1.
+ */
+
+static void scan_csum_fold(uint64_t *a, uint64_t *b,
+			   uint64_t a2, uint64_t b2, uint64_t nob2)
+{
+	*b += b2 + nob2 * *a;
+	*a += a2;
+}
+
+static void scan_checksum(struct m0_isc_scan_ctx *ctx,
+			  const unsigned char *buf, m0_bcount_t nob)
+{
+	uint64_t a = 0;
+	uint64_t b = 0;
+	uint64_t i;
+
+	for (i = 0; i < nob; ++i) {
+		a += buf[i];
+		b += (nob - i) * buf[i];
+	}
+	scan_csum_fold(&ctx->sc_csum_a, &ctx->sc_csum_b, a, b, nob);
+}
+
+/*
+ * Search kernel.
+ *
+ * The last (pattern length - 1) bytes of the data seen so far are kept in
+ * the tail, to find occurrences crossing the boundary with the next piece.
+ * The first bytes are kept in the head, for the same purpose when partial
+ * results are merged.
+ */
+
+/** Counts occurrences starting at offsets below "start_nr". */
+static uint64_t scan_search_count(const char *buf, uint64_t nob,
+				  const struct m0_buf *pat, uint64_t start_nr)
+{
+	const char *p   = buf;
+	const char *last;
+	uint64_t    cnt = 0;
+
+	if (nob < pat->b_nob)
+		return 0;
+	last = buf + min64u(start_nr, nob - pat->b_nob + 1);
+	while (p < last &&
+	       (p = memchr(p, *(char *)pat->b_addr, last - p)) != NULL) {
+		cnt += memcmp(p, pat->b_addr, pat->b_nob) == 0;
+		++p;
+	}
+	return cnt;
+}
+
+/** Counts occurrences starting in the tail and ending in "buf". */
+static uint64_t scan_search_cross(const char *tail, uint32_t tail_nob,
+				  const char *buf, uint64_t nob,
+				  const struct m0_buf *pat)
+{
+	char     window[2 * M0_ISC_SCAN_PATTERN_MAX];
+	uint64_t n = min64u(nob, pat->b_nob - 1);
+
+	memcpy(window, tail, tail_nob);
+	memcpy(window + tail_nob, buf, n);
+	return scan_search_count(window, tail_nob + n, pat, tail_nob);
+}
+
+static void scan_head_add(char *head, uint32_t *head_nob, uint32_t keep,
+			  const char *buf, uint64_t nob)
+{
+	uint64_t n;
+
+	if (*head_nob < keep) {
+		n = min64u(keep - *head_nob, nob);
+		memcpy(head + *head_nob, buf, n);
+		*head_nob += n;
+	}
+}
+
+static void scan_tail_add(char *tail, uint32_t *tail_nob, uint32_t keep,
+			  const char *buf, uint64_t nob)
+{
+	uint32_t drop;
+
+	if (nob >= keep) {
+		memcpy(tail, buf + nob - keep, keep);
+		*tail_nob = keep;
+	} else {
+		drop = *tail_nob + nob > keep ? *tail_nob + nob - keep : 0;
+		memmove(tail, tail + drop, *tail_nob - drop);
+		memcpy(tail + *tail_nob - drop, buf, nob);
+		*tail_nob += nob - drop;
+	}
+}
+
+static void scan_search(struct m0_isc_scan_ctx *ctx,
+			const char *buf, m0_bcount_t nob)
+{
+	const struct m0_buf *pat  = &ctx->sc_args->sa_pattern;
+	uint32_t             keep = pat->b_nob - 1;
+
+	ctx->sc_count += scan_search_cross(ctx->sc_tail, ctx->sc_tail_nob,
+					   buf, nob, pat) +
+			 scan_search_count(buf, nob, pat, nob);
+	scan_head_add(ctx->sc_head, &ctx->sc_head_nob, keep, buf, nob);
+	scan_tail_add(ctx->sc_tail, &ctx->sc_tail_nob, keep, buf, nob);
+}
+
+M0_INTERNAL void m0_isc_scan_ctx_feed(struct m0_isc_scan_ctx *ctx,
+				      const void *buf, m0_bcount_t nob)
+{
+	switch (ctx->sc_args->sa_kernel) {
+	case M0_ISC_SCAN_COUNT:
+	case M0_ISC_SCAN_MIN_MAX_SUM:
+		scan_column(ctx, buf, nob);
+		break;
+	case M0_ISC_SCAN_SEARCH:
+		scan_search(ctx, buf, nob);
+		break;
+	case M0_ISC_SCAN_CHECKSUM:
+		scan_checksum(ctx, buf, nob);
+		break;
+	default:
+		M0_IMPOSSIBLE("kernel=%u", ctx->sc_args->sa_kernel);
+	}
+	ctx->sc_nob += nob;
+}
+
+static int scan_edges_set(struct m0_isc_scan_result *res,
+			  const char *head, uint32_t head_nob,
+			  const char *tail, uint32_t tail_nob)
+{
+	m0_isc_scan_result_fini(res);
+	return m0_buf_copy(&res->sr_head,
+			   &M0_BUF_INIT(head_nob, (void *)head)) ?:
+	       m0_buf_copy(&res->sr_tail,
+			   &M0_BUF_INIT(tail_nob, (void *)tail));
+}
+
+M0_INTERNAL int m0_isc_scan_ctx_fini(struct m0_isc_scan_ctx *ctx,
+				     struct m0_isc_scan_result *res)
+{
+	M0_SET0(res);
+	res->sr_kernel = ctx->sc_args->sa_kernel;
+	res->sr_type   = ctx->sc_args->sa_type;
+	res->sr_nob    = ctx->sc_nob;
+	res->sr_rec_nr = ctx->sc_rec_nr;
+	res->sr_count  = ctx->sc_count;
+	if (res->sr_kernel == M0_ISC_SCAN_MIN_MAX_SUM && res->sr_count > 0) {
+		res->sr_min = ctx->sc_min.sv_u;
+		res->sr_max = ctx->sc_max.sv_u;
+		res->sr_sum = ctx->sc_sum.sv_u;
+	}
+	res->sr_csum_a = ctx->sc_csum_a;
+	res->sr_csum_b = ctx->sc_csum_b;
+	if (res->sr_kernel == M0_ISC_SCAN_SEARCH)
+		return scan_edges_set(res, ctx->sc_head, ctx->sc_head_nob,
+				      ctx->sc_tail, ctx->sc_tail_nob);
+	return 0;
+}
+
+M0_INTERNAL void m0_isc_scan_result_fini(struct m0_isc_scan_result *res)
+{
+	m0_buf_free(&res->sr_head);
+	m0_buf_free(&res->sr_tail);
+}
+
+static void scan_val_fold(uint32_t type, union m0_isc_scan_val *min,
+			  union m0_isc_scan_val *max,
+			  union m0_isc_scan_val *sum,
+			  const union m0_isc_scan_val *min2,
+			  const union m0_isc_scan_val *max2,
+			  const union m0_isc_scan_val *sum2)
+{
+	switch (type) {
+	case M0_ISC_SCAN_U32:
+	case M0_ISC_SCAN_U64:
+		min->sv_u  = min64u(min->sv_u, min2->sv_u);
+		max->sv_u  = max64u(max->sv_u, max2->sv_u);
+		sum->sv_u += sum2->sv_u;
+		break;
+	case M0_ISC_SCAN_I32:
+	case M0_ISC_SCAN_I64:
+		min->sv_i  = min64(min->sv_i, min2->sv_i);
+		max->sv_i  = max64(max->sv_i, max2->sv_i);
+		sum->sv_i += sum2->sv_i;
+		break;
+	case M0_ISC_SCAN_F64:
+		min->sv_f  = min2->sv_f < min->sv_f ? min2->sv_f : min->sv_f;
+		max->sv_f  = max2->sv_f > max->sv_f ? max2->sv_f : max->sv_f;
+		sum->sv_f += sum2->sv_f;
+		break;
+	default:
+		M0_IMPOSSIBLE("type=%u", type);
+	}
+}
+
+static int scan_search_merge(struct m0_isc_scan_result *acc,
+			     const struct m0_isc_scan_result *part,
+			     const struct m0_buf *pat)
+{
+	char     head[M0_ISC_SCAN_PATTERN_MAX];
+	char     tail[M0_ISC_SCAN_PATTERN_MAX];
+	uint32_t head_nob = acc->sr_head.b_nob;
+	uint32_t tail_nob = acc->sr_tail.b_nob;
+	uint32_t keep     = pat->b_nob - 1;
+
+	if (head_nob > keep || tail_nob > keep ||
+	    part->sr_head.b_nob > keep || part->sr_tail.b_nob > keep)
+		return M0_ERR(-EPROTO);
+	memcpy(head, acc->sr_head.b_addr, head_nob);
+	memcpy(tail, acc->sr_tail.b_addr, tail_nob);
+	acc->sr_count += scan_search_cross(tail, tail_nob,
+					   part->sr_head.b_addr,
+					   part->sr_head.b_nob, pat);
+	scan_head_add(head, &head_nob, keep,
+		      part->sr_head.b_addr, part->sr_head.b_nob);
+	scan_tail_add(tail, &tail_nob, keep,
+		      part->sr_tail.b_addr, part->sr_tail.b_nob);
+	return scan_edges_set(acc, head, head_nob, tail, tail_nob);
+}
+
+M0_INTERNAL int m0_isc_scan_result_merge(struct m0_isc_scan_result *acc,
+					 const struct m0_isc_scan_result *part,
+					 const struct m0_isc_scan_args *args)
+{
+	union m0_isc_scan_val min  = { .sv_u = acc->sr_min };
+	union m0_isc_scan_val max  = { .sv_u = acc->sr_max };
+	union m0_isc_scan_val sum  = { .sv_u = acc->sr_sum };
+	union m0_isc_scan_val min2 = { .sv_u = part->sr_min };
+	union m0_isc_scan_val max2 = { .sv_u = part->sr_max };
+	union m0_isc_scan_val sum2 = { .sv_u = part->sr_sum };
+	int                   rc   = 0;
+
+	if (part->sr_kernel != args->sa_kernel ||
+	    part->sr_type != args->sa_type)
+		return M0_ERR_INFO(-EPROTO, "kernel=%u type=%u",
+				   part->sr_kernel, part->sr_type);
+	acc->sr_kernel = args->sa_kernel;
+	acc->sr_type   = args->sa_type;
+	switch (args->sa_kernel) {
+	case M0_ISC_SCAN_MIN_MAX_SUM:
+		if (part->sr_count == 0)
+			break;
+		if (acc->sr_count == 0) {
+			min = min2;
+			max = max2;
+			sum = sum2;
+		} else
+			scan_val_fold(args->sa_type, &min, &max, &sum,
+				      &min2, &max2, &sum2);
+		acc->sr_min = min.sv_u;
+		acc->sr_max = max.sv_u;
+		acc->sr_sum = sum.sv_u;
+		break;
+	case M0_ISC_SCAN_SEARCH:
+		rc = scan_search_merge(acc, part, &args->sa_pattern);
+		break;
+	case M0_ISC_SCAN_CHECKSUM:
+		scan_csum_fold(&acc->sr_csum_a, &acc->sr_csum_b,
+			       part->sr_csum_a, part->sr_csum_b, part->sr_nob);
+		break;
+	}
+	acc->sr_nob    += part->sr_nob;
+	acc->sr_rec_nr += part->sr_rec_nr;
+	acc->sr_count  += part->sr_count;
+	return M0_RC(rc);
+}
+
+M0_INTERNAL int m0_isc_scan_args_encode(const struct m0_isc_scan_args *args,
+					struct m0_buf *buf)
+{
+	M0_SET0(buf);
+	return m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(m0_isc_scan_args_xc,
+						     (void *)args),
+				       &buf->b_addr, &buf->b_nob);
+}
+
+M0_INTERNAL int m0_isc_scan_args_decode(struct m0_isc_scan_args *args,
+					const struct m0_buf *buf)
+{
+	M0_SET0(args);
+	return m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(m0_isc_scan_args_xc,
+						       args),
+					 buf->b_addr, buf->b_nob);
+}
+
+M0_INTERNAL void m0_isc_scan_args_fini(struct m0_isc_scan_args *args)
+{
+	m0_buf_free(&args->sa_pattern);
+}
+
+M0_INTERNAL int m0_isc_scan_result_encode(const struct m0_isc_scan_result *res,
+					  struct m0_buf *buf)
+{
+	M0_SET0(buf);
+	return m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(m0_isc_scan_result_xc,
+						     (void *)res),
+				       &buf->b_addr, &buf->b_nob);
+}
+
+M0_INTERNAL int m0_isc_scan_result_decode(struct m0_isc_scan_result *res,
+					  const struct m0_buf *buf)
+{
+	M0_SET0(res);
+	return m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(m0_isc_scan_result_xc,
+						       res),
+					 buf->b_addr, buf->b_nob);
+}
+
+/*
+ * Server side of the scan.
+ *
+ * The range is read into two chunk buffers. A buffer is IDLE, READING while
+ * its stob io is in flight, or READY when the io completed and the data wait
+ * to be fed to the kernel. Buffers are consumed in turn, starting with
+ * s_buf[s_cur]; an idle buffer is immediately reused for the next chunk of
+ * the range, so the kernel of one chunk runs while the next one is read.
+ *
+ * io completion is delivered through a fom call-back, which runs in the
+ * locality of the fom. The fom is woken only when it waits for the buffer
+ * that just completed.
+ */
+
+enum scan_buf_state {
+	SBS_IDLE,
+	SBS_READING,
+	SBS_READY,
+};
+
+struct scan_buf {
+	struct isc_scan        *sb_scan;
+	enum scan_buf_state     sb_state;
+	void                   *sb_data;
+	struct m0_stob_io       sb_io;
+	struct m0_fom_callback  sb_cb;
+	/** Packed address, user and stob extents of the io, in blocks. */
+	void                   *sb_addr;
+	m0_bcount_t             sb_ucount;
+	m0_bcount_t             sb_scount;
+	m0_bindex_t             sb_index;
+};
+
+struct isc_scan {
+	struct m0_isc_scan_args s_args;
+	struct m0_isc_scan_ctx  s_ctx;
+	struct m0_fom          *s_fom;
+	struct m0_stob         *s_stob;
+	uint32_t                s_bshift;
+	/** Offset of the next chunk to read and end of the range. */
+	m0_bindex_t             s_next;
+	m0_bindex_t             s_end;
+	struct scan_buf         s_buf[2];
+	/** Index of the buffer holding the next chunk to consume. */
+	int                     s_cur;
+	/** The fom waits for s_buf[s_cur]. */
+	bool                    s_wait;
+	int                     s_rc;
+};
+
+static void scan_buf_cb(struct m0_fom_callback *cb)
+{
+	struct scan_buf *sb   = container_of(cb, struct scan_buf, sb_cb);
+	struct isc_scan *scan = sb->sb_scan;
+
+	M0_PRE(m0_fom_group_is_locked(cb->fc_fom));
+	M0_PRE(sb->sb_state == SBS_READING);
+
+	sb->sb_state = SBS_READY;
+	if (scan->s_wait && sb == &scan->s_buf[scan->s_cur]) {
+		scan->s_wait = false;
+		m0_fom_ready(cb->fc_fom);
+	}
+}
+
+static void scan_fini(struct isc_scan *scan)
+{
+	struct scan_buf *sb;
+	int              i;
+
+	for (i = 0; i < ARRAY_SIZE(scan->s_buf); ++i) {
+		sb = &scan->s_buf[i];
+		M0_ASSERT(sb->sb_state == SBS_IDLE);
+		if (sb->sb_data == NULL)
+			continue;
+		m0_fom_callback_fini(&sb->sb_cb);
+		m0_stob_io_fini(&sb->sb_io);
+		m0_free_aligned(sb->sb_data, M0_ISC_SCAN_CHUNK,
+				scan->s_bshift);
+	}
+	if (scan->s_stob != NULL)
+		m0_storage_dev_stob_put(m0_cs_storage_devs_get(),
+					scan->s_stob);
+	m0_isc_scan_args_fini(&scan->s_args);
+	m0_free(scan);
+}
+
+static int scan_init(struct isc_scan **out, struct m0_buf *in,
+		     struct m0_fom *fom)
+{
+	struct isc_scan   *scan;
+	struct scan_buf   *sb;
+	struct m0_stob_id  sid;
+	m0_bcount_t        bsize;
+	int                i;
+	int                rc;
+
+	M0_ALLOC_PTR(scan);
+	if (scan == NULL)
+		return M0_ERR(-ENOMEM);
+	rc = m0_isc_scan_args_decode(&scan->s_args, in) ?:
+	     m0_isc_scan_args_check(&scan->s_args);
+	if (rc != 0)
+		goto err;
+	m0_fid_convert_cob2stob(&scan->s_args.sa_cob, &sid);
+	rc = m0_storage_dev_stob_find(m0_cs_storage_devs_get(), &sid,
+				      &scan->s_stob);
+	if (rc != 0) {
+		scan->s_stob = NULL;
+		goto err;
+	}
+	scan->s_bshift = max32u(m0_stob_block_shift(scan->s_stob),
+				M0_0VEC_SHIFT);
+	bsize = 1ULL << m0_stob_block_shift(scan->s_stob);
+	if (scan->s_args.sa_offset % bsize != 0 ||
+	    scan->s_args.sa_count % bsize != 0) {
+		rc = M0_ERR_INFO(-EINVAL, "offset=%"PRIu64" count=%"PRIu64,
+				 scan->s_args.sa_offset,
+				 scan->s_args.sa_count);
+		goto err;
+	}
+	for (i = 0; i < ARRAY_SIZE(scan->s_buf); ++i) {
+		sb = &scan->s_buf[i];
+		sb->sb_data = m0_alloc_aligned(M0_ISC_SCAN_CHUNK,
+					       scan->s_bshift);
+		if (sb->sb_data == NULL) {
+			rc = M0_ERR(-ENOMEM);
+			goto err;
+		}
+		sb->sb_scan = scan;
+		m0_stob_io_init(&sb->sb_io);
+		m0_fom_callback_init(&sb->sb_cb);
+		sb->sb_cb.fc_bottom = &scan_buf_cb;
+	}
+	m0_isc_scan_ctx_init(&scan->s_ctx, &scan->s_args);
+	scan->s_fom  = fom;
+	scan->s_next = scan->s_args.sa_offset;
+	scan->s_end  = scan->s_args.sa_offset + scan->s_args.sa_count;
+	*out = scan;
+	return 0;
+err:
+	scan_fini(scan);
+	return M0_RC(rc);
+}
+
+static int scan_read(struct isc_scan *scan, struct scan_buf *sb)
+{
+	struct m0_stob_io *io     = &sb->sb_io;
+	uint32_t           bshift = m0_stob_block_shift(scan->s_stob);
+	m0_bcount_t        count;
+	int                rc;
+
+	M0_PRE(sb->sb_state == SBS_IDLE);
+
+	count = min64u(scan->s_end - scan->s_next, M0_ISC_SCAN_CHUNK);
+	sb->sb_addr   = m0_stob_addr_pack(sb->sb_data, bshift);
+	sb->sb_ucount = count >> bshift;
+	sb->sb_scount = count >> bshift;
+	sb->sb_index  = scan->s_next >> bshift;
+	io->si_opcode = SIO_READ;
+	io->si_flags  = 0;
+	io->si_user = (struct m0_bufvec) {
+		.ov_vec = { .v_nr = 1, .v_count = &sb->sb_ucount },
+		.ov_buf = &sb->sb_addr
+	};
+	io->si_stob = (struct m0_indexvec) {
+		.iv_vec   = { .v_nr = 1, .v_count = &sb->sb_scount },
+		.iv_index = &sb->sb_index
+	};
+	sb->sb_state = SBS_READING;
+	m0_mutex_lock(&io->si_mutex);
+	m0_fom_callback_arm(scan->s_fom, &io->si_wait, &sb->sb_cb);
+	m0_mutex_unlock(&io->si_mutex);
+	rc = m0_stob_io_prepare_and_launch(io, scan->s_stob, NULL, NULL);
+	if (rc != 0) {
+		m0_mutex_lock(&io->si_mutex);
+		m0_fom_callback_cancel(&sb->sb_cb);
+		m0_mutex_unlock(&io->si_mutex);
+		sb->sb_state = SBS_IDLE;
+		return M0_ERR(rc);
+	}
+	scan->s_next += count;
+	return 0;
+}
+
+static void scan_consume(struct isc_scan *scan, struct scan_buf *sb)
+{
+	struct m0_stob_io *io = &sb->sb_io;
+
+	M0_PRE(sb->sb_state == SBS_READY);
+
+	if (scan->s_rc == 0)
+		scan->s_rc = io->si_rc;
+	if (scan->s_rc == 0)
+		m0_isc_scan_ctx_feed(&scan->s_ctx, sb->sb_data,
+				     io->si_count << m0_stob_block_shift(
+					     scan->s_stob));
+	sb->sb_state = SBS_IDLE;
+}
+
+static int scan_done(struct isc_scan *scan, struct m0_buf *out)
+{
+	struct m0_isc_scan_result res;
+	int                       rc;
+
+	rc = scan->s_rc ?: m0_isc_scan_ctx_fini(&scan->s_ctx, &res);
+	if (rc == 0) {
+		rc = m0_isc_scan_result_encode(&res, out);
+		m0_isc_scan_result_fini(&res);
+	}
+	return M0_RC(rc);
+}
+
+M0_INTERNAL int m0_isc_scan_comp(struct m0_buf *args, struct m0_buf *out,
+				 struct m0_isc_comp_private *comp_data,
+				 int *rc)
+{
+	struct isc_scan *scan = comp_data->icp_data;
+	struct scan_buf *sb;
+	int              i;
+
+	if (scan == NULL) {
+		*rc = scan_init(&scan, args, comp_data->icp_fom);
+		if (*rc != 0)
+			return M0_FSO_AGAIN;
+		comp_data->icp_data = scan;
+	}
+	for (i = 0; i < ARRAY_SIZE(scan->s_buf) && scan->s_rc == 0; ++i) {
+		sb = &scan->s_buf[(scan->s_cur + i) % ARRAY_SIZE(scan->s_buf)];
+		if (sb->sb_state == SBS_IDLE && scan->s_next < scan->s_end)
+			scan->s_rc = scan_read(scan, sb);
+	}
+	sb = &scan->s_buf[scan->s_cur];
+	*rc = -EAGAIN;
+	switch (sb->sb_state) {
+	case SBS_READING:
+		scan->s_wait = true;
+		return M0_FSO_WAIT;
+	case SBS_READY:
+		/* Yield after every chunk. */
+		scan_consume(scan, sb);
+		scan->s_cur = 1 - scan->s_cur;
+		return M0_FSO_AGAIN;
+	case SBS_IDLE:
+		/* Launches stopped on an error, wait for the other buffer. */
+		if (scan->s_buf[1 - scan->s_cur].sb_state != SBS_IDLE) {
+			scan->s_cur = 1 - scan->s_cur;
+			return M0_FSO_AGAIN;
+		}
+		break;
+	}
+	*rc = scan_done(scan, out);
+	scan_fini(scan);
+	comp_data->icp_data = NULL;
+	return M0_FSO_AGAIN;
+}
+
+/** @} end of isc-scan group */
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
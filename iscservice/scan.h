@@ -0,0 +1,277 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_ISCSERVICE_SCAN_H__
+#define __MOTR_ISCSERVICE_SCAN_H__
+
+#include "lib/types.h"
+#include "lib/buf.h"
+#include "lib/buf_xc.h"
+#include "fid/fid.h"
+#include "fid/fid_xc.h"
+#include "xcode/xcode_attr.h"
+
+struct m0_isc_comp_private;
+
+/**
+ * @defgroup isc-scan Streaming scan computations
+ *
+ * Built-in ISC computation which streams a range of a cob through a simple
+ * data-parallel kernel and returns a partial aggregate instead of the data.
+ *
+ * The computation is registered by the ISC service under m0_isc_scan_fid.
+ * Its argument is an encoded m0_isc_scan_args and its result an encoded
+ * m0_isc_scan_result. On the server the range is read from the cob stob in
+ * chunks of M0_ISC_SCAN_CHUNK bytes, two chunks at a time: while the fom
+ * feeds one chunk to the kernel, the read of the next one is in flight.
+ * The fom yields after every chunk.
+ *
+ * Kernels:
+ *
+ * - M0_ISC_SCAN_COUNT counts records whose column satisfies the predicate
+ *   (sa_cmp, sa_operand);
+ *
+ * - M0_ISC_SCAN_MIN_MAX_SUM additionally computes minimum, maximum and sum of
+ *   the column over the matching records;
+ *
+ * - M0_ISC_SCAN_SEARCH counts (possibly overlapping) occurrences of a byte
+ *   pattern;
+ *
+ * - M0_ISC_SCAN_CHECKSUM computes a Fletcher-style checksum of the range.
+ *
+ * Records are sa_rec_size bytes long, which must be a power of two. The
+ * column is a value of sa_type at offset sa_col_off within the record. The
+ * kernels are plain branch-free loops over fixed-stride columns, left to the
+ * compiler to vectorise.
+ *
+ * A client splits an object range into the cob ranges backing each data
+ * unit, executes the computation for each and folds the partial results in
+ * the object offset order with m0_isc_scan_result_merge(). The result of
+ * merging is the same as of a single scan over the concatenated data.
+ * Partials carry the first and the last (pattern length - 1) bytes of their
+ * range, so that the search kernel also counts the occurrences crossing
+ * unit boundaries.
+ *
+ * The scan state (m0_isc_scan_ctx) does not depend on the ISC service and
+ * can be fed with any data, e.g. by a client scanning a local buffer.
+ *
+ * @{
+ */
+
+enum m0_isc_scan_kernel {
+	M0_ISC_SCAN_COUNT,
+	M0_ISC_SCAN_MIN_MAX_SUM,
+	M0_ISC_SCAN_SEARCH,
+	M0_ISC_SCAN_CHECKSUM,
+	M0_ISC_SCAN_KERNEL_NR
+};
+
+/** Type of a column. */
+enum m0_isc_scan_type {
+	M0_ISC_SCAN_U32,
+	M0_ISC_SCAN_I32,
+	M0_ISC_SCAN_U64,
+	M0_ISC_SCAN_I64,
+	M0_ISC_SCAN_F64,
+	M0_ISC_SCAN_TYPE_NR
+};
+
+/** Predicate applied to a column: "value <cmp> operand". */
+enum m0_isc_scan_cmp {
+	/** Every record matches. */
+	M0_ISC_SCAN_ALL,
+	M0_ISC_SCAN_LT,
+	M0_ISC_SCAN_LE,
+	M0_ISC_SCAN_EQ,
+	M0_ISC_SCAN_NE,
+	M0_ISC_SCAN_GE,
+	M0_ISC_SCAN_GT,
+	M0_ISC_SCAN_CMP_NR
+};
+
+enum {
+	/** Size of a stob read issued by the scan computation. */
+	M0_ISC_SCAN_CHUNK       = 1 << 20,
+	/** Maximal length of a search pattern. */
+	M0_ISC_SCAN_PATTERN_MAX = 256,
+};
+
+/** Identifier of the built-in scan computation. */
+extern const struct m0_fid m0_isc_scan_fid;
+
+/** Arguments of the scan computation. */
+struct m0_isc_scan_args {
+	/** Cob to scan. */
+	struct m0_fid sa_cob;
+	/** Offset of the range within the cob, multiple of the block size. */
+	uint64_t      sa_offset;
+	/** Size of the range, multiple of the block size. */
+	uint64_t      sa_count;
+	/** m0_isc_scan_kernel. */
+	uint32_t      sa_kernel;
+	/** m0_isc_scan_type, column kernels only. */
+	uint32_t      sa_type;
+	/** Record size, column kernels only. */
+	uint32_t      sa_rec_size;
+	/** Offset of the column within a record, column kernels only. */
+	uint32_t      sa_col_off;
+	/** m0_isc_scan_cmp, column kernels only. */
+	uint32_t      sa_cmp;
+	/** Bit pattern of the predicate operand, of sa_type. */
+	uint64_t      sa_operand;
+	/** Pattern to look for, M0_ISC_SCAN_SEARCH only. */
+	struct m0_buf sa_pattern;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
+/**
+ * Partial aggregate of a scan.
+ *
+ * Minimum, maximum and sum are bit patterns of uint64_t (unsigned types),
+ * int64_t (signed types) or double (M0_ISC_SCAN_F64). They are defined only
+ * when sr_count is not 0.
+ */
+struct m0_isc_scan_result {
+	uint32_t      sr_kernel;
+	uint32_t      sr_type;
+	/** Number of bytes scanned. */
+	uint64_t      sr_nob;
+	/** Number of records scanned, column kernels only. */
+	uint64_t      sr_rec_nr;
+	/** Number of matching records or pattern occurrences. */
+	uint64_t      sr_count;
+	uint64_t      sr_min;
+	uint64_t      sr_max;
+	uint64_t      sr_sum;
+	/** Checksum halves, M0_ISC_SCAN_CHECKSUM only. */
+	uint64_t      sr_csum_a;
+	uint64_t      sr_csum_b;
+	/** First bytes of the range, M0_ISC_SCAN_SEARCH only. */
+	struct m0_buf sr_head;
+	/** Last bytes of the range, M0_ISC_SCAN_SEARCH only. */
+	struct m0_buf sr_tail;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
+/** Values of a column type, as kept while scanning. */
+union m0_isc_scan_val {
+	uint64_t sv_u;
+	int64_t  sv_i;
+	double   sv_f;
+};
+
+/** State of a scan, fed with consecutive pieces of the range. */
+struct m0_isc_scan_ctx {
+	const struct m0_isc_scan_args *sc_args;
+	/** Distance between column values, in values of the column type. */
+	uint64_t                       sc_stride;
+	uint64_t                       sc_nob;
+	uint64_t                       sc_rec_nr;
+	uint64_t                       sc_count;
+	union m0_isc_scan_val          sc_min;
+	union m0_isc_scan_val          sc_max;
+	union m0_isc_scan_val          sc_sum;
+	uint64_t                       sc_csum_a;
+	uint64_t                       sc_csum_b;
+	/** First bytes fed, at most pattern length - 1 of them. */
+	uint32_t                       sc_head_nob;
+	char                           sc_head[M0_ISC_SCAN_PATTERN_MAX];
+	/** Last bytes fed, at most pattern length - 1 of them. */
+	uint32_t                       sc_tail_nob;
+	char                           sc_tail[M0_ISC_SCAN_PATTERN_MAX];
+};
+
+/**
+ * Checks the arguments, except for the alignment of the range to the block
+ * size, which is only known on the server.
+ */
+M0_INTERNAL int m0_isc_scan_args_check(const struct m0_isc_scan_args *args);
+
+/**
+ * Initialises the scan state. The arguments must be valid and stay
+ * unchanged until m0_isc_scan_ctx_fini().
+ */
+M0_INTERNAL void m0_isc_scan_ctx_init(struct m0_isc_scan_ctx *ctx,
+				      const struct m0_isc_scan_args *args);
+
+/**
+ * Feeds the next piece of the range to the kernel. For column kernels nob
+ * must be a multiple of the record size.
+ */
+M0_INTERNAL void m0_isc_scan_ctx_feed(struct m0_isc_scan_ctx *ctx,
+				      const void *buf, m0_bcount_t nob);
+
+/**
+ * Stores the aggregate in the result, which is finalised with
+ * m0_isc_scan_result_fini().
+ */
+M0_INTERNAL int m0_isc_scan_ctx_fini(struct m0_isc_scan_ctx *ctx,
+				     struct m0_isc_scan_result *res);
+
+M0_INTERNAL void m0_isc_scan_result_fini(struct m0_isc_scan_result *res);
+
+/**
+ * Folds the partial result of the range immediately following the range of
+ * acc into acc. An acc zeroed with M0_SET0() is an empty aggregate.
+ *
+ * @param args arguments the partials were computed with.
+ */
+M0_INTERNAL int m0_isc_scan_result_merge(struct m0_isc_scan_result *acc,
+					 const struct m0_isc_scan_result *part,
+					 const struct m0_isc_scan_args *args);
+
+/** Encodes the arguments to a buffer allocated by this function. */
+M0_INTERNAL int m0_isc_scan_args_encode(const struct m0_isc_scan_args *args,
+					struct m0_buf *buf);
+/** Decodes the arguments, finalised with m0_isc_scan_args_fini(). */
+M0_INTERNAL int m0_isc_scan_args_decode(struct m0_isc_scan_args *args,
+					const struct m0_buf *buf);
+M0_INTERNAL void m0_isc_scan_args_fini(struct m0_isc_scan_args *args);
+
+M0_INTERNAL int m0_isc_scan_result_encode(const struct m0_isc_scan_result *res,
+					  struct m0_buf *buf);
+M0_INTERNAL int m0_isc_scan_result_decode(struct m0_isc_scan_result *res,
+					  const struct m0_buf *buf);
+
+/**
+ * The scan computation, registered by the ISC service. Follows the
+ * signature of ISC computations, see iscservice/isc.h.
+ */
+M0_INTERNAL int m0_isc_scan_comp(struct m0_buf *args, struct m0_buf *out,
+				 struct m0_isc_comp_private *comp_data,
+				 int *rc);
+
+/** @} end of isc-scan group */
+#endif /* __MOTR_ISCSERVICE_SCAN_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -0,0 +1,359 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_UT
+#include "lib/trace.h"
+#include "lib/errno.h"
+#include "lib/misc.h"
+#include "lib/memory.h"
+#include "ut/ut.h"
+#include "iscservice/scan.h"
+
+enum {
+	REC_SIZE = 16,
+	REC_NR   = 1000,
+	DATA_NOB = REC_SIZE * REC_NR,
+};
+
+struct rec {
+	uint32_t r_u32;
+	int32_t  r_i32;
+	double   r_f64;
+};
+
+static const char pattern[] = "abcab";
+
+static void data_fill(char *data)
+{
+	struct rec *r = (struct rec *)data;
+	int         i;
+
+	for (i = 0; i < REC_NR; ++i) {
+		r[i].r_u32 = (i * 7919) % 1000;
+		r[i].r_i32 = 500 - r[i].r_u32;
+		r[i].r_f64 = r[i].r_i32 / 4.0;
+	}
+}
+
+/* Feeds the data in pieces of "step" bytes and returns the result. */
+static void scan(const struct m0_isc_scan_args *args, const char *data,
+		 uint64_t nob, uint64_t step, struct m0_isc_scan_result *res)
+{
+	struct m0_isc_scan_ctx ctx;
+	uint64_t               off;
+	int                    rc;
+
+	m0_isc_scan_ctx_init(&ctx, args);
+	for (off = 0; off < nob; off += step)
+		m0_isc_scan_ctx_feed(&ctx, data + off, min64u(step, nob - off));
+	rc = m0_isc_scan_ctx_fini(&ctx, res);
+	M0_UT_ASSERT(rc == 0);
+}
+
+/* Scans the data as partials of "part" bytes and merges them. */
+static void scan_merged(const struct m0_isc_scan_args *args, const char *data,
+			uint64_t nob, uint64_t part,
+			struct m0_isc_scan_result *acc)
+{
+	struct m0_isc_scan_result res;
+	uint64_t                  off;
+	int                       rc;
+
+	M0_SET0(acc);
+	for (off = 0; off < nob; off += part) {
+		scan(args, data + off, min64u(part, nob - off), 64, &res);
+		rc = m0_isc_scan_result_merge(acc, &res, args);
+		M0_UT_ASSERT(rc == 0);
+		m0_isc_scan_result_fini(&res);
+	}
+}
+
+static void test_column(void)
+{
+	struct m0_isc_scan_args   args = {
+		.sa_kernel   = M0_ISC_SCAN_MIN_MAX_SUM,
+		.sa_rec_size = REC_SIZE,
+		.sa_count    = DATA_NOB,
+	};
+	struct m0_isc_scan_result res;
+	struct m0_isc_scan_result acc;
+	const struct rec         *r;
+	union m0_isc_scan_val     val;
+	char                     *data;
+	uint64_t                  cnt = 0;
+	int64_t                   sum = 0;
+	int64_t                   min = INT64_MAX;
+	int64_t                   max = INT64_MIN;
+	int                       i;
+
+	data = m0_alloc(DATA_NOB);
+	M0_UT_ASSERT(data != NULL);
+	data_fill(data);
+	r = (const struct rec *)data;
+	for (i = 0; i < REC_NR; ++i) {
+		if (r[i].r_i32 < 100) {
+			++cnt;
+			sum += r[i].r_i32;
+			min = min64(min, r[i].r_i32);
+			max = max64(max, r[i].r_i32);
+		}
+	}
+
+	/* Filter-count over an unsigned column. */
+	args.sa_kernel  = M0_ISC_SCAN_COUNT;
+	args.sa_type    = M0_ISC_SCAN_U32;
+	args.sa_col_off = offsetof(struct rec, r_u32);
+	args.sa_cmp     = M0_ISC_SCAN_GT;
+	args.sa_operand = 400;
+	M0_UT_ASSERT(m0_isc_scan_args_check(&args) == 0);
+	scan(&args, data, DATA_NOB, REC_SIZE * 3, &res);
+	M0_UT_ASSERT(res.sr_rec_nr == REC_NR);
+	M0_UT_ASSERT(res.sr_count == cnt);
+	m0_isc_scan_result_fini(&res);
+
+	/* Min, max and sum over a signed column. */
+	args.sa_kernel  = M0_ISC_SCAN_MIN_MAX_SUM;
+	args.sa_type    = M0_ISC_SCAN_I32;
+	args.sa_col_off = offsetof(struct rec, r_i32);
+	args.sa_cmp     = M0_ISC_SCAN_LT;
+	val.sv_i        = 100;
+	args.sa_operand = val.sv_u;
+	scan(&args, data, DATA_NOB, DATA_NOB, &res);
+	M0_UT_ASSERT(res.sr_count == cnt);
+	M0_UT_ASSERT((int64_t)res.sr_min == min);
+	M0_UT_ASSERT((int64_t)res.sr_max == max);
+	M0_UT_ASSERT((int64_t)res.sr_sum == sum);
+	scan_merged(&args, data, DATA_NOB, REC_SIZE * 77, &acc);
+	M0_UT_ASSERT(acc.sr_rec_nr == REC_NR);
+	M0_UT_ASSERT(acc.sr_count == cnt);
+	M0_UT_ASSERT(acc.sr_min == res.sr_min);
+	M0_UT_ASSERT(acc.sr_max == res.sr_max);
+	M0_UT_ASSERT(acc.sr_sum == res.sr_sum);
+	m0_isc_scan_result_fini(&acc);
+	m0_isc_scan_result_fini(&res);
+
+	/* Doubles, no predicate. */
+	args.sa_type    = M0_ISC_SCAN_F64;
+	args.sa_col_off = offsetof(struct rec, r_f64);
+	args.sa_cmp     = M0_ISC_SCAN_ALL;
+	scan(&args, data, DATA_NOB, REC_SIZE * 10, &res);
+	M0_UT_ASSERT(res.sr_count == REC_NR);
+	val.sv_u = res.sr_min;
+	M0_UT_ASSERT(val.sv_f == -499 / 4.0);
+	val.sv_u = res.sr_max;
+	M0_UT_ASSERT(val.sv_f == 500 / 4.0);
+	m0_isc_scan_result_fini(&res);
+
+	/* No record matches: merging skips the partial. */
+	args.sa_type    = M0_ISC_SCAN_I32;
+	args.sa_col_off = offsetof(struct rec, r_i32);
+	args.sa_cmp     = M0_ISC_SCAN_GT;
+	args.sa_operand = 1000;
+	scan_merged(&args, data, DATA_NOB, REC_SIZE * 100, &acc);
+	M0_UT_ASSERT(acc.sr_rec_nr == REC_NR);
+	M0_UT_ASSERT(acc.sr_count == 0);
+	m0_isc_scan_result_fini(&acc);
+	m0_free(data);
+}
+
+static uint64_t search_naive(const char *data, uint64_t nob)
+{
+	uint64_t plen = strlen(pattern);
+	uint64_t cnt  = 0;
+	uint64_t i;
+
+	for (i = 0; i + plen <= nob; ++i)
+		cnt += memcmp(data + i, pattern, plen) == 0;
+	return cnt;
+}
+
+static void test_search(void)
+{
+	struct m0_isc_scan_args   args = {
+		.sa_kernel  = M0_ISC_SCAN_SEARCH,
+		.sa_count   = DATA_NOB,
+		.sa_pattern = M0_BUF_INIT(strlen(pattern), (void *)pattern),
+	};
+	static const uint64_t     steps[] = { 1, 2, 3, 4, 5, 64, 4097 };
+	struct m0_isc_scan_result res;
+	char                     *data;
+	uint64_t                  cnt;
+	int                       i;
+
+	data = m0_alloc(DATA_NOB);
+	M0_UT_ASSERT(data != NULL);
+	for (i = 0; i < DATA_NOB; ++i)
+		data[i] = "abc"[(i * 31 + i / 7) % 3];
+	/* Occurrences at both sides of various boundaries. */
+	for (i = 0; i + 5 <= DATA_NOB; i += 997)
+		memcpy(data + i, pattern, 5);
+	cnt = search_naive(data, DATA_NOB);
+	M0_UT_ASSERT(cnt > DATA_NOB / 997);
+	M0_UT_ASSERT(m0_isc_scan_args_check(&args) == 0);
+	for (i = 0; i < ARRAY_SIZE(steps); ++i) {
+		scan(&args, data, DATA_NOB, steps[i], &res);
+		M0_UT_ASSERT(res.sr_nob == DATA_NOB);
+		M0_UT_ASSERT(res.sr_count == cnt);
+		m0_isc_scan_result_fini(&res);
+		/* Partials shorter than the pattern are merged, too. */
+		scan_merged(&args, data, DATA_NOB, steps[i], &res);
+		M0_UT_ASSERT(res.sr_nob == DATA_NOB);
+		M0_UT_ASSERT(res.sr_count == cnt);
+		M0_UT_ASSERT(memcmp(res.sr_head.b_addr, data, 4) == 0);
+		M0_UT_ASSERT(memcmp(res.sr_tail.b_addr,
+				    data + DATA_NOB - 4, 4) == 0);
+		m0_isc_scan_result_fini(&res);
+	}
+	m0_free(data);
+}
+
+static void test_checksum(void)
+{
+	struct m0_isc_scan_args   args = {
+		.sa_kernel = M0_ISC_SCAN_CHECKSUM,
+		.sa_count  = DATA_NOB,
+	};
+	struct m0_isc_scan_result res;
+	struct m0_isc_scan_result acc;
+	unsigned char            *data;
+	uint64_t                  a = 0;
+	uint64_t                  b = 0;
+	int                       i;
+
+	data = m0_alloc(DATA_NOB);
+	M0_UT_ASSERT(data != NULL);
+	for (i = 0; i < DATA_NOB; ++i) {
+		data[i] = i * 131 + 17;
+		a += data[i];
+		b += a;
+	}
+	scan(&args, (char *)data, DATA_NOB, 1000, &res);
+	M0_UT_ASSERT(res.sr_csum_a == a);
+	M0_UT_ASSERT(res.sr_csum_b == b);
+	scan_merged(&args, (char *)data, DATA_NOB, 333, &acc);
+	M0_UT_ASSERT(acc.sr_nob == DATA_NOB);
+	M0_UT_ASSERT(acc.sr_csum_a == a);
+	M0_UT_ASSERT(acc.sr_csum_b == b);
+	m0_isc_scan_result_fini(&acc);
+	m0_isc_scan_result_fini(&res);
+	m0_free(data);
+}
+
+static void test_encdec(void)
+{
+	struct m0_isc_scan_args   args = {
+		.sa_cob      = M0_FID_INIT(0x12, 0x34),
+		.sa_offset   = 4096,
+		.sa_count    = 8192,
+		.sa_kernel   = M0_ISC_SCAN_SEARCH,
+		.sa_pattern  = M0_BUF_INIT(strlen(pattern), (void *)pattern),
+	};
+	struct m0_isc_scan_args   args2;
+	struct m0_isc_scan_result res = {
+		.sr_kernel = M0_ISC_SCAN_SEARCH,
+		.sr_nob    = 8192,
+		.sr_count  = 3,
+		.sr_head   = M0_BUF_INIT(2, (void *)pattern),
+		.sr_tail   = M0_BUF_INIT(4, (void *)pattern),
+	};
+	struct m0_isc_scan_result res2;
+	struct m0_buf             buf;
+	int                       rc;
+
+	rc = m0_isc_scan_args_encode(&args, &buf);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_isc_scan_args_decode(&args2, &buf);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_fid_eq(&args2.sa_cob, &args.sa_cob));
+	M0_UT_ASSERT(args2.sa_offset == args.sa_offset);
+	M0_UT_ASSERT(args2.sa_count == args.sa_count);
+	M0_UT_ASSERT(m0_buf_eq(&args2.sa_pattern, &args.sa_pattern));
+	m0_isc_scan_args_fini(&args2);
+	m0_buf_free(&buf);
+
+	rc = m0_isc_scan_result_encode(&res, &buf);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_isc_scan_result_decode(&res2, &buf);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(res2.sr_nob == res.sr_nob);
+	M0_UT_ASSERT(res2.sr_count == res.sr_count);
+	M0_UT_ASSERT(m0_buf_eq(&res2.sr_head, &res.sr_head));
+	M0_UT_ASSERT(m0_buf_eq(&res2.sr_tail, &res.sr_tail));
+	m0_isc_scan_result_fini(&res2);
+	m0_buf_free(&buf);
+}
+
+static void test_args_check(void)
+{
+	struct m0_isc_scan_args args = {
+		.sa_kernel   = M0_ISC_SCAN_COUNT,
+		.sa_type     = M0_ISC_SCAN_U64,
+		.sa_rec_size = 24,
+		.sa_count    = 48,
+	};
+
+	/* Records must be a power of two in size. */
+	M0_UT_ASSERT(m0_isc_scan_args_check(&args) == -EINVAL);
+	args.sa_rec_size = 32;
+	args.sa_count    = 64;
+	M0_UT_ASSERT(m0_isc_scan_args_check(&args) == 0);
+	args.sa_col_off = 4;
+	M0_UT_ASSERT(m0_isc_scan_args_check(&args) == -EINVAL);
+	args.sa_col_off = 32;
+	M0_UT_ASSERT(m0_isc_scan_args_check(&args) == -EINVAL);
+	args.sa_col_off = 24;
+	args.sa_count   = 48;
+	M0_UT_ASSERT(m0_isc_scan_args_check(&args) == -EINVAL);
+	args.sa_kernel = M0_ISC_SCAN_SEARCH;
+	M0_UT_ASSERT(m0_isc_scan_args_check(&args) == -EINVAL);
+	args.sa_kernel = M0_ISC_SCAN_KERNEL_NR;
+	M0_UT_ASSERT(m0_isc_scan_args_check(&args) == -EINVAL);
+}
+
+struct m0_ut_suite isc_scan_ut = {
+	.ts_name  = "isc-scan-ut",
+	.ts_init  = NULL,
+	.ts_fini  = NULL,
+	.ts_tests = {
+		{ "column",     test_column     },
+		{ "search",     test_search     },
+		{ "checksum",   test_checksum   },
+		{ "encdec",     test_encdec     },
+		{ "args-check", test_args_check },
+		{ NULL, NULL }
+	}
+};
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
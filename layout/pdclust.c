@@ -50,6 +50,10 @@
  * of columns. permute() function applies a permutation, simultaneously building
  * an inverse permutation.
  *
+ * Permutations of the M0_PDCLUST_TILE_CACHE_NR recently used tiles are kept
+ * in m0_pdclust_instance::pi_tile_cache[] (see tile_get()), replaced in the
+ * LRU order.
+ *
  * Finally, layout mapping function is defined in terms of conversions between
  * matrices of different shapes. Let's call a matrix having M columns and an
  * arbitrary (probably infinite) number of rows an M-matrix. An element of an
@@ -79,6 +83,9 @@
  * Inverse layout mapping function m0_pdclust_instance_inv() performs reverse
  * conversions.
  *
+ * m0_pdclust_instance_map_nr() maps whole parity groups, walking the tile in
+ * the P-matrix order instead of re-doing the conversions for every unit.
+ *
  * @{
  */
 
@@ -155,7 +162,7 @@ static bool pdclust_instance_invariant(const struct m0_pdclust_instance *pi)
 	pl = bob_of(pi->pi_base.li_l, struct m0_pdclust_layout,
 		    pl_base.sl_base, &pdclust_bob);
 	P  = pl->pl_attr.pa_P;
-	tc = &pi->pi_tile_cache;
+	tc = pi->pi_tile_cache;
 
 	return
 		m0_pdclust_instance_bob_check(pi) &&
@@ -165,11 +172,13 @@ static bool pdclust_instance_invariant(const struct m0_pdclust_instance *pi)
 		 * tc->tc_permute[] and tc->tc_inverse[] are mutually inverse
 		 * bijections of {0, ..., P - 1}.
 		 */
-		m0_forall(i, P,
-			  tc->tc_lcode[i] + i < P &&
-			  (tc->tc_permute[i] < P && tc->tc_inverse[i] < P) &&
-			  tc->tc_permute[tc->tc_inverse[i]] == i &&
-			  tc->tc_inverse[tc->tc_permute[i]] == i);
+		m0_forall(k, M0_PDCLUST_TILE_CACHE_NR,
+			  m0_forall(i, P,
+				    tc[k].tc_lcode[i] + i < P &&
+				    tc[k].tc_permute[i] < P &&
+				    tc[k].tc_inverse[i] < P &&
+				    tc[k].tc_permute[tc[k].tc_inverse[i]] == i &&
+				    tc[k].tc_inverse[tc[k].tc_permute[i]] == i));
 }
 
 /**
@@ -637,6 +646,62 @@ static void permute(uint32_t n, uint32_t *k, uint32_t *s, uint32_t *r)
 	r[s[n - 1]] = n - 1;
 }
 
+/** Computes column permutation for tile omega in the cache entry. */
+static void tile_fill(struct m0_pdclust_instance *pi, struct tile_cache *tc,
+		      uint64_t omega)
+{
+	struct m0_pdclust_attr  attr = pi_to_pl(pi)->pl_attr;
+	struct m0_fid          *gfid = &pi->pi_base.li_gfid;
+	uint32_t                i;
+	uint64_t                rstate;
+
+	/* Initialise columns array that will be permuted. */
+	for (i = 0; i < attr.pa_P; ++i)
+		tc->tc_permute[i] = i;
+
+	/* Initialise PRNG. */
+	rstate = m0_hash(attr.pa_seed.u_hi + gfid->f_key) ^
+		 m0_hash(attr.pa_seed.u_lo + omega + gfid->f_container);
+
+	/* Generate permutation number in lexicographic ordering. */
+	for (i = 0; i < attr.pa_P - 1; ++i)
+		tc->tc_lcode[i] = m0_rnd(attr.pa_P - i, &rstate);
+
+	/* Apply the permutation. */
+	permute(attr.pa_P, tc->tc_lcode, tc->tc_permute, tc->tc_inverse);
+	tc->tc_tile_no = omega;
+}
+
+/**
+ * Returns the cache entry for tile omega, computing permutations in place of
+ * the least recently used entry if the tile is not cached.
+ *
+ * The entry stays valid only while m0_pdclust_instance::pi_mutex is held.
+ */
+static struct tile_cache *tile_get(struct m0_pdclust_instance *pi,
+				   uint64_t omega)
+{
+	struct tile_cache *tc;
+	struct tile_cache *lru = NULL;
+	int                i;
+
+	M0_PRE(m0_mutex_is_locked(&pi->pi_mutex));
+
+	for (i = 0; i < ARRAY_SIZE(pi->pi_tile_cache); ++i) {
+		tc = &pi->pi_tile_cache[i];
+		if (tc->tc_tile_no == omega)
+			break;
+		if (lru == NULL || tc->tc_stamp < lru->tc_stamp)
+			lru = tc;
+	}
+	if (i == ARRAY_SIZE(pi->pi_tile_cache)) {
+		tc = lru;
+		tile_fill(pi, tc, omega);
+	}
+	tc->tc_stamp = ++pi->pi_tile_clock;
+	return tc;
+}
+
 /**
  * Returns column number that a column t has after a permutation for tile omega
  * is applied.
@@ -644,41 +709,14 @@ static void permute(uint32_t n, uint32_t *k, uint32_t *s, uint32_t *r)
 static uint64_t permute_column(struct m0_pdclust_instance *pi,
 			       uint64_t omega, uint64_t t)
 {
-	struct tile_cache        *tc;
-	struct m0_pdclust_attr    attr;
-	struct m0_pdclust_layout *pl;
-	struct m0_fid            *gfid;
-
-	pl   = pi_to_pl(pi);
-	attr =  pl->pl_attr;
-	gfid = &pi->pi_base.li_gfid;
+	struct tile_cache      *tc;
+	struct m0_pdclust_attr  attr = pi_to_pl(pi)->pl_attr;
+	uint64_t                result;
 
 	M0_ENTRY("t %lu, P %lu", (unsigned long)t, (unsigned long)attr.pa_P);
 	M0_ASSERT(t < attr.pa_P);
-	tc = &pi->pi_tile_cache;
-
-	/* If cached values are for different tile, update the cache. */
-	if (tc->tc_tile_no != omega) {
-		uint32_t i;
-		uint64_t rstate;
-
-		/* Initialise columns array that will be permuted. */
-		for (i = 0; i < attr.pa_P; ++i)
-			tc->tc_permute[i] = i;
-
-		/* Initialise PRNG. */
-		rstate = m0_hash(attr.pa_seed.u_hi + gfid->f_key) ^
-			 m0_hash(attr.pa_seed.u_lo + omega + gfid->f_container);
-
-		/* Generate permutation number in lexicographic ordering. */
-		for (i = 0; i < attr.pa_P - 1; ++i)
-			tc->tc_lcode[i] = m0_rnd(attr.pa_P - i, &rstate);
-
-		/* Apply the permutation. */
-		permute(attr.pa_P, tc->tc_lcode,
-			tc->tc_permute, tc->tc_inverse);
-		tc->tc_tile_no = omega;
-	}
+	m0_mutex_lock(&pi->pi_mutex);
+	tc = tile_get(pi, omega);
 
 	/**
 	 * @todo Not sure if this should be replaced by an ADDB DP or a M0_LOG.
@@ -687,7 +725,9 @@ static uint64_t permute_column(struct m0_pdclust_instance *pi,
 	M0_POST(tc->tc_permute[t] < attr.pa_P);
 	M0_POST(tc->tc_inverse[tc->tc_permute[t]] == t);
 	M0_POST(tc->tc_permute[tc->tc_inverse[t]] == t);
-	return tc->tc_permute[t];
+	result = tc->tc_permute[t];
+	m0_mutex_unlock(&pi->pi_mutex);
+	return result;
 }
 
 M0_INTERNAL void m0_pdclust_instance_map(struct m0_pdclust_instance *pi,
@@ -733,6 +773,53 @@ M0_INTERNAL void m0_pdclust_instance_map(struct m0_pdclust_instance *pi,
 	M0_LEAVE("pi %p", pi);
 }
 
+M0_INTERNAL void m0_pdclust_instance_map_nr(struct m0_pdclust_instance *pi,
+					    uint64_t group, uint64_t nr,
+					    struct m0_pdclust_tgt_addr *tgt)
+{
+	struct m0_pdclust_layout *pl;
+	const struct tile_cache  *tc = NULL;
+	uint32_t                  W;
+	uint32_t                  P;
+	uint32_t                  C;
+	uint32_t                  L;
+	uint32_t                  u;
+	uint64_t                  g;
+	uint64_t                  omega;
+	uint64_t                  j;
+	uint64_t                  r;
+	uint64_t                  t;
+
+	M0_PRE(pdclust_instance_invariant(pi));
+
+	pl = pi_to_pl(pi);
+	W = pl->pl_attr.pa_N + 2 * pl->pl_attr.pa_K;
+	P = pl->pl_attr.pa_P;
+	C = pl->pl_C;
+	L = pl->pl_L;
+
+	m0_mutex_lock(&pi->pi_mutex);
+	for (g = 0; g < nr; ++g) {
+		m_dec(C, group + g, &omega, &j);
+		if (tc == NULL || tc->tc_tile_no != omega)
+			tc = tile_get(pi, omega);
+		/*
+		 * Units of a group are consecutive in the C*(N+2*K) form of
+		 * the tile, hence consecutive in its L*P form as well.
+		 */
+		m_dec(P, m_enc(W, j, 0), &r, &t);
+		for (u = 0; u < W; ++u, ++tgt) {
+			tgt->ta_obj   = tc->tc_permute[t];
+			tgt->ta_frame = m_enc(L, omega, r);
+			if (++t == P) {
+				t = 0;
+				++r;
+			}
+		}
+	}
+	m0_mutex_unlock(&pi->pi_mutex);
+}
+
 M0_INTERNAL void m0_pdclust_instance_inv(struct m0_pdclust_instance *pi,
 					 const struct m0_pdclust_tgt_addr *tgt,
 					 struct m0_pdclust_src_addr *src)
@@ -765,8 +852,9 @@ M0_INTERNAL void m0_pdclust_instance_inv(struct m0_pdclust_instance *pi,
 	 * reverse order.
 	 */
 	m_dec(L, tgt->ta_frame, &omega, &r);
-	permute_column(pi, omega, t); /* Force tile cache update */
-	t = pi->pi_tile_cache.tc_inverse[t];
+	m0_mutex_lock(&pi->pi_mutex);
+	t = tile_get(pi, omega)->tc_inverse[t];
+	m0_mutex_unlock(&pi->pi_mutex);
 	m_dec(N + 2*K, m_enc(P, r, t), &j, &src->sa_unit);
 	src->sa_group = m_enc(C, omega, j);
 }
@@ -783,7 +871,8 @@ M0_INTERNAL void m0_pdclust_perm_cache_destroy(struct m0_layout *layout,
 
 	pool_ver = layout->l_pver;
 	M0_ASSERT(pool_ver != NULL);
-	cache_cnt = layout->l_pver->pv_fd_tree.ft_cache_info.fci_nr;
+	cache_cnt = layout->l_pver->pv_fd_tree.ft_cache_info.fci_nr *
+		    M0_PDCLUST_TILE_CACHE_NR;
 	for (i = 0; i < cache_cnt; ++i)
 		m0_fd_perm_cache_fini(&pi->pi_perm_cache[i]);
 	m0_free(pi->pi_perm_cache);
@@ -799,12 +888,13 @@ M0_INTERNAL int m0_pdclust_perm_cache_build(struct m0_layout *layout,
 
 	M0_PRE(layout != NULL && layout->l_pver != NULL);
 	cache_info = &layout->l_pver->pv_fd_tree.ft_cache_info;
-	M0_ALLOC_ARR(pi->pi_perm_cache, cache_info->fci_nr);
+	M0_ALLOC_ARR(pi->pi_perm_cache,
+		     cache_info->fci_nr * M0_PDCLUST_TILE_CACHE_NR);
 	if (pi->pi_perm_cache == NULL)
 		return M0_ERR(-ENOMEM);
-	for (i = 0; i < cache_info->fci_nr; ++i) {
+	for (i = 0; i < cache_info->fci_nr * M0_PDCLUST_TILE_CACHE_NR; ++i) {
 		rc = m0_fd_perm_cache_init(&pi->pi_perm_cache[i],
-				           cache_info->fci_info[i]);
+			cache_info->fci_info[i / M0_PDCLUST_TILE_CACHE_NR]);
 		if (rc != 0)
 			break;
 	}
@@ -819,6 +909,17 @@ M0_INTERNAL bool m0_pdclust_is_replicated(struct m0_pdclust_layout *play)
 	return play->pl_attr.pa_N == 1;
 }
 
+static void tile_cache_free(struct m0_pdclust_instance *pi)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pi->pi_tile_cache); ++i) {
+		m0_free(pi->pi_tile_cache[i].tc_inverse);
+		m0_free(pi->pi_tile_cache[i].tc_permute);
+		m0_free(pi->pi_tile_cache[i].tc_lcode);
+	}
+}
+
 /**
  * Implementation of lo_instance_build().
  *
@@ -836,6 +937,7 @@ static int pdclust_instance_build(struct m0_layout           *l,
 	struct m0_pdclust_layout   *pl = m0_layout_to_pdl(l);
 	struct m0_pdclust_instance *pi;
 	struct tile_cache          *tc = NULL; /* to keep gcc happy */
+	uint32_t                    i;
 	uint32_t                    N;
 	uint32_t                    K;
 	uint32_t                    P;
@@ -859,18 +961,22 @@ err1_injected:
 		if (rc != 0)
 		return M0_RC(rc);
 
-		tc = &pi->pi_tile_cache;
+		tc = pi->pi_tile_cache;
 
 		if (M0_FI_ENABLED("mem_err2"))
-			{ tc->tc_lcode = NULL; goto err2_injected; }
-		M0_ALLOC_ARR(tc->tc_lcode, P);
-		M0_ALLOC_ARR(tc->tc_permute, P);
-		M0_ALLOC_ARR(tc->tc_inverse, P);
+			goto err2_injected;
+		for (i = 0; i < M0_PDCLUST_TILE_CACHE_NR; ++i) {
+			M0_ALLOC_ARR(tc[i].tc_lcode, P);
+			M0_ALLOC_ARR(tc[i].tc_permute, P);
+			M0_ALLOC_ARR(tc[i].tc_inverse, P);
+		}
 err2_injected:
-		if (tc->tc_lcode != NULL &&
-		    tc->tc_permute != NULL &&
-		    tc->tc_inverse != NULL) {
-			tc->tc_tile_no = 1;
+		if (m0_forall(k, M0_PDCLUST_TILE_CACHE_NR,
+			      tc[k].tc_lcode != NULL &&
+			      tc[k].tc_permute != NULL &&
+			      tc[k].tc_inverse != NULL)) {
+			for (i = 0; i < M0_PDCLUST_TILE_CACHE_NR; ++i)
+				tc[i].tc_tile_no = ~(uint64_t)0;
 
 			if (M0_FI_ENABLED("parity_math_err"))
 				{ rc = -EPROTO; goto err3_injected; }
@@ -882,7 +988,11 @@ err3_injected:
 							&pdclust_instance_ops);
 				m0_pdclust_instance_bob_init(pi);
 				m0_mutex_init(&pi->pi_mutex);
-				permute_column(pi, 0, 0);
+				/* Fill the cache with the first tiles. */
+				m0_mutex_lock(&pi->pi_mutex);
+				for (i = 0; i < M0_PDCLUST_TILE_CACHE_NR; ++i)
+					tile_get(pi, i);
+				m0_mutex_unlock(&pi->pi_mutex);
 			}
 			else
 				M0_LOG(M0_ERROR, "pi %p, m0_parity_math_init()"
@@ -901,11 +1011,8 @@ err3_injected:
 			m0_layout__log("pdclust_instance_build",
 				       "M0_ALLOC() failed",
 				       l->l_id, rc);
-		if (pi != NULL) {
-			m0_free(tc->tc_inverse);
-			m0_free(tc->tc_permute);
-			m0_free(tc->tc_lcode);
-		}
+		if (pi != NULL)
+			tile_cache_free(pi);
 		m0_free(pi);
 	}
 
@@ -930,9 +1037,7 @@ M0_INTERNAL void pdclust_instance_fini(struct m0_layout_instance *li)
 	m0_layout__instance_fini(&pi->pi_base);
 	m0_mutex_fini(&pi->pi_mutex);
 	m0_pdclust_instance_bob_fini(pi);
-	m0_free(pi->pi_tile_cache.tc_inverse);
-	m0_free(pi->pi_tile_cache.tc_permute);
-	m0_free(pi->pi_tile_cache.tc_lcode);
+	tile_cache_free(pi);
 	m0_free(pi);
 	M0_LEAVE();
 }
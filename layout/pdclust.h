@@ -83,6 +83,16 @@ struct m0_pdclust_instance;
 struct m0_pdclust_src_addr;
 struct m0_pdclust_tgt_addr;
 
+enum {
+	/**
+	 * Number of tiles, for which permutations are cached by a pdclust
+	 * instance, both for pdclust (m0_pdclust_instance::pi_tile_cache[])
+	 * and failure domain (m0_pdclust_instance::pi_perm_cache[])
+	 * permutations.
+	 */
+	M0_PDCLUST_TILE_CACHE_NR = 4
+};
+
 /** Classification of units in a parity group. */
 enum m0_pdclust_unit_type {
         M0_PUT_DATA,
@@ -170,18 +180,23 @@ struct m0_pdclust_instance {
 	/* Super class, storing pointer to the layout being used. */
 	struct m0_layout_instance    pi_base;
 	/**
-	 * Caches information about the most recently used tile.
+	 * Caches information about the recently used tiles.
 	 *
 	 * Some auxiliary data, such as permutations, used by layout mapping
 	 * function is relatively expensive to re-compute. To reduce the
 	 * overhead, such information is cached.
 	 *
-	 * Currently only information for a single tile is cached. More
-	 * sophisticated schemes are possible.
+	 * Information for M0_PDCLUST_TILE_CACHE_NR tiles is cached. When a
+	 * tile is not in the cache, the least recently used entry is reused.
+	 * This keeps mapping of an I/O spanning a few tiles, or interleaving
+	 * forward and reverse mapping of different tiles, from recomputing
+	 * permutations on every call.
 	 */
 	struct tile_cache {
 		/** Tile to which caches information pertains. */
 		uint64_t  tc_tile_no;
+		/** Value of pi_tile_clock when the entry was last used. */
+		uint64_t  tc_stamp;
 
 		/**
 		 * Column permutation for this tile.
@@ -213,9 +228,21 @@ struct m0_pdclust_instance {
 		 * @see http://en.wikipedia.org/wiki/Lehmer_code
 		 */
 		uint32_t *tc_lcode;
-	} pi_tile_cache;
+	} pi_tile_cache[M0_PDCLUST_TILE_CACHE_NR];
+	/** Logical clock for the LRU replacement of the caches. */
+	uint64_t                     pi_tile_clock;
 
+	/**
+	 * Number of distinct permutation lengths in the failure domains
+	 * tree, m0_fd_cache_info::fci_nr.
+	 */
 	uint64_t                     pi_cache_nr;
+	/**
+	 * Failure domain permutation caches. There are
+	 * M0_PDCLUST_TILE_CACHE_NR caches (for different tiles) of each
+	 * length: caches of the i-th length of m0_fd_cache_info::fci_info[]
+	 * are pi_perm_cache[i * M0_PDCLUST_TILE_CACHE_NR + k].
+	 */
 	struct m0_fd_perm_cache     *pi_perm_cache;
 	/** Parity math information, initialised according to the layout. */
 	struct m0_parity_math        pi_math;
@@ -223,7 +250,9 @@ struct m0_pdclust_instance {
 	uint64_t                     pi_magic;
 
 	/**
-	 *  Lock to serialize access to cache.
+	 *  Lock to serialize access to cache. Taken by the mapping functions
+	 *  (m0_pdclust_instance_map(), m0_fd_fwd_map() and friends) around
+	 *  the lookup, refill and use of pi_tile_cache[] and pi_perm_cache[].
 	 */
 	struct m0_mutex              pi_mutex;
 };
@@ -316,6 +345,20 @@ M0_INTERNAL void m0_pdclust_instance_inv(struct m0_pdclust_instance *pi,
 					 const struct m0_pdclust_tgt_addr *tgt,
 					 struct m0_pdclust_src_addr *src);
 
+/**
+ * Batch layout mapping function.
+ *
+ * Maps all units of nr parity groups starting from the group "group". Target
+ * address of unit u of group (group + g) is stored to tgt[g * W + u], where
+ * W == N + 2 * K. The result is the same as of m0_pdclust_instance_map() for
+ * each unit, but permutations are looked up once per tile.
+ *
+ * @pre tgt has room for nr * (N + 2 * K) elements.
+ */
+M0_INTERNAL void m0_pdclust_instance_map_nr(struct m0_pdclust_instance *pi,
+					    uint64_t group, uint64_t nr,
+					    struct m0_pdclust_tgt_addr *tgt);
+
 M0_INTERNAL int m0_pdclust_perm_cache_build(struct m0_layout *layout,
 					    struct m0_pdclust_instance *pi);
 
@@ -2433,6 +2433,45 @@ static void test_recsize(void)
 	M0_UT_ASSERT(rc == 0);
 }
 
+/**
+ * Compares m0_pdclust_instance_map_nr() with unit-at-a-time mapping over the
+ * groups of several tiles. The groups are checked in an order which switches
+ * between the first and the last tile, so that the tile cache is exercised.
+ */
+static void ldemo_nr(struct m0_pdclust_instance *pi,
+		     const struct m0_pdclust_layout *pl)
+{
+	struct m0_pdclust_src_addr  src;
+	struct m0_pdclust_tgt_addr  tgt;
+	struct m0_pdclust_src_addr  src1;
+	struct m0_pdclust_tgt_addr *out;
+	uint64_t                    W;
+	uint64_t                    nr;
+	uint64_t                    first;
+	uint64_t                    i;
+	uint64_t                    idx;
+
+	W = pl->pl_attr.pa_N + 2 * pl->pl_attr.pa_K;
+	nr = (M0_PDCLUST_TILE_CACHE_NR + 2) * pl->pl_C;
+	/* Start in the middle of a tile. */
+	first = 5 * pl->pl_C + pl->pl_C / 2;
+	M0_ALLOC_ARR(out, nr * W);
+	M0_UT_ASSERT(out != NULL);
+	m0_pdclust_instance_map_nr(pi, first, nr, out);
+	for (i = 0; i < nr * W; ++i) {
+		idx = i / W;
+		src.sa_group = first + (i % 2 == 0 ? idx : nr - 1 - idx);
+		src.sa_unit  = i % W;
+		m0_pdclust_instance_map(pi, &src, &tgt);
+		idx = (src.sa_group - first) * W + src.sa_unit;
+		M0_UT_ASSERT(tgt.ta_obj == out[idx].ta_obj);
+		M0_UT_ASSERT(tgt.ta_frame == out[idx].ta_frame);
+		m0_pdclust_instance_inv(pi, &out[idx], &src1);
+		M0_UT_ASSERT(memcmp(&src, &src1, sizeof src) == 0);
+	}
+	m0_free(out);
+}
+
 static void ldemo(struct m0_pdclust_instance *pi,
 		  const struct m0_pdclust_layout *pl)
 {
@@ -2451,6 +2490,7 @@ static void ldemo(struct m0_pdclust_instance *pi,
 		m0_pdclust_instance_inv(pi, &tgt, &src1);
 		M0_ASSERT(memcmp(&src, &src1, sizeof src) == 0);
 	}
+	ldemo_nr(pi, pl);
 }
 
 /* Tests the APIs supported for m0_pdclust_instance object. */
@@ -3745,6 +3785,116 @@ struct m0_ut_suite layout_ut = {
 };
 M0_EXPORTED(layout_ut);
 
+enum {
+	UB_ITER     = 100,
+	UB_GROUP_NR = 1024,
+	UB_P        = 30
+};
+
+static struct m0_pdclust_layout   *ub_pl;
+static struct m0_pdclust_instance *ub_pi;
+static struct m0_pool_version      ub_pver;
+static uint64_t                    ub_cache_len[] = { 1, 2, 3, 4 };
+static struct m0_pdclust_tgt_addr *ub_tgt;
+static uint64_t                    ub_W;
+
+static int ub_init(const char *opts M0_UNUSED)
+{
+	struct m0_layout_linear_enum *lin_enum;
+	struct m0_layout_instance    *li;
+	struct m0_uint128             seed;
+	struct m0_fid                 gfid;
+	uint32_t                      N;
+	uint32_t                      K;
+	uint32_t                      P;
+
+	test_init();
+	m0_uint128_init(&seed, "ubpdclustlayout!");
+	NKP_assign_and_pool_init(LINEAR_ENUM_ID, INLINE_NOT_APPLICABLE,
+				 0, 0, UB_P, &N, &K, &P);
+	rc = pdclust_layout_build(LINEAR_ENUM_ID, 13001, N, K, P, &seed,
+				  10, 20, &ub_pl, &lin_enum, !FAILURE_TEST);
+	M0_UB_ASSERT(rc == 0);
+	ub_pver.pv_fd_tree.ft_cache_info.fci_nr = ARRAY_SIZE(ub_cache_len);
+	ub_pver.pv_fd_tree.ft_cache_info.fci_info = ub_cache_len;
+	m0_pdl_to_layout(ub_pl)->l_pver = &ub_pver;
+	m0_fid_set(&gfid, 0, 999);
+	rc = m0_layout_instance_build(m0_pdl_to_layout(ub_pl), &gfid, &li);
+	M0_UB_ASSERT(rc == 0);
+	ub_pi = m0_layout_instance_to_pdi(li);
+	ub_W = N + 2 * K;
+	M0_ALLOC_ARR(ub_tgt, UB_GROUP_NR * ub_W);
+	M0_UB_ASSERT(ub_tgt != NULL);
+	return 0;
+}
+
+static void ub_fini(void)
+{
+	m0_free(ub_tgt);
+	m0_layout_instance_fini(&ub_pi->pi_base);
+	m0_layout_put(m0_pdl_to_layout(ub_pl));
+	m0_pool_fini(&pool);
+	test_fini();
+}
+
+/* Maps UB_GROUP_NR consecutive groups, a unit at a time. */
+static void ub_map(int iter)
+{
+	struct m0_pdclust_src_addr src;
+	uint64_t                   i;
+
+	for (i = 0; i < UB_GROUP_NR * ub_W; ++i) {
+		src.sa_group = iter * UB_GROUP_NR + i / ub_W;
+		src.sa_unit  = i % ub_W;
+		m0_pdclust_instance_map(ub_pi, &src, &ub_tgt[i]);
+	}
+}
+
+/* Maps the same groups with a single m0_pdclust_instance_map_nr() call. */
+static void ub_map_nr(int iter)
+{
+	m0_pdclust_instance_map_nr(ub_pi, iter * UB_GROUP_NR, UB_GROUP_NR,
+				   ub_tgt);
+}
+
+/*
+ * Maps the groups of two distant tiles in turn, which defeated the single
+ * tile cache.
+ */
+static void ub_map_alternate(int iter)
+{
+	struct m0_pdclust_src_addr src;
+	uint64_t                   i;
+
+	for (i = 0; i < UB_GROUP_NR * ub_W; ++i) {
+		src.sa_group = iter * UB_GROUP_NR + i / ub_W +
+			(i % 2) * UB_ITER * UB_GROUP_NR;
+		src.sa_unit  = i % ub_W;
+		m0_pdclust_instance_map(ub_pi, &src, &ub_tgt[i]);
+	}
+}
+
+struct m0_ub_set m0_layout_ub = {
+	.us_name = "layout-ub",
+	.us_init = ub_init,
+	.us_fini = ub_fini,
+	.us_run  = {
+		{ .ub_name  = "map",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_map },
+
+		{ .ub_name  = "map-nr",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_map_nr },
+
+		{ .ub_name  = "map-alternate",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_map_alternate },
+
+		{ .ub_name = NULL }
+	}
+};
+
 #undef M0_TRACE_SUBSYSTEM
 
 /*
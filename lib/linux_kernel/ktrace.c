@@ -24,6 +24,7 @@
 #include <linux/kernel.h>            /* vprintk, kstrtoul */
 #include <linux/jiffies.h>           /* time_in_range_open */
 #include <linux/version.h>
+#include <linux/smp.h>               /* raw_smp_processor_id */
 
 #include "lib/errno.h"
 #include "lib/atomic.h"
@@ -240,6 +241,11 @@ M0_INTERNAL void m0_arch_trace_buf_header_init(struct m0_trace_buf_header *tbh)
 	tbh->tbh_module_struct    = m;
 }
 
+M0_INTERNAL uint32_t m0_arch_trace_cpu_get(void)
+{
+	return raw_smp_processor_id();
+}
+
 /** @} end of trace group */
 
 /*
@@ -82,6 +82,11 @@ M0_INTERNAL bool m0_is_poisoned(const void *ptr)
 }
 #endif
 
+M0_INTERNAL void m0_memory_poison(void *data, size_t size)
+{
+	poison_before_free(data, size);
+}
+
 M0_INTERNAL void  *m0_arch_alloc       (size_t size);
 M0_INTERNAL void   m0_arch_free        (void *data);
 M0_INTERNAL void   m0_arch_allocated_zero(void *data, size_t size);
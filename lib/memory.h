@@ -163,6 +163,15 @@ M0_INTERNAL int m0_pagesize_get(void);
  */
 M0_INTERNAL bool m0_is_poisoned(const void *p);
 
+/**
+ * Fills the memory region with the same pattern m0_free() uses, when
+ * ENABLE_FREE_POISON is defined. Does nothing otherwise.
+ *
+ * This is for allocators keeping freed objects around (see lib/slab.h), so
+ * that use-after-free is caught by m0_is_poisoned() as for m0_free().
+ */
+M0_INTERNAL void m0_memory_poison(void *data, size_t size);
+
 /**
  * Mark this memory region to be excluded from core dump.
  * see madvise(2).
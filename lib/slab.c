@@ -0,0 +1,256 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_LIB
+#include "lib/trace.h"
+#include "lib/assert.h"
+#include "lib/misc.h"          /* M0_SET0, ARRAY_SIZE */
+#include "lib/memory.h"
+#ifdef __KERNEL__
+#include <linux/smp.h>         /* raw_smp_processor_id */
+#else
+#include "lib/processor.h"     /* m0_processor_id_get */
+#endif
+#include "lib/slab.h"
+#include "addb2/addb2.h"
+#include "addb2/identifier.h"
+
+/**
+ * @addtogroup slab
+ *
+ * @{
+ */
+
+/**
+ * Returns the magazine of the current processor.
+ *
+ * The processor only spreads callers over magazines; a magazine is used
+ * under its sm_lock, so a caller migrated to another processor is still
+ * correct. In the kernel callers are preemptible, hence the raw id rather
+ * than smp_processor_id() behind m0_processor_id_get().
+ */
+static struct m0_slab_mag *slab_mag(struct m0_slab *slab)
+{
+#ifdef __KERNEL__
+	return &slab->sl_mag[raw_smp_processor_id() % M0_SLAB_MAG_NR];
+#else
+	return &slab->sl_mag[m0_processor_id_get() % M0_SLAB_MAG_NR];
+#endif
+}
+
+static void *slab_sys_alloc(struct m0_slab *slab)
+{
+	void *obj;
+
+	obj = m0_alloc(slab->sl_size);
+	if (obj != NULL) {
+		if (slab->sl_ctor != NULL)
+			slab->sl_ctor(obj);
+		m0_atomic64_inc(&slab->sl_sys_alloc_nr);
+	}
+	return obj;
+}
+
+static void slab_sys_free(struct m0_slab *slab, void *obj)
+{
+	if (slab->sl_dtor != NULL)
+		slab->sl_dtor(obj);
+	m0_free(obj);
+	m0_atomic64_inc(&slab->sl_sys_free_nr);
+}
+
+static void slab_mag_post(struct m0_slab *slab, const struct m0_slab_mag *mag)
+{
+	M0_ADDB2_ADD(M0_AVI_SLAB, (uint64_t)slab, mag->sm_alloc_nr,
+		     mag->sm_hit_nr, m0_atomic64_get(&slab->sl_sys_alloc_nr),
+		     m0_atomic64_get(&slab->sl_sys_free_nr));
+}
+
+/** Moves up to M0_SLAB_BATCH objects from the depot to an empty magazine. */
+static void slab_refill(struct m0_slab *slab, struct m0_slab_mag *mag)
+{
+	uint32_t nr;
+
+	M0_PRE(m0_mutex_is_locked(&mag->sm_lock));
+	M0_PRE(mag->sm_nr == 0);
+
+	m0_mutex_lock(&slab->sl_lock);
+	nr = min_check(slab->sl_depot_nr, (uint32_t)M0_SLAB_BATCH);
+	slab->sl_depot_nr -= nr;
+	memcpy(mag->sm_obj, &slab->sl_depot[slab->sl_depot_nr],
+	       nr * sizeof mag->sm_obj[0]);
+	m0_mutex_unlock(&slab->sl_lock);
+	mag->sm_nr = nr;
+	slab_mag_post(slab, mag);
+}
+
+/**
+ * Moves M0_SLAB_BATCH objects from a full magazine to the depot. Objects
+ * which do not fit into the depot are returned to the system.
+ */
+static void slab_drain(struct m0_slab *slab, struct m0_slab_mag *mag)
+{
+	uint32_t nr;
+
+	M0_PRE(m0_mutex_is_locked(&mag->sm_lock));
+	M0_PRE(mag->sm_nr == ARRAY_SIZE(mag->sm_obj));
+
+	m0_mutex_lock(&slab->sl_lock);
+	nr = min_check(M0_SLAB_DEPOT_MAX - slab->sl_depot_nr,
+		       (uint32_t)M0_SLAB_BATCH);
+	mag->sm_nr -= nr;
+	memcpy(&slab->sl_depot[slab->sl_depot_nr], &mag->sm_obj[mag->sm_nr],
+	       nr * sizeof mag->sm_obj[0]);
+	slab->sl_depot_nr += nr;
+	m0_mutex_unlock(&slab->sl_lock);
+	for (; nr < M0_SLAB_BATCH; ++nr)
+		slab_sys_free(slab, mag->sm_obj[--mag->sm_nr]);
+	slab_mag_post(slab, mag);
+}
+
+M0_INTERNAL void m0_slab_init(struct m0_slab *slab, const char *name,
+			      size_t size, void (*ctor)(void *obj),
+			      void (*dtor)(void *obj))
+{
+	int i;
+
+	M0_PRE(size > 0);
+	M0_PRE(ergo(dtor != NULL, ctor != NULL));
+
+	M0_SET0(slab);
+	slab->sl_name = name;
+	slab->sl_size = size;
+	slab->sl_ctor = ctor;
+	slab->sl_dtor = dtor;
+	m0_mutex_init(&slab->sl_lock);
+	m0_atomic64_set(&slab->sl_sys_alloc_nr, 0);
+	m0_atomic64_set(&slab->sl_sys_free_nr, 0);
+	for (i = 0; i < ARRAY_SIZE(slab->sl_mag); ++i)
+		m0_mutex_init(&slab->sl_mag[i].sm_lock);
+}
+
+M0_INTERNAL void m0_slab_fini(struct m0_slab *slab)
+{
+	int i;
+
+	m0_slab_shrink(slab);
+	M0_LOG(M0_DEBUG, "%s: %"PRIi64" objects taken from the system, "
+	       "%"PRIi64" returned", slab->sl_name,
+	       m0_atomic64_get(&slab->sl_sys_alloc_nr),
+	       m0_atomic64_get(&slab->sl_sys_free_nr));
+	for (i = 0; i < ARRAY_SIZE(slab->sl_mag); ++i)
+		m0_mutex_fini(&slab->sl_mag[i].sm_lock);
+	m0_mutex_fini(&slab->sl_lock);
+}
+
+M0_INTERNAL void *m0_slab_alloc(struct m0_slab *slab)
+{
+	struct m0_slab_mag *mag = slab_mag(slab);
+	void               *obj = NULL;
+
+	m0_mutex_lock(&mag->sm_lock);
+	mag->sm_alloc_nr++;
+	if (mag->sm_nr == 0)
+		slab_refill(slab, mag);
+	if (mag->sm_nr > 0) {
+		obj = mag->sm_obj[--mag->sm_nr];
+		mag->sm_hit_nr++;
+	}
+	m0_mutex_unlock(&mag->sm_lock);
+	if (obj == NULL)
+		obj = slab_sys_alloc(slab);
+	else if (slab->sl_ctor == NULL)
+		memset(obj, 0, slab->sl_size);
+	return obj;
+}
+
+M0_INTERNAL void m0_slab_free(struct m0_slab *slab, void *obj)
+{
+	struct m0_slab_mag *mag;
+
+	if (obj == NULL)
+		return;
+	if (slab->sl_ctor == NULL)
+		m0_memory_poison(obj, slab->sl_size);
+	mag = slab_mag(slab);
+	m0_mutex_lock(&mag->sm_lock);
+	if (mag->sm_nr == ARRAY_SIZE(mag->sm_obj))
+		slab_drain(slab, mag);
+	mag->sm_obj[mag->sm_nr++] = obj;
+	m0_mutex_unlock(&mag->sm_lock);
+}
+
+M0_INTERNAL void m0_slab_shrink(struct m0_slab *slab)
+{
+	struct m0_slab_mag *mag;
+	int                 i;
+
+	for (i = 0; i < ARRAY_SIZE(slab->sl_mag); ++i) {
+		mag = &slab->sl_mag[i];
+		m0_mutex_lock(&mag->sm_lock);
+		while (mag->sm_nr > 0)
+			slab_sys_free(slab, mag->sm_obj[--mag->sm_nr]);
+		m0_mutex_unlock(&mag->sm_lock);
+	}
+	m0_mutex_lock(&slab->sl_lock);
+	while (slab->sl_depot_nr > 0)
+		slab_sys_free(slab, slab->sl_depot[--slab->sl_depot_nr]);
+	m0_mutex_unlock(&slab->sl_lock);
+}
+
+M0_INTERNAL void m0_slab_stats_get(struct m0_slab *slab,
+				   struct m0_slab_stats *stats)
+{
+	struct m0_slab_mag *mag;
+	int                 i;
+
+	M0_SET0(stats);
+	for (i = 0; i < ARRAY_SIZE(slab->sl_mag); ++i) {
+		mag = &slab->sl_mag[i];
+		m0_mutex_lock(&mag->sm_lock);
+		stats->ss_alloc_nr  += mag->sm_alloc_nr;
+		stats->ss_hit_nr    += mag->sm_hit_nr;
+		stats->ss_cached_nr += mag->sm_nr;
+		m0_mutex_unlock(&mag->sm_lock);
+	}
+	m0_mutex_lock(&slab->sl_lock);
+	stats->ss_cached_nr += slab->sl_depot_nr;
+	m0_mutex_unlock(&slab->sl_lock);
+	stats->ss_sys_alloc_nr = m0_atomic64_get(&slab->sl_sys_alloc_nr);
+	stats->ss_sys_free_nr  = m0_atomic64_get(&slab->sl_sys_free_nr);
+}
+
+/** @} end of slab group */
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
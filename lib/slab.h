@@ -0,0 +1,159 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_LIB_SLAB_H__
+#define __MOTR_LIB_SLAB_H__
+
+#include "lib/types.h"
+#include "lib/atomic.h"
+#include "lib/mutex.h"
+
+/**
+ * @defgroup slab Object caches
+ *
+ * Cache of fixed-size objects of the same type, for objects allocated and
+ * freed at high rate on the request path: fops, foms, rpc packets.
+ *
+ * Freed objects are kept in per-processor magazines. A magazine is selected
+ * by processor id, the same way m0_locality_get() selects a locality, and
+ * has its own lock, so that allocation and free on different cores do not
+ * contend. When a magazine is empty it is refilled with M0_SLAB_BATCH
+ * objects from the shared depot; when it is full, M0_SLAB_BATCH objects are
+ * moved to the depot. Objects which do not fit into the depot go back to
+ * the system allocator. Objects are taken from the system with m0_alloc()
+ * and returned with m0_free(), so an object allocated by m0_alloc() of the
+ * same size can be freed to the cache and vice versa.
+ *
+ * If the cache has a constructor, it is called once when an object is taken
+ * from the system, and the destructor is called before the object goes
+ * back. Objects keep their constructed state while cached, which allows
+ * embedded mutexes, lists, etc. to be initialised once. Without a
+ * constructor, m0_slab_alloc() returns zeroed memory, like m0_alloc(), and
+ * m0_slab_free() poisons the object (see m0_memory_poison()), like
+ * m0_free().
+ *
+ * Statistics are kept per magazine and are published as M0_AVI_SLAB addb2
+ * records when a magazine is refilled or drained, that is, off the fast
+ * path. The cache cannot tell its own objects from foreign ones, so it
+ * counts objects taken from and returned to the system separately: an
+ * object from m0_alloc() freed to the cache is counted when it is returned,
+ * and a cached object freed with m0_free() never is.
+ *
+ * m0_slab is fully embedded: initialisation cannot fail.
+ *
+ * @{
+ */
+
+enum {
+	/** Number of per-processor magazines. */
+	M0_SLAB_MAG_NR    = 16,
+	/** Number of objects moved between a magazine and the depot at once. */
+	M0_SLAB_BATCH     = 16,
+	/** Maximal number of objects kept in the depot. */
+	M0_SLAB_DEPOT_MAX = 256
+};
+
+/** Per-processor magazine of cached objects. */
+struct m0_slab_mag {
+	struct m0_mutex sm_lock;
+	/** Number of objects in sm_obj[]. */
+	uint32_t        sm_nr;
+	void           *sm_obj[2 * M0_SLAB_BATCH];
+	/** Number of allocations through this magazine. */
+	uint64_t        sm_alloc_nr;
+	/** Number of allocations served from the cache. */
+	uint64_t        sm_hit_nr;
+};
+
+struct m0_slab {
+	const char         *sl_name;
+	/** Object size. */
+	size_t              sl_size;
+	/** Optional constructor, called when an object comes from the system. */
+	void              (*sl_ctor)(void *obj);
+	/** Optional destructor, called before an object goes to the system. */
+	void              (*sl_dtor)(void *obj);
+	/** Protects the depot. Taken after a magazine lock. */
+	struct m0_mutex     sl_lock;
+	uint32_t            sl_depot_nr;
+	void               *sl_depot[M0_SLAB_DEPOT_MAX];
+	/** Number of objects taken from the system by the cache. */
+	struct m0_atomic64  sl_sys_alloc_nr;
+	/** Number of objects returned to the system by the cache. */
+	struct m0_atomic64  sl_sys_free_nr;
+	struct m0_slab_mag  sl_mag[M0_SLAB_MAG_NR];
+};
+
+struct m0_slab_stats {
+	uint64_t ss_alloc_nr;
+	uint64_t ss_hit_nr;
+	/** Objects taken from the system by m0_slab_alloc(). */
+	uint64_t ss_sys_alloc_nr;
+	/** Objects returned to the system, including foreign ones. */
+	uint64_t ss_sys_free_nr;
+	/** Objects in the magazines and in the depot. */
+	uint64_t ss_cached_nr;
+};
+
+/**
+ * Initialises the cache of objects of the given size.
+ *
+ * @param ctor optional constructor, can be NULL.
+ * @param dtor optional destructor, can be NULL. Must be NULL if ctor is NULL.
+ */
+M0_INTERNAL void m0_slab_init(struct m0_slab *slab, const char *name,
+			      size_t size, void (*ctor)(void *obj),
+			      void (*dtor)(void *obj));
+
+/** Returns all cached objects to the system. */
+M0_INTERNAL void m0_slab_fini(struct m0_slab *slab);
+
+/** Allocates an object. Returns NULL if the system is out of memory. */
+M0_INTERNAL void *m0_slab_alloc(struct m0_slab *slab);
+
+/** Frees an object allocated from the cache. obj can be NULL. */
+M0_INTERNAL void m0_slab_free(struct m0_slab *slab, void *obj);
+
+/** Returns all cached objects to the system, keeping the cache usable. */
+M0_INTERNAL void m0_slab_shrink(struct m0_slab *slab);
+
+/** Sums statistics over the magazines. The result is approximate. */
+M0_INTERNAL void m0_slab_stats_get(struct m0_slab *slab,
+				   struct m0_slab_stats *stats);
+
+/** @} end of slab group */
+#endif /* __MOTR_LIB_SLAB_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
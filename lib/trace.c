@@ -50,6 +50,15 @@
  * file. Buffer space allocation is controlled by a single atomic variable
  * (m0_trace_buf_header::tbh_cur_pos).
  *
+ * A buffer can also be split into per-CPU sub-buffers
+ * (m0_trace_buf_cpu_split()), each being a ring of its own with a separate
+ * position and record counter (m0_trace_buf_header::tbh_cpu[]). A thread
+ * allots its records in the sub-buffer of the CPU it runs on, so that
+ * concurrent threads don't bounce a shared cache line. Records of different
+ * sub-buffers are ordered by their timestamps, m0_trace_parse() merges them.
+ * User-space buffers are split, kernel ones are not, as trace readers of the
+ * kernel buffer (m0traced, debugfs) follow a single ring.
+ *
  * Trace entries contain pointers from the process address space. To interpret
  * them, m0_trace_parse() must be called in the same binary. See utils/ut_main.c
  * for example.
@@ -211,7 +220,13 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	uint32_t  str_data_size;
 	void     *body_in_buf;
 	char     *dst_str;
+	uint32_t  cpu;
+	char     *buf;
+	uint64_t  bufsize;
+	uint64_t  mask;
 
+	struct m0_atomic64         *cur_pos;
+	struct m0_atomic64         *rec_cnt;
 	struct m0_trace_rec_header *header;
 	struct m0_trace_buf_header *tbh = m0_logbuf_header;
 	register unsigned long      sp asm("sp"); /* stack pointer */
@@ -222,7 +237,22 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 		return;
 #endif
 
-	record_num = m0_atomic64_add_return(&tbh->tbh_rec_cnt, 1);
+	if (tbh->tbh_cpu_nr > 1) {
+		cpu     = m0_arch_trace_cpu_get() & (tbh->tbh_cpu_nr - 1);
+		cur_pos = &tbh->tbh_cpu[cpu].tcp_cur_pos;
+		rec_cnt = &tbh->tbh_cpu[cpu].tcp_rec_cnt;
+		buf     = m0_logbuf + cpu * tbh->tbh_cpu_buf_size;
+		bufsize = tbh->tbh_cpu_buf_size;
+	} else {
+		cpu     = 0;
+		cur_pos = &tbh->tbh_cur_pos;
+		rec_cnt = &tbh->tbh_rec_cnt;
+		buf     = m0_logbuf;
+		bufsize = m0_logbufsize;
+	}
+	mask = bufsize - 1;
+
+	record_num = m0_atomic64_add_return(rec_cnt, 1);
 
 	/*
 	 * Allocate space in trace buffer to store trace record header
@@ -241,6 +271,11 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	 * First free byte in the trace buffer is at "cur" offset. Note, that
 	 * cur is not wrapped to 0 when the end of the buffer is reached (that
 	 * would require additional synchronization between contending threads).
+	 *
+	 * When the buffer is split, the same applies to the sub-buffer of the
+	 * current CPU. The thread can migrate to another CPU meanwhile, so the
+	 * position is still updated atomically, but the update is normally
+	 * uncontended.
 	 */
 
 	header_len    = m0_align(sizeof *header, M0_TRACE_REC_ALIGN);
@@ -249,24 +284,23 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 			m0_align(str_data_size, M0_TRACE_REC_ALIGN);
 
 	while (1) {
-		endpos = m0_atomic64_add_return(&tbh->tbh_cur_pos, record_len);
+		endpos = m0_atomic64_add_return(cur_pos, record_len);
 		pos    = endpos - record_len;
-		pos_in_buf = pos & bufmask;
-		endpos_in_buf = endpos & bufmask;
+		pos_in_buf = pos & mask;
+		endpos_in_buf = endpos & mask;
 		/*
 		 * The record should not cross the buffer.
 		 */
 		if (pos_in_buf > endpos_in_buf && endpos_in_buf) {
-			memset(m0_logbuf + pos_in_buf, 0,
-			       m0_logbufsize - pos_in_buf);
-			memset(m0_logbuf, 0, endpos_in_buf);
+			memset(buf + pos_in_buf, 0, bufsize - pos_in_buf);
+			memset(buf, 0, endpos_in_buf);
 		} else
 			break;
 	}
 
 	m0_trace_stats_update(record_len);
 
-	header                = m0_logbuf + pos_in_buf;
+	header                = (void *)(buf + pos_in_buf);
 	header->trh_magic     = 0;
 #ifdef __KERNEL__
 	header->trh_pid       = current->pid;
@@ -280,6 +314,7 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	header->trh_descr     = td;
 	header->trh_string_data_size = str_data_size;
 	header->trh_record_size = record_len;
+	header->trh_cpu       = cpu;
 	body_in_buf           = (char*)header + header_len;
 
 	memcpy(body_in_buf, body, td->td_size);
@@ -894,23 +929,24 @@ int  m0_trace_record_print_yaml(char *outbuf, size_t outbuf_size,
 }
 M0_EXPORTED(m0_trace_record_print_yaml);
 
-M0_INTERNAL const struct m0_trace_rec_header *m0_trace_last_record_get(void)
+static const struct m0_trace_rec_header *last_record_get(char *buf,
+							 uint64_t size,
+							 uint64_t pos)
 {
-	char *curptr = (char*)m0_logbuf +
-				m0_trace_logbuf_pos_get() % m0_logbufsize;
+	char *curptr = buf + pos % size;
 	char *p = curptr;
 
 	/* moving from current position in buffer backwards to buffer start */
-	while (p >= (char*)m0_logbuf) {
+	while (p > buf) {
 		p -= M0_TRACE_REC_ALIGN;
 		if (*((uint64_t*)p) == M0_TRACE_MAGIC)
 			return (const struct m0_trace_rec_header*)p;
 	}
 
 	/* continue search from buffer end, backwards till current position */
-	p = (char*)m0_logbuf + m0_logbufsize;
+	p = buf + size;
 
-	while (p >= curptr) {
+	while (p > curptr) {
 		p -= M0_TRACE_REC_ALIGN;
 		if (*((uint64_t*)p) == M0_TRACE_MAGIC)
 			return (const struct m0_trace_rec_header*)p;
@@ -918,6 +954,29 @@ M0_INTERNAL const struct m0_trace_rec_header *m0_trace_last_record_get(void)
 
 	return NULL;
 }
+
+M0_INTERNAL const struct m0_trace_rec_header *m0_trace_last_record_get(void)
+{
+	struct m0_trace_buf_header       *tbh = m0_logbuf_header;
+	const struct m0_trace_rec_header *last = NULL;
+	const struct m0_trace_rec_header *trh;
+	uint32_t                          i;
+
+	if (tbh->tbh_cpu_nr <= 1)
+		return last_record_get(m0_logbuf, m0_logbufsize,
+				       m0_trace_logbuf_pos_get());
+
+	for (i = 0; i < tbh->tbh_cpu_nr; ++i) {
+		trh = last_record_get((char*)m0_logbuf +
+				      i * tbh->tbh_cpu_buf_size,
+				      tbh->tbh_cpu_buf_size,
+			     m0_atomic64_get(&tbh->tbh_cpu[i].tcp_cur_pos));
+		if (trh != NULL &&
+		    (last == NULL || trh->trh_timestamp > last->trh_timestamp))
+			last = trh;
+	}
+	return last;
+}
 M0_EXPORTED(m0_trace_last_record_get);
 
 
@@ -940,6 +999,9 @@ M0_INTERNAL void m0_trace_buf_header_init(struct m0_trace_buf_header *tbh, size_
 	m0_atomic64_set(&tbh->tbh_cur_pos, 0);
 	m0_atomic64_set(&tbh->tbh_rec_cnt, 0);
 
+	tbh->tbh_cpu_nr       = 0;
+	tbh->tbh_cpu_buf_size = 0;
+
 	strncpy(tbh->tbh_motr_version, bi->bi_version_string,
 		sizeof tbh->tbh_motr_version);
 	strncpy(tbh->tbh_motr_git_describe, bi->bi_git_describe,
@@ -951,6 +1013,29 @@ M0_INTERNAL void m0_trace_buf_header_init(struct m0_trace_buf_header *tbh, size_
 }
 M0_EXPORTED(m0_trace_buf_header_init);
 
+M0_INTERNAL void m0_trace_buf_cpu_split(struct m0_trace_buf_header *tbh,
+					uint32_t cpu_nr)
+{
+	uint32_t nr = 1;
+	uint32_t i;
+
+	M0_PRE(m0_is_po2(tbh->tbh_buf_size));
+
+	while (nr * 2 <= min32u(cpu_nr, M0_TRACE_CPU_MAX) &&
+	       tbh->tbh_buf_size / (nr * 2) >= M0_TRACE_CPU_BUF_MIN)
+		nr *= 2;
+
+	if (nr == 1)
+		return;
+
+	for (i = 0; i < nr; ++i) {
+		m0_atomic64_set(&tbh->tbh_cpu[i].tcp_cur_pos, 0);
+		m0_atomic64_set(&tbh->tbh_cpu[i].tcp_rec_cnt, 0);
+	}
+	tbh->tbh_cpu_buf_size = tbh->tbh_buf_size / nr;
+	tbh->tbh_cpu_nr       = nr;
+}
+
 M0_INTERNAL void m0_trace_switch_to_static_logbuf(void)
 {
 	m0_logbuf_header = &bootlog.bl_area.ta_header;
@@ -304,6 +304,12 @@ enum {
 	M0_TRACE_BUF_HEADER_SIZE = PAGE_SIZE,
 	/** Alignment for trace records in trace buffer */
 	M0_TRACE_REC_ALIGN = 8, /* word size on x86_64 */
+	/** Maximal number of per-CPU sub-buffers, power of 2 */
+	M0_TRACE_CPU_MAX = 16,
+	/** Minimal size of a per-CPU sub-buffer */
+	M0_TRACE_CPU_BUF_MIN = 1 << 20,
+	/** Size of m0_trace_cpu_pos, a cache line */
+	M0_TRACE_CPU_POS_SIZE = 64,
 };
 M0_BASSERT(M0_TRACE_BUF_HEADER_SIZE % PAGE_SIZE == 0);
 
@@ -323,6 +329,22 @@ enum m0_trace_buf_flags {
 };
 M0_BASSERT(M0_TRACE_BUF_FLAGS_MAX < UINT16_MAX);
 
+/**
+ * Allocation state of a per-CPU trace sub-buffer.
+ *
+ * Padded to a cache line, so that CPUs do not contend on each other's
+ * positions.
+ */
+struct m0_trace_cpu_pos {
+	/** Current position in the sub-buffer, same as tbh_cur_pos */
+	struct m0_atomic64 tcp_cur_pos;
+	/** Record counter of the sub-buffer */
+	struct m0_atomic64 tcp_rec_cnt;
+	char               tcp_pad[M0_TRACE_CPU_POS_SIZE -
+				   2 * sizeof(struct m0_atomic64)];
+};
+M0_BASSERT(sizeof (struct m0_trace_cpu_pos) == M0_TRACE_CPU_POS_SIZE);
+
 /**
  * Trace buffer header structure
  *
@@ -392,6 +414,19 @@ struct m0_trace_buf_header {
 			uint16_t                tbh_magic_sym_addresses_nr;
 			/** Additional magic symbols for external libraries */
 			const void             *tbh_magic_sym_addresses[128];
+			/**
+			 * Number of per-CPU sub-buffers the trace buffer is
+			 * split into, 0 if it's a single ring allocated with
+			 * tbh_cur_pos and tbh_rec_cnt, see
+			 * m0_trace_buf_cpu_split()
+			 */
+			uint32_t                tbh_cpu_nr;
+			/** Size of a per-CPU sub-buffer */
+			uint64_t                tbh_cpu_buf_size;
+			/** Aligns tbh_cpu[] to a cache line */
+			char                    tbh_cpu_pad[56];
+			/** Allocation state of per-CPU sub-buffers */
+			struct m0_trace_cpu_pos tbh_cpu[M0_TRACE_CPU_MAX];
 
 			/* XXX: add new field right above this line */
 		};
@@ -399,13 +434,15 @@ struct m0_trace_buf_header {
 	};
 };
 M0_BASSERT(sizeof (struct m0_trace_buf_header) == M0_TRACE_BUF_HEADER_SIZE);
+M0_BASSERT(offsetof(struct m0_trace_buf_header, tbh_cpu) %
+	   M0_TRACE_CPU_POS_SIZE == 0);
 
 /**
  * Record header structure
  *
  * - magic number to locate the record in buffer
  * - stack pointer - useful to distinguish between threads
- * - global record number
+ * - record number, global or within a per-CPU sub-buffer
  * - timestamp
  * - pointer to record description in the program file
  */
@@ -415,12 +452,15 @@ struct m0_trace_rec_header {
 	uint64_t                     trh_magic;
 	uint64_t                     trh_sp; /**< stack pointer */
 	uint64_t                     trh_no; /**< record # */
-	uint64_t                     trh_pos; /**< abs record pos in logbuf */
+	/** abs record pos in logbuf or in per-CPU sub-buffer */
+	uint64_t                     trh_pos;
 	uint64_t                     trh_timestamp;
 	const struct m0_trace_descr *trh_descr;
 	uint32_t                     trh_string_data_size;
 	uint32_t                     trh_record_size; /**< total record size */
 	pid_t                        trh_pid; /**< current PID */
+	/** index of per-CPU sub-buffer, 0 if trace buffer isn't split */
+	uint32_t                     trh_cpu;
 };
 
 /**
@@ -80,6 +80,19 @@ M0_INTERNAL void m0_trace_stats_update(uint32_t rec_size);
 M0_INTERNAL void m0_trace_buf_header_init(struct m0_trace_buf_header *tbh, size_t buf_size);
 M0_INTERNAL void m0_arch_trace_buf_header_init(struct m0_trace_buf_header *tbh);
 
+/**
+ * Splits the trace buffer into per-CPU sub-buffers, at most cpu_nr of them.
+ *
+ * The number of sub-buffers is a power of 2, not greater than
+ * M0_TRACE_CPU_MAX, and each of them is at least M0_TRACE_CPU_BUF_MIN bytes.
+ * The buffer is left unsplit if it's too small for two sub-buffers.
+ */
+M0_INTERNAL void m0_trace_buf_cpu_split(struct m0_trace_buf_header *tbh,
+					uint32_t cpu_nr);
+
+/** Returns the CPU the current thread runs on, used to pick a sub-buffer. */
+M0_INTERNAL uint32_t m0_arch_trace_cpu_get(void);
+
 M0_INTERNAL void m0_trace_switch_to_static_logbuf(void);
 
 M0_INTERNAL void m0_console_vprintf(const char *fmt, va_list ap);
@@ -33,6 +33,7 @@
 #include <limits.h>   /* CHAR_BIT */
 #include <stddef.h>   /* ptrdiff_t */
 #include <time.h>     /* strftime */
+#include <sched.h>    /* sched_getcpu */
 
 #include "lib/types.h"
 #include "lib/arith.h"
@@ -105,6 +106,8 @@ static int logbuf_map()
 		m0_logbuf = trace_area->ta_buf;
 		memset(trace_area, 0, trace_area_size);
 		m0_trace_buf_header_init(&trace_area->ta_header, trace_buf_size);
+		m0_trace_buf_cpu_split(&trace_area->ta_header,
+				       sysconf(_SC_NPROCESSORS_CONF));
 		m0_trace_logbuf_size_set(trace_buf_size);
 	}
 
@@ -153,6 +156,14 @@ M0_INTERNAL void m0_trace_stats_update(uint32_t rec_size)
 {
 }
 
+M0_INTERNAL uint32_t m0_arch_trace_cpu_get(void)
+{
+	int cpu = sched_getcpu();
+
+	/* any sub-buffer will do, if the CPU is unknown */
+	return cpu < 0 ? 0 : cpu;
+}
+
 M0_INTERNAL void m0_trace_set_mmapped_buffer(bool val)
 {
 	use_mmaped_buffer = val;
@@ -516,12 +527,214 @@ enum {
 		((struct m0_trace_buf_header *)0)->tbh_magic_sym_addresses)
 };
 
+/**
+ * Finds the trace descriptor of a record among the known magic symbol
+ * offsets. Stores its (patched) copy in td_copy and points trh->trh_descr to
+ * it.
+ *
+ * Returns -ENOENT if the record should be skipped.
+ */
+static int rec_descr_find(struct m0_trace_rec_header *trh,
+			  const struct m0_trace_buf_header *tbh,
+			  const ptrdiff_t *td_offsets, size_t td_offsets_nr,
+			  struct m0_trace_descr *td_copy,
+			  size_t *invalid_td_count)
+{
+	const ptrdiff_t       *td_offset;
+	struct m0_trace_descr *td;
+	bool                   td_is_sane;
+	int                    i;
+
+	for (i = 0; i < td_offsets_nr; ++i) {
+		td_offset = &td_offsets[i];
+		td = (struct m0_trace_descr*)((char*)trh->trh_descr +
+					      *td_offset);
+		td_is_sane = m0_addr_is_sane_and_aligned((const uint64_t *)td);
+		if (td_is_sane && td->td_magic == M0_TRACE_DESCR_MAGIC)
+				break;
+
+	}
+
+	if (!td_is_sane) {
+		warnx("Skipping non-existing trace descriptor %p",
+		      trh->trh_descr);
+		return -ENOENT;
+	}
+
+	if (td->td_magic != M0_TRACE_DESCR_MAGIC) {
+		if (*invalid_td_count == 0)
+			warnx("Invalid trace descriptor - most probably"
+			      "the trace file was produced by a"
+			      "different version of Motr");
+		++*invalid_td_count;
+		return -ENOENT;
+	}
+
+	*td_copy = *td;
+	if (tbh->tbh_buf_type == M0_TRACE_BUF_KERNEL)
+		patch_trace_descr(td_copy, *td_offset);
+	trh->trh_descr = td_copy;
+	return 0;
+}
+
+static void rec_print(FILE *output_file, const struct m0_trace_rec_header *trh,
+		      const void *buf, enum m0_trace_parse_flags flags)
+{
+	static char yaml_buf[256 * 1024]; /* 256 KB */
+	int         rc;
+
+	rc = m0_trace_record_print_yaml(yaml_buf, sizeof yaml_buf, trh,
+		buf, !(flags & M0_TRACE_PARSE_YAML_SINGLE_DOC_OUTPUT));
+	if (rc == 0)
+		fprintf(output_file, "%s", yaml_buf);
+	else if (rc == -ENOBUFS)
+		warnx("Internal buffer is too small to hold trace record");
+	else
+		warnx("Failed to process trace record data for %p"
+		      " descriptor", trh->trh_descr);
+}
+
+/** Reference to a record of a per-CPU sub-buffer, loaded in memory. */
+struct rec_ref {
+	uint64_t    rr_timestamp;
+	uint64_t    rr_no;
+	uint32_t    rr_cpu;
+	const char *rr_rec;
+};
+
+static int rec_ref_cmp(const void *a, const void *b)
+{
+	const struct rec_ref *r0 = a;
+	const struct rec_ref *r1 = b;
+
+	return M0_3WAY(r0->rr_timestamp, r1->rr_timestamp) ?:
+	       M0_3WAY(r0->rr_cpu, r1->rr_cpu) ?:
+	       M0_3WAY(r0->rr_no, r1->rr_no);
+}
+
+/**
+ * Looks for records in a per-CPU sub-buffer. Stores references to them in
+ * refs, unless it's NULL, and returns their number.
+ */
+static size_t cpu_buf_scan(const char *buf, uint64_t size, uint32_t cpu,
+			   struct rec_ref *refs)
+{
+	const struct m0_trace_rec_header *trh;
+	uint64_t                          pos = 0;
+	size_t                            nr = 0;
+
+	while (pos + sizeof *trh <= size) {
+		trh = (const struct m0_trace_rec_header *)(buf + pos);
+		if (trh->trh_magic != M0_TRACE_MAGIC ||
+		    trh->trh_record_size < sizeof *trh ||
+		    trh->trh_record_size > size - pos ||
+		    trh->trh_record_size % M0_TRACE_REC_ALIGN != 0) {
+			pos += M0_TRACE_REC_ALIGN;
+			continue;
+		}
+		if (refs != NULL)
+			refs[nr] = (struct rec_ref) {
+				.rr_timestamp = trh->trh_timestamp,
+				.rr_no        = trh->trh_no,
+				.rr_cpu       = cpu,
+				.rr_rec       = (const char *)trh
+			};
+		++nr;
+		pos += trh->trh_record_size;
+	}
+	return nr;
+}
+
+static bool cpu_bufs_are_valid(const struct m0_trace_buf_header *tbh)
+{
+	return tbh->tbh_cpu_nr <= M0_TRACE_CPU_MAX &&
+	       m0_is_po2(tbh->tbh_cpu_nr) &&
+	       tbh->tbh_cpu_buf_size * tbh->tbh_cpu_nr == tbh->tbh_buf_size;
+}
+
+/**
+ * Parses a trace buffer split into per-CPU sub-buffers.
+ *
+ * The whole buffer is loaded in memory, records of all sub-buffers are sorted
+ * by their timestamps and printed in this order, as if they were written to
+ * a single buffer.
+ */
+static int cpu_bufs_parse(FILE *trace_file, FILE *output_file,
+			  const struct m0_trace_buf_header *tbh,
+			  enum m0_trace_parse_flags flags,
+			  const ptrdiff_t *td_offsets, size_t td_offsets_nr)
+{
+	struct m0_trace_rec_header  trh;
+	struct m0_trace_descr       patched_td;
+	struct rec_ref             *refs = NULL;
+	char                       *data;
+	size_t                      nr;
+	size_t                      rec_nr = 0;
+	size_t                      invalid_td_count = 0;
+	size_t                      i;
+	uint32_t                    cpu;
+
+	data = m0_alloc(tbh->tbh_buf_size);
+	if (data == NULL) {
+		warnx("Failed to allocate %"PRIu64" bytes for trace buffer",
+		      tbh->tbh_buf_size);
+		return EX_OSERR;
+	}
+	nr = fread(data, 1, tbh->tbh_buf_size, trace_file);
+	if (ferror(trace_file)) {
+		warn("Failed to read trace buffer");
+		m0_free(data);
+		return EX_DATAERR;
+	}
+	/* the missing part of a truncated trace file stays zeroed */
+	if (nr != tbh->tbh_buf_size)
+		warnx("Got %zu bytes of trace buffer (expected %"PRIu64")",
+		      nr, tbh->tbh_buf_size);
+
+	for (cpu = 0; cpu < tbh->tbh_cpu_nr; ++cpu)
+		rec_nr += cpu_buf_scan(data + cpu * tbh->tbh_cpu_buf_size,
+				       tbh->tbh_cpu_buf_size, cpu, NULL);
+	if (rec_nr > 0) {
+		M0_ALLOC_ARR(refs, rec_nr);
+		if (refs == NULL) {
+			warnx("Failed to allocate index of %zu trace records",
+			      rec_nr);
+			m0_free(data);
+			return EX_OSERR;
+		}
+	}
+	for (i = 0, cpu = 0; cpu < tbh->tbh_cpu_nr; ++cpu)
+		i += cpu_buf_scan(data + cpu * tbh->tbh_cpu_buf_size,
+				  tbh->tbh_cpu_buf_size, cpu, refs + i);
+	M0_ASSERT(i == rec_nr);
+	qsort(refs, rec_nr, sizeof refs[0], &rec_ref_cmp);
+
+	for (i = 0; i < rec_nr; ++i) {
+		memcpy(&trh, refs[i].rr_rec, sizeof trh);
+		if (rec_descr_find(&trh, tbh, td_offsets, td_offsets_nr,
+				   &patched_td, &invalid_td_count) != 0)
+			continue;
+		rec_print(output_file, &trh, refs[i].rr_rec + sizeof trh,
+			  flags);
+	}
+	if (invalid_td_count > 0)
+		warnx("Total number of unknown trace records, that were"
+		      " skipped: %zu", invalid_td_count);
+
+	m0_free(refs);
+	m0_free(data);
+	return EX_OK;
+}
+
 /**
  * Parse log buffer from a trace file.
  *
  * Normally a trace file would be called "m0trace.12345" or something like that,
  * where number represents a PID of the process which created that trace file.
  *
+ * Records of a trace buffer split into per-CPU sub-buffers are printed in the
+ * order of their timestamps.
+ *
  * Returns sysexits.h error codes.
  */
 M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
@@ -532,21 +745,16 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 {
 	const struct m0_trace_buf_header *tbh;
 	struct m0_trace_rec_header        trh;
-	struct m0_trace_descr            *td;
 	struct m0_trace_descr             patched_td;
 
 	int        rc;
-	int        i;
 	size_t     pos = 0;
 	size_t     nr;
 	size_t     n2r;
 	size_t     size;
 	size_t     invalid_td_count = 0;
-	bool       td_is_sane;
 	char      *buf;
 
-	static char  yaml_buf[256 * 1024]; /* 256 KB */
-	ptrdiff_t   *td_offset;
 	ptrdiff_t    td_offsets[MAGIC_SYM_OFFSETS_MAX + 1] = { 0 };
 	size_t       td_offsets_nr =
 			(magic_symbols_nr < MAGIC_SYM_OFFSETS_MAX ?
@@ -584,6 +792,15 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 	if (flags & M0_TRACE_PARSE_YAML_SINGLE_DOC_OUTPUT)
 		fprintf(output_file, "trace_records:\n");
 
+	if (tbh->tbh_cpu_nr > 1) {
+		if (cpu_bufs_are_valid(tbh))
+			return cpu_bufs_parse(trace_file, output_file, tbh,
+					      flags, td_offsets, td_offsets_nr);
+		warnx("Invalid per-CPU trace buffers layout (%u x %"PRIu64
+		      " bytes), parsing it as a single buffer",
+		      tbh->tbh_cpu_nr, tbh->tbh_cpu_buf_size);
+	}
+
 	while (!feof(trace_file)) {
 
 		/* At the beginning of a record */
@@ -620,37 +837,11 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 		}
 		pos += nr;
 
-		for (i = 0; i < td_offsets_nr; ++i) {
-			td_offset = &td_offsets[i];
-			td = (struct m0_trace_descr*)((char*)trh.trh_descr +
-						      *td_offset);
-			td_is_sane =
-			     m0_addr_is_sane_and_aligned((const uint64_t *)td);
-			if (td_is_sane && td->td_magic == M0_TRACE_DESCR_MAGIC)
-					break;
-
-		}
-
-		if (!td_is_sane) {
-			warnx("Skipping non-existing trace descriptor %p",
-			      trh.trh_descr);
+		if (rec_descr_find(&trh, tbh, td_offsets, td_offsets_nr,
+				   &patched_td, &invalid_td_count) != 0)
 			continue;
-		}
-
-		if (td->td_magic != M0_TRACE_DESCR_MAGIC) {
-			if (invalid_td_count == 0)
-				warnx("Invalid trace descriptor - most probably"
-				      "the trace file was produced by a"
-				      "different version of Motr");
-			++invalid_td_count;
-			continue;
-		}
 
-		patched_td = *td;
-		if (tbh->tbh_buf_type == M0_TRACE_BUF_KERNEL)
-			patch_trace_descr(&patched_td, *td_offset);
-		trh.trh_descr = &patched_td;
-		size = m0_align(td->td_size + trh.trh_string_data_size,
+		size = m0_align(patched_td.td_size + trh.trh_string_data_size,
 				M0_TRACE_REC_ALIGN);
 
 		buf = m0_alloc(size);
@@ -667,15 +858,7 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 		}
 		pos += nr;
 
-		rc = m0_trace_record_print_yaml(yaml_buf, sizeof yaml_buf, &trh,
-			buf, !(flags & M0_TRACE_PARSE_YAML_SINGLE_DOC_OUTPUT));
-		if (rc == 0)
-			fprintf(output_file, "%s", yaml_buf);
-		else if (rc == -ENOBUFS)
-			warnx("Internal buffer is too small to hold trace record");
-		else
-			warnx("Failed to process trace record data for %p"
-			      " descriptor", trh.trh_descr);
+		rec_print(output_file, &trh, buf, flags);
 		m0_free(buf);
 	}
 	return EX_OK;
@@ -43,11 +43,13 @@ extern void test_processor(void);
 extern void test_queue(void);
 extern void test_refs(void);
 extern void test_rw(void);
+extern void test_slab(void);
 extern void test_thread(void);
 extern void m0_ut_time_test(void);
 extern void test_timer(void);
 extern void test_tlist(void);
 extern void test_trace(void);
+extern void test_trace_cpu(void);
 extern void test_varr(void);
 extern void test_vec(void);
 extern void test_zerovec(void);
@@ -86,11 +88,13 @@ struct m0_ut_suite libm0_ut = {
 		{ "processor",        test_processor     },
 		{ "queue",            test_queue         },
 		{ "refs",             test_refs          },
+		{ "slab",             test_slab          },
 		{ "thread",           test_thread        },
 		{ "time",             m0_ut_time_test    },
 		{ "timer",            test_timer,        "Max" },
 		{ "tlist",            test_tlist         },
 		{ "trace",            test_trace,        "Dima, Andriy" },
+		{ "trace-cpu",        test_trace_cpu     },
 		{ "uuid",             m0_test_lib_uuid   },
 		{ "varr",             test_varr          },
 		{ "vec",              test_vec,          "Huang Hua"},
@@ -0,0 +1,194 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "ut/ut.h"
+#include "lib/slab.h"
+#include "lib/thread.h"
+#include "lib/atomic.h"
+#include "lib/memory.h"
+#include "lib/misc.h"       /* ARRAY_SIZE */
+
+enum {
+	OBJ_NR    = M0_SLAB_MAG_NR * 2 * M0_SLAB_BATCH + M0_SLAB_DEPOT_MAX,
+	THREAD_NR = 8,
+	ROUND_NR  = 10000
+};
+
+struct slab_obj {
+	uint64_t so_magic;
+	char     so_payload[40];
+};
+
+static struct m0_slab      slab;
+static void               *obj[OBJ_NR];
+static struct m0_atomic64  ctor_nr;
+static struct m0_atomic64  dtor_nr;
+
+static void obj_ctor(void *o)
+{
+	((struct slab_obj *)o)->so_magic = 0x5ca1ab1e;
+	m0_atomic64_inc(&ctor_nr);
+}
+
+static void obj_dtor(void *o)
+{
+	M0_UT_ASSERT(((struct slab_obj *)o)->so_magic == 0x5ca1ab1e);
+	m0_atomic64_inc(&dtor_nr);
+}
+
+static void slab_plain(void)
+{
+	struct m0_slab_stats st;
+	struct slab_obj     *o;
+	int                  i;
+
+	m0_slab_init(&slab, "ut", sizeof *o, NULL, NULL);
+	for (i = 0; i < 100; ++i) {
+		obj[i] = o = m0_slab_alloc(&slab);
+		M0_UT_ASSERT(o != NULL);
+		M0_UT_ASSERT(m0_forall(j, sizeof *o, ((char *)o)[j] == 0));
+		memset(o, 0xff, sizeof *o);
+	}
+	for (i = 0; i < 100; ++i) {
+		m0_slab_free(&slab, obj[i]);
+#if defined(ENABLE_FREE_POISON)
+		M0_UT_ASSERT(m0_is_poisoned(obj[i]));
+#endif
+	}
+	/* Cached objects are zeroed again. */
+	for (i = 0; i < 100; ++i) {
+		obj[i] = o = m0_slab_alloc(&slab);
+		M0_UT_ASSERT(m0_forall(j, sizeof *o, ((char *)o)[j] == 0));
+	}
+	m0_slab_stats_get(&slab, &st);
+	M0_UT_ASSERT(st.ss_alloc_nr == 200);
+	M0_UT_ASSERT(st.ss_hit_nr >= 100);
+	M0_UT_ASSERT(st.ss_sys_alloc_nr <= 200);
+	/* Memory from m0_alloc() can be freed to the cache. */
+	m0_slab_free(&slab, m0_alloc(sizeof *o));
+	m0_slab_free(&slab, NULL);
+	for (i = 0; i < 100; ++i)
+		m0_slab_free(&slab, obj[i]);
+	m0_slab_shrink(&slab);
+	m0_slab_stats_get(&slab, &st);
+	M0_UT_ASSERT(st.ss_cached_nr == 0);
+	/* The foreign object is only counted when it goes to the system. */
+	M0_UT_ASSERT(st.ss_sys_free_nr == st.ss_sys_alloc_nr + 1);
+	m0_slab_fini(&slab);
+}
+
+static void slab_ctor(void)
+{
+	struct m0_slab_stats st;
+	struct slab_obj     *o;
+	int                  i;
+
+	m0_atomic64_set(&ctor_nr, 0);
+	m0_atomic64_set(&dtor_nr, 0);
+	m0_slab_init(&slab, "ut-ctor", sizeof *o, &obj_ctor, &obj_dtor);
+	for (i = 0; i < ARRAY_SIZE(obj); ++i) {
+		obj[i] = o = m0_slab_alloc(&slab);
+		M0_UT_ASSERT(o != NULL);
+		M0_UT_ASSERT(o->so_magic == 0x5ca1ab1e);
+	}
+	M0_UT_ASSERT(m0_atomic64_get(&ctor_nr) == ARRAY_SIZE(obj));
+	/* Objects which do not fit into the cache go back to the system. */
+	for (i = 0; i < ARRAY_SIZE(obj); ++i)
+		m0_slab_free(&slab, obj[i]);
+	m0_slab_stats_get(&slab, &st);
+	M0_UT_ASSERT(st.ss_sys_alloc_nr == ARRAY_SIZE(obj));
+	M0_UT_ASSERT(st.ss_sys_free_nr == m0_atomic64_get(&dtor_nr));
+	M0_UT_ASSERT(st.ss_sys_alloc_nr - st.ss_sys_free_nr ==
+		     st.ss_cached_nr);
+	/* Constructed state survives caching. */
+	for (i = 0; i < ARRAY_SIZE(obj); ++i) {
+		obj[i] = o = m0_slab_alloc(&slab);
+		M0_UT_ASSERT(o->so_magic == 0x5ca1ab1e);
+	}
+	for (i = 0; i < ARRAY_SIZE(obj); ++i)
+		m0_slab_free(&slab, obj[i]);
+	m0_slab_fini(&slab);
+	M0_UT_ASSERT(m0_atomic64_get(&ctor_nr) == m0_atomic64_get(&dtor_nr));
+}
+
+static void slab_worker(int idx)
+{
+	struct slab_obj *o[M0_SLAB_BATCH * 3];
+	int              i;
+	int              j;
+
+	for (i = 0; i < ROUND_NR; ++i) {
+		for (j = 0; j < (i % ARRAY_SIZE(o)) + 1; ++j) {
+			o[j] = m0_slab_alloc(&slab);
+			M0_UT_ASSERT(o[j] != NULL);
+			M0_UT_ASSERT(o[j]->so_magic == 0x5ca1ab1e);
+			o[j]->so_payload[0] = idx;
+		}
+		while (--j >= 0) {
+			M0_UT_ASSERT(o[j]->so_payload[0] == idx);
+			m0_slab_free(&slab, o[j]);
+		}
+	}
+}
+
+static void slab_mt(void)
+{
+	struct m0_thread t[THREAD_NR] = {};
+	int              i;
+	int              rc;
+
+	m0_atomic64_set(&ctor_nr, 0);
+	m0_atomic64_set(&dtor_nr, 0);
+	m0_slab_init(&slab, "ut-mt", sizeof(struct slab_obj),
+		     &obj_ctor, &obj_dtor);
+	for (i = 0; i < ARRAY_SIZE(t); ++i) {
+		rc = M0_THREAD_INIT(&t[i], int, NULL, &slab_worker, i,
+				    "slab%d", i);
+		M0_UT_ASSERT(rc == 0);
+	}
+	for (i = 0; i < ARRAY_SIZE(t); ++i) {
+		m0_thread_join(&t[i]);
+		m0_thread_fini(&t[i]);
+	}
+	m0_slab_fini(&slab);
+	M0_UT_ASSERT(m0_atomic64_get(&ctor_nr) == m0_atomic64_get(&dtor_nr));
+}
+
+void test_slab(void)
+{
+	slab_plain();
+	slab_ctor();
+	slab_mt();
+}
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -27,6 +27,7 @@
 #include "lib/assert.h"
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_UT
 #include "lib/trace.h"
+#include "lib/trace_internal.h"
 
 enum {
 	NR       = 16,
@@ -73,10 +74,77 @@ void test_trace(void)
 		(char *)"foobar");
 }
 
+static uint64_t rec_cnt(const struct m0_trace_buf_header *tbh)
+{
+	uint64_t cnt = m0_atomic64_get(&tbh->tbh_rec_cnt);
+	uint32_t i;
+
+	for (i = 0; i < tbh->tbh_cpu_nr; ++i)
+		cnt += m0_atomic64_get(&tbh->tbh_cpu[i].tcp_rec_cnt);
+	return cnt;
+}
+
+void test_trace_cpu(void)
+{
+	static struct m0_trace_buf_header hdr;
+
+	const struct m0_trace_buf_header *tbh = m0_trace_logbuf_header_get();
+	const struct m0_trace_rec_header *trh;
+	const char                       *buf = m0_trace_logbuf_get();
+	const char                       *sub;
+	uint64_t                          cnt;
+	int                               i;
+
+	M0_SET0(&hdr);
+	hdr.tbh_buf_size = 8 * M0_TRACE_CPU_BUF_MIN;
+	m0_trace_buf_cpu_split(&hdr, 1);
+	M0_UT_ASSERT(hdr.tbh_cpu_nr == 0);
+	m0_trace_buf_cpu_split(&hdr, 3);
+	M0_UT_ASSERT(hdr.tbh_cpu_nr == 2);
+	M0_UT_ASSERT(hdr.tbh_cpu_buf_size == 4 * M0_TRACE_CPU_BUF_MIN);
+	m0_trace_buf_cpu_split(&hdr, 1024);
+	M0_UT_ASSERT(hdr.tbh_cpu_nr == 8);
+	M0_UT_ASSERT(hdr.tbh_cpu_buf_size == M0_TRACE_CPU_BUF_MIN);
+	M0_SET0(&hdr);
+	hdr.tbh_buf_size = 1024 * M0_TRACE_CPU_BUF_MIN;
+	m0_trace_buf_cpu_split(&hdr, 1024);
+	M0_UT_ASSERT(hdr.tbh_cpu_nr == M0_TRACE_CPU_MAX);
+	M0_SET0(&hdr);
+	hdr.tbh_buf_size = M0_TRACE_CPU_BUF_MIN;
+	m0_trace_buf_cpu_split(&hdr, 1024);
+	M0_UT_ASSERT(hdr.tbh_cpu_nr == 0);
+
+	cnt = rec_cnt(tbh);
+	for (i = 0; i < NR_INNER; ++i)
+		M0_LOG(M0_DEBUG, "i: %i", i);
+	M0_UT_ASSERT(rec_cnt(tbh) - cnt >= NR_INNER);
+
+	trh = m0_trace_last_record_get();
+	M0_UT_ASSERT(trh != NULL);
+	M0_UT_ASSERT(trh->trh_magic == M0_TRACE_MAGIC);
+	if (tbh->tbh_cpu_nr > 1) {
+		M0_UT_ASSERT(trh->trh_cpu < tbh->tbh_cpu_nr);
+		sub = buf + trh->trh_cpu * tbh->tbh_cpu_buf_size;
+		M0_UT_ASSERT((const char *)trh >= sub &&
+			     (const char *)trh < sub + tbh->tbh_cpu_buf_size);
+		M0_UT_ASSERT(trh->trh_pos < m0_atomic64_get(
+				     &tbh->tbh_cpu[trh->trh_cpu].tcp_cur_pos));
+	} else {
+		M0_UT_ASSERT(trh->trh_cpu == 0);
+		M0_UT_ASSERT(trh->trh_pos < m0_trace_logbuf_pos_get());
+	}
+}
+
 enum {
-	UB_ITER = 5000000
+	UB_ITER = 5000000,
+	/** Records logged in a round of multi-threaded benchmarks */
+	UB_MT_REC = 1 << 20,
+	UB_MT_ITER = 10,
+	UB_MT_THREADS_MAX = 32
 };
 
+static struct m0_thread ub_t[UB_MT_THREADS_MAX];
+
 static void ub_empty(int i)
 {
 	M0_LOG(M0_DEBUG, "msg");
@@ -94,6 +162,53 @@ static void ub_64(int i)
 		i + 6, i + 7);
 }
 
+static void ub_mt_thread(int nr)
+{
+	int j;
+
+	for (j = 0; j < UB_MT_REC / nr; ++j)
+		M0_LOG(M0_DEBUG, "%i", j);
+}
+
+/* UB_MT_REC records from nr threads, to see contention on trace buffer */
+static void ub_mt(int nr)
+{
+	int i;
+	int rc;
+
+	M0_PRE(nr <= UB_MT_THREADS_MAX);
+	M0_SET_ARR0(ub_t);
+	for (i = 0; i < nr; ++i) {
+		rc = M0_THREAD_INIT(&ub_t[i], int, NULL, &ub_mt_thread,
+				    nr, "trace_ub_%i", i);
+		M0_ASSERT(rc == 0);
+	}
+	for (i = 0; i < nr; ++i) {
+		m0_thread_join(&ub_t[i]);
+		m0_thread_fini(&ub_t[i]);
+	}
+}
+
+static void ub_mt_1(int i)
+{
+	ub_mt(1);
+}
+
+static void ub_mt_4(int i)
+{
+	ub_mt(4);
+}
+
+static void ub_mt_16(int i)
+{
+	ub_mt(16);
+}
+
+static void ub_mt_32(int i)
+{
+	ub_mt(32);
+}
+
 struct m0_ub_set m0_trace_ub = {
 	.us_name = "trace-ub",
 	.us_run  = {
@@ -109,6 +224,22 @@ struct m0_ub_set m0_trace_ub = {
 		  .ub_iter = UB_ITER,
 		  .ub_round = ub_64 },
 
+		{ .ub_name = "mt-1",
+		  .ub_iter = UB_MT_ITER,
+		  .ub_round = ub_mt_1 },
+
+		{ .ub_name = "mt-4",
+		  .ub_iter = UB_MT_ITER,
+		  .ub_round = ub_mt_4 },
+
+		{ .ub_name = "mt-16",
+		  .ub_iter = UB_MT_ITER,
+		  .ub_round = ub_mt_16 },
+
+		{ .ub_name = "mt-32",
+		  .ub_iter = UB_MT_ITER,
+		  .ub_round = ub_mt_32 },
+
 		{ .ub_name = NULL }
 	}
 };
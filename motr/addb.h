@@ -57,6 +57,8 @@ enum m0_avi_labels {
 	M0_AVI_IOO_ATTR_PAGE_SIZE,
 	M0_AVI_IOO_ATTR_BUFS_ALIGNED,
 	M0_AVI_IOO_ATTR_RMW,
+	M0_AVI_IOO_ATTR_FULLSTRIPE_NR,
+	M0_AVI_IOO_ATTR_RMW_NR,
 
 	M0_AVI_IOO_REQ,
 	M0_AVI_IOO_REQ_COUNTER,
@@ -0,0 +1,1103 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include "motr/client.h"
+#include "motr/client_internal.h"
+#include "motr/pg.h"
+#include "motr/io.h"
+#include "motr/cache.h"
+#include "motr/magic.h"
+
+#include "lib/bitmap.h"            /* m0_bitmap */
+#include "lib/errno.h"             /* ENOMEM */
+#include "lib/memory.h"            /* m0_alloc_aligned */
+#include "lib/vec.h"               /* m0_bufvec_cursor */
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"             /* M0_LOG */
+
+/**
+ * @addtogroup client-cache
+ * @{
+ */
+
+enum {
+	/** Alignment of the buffers of internal operations. */
+	OBJ_CACHE_BUF_SHIFT = 12,
+};
+
+/** Cached parity group of an object. */
+struct obj_cache_grp {
+	uint64_t             g_magic;
+	struct m0_obj_cache *g_cache;
+	/** Parity group number: group offset divided by the group size. */
+	uint64_t             g_index;
+	char                *g_buf;
+	struct m0_bitmap     g_valid;
+	struct m0_bitmap     g_dirty;
+	uint32_t             g_valid_nr;
+	uint32_t             g_dirty_nr;
+	/** When the group became dirty, 0 for a clean group. */
+	m0_time_t            g_dirtied;
+	/** Read-ahead of the group is in flight. */
+	bool                 g_ra;
+	/** Write-back of the group is in flight. */
+	bool                 g_wb;
+	/** Linkage into m0_obj_cache::oc_grps. */
+	struct m0_tlink      g_linkage;
+	/** Linkage into m0_obj_cache_domain::ocd_lru. */
+	struct m0_tlink      g_lru;
+};
+
+/** Internal read-ahead or write-back operation on a single group. */
+struct obj_cache_io {
+	uint64_t              io_magic;
+	struct m0_obj_cache  *io_cache;
+	struct obj_cache_grp *io_grp;
+	enum m0_obj_opcode    io_opcode;
+	struct m0_op         *io_op;
+	/** Snapshot of the group, the operation works on. */
+	char                 *io_buf;
+	struct m0_indexvec    io_ext;
+	struct m0_bufvec      io_data;
+	struct m0_bufvec      io_attr;
+	bool                  io_done;
+	/** Linkage into m0_obj_cache::oc_ios. */
+	struct m0_tlink       io_linkage;
+	/** Linkage into the list of operations to be launched. */
+	struct m0_tlink       io_launch;
+};
+
+M0_TL_DESCR_DEFINE(ocgrp, "object cache groups", static,
+		   struct obj_cache_grp, g_linkage, g_magic,
+		   M0_OBJ_CACHE_GRP_MAGIC, M0_OBJ_CACHE_GRP_HEAD_MAGIC);
+M0_TL_DEFINE(ocgrp, static, struct obj_cache_grp);
+
+M0_TL_DESCR_DEFINE(oclru, "object cache lru", static,
+		   struct obj_cache_grp, g_lru, g_magic,
+		   M0_OBJ_CACHE_GRP_MAGIC, M0_OBJ_CACHE_LRU_HEAD_MAGIC);
+M0_TL_DEFINE(oclru, static, struct obj_cache_grp);
+
+M0_TL_DESCR_DEFINE(ocio, "object cache operations", static,
+		   struct obj_cache_io, io_linkage, io_magic,
+		   M0_OBJ_CACHE_IO_MAGIC, M0_OBJ_CACHE_IO_HEAD_MAGIC);
+M0_TL_DEFINE(ocio, static, struct obj_cache_io);
+
+M0_TL_DESCR_DEFINE(oclaunch, "object cache operations to launch", static,
+		   struct obj_cache_io, io_launch, io_magic,
+		   M0_OBJ_CACHE_IO_MAGIC, M0_OBJ_CACHE_IO_HEAD_MAGIC);
+M0_TL_DEFINE(oclaunch, static, struct obj_cache_io);
+
+static const struct m0_op_ops obj_cache_io_cbs;
+
+/**
+ * Callback of obj_cache_walk(), called for each part of an extent that falls
+ * into a single group. The cursor, if any, points to the data of the part.
+ */
+typedef int (*obj_cache_walk_cb_t)(struct m0_obj_cache     *cache,
+				   uint64_t                 gidx,
+				   m0_bindex_t              goff,
+				   m0_bcount_t              len,
+				   struct m0_bufvec_cursor *cur,
+				   void                    *datum);
+
+static uint32_t grp_block_nr(const struct m0_obj_cache *cache)
+{
+	return cache->oc_grp_size >> cache->oc_bshift;
+}
+
+static bool grp_is_idle(const struct obj_cache_grp *grp)
+{
+	return !grp->g_ra && !grp->g_wb;
+}
+
+static void grp_block_set(struct obj_cache_grp *grp, size_t b,
+			  bool valid, bool dirty)
+{
+	M0_PRE(ergo(dirty, valid));
+
+	if (m0_bitmap_get(&grp->g_valid, b) != valid) {
+		m0_bitmap_set(&grp->g_valid, b, valid);
+		valid ? ++grp->g_valid_nr : --grp->g_valid_nr;
+	}
+	if (m0_bitmap_get(&grp->g_dirty, b) != dirty) {
+		m0_bitmap_set(&grp->g_dirty, b, dirty);
+		dirty ? ++grp->g_dirty_nr : --grp->g_dirty_nr;
+	}
+	if (grp->g_dirty_nr == 0)
+		grp->g_dirtied = 0;
+	else if (grp->g_dirtied == 0)
+		grp->g_dirtied = m0_time_now();
+}
+
+static bool grp_block_is_valid(const struct obj_cache_grp *grp, size_t b)
+{
+	return m0_bitmap_get(&grp->g_valid, b);
+}
+
+static bool grp_block_is_dirty(const struct obj_cache_grp *grp, size_t b)
+{
+	return m0_bitmap_get(&grp->g_dirty, b);
+}
+
+static struct obj_cache_grp *grp_find(const struct m0_obj_cache *cache,
+				      uint64_t gidx)
+{
+	return m0_tl_find(ocgrp, grp, &cache->oc_grps, grp->g_index == gidx);
+}
+
+static void grp_touch(struct obj_cache_grp *grp)
+{
+	oclru_tlist_move(&grp->g_cache->oc_dom->ocd_lru, grp);
+}
+
+static struct obj_cache_grp *grp_alloc(struct m0_obj_cache *cache,
+				       uint64_t gidx)
+{
+	struct obj_cache_grp *grp;
+
+	M0_ALLOC_PTR(grp);
+	if (grp == NULL)
+		return NULL;
+	grp->g_buf = m0_alloc(cache->oc_grp_size);
+	if (grp->g_buf == NULL ||
+	    m0_bitmap_init(&grp->g_valid, grp_block_nr(cache)) != 0 ||
+	    m0_bitmap_init(&grp->g_dirty, grp_block_nr(cache)) != 0) {
+		m0_bitmap_fini(&grp->g_valid);
+		m0_free(grp->g_buf);
+		m0_free(grp);
+		return NULL;
+	}
+	grp->g_cache = cache;
+	grp->g_index = gidx;
+	ocgrp_tlink_init_at(grp, &cache->oc_grps);
+	oclru_tlink_init_at(grp, &cache->oc_dom->ocd_lru);
+	cache->oc_dom->ocd_used += cache->oc_grp_size;
+	return grp;
+}
+
+static void grp_free(struct obj_cache_grp *grp)
+{
+	struct m0_obj_cache *cache = grp->g_cache;
+
+	M0_PRE(grp_is_idle(grp));
+
+	if (grp->g_dirty_nr > 0)
+		M0_LOG(M0_ERROR, "Dropping %"PRIu32" dirty blocks of group "
+		       "%"PRIu64, grp->g_dirty_nr, grp->g_index);
+	ocgrp_tlink_del_fini(grp);
+	oclru_tlink_del_fini(grp);
+	m0_bitmap_fini(&grp->g_dirty);
+	m0_bitmap_fini(&grp->g_valid);
+	m0_free(grp->g_buf);
+	m0_free(grp);
+	cache->oc_dom->ocd_used -= cache->oc_grp_size;
+}
+
+/**
+ * Evicts clean idle groups of any object, least recently used first, until
+ * "size" more bytes fit into the budget.
+ */
+static bool obj_cache_reserve(struct m0_obj_cache_domain *dom,
+			      m0_bcount_t size)
+{
+	struct obj_cache_grp *grp;
+	struct obj_cache_grp *prev;
+
+	M0_PRE(m0_mutex_is_locked(&dom->ocd_lock));
+
+	for (grp = oclru_tlist_tail(&dom->ocd_lru);
+	     grp != NULL && dom->ocd_used + size > dom->ocd_budget;
+	     grp = prev) {
+		prev = oclru_tlist_prev(&dom->ocd_lru, grp);
+		if (grp_is_idle(grp) && grp->g_dirty_nr == 0) {
+			grp_free(grp);
+			++dom->ocd_stats.ocs_evict_nr;
+		}
+	}
+	return dom->ocd_used + size <= dom->ocd_budget;
+}
+
+/**
+ * Calls "cb" for each part of "ext" that falls into a single group.
+ * Stops at the first non-zero return value.
+ */
+static int obj_cache_walk(struct m0_obj_cache      *cache,
+			  const struct m0_indexvec *ext,
+			  struct m0_bufvec         *data,
+			  obj_cache_walk_cb_t       cb,
+			  void                     *datum)
+{
+	struct m0_bufvec_cursor cur;
+	struct m0_bufvec_cursor part;
+	m0_bindex_t             off;
+	m0_bcount_t             left;
+	m0_bcount_t             len;
+	m0_bcount_t             gsize = cache->oc_grp_size;
+	uint32_t                i;
+	int                     rc = 0;
+
+	M0_SET0(&cur);
+	if (data != NULL)
+		m0_bufvec_cursor_init(&cur, data);
+	for (i = 0; i < ext->iv_vec.v_nr && rc == 0; ++i) {
+		off  = ext->iv_index[i];
+		left = ext->iv_vec.v_count[i];
+		while (left > 0 && rc == 0) {
+			len = min64u(left, gsize - off % gsize);
+			part = cur;
+			rc = cb(cache, off / gsize, off % gsize, len,
+				data != NULL ? &part : NULL, datum);
+			if (data != NULL)
+				m0_bufvec_cursor_move(&cur, len);
+			off  += len;
+			left -= len;
+		}
+	}
+	return rc;
+}
+
+/** Returns the range of blocks [*b0, *b1] spanned by a part of a group. */
+static void obj_cache_blocks(const struct m0_obj_cache *cache,
+			     m0_bindex_t goff, m0_bcount_t len,
+			     size_t *b0, size_t *b1)
+{
+	*b0 = goff >> cache->oc_bshift;
+	*b1 = (goff + len - 1) >> cache->oc_bshift;
+}
+
+/** Whether block "b" is completely covered by [goff, goff + len). */
+static bool obj_cache_block_covered(const struct m0_obj_cache *cache,
+				    size_t b, m0_bindex_t goff, m0_bcount_t len)
+{
+	return goff <= ((m0_bindex_t)b << cache->oc_bshift) &&
+	       ((m0_bindex_t)(b + 1) << cache->oc_bshift) <= goff + len;
+}
+
+static struct obj_cache_io *obj_cache_io_alloc(struct obj_cache_grp *grp,
+					       enum m0_obj_opcode opcode,
+					       uint32_t nr)
+{
+	struct m0_obj_cache *cache = grp->g_cache;
+	struct obj_cache_io *io;
+
+	M0_ALLOC_PTR(io);
+	if (io == NULL)
+		return NULL;
+	io->io_cache  = cache;
+	io->io_grp    = grp;
+	io->io_opcode = opcode;
+	ocio_tlink_init(io);
+	oclaunch_tlink_init(io);
+	io->io_buf = m0_alloc_aligned(cache->oc_grp_size, OBJ_CACHE_BUF_SHIFT);
+	if (io->io_buf == NULL ||
+	    m0_indexvec_alloc(&io->io_ext, nr) != 0 ||
+	    m0_bufvec_empty_alloc(&io->io_data, nr) != 0 ||
+	    m0_bufvec_alloc(&io->io_attr, nr, 1) != 0) {
+		m0_bufvec_free(&io->io_attr);
+		m0_bufvec_free2(&io->io_data);
+		m0_indexvec_free(&io->io_ext);
+		if (io->io_buf != NULL)
+			m0_free_aligned(io->io_buf, cache->oc_grp_size,
+					OBJ_CACHE_BUF_SHIFT);
+		m0_free(io);
+		return NULL;
+	}
+	return io;
+}
+
+static void obj_cache_io_free(struct obj_cache_io *io)
+{
+	ocio_tlink_fini(io);
+	oclaunch_tlink_fini(io);
+	m0_bufvec_free(&io->io_attr);
+	m0_bufvec_free2(&io->io_data);
+	m0_indexvec_free(&io->io_ext);
+	m0_free_aligned(io->io_buf, io->io_cache->oc_grp_size,
+			OBJ_CACHE_BUF_SHIFT);
+	m0_free(io);
+}
+
+static void obj_cache_io_seg_set(struct obj_cache_io *io, uint32_t i,
+				 m0_bindex_t goff, m0_bcount_t len)
+{
+	io->io_ext.iv_index[i] = io->io_grp->g_index *
+				 io->io_cache->oc_grp_size + goff;
+	io->io_ext.iv_vec.v_count[i] = len;
+	io->io_data.ov_buf[i] = io->io_buf + goff;
+	io->io_data.ov_vec.v_count[i] = len;
+}
+
+static void obj_cache_io_queue(struct obj_cache_io *io, struct m0_tl *launch)
+{
+	ocio_tlist_add_tail(&io->io_cache->oc_ios, io);
+	oclaunch_tlist_add_tail(launch, io);
+}
+
+/** Prepares read-ahead of a whole group. */
+static int obj_cache_ra_prep(struct obj_cache_grp *grp, struct m0_tl *launch)
+{
+	struct obj_cache_io *io;
+
+	M0_PRE(grp_is_idle(grp));
+
+	io = obj_cache_io_alloc(grp, M0_OC_READ, 1);
+	if (io == NULL)
+		return M0_ERR(-ENOMEM);
+	obj_cache_io_seg_set(io, 0, 0, grp->g_cache->oc_grp_size);
+	grp->g_ra = true;
+	++grp->g_cache->oc_dom->ocd_stats.ocs_ra_nr;
+	obj_cache_io_queue(io, launch);
+	return 0;
+}
+
+/**
+ * Prepares write-back of a dirty group: the whole group when all its blocks
+ * are valid (full-stripe write), its dirty extents otherwise. The group data
+ * are copied, so that the group can be modified while the write is in
+ * flight.
+ */
+static int obj_cache_wb_prep(struct obj_cache_grp *grp, struct m0_tl *launch)
+{
+	struct m0_obj_cache *cache = grp->g_cache;
+	struct obj_cache_io *io;
+	uint32_t             nr = grp_block_nr(cache);
+	uint32_t             shift = cache->oc_bshift;
+	uint32_t             seg_nr = 0;
+	bool                 full = grp->g_valid_nr == nr;
+	size_t               b;
+	size_t               s;
+
+	M0_PRE(grp->g_dirty_nr > 0 && !grp->g_wb);
+
+	if (full)
+		seg_nr = 1;
+	else
+		for (b = 0; b < nr; ++b)
+			seg_nr += grp_block_is_dirty(grp, b) &&
+				  (b == 0 || !grp_block_is_dirty(grp, b - 1));
+	io = obj_cache_io_alloc(grp, M0_OC_WRITE, seg_nr);
+	if (io == NULL)
+		return M0_ERR(-ENOMEM);
+	memcpy(io->io_buf, grp->g_buf, cache->oc_grp_size);
+	if (full) {
+		obj_cache_io_seg_set(io, 0, 0, cache->oc_grp_size);
+	} else {
+		for (seg_nr = 0, b = 0; b < nr; ) {
+			if (!grp_block_is_dirty(grp, b)) {
+				++b;
+				continue;
+			}
+			for (s = b; b < nr && grp_block_is_dirty(grp, b); ++b)
+				;
+			obj_cache_io_seg_set(io, seg_nr++, s << shift,
+					     (b - s) << shift);
+		}
+	}
+	for (b = 0; b < nr; ++b)
+		grp_block_set(grp, b, grp_block_is_valid(grp, b), false);
+	grp->g_wb = true;
+	if (full)
+		++cache->oc_dom->ocd_stats.ocs_flush_full_nr;
+	else
+		++cache->oc_dom->ocd_stats.ocs_flush_part_nr;
+	obj_cache_io_queue(io, launch);
+	return 0;
+}
+
+/** Completes an internal operation. */
+static void obj_cache_io_done(struct obj_cache_io *io, int rc)
+{
+	struct obj_cache_grp *grp = io->io_grp;
+	struct m0_obj_cache  *cache = io->io_cache;
+	uint32_t              shift = cache->oc_bshift;
+	size_t                b;
+	size_t                b0;
+	size_t                b1;
+	uint32_t              i;
+
+	M0_PRE(m0_mutex_is_locked(&cache->oc_dom->ocd_lock));
+	M0_PRE(!io->io_done);
+
+	if (io->io_opcode == M0_OC_READ) {
+		M0_ASSERT(grp->g_ra);
+		/* Blocks written while the read was in flight are newer. */
+		for (b = 0; rc == 0 && b < grp_block_nr(cache); ++b) {
+			if (grp_block_is_valid(grp, b))
+				continue;
+			memcpy(grp->g_buf + (b << shift),
+			       io->io_buf + (b << shift), 1UL << shift);
+			grp_block_set(grp, b, true, false);
+		}
+		grp->g_ra = false;
+	} else {
+		M0_ASSERT(grp->g_wb);
+		if (rc != 0) {
+			M0_LOG(M0_ERROR, "Write-back of group %"PRIu64
+			       " failed: rc=%d", grp->g_index, rc);
+			if (cache->oc_rc == 0)
+				cache->oc_rc = rc;
+			/* Keep the data to retry on the next flush. */
+			for (i = 0; i < io->io_ext.iv_vec.v_nr; ++i) {
+				obj_cache_blocks(cache, io->io_ext.iv_index[i] %
+						 cache->oc_grp_size,
+						 io->io_ext.iv_vec.v_count[i],
+						 &b0, &b1);
+				for (b = b0; b <= b1; ++b)
+					if (grp_block_is_valid(grp, b))
+						grp_block_set(grp, b,
+							      true, true);
+			}
+		}
+		grp->g_wb = false;
+	}
+	io->io_done = true;
+}
+
+static void obj_cache_io_cb(struct m0_op *op)
+{
+	struct obj_cache_io        *io = op->op_datum;
+	struct m0_obj_cache_domain *dom = io->io_cache->oc_dom;
+
+	m0_mutex_lock(&dom->ocd_lock);
+	obj_cache_io_done(io, op->op_rc ?: op->op_sm.sm_rc);
+	m0_mutex_unlock(&dom->ocd_lock);
+}
+
+static const struct m0_op_ops obj_cache_io_cbs = {
+	.oop_executed = NULL,
+	.oop_failed   = obj_cache_io_cb,
+	.oop_stable   = obj_cache_io_cb,
+};
+
+/** Builds and launches prepared operations. Called without the lock. */
+static void obj_cache_ios_launch(struct m0_obj_cache_domain *dom,
+				 struct m0_tl *launch)
+{
+	struct obj_cache_io *io;
+	struct m0_op        *op;
+	int                  rc;
+
+	M0_PRE(!m0_mutex_is_locked(&dom->ocd_lock));
+
+	m0_tl_teardown(oclaunch, launch, io) {
+		op = NULL;
+		rc = m0_obj_op(io->io_cache->oc_obj, io->io_opcode,
+			       &io->io_ext, &io->io_data, &io->io_attr,
+			       0, 0, &op);
+		if (rc == 0) {
+			op->op_datum = io;
+			m0_op_setup(op, &obj_cache_io_cbs, 0);
+			io->io_op = op;
+			m0_op_launch(&op, 1);
+		} else {
+			m0_mutex_lock(&dom->ocd_lock);
+			obj_cache_io_done(io, rc);
+			m0_mutex_unlock(&dom->ocd_lock);
+		}
+	}
+}
+
+/**
+ * Whether the current thread can finalise the operation. Finalisation of
+ * an io operation waits for an AST of its locality, so it cannot be done from
+ * that locality (e.g. when an operation is launched from a callback).
+ */
+static bool obj_cache_io_can_fini(const struct obj_cache_io *io)
+{
+	struct m0_op_common *oc;
+	struct m0_op_obj    *oo;
+
+	if (io->io_op == NULL)
+		return true;
+	oc = bob_of(io->io_op, struct m0_op_common, oc_op, &oc_bobtype);
+	oo = bob_of(oc, struct m0_op_obj, oo_oc, &oo_bobtype);
+	return !m0_sm_group_is_locked(oo->oo_sm_grp);
+}
+
+/**
+ * Finalises completed internal operations of the object. With "wait" set,
+ * also waits for launched operations to complete.
+ */
+static void obj_cache_reap(struct m0_obj_cache *cache, bool wait)
+{
+	struct m0_obj_cache_domain *dom = cache->oc_dom;
+	struct obj_cache_io        *io;
+	struct m0_op               *op;
+
+	while (true) {
+		m0_mutex_lock(&dom->ocd_lock);
+		io = m0_tl_find(ocio, io, &cache->oc_ios,
+				(io->io_done ||
+				 (wait && io->io_op != NULL)) &&
+				obj_cache_io_can_fini(io));
+		if (io != NULL)
+			ocio_tlist_del(io);
+		m0_mutex_unlock(&dom->ocd_lock);
+		if (io == NULL)
+			break;
+		op = io->io_op;
+		if (op != NULL) {
+			m0_op_wait(op, M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+				   M0_TIME_NEVER);
+			m0_mutex_lock(&dom->ocd_lock);
+			/* Launch failures do not invoke callbacks. */
+			if (!io->io_done)
+				obj_cache_io_done(io, op->op_sm.sm_rc ?: -EIO);
+			m0_mutex_unlock(&dom->ocd_lock);
+			m0_op_fini(op);
+			m0_op_free(op);
+		}
+		obj_cache_io_free(io);
+	}
+}
+
+static int obj_cache_hit_cb(struct m0_obj_cache *cache, uint64_t gidx,
+			    m0_bindex_t goff, m0_bcount_t len,
+			    struct m0_bufvec_cursor *cur, void *datum)
+{
+	struct obj_cache_grp *grp = grp_find(cache, gidx);
+	size_t                b;
+	size_t                b0;
+	size_t                b1;
+
+	if (grp == NULL)
+		return -ENOENT;
+	obj_cache_blocks(cache, goff, len, &b0, &b1);
+	for (b = b0; b <= b1; ++b)
+		if (!grp_block_is_valid(grp, b))
+			return -ENOENT;
+	return 0;
+}
+
+static int obj_cache_copyout_cb(struct m0_obj_cache *cache, uint64_t gidx,
+				m0_bindex_t goff, m0_bcount_t len,
+				struct m0_bufvec_cursor *cur, void *datum)
+{
+	struct obj_cache_grp *grp = grp_find(cache, gidx);
+
+	grp_touch(grp);
+	m0_bufvec_cursor_copyto(cur, grp->g_buf + goff, len);
+	return 0;
+}
+
+/** Completes a read from the cache, if all its blocks are valid. */
+static bool obj_cache_serve(struct m0_obj_cache *cache,
+			    const struct m0_indexvec *ext,
+			    struct m0_bufvec *data)
+{
+	if (obj_cache_walk(cache, ext, NULL, &obj_cache_hit_cb, NULL) != 0)
+		return false;
+	obj_cache_walk(cache, ext, data, &obj_cache_copyout_cb, NULL);
+	return true;
+}
+
+/**
+ * Tracks sequential reads and prepares read-ahead of the groups following
+ * a detected stream.
+ */
+static void obj_cache_stream(struct m0_obj_cache *cache,
+			     const struct m0_indexvec *ext,
+			     struct m0_tl *launch)
+{
+	struct m0_obj_cache_domain *dom = cache->oc_dom;
+	struct obj_cache_grp       *grp;
+	uint32_t                    last = ext->iv_vec.v_nr - 1;
+	uint64_t                    gidx;
+	uint64_t                    first;
+
+	if (ext->iv_vec.v_nr == 0)
+		return;
+	if (ext->iv_index[0] == cache->oc_next)
+		++cache->oc_seq_nr;
+	else
+		cache->oc_seq_nr = 0;
+	cache->oc_next = ext->iv_index[last] + ext->iv_vec.v_count[last];
+	if (cache->oc_seq_nr < M0_OBJ_CACHE_SEQ_NR)
+		return;
+	first = cache->oc_next / cache->oc_grp_size;
+	for (gidx = first; gidx < first + dom->ocd_ra_grp_nr; ++gidx) {
+		grp = grp_find(cache, gidx);
+		if (grp != NULL) {
+			if (!grp_is_idle(grp) ||
+			    grp->g_valid_nr == grp_block_nr(cache))
+				continue;
+		} else {
+			if (!obj_cache_reserve(dom, cache->oc_grp_size))
+				break;
+			grp = grp_alloc(cache, gidx);
+			if (grp == NULL)
+				break;
+		}
+		if (obj_cache_ra_prep(grp, launch) != 0)
+			break;
+	}
+}
+
+static int obj_cache_missing_cb(struct m0_obj_cache *cache, uint64_t gidx,
+				m0_bindex_t goff, m0_bcount_t len,
+				struct m0_bufvec_cursor *cur, void *datum)
+{
+	uint32_t *nr = datum;
+	uint64_t  mask = (1ULL << cache->oc_bshift) - 1;
+
+	/* Whole groups are written as full stripes anyway. */
+	if (len == cache->oc_grp_size)
+		return -EFBIG;
+	if (((goff | len) & mask) != 0)
+		return -EINVAL;
+	if (grp_find(cache, gidx) == NULL)
+		++*nr;
+	return 0;
+}
+
+static int obj_cache_alloc_cb(struct m0_obj_cache *cache, uint64_t gidx,
+			      m0_bindex_t goff, m0_bcount_t len,
+			      struct m0_bufvec_cursor *cur, void *datum)
+{
+	if (grp_find(cache, gidx) == NULL && grp_alloc(cache, gidx) == NULL)
+		return M0_ERR(-ENOMEM);
+	return 0;
+}
+
+static int obj_cache_absorb_cb(struct m0_obj_cache *cache, uint64_t gidx,
+			       m0_bindex_t goff, m0_bcount_t len,
+			       struct m0_bufvec_cursor *cur, void *datum)
+{
+	struct obj_cache_grp *grp = grp_find(cache, gidx);
+	struct m0_tl         *launch = datum;
+	size_t                b;
+	size_t                b0;
+	size_t                b1;
+
+	grp_touch(grp);
+	m0_bufvec_cursor_copyfrom(cur, grp->g_buf + goff, len);
+	obj_cache_blocks(cache, goff, len, &b0, &b1);
+	for (b = b0; b <= b1; ++b)
+		grp_block_set(grp, b, true, true);
+	/*
+	 * A fully dirty group is written back at once as a full stripe. If
+	 * this fails, the group is written by the next flush.
+	 */
+	if (grp->g_dirty_nr == grp_block_nr(cache) && !grp->g_wb)
+		obj_cache_wb_prep(grp, launch);
+	return 0;
+}
+
+/**
+ * Copies a block-aligned write into the cache, if it does not cover whole
+ * groups and there is room for it.
+ */
+static bool obj_cache_absorb(struct m0_obj_cache *cache,
+			     const struct m0_indexvec *ext,
+			     struct m0_bufvec *data,
+			     struct m0_tl *launch)
+{
+	struct m0_obj_cache_domain *dom = cache->oc_dom;
+	uint32_t                    nr = 0;
+	uint32_t                    counted;
+
+	/*
+	 * Eviction can drop clean groups of this very write, which were not
+	 * counted as missing. Count again until the reservation covers every
+	 * group to be allocated.
+	 */
+	do {
+		counted = nr;
+		nr = 0;
+		if (obj_cache_walk(cache, ext, NULL,
+				   &obj_cache_missing_cb, &nr) != 0 ||
+		    !obj_cache_reserve(dom, nr * cache->oc_grp_size))
+			return false;
+	} while (nr != counted);
+	if (obj_cache_walk(cache, ext, NULL, &obj_cache_alloc_cb, NULL) != 0)
+		return false;
+	M0_ASSERT(dom->ocd_used <= dom->ocd_budget);
+	obj_cache_walk(cache, ext, data, &obj_cache_absorb_cb, launch);
+	return true;
+}
+
+static int obj_cache_update_cb(struct m0_obj_cache *cache, uint64_t gidx,
+			       m0_bindex_t goff, m0_bcount_t len,
+			       struct m0_bufvec_cursor *cur, void *datum)
+{
+	struct obj_cache_grp *grp = grp_find(cache, gidx);
+	size_t                b;
+	size_t                b0;
+	size_t                b1;
+	bool                  valid;
+
+	if (grp == NULL)
+		return 0;
+	grp_touch(grp);
+	m0_bufvec_cursor_copyfrom(cur, grp->g_buf + goff, len);
+	obj_cache_blocks(cache, goff, len, &b0, &b1);
+	for (b = b0; b <= b1; ++b) {
+		valid = grp_block_is_valid(grp, b) ||
+			obj_cache_block_covered(cache, b, goff, len);
+		/*
+		 * The write may reach the ioservices before an in-flight
+		 * write-back of older data: write the block again.
+		 */
+		grp_block_set(grp, b, valid, grp_block_is_dirty(grp, b) ||
+			      (valid && grp->g_wb));
+	}
+	return 0;
+}
+
+/** Refreshes the cached copy of data written directly. */
+static void obj_cache_update(struct m0_obj_cache *cache,
+			     const struct m0_indexvec *ext,
+			     struct m0_bufvec *data)
+{
+	obj_cache_walk(cache, ext, data, &obj_cache_update_cb, NULL);
+}
+
+static int obj_cache_discard_cb(struct m0_obj_cache *cache, uint64_t gidx,
+				m0_bindex_t goff, m0_bcount_t len,
+				struct m0_bufvec_cursor *cur, void *datum)
+{
+	struct obj_cache_grp *grp = grp_find(cache, gidx);
+	size_t                b;
+	size_t                b0;
+	size_t                b1;
+
+	if (grp == NULL)
+		return 0;
+	/* Freed extents read back as zeroes. */
+	memset(grp->g_buf + goff, 0, len);
+	obj_cache_blocks(cache, goff, len, &b0, &b1);
+	for (b = b0; b <= b1; ++b)
+		if (obj_cache_block_covered(cache, b, goff, len))
+			grp_block_set(grp, b, false, false);
+	return 0;
+}
+
+/** Drops freed extents from the cache. */
+static void obj_cache_discard(struct m0_obj_cache *cache,
+			      const struct m0_indexvec *ext)
+{
+	obj_cache_walk(cache, ext, NULL, &obj_cache_discard_cb, NULL);
+}
+
+static int obj_cache_overlay_cb(struct m0_obj_cache *cache, uint64_t gidx,
+				m0_bindex_t goff, m0_bcount_t len,
+				struct m0_bufvec_cursor *cur, void *datum)
+{
+	struct obj_cache_grp *grp = grp_find(cache, gidx);
+	uint32_t              shift = cache->oc_bshift;
+	m0_bindex_t           start;
+	m0_bindex_t           end;
+	size_t                b;
+	size_t                b0;
+	size_t                b1;
+
+	if (grp == NULL)
+		return 0;
+	obj_cache_blocks(cache, goff, len, &b0, &b1);
+	for (b = b0; b <= b1; ++b) {
+		start = max64u(goff, (m0_bindex_t)b << shift);
+		end   = min64u(goff + len, (m0_bindex_t)(b + 1) << shift);
+		if (grp_block_is_valid(grp, b)) {
+			m0_bufvec_cursor_copyto(cur, grp->g_buf + start,
+						end - start);
+		} else if (obj_cache_block_covered(cache, b, goff, len)) {
+			m0_bufvec_cursor_copyfrom(cur, grp->g_buf + start,
+						  end - start);
+			grp_block_set(grp, b, true, false);
+		} else {
+			m0_bufvec_cursor_move(cur, end - start);
+		}
+	}
+	return 0;
+}
+
+/** Prepares write-back of the groups dirty for longer than the flush age. */
+static void obj_cache_expire(struct m0_obj_cache *cache, m0_time_t now,
+			     struct m0_tl *launch)
+{
+	struct obj_cache_grp *grp;
+
+	m0_tl_for(ocgrp, &cache->oc_grps, grp) {
+		if (grp->g_dirty_nr > 0 && !grp->g_wb &&
+		    m0_time_sub(now, grp->g_dirtied) >=
+		    cache->oc_dom->ocd_flush_age)
+			obj_cache_wb_prep(grp, launch);
+	} m0_tl_endfor;
+}
+
+/**
+ * Prepares write-back of all dirty groups. Returns the number of dirty
+ * groups that have to wait for a write-back in flight.
+ */
+static uint32_t obj_cache_wb_all(struct m0_obj_cache *cache,
+				 struct m0_tl *launch)
+{
+	struct obj_cache_grp *grp;
+	uint32_t              busy = 0;
+
+	m0_tl_for(ocgrp, &cache->oc_grps, grp) {
+		if (grp->g_dirty_nr == 0)
+			continue;
+		if (grp->g_wb)
+			++busy;
+		else if (obj_cache_wb_prep(grp, launch) != 0 &&
+			 cache->oc_rc == 0)
+			cache->oc_rc = M0_ERR(-ENOMEM);
+	} m0_tl_endfor;
+	return busy;
+}
+
+static struct m0_obj_cache *obj_cache_alloc(struct m0_obj_cache_domain *dom,
+					    struct m0_obj *obj,
+					    m0_bcount_t grp_size,
+					    uint32_t bshift)
+{
+	struct m0_obj_cache *cache;
+
+	M0_PRE(grp_size > 0 && grp_size % (1ULL << bshift) == 0);
+
+	M0_ALLOC_PTR(cache);
+	if (cache == NULL)
+		return NULL;
+	cache->oc_dom      = dom;
+	cache->oc_obj      = obj;
+	cache->oc_grp_size = grp_size;
+	cache->oc_bshift   = bshift;
+	cache->oc_next     = M0_BINDEX_MAX;
+	ocgrp_tlist_init(&cache->oc_grps);
+	ocio_tlist_init(&cache->oc_ios);
+	return cache;
+}
+
+static void obj_cache_free(struct m0_obj_cache *cache)
+{
+	struct obj_cache_grp *grp;
+
+	M0_PRE(ocio_tlist_is_empty(&cache->oc_ios));
+
+	m0_mutex_lock(&cache->oc_dom->ocd_lock);
+	while ((grp = ocgrp_tlist_head(&cache->oc_grps)) != NULL)
+		grp_free(grp);
+	m0_mutex_unlock(&cache->oc_dom->ocd_lock);
+	ocio_tlist_fini(&cache->oc_ios);
+	ocgrp_tlist_fini(&cache->oc_grps);
+	m0_free(cache);
+}
+
+static bool obj_cache_is_enabled(struct m0_obj_cache_domain *dom,
+				 struct m0_op_io *ioo)
+{
+	struct m0_op *op = &ioo->ioo_oo.oo_oc.oc_op;
+
+	return dom->ocd_budget != 0 && op->op_parent == NULL &&
+	       op->op_cbs != &obj_cache_io_cbs;
+}
+
+static struct m0_obj_cache *obj_cache_get(struct m0_obj_cache_domain *dom,
+					  struct m0_op_io *ioo)
+{
+	struct m0_obj *obj = ioo->ioo_obj;
+
+	m0_mutex_lock(&dom->ocd_lock);
+	if (obj->ob_cache == NULL)
+		obj->ob_cache = obj_cache_alloc(dom, obj,
+						data_size(pdlayout_get(ioo)),
+						obj->ob_attr.oa_bshift);
+	m0_mutex_unlock(&dom->ocd_lock);
+	return obj->ob_cache;
+}
+
+/** Completes an operation served by the cache. */
+static void obj_cache_op_complete(struct m0_op *op)
+{
+	M0_PRE(m0_sm_group_is_locked(&op->op_sm_group));
+
+	m0_sm_move(&op->op_sm, 0, M0_OS_LAUNCHED);
+	m0_sm_move(&op->op_sm, 0, M0_OS_EXECUTED);
+	m0_op_executed(op);
+	m0_sm_move(&op->op_sm, 0, M0_OS_STABLE);
+	m0_op_stable(op);
+}
+
+M0_INTERNAL void m0__obj_cache_domain_init(struct m0_obj_cache_domain *dom,
+					   const struct m0_config *conf)
+{
+	M0_SET0(dom);
+	m0_mutex_init(&dom->ocd_lock);
+	oclru_tlist_init(&dom->ocd_lru);
+	dom->ocd_budget    = conf->mc_cache_size;
+	dom->ocd_ra_grp_nr = conf->mc_cache_ra_grp_nr ?:
+			     M0_OBJ_CACHE_RA_GRP_NR_DEF;
+	dom->ocd_flush_age = (conf->mc_cache_flush_ms ?:
+			      M0_OBJ_CACHE_FLUSH_MS_DEF) * M0_TIME_ONE_MSEC;
+}
+
+M0_INTERNAL void m0__obj_cache_domain_fini(struct m0_obj_cache_domain *dom)
+{
+	struct m0_obj_cache_stats *st = &dom->ocd_stats;
+
+	if (dom->ocd_budget != 0)
+		M0_LOG(M0_INFO, "hit=%"PRIu64" miss=%"PRIu64" ra=%"PRIu64
+		       " absorb=%"PRIu64" flush=%"PRIu64"/%"PRIu64
+		       " evict=%"PRIu64, st->ocs_hit_nr, st->ocs_miss_nr,
+		       st->ocs_ra_nr, st->ocs_absorb_nr,
+		       st->ocs_flush_full_nr, st->ocs_flush_part_nr,
+		       st->ocs_evict_nr);
+	oclru_tlist_fini(&dom->ocd_lru);
+	m0_mutex_fini(&dom->ocd_lock);
+}
+
+M0_INTERNAL bool m0__obj_cache_launch(struct m0_op_io *ioo)
+{
+	struct m0_op               *op = &ioo->ioo_oo.oo_oc.oc_op;
+	struct m0_obj_cache_domain *dom = &m0__op_instance(op)->m0c_cache;
+	struct m0_obj_cache        *cache;
+	struct m0_tl                launch;
+	bool                        done = false;
+
+	M0_ENTRY("ioo=%p", ioo);
+
+	if (!obj_cache_is_enabled(dom, ioo))
+		goto out;
+	cache = obj_cache_get(dom, ioo);
+	if (cache == NULL)
+		goto out;
+	obj_cache_reap(cache, false);
+
+	oclaunch_tlist_init(&launch);
+	m0_mutex_lock(&dom->ocd_lock);
+	obj_cache_expire(cache, m0_time_now(), &launch);
+	switch (op->op_code) {
+	case M0_OC_READ:
+		done = obj_cache_serve(cache, &ioo->ioo_ext, &ioo->ioo_data);
+		if (done)
+			++dom->ocd_stats.ocs_hit_nr;
+		else
+			++dom->ocd_stats.ocs_miss_nr;
+		obj_cache_stream(cache, &ioo->ioo_ext, &launch);
+		break;
+	case M0_OC_WRITE:
+		done = !ioo->ioo_nocache &&
+		       obj_cache_absorb(cache, &ioo->ioo_ext,
+					&ioo->ioo_data, &launch);
+		if (done)
+			++dom->ocd_stats.ocs_absorb_nr;
+		else
+			obj_cache_update(cache, &ioo->ioo_ext, &ioo->ioo_data);
+		break;
+	case M0_OC_FREE:
+		obj_cache_discard(cache, &ioo->ioo_ext);
+		break;
+	default:
+		M0_IMPOSSIBLE("Unexpected opcode");
+	}
+	m0_mutex_unlock(&dom->ocd_lock);
+	obj_cache_ios_launch(dom, &launch);
+	oclaunch_tlist_fini(&launch);
+
+	if (done)
+		obj_cache_op_complete(op);
+out:
+	M0_LEAVE("done=%d", !!done);
+	return done;
+}
+
+M0_INTERNAL void m0__obj_cache_read_done(struct m0_op_io *ioo)
+{
+	struct m0_op               *op = &ioo->ioo_oo.oo_oc.oc_op;
+	struct m0_obj_cache_domain *dom = &m0__op_instance(op)->m0c_cache;
+	struct m0_obj_cache        *cache = ioo->ioo_obj->ob_cache;
+
+	M0_PRE(op->op_code == M0_OC_READ);
+
+	if (cache == NULL || !obj_cache_is_enabled(dom, ioo))
+		return;
+	m0_mutex_lock(&dom->ocd_lock);
+	obj_cache_walk(cache, &ioo->ioo_ext, &ioo->ioo_data,
+		       &obj_cache_overlay_cb, NULL);
+	m0_mutex_unlock(&dom->ocd_lock);
+}
+
+M0_INTERNAL int m0__obj_cache_flush(struct m0_obj *obj)
+{
+	struct m0_obj_cache        *cache = obj->ob_cache;
+	struct m0_obj_cache_domain *dom;
+	struct m0_tl                launch;
+	uint32_t                    busy;
+	int                         rc;
+
+	M0_ENTRY("obj=%p", obj);
+
+	if (cache == NULL)
+		return M0_RC(0);
+	dom = cache->oc_dom;
+	oclaunch_tlist_init(&launch);
+	do {
+		m0_mutex_lock(&dom->ocd_lock);
+		busy = obj_cache_wb_all(cache, &launch);
+		rc = cache->oc_rc;
+		m0_mutex_unlock(&dom->ocd_lock);
+		obj_cache_ios_launch(dom, &launch);
+		obj_cache_reap(cache, true);
+	} while (busy > 0 && rc == 0);
+	oclaunch_tlist_fini(&launch);
+
+	m0_mutex_lock(&dom->ocd_lock);
+	rc = cache->oc_rc;
+	cache->oc_rc = 0;
+	m0_mutex_unlock(&dom->ocd_lock);
+	return M0_RC(rc);
+}
+
+M0_INTERNAL void m0__obj_cache_fini(struct m0_obj *obj)
+{
+	int rc;
+
+	M0_ENTRY("obj=%p", obj);
+
+	if (obj->ob_cache != NULL) {
+		rc = m0__obj_cache_flush(obj);
+		if (rc != 0)
+			M0_LOG(M0_ERROR, "Write-back failed: rc=%d", rc);
+		obj_cache_reap(obj->ob_cache, true);
+		obj_cache_free(obj->ob_cache);
+		obj->ob_cache = NULL;
+	}
+	M0_LEAVE();
+}
+
+#undef M0_TRACE_SUBSYSTEM
+
+/** @} end of client-cache group */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -0,0 +1,197 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __MOTR_CACHE_H__
+#define __MOTR_CACHE_H__
+
+#include "lib/mutex.h"
+#include "lib/tlist.h"
+#include "lib/time.h"
+#include "lib/types.h"
+
+/**
+ * @defgroup client-cache Client object data cache
+ *
+ * Optional client-side cache of object data, enabled by setting
+ * m0_config::mc_cache_size to a non-zero memory budget.
+ *
+ * Data are cached in units of parity groups: a cached group holds a buffer
+ * of data_size() bytes and two bitmaps with a bit per object block, telling
+ * which blocks hold valid data and which of them were written by the
+ * application and not yet sent to the ioservices (dirty).
+ *
+ * The cache is consulted when an object io operation is launched:
+ *
+ * - a READ whose blocks are all valid is completed from the cache without
+ *   network io. Otherwise it proceeds as usual and, once the data are
+ *   received, valid cached blocks are copied over the reply, so that dirty
+ *   data are never hidden by stale data from the ioservices;
+ *
+ * - READs continuing the previous READ of the same object are counted as a
+ *   sequential stream. Once a stream is detected, the next
+ *   m0_config::mc_cache_ra_grp_nr parity groups are read ahead, each as a
+ *   single full-group operation;
+ *
+ * - a block-aligned WRITE that does not cover a whole parity group is
+ *   absorbed: its data are copied into the cache and the operation completes
+ *   immediately. A group that becomes completely dirty is written back at
+ *   once as a full-stripe write, avoiding read-modify-write. Whole-group
+ *   writes and M0_OOF_SYNC writes go to the ioservices directly and only
+ *   refresh the cached copy;
+ *
+ * - a FREE drops the affected blocks from the cache.
+ *
+ * Remaining dirty data are written back by m0_entity_sync() and m0_obj_fini(),
+ * and when they get older than m0_config::mc_cache_flush_ms (checked when the
+ * object is accessed). A group that is valid in full is written back as a
+ * full stripe, otherwise only its dirty extents are written. Write-back
+ * errors are reported by the next m0_entity_sync().
+ *
+ * Memory used by all cached groups of a client instance is limited by
+ * m0_config::mc_cache_size. Clean idle groups are evicted in LRU order; when
+ * that is not enough, writes bypass the cache and read-ahead is skipped.
+ *
+ * The cache assumes that an object is not concurrently modified through
+ * other client instances. Composite layout sub-objects are not cached.
+ *
+ * Locking: all caches of a client instance are protected by
+ * m0_obj_cache_domain::ocd_lock, which is innermost with respect to the
+ * operation and locality state machine group locks. Internal operations are
+ * built, launched and finalised without the lock held.
+ *
+ * @{
+ */
+
+struct m0_obj;
+struct m0_op_io;
+struct m0_config;
+
+enum {
+	/** Default read-ahead window, in parity groups. */
+	M0_OBJ_CACHE_RA_GRP_NR_DEF = 4,
+	/** Default age of dirty data, after which they are written back. */
+	M0_OBJ_CACHE_FLUSH_MS_DEF  = 5000,
+	/**
+	 * Number of reads continuing the previous read, after which
+	 * read-ahead starts.
+	 */
+	M0_OBJ_CACHE_SEQ_NR        = 1,
+};
+
+struct m0_obj_cache_stats {
+	/** Reads completed from the cache. */
+	uint64_t ocs_hit_nr;
+	/** Reads sent to the ioservices. */
+	uint64_t ocs_miss_nr;
+	/** Parity groups read ahead. */
+	uint64_t ocs_ra_nr;
+	/** Writes absorbed by the cache. */
+	uint64_t ocs_absorb_nr;
+	/** Full-stripe write-backs. */
+	uint64_t ocs_flush_full_nr;
+	/** Partial write-backs. */
+	uint64_t ocs_flush_part_nr;
+	/** Evicted groups. */
+	uint64_t ocs_evict_nr;
+};
+
+/** Per client instance cache state, embedded in m0_client. */
+struct m0_obj_cache_domain {
+	struct m0_mutex           ocd_lock;
+	/** Memory budget, 0 when the cache is disabled. */
+	m0_bcount_t               ocd_budget;
+	/** Memory used by cached groups. */
+	m0_bcount_t               ocd_used;
+	/** Read-ahead window, in parity groups. */
+	uint32_t                  ocd_ra_grp_nr;
+	/** Age of dirty data, after which they are written back. */
+	m0_time_t                 ocd_flush_age;
+	/** All cached groups, most recently used first. */
+	struct m0_tl              ocd_lru;
+	struct m0_obj_cache_stats ocd_stats;
+};
+
+/** Per object cache state, allocated on the first cached operation. */
+struct m0_obj_cache {
+	struct m0_obj_cache_domain *oc_dom;
+	struct m0_obj              *oc_obj;
+	/** Parity group size, data_size() of the object layout. */
+	m0_bcount_t                 oc_grp_size;
+	/** Object block shift, m0_obj_attr::oa_bshift. */
+	uint32_t                    oc_bshift;
+	/** Cached groups of this object. */
+	struct m0_tl                oc_grps;
+	/** Internal read-ahead and write-back operations. */
+	struct m0_tl                oc_ios;
+	/** Offset where the next sequential read is expected. */
+	m0_bindex_t                 oc_next;
+	/** Number of reads that continued the previous one. */
+	uint32_t                    oc_seq_nr;
+	/** First write-back error since the last flush. */
+	int                         oc_rc;
+};
+
+M0_INTERNAL void m0__obj_cache_domain_init(struct m0_obj_cache_domain *dom,
+					   const struct m0_config *conf);
+M0_INTERNAL void m0__obj_cache_domain_fini(struct m0_obj_cache_domain *dom);
+
+/**
+ * Consults the cache when an object io operation is launched.
+ * Called from the launch callback with the operation group locked.
+ *
+ * @retval true the operation has been completed from the cache.
+ * @retval false the operation has to be executed as usual.
+ */
+M0_INTERNAL bool m0__obj_cache_launch(struct m0_op_io *ioo);
+
+/**
+ * Called when the data of a READ operation have been copied to the
+ * application buffers. Overlays valid cached blocks on top of the received
+ * data and fills cached groups with the rest.
+ */
+M0_INTERNAL void m0__obj_cache_read_done(struct m0_op_io *ioo);
+
+/**
+ * Writes back all dirty data of the object and waits for completion.
+ * Returns the first write-back error seen since the previous call.
+ */
+M0_INTERNAL int m0__obj_cache_flush(struct m0_obj *obj);
+
+/** Flushes the object cache and releases it. */
+M0_INTERNAL void m0__obj_cache_fini(struct m0_obj *obj);
+
+/** @} end of client-cache group */
+#endif /* __MOTR_CACHE_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
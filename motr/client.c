@@ -458,6 +458,9 @@ void m0_obj_fini(struct m0_obj *obj)
 	M0_ENTRY();
 	M0_PRE(obj != NULL);
 
+	/* Write back and release cached data, needs the layout. */
+	m0__obj_cache_fini(obj);
+
 	/* Cleanup layout. */
 	if (obj->ob_layout != NULL) {
 		m0_client__layout_put(obj->ob_layout);
@@ -710,13 +713,19 @@ M0_INTERNAL void m0_op_launch_one(struct m0_op *op)
 
 void m0_op_launch(struct m0_op **op, uint32_t nr)
 {
-	int i;
+	struct m0_idx_batch ibatch;
+	int                 i;
 
 	M0_ENTRY();
 	M0_PRE(op != NULL);
 
+	m0__obj_io_merge(op, nr);
+	m0__obj_io_batch(op, nr);
+	m0__idx_op_batch(op, nr, &ibatch);
 	for (i = 0; i < nr; i++)
 		m0_op_launch_one(op[i]);
+	m0__obj_io_merge_launch(op, nr);
+	m0__idx_op_batch_launch(&ibatch);
 
 	M0_LEAVE();
 }
@@ -734,12 +734,15 @@ enum m0_client_layout_type {
  * attributes.
  */
 struct m0_client_layout;
+struct m0_obj_cache;
 struct m0_obj {
 	struct m0_entity          ob_entity;
 	struct m0_obj_attr        ob_attr;
 	struct m0_client_layout  *ob_layout;
 	/** Cookie associated with a RM context */
 	struct m0_cookie   ob_cookie;
+	/** Cached data, if m0_config::mc_cache_size is set. */
+	struct m0_obj_cache      *ob_cache;
 };
 
 struct m0_client_layout {
@@ -858,6 +861,22 @@ struct m0_config {
 	 */
 	bool        mc_is_read_verify;
 
+	/**
+	 * Flag for write merging. Adjacent WRITE operations on an object,
+	 * launched together by m0_op_launch(), are executed as a single
+	 * WRITE when some of them end in the middle of a parity group. This
+	 * turns read-modify-write of such groups into full-stripe writes.
+	 */
+	bool        mc_is_write_merge;
+
+	/**
+	 * Time in microseconds io and CAS fops of the operations launched
+	 * together by m0_op_launch() may wait to be packed into shared rpc
+	 * packets with the fops of each other. 0 sends the fops of each
+	 * operation at once.
+	 */
+	uint32_t    mc_launch_batch_us;
+
 	/**
 	 * Flag to enable/disable addb2 initialization
 	 */
@@ -894,6 +913,22 @@ struct m0_config {
  	 * ADDB size
  	 */
 	m0_bcount_t mc_addb_size;
+
+	/**
+	 * Memory budget of the client object data cache, 0 disables the
+	 * cache. See @ref client-cache.
+	 */
+	m0_bcount_t mc_cache_size;
+	/**
+	 * Read-ahead window of the cache in parity groups, use 0 for
+	 * M0_OBJ_CACHE_RA_GRP_NR_DEF.
+	 */
+	uint32_t    mc_cache_ra_grp_nr;
+	/**
+	 * Age in milliseconds after which dirty cached data are written
+	 * back, use 0 for M0_OBJ_CACHE_FLUSH_MS_DEF.
+	 */
+	uint32_t    mc_cache_flush_ms;
 };
 
 /** The identifier of the root of realm hierarchy. */
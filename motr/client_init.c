@@ -1604,6 +1604,8 @@ int m0_client_init(struct m0_client **m0c_p,
 	/* Init the hash-table for RM contexts */
 	rm_ctx_htable_init(&m0c->m0c_rm_ctxs, M0_RM_HBUCKET_NR);
 
+	m0__obj_cache_domain_init(&m0c->m0c_cache, conf);
+
 	if (conf->mc_is_addb_init) {
 		char buf[64];
 		/* Default client addb record file size set to 128M */
@@ -1650,6 +1652,8 @@ void m0_client_fini(struct m0_client *m0c, bool fini_m0)
 	/* Finalize hash-table for RM contexts */
 	rm_ctx_htable_fini(&m0c->m0c_rm_ctxs);
 
+	m0__obj_cache_domain_fini(&m0c->m0c_cache);
+
 	/* shut down this client instance */
 	m0_sm_group_lock(&m0c->m0c_sm_group);
 
@@ -60,9 +60,12 @@
 #include "motr/idx.h"  /* m0_idx_* */
 #include "motr/pg.h"          /* nwxfer and friends */
 #include "motr/sync.h"        /* sync_request */
+#include "motr/cache.h"       /* m0_obj_cache_domain */
 #include "fop/fop.h"
 
 struct m0_idx_service_ctx;
+struct obj_io_merge;
+struct dix_batch;
 
 #ifdef CLIENT_FOR_M0T1FS
 /**
@@ -225,6 +228,11 @@ struct m0_op_idx {
 	struct dix_req     *oi_dix_req;
 	/** To know dix req in completion callback */
 	bool                oi_in_completion;
+	/**
+	 * Batch of operations launched together, which executes this one,
+	 * or NULL. See m0__idx_op_batch().
+	 */
+	struct dix_batch   *oi_batch;
 };
 
 /**
@@ -263,6 +271,8 @@ struct m0_op_io {
 	uint64_t                          ioo_attr_mask;
 	/** A bit-mask of m0_op_obj_flags. */
 	uint32_t                          ioo_flags;
+	/** The operation bypasses the object data cache (M0_OOF_SYNC). */
+	bool                              ioo_nocache;
 	/** Object's pool version */
 	struct m0_fid                     ioo_pver;
 
@@ -283,6 +293,21 @@ struct m0_op_io {
 	enum m0_pbuf_type                 ioo_pbuf_type;
 	/** Number of pages to read in RMW */
 	uint64_t                          ioo_rmw_read_pages;
+	/** Number of parity groups fully overwritten by a WRITE. */
+	uint64_t                          ioo_fullstripe_grp_nr;
+	/** Number of parity groups a WRITE updates with read-modify-write. */
+	uint64_t                          ioo_rmw_grp_nr;
+	/**
+	 * Merged WRITE executing this operation, or NULL.
+	 * See m0__obj_io_merge().
+	 */
+	struct obj_io_merge              *ioo_merge;
+	/**
+	 * Deadline of io fops, so that the fops of operations launched
+	 * together are packed into shared rpc packets. 0 sends them at once.
+	 * See m0__obj_io_batch().
+	 */
+	m0_time_t                         ioo_fop_deadline;
 
 	/** State machine for this io operation */
 	struct m0_sm                      ioo_sm;
@@ -581,6 +606,9 @@ struct m0_client {
 #endif
 
 	struct m0_htable                        m0c_rm_ctxs;
+
+	/** Object data cache, see @ref client-cache. */
+	struct m0_obj_cache_domain              m0c_cache;
 };
 
 /** CPUs semaphore - to control CPUs usage by parity calcs. */
@@ -927,6 +955,57 @@ M0_INTERNAL int m0__obj_io_build(struct m0_io_args *args,
 				 struct m0_op     **op);
 M0_INTERNAL void m0__obj_op_done(struct m0_op *op);
 
+/**
+ * Looks for runs of adjacent WRITE operations on the same object among the
+ * operations about to be launched, where some operation ends in the middle of
+ * a parity group. Each such run is executed by a single merged WRITE, so that
+ * the groups straddling operation boundaries are written in full once rather
+ * than with read-modify-write by each operation.
+ *
+ * Enabled by m0_config::mc_is_write_merge, unless the object data cache is
+ * enabled. Called by m0_op_launch() before the operations are launched.
+ */
+M0_INTERNAL void m0__obj_io_merge(struct m0_op **op, uint32_t nr);
+
+/**
+ * Gives io operations launched together a common deadline for their io fops,
+ * m0_config::mc_launch_batch_us from now. Rpc formation then packs the fops
+ * going to the same ioservice into shared rpc packets, instead of sending a
+ * packet per operation. Fops are sent before the deadline once enough of
+ * them accumulate for a packet.
+ */
+M0_INTERNAL void m0__obj_io_batch(struct m0_op **op, uint32_t nr);
+
+/**
+ * Launches the merged WRITEs built by m0__obj_io_merge(), once the merged
+ * operations have been launched.
+ */
+M0_INTERNAL void m0__obj_io_merge_launch(struct m0_op **op, uint32_t nr);
+
+/** Index operations launched together, see m0__idx_op_batch(). */
+struct m0_idx_batch {
+	struct m0_idx_query_ops *ib_ops;
+	/** Batch returned by m0_idx_query_ops::iqo_batch(), or NULL. */
+	void                    *ib_batch;
+};
+
+/**
+ * Passes GET, PUT and DEL operations of the same client launched together to
+ * the index service, so that it can execute them as a batch: e.g., look up
+ * the layouts of all the indices at once and send the fops going to the same
+ * service in shared rpc packets. Each operation still completes on its own,
+ * with its own return codes. Called by m0_op_launch() before the operations
+ * are launched.
+ */
+M0_INTERNAL void m0__idx_op_batch(struct m0_op **op, uint32_t nr,
+				  struct m0_idx_batch *batch);
+
+/**
+ * Starts the batch built by m0__idx_op_batch(), once the operations have
+ * been launched.
+ */
+M0_INTERNAL void m0__idx_op_batch_launch(struct m0_idx_batch *batch);
+
 M0_INTERNAL bool m0__is_read_op(struct m0_op *op);
 M0_INTERNAL bool m0__is_update_op(struct m0_op *op);
 
@@ -62,6 +62,139 @@ static int
 composite_extents_scan_sync(struct m0_obj *obj,
 			    struct m0_client_composite_layout *clayout);
 
+/**---------------------------------------------------------------------------*
+ *                     Client COMPOSITE LAYOUT extent map                     *
+ *----------------------------------------------------------------------------*/
+
+static void composite_extmap_fini(struct m0_composite_extmap *map)
+{
+	m0_free0(&map->cxm_segs);
+	m0_free0(&map->cxm_layers);
+	map->cxm_nr = 0;
+	map->cxm_nr_layers = 0;
+	map->cxm_valid = false;
+}
+
+static void composite_extmap_reset(struct m0_composite_extmap *map)
+{
+	composite_extmap_fini(map);
+	map->cxm_valid = true;
+}
+
+/**
+ * Merges the extents of a layer into the map. The layer must have lower
+ * priority than any layer merged before, so its extents only fill the holes
+ * in the map. The extents are sorted by offset, but can overlap.
+ *
+ * Runs in O(map->cxm_nr + number of extents).
+ */
+static int composite_extmap_merge(struct m0_composite_extmap *map,
+				  struct m0_composite_layer *layer,
+				  struct m0_tl *exts)
+{
+	struct m0_composite_layer **layers;
+	struct m0_composite_seg    *segs;
+	struct m0_composite_seg    *old = map->cxm_segs;
+	struct m0_composite_extent *ext;
+	uint32_t                    nr = 0;
+	uint32_t                    i = 0;
+	m0_bindex_t                 start;
+	m0_bindex_t                 end;
+	m0_bindex_t                 done = 0;
+
+	M0_PRE(map->cxm_valid);
+
+	if (cext_tlist_is_empty(exts))
+		return 0;
+	/*
+	 * Every hole filled by an extent ends at the beginning of an old
+	 * segment or at the end of the extent.
+	 */
+	M0_ALLOC_ARR(segs, 2 * map->cxm_nr + cext_tlist_length(exts));
+	M0_ALLOC_ARR(layers, map->cxm_nr_layers + 1);
+	if (segs == NULL || layers == NULL) {
+		m0_free(segs);
+		m0_free(layers);
+		return M0_ERR(-ENOMEM);
+	}
+	memcpy(layers, map->cxm_layers,
+	       map->cxm_nr_layers * sizeof map->cxm_layers[0]);
+	layers[map->cxm_nr_layers] = layer;
+
+	m0_tl_for(cext, exts, ext) {
+		start = max64u(ext->ce_off, done);
+		end = ext->ce_off + ext->ce_len;
+		while (start < end) {
+			while (i < map->cxm_nr && old[i].cs_end <= start)
+				segs[nr++] = old[i++];
+			if (i < map->cxm_nr && old[i].cs_off <= start) {
+				/* Covered by a layer of higher priority. */
+				start = old[i].cs_end;
+				segs[nr++] = old[i++];
+				continue;
+			}
+			segs[nr].cs_off = start;
+			segs[nr].cs_end = i < map->cxm_nr ?
+				min64u(old[i].cs_off, end) : end;
+			segs[nr].cs_layer = map->cxm_nr_layers;
+			start = segs[nr++].cs_end;
+		}
+		done = max64u(done, end);
+	} m0_tl_endfor;
+	while (i < map->cxm_nr)
+		segs[nr++] = old[i++];
+
+	m0_free(map->cxm_segs);
+	m0_free(map->cxm_layers);
+	map->cxm_segs = segs;
+	map->cxm_nr = nr;
+	map->cxm_layers = layers;
+	map->cxm_nr_layers++;
+	return 0;
+}
+
+/** Builds the map from the extent lists of all layers. */
+static int composite_extmap_build(struct m0_client_composite_layout *clayout,
+				  struct m0_composite_extmap *map, bool write)
+{
+	struct m0_composite_layer *layer;
+	int                        rc = 0;
+
+	M0_PRE(m0_mutex_is_locked(&clayout->ccl_lock));
+
+	composite_extmap_reset(map);
+	m0_tl_for(clayer, &clayout->ccl_layers, layer) {
+		rc = composite_extmap_merge(map, layer, write ?
+					    &layer->ccr_wr_exts :
+					    &layer->ccr_rd_exts);
+		if (rc != 0) {
+			composite_extmap_fini(map);
+			break;
+		}
+	} m0_tl_endfor;
+	return M0_RC(rc);
+}
+
+/** Returns the segment covering the offset or NULL. */
+static const struct m0_composite_seg *
+composite_extmap_lookup(const struct m0_composite_extmap *map, m0_bindex_t off)
+{
+	uint32_t lo = 0;
+	uint32_t hi = map->cxm_nr;
+	uint32_t mid;
+
+	/* Find the first segment ending after the offset. */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (map->cxm_segs[mid].cs_end <= off)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo < map->cxm_nr && map->cxm_segs[lo].cs_off <= off ?
+		&map->cxm_segs[lo] : NULL;
+}
+
 static struct layout_dix_req*
 layout_dix_req_alloc(struct m0_sm_group *grp, struct m0_dix_cli *cli,
 		     m0_chan_cb_t cb, struct m0_op_layout *ol)
@@ -489,6 +622,8 @@ static void composite_layout_put(struct m0_client_layout *layout)
 
 	comp = M0_AMB(comp, layout, ccl_layout);
 	m0_mutex_fini(&comp->ccl_lock);
+	composite_extmap_fini(&comp->ccl_rd_map);
+	composite_extmap_fini(&comp->ccl_wr_map);
 
 	/* Teardown extent lists and layer list. */
 	m0_tl_teardown(clayer, &comp->ccl_layers, layer) {
@@ -599,6 +734,7 @@ void m0_composite_layer_del(struct m0_client_layout *layout,
 	layer = m0_tl_find(clayer, layer, &clayout->ccl_layers,
 			   m0_uint128_eq(&layer->ccr_subobj, &subobj_id));
 	if (layer == NULL) {
+		m0_mutex_unlock(&clayout->ccl_lock);
 		M0_LEAVE();
 		return;
 	}
@@ -607,7 +743,12 @@ void m0_composite_layer_del(struct m0_client_layout *layout,
 	m0_tl_teardown(cext, &layer->ccr_wr_exts, ext)
 		m0_free(ext);
 	clayer_tlist_del(layer);
+	clayer_tlink_fini(layer);
+	m0_free(layer);
 	clayout->ccl_nr_layers--;
+	/* Extents of lower priority layers can become visible. */
+	composite_extmap_fini(&clayout->ccl_rd_map);
+	composite_extmap_fini(&clayout->ccl_wr_map);
 	m0_mutex_unlock(&clayout->ccl_lock);
 
 	M0_LEAVE();
@@ -675,43 +816,6 @@ static void composite_sub_io_destroy(struct composite_sub_io *sio_arr,
 	m0_free(sio_arr);
 }
 
-/* Compute the step to advance. */
-static m0_bindex_t get_next_off(struct m0_composite_extent *cexts[], int n)
-{
-	int i;
-	m0_bindex_t next_off;
-
-	next_off = cexts[n]->ce_off + cexts[n]->ce_len;
-	for (i = n - 1; i >= 0; i--) {
-		if (cexts[i] == NULL)
-			continue;
-		if (cexts[i]->ce_off <= next_off )
-			break;
-	}
-	if (i >= 0)
-		next_off = cexts[i]->ce_off;
-
-	return next_off;
-}
-
-/* Advance each layer's extent cursor. */
-static void advance_layers_cursor(struct m0_tl *cext_tlists[],
-				  struct m0_composite_extent *cexts[], int n,
-				  m0_bindex_t off)
-{
-	int i;
-
-	for (i = 0; i < n; i++) {
-		if (cexts[i] == NULL ||
-		    cexts[i]->ce_off + cexts[i]->ce_len > off)
-			continue;
-		cexts[i] = cext_tlist_next(cext_tlists[i], cexts[i]);
-		while (cexts[i] != NULL &&
-		       cexts[i]->ce_off + cexts[i]->ce_len <= off)
-			cexts[i] = cext_tlist_next(cext_tlists[i], cexts[i]);
-	}
-}
-
 /*
  * Divide original IO index vector and buffers according to sub-objects.
  */
@@ -721,85 +825,62 @@ static int composite_io_divide(struct m0_client_composite_layout *clayout,
 			       struct composite_sub_io **out,
 			       int *out_nr_sios)
 {
-	int                                 rc = 0;
-	int                                 i;
-	int                                 nr_subobjs;
-	int                                 valid_subobj_cnt = 0;
-	m0_bindex_t                         off;
-	m0_bcount_t                         len = 0;
-	m0_bindex_t                         next_off;
-	struct m0_ivec_cursor               icursor;
-	struct m0_bufvec_cursor             bcursor;
-	struct composite_sub_io            *sio_arr;
-	struct composite_sub_io_ext        *sio_ext;
-	struct m0_composite_layer          *layer = NULL;
-	struct m0_composite_extent        **cexts;
-	struct m0_tl                      **cext_tlists;
-	struct m0_tl                       *tl;
-
-	nr_subobjs = clayout->ccl_nr_layers;
-	M0_ASSERT(nr_subobjs != 0);
+	int                            rc = 0;
+	int                            i;
+	int                            nr_sios = 0;
+	m0_bindex_t                    off;
+	m0_bcount_t                    len = 0;
+	m0_bindex_t                    next_off;
+	struct m0_ivec_cursor          icursor;
+	struct m0_bufvec_cursor        bcursor;
+	struct composite_sub_io       *sio_arr = NULL;
+	struct composite_sub_io_ext   *sio_ext;
+	struct m0_composite_layer     *layer;
+	struct m0_composite_extmap    *map;
+	const struct m0_composite_seg *seg;
+
+	M0_ASSERT(clayout->ccl_nr_layers != 0);
 	M0_ASSERT(!clayer_tlist_is_empty(&clayout->ccl_layers));
-	M0_ALLOC_ARR(sio_arr, nr_subobjs);
-	M0_ALLOC_ARR(cext_tlists, nr_subobjs);
-	M0_ALLOC_ARR(cexts, nr_subobjs);
-	if (sio_arr == NULL || cext_tlists == NULL || cexts == NULL) {
-		m0_free(sio_arr);
-		m0_free(cext_tlists);
-		m0_free(cexts);
-		return M0_ERR(-ENOMEM);
-	}
 
-	for (i = 0; i < nr_subobjs; i++) {
-		layer = (i == 0) ?
-		     clayer_tlist_head(&clayout->ccl_layers) :
-		     clayer_tlist_next(&clayout->ccl_layers, layer);
-		tl = (opcode == M0_OC_READ)?
-		     &layer->ccr_rd_exts: &layer->ccr_wr_exts;
-
-		/* Only those layers with extents are considered valid. */
-		if (cext_tlist_is_empty(tl))
-			continue;
-
-		/* Initialise subobj IO. */
-		cext_tlists[valid_subobj_cnt] = tl;
-		cexts[valid_subobj_cnt] = cext_tlist_head(tl);
-		sio_ext_tlist_init(&sio_arr[valid_subobj_cnt].si_exts);
-		sio_arr[valid_subobj_cnt].si_id = layer->ccr_subobj;
-		sio_arr[valid_subobj_cnt].si_lid = layer->ccr_lid;
-		valid_subobj_cnt++;
+	map = opcode == M0_OC_READ ?
+	      &clayout->ccl_rd_map : &clayout->ccl_wr_map;
+	m0_mutex_lock(&clayout->ccl_lock);
+	if (!map->cxm_valid) {
+		rc = composite_extmap_build(clayout, map,
+					    opcode != M0_OC_READ);
+		if (rc != 0)
+			goto err;
+	}
+	/* Only those layers with extents are considered valid. */
+	nr_sios = map->cxm_nr_layers;
+	M0_ASSERT(nr_sios != 0);
+	M0_ALLOC_ARR(sio_arr, nr_sios);
+	if (sio_arr == NULL) {
+		rc = M0_ERR(-ENOMEM);
+		goto err;
+	}
+	for (i = 0; i < nr_sios; i++) {
+		layer = map->cxm_layers[i];
+		sio_ext_tlist_init(&sio_arr[i].si_exts);
+		sio_arr[i].si_id = layer->ccr_subobj;
+		sio_arr[i].si_lid = layer->ccr_lid;
 	}
-	M0_ASSERT(valid_subobj_cnt != 0);
 
 	m0_ivec_cursor_init(&icursor, ext);
 	m0_bufvec_cursor_init(&bcursor, data);
 
-	/*
-	 * Skip the first few extents whose end is less than the offset
-	 * of IO range as they are certainly not in the range.
-	 */
-	off = m0_ivec_cursor_index(&icursor);
-	advance_layers_cursor(cext_tlists, cexts, valid_subobj_cnt, off);
-
 	while (!m0_ivec_cursor_move(&icursor, len) &&
 	       !m0_bufvec_cursor_move(&bcursor, len)) {
 		off = m0_ivec_cursor_index(&icursor);
 		len = m0_ivec_cursor_step(&icursor);
 
 		/*
-		 * Naive search for an extent covering the offset. Note that
-		 * layers are sorted in priority order and extents are sorted
-		 * in offset order in a layer. It is considered an assert if
-		 * there is no sub-object covering the offset.
+		 * It is considered an assert if there is no sub-object
+		 * covering the offset.
 		 */
-		for (i = 0; i < valid_subobj_cnt; i++)
-			if (cexts[i] != NULL && off >= cexts[i]->ce_off)
-				break;
-		M0_ASSERT(i < valid_subobj_cnt);
-
-		next_off = get_next_off(cexts, i);
-		if (next_off > off + len)
-			next_off = off + len;
+		seg = composite_extmap_lookup(map, off);
+		M0_ASSERT(seg != NULL);
+		next_off = min64u(seg->cs_end, off + len);
 		len = next_off - off;
 
 		/* Create a new IO extent. */
@@ -808,22 +889,19 @@ static int composite_io_divide(struct m0_client_composite_layout *clayout,
 			rc = M0_ERR(-ENOMEM);
 			goto err;
 		}
+		i = seg->cs_layer;
 		sio_ext->sie_off = off;
 		sio_ext->sie_len = len;
 		sio_ext->sie_buf = m0_bufvec_cursor_addr(&bcursor);
 		sio_arr[i].si_nr_exts++;
 		sio_ext_tlink_init_at(sio_ext, &sio_arr[i].si_exts);
-
-		advance_layers_cursor(cext_tlists, cexts, valid_subobj_cnt,
-				      next_off);
 	}
 	*out = sio_arr;
-	*out_nr_sios = valid_subobj_cnt;
+	*out_nr_sios = nr_sios;
  err:
-	m0_free(cext_tlists);
-	m0_free(cexts);
-	if (rc != 0)
-		composite_sub_io_destroy(sio_arr, nr_subobjs);
+	m0_mutex_unlock(&clayout->ccl_lock);
+	if (rc != 0 && sio_arr != NULL)
+		composite_sub_io_destroy(sio_arr, nr_sios);
 
 	return M0_RC(rc);
 }
@@ -1515,19 +1593,29 @@ static int
 composite_extents_scan_sync(struct m0_obj *obj,
 			    struct m0_client_composite_layout *clayout)
 {
-	int                               rc = 0;
+	int                        rc = 0;
 	struct m0_composite_layer *layer;
 
+	m0_mutex_lock(&clayout->ccl_lock);
+	composite_extmap_reset(&clayout->ccl_rd_map);
+	composite_extmap_reset(&clayout->ccl_wr_map);
+	m0_mutex_unlock(&clayout->ccl_lock);
 	m0_tl_for(clayer, &clayout->ccl_layers, layer) {
-		/* Query and update write extent list. */
-		rc = composite_layer_idx_scan(layer, true);
-		if (rc != 0) {
-			composite_layout_put(&clayout->ccl_layout);
-			return M0_ERR(rc);
+		/*
+		 * Query and update write and read extent lists. Layers are
+		 * scanned in priority order, so each of them is merged into
+		 * the extent maps as soon as its extents are loaded.
+		 */
+		rc = composite_layer_idx_scan(layer, true)?:
+		     composite_layer_idx_scan(layer, false);
+		if (rc == 0) {
+			m0_mutex_lock(&clayout->ccl_lock);
+			rc = composite_extmap_merge(&clayout->ccl_wr_map, layer,
+						    &layer->ccr_wr_exts)?:
+			     composite_extmap_merge(&clayout->ccl_rd_map, layer,
+						    &layer->ccr_rd_exts);
+			m0_mutex_unlock(&clayout->ccl_lock);
 		}
-
-		/* Query and update read extent list. */
-		rc = composite_layer_idx_scan(layer, false);
 		if (rc != 0) {
 			composite_layout_put(&clayout->ccl_layout);
 			return M0_ERR(rc);
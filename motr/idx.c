@@ -141,6 +141,7 @@ static int idx_op_init(struct m0_idx *idx, int opcode,
 	oi->oi_vals = vals;
 	oi->oi_rcs  = rcs;
 	oi->oi_flags = flags;
+	oi->oi_batch = NULL;
 
 	locality = m0__locality_pick(oi_instance(oi));
 	M0_ASSERT(locality != NULL);
@@ -487,6 +488,64 @@ int m0_idx_op(struct m0_idx       *idx,
 }
 M0_EXPORTED(m0_idx_op);
 
+/**
+ * Returns the index operation, if it can be executed in a batch with other
+ * operations launched together, see m0__idx_op_batch().
+ */
+static struct m0_op_idx *idx_op_batchable(struct m0_op *op)
+{
+	struct m0_op_common *oc;
+
+	if (op->op_entity == NULL || op->op_entity->en_type != M0_ET_IDX ||
+	    !M0_IN(op->op_code, (M0_IC_GET, M0_IC_PUT, M0_IC_DEL)) ||
+	    op->op_sm.sm_state != M0_OS_INITIALISED)
+		return NULL;
+	oc = M0_AMB(oc, op, oc_op);
+	return bob_of(oc, struct m0_op_idx, oi_oc, &oi_bobtype);
+}
+
+M0_INTERNAL void m0__idx_op_batch(struct m0_op **op, uint32_t nr,
+				  struct m0_idx_batch *batch)
+{
+	struct m0_idx_query_ops  *query_ops;
+	struct m0_op_idx        **oi;
+	struct m0_op_idx         *o;
+	struct m0_client         *m0c = NULL;
+	uint32_t                  k = 0;
+	uint32_t                  i;
+
+	M0_PRE(op != NULL);
+
+	M0_SET0(batch);
+	if (nr < 2 || m0_count(j, nr, idx_op_batchable(op[j]) != NULL) < 2)
+		return;
+	M0_ALLOC_ARR(oi, nr);
+	if (oi == NULL)
+		/* Not fatal, the operations are executed one by one. */
+		return;
+	for (i = 0; i < nr; ++i) {
+		o = idx_op_batchable(op[i]);
+		if (o == NULL)
+			continue;
+		if (m0c == NULL)
+			m0c = oi_instance(o);
+		if (oi_instance(o) == m0c)
+			oi[k++] = o;
+	}
+	query_ops = m0c->m0c_idx_svc_ctx.isc_service->is_query_ops;
+	if (k > 1 && query_ops->iqo_batch != NULL) {
+		batch->ib_ops   = query_ops;
+		batch->ib_batch = query_ops->iqo_batch(oi, k);
+	}
+	m0_free(oi);
+}
+
+M0_INTERNAL void m0__idx_op_batch_launch(struct m0_idx_batch *batch)
+{
+	if (batch->ib_batch != NULL)
+		batch->ib_ops->iqo_batch_launch(batch->ib_batch);
+}
+
 /**
  * Sets an entity operation to create or delete an index.
  *
@@ -134,6 +134,16 @@ struct m0_idx_query_ops {
 	int  (*iqo_put)(struct m0_op_idx *oi);
 	int  (*iqo_del)(struct m0_op_idx *oi);
 	int  (*iqo_next)(struct m0_op_idx *oi);
+
+	/*
+	 * Batches, optional. iqo_batch() is called with GET, PUT and DEL
+	 * operations that m0_op_launch() is about to launch together. It
+	 * returns a batch executing them, or NULL if they are to be executed
+	 * one by one. iqo_batch_launch() is called once all the operations
+	 * have been launched. See m0__idx_op_batch().
+	 */
+	void *(*iqo_batch)(struct m0_op_idx **oi, uint32_t nr);
+	void  (*iqo_batch_launch)(void *batch);
 };
 
 /** Initialisation and finalisation functions for an index service. */
@@ -86,12 +86,47 @@ struct dix_req {
 	 * It's true for M0_IC_LOOKUP and M0_IC_LIST operations.
 	 */
 	bool                     idr_meta;
+	/**
+	 * Index layout found by the batch executing the operation, see
+	 * dix_batch. DIX_LTYPE_UNKNOWN otherwise.
+	 */
+	struct m0_dix_layout     idr_layout;
+};
+
+/**
+ * GET, PUT and DEL operations on distributed indices launched together.
+ *
+ * Layouts of all the indices are looked up by a single meta-request, rather
+ * than by a meta-request per operation. Then DIX requests of all the
+ * operations are started at once, with a common CAS fop deadline
+ * m0_config::mc_launch_batch_us ahead, so that rpc formation packs the CAS
+ * fops going to the same CAS service into shared rpc packets.
+ *
+ * A CAS fop carries records of a single catalogue, so fops of different
+ * indices are not merged, only packed. Each operation completes on its own,
+ * with its own return codes.
+ */
+struct dix_batch {
+	struct m0_sm_group      *db_grp;
+	struct m0_dix_cli       *db_dixc;
+	/** Time CAS fops may wait to be packed, in microseconds. */
+	uint32_t                 db_us;
+	/** Requests of the operations launched successfully. */
+	struct dix_req         **db_reqs;
+	uint32_t                 db_nr;
+	/** Number of operations in the batch, size of db_reqs. */
+	uint32_t                 db_max;
+	/** Meta-request looking up the layouts of all the indices. */
+	struct m0_dix_meta_req   db_mreq;
+	struct m0_clink          db_clink;
+	struct m0_sm_ast         db_ast;
 };
 
 static bool dixreq_clink_cb(struct m0_clink *cl);
 static bool dix_meta_req_clink_cb(struct m0_clink *cl);
 static void dix_req_immed_failure(struct dix_req *req, int rc);
 static void dixreq_completed_post(struct dix_req *req, int rc);
+static void dix_batch_add(struct dix_batch *db, struct dix_req *req);
 
 static bool idx_is_distributed(const struct m0_op_idx *oi)
 {
@@ -633,6 +668,8 @@ static void dix_req_destroy(struct dix_req *req)
 	M0_ENTRY();
 	m0_clink_fini(&req->idr_clink);
 	m0_bufvec_free(&req->idr_start_key);
+	if (req->idr_layout.dl_type == DIX_LTYPE_DESCR)
+		m0_dix_ldesc_fini(&req->idr_layout.u.dl_desc);
 	if (idx_is_distributed(req->idr_oi)) {
 		if (req->idr_meta)
 			m0_dix_meta_req_fini(&req->idr_mreq);
@@ -839,7 +876,10 @@ static void dix_req_exec(struct dix_req  *req,
 	M0_ENTRY();
 	req->idr_ast.sa_cb = exec_fn;
 	req->idr_ast.sa_datum = req;
-	m0_sm_ast_post(req->idr_oi->oi_sm_grp, &req->idr_ast);
+	if (req->idr_oi->oi_batch != NULL)
+		dix_batch_add(req->idr_oi->oi_batch, req);
+	else
+		m0_sm_ast_post(req->idr_oi->oi_sm_grp, &req->idr_ast);
 	M0_LEAVE();
 }
 
@@ -934,6 +974,8 @@ static void dix_dreq_prepare(struct dix_req   *req,
 			     struct m0_op_idx *oi)
 {
 	dix_build(oi, dix);
+	/* Copied by m0_dix_put() and friends. */
+	dix->dd_layout = req->idr_layout;
 	m0_clink_add(&req->idr_dreq.dr_sm.sm_chan, &req->idr_clink);
 }
 
@@ -1198,6 +1240,164 @@ static int dix_next(struct m0_op_idx *oi)
 	return 1;
 }
 
+static void dix_batch_fini(struct dix_batch *db)
+{
+	m0_free(db->db_reqs);
+	m0_free(db);
+}
+
+static void *dix_batch_init(struct m0_op_idx **oi, uint32_t nr)
+{
+	struct dix_batch *db;
+	uint32_t          i;
+
+	/* Operations on non-distributed indices are not batched. */
+	if (m0_count(j, nr, idx_is_distributed(oi[j])) < 2)
+		return NULL;
+	M0_ALLOC_PTR(db);
+	if (db == NULL)
+		return NULL;
+	M0_ALLOC_ARR(db->db_reqs, nr);
+	if (db->db_reqs == NULL) {
+		m0_free(db);
+		return NULL;
+	}
+	db->db_max = nr;
+	for (i = 0; i < nr; ++i) {
+		if (!idx_is_distributed(oi[i]))
+			continue;
+		if (db->db_grp == NULL) {
+			db->db_grp  = oi[i]->oi_sm_grp;
+			db->db_dixc = op_dixc(oi[i]);
+			db->db_us   = m0__op_instance(&oi[i]->oi_oc.oc_op)->
+					m0c_config->mc_launch_batch_us;
+		}
+		/* All requests of the batch are executed in the same group. */
+		oi[i]->oi_sm_grp = db->db_grp;
+		oi[i]->oi_batch  = db;
+	}
+	return db;
+}
+
+/**
+ * Adds the request of a launched operation to the batch. Operations are
+ * launched by a single thread, before the batch is started.
+ */
+static void dix_batch_add(struct dix_batch *db, struct dix_req *req)
+{
+	M0_PRE(db->db_nr < db->db_max);
+	db->db_reqs[db->db_nr++] = req;
+}
+
+/** Starts the requests added to the batch and finalises the batch. */
+static void dix_batch_start(struct dix_batch *db)
+{
+	struct dix_req *req;
+	m0_time_t       deadline = 0;
+	uint32_t        i;
+
+	if (db->db_us != 0)
+		deadline = m0_time_from_now(0, db->db_us * 1000ULL);
+	for (i = 0; i < db->db_nr; ++i) {
+		req = db->db_reqs[i];
+		if (req == NULL)
+			continue;
+		req->idr_oi->oi_batch = NULL;
+		req->idr_dreq.dr_deadline = deadline;
+		req->idr_ast.sa_cb(db->db_grp, &req->idr_ast);
+	}
+	dix_batch_fini(db);
+}
+
+static void dix_batch_layouts_ast(struct m0_sm_group *grp,
+				  struct m0_sm_ast   *ast)
+{
+	struct dix_batch       *db = ast->sa_datum;
+	struct m0_dix_meta_req *mreq = &db->db_mreq;
+	struct dix_req         *req;
+	uint32_t                i;
+	int                     rc;
+
+	M0_ENTRY("db=%p", db);
+	/*
+	 * If the meta-request failed as a whole, the requests look up their
+	 * layouts themselves and report errors as usual.
+	 */
+	if (m0_dix_meta_generic_rc(mreq) == 0) {
+		M0_ASSERT(m0_dix_meta_req_nr(mreq) == db->db_nr);
+		for (i = 0; i < db->db_nr; ++i) {
+			req = db->db_reqs[i];
+			rc = m0_dix_layout_rep_get(mreq, i, &req->idr_layout);
+			if (rc != 0) {
+				/* E.g. -ENOENT for non-existing index. */
+				M0_SET0(&req->idr_layout);
+				dixreq_completed_post(req, rc);
+				db->db_reqs[i] = NULL;
+			}
+		}
+	}
+	m0_dix_meta_req_fini(mreq);
+	dix_batch_start(db);
+	M0_LEAVE();
+}
+
+static bool dix_batch_clink_cb(struct m0_clink *cl)
+{
+	struct dix_batch *db = M0_AMB(db, cl, db_clink);
+
+	m0_clink_del(cl);
+	m0_clink_fini(cl);
+	db->db_ast.sa_cb = dix_batch_layouts_ast;
+	db->db_ast.sa_datum = db;
+	m0_sm_ast_post(db->db_grp, &db->db_ast);
+	return true;
+}
+
+static void dix_batch_launch_ast(struct m0_sm_group *grp,
+				 struct m0_sm_ast   *ast)
+{
+	struct dix_batch *db = ast->sa_datum;
+	struct m0_fid    *fids;
+	uint32_t          i;
+	int               rc;
+
+	M0_ENTRY("db=%p nr=%"PRIu32, db, db->db_nr);
+	if (db->db_nr == 0) {
+		dix_batch_fini(db);
+		M0_LEAVE();
+		return;
+	}
+	M0_ALLOC_ARR(fids, db->db_nr);
+	if (fids == NULL) {
+		dix_batch_start(db);
+		M0_LEAVE();
+		return;
+	}
+	for (i = 0; i < db->db_nr; ++i)
+		fids[i] = *OI_IFID(db->db_reqs[i]->idr_oi);
+	m0_dix_meta_req_init(&db->db_mreq, db->db_dixc, db->db_grp);
+	m0_clink_init(&db->db_clink, dix_batch_clink_cb);
+	m0_clink_add_lock(&db->db_mreq.dmr_chan, &db->db_clink);
+	rc = m0_dix_layout_get(&db->db_mreq, fids, db->db_nr);
+	if (rc != 0) {
+		m0_clink_del_lock(&db->db_clink);
+		m0_clink_fini(&db->db_clink);
+		m0_dix_meta_req_fini(&db->db_mreq);
+		dix_batch_start(db);
+	}
+	m0_free(fids);
+	M0_LEAVE();
+}
+
+static void dix_batch_launch(void *batch)
+{
+	struct dix_batch *db = batch;
+
+	db->db_ast.sa_cb = dix_batch_launch_ast;
+	db->db_ast.sa_datum = db;
+	m0_sm_ast_post(db->db_grp, &db->db_ast);
+}
+
 static struct m0_idx_query_ops dix_query_ops = {
 	.iqo_namei_create = dix_index_create,
 	.iqo_namei_delete = dix_index_delete,
@@ -1208,6 +1408,9 @@ static struct m0_idx_query_ops dix_query_ops = {
 	.iqo_put          = dix_put,
 	.iqo_del          = dix_del,
 	.iqo_next         = dix_next,
+
+	.iqo_batch        = dix_batch_init,
+	.iqo_batch_launch = dix_batch_launch,
 };
 
 /*--------------------------------------------------------------------------*
@@ -239,6 +239,15 @@ static void addb2_add_ioo_attrs(const struct m0_op_io *ioo,
 	M0_ADDB2_ADD(M0_AVI_ATTR, ioid, M0_AVI_IOO_ATTR_BUFS_ALIGNED,
 		     (int)addr_is_network_aligned(ioo->ioo_data.ov_buf[0]));
 	M0_ADDB2_ADD(M0_AVI_ATTR, ioid, M0_AVI_IOO_ATTR_RMW, rmw);
+	if (ioo->ioo_oo.oo_oc.oc_op.op_code == M0_OC_WRITE) {
+		M0_ADDB2_ADD(M0_AVI_ATTR, ioid, M0_AVI_IOO_ATTR_FULLSTRIPE_NR,
+			     ioo->ioo_fullstripe_grp_nr);
+		M0_ADDB2_ADD(M0_AVI_ATTR, ioid, M0_AVI_IOO_ATTR_RMW_NR,
+			     ioo->ioo_rmw_grp_nr);
+		M0_LOG(M0_DEBUG, "ioo %p: %"PRIu64" full-stripe, %"PRIu64
+		       " rmw groups", ioo, ioo->ioo_fullstripe_grp_nr,
+		       ioo->ioo_rmw_grp_nr);
+	}
 }
 
 /**
@@ -275,6 +284,16 @@ static void obj_io_cb_launch(struct m0_op_common *oc)
 	cinst = m0__op_instance(op);
 	M0_PRE(cinst!= NULL);
 
+	/* Executed by a merged WRITE, see m0__obj_io_merge_launch(). */
+	if (ioo->ioo_merge != NULL) {
+		m0_sm_move(&op->op_sm, 0, M0_OS_LAUNCHED);
+		goto end;
+	}
+
+	/* Completed from the object data cache? */
+	if (m0__obj_cache_launch(ioo))
+		goto end;
+
 	play = pdlayout_get(ioo);
 
 	if (should_allocate_paritybuf(op, cinst, ioo))
@@ -420,6 +439,8 @@ static void obj_io_ast_fini(struct m0_sm_group *grp,
 	M0_LEAVE();
 }
 
+static void obj_io_merge_put(struct obj_io_merge *merge);
+
 /**
  * Callback for an IO operation being finalised.
  * This causes iofops et al to be freed.
@@ -459,6 +480,9 @@ static void obj_io_cb_fini(struct m0_op_common *oc)
 	m0_clink_fini(&w);
 	m0_chan_fini_lock(&ioo->ioo_completion);
 
+	if (ioo->ioo_merge != NULL)
+		obj_io_merge_put(ioo->ioo_merge);
+
 	/* Finalise the bob type */
 	m0_op_io_bob_fini(ioo);
 
@@ -556,6 +580,7 @@ static int obj_io_init(struct m0_obj      *obj,
 	ioo->ioo_sns_state = SRS_UNINITIALIZED;
 	ioo->ioo_ext = *ext;
 	ioo->ioo_flags = flags;
+	ioo->ioo_nocache = !!(flags & M0_OOF_SYNC);
 	ioo->ioo_flags |= M0_OOF_SYNC;
 	if (M0_IN(opcode, (M0_OC_READ, M0_OC_WRITE))) {
 		ioo->ioo_data = *data;
@@ -806,6 +831,349 @@ exit:
 }
 M0_EXPORTED(m0_obj_op);
 
+/**
+ * A WRITE executing a run of adjacent WRITE operations launched together,
+ * see m0__obj_io_merge().
+ */
+struct obj_io_merge {
+	/** The merged operation. */
+	struct m0_op       *om_op;
+	/** Operations executed by om_op, in the order of offsets. */
+	struct m0_op      **om_ops;
+	uint32_t            om_nr;
+	/** Concatenated extents and buffers of om_ops[]. */
+	struct m0_indexvec  om_ext;
+	struct m0_bufvec    om_data;
+	/**
+	 * Copies of the attributes of om_ops[], one element per om_data
+	 * segment, see obj_io_merge_attr_add().
+	 */
+	struct m0_bufvec    om_attr;
+	/**
+	 * Number of operations from om_ops[] not finalised yet, plus one
+	 * while om_op is being launched.
+	 */
+	struct m0_atomic64  om_ref;
+	/** om_ops[] have been completed, protected by om_op group lock. */
+	bool                om_done;
+};
+
+/** Returns the io operation for "op", NULL if "op" is not an object io. */
+static struct m0_op_io *obj_io_of(struct m0_op *op)
+{
+	struct m0_op_common *oc;
+	struct m0_op_obj    *oo;
+
+	if (op->op_entity == NULL || op->op_entity->en_type != M0_ET_OBJ ||
+	    !M0_IN(op->op_code, (M0_OC_READ, M0_OC_WRITE, M0_OC_FREE)))
+		return NULL;
+	oc = bob_of(op, struct m0_op_common, oc_op, &oc_bobtype);
+	/* Composite layout operations have their own vtable. */
+	if (oc->oc_cb_launch != obj_io_cb_launch)
+		return NULL;
+	oo = bob_of(oc, struct m0_op_obj, oo_oc, &oo_bobtype);
+	return bob_of(oo, struct m0_op_io, ioo_oo, &ioo_bobtype);
+}
+
+/**
+ * Returns the io operation for "op" if it can be merged with its
+ * neighbours, NULL otherwise.
+ */
+static struct m0_op_io *obj_io_merge_ioo(struct m0_op *op)
+{
+	struct m0_op_io  *ioo = obj_io_of(op);
+	struct m0_client *cinst;
+
+	if (ioo == NULL || op->op_code != M0_OC_WRITE ||
+	    ioo->ioo_merge != NULL || op->op_parent != NULL ||
+	    op->op_sm.sm_state != M0_OS_INITIALISED)
+		return NULL;
+	cinst = m0__op_instance(op);
+	/* The object data cache coalesces partial writes on its own. */
+	if (!cinst->m0c_config->mc_is_write_merge ||
+	    cinst->m0c_cache.ocd_budget != 0)
+		return NULL;
+	return ioo;
+}
+
+static m0_bindex_t obj_io_end(const struct m0_op_io *ioo)
+{
+	const struct m0_indexvec *ext = &ioo->ioo_ext;
+
+	return seg_endpos(ext, ext->iv_vec.v_nr - 1);
+}
+
+static bool obj_io_merge_adjacent(const struct m0_op_io *prev,
+				  const struct m0_op_io *next)
+{
+	return prev->ioo_obj == next->ioo_obj &&
+	       prev->ioo_nocache == next->ioo_nocache &&
+	       prev->ioo_attr_mask == next->ioo_attr_mask &&
+	       m0_fid_eq(&prev->ioo_pver, &next->ioo_pver) &&
+	       obj_io_end(prev) == next->ioo_ext.iv_index[0];
+}
+
+static void obj_io_merge_free(struct obj_io_merge *merge)
+{
+	m0_bufvec_free(&merge->om_attr);
+	m0_bufvec_free2(&merge->om_data);
+	m0_indexvec_free(&merge->om_ext);
+	m0_free(merge->om_ops);
+	m0_free(merge);
+}
+
+/**
+ * Completes the merged operations with the result of the merged WRITE.
+ * Called with the group of the merged WRITE locked.
+ */
+static void obj_io_merge_done(struct obj_io_merge *merge, int rc)
+{
+	struct m0_op *op;
+	uint32_t      i;
+
+	M0_PRE(m0_sm_group_is_locked(&merge->om_op->op_sm_group));
+	M0_PRE(!merge->om_done);
+
+	merge->om_done = true;
+	for (i = 0; i < merge->om_nr; ++i) {
+		op = merge->om_ops[i];
+		m0_sm_group_lock(&op->op_sm_group);
+		/* Could have failed to launch. */
+		if (op->op_sm.sm_state == M0_OS_LAUNCHED) {
+			op->op_rc = rc;
+			m0_sm_move(&op->op_sm, 0, M0_OS_EXECUTED);
+			m0_op_executed(op);
+			m0_sm_move(&op->op_sm, 0, M0_OS_STABLE);
+			m0_op_stable(op);
+		}
+		m0_sm_group_unlock(&op->op_sm_group);
+	}
+}
+
+static void obj_io_merge_cb_stable(struct m0_op *op)
+{
+	obj_io_merge_done(op->op_datum, op->op_rc);
+}
+
+static void obj_io_merge_cb_failed(struct m0_op *op)
+{
+	obj_io_merge_done(op->op_datum, op->op_sm.sm_rc ?: op->op_rc);
+}
+
+static const struct m0_op_ops obj_io_merge_cbs = {
+	.oop_executed = NULL,
+	.oop_stable   = obj_io_merge_cb_stable,
+	.oop_failed   = obj_io_merge_cb_failed,
+};
+
+/** Releases a reference to the merged WRITE, taken by a merged operation. */
+static void obj_io_merge_put(struct obj_io_merge *merge)
+{
+	struct m0_op *op = merge->om_op;
+
+	if (!m0_atomic64_dec_and_test(&merge->om_ref))
+		return;
+	if (op->op_sm.sm_state != M0_OS_INITIALISED)
+		m0_op_wait(op, M0_BITS(M0_OS_STABLE, M0_OS_FAILED),
+			   M0_TIME_NEVER);
+	m0_op_fini(op);
+	m0_op_free(op);
+	obj_io_merge_free(merge);
+}
+
+/**
+ * Appends the attributes of "ioo" to the attributes of a merged WRITE, starting
+ * at the element *pos, one element per data segment of "ioo".
+ *
+ * The attributes are copied with their sizes. A data segment without an
+ * attribute element gets a 1-byte zeroed one, which is what applications
+ * pass when they have no attributes.
+ */
+static int obj_io_merge_attr_add(struct m0_bufvec *attr, uint32_t *pos,
+				 const struct m0_op_io *ioo)
+{
+	const struct m0_bufvec *src = &ioo->ioo_attr;
+	m0_bcount_t             size;
+	uint32_t                j;
+
+	M0_PRE(*pos + ioo->ioo_data.ov_vec.v_nr <= attr->ov_vec.v_nr);
+	for (j = 0; j < ioo->ioo_data.ov_vec.v_nr; ++j, ++*pos) {
+		size = j < src->ov_vec.v_nr ? src->ov_vec.v_count[j] : 1;
+		attr->ov_buf[*pos] = m0_alloc(size);
+		if (attr->ov_buf[*pos] == NULL)
+			return M0_ERR(-ENOMEM);
+		attr->ov_vec.v_count[*pos] = size;
+		if (j < src->ov_vec.v_nr)
+			memcpy(attr->ov_buf[*pos], src->ov_buf[j], size);
+	}
+	return 0;
+}
+
+/**
+ * Builds the merged WRITE for a run of adjacent operations. The data are not
+ * copied, the merged WRITE uses the application buffers. The attributes are
+ * concatenated.
+ */
+static void obj_io_merge_build(struct m0_op **ops, uint32_t nr)
+{
+	struct obj_io_merge *merge;
+	struct m0_op_io     *ioo;
+	uint32_t             ext_nr = 0;
+	uint32_t             data_nr = 0;
+	uint32_t             i;
+	uint32_t             j;
+	uint32_t             e = 0;
+	uint32_t             d = 0;
+	uint32_t             a = 0;
+	int                  rc;
+
+	M0_ENTRY("op %p, nr %"PRIu32, ops[0], nr);
+
+	M0_ALLOC_PTR(merge);
+	if (merge == NULL)
+		goto err;
+	for (i = 0; i < nr; ++i) {
+		ioo = obj_io_merge_ioo(ops[i]);
+		ext_nr  += ioo->ioo_ext.iv_vec.v_nr;
+		data_nr += ioo->ioo_data.ov_vec.v_nr;
+	}
+	M0_ALLOC_ARR(merge->om_ops, nr);
+	if (merge->om_ops == NULL ||
+	    m0_indexvec_alloc(&merge->om_ext, ext_nr) != 0 ||
+	    m0_bufvec_empty_alloc(&merge->om_data, data_nr) != 0 ||
+	    m0_bufvec_empty_alloc(&merge->om_attr, data_nr) != 0)
+		goto err_free;
+	for (i = 0; i < nr; ++i) {
+		ioo = obj_io_merge_ioo(ops[i]);
+		for (j = 0; j < ioo->ioo_ext.iv_vec.v_nr; ++j, ++e) {
+			merge->om_ext.iv_index[e] = ioo->ioo_ext.iv_index[j];
+			merge->om_ext.iv_vec.v_count[e] =
+				ioo->ioo_ext.iv_vec.v_count[j];
+		}
+		for (j = 0; j < ioo->ioo_data.ov_vec.v_nr; ++j, ++d) {
+			merge->om_data.ov_buf[d] = ioo->ioo_data.ov_buf[j];
+			merge->om_data.ov_vec.v_count[d] =
+				ioo->ioo_data.ov_vec.v_count[j];
+		}
+		if (obj_io_merge_attr_add(&merge->om_attr, &a, ioo) != 0)
+			goto err_free;
+		merge->om_ops[i] = ops[i];
+	}
+	ioo = obj_io_merge_ioo(ops[0]);
+	rc = m0_obj_op(ioo->ioo_obj, M0_OC_WRITE, &merge->om_ext,
+		       &merge->om_data, &merge->om_attr, ioo->ioo_attr_mask,
+		       ioo->ioo_nocache ? M0_OOF_SYNC : 0, &merge->om_op);
+	if (rc != 0)
+		goto err_free;
+	merge->om_op->op_datum = merge;
+	m0_op_setup(merge->om_op, &obj_io_merge_cbs, 0);
+	merge->om_nr = nr;
+	m0_atomic64_set(&merge->om_ref, nr + 1);
+	/* Set last, obj_io_merge_ioo() refuses merged operations. */
+	for (i = 0; i < nr; ++i) {
+		ioo = obj_io_merge_ioo(ops[i]);
+		ioo->ioo_merge = merge;
+	}
+	M0_LEAVE("merged %p", merge->om_op);
+	return;
+err_free:
+	obj_io_merge_free(merge);
+err:
+	/* Not fatal, the operations are executed one by one. */
+	M0_LOG(M0_WARN, "Failed to merge %"PRIu32" writes.", nr);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0__obj_io_merge(struct m0_op **op, uint32_t nr)
+{
+	struct m0_op_io *prev;
+	struct m0_op_io *next;
+	uint32_t         start;
+	uint32_t         end;
+	bool             unaligned;
+
+	M0_PRE(op != NULL);
+
+	for (start = 0; start < nr; start = end) {
+		unaligned = false;
+		prev = obj_io_merge_ioo(op[start]);
+		for (end = start + 1; prev != NULL && end < nr; ++end) {
+			next = obj_io_merge_ioo(op[end]);
+			if (next == NULL || !obj_io_merge_adjacent(prev, next))
+				break;
+			unaligned |= obj_io_end(prev) %
+				     data_size(pdlayout_get(prev)) != 0;
+			prev = next;
+		}
+		/*
+		 * Merging helps only when some operation ends in the middle
+		 * of a parity group, which would then be written twice, each
+		 * time with read-modify-write.
+		 */
+		if (unaligned)
+			obj_io_merge_build(op + start, end - start);
+	}
+}
+
+M0_INTERNAL void m0__obj_io_batch(struct m0_op **op, uint32_t nr)
+{
+	struct m0_op_io  *ioo;
+	struct m0_client *cinst;
+	m0_time_t         deadline = 0;
+	uint64_t          us;
+	uint32_t          i;
+
+	M0_PRE(op != NULL);
+
+	if (nr < 2)
+		return;
+	for (i = 0; i < nr; ++i) {
+		ioo = obj_io_of(op[i]);
+		if (ioo == NULL)
+			continue;
+		if (deadline == 0) {
+			cinst = m0__op_instance(op[i]);
+			us = cinst->m0c_config->mc_launch_batch_us;
+			if (us == 0)
+				return;
+			deadline = m0_time_from_now(0, us * 1000);
+		}
+		ioo->ioo_fop_deadline = deadline;
+	}
+}
+
+M0_INTERNAL void m0__obj_io_merge_launch(struct m0_op **op, uint32_t nr)
+{
+	struct obj_io_merge *merge;
+	struct m0_op_io     *ioo;
+	struct m0_op        *mop;
+	uint32_t             i;
+
+	M0_PRE(op != NULL);
+
+	for (i = 0; i < nr; ++i) {
+		ioo = obj_io_of(op[i]);
+		merge = ioo != NULL ? ioo->ioo_merge : NULL;
+		if (merge == NULL)
+			continue;
+		M0_ASSERT(merge->om_ops[0] == op[i]);
+		/*
+		 * Merged operations can be completed and finalised as soon as
+		 * om_op is launched, don't look at them any more.
+		 */
+		i += merge->om_nr - 1;
+		mop = merge->om_op;
+		obj_io_of(mop)->ioo_fop_deadline = ioo->ioo_fop_deadline;
+		m0_op_launch(&mop, 1);
+		/* Failed without callbacks, see m0_op_launch_one(). */
+		m0_sm_group_lock(&mop->op_sm_group);
+		if (mop->op_sm.sm_state == M0_OS_FAILED && !merge->om_done)
+			obj_io_merge_done(merge, mop->op_rc);
+		m0_sm_group_unlock(&mop->op_sm_group);
+		obj_io_merge_put(merge);
+	}
+}
+
 /**
  * Initialisation for object io operations.
  * This initialises certain list types.
@@ -1621,6 +1621,7 @@ static int nw_xfer_req_dispatch(struct nw_xfer_request *xfer)
 			 */
 			M0_LOG(M0_DEBUG, "item="ITEM_FMT" osr_xid=%"PRIu64,
 				ITEM_ARG(item), item->ri_header.osr_xid);
+			item->ri_deadline = ioo->ioo_fop_deadline;
 			rc = m0_rpc_post(item);
 			M0_CNT_INC(nr_dispatched);
 			m0_op_io_to_rpc_map(ioo, item);
@@ -1646,6 +1647,9 @@ static int nw_xfer_req_dispatch(struct nw_xfer_request *xfer)
 			continue;
 		}
 		m0_tl_for (iofops, &ti->ti_iofops, irfop) {
+			/* Pack with the fops of other operations, if any. */
+			irfop->irf_iofop.if_fop.f_item.ri_deadline =
+				ioo->ioo_fop_deadline;
 			rc = ioreq_fop_async_submit(&irfop->irf_iofop,
 						    ti->ti_session);
 			ri_error = irfop->irf_iofop.if_fop.f_item.ri_error;
@@ -520,6 +520,12 @@ static int pargrp_iomap_populate(struct pargrp_iomap      *map,
 	}
 	if (op->op_code == M0_OC_FREE && rmw)
 		map->pi_trunc_partial = true;
+	if (op->op_code == M0_OC_WRITE) {
+		if (rmw)
+			++ioo->ioo_rmw_grp_nr;
+		else
+			++ioo->ioo_fullstripe_grp_nr;
+	}
 
 	startindex = m0_ivec_cursor_index(cursor);
 	M0_LOG(M0_INFO, "Group id %"PRIu64" is %s", map->pi_grpid,
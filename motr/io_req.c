@@ -525,6 +525,7 @@ static void ioreq_iosm_handle_executed(struct m0_sm_group *grp,
 						 "failed (to APP): rc=%d", rc);
 				goto fail_locked;
 			}
+			m0__obj_cache_read_done(ioo);
 		} else {
 			M0_ASSERT(state == IRS_WRITE_COMPLETE);
 
@@ -95,6 +95,15 @@
  *    a execution plan which forms a DAG representing the execution orders
  *    of steps. This requires re-write/organise many places in motr and
  *    will leave for the next version.
+ *
+ * (8) The extents of all layers are flattened into a per-layout extent map
+ *     (m0_composite_extmap), one for read extents and one for write
+ *     extents. The map is a sorted array of disjoint segments, each owned
+ *     by the highest priority layer covering it, so that IO division looks
+ *     up an offset by binary search instead of merging the extent lists of
+ *     all layers. The map is built layer by layer as extents are loaded,
+ *     is unaffected by adding a layer (new layers have no extents yet) and
+ *     is rebuilt on the next IO after a layer is deleted.
  */
 
 struct m0_client_layout;
@@ -150,14 +159,44 @@ struct m0_composite_layer {
 	uint64_t          ccr_tlink_magic;
 };
 
+/** Part of the object address space served by a single layer. */
+struct m0_composite_seg {
+	m0_bindex_t cs_off;
+	/** End of the segment, exclusive. */
+	m0_bindex_t cs_end;
+	/** Index of the owning layer in m0_composite_extmap::cxm_layers[]. */
+	uint32_t    cs_layer;
+};
+
+/**
+ * Extents of a composite layout flattened over the layers.
+ *
+ * cxm_segs[] is sorted by offset and the segments do not overlap. A segment
+ * belongs to the layer of the highest priority which has an extent covering
+ * it. cxm_layers[] lists the layers with at least one extent, in priority
+ * order.
+ */
+struct m0_composite_extmap {
+	/** False if the map has to be rebuilt from the layers. */
+	bool                        cxm_valid;
+	uint32_t                    cxm_nr;
+	struct m0_composite_seg    *cxm_segs;
+	uint32_t                    cxm_nr_layers;
+	struct m0_composite_layer **cxm_layers;
+};
+
 /**
  * In-memory representation of an composite layout.
  */
 struct m0_client_composite_layout {
-	struct m0_client_layout ccl_layout;
-	uint64_t                ccl_nr_layers;
-	struct m0_tl            ccl_layers;
-	struct m0_mutex         ccl_lock;
+	struct m0_client_layout    ccl_layout;
+	uint64_t                   ccl_nr_layers;
+	struct m0_tl               ccl_layers;
+	struct m0_mutex            ccl_lock;
+	/** Flattened read extents, protected by ccl_lock. */
+	struct m0_composite_extmap ccl_rd_map;
+	/** Flattened write extents, protected by ccl_lock. */
+	struct m0_composite_extmap ccl_wr_map;
 };
 
 /**
@@ -98,6 +98,8 @@ struct m0_workload_index {
 	int			warmup_put_cnt;
 	/** Delete every 'warmup_del_ratio' records before test. */
 	int			warmup_del_ratio;
+	/** Percent of GET keys which were never inserted. */
+	int			get_miss_prcnt;
 
 	struct m0_fid		key_prefix;
 	int			keys_count;
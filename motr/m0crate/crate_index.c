@@ -93,6 +93,10 @@
  *	the index").
  * * WARMUP_DEL_RATIO - ratio, which determines, which portion of WARMUP_PUT_CNT
  *	should deleted in random order (int).
+ * * GET_MISS - percent of keys in GET operations taken outside of the key
+ *	space, i.e. keys which are never inserted (int). Lookups of such keys
+ *	fail with -ENOENT, which is not counted as an error. Used to measure
+ *	miss-heavy lookups, see tests/test7.yaml.
  * * KEY_ORDER - defines key ordering in operations ("ordered" or "random").
  * * INDEX_FID - index fid (fid, for example, `<7800000000000001:0>`).
  * * LOG_LEVEL - logging level(err(0), warn(1), info(2), trace(3), debug(4)).
@@ -838,7 +842,8 @@ static int cr_idx_w_find_rnd_k(struct cr_idx_w *w,
 
 static int cr_execute_query(struct m0_fid *id,
 			     struct kv_pair *p,
-			     enum cr_opcode opcode)
+			     enum cr_opcode opcode,
+			     bool enoent_ok)
 {
 	struct m0_op         *ops[1] = { [0] = NULL };
 	int32_t              *rcs;
@@ -872,7 +877,8 @@ static int cr_execute_query(struct m0_fid *id,
 		goto end;
 	}
 
-	if (m0_exists(i, kv_nr, (kv_index = i, (rc = rcs[i]) != 0))) {
+	if (m0_exists(i, kv_nr, (kv_index = i, (rc = rcs[i]) != 0 &&
+				 !(enoent_ok && rc == -ENOENT)))) {
 		/* XXX: client destroys keys, if NEXT op failed */
 		if (op->m0_op == M0_IC_NEXT) {
 			crlog(CLL_ERROR,
@@ -922,6 +928,7 @@ static int cr_idx_w_execute(struct cr_idx_w *w,
 	int			*ikeys = NULL;
 	struct m0_fid		*keys = NULL;
 	struct kv_pair		 kv = {0};
+	bool			 miss = false;
 	int			 i;
 
 	M0_PRE(nr_keys > 0);
@@ -956,6 +963,12 @@ static int cr_idx_w_execute(struct cr_idx_w *w,
 	for (i = 0; i < nr_keys; i++) {
 		keys[i].f_key = ikeys[i];
 		keys[i].f_container = w->key_prefix.f_container;
+		/* Keys at and above nr_keys are never inserted. */
+		if (opcode == CRATE_OP_GET &&
+		    cr_rand_pos_range(100) < w->wit->get_miss_prcnt) {
+			keys[i].f_key += w->nr_keys;
+			miss = true;
+		}
 	}
 
 	rc = op->fill_kv(w, keys, &kv, nr_keys);
@@ -964,7 +977,7 @@ static int cr_idx_w_execute(struct cr_idx_w *w,
 		goto do_exit_kv;
 	}
 
-	rc = cr_execute_query(&w->wit->index_fid, &kv, opcode);
+	rc = cr_execute_query(&w->wit->index_fid, &kv, opcode, miss);
 	if (rc != 0) {
 		rc = M0_ERR(rc);
 		goto do_exit_kv;
@@ -71,6 +71,7 @@ enum config_key_val {
 	EXEC_TIME,
 	WARMUP_PUT_CNT,
 	WARMUP_DEL_RATIO,
+	GET_MISS,
 	KEY_PREFIX,
 	KEY_ORDER,
 	INDEX_FID,
@@ -127,6 +128,7 @@ struct key_lookup_table lookuptable[] = {
 	{"EXEC_TIME", EXEC_TIME},
 	{"WARMUP_PUT_CNT", WARMUP_PUT_CNT},
 	{"WARMUP_DEL_RATIO", WARMUP_DEL_RATIO},
+	{"GET_MISS", GET_MISS},
 	{"KEY_PREFIX", KEY_PREFIX},
 	{"KEY_ORDER", KEY_ORDER},
 	{"INDEX_FID", INDEX_FID},
@@ -462,6 +464,11 @@ int copy_value(struct workload *load, int max_workload, int *index,
 			ciw = workload_index(w);
 			ciw->warmup_del_ratio = parse_int(value, WARMUP_DEL_RATIO);
 			break;
+		case GET_MISS:
+			w = &load[*index];
+			ciw = workload_index(w);
+			ciw->get_miss_prcnt = parse_int(value, GET_MISS);
+			break;
 		case THREAD_OPS:
 			w = &load[*index];
 			cw = workload_io(w);
@@ -101,6 +101,15 @@ enum m0_magic_satchel {
 	/* be_alloc_chunk::bac_magic_free (edifice faded) */
 	M0_BE_ALLOC_FREE_LINK_MAGIC = 0xed1f1cefaded,
 
+	/* m0_be_alloc_mag_class::bmc_chunks (cable seabed) */
+	M0_BE_ALLOC_MAG_MAGIC = 0xcab1e5eabed,
+
+	/* be_alloc_chunk::bac_magic_free in a magazine (boldface odd) */
+	M0_BE_ALLOC_MAG_LINK_MAGIC = 0xb01dface0dd,
+
+	/* m0_be_alloc_mag_tab::bmt_magic (tabled decade) */
+	M0_BE_ALLOC_MAG_TAB_MAGIC = 0x7ab1edecade,
+
 	/* m0_be_0type::b0_magic (bee fires stig) */
 	M0_BE_0TYPE_MAGIC = 0x33beef17e5519177,
 
@@ -686,6 +695,12 @@ enum m0_magic_satchel {
 	/* net/sock.c: buf list head (bad dada decaf) */
 	M0_NET_SOCK_BUF_HEAD_MAGIC = 0x33baddadadecaf77,
 
+	/* net/sock.c: direct buf list element, buf::b_dmagix (decaf fee bead) */
+	M0_NET_SOCK_BUF_DIRECT_MAGIC = 0x33decaffeebead77,
+
+	/* net/sock.c: direct buf list head (accede facade) */
+	M0_NET_SOCK_BUF_DIRECT_HEAD_MAGIC = 0x33accedefacade77,
+
 	/* net/net.h: m0_nep list element, endpoint (obsessed loll) */
 	M0_NET_NEP_MAGIC = 0x330b5e55ed101177,
 
@@ -749,6 +764,12 @@ enum m0_magic_satchel {
 	/* m0_sm_conf::scf_magic (falsie zodiac) */
 	M0_SM_CONF_MAGIC = 0x33FA151E20D1AC77,
 
+	/* m0_sm_timer::tr_magic (callable tac) */
+	M0_SM_TIMER_MAGIC = 0x33ca11ab1e7ac077,
+
+	/* sm_timer_tl::td_head_magic (dead decade) */
+	M0_SM_TIMER_HEAD_MAGIC = 0x33dead0decade077,
+
 /* Resource Manager */
 	/* m0_rm_pin::rp_magix (bellicose bel) */
 	M0_RM_PIN_MAGIC = 0x33be111c05ebe177,
@@ -1062,6 +1083,16 @@ enum m0_magic_satchel {
 	M0_RM_MAGIC           = 0x331CE1CE1C0E2277,
 	/* rm_ctx_tl::td_head_magic (coca cola sea) */
 	M0_RM_HEAD_MAGIC      = 0x33C0CAC01A5EA277,
+	/* obj_cache_grp::g_magic */
+	M0_OBJ_CACHE_GRP_MAGIC      = 0x3328816123512277,
+	/* ocgrp_tl::td_head_magic */
+	M0_OBJ_CACHE_GRP_HEAD_MAGIC = 0x3329816123512277,
+	/* oclru_tl::td_head_magic */
+	M0_OBJ_CACHE_LRU_HEAD_MAGIC = 0x332a816123512277,
+	/* obj_cache_io::io_magic */
+	M0_OBJ_CACHE_IO_MAGIC       = 0x332b816123512277,
+	/* ocio_tl::td_head_magic */
+	M0_OBJ_CACHE_IO_HEAD_MAGIC  = 0x332c816123512277,
 
 /* module/param */
 	/* m0_param_source::ps_magic (boozed billie) */
@@ -1099,6 +1130,15 @@ enum m0_magic_satchel {
 	M0_DIX_ROP_HEAD_MAGIC  = 0x33ba51c0ff10ad77,
 	/** struct m0_dix_cm::dcm_magic (dixdixdixdix) */
 	M0_DIX_CM_MAGIC        = 0x33d18d18d18d1877,
+/* CAS */
+	/** ctg_filter::cf_magic (casefile ball) */
+	M0_CAS_FILTER_MAGIC            = 0x33ca5ef11eba1177,
+	/** ctg_filter htable head magic (casefile head) */
+	M0_CAS_FILTER_HEAD_MAGIC       = 0x33ca5ef11e4ead77,
+	/** ctg_filter::cf_qmagic (casefile dose) */
+	M0_CAS_FILTER_QUEUE_MAGIC      = 0x33ca5ef11ed05e77,
+	/** m0_ctg_store::cs_filter_queue head magic (casefile face) */
+	M0_CAS_FILTER_QUEUE_HEAD_MAGIC = 0x33ca5ef11eface77,
 /* FDMI */
 	/* m0_reqh_fdmi_service::rfdms_magic (abide dazzled) */
 	M0_FDMS_REQH_SVC_MAGIC = 0x33ab1deda221ed77,
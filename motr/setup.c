@@ -1456,8 +1456,9 @@ static int cs_be_init(struct m0_reqh_context *rctx,
 		      struct m0_be_seg       **out)
 {
 	enum { len = 1024 };
-	char **loc = &be->but_stob_domain_location;
-	int    rc;
+	char     **loc   = &be->but_stob_domain_location;
+	m0_time_t  start = m0_time_now();
+	int        rc;
 
 	*loc = m0_alloc(len);
 	if (*loc == NULL)
@@ -1513,6 +1514,9 @@ static int cs_be_init(struct m0_reqh_context *rctx,
 		be->but_dom_cfg.bc_engine.bec_group_freeze_timeout_max =
 			rctx->rc_be_tx_group_freeze_timeout_max;
 	}
+	be->but_dom_cfg.bc_pg_budget = rctx->rc_be_seg_pg_budget;
+	be->but_dom_cfg.bc_seg_warmup_size = rctx->rc_be_seg_warmup_size;
+	be->but_dom_cfg.bc_seg_huge = rctx->rc_be_seg_huge;
 	rc = cs_be_dom_cfg_zone_pcnt_fill(&rctx->rc_reqh, &be->but_dom_cfg);
 	if (rc != 0)
 		goto err;
@@ -1522,8 +1526,12 @@ static int cs_be_init(struct m0_reqh_context *rctx,
 
 	be_seg_init(be, rctx->rc_be_seg_size, preallocate, format,
 		    rctx->rc_be_seg_path, out);
-	if (*out != NULL)
+	if (*out != NULL) {
+		/* Includes segment warm-up. */
+		M0_LOG(M0_INFO, "BE is ready in %"PRIu64" ms",
+		       m0_time_sub(m0_time_now(), start) / M0_TIME_ONE_MSEC);
 		return 0;
+	}
 	M0_LOG(M0_ERROR, "cs_be_init: failed to init segment");
 	rc = M0_ERR(-ENOMEM);
 err:
@@ -2168,6 +2176,34 @@ static int _args_parse(struct m0_motr *cctx, int argc, char **argv)
 				{
 					rctx->rc_be_seg_size = size;
 				})),
+			M0_NUMBERARG('P', "BE segment resident memory budget",
+				LAMBDA(void, (int64_t size)
+				{
+					rctx->rc_be_seg_pg_budget = size;
+				})),
+			M0_NUMBERARG('O', "CAS lookup filter memory budget",
+				LAMBDA(void, (int64_t size)
+				{
+					rctx->rc_cas_filter_budget = size;
+				})),
+			M0_NUMBERARG('t', "CAS lookup filter false positive"
+				     " rate, parts per million",
+				LAMBDA(void, (int64_t ppm)
+				{
+					rctx->rc_cas_filter_fpr = ppm;
+				})),
+			M0_NUMBERARG('W', "BE segment warm-up size,"
+				     " -1 for the whole segment",
+				LAMBDA(void, (int64_t size)
+				{
+					rctx->rc_be_seg_warmup_size =
+						size < 0 ? M0_BCOUNT_MAX : size;
+				})),
+			M0_VOIDARG('X', "Back BE segments with huge pages",
+				LAMBDA(void, (void)
+				{
+					rctx->rc_be_seg_huge = true;
+				})),
 			M0_NUMBERARG('V', "BE log size",
 				LAMBDA(void, (int64_t size)
 				{
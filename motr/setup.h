@@ -276,6 +276,16 @@ struct m0_reqh_context {
 	/** BE primary segment size for m0mkfs. */
 	m0_bcount_t		     rc_be_seg_size;
 	m0_bcount_t		     rc_be_log_size;
+	/** Resident memory budget of BE segments, 0 means no limit. */
+	m0_bcount_t		     rc_be_seg_pg_budget;
+	/** Number of bytes of BE segments to prefetch on startup. */
+	m0_bcount_t		     rc_be_seg_warmup_size;
+	/** Back BE segments with huge pages. */
+	bool			     rc_be_seg_huge;
+	/** Memory budget of CAS negative lookup filters, 0 disables them. */
+	m0_bcount_t		     rc_cas_filter_budget;
+	/** False positive rate of CAS lookup filters, parts per million. */
+	uint32_t		     rc_cas_filter_fpr;
 	m0_bcount_t                  rc_be_tx_group_tx_nr_max;
 	m0_bcount_t                  rc_be_tx_group_reg_nr_max;
 	m0_bcount_t                  rc_be_tx_group_reg_size_max;
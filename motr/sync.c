@@ -1070,6 +1070,13 @@ int m0_entity_sync(struct m0_entity *ent)
 	M0_ENTRY();
 	M0_PRE(ent != NULL);
 
+	/* Cached dirty data have to reach the ioservices first. */
+	if (ent->en_type == M0_ET_OBJ) {
+		rc = m0__obj_cache_flush(m0__obj_entity(ent));
+		if (rc != 0)
+			return M0_ERR(rc);
+	}
+
 	sync_request_init(&sreq);
 	rc = sync_request_target_add(&sreq, SYNC_ENTITY, ent);
 	if (rc != 0)
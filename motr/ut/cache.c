@@ -0,0 +1,434 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include "ut/ut.h"              /* M0_UT_ASSERT */
+#include "motr/ut/client.h"
+
+/*
+ * Include the c file to test static functions. The cache logic is exercised
+ * without launching operations: prepared read-ahead and write-back
+ * operations are completed by hand.
+ */
+#include "motr/cache.c"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_CLIENT
+#include "lib/trace.h"          /* M0_LOG */
+
+struct m0_ut_suite ut_suite_cache;
+
+enum {
+	UT_BSHIFT   = 12,
+	UT_BSIZE    = 1 << UT_BSHIFT,
+	UT_GRP_SIZE = 4 * UT_BSIZE,
+};
+
+static struct m0_obj_cache_domain ut_dom;
+static struct m0_obj              ut_obj;
+static struct m0_obj_cache       *ut_cache;
+
+static void ut_cache_init(uint32_t grp_budget)
+{
+	struct m0_config conf = {
+		.mc_cache_size      = grp_budget * UT_GRP_SIZE,
+		.mc_cache_ra_grp_nr = 2,
+	};
+
+	M0_SET0(&ut_obj);
+	m0__obj_cache_domain_init(&ut_dom, &conf);
+	ut_cache = obj_cache_alloc(&ut_dom, &ut_obj, UT_GRP_SIZE, UT_BSHIFT);
+	M0_UT_ASSERT(ut_cache != NULL);
+	ut_obj.ob_cache = ut_cache;
+}
+
+static void ut_cache_fini(void)
+{
+	obj_cache_free(ut_cache);
+	ut_obj.ob_cache = NULL;
+	M0_UT_ASSERT(ut_dom.ocd_used == 0);
+	m0__obj_cache_domain_fini(&ut_dom);
+}
+
+static void ut_vec_alloc(struct m0_indexvec *ext, struct m0_bufvec *data,
+			 m0_bindex_t off, m0_bcount_t len, char fill)
+{
+	int rc;
+
+	rc = m0_indexvec_alloc(ext, 1);
+	M0_UT_ASSERT(rc == 0);
+	ext->iv_index[0] = off;
+	ext->iv_vec.v_count[0] = len;
+	rc = m0_bufvec_alloc(data, 1, len);
+	M0_UT_ASSERT(rc == 0);
+	memset(data->ov_buf[0], fill, len);
+}
+
+static void ut_vec_free(struct m0_indexvec *ext, struct m0_bufvec *data)
+{
+	m0_indexvec_free(ext);
+	m0_bufvec_free(data);
+}
+
+static bool ut_buf_is(const char *buf, m0_bcount_t len, char fill)
+{
+	return m0_forall(i, len, buf[i] == fill);
+}
+
+static bool ut_write(m0_bindex_t off, m0_bcount_t len, char fill,
+		     struct m0_tl *launch)
+{
+	struct m0_indexvec ext;
+	struct m0_bufvec   data;
+	bool               done;
+
+	ut_vec_alloc(&ext, &data, off, len, fill);
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	done = obj_cache_absorb(ut_cache, &ext, &data, launch);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	ut_vec_free(&ext, &data);
+	return done;
+}
+
+/** Reads through the cache, expecting "fill" on a hit. */
+static bool ut_read(m0_bindex_t off, m0_bcount_t len, char fill,
+		    struct m0_tl *launch)
+{
+	struct m0_indexvec ext;
+	struct m0_bufvec   data;
+	bool               done;
+
+	ut_vec_alloc(&ext, &data, off, len, 0);
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	done = obj_cache_serve(ut_cache, &ext, &data);
+	if (launch != NULL)
+		obj_cache_stream(ut_cache, &ext, launch);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	M0_UT_ASSERT(ergo(done, ut_buf_is(data.ov_buf[0], len, fill)));
+	ut_vec_free(&ext, &data);
+	return done;
+}
+
+/** Completes the prepared operation at the head of "launch". */
+static struct obj_cache_io *ut_io_complete(struct m0_tl *launch,
+					   enum m0_obj_opcode opcode,
+					   char fill, int rc)
+{
+	struct obj_cache_io *io;
+
+	io = oclaunch_tlist_pop(launch);
+	M0_UT_ASSERT(io != NULL);
+	M0_UT_ASSERT(io->io_opcode == opcode);
+	if (opcode == M0_OC_READ)
+		memset(io->io_buf, fill, UT_GRP_SIZE);
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_io_done(io, rc);
+	ocio_tlist_del(io);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	return io;
+}
+
+static void ut_cache_absorb_serve(void)
+{
+	struct m0_tl        launch;
+	struct m0_indexvec  ext;
+	struct m0_bufvec    data;
+
+	ut_cache_init(4);
+	oclaunch_tlist_init(&launch);
+
+	M0_UT_ASSERT(ut_write(UT_BSIZE, UT_BSIZE, 'a', &launch));
+	M0_UT_ASSERT(oclaunch_tlist_is_empty(&launch));
+	M0_UT_ASSERT(ut_read(UT_BSIZE, UT_BSIZE, 'a', NULL));
+	M0_UT_ASSERT(!ut_read(0, 2 * UT_BSIZE, 'a', NULL));
+
+	/* Whole groups are not absorbed. */
+	M0_UT_ASSERT(!ut_write(UT_GRP_SIZE, UT_GRP_SIZE, 'b', &launch));
+
+	/* A direct write refreshes the cached copy. */
+	ut_vec_alloc(&ext, &data, 0, 2 * UT_BSIZE, 'c');
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_update(ut_cache, &ext, &data);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	M0_UT_ASSERT(ut_read(0, 2 * UT_BSIZE, 'c', NULL));
+
+	/* Free drops the blocks. */
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_discard(ut_cache, &ext);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	M0_UT_ASSERT(!ut_read(UT_BSIZE, UT_BSIZE, 'c', NULL));
+	ut_vec_free(&ext, &data);
+
+	oclaunch_tlist_fini(&launch);
+	ut_cache_fini();
+}
+
+static void ut_cache_full_stripe(void)
+{
+	struct m0_tl          launch;
+	struct obj_cache_io  *io;
+	struct obj_cache_grp *grp;
+
+	ut_cache_init(4);
+	oclaunch_tlist_init(&launch);
+
+	M0_UT_ASSERT(ut_write(0, 2 * UT_BSIZE, 'a', &launch));
+	M0_UT_ASSERT(oclaunch_tlist_is_empty(&launch));
+	M0_UT_ASSERT(ut_write(2 * UT_BSIZE, 2 * UT_BSIZE, 'b', &launch));
+	M0_UT_ASSERT(oclaunch_tlist_length(&launch) == 1);
+
+	/* The completed group is written as a single full stripe. */
+	grp = grp_find(ut_cache, 0);
+	M0_UT_ASSERT(grp != NULL && grp->g_wb && grp->g_dirty_nr == 0);
+	io = oclaunch_tlist_head(&launch);
+	M0_UT_ASSERT(io->io_ext.iv_vec.v_nr == 1);
+	M0_UT_ASSERT(io->io_ext.iv_index[0] == 0);
+	M0_UT_ASSERT(io->io_ext.iv_vec.v_count[0] == UT_GRP_SIZE);
+	M0_UT_ASSERT(ut_buf_is(io->io_buf, 2 * UT_BSIZE, 'a'));
+	M0_UT_ASSERT(ut_buf_is(io->io_buf + 2 * UT_BSIZE, 2 * UT_BSIZE, 'b'));
+	M0_UT_ASSERT(ut_dom.ocd_stats.ocs_flush_full_nr == 1);
+
+	io = ut_io_complete(&launch, M0_OC_WRITE, 0, 0);
+	M0_UT_ASSERT(!grp->g_wb && grp->g_valid_nr == 4);
+	obj_cache_io_free(io);
+	M0_UT_ASSERT(ut_read(0, UT_GRP_SIZE / 2, 'a', NULL));
+
+	oclaunch_tlist_fini(&launch);
+	ut_cache_fini();
+}
+
+static void ut_cache_partial_flush(void)
+{
+	struct m0_tl          launch;
+	struct obj_cache_io  *io;
+	struct obj_cache_grp *grp;
+
+	ut_cache_init(4);
+	oclaunch_tlist_init(&launch);
+
+	M0_UT_ASSERT(ut_write(UT_BSIZE, UT_BSIZE, 'a', &launch));
+	M0_UT_ASSERT(ut_write(3 * UT_BSIZE, UT_BSIZE, 'b', &launch));
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	M0_UT_ASSERT(obj_cache_wb_all(ut_cache, &launch) == 0);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+
+	/* Dirty extents are written separately. */
+	io = oclaunch_tlist_head(&launch);
+	M0_UT_ASSERT(io->io_ext.iv_vec.v_nr == 2);
+	M0_UT_ASSERT(io->io_ext.iv_index[0] == UT_BSIZE);
+	M0_UT_ASSERT(io->io_ext.iv_index[1] == 3 * UT_BSIZE);
+	M0_UT_ASSERT(ut_dom.ocd_stats.ocs_flush_part_nr == 1);
+
+	/* A failed write-back keeps the data dirty and reports the error. */
+	io = ut_io_complete(&launch, M0_OC_WRITE, 0, -EIO);
+	obj_cache_io_free(io);
+	grp = grp_find(ut_cache, 0);
+	M0_UT_ASSERT(grp->g_dirty_nr == 2);
+	M0_UT_ASSERT(ut_cache->oc_rc == -EIO);
+
+	/* Expired groups are written back. */
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_expire(ut_cache, m0_time_add(m0_time_now(),
+					       ut_dom.ocd_flush_age), &launch);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	M0_UT_ASSERT(oclaunch_tlist_length(&launch) == 1);
+	io = ut_io_complete(&launch, M0_OC_WRITE, 0, 0);
+	obj_cache_io_free(io);
+	M0_UT_ASSERT(grp->g_dirty_nr == 0 && grp->g_dirtied == 0);
+
+	oclaunch_tlist_fini(&launch);
+	ut_cache_fini();
+}
+
+static void ut_cache_readahead(void)
+{
+	struct m0_tl          launch;
+	struct obj_cache_io  *io;
+
+	ut_cache_init(4);
+	oclaunch_tlist_init(&launch);
+
+	/* The first read does not start read-ahead, the next one does. */
+	M0_UT_ASSERT(!ut_read(0, UT_BSIZE, 0, &launch));
+	M0_UT_ASSERT(oclaunch_tlist_is_empty(&launch));
+	M0_UT_ASSERT(!ut_read(UT_BSIZE, UT_BSIZE, 0, &launch));
+	M0_UT_ASSERT(oclaunch_tlist_length(&launch) == 2);
+	M0_UT_ASSERT(ut_dom.ocd_stats.ocs_ra_nr == 2);
+	io = oclaunch_tlist_tail(&launch);
+	M0_UT_ASSERT(io->io_ext.iv_index[0] == UT_GRP_SIZE);
+	M0_UT_ASSERT(io->io_ext.iv_vec.v_count[0] == UT_GRP_SIZE);
+
+	/* Blocks written while read-ahead is in flight are kept. */
+	M0_UT_ASSERT(ut_write(UT_GRP_SIZE, UT_BSIZE, 'w', &launch));
+	io = ut_io_complete(&launch, M0_OC_READ, 'r', 0);
+	obj_cache_io_free(io);
+	io = ut_io_complete(&launch, M0_OC_READ, 'r', 0);
+	obj_cache_io_free(io);
+	M0_UT_ASSERT(ut_read(0, UT_GRP_SIZE, 'r', NULL));
+	M0_UT_ASSERT(ut_read(UT_GRP_SIZE, UT_BSIZE, 'w', NULL));
+	M0_UT_ASSERT(ut_read(UT_GRP_SIZE + UT_BSIZE, UT_BSIZE, 'r', NULL));
+
+	/* A random read breaks the stream. */
+	M0_UT_ASSERT(!ut_read(10 * UT_GRP_SIZE, UT_BSIZE, 0, &launch));
+	M0_UT_ASSERT(oclaunch_tlist_is_empty(&launch));
+
+	oclaunch_tlist_fini(&launch);
+	ut_cache_fini();
+}
+
+static void ut_cache_evict(void)
+{
+	struct m0_tl         launch;
+	struct obj_cache_io *io;
+
+	ut_cache_init(2);
+	oclaunch_tlist_init(&launch);
+
+	/* Group 0 is clean after write-back, group 1 is dirty. */
+	M0_UT_ASSERT(ut_write(0, UT_BSIZE, 'a', &launch));
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_wb_all(ut_cache, &launch);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	io = ut_io_complete(&launch, M0_OC_WRITE, 0, 0);
+	obj_cache_io_free(io);
+	M0_UT_ASSERT(ut_write(UT_GRP_SIZE, UT_BSIZE, 'b', &launch));
+
+	/* The clean group is evicted to make room. */
+	M0_UT_ASSERT(ut_write(2 * UT_GRP_SIZE, UT_BSIZE, 'c', &launch));
+	M0_UT_ASSERT(grp_find(ut_cache, 0) == NULL);
+	M0_UT_ASSERT(ut_dom.ocd_stats.ocs_evict_nr == 1);
+
+	/* Dirty groups are never evicted. */
+	M0_UT_ASSERT(!ut_write(3 * UT_GRP_SIZE, UT_BSIZE, 'd', &launch));
+	M0_UT_ASSERT(grp_find(ut_cache, 1) != NULL);
+	M0_UT_ASSERT(ut_dom.ocd_used == 2 * UT_GRP_SIZE);
+
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_wb_all(ut_cache, &launch);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	while (!oclaunch_tlist_is_empty(&launch))
+		obj_cache_io_free(ut_io_complete(&launch, M0_OC_WRITE, 0, 0));
+
+	oclaunch_tlist_fini(&launch);
+	ut_cache_fini();
+}
+
+static void ut_cache_evict_own(void)
+{
+	struct m0_tl launch;
+
+	ut_cache_init(2);
+	oclaunch_tlist_init(&launch);
+
+	/* The cache is full of clean groups, group 0 is the LRU tail. */
+	M0_UT_ASSERT(ut_write(0, UT_BSIZE, 'a', &launch));
+	M0_UT_ASSERT(ut_write(5 * UT_GRP_SIZE, UT_BSIZE, 'b', &launch));
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_wb_all(ut_cache, &launch);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	while (!oclaunch_tlist_is_empty(&launch))
+		obj_cache_io_free(ut_io_complete(&launch, M0_OC_WRITE, 0, 0));
+	M0_UT_ASSERT(ut_read(5 * UT_GRP_SIZE, UT_BSIZE, 'b', NULL));
+	M0_UT_ASSERT(ut_dom.ocd_used == ut_dom.ocd_budget);
+
+	/*
+	 * The write covers group 0 and the missing group 1. Making room for
+	 * group 1 evicts group 0, which has to be allocated again.
+	 */
+	M0_UT_ASSERT(ut_write(UT_GRP_SIZE - UT_BSIZE, 2 * UT_BSIZE, 'c',
+			      &launch));
+	M0_UT_ASSERT(ut_dom.ocd_used <= ut_dom.ocd_budget);
+	M0_UT_ASSERT(grp_find(ut_cache, 5) == NULL);
+	M0_UT_ASSERT(ut_dom.ocd_stats.ocs_evict_nr == 2);
+	M0_UT_ASSERT(ut_read(UT_GRP_SIZE - UT_BSIZE, 2 * UT_BSIZE, 'c', NULL));
+
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_wb_all(ut_cache, &launch);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	while (!oclaunch_tlist_is_empty(&launch))
+		obj_cache_io_free(ut_io_complete(&launch, M0_OC_WRITE, 0, 0));
+
+	oclaunch_tlist_fini(&launch);
+	ut_cache_fini();
+}
+
+static void ut_cache_overlay(void)
+{
+	struct m0_tl          launch;
+	struct m0_indexvec    ext;
+	struct m0_bufvec      data;
+	struct obj_cache_grp *grp;
+
+	ut_cache_init(4);
+	oclaunch_tlist_init(&launch);
+
+	M0_UT_ASSERT(ut_write(0, UT_BSIZE, 'a', &launch));
+
+	/* Data received from the ioservices, stale for block 0. */
+	ut_vec_alloc(&ext, &data, 0, 2 * UT_BSIZE, 's');
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_walk(ut_cache, &ext, &data, &obj_cache_overlay_cb, NULL);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	M0_UT_ASSERT(ut_buf_is(data.ov_buf[0], UT_BSIZE, 'a'));
+	M0_UT_ASSERT(ut_buf_is(data.ov_buf[0] + UT_BSIZE, UT_BSIZE, 's'));
+	ut_vec_free(&ext, &data);
+
+	grp = grp_find(ut_cache, 0);
+	M0_UT_ASSERT(grp->g_valid_nr == 2 && grp->g_dirty_nr == 1);
+	M0_UT_ASSERT(ut_read(UT_BSIZE, UT_BSIZE, 's', NULL));
+
+	m0_mutex_lock(&ut_dom.ocd_lock);
+	obj_cache_wb_all(ut_cache, &launch);
+	m0_mutex_unlock(&ut_dom.ocd_lock);
+	obj_cache_io_free(ut_io_complete(&launch, M0_OC_WRITE, 0, 0));
+
+	oclaunch_tlist_fini(&launch);
+	ut_cache_fini();
+}
+
+struct m0_ut_suite ut_suite_cache = {
+	.ts_name = "client-cache-ut",
+	.ts_init = NULL,
+	.ts_fini = NULL,
+	.ts_tests = {
+		{ "absorb-serve",   &ut_cache_absorb_serve },
+		{ "full-stripe",    &ut_cache_full_stripe },
+		{ "partial-flush",  &ut_cache_partial_flush },
+		{ "readahead",      &ut_cache_readahead },
+		{ "evict",          &ut_cache_evict },
+		{ "evict-own",      &ut_cache_evict_own },
+		{ "overlay",        &ut_cache_overlay },
+		{ NULL, NULL },
+	}
+};
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -49,6 +49,7 @@ enum {
 	MAX_RPCS_IN_FLIGHT = 10,
 	CNT = 10,
 	BATCH_SZ = 128,
+	IDX_NR = 3,
 };
 
 static char *cas_startup_cmd[] = { "m0d", "-T", "linux",
@@ -742,6 +743,135 @@ static void ut_dix_record_ops_non_dist(void)
 	ut_dix_record_ops(false);
 }
 
+static void batch_launch_wait(struct m0_op **op, int nr)
+{
+	int i;
+	int rc;
+
+	m0_op_launch(op, nr);
+	for (i = 0; i < nr; i++) {
+		rc = m0_op_wait(op[i], M0_BITS(M0_OS_STABLE, M0_OS_FAILED),
+				WAIT_TIMEOUT);
+		M0_UT_ASSERT(rc == 0);
+	}
+}
+
+static void batch_ops_fini(struct m0_op **op, int **rcs, int nr)
+{
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		m0_op_fini(op[i]);
+		m0_free0(&op[i]);
+		m0_free0(&rcs[i]);
+	}
+}
+
+/*
+ * Record operations on several distributed indices launched together, the
+ * last one on a non-existing index.
+ */
+static void ut_dix_record_ops_batch(void)
+{
+	struct m0_container realm;
+	struct m0_idx       idx[IDX_NR + 1];
+	struct m0_fid       ifid[IDX_NR + 1];
+	struct m0_op       *op[IDX_NR + 1] = { NULL };
+	int                *rcs[IDX_NR + 1] = { NULL };
+	struct m0_bufvec    keys;
+	struct m0_bufvec    vals[IDX_NR + 1];
+	uint64_t            i;
+	uint64_t            j;
+	int                 rc;
+
+	ut_m0_config.mc_launch_batch_us = 1000;
+	idx_dix_ut_init();
+	m0_container_init(&realm, NULL, &M0_UBER_REALM, ut_m0c);
+	for (i = 0; i <= IDX_NR; i++) {
+		general_ifid_fill_batch(&ifid[i], true, i + 1);
+		m0_idx_init(&idx[i], &realm.co_realm,
+			    (struct m0_uint128 *)&ifid[i]);
+	}
+	for (i = 0; i < IDX_NR; i++) {
+		rc = m0_entity_create(NULL, &idx[i].in_entity, &op[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+	batch_launch_wait(op, IDX_NR);
+	M0_UT_ASSERT(m0_forall(k, IDX_NR, op[k]->op_rc == 0));
+	batch_ops_fini(op, rcs, IDX_NR);
+
+	/* Put different values under the same keys to all indices. */
+	rc = m0_bufvec_alloc(&keys, CNT, sizeof(uint64_t));
+	M0_UT_ASSERT(rc == 0);
+	for (j = 0; j < CNT; j++)
+		*(uint64_t *)keys.ov_buf[j] = dix_key(j);
+	for (i = 0; i <= IDX_NR; i++) {
+		rc = m0_bufvec_alloc(&vals[i], CNT, sizeof(uint64_t));
+		M0_UT_ASSERT(rc == 0);
+		for (j = 0; j < CNT; j++)
+			*(uint64_t *)vals[i].ov_buf[j] = dix_val(i * CNT + j);
+		rcs[i] = rcs_alloc(CNT);
+		rc = m0_idx_op(&idx[i], M0_IC_PUT, &keys, &vals[i], rcs[i], 0,
+			       &op[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+	batch_launch_wait(op, IDX_NR + 1);
+	for (i = 0; i < IDX_NR; i++) {
+		M0_UT_ASSERT(op[i]->op_sm.sm_state == M0_OS_STABLE);
+		M0_UT_ASSERT(m0_forall(k, CNT, rcs[i][k] == 0));
+	}
+	M0_UT_ASSERT(op[IDX_NR]->op_sm.sm_state == M0_OS_FAILED);
+	M0_UT_ASSERT(op[IDX_NR]->op_rc == -ENOENT);
+	batch_ops_fini(op, rcs, IDX_NR + 1);
+	for (i = 0; i <= IDX_NR; i++)
+		m0_bufvec_free(&vals[i]);
+
+	/* Get them back. */
+	for (i = 0; i < IDX_NR; i++) {
+		rc = m0_bufvec_empty_alloc(&vals[i], CNT);
+		M0_UT_ASSERT(rc == 0);
+		rcs[i] = rcs_alloc(CNT);
+		rc = m0_idx_op(&idx[i], M0_IC_GET, &keys, &vals[i], rcs[i], 0,
+			       &op[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+	batch_launch_wait(op, IDX_NR);
+	for (i = 0; i < IDX_NR; i++) {
+		M0_UT_ASSERT(op[i]->op_rc == 0);
+		M0_UT_ASSERT(m0_forall(k, CNT, rcs[i][k] == 0 &&
+				       *(uint64_t *)vals[i].ov_buf[k] ==
+				       dix_val(i * CNT + k)));
+		m0_bufvec_free(&vals[i]);
+	}
+	batch_ops_fini(op, rcs, IDX_NR);
+
+	/* Delete the records. */
+	for (i = 0; i < IDX_NR; i++) {
+		rcs[i] = rcs_alloc(CNT);
+		rc = m0_idx_op(&idx[i], M0_IC_DEL, &keys, NULL, rcs[i], 0,
+			       &op[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+	batch_launch_wait(op, IDX_NR);
+	for (i = 0; i < IDX_NR; i++) {
+		M0_UT_ASSERT(op[i]->op_rc == 0);
+		M0_UT_ASSERT(m0_forall(k, CNT, rcs[i][k] == 0));
+	}
+	batch_ops_fini(op, rcs, IDX_NR);
+	m0_bufvec_free(&keys);
+
+	for (i = 0; i < IDX_NR; i++) {
+		rc = m0_entity_delete(&idx[i].in_entity, &op[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+	batch_launch_wait(op, IDX_NR);
+	batch_ops_fini(op, rcs, IDX_NR);
+	for (i = 0; i <= IDX_NR; i++)
+		m0_idx_fini(&idx[i]);
+	idx_dix_ut_fini();
+	ut_m0_config.mc_launch_batch_us = 0;
+}
+
 struct m0_ut_suite ut_suite_idx_dix = {
 	.ts_name   = "idx-dix",
 	.ts_owners = "Egor",
@@ -753,6 +883,7 @@ struct m0_ut_suite ut_suite_idx_dix = {
 		{ "namei-ops-non-dist",   ut_dix_namei_ops_non_dist,  "Egor" },
 		{ "record-ops-dist",      ut_dix_record_ops_dist,     "Egor" },
 		{ "record-ops-non-dist",  ut_dix_record_ops_non_dist, "Egor" },
+		{ "record-ops-batch",     ut_dix_record_ops_batch,    "Egor" },
 		{ "namei-ops-cancel-dist",     ut_dix_namei_ops_cancel_dist,
 		  "Vikram" },
 		{ "namei-ops-cancel-non-dist", ut_dix_namei_ops_cancel_non_dist,
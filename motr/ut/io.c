@@ -751,6 +751,268 @@ static void ut_test_obj_io_cb_free(void)
 	obj_io_cb_free(&ioo->ioo_oo.oo_oc);
 }
 
+/**
+ * Tests obj_io_merge_adjacent().
+ */
+static void ut_test_obj_io_merge_adjacent(void)
+{
+	struct m0_op_io  *prev;
+	struct m0_op_io  *next;
+	struct m0_obj    *obj;
+	struct m0_client *instance = dummy_instance;
+
+	prev = ut_dummy_ioo_create(instance, 1);
+	next = ut_dummy_ioo_create(instance, 1);
+	obj = next->ioo_obj;
+
+	/* Different objects. */
+	next->ioo_ext.iv_index[0] = obj_io_end(prev);
+	M0_UT_ASSERT(!obj_io_merge_adjacent(prev, next));
+
+	/* Base case. */
+	next->ioo_obj = prev->ioo_obj;
+	M0_UT_ASSERT(obj_io_end(prev) == UT_DEFAULT_BLOCK_SIZE);
+	M0_UT_ASSERT(obj_io_merge_adjacent(prev, next));
+
+	/* A hole in between. */
+	next->ioo_ext.iv_index[0] += UT_DEFAULT_BLOCK_SIZE;
+	M0_UT_ASSERT(!obj_io_merge_adjacent(prev, next));
+	next->ioo_ext.iv_index[0] = obj_io_end(prev);
+
+	/* M0_OOF_SYNC and cached writes are not mixed. */
+	next->ioo_nocache = true;
+	M0_UT_ASSERT(!obj_io_merge_adjacent(prev, next));
+
+	next->ioo_obj = obj;
+	ut_dummy_ioo_delete(next, instance);
+	ut_dummy_ioo_delete(prev, instance);
+}
+
+/**
+ * Tests obj_io_merge_attr_add().
+ */
+static void ut_test_obj_io_merge_attr_add(void)
+{
+	struct m0_op_io  *ioo[2];
+	struct m0_bufvec  attr;
+	uint32_t          pos = 0;
+	int               rc;
+	int               i;
+	struct m0_client *instance = dummy_instance;
+
+	for (i = 0; i < 2; ++i)
+		ioo[i] = ut_dummy_ioo_create(instance, 1);
+	/* The first operation carries an 8-byte attribute, the second none. */
+	rc = m0_bufvec_alloc(&ioo[0]->ioo_attr, 1, 8);
+	M0_UT_ASSERT(rc == 0);
+	memset(ioo[0]->ioo_attr.ov_buf[0], 0xa5, 8);
+	rc = m0_bufvec_empty_alloc(&attr, 2);
+	M0_UT_ASSERT(rc == 0);
+
+	for (i = 0; i < 2; ++i) {
+		rc = obj_io_merge_attr_add(&attr, &pos, ioo[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+	M0_UT_ASSERT(pos == 2);
+	M0_UT_ASSERT(attr.ov_vec.v_count[0] == 8);
+	M0_UT_ASSERT(memcmp(attr.ov_buf[0],
+			    ioo[0]->ioo_attr.ov_buf[0], 8) == 0);
+	/* A copy, not the caller's buffer. */
+	M0_UT_ASSERT(attr.ov_buf[0] != ioo[0]->ioo_attr.ov_buf[0]);
+	M0_UT_ASSERT(attr.ov_vec.v_count[1] == 1);
+	M0_UT_ASSERT(((char *)attr.ov_buf[1])[0] == 0);
+
+	m0_bufvec_free(&attr);
+	m0_bufvec_free(&ioo[0]->ioo_attr);
+	for (i = 0; i < 2; ++i)
+		ut_dummy_ioo_delete(ioo[i], instance);
+}
+
+/**
+ * Tests m0__obj_io_batch().
+ */
+static void ut_test_obj_io_batch(void)
+{
+	int                 i;
+	uint32_t            batch_us;
+	struct m0_op       *ops[2];
+	struct m0_op_io    *ioo[2];
+	struct m0_obj      *obj[2];
+	struct m0_realm     realm;
+	struct m0_client   *instance = dummy_instance;
+
+	for (i = 0; i < 2; ++i) {
+		ioo[i] = ut_dummy_ioo_create(instance, 1);
+		obj[i] = ioo[i]->ioo_obj;
+		ut_realm_entity_setup(&realm, &obj[i]->ob_entity, instance);
+		ioo[i]->ioo_oo.oo_oc.oc_cb_launch = obj_io_cb_launch;
+		ops[i] = &ioo[i]->ioo_oo.oo_oc.oc_op;
+	}
+	batch_us = instance->m0c_config->mc_launch_batch_us;
+
+	/* Disabled. */
+	instance->m0c_config->mc_launch_batch_us = 0;
+	m0__obj_io_batch(ops, 2);
+	M0_UT_ASSERT(ioo[0]->ioo_fop_deadline == 0);
+	M0_UT_ASSERT(ioo[1]->ioo_fop_deadline == 0);
+
+	/* A single operation is not delayed. */
+	instance->m0c_config->mc_launch_batch_us = 1000;
+	m0__obj_io_batch(ops, 1);
+	M0_UT_ASSERT(ioo[0]->ioo_fop_deadline == 0);
+
+	/* Base case. */
+	m0__obj_io_batch(ops, 2);
+	M0_UT_ASSERT(ioo[0]->ioo_fop_deadline != 0);
+	M0_UT_ASSERT(ioo[0]->ioo_fop_deadline == ioo[1]->ioo_fop_deadline);
+
+	instance->m0c_config->mc_launch_batch_us = batch_us;
+	for (i = 0; i < 2; ++i) {
+		m0_entity_fini(&obj[i]->ob_entity);
+		ut_dummy_ioo_delete(ioo[i], instance);
+	}
+}
+
+static int ut_merge_launch_nr;
+static int ut_merge_free_nr;
+
+static void ut_mock_merge_iosm_handle_launch(struct m0_sm_group *grp,
+					     struct m0_sm_ast *ast)
+{
+	struct m0_op_io *ioo = bob_of(ast, struct m0_op_io, ioo_ast,
+				      &ioo_bobtype);
+	struct m0_op    *op  = &ioo->ioo_oo.oo_oc.oc_op;
+
+	ut_merge_launch_nr++;
+	m0_sm_group_lock(&op->op_sm_group);
+	m0_sm_move(&op->op_sm, 0, M0_OS_LAUNCHED);
+	m0_sm_group_unlock(&op->op_sm_group);
+}
+
+static void ut_mock_merge_cb_free(struct m0_op_common *oc)
+{
+	ut_merge_free_nr++;
+	obj_io_cb_free(oc);
+}
+
+/**
+ * Tests m0__obj_io_merge() and m0__obj_io_merge_launch(): two adjacent
+ * WRITEs are executed by a single merged WRITE. The steps of m0_op_launch()
+ * are done one by one, so that the merged WRITE is not sent to the network,
+ * and it is completed by hand.
+ */
+static void ut_test_obj_io_merge_launch(void)
+{
+	int                  i;
+	int                  rc;
+	bool                 write_merge;
+	m0_bcount_t          len = 1ULL << M0_MIN_BUF_SHIFT;
+	struct m0_obj        obj;
+	struct m0_realm      realm;
+	struct m0_indexvec   ext[2];
+	struct m0_bufvec     data[2];
+	struct m0_bufvec     attr[2];
+	struct m0_op        *ops[2] = {};
+	struct m0_op        *mop;
+	struct m0_op_io     *mioo;
+	struct m0_op_io_ops  mioo_ops;
+	struct nw_xfer_ops   mxfer_ops;
+	struct obj_io_merge *merge;
+	struct m0_client    *instance = dummy_instance;
+
+	M0_SET0(&obj);
+	ut_realm_entity_setup(&realm, &obj.ob_entity, instance);
+	obj.ob_attr.oa_bshift = M0_MIN_BUF_SHIFT;
+	obj.ob_attr.oa_pver   = instance->m0c_pools_common.pc_cur_pver->pv_id;
+	write_merge = instance->m0c_config->mc_is_write_merge;
+	instance->m0c_config->mc_is_write_merge = true;
+
+	m0_fi_enable("m0__obj_layout_id_get", "fake_obj_layout_id");
+	m0_fi_enable("tolerance_of_level", "fake_tolerance_of_level");
+	/* The first WRITE ends in the middle of a parity group. */
+	for (i = 0; i < 2; ++i) {
+		rc = m0_indexvec_alloc(&ext[i], 1);
+		M0_UT_ASSERT(rc == 0);
+		ext[i].iv_index[0] = i * len;
+		ext[i].iv_vec.v_count[0] = len;
+		rc = m0_bufvec_alloc(&data[i], 1, len) ?:
+		     m0_bufvec_alloc(&attr[i], 1, 1);
+		M0_UT_ASSERT(rc == 0);
+		rc = m0_obj_op(&obj, M0_OC_WRITE, &ext[i], &data[i], &attr[i],
+			       0, 0, &ops[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+
+	m0__obj_io_merge(ops, 2);
+	m0_fi_disable("m0__obj_layout_id_get", "fake_obj_layout_id");
+	m0_fi_disable("tolerance_of_level", "fake_tolerance_of_level");
+	merge = obj_io_of(ops[0])->ioo_merge;
+	M0_UT_ASSERT(merge != NULL);
+	M0_UT_ASSERT(obj_io_of(ops[1])->ioo_merge == merge);
+	M0_UT_ASSERT(merge->om_nr == 2);
+	mop = merge->om_op;
+	mioo = obj_io_of(mop);
+	M0_UT_ASSERT(mioo->ioo_ext.iv_vec.v_nr == 2);
+	M0_UT_ASSERT(obj_io_end(mioo) == 2 * len);
+
+	/* Keep the merged WRITE off the network. */
+	mioo_ops = *mioo->ioo_ops;
+	mioo_ops.iro_iomaps_prepare = &ut_mock_io_launch_prepare;
+	mioo_ops.iro_iosm_handle_launch = &ut_mock_merge_iosm_handle_launch;
+	mioo->ioo_ops = &mioo_ops;
+	mxfer_ops = *mioo->ioo_nwxfer.nxr_ops;
+	mxfer_ops.nxo_distribute = &ut_mock_io_launch_distribute;
+	mioo->ioo_nwxfer.nxr_ops = &mxfer_ops;
+	mioo->ioo_oo.oo_oc.oc_cb_free = &ut_mock_merge_cb_free;
+
+	ut_merge_launch_nr = 0;
+	ut_merge_free_nr = 0;
+	for (i = 0; i < 2; ++i)
+		m0_op_launch_one(ops[i]);
+	m0__obj_io_merge_launch(ops, 2);
+	m0_sm_group_lock(mioo->ioo_oo.oo_sm_grp);
+	m0_sm_group_unlock(mioo->ioo_oo.oo_sm_grp);
+
+	/* Only the merged WRITE is issued. */
+	M0_UT_ASSERT(ut_merge_launch_nr == 1);
+	M0_UT_ASSERT(mop->op_sm.sm_state == M0_OS_LAUNCHED);
+	for (i = 0; i < 2; ++i) {
+		M0_UT_ASSERT(ops[i]->op_sm.sm_state == M0_OS_LAUNCHED);
+		M0_UT_ASSERT(obj_io_of(ops[i])->ioo_iomaps == NULL);
+	}
+	M0_UT_ASSERT(m0_atomic64_get(&merge->om_ref) == 2);
+
+	/* Complete the merged WRITE, as the io state machine would. */
+	m0_sm_group_lock(&mop->op_sm_group);
+	m0_sm_move(&mop->op_sm, 0, M0_OS_EXECUTED);
+	m0_op_executed(mop);
+	m0_sm_move(&mop->op_sm, 0, M0_OS_STABLE);
+	m0_op_stable(mop);
+	m0_sm_group_unlock(&mop->op_sm_group);
+	M0_UT_ASSERT(merge->om_done);
+	for (i = 0; i < 2; ++i) {
+		M0_UT_ASSERT(ops[i]->op_sm.sm_state == M0_OS_STABLE);
+		M0_UT_ASSERT(ops[i]->op_rc == 0);
+	}
+
+	/* The last finalised operation frees the merged WRITE. */
+	m0_op_fini(ops[0]);
+	m0_op_free(ops[0]);
+	M0_UT_ASSERT(m0_atomic64_get(&merge->om_ref) == 1);
+	M0_UT_ASSERT(ut_merge_free_nr == 0);
+	m0_op_fini(ops[1]);
+	m0_op_free(ops[1]);
+	M0_UT_ASSERT(ut_merge_free_nr == 1);
+
+	for (i = 0; i < 2; ++i) {
+		m0_bufvec_free(&attr[i]);
+		m0_bufvec_free(&data[i]);
+		m0_indexvec_free(&ext[i]);
+	}
+	instance->m0c_config->mc_is_write_merge = write_merge;
+	m0_entity_fini(&obj.ob_entity);
+}
+
 /**
  * Tests m0_obj_op, covering READ.
  */
@@ -927,6 +1189,14 @@ struct m0_ut_suite ut_suite_io = {
 				    &ut_test_segments_sort},
 		{ "obj_io_cb_free",
 				    &ut_test_obj_io_cb_free},
+		{ "obj_io_merge_adjacent",
+				    &ut_test_obj_io_merge_adjacent},
+		{ "obj_io_merge_attr_add",
+				    &ut_test_obj_io_merge_attr_add},
+		{ "obj_io_batch",
+				    &ut_test_obj_io_batch},
+		{ "obj_io_merge_launch",
+				    &ut_test_obj_io_merge_launch},
 		{ "m0_obj_op",
 				    &ut_test_m0_obj_op},
 		{ NULL, NULL },
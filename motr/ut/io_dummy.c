@@ -117,7 +117,9 @@ M0_INTERNAL struct m0_pdclust_instance *
 ut_dummy_pdclust_instance_create(struct m0_pdclust_layout  *pdl)
 {
 	int                         i;
+	int                         k;
 	struct m0_pdclust_instance *pdi;
+	struct tile_cache          *tc;
 
 	M0_ALLOC_PTR(pdi);
 	pdi->pi_base.li_l = &pdl->pl_base.sl_base;
@@ -125,6 +127,7 @@ ut_dummy_pdclust_instance_create(struct m0_pdclust_layout  *pdl)
 
 	/* pointless but required by the compiler. */
 	m0_pdclust_instance_bob_check(pdi);
+	m0_mutex_init(&pdi->pi_mutex);
 
 	/* Init the layout_instance part. */
 	m0_layout_instance_bob_init(&pdi->pi_base);
@@ -134,20 +137,23 @@ ut_dummy_pdclust_instance_create(struct m0_pdclust_layout  *pdl)
 	pdi->pi_base.li_ops = (struct m0_layout_instance_ops *)DUMMY_PTR;
 
 	/* tc */
-	M0_ALLOC_ARR(pdi->pi_tile_cache.tc_lcode, pdl->pl_attr.pa_P);
-	M0_ALLOC_ARR(pdi->pi_tile_cache.tc_permute, pdl->pl_attr.pa_P);
-	M0_ALLOC_ARR(pdi->pi_tile_cache.tc_inverse, pdl->pl_attr.pa_P);
-
-	for (i = 0; i < pdl->pl_attr.pa_P; i++) {
-		/*
-		 * These aren't valid values - but they keep the invariant
-		 * check happy
-		 */
-		pdi->pi_tile_cache.tc_lcode[i] = 0;
-
- 		/* tc->tc_permute[tc->tc_inverse[N]] = N */
-		pdi->pi_tile_cache.tc_permute[i] = i;
-		pdi->pi_tile_cache.tc_inverse[i] = i;
+	for (k = 0; k < M0_PDCLUST_TILE_CACHE_NR; k++) {
+		tc = &pdi->pi_tile_cache[k];
+		M0_ALLOC_ARR(tc->tc_lcode, pdl->pl_attr.pa_P);
+		M0_ALLOC_ARR(tc->tc_permute, pdl->pl_attr.pa_P);
+		M0_ALLOC_ARR(tc->tc_inverse, pdl->pl_attr.pa_P);
+
+		for (i = 0; i < pdl->pl_attr.pa_P; i++) {
+			/*
+			 * These aren't valid values - but they keep the
+			 * invariant check happy
+			 */
+			tc->tc_lcode[i] = 0;
+
+			/* tc->tc_permute[tc->tc_inverse[N]] = N */
+			tc->tc_permute[i] = i;
+			tc->tc_inverse[i] = i;
+		}
 	}
 
 	return pdi;
@@ -156,13 +162,18 @@ ut_dummy_pdclust_instance_create(struct m0_pdclust_layout  *pdl)
 M0_INTERNAL void
 ut_dummy_pdclust_instance_delete(struct m0_pdclust_instance *pdi)
 {
-	m0_free(pdi->pi_tile_cache.tc_lcode);
-	m0_free(pdi->pi_tile_cache.tc_permute);
-	m0_free(pdi->pi_tile_cache.tc_inverse);
+	int k;
+
+	for (k = 0; k < M0_PDCLUST_TILE_CACHE_NR; k++) {
+		m0_free(pdi->pi_tile_cache[k].tc_lcode);
+		m0_free(pdi->pi_tile_cache[k].tc_permute);
+		m0_free(pdi->pi_tile_cache[k].tc_inverse);
+	}
 
 	/* Fini the layout_instance part */
 	m0_layout_instance_bob_fini(&pdi->pi_base);
 
+	m0_mutex_fini(&pdi->pi_mutex);
 	m0_pdclust_instance_bob_fini(pdi);
 	m0_free(pdi);
 }
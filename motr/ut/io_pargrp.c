@@ -412,6 +412,8 @@ static void ut_test_pargrp_iomap_populate(void)
 	m0_ivec_cursor_init(&cursor, &ivec);
 	rc = pargrp_iomap_populate(map, &ivec, &cursor, NULL);
 	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(ioo->ioo_rmw_grp_nr == 1);
+	M0_UT_ASSERT(ioo->ioo_fullstripe_grp_nr == 0);
 
 	m0_indexvec_free(&ivec);
 	ut_dummy_paritybufs_delete(map, true);
@@ -811,11 +811,125 @@ static void ut_composite_io_divide(void)
                         m0_free(ext);
                 m0_free0(&layer);
         }
+	composite_extmap_fini(&clayout->ccl_rd_map);
 	m0_client_layout_free(layout);
 	m0_free(layer_ids);
 	m0_free(io_segs);
 }
 
+static void composite_ext_add(struct m0_composite_layer *layer,
+			      m0_bindex_t off, m0_bcount_t len)
+{
+	struct m0_composite_extent *ext;
+
+	M0_ALLOC_PTR(ext);
+	M0_UT_ASSERT(ext != NULL);
+	ext->ce_id = layer->ccr_subobj;
+	ext->ce_off = off;
+	ext->ce_len = len;
+	cext_tlink_init_at_tail(ext, &layer->ccr_rd_exts);
+}
+
+static void composite_sio_check(struct composite_sub_io *sio, int nr,
+				const struct io_seg *exp)
+{
+	struct composite_sub_io_ext *sio_ext;
+	int                          i = 0;
+
+	M0_UT_ASSERT(sio->si_nr_exts == nr);
+	m0_tl_for(sio_ext, &sio->si_exts, sio_ext) {
+		M0_UT_ASSERT(sio_ext->sie_off == exp[i].is_off);
+		M0_UT_ASSERT(sio_ext->sie_len == exp[i].is_len);
+		i++;
+	} m0_tl_endfor;
+}
+
+/*
+ * Overlapping extents of layers with different priorities: checks the
+ * flattened extent map, IO division over it and the rebuild of the map
+ * after a layer is deleted.
+ */
+static void ut_composite_extmap(void)
+{
+	int                                 rc;
+	int                                 nr_sios;
+	int                                 i;
+	m0_bcount_t                         u = 4096;
+	struct m0_uint128                   layer_ids[3];
+	struct m0_client_layout            *layout;
+	struct m0_client_composite_layout  *clayout;
+	struct m0_composite_layer          *layers[3];
+	struct m0_composite_layer          *layer;
+	struct m0_composite_extmap         *map;
+	struct composite_sub_io            *sio_arr;
+	struct io_seg                       io = { 2 * u, 12 * u };
+	const struct m0_composite_seg       segs[] = {
+		{  0 * u,  4 * u, 1 },
+		{  4 * u,  8 * u, 0 },
+		{  8 * u, 10 * u, 2 },
+		{ 10 * u, 12 * u, 1 },
+		{ 12 * u, 16 * u, 2 }
+	};
+
+	layout = m0_client_layout_alloc(M0_LT_COMPOSITE);
+	M0_UT_ASSERT(layout != NULL);
+	clayout = M0_AMB(clayout, layout, ccl_layout);
+	map = &clayout->ccl_rd_map;
+	M0_UT_ASSERT(!map->cxm_valid);
+	rc = composite_layout_add_layers(layout, 3, layer_ids);
+	M0_UT_ASSERT(rc == 0);
+	i = 0;
+	m0_tl_for(clayer, &clayout->ccl_layers, layer) {
+		layers[i++] = layer;
+	} m0_tl_endfor;
+	/* Layers are sorted by priority, layers[0] is the highest one. */
+	composite_ext_add(layers[0], 4 * u, 4 * u);
+	composite_ext_add(layers[1], 0, 6 * u);
+	composite_ext_add(layers[1], 10 * u, 2 * u);
+	composite_ext_add(layers[2], 0, 16 * u);
+	composite_ext_add(layers[2], 4 * u, 2 * u);
+
+	/* The map is built by the first IO. */
+	rc = do_composite_io_divide(clayout, 1, &io, &sio_arr, &nr_sios);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(map->cxm_valid);
+	M0_UT_ASSERT(map->cxm_nr == ARRAY_SIZE(segs));
+	M0_UT_ASSERT(m0_forall(j, ARRAY_SIZE(segs),
+			       map->cxm_segs[j].cs_off == segs[j].cs_off &&
+			       map->cxm_segs[j].cs_end == segs[j].cs_end &&
+			       map->cxm_segs[j].cs_layer == segs[j].cs_layer));
+	M0_UT_ASSERT(composite_extmap_lookup(map, 16 * u) == NULL);
+	M0_UT_ASSERT(composite_extmap_lookup(map, 9 * u) == &map->cxm_segs[2]);
+	M0_UT_ASSERT(nr_sios == 3);
+	composite_sio_check(&sio_arr[0], 1,
+			    (struct io_seg []){ { 4 * u, 4 * u } });
+	composite_sio_check(&sio_arr[1], 2,
+			    (struct io_seg []){ { 2 * u, 2 * u },
+						{ 10 * u, 2 * u } });
+	composite_sio_check(&sio_arr[2], 2,
+			    (struct io_seg []){ { 8 * u, 2 * u },
+						{ 12 * u, 2 * u } });
+	composite_sub_io_destroy(sio_arr, nr_sios);
+
+	/* Deleting the top layer uncovers the extents below it. */
+	m0_composite_layer_del(layout, layer_ids[0]);
+	M0_UT_ASSERT(!map->cxm_valid);
+	rc = do_composite_io_divide(clayout, 1, &io, &sio_arr, &nr_sios);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(map->cxm_nr == 4);
+	M0_UT_ASSERT(nr_sios == 2);
+	composite_sio_check(&sio_arr[0], 2,
+			    (struct io_seg []){ { 2 * u, 4 * u },
+						{ 10 * u, 2 * u } });
+	composite_sio_check(&sio_arr[1], 2,
+			    (struct io_seg []){ { 6 * u, 4 * u },
+						{ 12 * u, 2 * u } });
+	composite_sub_io_destroy(sio_arr, nr_sios);
+
+	composite_layout_put(layout);
+	m0_client_layout_free(layout);
+}
+
 static void ut_composite_layer_idx_extents_extract(void)
 {
 	int                                i;
@@ -953,6 +1067,8 @@ struct m0_ut_suite ut_suite_layout = {
 			&ut_composite_sub_io_ops_build},
 		{ "composite_io_divide",
 			&ut_composite_io_divide},
+		{ "composite_extmap",
+			&ut_composite_extmap},
 		{ "composite_layer_idx_extents_extract",
 			&ut_composite_layer_idx_extents_extract},
 		{ "composite_layer_idx_scan",
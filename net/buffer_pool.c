@@ -24,6 +24,7 @@
 #include "lib/memory.h"/* M0_ALLOC_PTR */
 #include "lib/errno.h" /* ENOMEM */
 #include "lib/arith.h" /* M0_CNT_INC, M0_CNT_DEC */
+#include "lib/atomic.h"/* m0_atomic64_cas */
 #include "motr/magic.h"
 #include "net/buffer_pool.h"
 #include "net/net_internal.h"
@@ -46,6 +47,9 @@ static bool pool_colour_check(const struct m0_net_buffer_pool *pool);
 static bool pool_lru_buffer_check(const struct m0_net_buffer_pool *pool);
 static bool colour_is_valid(const struct m0_net_buffer_pool *pool,
 			    uint32_t colour);
+static struct m0_net_buffer *pool_cache_steal(struct m0_net_buffer_pool *pool,
+					      uint32_t colour);
+static void pool_caches_drain(struct m0_net_buffer_pool *pool);
 
 M0_INTERNAL bool m0_net_buffer_pool_invariant(const struct m0_net_buffer_pool
 					      *pool)
@@ -62,7 +66,9 @@ M0_INTERNAL bool m0_net_buffer_pool_invariant(const struct m0_net_buffer_pool
 		    m0_net_pool_tlist_length(&pool->nbp_lru)) &&
 		_0C(pool_colour_check(pool)) &&
 		_0C(pool_lru_buffer_check(pool)) &&
-		_0C((pool->nbp_colours_nr == 0) == (pool->nbp_colours == NULL));
+		_0C((pool->nbp_colours_nr == 0) ==
+		    (pool->nbp_colours == NULL)) &&
+		_0C((pool->nbp_colours == NULL) == (pool->nbp_caches == NULL));
 }
 
 static bool pool_colour_check(const struct m0_net_buffer_pool *pool)
@@ -102,12 +108,17 @@ M0_INTERNAL int m0_net_buffer_pool_init(struct m0_net_buffer_pool *pool,
 	pool->nbp_align      = shift;
 	pool->nbp_dont_dump  = dont_dump;
 
-	if (colours == 0)
+	if (colours == 0) {
 		pool->nbp_colours = NULL;
-	else {
+		pool->nbp_caches  = NULL;
+	} else {
 		M0_ALLOC_ARR(pool->nbp_colours, colours);
-		if (pool->nbp_colours == NULL)
+		M0_ALLOC_ARR(pool->nbp_caches, colours);
+		if (pool->nbp_colours == NULL || pool->nbp_caches == NULL) {
+			m0_free0(&pool->nbp_colours);
+			m0_free0(&pool->nbp_caches);
 			return M0_ERR(-ENOMEM);
+		}
 	}
 	m0_mutex_init(&pool->nbp_mutex);
 	m0_net_pool_tlist_init(&pool->nbp_lru);
@@ -169,6 +180,7 @@ M0_INTERNAL void m0_net_buffer_pool_fini(struct m0_net_buffer_pool *pool)
 	m0_net_buffer_pool_lock(pool);
 	M0_ASSERT(m0_net_buffer_pool_invariant(pool));
 
+	pool_caches_drain(pool);
 	M0_ASSERT(pool->nbp_free == pool->nbp_buf_nr);
 
 	m0_tl_for(m0_net_pool, &pool->nbp_lru, nb) {
@@ -181,6 +193,7 @@ M0_INTERNAL void m0_net_buffer_pool_fini(struct m0_net_buffer_pool *pool)
 		m0_net_tm_tlist_fini(&pool->nbp_colours[i]);
 	if (pool->nbp_colours != NULL)
 		m0_free(pool->nbp_colours);
+	m0_free0(&pool->nbp_caches);
 	m0_mutex_fini(&pool->nbp_mutex);
 }
 
@@ -221,17 +234,22 @@ m0_net_buffer_pool_get(struct m0_net_buffer_pool *pool, uint32_t colour)
 	M0_PRE_EX(m0_net_buffer_pool_invariant(pool));
 	M0_PRE(colour_is_valid(pool, colour));
 
-	if (pool->nbp_free <= 0)
-		return NULL;
-	if (colour != M0_BUFFER_ANY_COLOUR &&
-	    !m0_net_tm_tlist_is_empty(&pool->nbp_colours[colour]))
-		nb = m0_net_tm_tlist_head(&pool->nbp_colours[colour]);
-	else
-		nb = m0_net_pool_tlist_head(&pool->nbp_lru);
-	M0_ASSERT(nb != NULL);
-	m0_net_pool_tlist_del(nb);
-	m0_net_tm_tlist_remove(nb);
-	M0_CNT_DEC(pool->nbp_free);
+	if (pool->nbp_free <= 0) {
+		/* Cached buffers are still free, take one of them. */
+		nb = pool_cache_steal(pool, colour);
+		if (nb == NULL)
+			return NULL;
+	} else {
+		if (colour != M0_BUFFER_ANY_COLOUR &&
+		    !m0_net_tm_tlist_is_empty(&pool->nbp_colours[colour]))
+			nb = m0_net_tm_tlist_head(&pool->nbp_colours[colour]);
+		else
+			nb = m0_net_pool_tlist_head(&pool->nbp_lru);
+		M0_ASSERT(nb != NULL);
+		m0_net_pool_tlist_del(nb);
+		m0_net_tm_tlist_remove(nb);
+		M0_CNT_DEC(pool->nbp_free);
+	}
 	if (pool->nbp_free < pool->nbp_threshold)
 		pool->nbp_ops->nbpo_below_threshold(pool);
 	nb->nb_pool = pool;
@@ -241,6 +259,20 @@ m0_net_buffer_pool_get(struct m0_net_buffer_pool *pool, uint32_t colour)
 	return nb;
 }
 
+/** Adds a free buffer to the pool lists. */
+static void pool_buffer_add(struct m0_net_buffer_pool *pool,
+			    struct m0_net_buffer *buf, uint32_t colour)
+{
+	M0_ASSERT(buf->nb_magic == M0_NET_BUFFER_LINK_MAGIC);
+	M0_ASSERT(!m0_net_pool_tlink_is_in(buf));
+	if (colour != M0_BUFFER_ANY_COLOUR) {
+		M0_ASSERT(!m0_net_tm_tlink_is_in(buf));
+		m0_net_tm_tlist_add(&pool->nbp_colours[colour], buf);
+	}
+	m0_net_pool_tlist_add_tail(&pool->nbp_lru, buf);
+	M0_CNT_INC(pool->nbp_free);
+}
+
 M0_INTERNAL void m0_net_buffer_pool_put(struct m0_net_buffer_pool *pool,
 					struct m0_net_buffer *buf,
 					uint32_t colour)
@@ -254,14 +286,7 @@ M0_INTERNAL void m0_net_buffer_pool_put(struct m0_net_buffer_pool *pool,
 	M0_PRE(pool->nbp_ndom == buf->nb_dom);
 
 	M0_ENTRY();
-	M0_ASSERT(buf->nb_magic == M0_NET_BUFFER_LINK_MAGIC);
-	M0_ASSERT(!m0_net_pool_tlink_is_in(buf));
-	if (colour != M0_BUFFER_ANY_COLOUR) {
-		M0_ASSERT(!m0_net_tm_tlink_is_in(buf));
-		m0_net_tm_tlist_add(&pool->nbp_colours[colour], buf);
-	}
-	m0_net_pool_tlist_add_tail(&pool->nbp_lru, buf);
-	M0_CNT_INC(pool->nbp_free);
+	pool_buffer_add(pool, buf, colour);
 	if (pool->nbp_free == 1)
 		pool->nbp_ops->nbpo_not_empty(pool);
 	M0_POST_EX(m0_net_buffer_pool_invariant(pool));
@@ -323,6 +348,153 @@ M0_INTERNAL bool m0_net_buffer_pool_prune(struct m0_net_buffer_pool *pool)
 	return true;
 }
 
+/** Takes a buffer from the cache, returns NULL if the cache is empty. */
+static struct m0_net_buffer *cache_take(struct m0_net_buffer_pool_cache *cache)
+{
+	int64_t v;
+	int     i;
+
+	for (i = 0; i < ARRAY_SIZE(cache->nbc_slot); ++i) {
+		v = cache->nbc_slot[i];
+		if (v != 0 && m0_atomic64_cas(&cache->nbc_slot[i], v, 0))
+			return (struct m0_net_buffer *)v;
+	}
+	return NULL;
+}
+
+/** Puts the buffer to the cache, returns false if the cache is full. */
+static bool cache_give(struct m0_net_buffer_pool_cache *cache,
+		       struct m0_net_buffer *nb)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache->nbc_slot); ++i) {
+		if (cache->nbc_slot[i] == 0 &&
+		    m0_atomic64_cas(&cache->nbc_slot[i], 0, (int64_t)nb))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Takes a buffer from the cache of the colour or, failing that, from the
+ * caches of the other colours.
+ */
+static struct m0_net_buffer *pool_cache_steal(struct m0_net_buffer_pool *pool,
+					      uint32_t colour)
+{
+	struct m0_net_buffer *nb = NULL;
+	uint32_t              i;
+
+	if (pool->nbp_caches == NULL)
+		return NULL;
+	if (colour == M0_BUFFER_ANY_COLOUR)
+		colour = 0;
+	for (i = 0; i < pool->nbp_colours_nr && nb == NULL; ++i)
+		nb = cache_take(&pool->nbp_caches[(colour + i) %
+						  pool->nbp_colours_nr]);
+	if (nb != NULL)
+		pool->nbp_caches[colour].nbc_steal++;
+	return nb;
+}
+
+/** Returns all cached buffers to the pool. */
+static void pool_caches_drain(struct m0_net_buffer_pool *pool)
+{
+	struct m0_net_buffer_pool_cache *cache;
+	struct m0_net_buffer            *nb;
+	uint32_t                         i;
+
+	M0_PRE(m0_net_buffer_pool_is_locked(pool));
+
+	for (i = 0; i < pool->nbp_colours_nr; ++i) {
+		cache = &pool->nbp_caches[i];
+		while ((nb = cache_take(cache)) != NULL)
+			pool_buffer_add(pool, nb, i);
+		M0_LOG(M0_DEBUG, "pool=%p colour=%u hit=%"PRIu64" miss=%"PRIu64
+		       " steal=%"PRIu64" drain=%"PRIu64, pool, i,
+		       cache->nbc_hit, cache->nbc_miss, cache->nbc_steal,
+		       cache->nbc_drain);
+	}
+}
+
+M0_INTERNAL struct m0_net_buffer *
+m0_net_buffer_pool_cache_get(struct m0_net_buffer_pool *pool, uint32_t colour)
+{
+	struct m0_net_buffer_pool_cache *cache;
+	struct m0_net_buffer            *nb;
+	struct m0_net_buffer            *extra;
+	int                              i;
+
+	M0_PRE(colour_is_valid(pool, colour));
+
+	if (colour == M0_BUFFER_ANY_COLOUR || pool->nbp_caches == NULL) {
+		m0_net_buffer_pool_lock(pool);
+		nb = m0_net_buffer_pool_get(pool, colour);
+		m0_net_buffer_pool_unlock(pool);
+		return nb;
+	}
+	cache = &pool->nbp_caches[colour];
+	nb = cache_take(cache);
+	if (nb != NULL) {
+		cache->nbc_hit++;
+		M0_POST(nb->nb_pool == pool);
+		return nb;
+	}
+	cache->nbc_miss++;
+	/* Refill the cache. */
+	m0_net_buffer_pool_lock(pool);
+	nb = m0_net_buffer_pool_get(pool, colour);
+	for (i = 1; nb != NULL && i < M0_NET_BUFFER_POOL_CACHE_BATCH &&
+		    pool->nbp_free > pool->nbp_threshold; ++i) {
+		extra = m0_net_buffer_pool_get(pool, colour);
+		if (!cache_give(cache, extra)) {
+			m0_net_buffer_pool_put(pool, extra, colour);
+			break;
+		}
+	}
+	m0_net_buffer_pool_unlock(pool);
+	M0_POST(ergo(nb != NULL, nb->nb_pool == pool));
+	return nb;
+}
+
+M0_INTERNAL void m0_net_buffer_pool_cache_put(struct m0_net_buffer_pool *pool,
+					      struct m0_net_buffer *buf,
+					      uint32_t colour)
+{
+	struct m0_net_buffer_pool_cache *cache;
+	struct m0_net_buffer            *nb;
+	int                              i;
+
+	M0_PRE(buf != NULL);
+	M0_PRE(colour_is_valid(pool, colour));
+
+	/*
+	 * nbp_free is read without the lock. A stale value only makes the
+	 * buffer go to the cache while the pool is low, in which case one of
+	 * the buffers taken from the pool since then notifies the pool users
+	 * when it is put back.
+	 */
+	if (colour != M0_BUFFER_ANY_COLOUR && pool->nbp_caches != NULL &&
+	    pool->nbp_free > pool->nbp_threshold) {
+		cache = &pool->nbp_caches[colour];
+		if (cache_give(cache, buf))
+			return;
+		cache->nbc_drain++;
+	}
+	m0_net_buffer_pool_lock(pool);
+	m0_net_buffer_pool_put(pool, buf, colour);
+	/* Drain a batch of cached buffers together with this one. */
+	for (i = 1; colour != M0_BUFFER_ANY_COLOUR && pool->nbp_caches != NULL &&
+		    i < M0_NET_BUFFER_POOL_CACHE_BATCH; ++i) {
+		nb = cache_take(&pool->nbp_caches[colour]);
+		if (nb == NULL)
+			break;
+		m0_net_buffer_pool_put(pool, nb, colour);
+	}
+	m0_net_buffer_pool_unlock(pool);
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /** @} */ /* end of net_buffer_pool */
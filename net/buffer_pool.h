@@ -56,6 +56,14 @@
 	  Pool is protected by a lock, to get or put a buffer into the pool user
 	  must acquire the lock and release the lock once its usage is over.
 
+	  Every colour also has a small cache of free buffers, used by
+	  m0_net_buffer_pool_cache_get() and m0_net_buffer_pool_cache_put()
+	  without taking the pool lock. A cache is refilled from the pool and
+	  drained to it M0_NET_BUFFER_POOL_CACHE_BATCH buffers at a time.
+	  Cached buffers are not counted in m0_net_buffer_pool::nbp_free, but
+	  m0_net_buffer_pool_get() takes them from the caches when the pool is
+	  empty, so they are never lost for the users of the locked interface.
+
 	  To finalize the pool all the buffers must be returned back to the pool
 	  (i.e number of free buffers must be equal to the total number of
 	   buffers).
@@ -120,6 +128,13 @@
 	m0_net_buffer_pool_unlock(&bp);
     @endcode
 
+    - To get and put a buffer without taking the pool lock:
+    @code
+	nb = m0_net_buffer_pool_cache_get(&bp, colour);
+	...
+	m0_net_buffer_pool_cache_put(&bp, nb, colour);
+    @endcode
+
     - To remove a buffer from the pool:
     @code
 	m0_net_buffer_pool_lock(&bp);
@@ -140,6 +155,10 @@
 enum {
 	M0_BUFFER_ANY_COLOUR	     = ~0,
 	M0_NET_BUFFER_POOL_THRESHOLD = 2,
+	/** Number of buffers a colour cache can hold. */
+	M0_NET_BUFFER_POOL_CACHE_NR    = 16,
+	/** Number of buffers moved between a cache and the pool at once. */
+	M0_NET_BUFFER_POOL_CACHE_BATCH = M0_NET_BUFFER_POOL_CACHE_NR / 2,
 };
 
 struct m0_net_buffer_pool;
@@ -241,6 +260,46 @@ M0_INTERNAL void m0_net_buffer_pool_put(struct m0_net_buffer_pool *pool,
  */
 M0_INTERNAL bool m0_net_buffer_pool_prune(struct m0_net_buffer_pool *pool);
 
+/**
+   Gets a buffer from the cache of the colour. If the cache is empty, it is
+   refilled from the pool under the pool lock. If the pool is empty too, a
+   buffer is taken from the cache of another colour.
+
+   M0_BUFFER_ANY_COLOUR or a pool without colours takes the pool lock.
+   @pre m0_net_buffer_pool_is_not_locked(pool)
+   @pre colour == M0_BUFFER_ANY_COLOUR || colour < pool->nbp_colours_nr
+   @post ergo(result != NULL, result->nb_pool == pool)
+ */
+M0_INTERNAL struct m0_net_buffer *
+m0_net_buffer_pool_cache_get(struct m0_net_buffer_pool *pool, uint32_t colour);
+
+/**
+   Puts the buffer to the cache of the colour. If the cache is full, the
+   buffer and a batch of cached buffers are returned to the pool. When the
+   pool is not above its threshold, the buffer is returned to the pool, so
+   that its users waiting for buffers are notified.
+   @pre m0_net_buffer_pool_is_not_locked(pool)
+   @pre the same as of m0_net_buffer_pool_put().
+ */
+M0_INTERNAL void m0_net_buffer_pool_cache_put(struct m0_net_buffer_pool *pool,
+					      struct m0_net_buffer *buf,
+					      uint32_t colour);
+
+/**
+   Lock-free cache of free buffers of a colour.
+
+   A slot either is 0 or holds a pointer to a free buffer. Buffers are put to
+   and taken from the slots with m0_atomic64_cas().
+ */
+struct m0_net_buffer_pool_cache {
+	int64_t  nbc_slot[M0_NET_BUFFER_POOL_CACHE_NR];
+	/** Statistics, updated without synchronisation. */
+	uint64_t nbc_hit;
+	uint64_t nbc_miss;
+	uint64_t nbc_steal;
+	uint64_t nbc_drain;
+};
+
 /** Buffer pool. */
 struct m0_net_buffer_pool {
 	/** Number of free buffers in the pool. */
@@ -271,6 +330,8 @@ struct m0_net_buffer_pool {
 	    lists.
 	*/
 	struct m0_tl			    *nbp_colours;
+	/** An array of nbp_colours_nr buffer caches. */
+	struct m0_net_buffer_pool_cache	    *nbp_caches;
 	/** Alignment for network buffers */
 	unsigned			     nbp_align;
 	/** Memory in this pool is excluded in core dump or not */
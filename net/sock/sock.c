@@ -292,14 +292,17 @@
  * --------
  *
  * Network communication over sockets happen in the form of "packets". There are
- * 2 types of packets:
+ * 3 types of packets:
  *
  *     - PUT packet contains data to be copied from the source buffer to the
  *       target buffer. A PUT packet is sent from the peer containing the source
  *       buffer to the peer containing the target buffer;
  *
  *     - GET packet is a request to initiate transfer of the source buffer to
- *       the target buffer. It is sent to the peer containing the source buffer.
+ *       the target buffer. It is sent to the peer containing the source buffer;
+ *
+ *     - DONE packet notifies the passive peer that the data have already been
+ *       copied directly (see Direct copy section below). It has no payload.
  *
  * A packet on the wire starts with the header (struct packet). The header
  * identifies the source buffer, the target buffer and, for a PUT packet,
@@ -526,6 +529,57 @@
  *
  * sock has its own provisioning, see the comment in pk_header_done().
  *
+ * Direct copy
+ * -----------
+ *
+ * When both peers of a bulk transfer run on the same host, moving the data
+ * through a loopback socket costs 2 memory copies and a number of system calls
+ * on each side. Instead, the receiving side pulls the data directly from the
+ * address space of the sending process with process_vm_readv(2).
+ *
+ * To make this possible, a descriptor of a M0_NET_QT_PASSIVE_BULK_SEND buffer
+ * (struct ndesc) carries, in addition to struct bdesc, the host identifier
+ * (sock_host_id()), the pid of the passive process and the address of the
+ * passive buffer bufvec in that process (bdesc_create()). When an
+ * M0_NET_QT_ACTIVE_BULK_RECV buffer is queued and the passive peer runs on the
+ * same host and in the same pid namespace, buf_add() places the buffer on
+ * ma::t_direct list and wakes the poller thread up (ma::t_wakefd).
+ *
+ * The poller thread copies the data (ma_direct()) after it has released the ma
+ * lock at the end of an iteration, so that neither user threads nor socket
+ * processing wait for the copy. direct_copy() verifies that the passive buffer
+ * is still queued (by reading its cookie), reads its bufvec, copies the data
+ * and reads the cookie again to check that the passive buffer has not been
+ * completed while the data were copied. Passive buffers invalidate their
+ * cookies on completion (buf_fini()), before the completion call-back returns
+ * the buffer memory to the user. At the beginning of the next iteration, under
+ * the ma lock, ma_direct_done() starts the writer of the active buffer. On
+ * success, instead of a GET packet, the writer sends a single DONE packet
+ * (done_op), which informs the passive side that the transfer is complete
+ * (pk_header_done()). The active buffer completes when the DONE packet has
+ * been written.
+ *
+ * Only the receiver ever accesses the memory of the other process and it only
+ * reads it, so a misbehaving or racing peer can at worst corrupt the data it
+ * sends, never the memory of the receiver. This is why there is no "push"
+ * direction: with process_vm_writev(2) the active sender would write into a
+ * passive receive buffer that can be cancelled and reused by its owner at any
+ * moment. Data sent by an active buffer always go through sockets.
+ *
+ * If direct copy is not possible (different hosts, no permission to access the
+ * other process, the passive buffer has been dequeued, etc.), the usual packet
+ * protocol is used. Lack of permission is remembered in the end-point
+ * (ep::e_nodirect), so that the system calls are not retried.
+ *
+ * Messages are always sent through sockets: the receiving buffer is selected by
+ * the receiver, so the sender does not know where to copy the data.
+ *
+ * Descriptors with the direct copy fields and DONE packets are not understood
+ * by older peers, hence M0_NET_SOCK_PROTO_VERSION 2.
+ *
+ * Direct copy can be disabled by setting M0_NET_SOCK_NODIRECT environment
+ * variable, e.g., to compare performance.
+ *
  * Limitations and options
  * -----------------------
  *
@@ -617,6 +671,10 @@
 #include <arpa/inet.h>                     /* inet_pton, htons */
 #include <string.h>                        /* strchr */
 #include <unistd.h>                        /* close */
+#include <stdlib.h>                        /* getenv */
+#include <fcntl.h>                         /* open */
+#include <sys/stat.h>                      /* stat */
+#include <sys/eventfd.h>                   /* eventfd */
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_NET
 #include "lib/trace.h"
@@ -632,6 +690,10 @@
 #include "lib/bitmap.h"
 #include "lib/refs.h"
 #include "lib/time.h"
+#include "lib/hash.h"                      /* m0_hash */
+#include "lib/hash_fnc.h"                  /* m0_hash_fnc_fnv1 */
+#include "lib/arith.h"                     /* min3 */
+#include "lib/finject.h"                   /* M0_FI_ENABLED */
 #include "sm/sm.h"
 #include "motr/magic.h"
 #include "net/net.h"
@@ -639,6 +701,7 @@
 #include "net/net_internal.h"              /* m0_net__tm_invariant */
 #include "format/format.h"
 
+#include "net/sock/sock.h"
 #include "net/sock/xcode.h"
 #include "net/sock/xcode_xc.h"
 
@@ -757,6 +820,11 @@ struct ep {
 	struct m0_tl            e_sock;
 	/** Writers sending data to this end-point. */
 	struct m0_tl            e_writer;
+	/**
+	 * True iff direct copy to the process of this end-point is not
+	 * permitted. See "Direct copy" section.
+	 */
+	bool                    e_nodirect;
 #ifdef EP_DEBUG
 	int e_r_mover;
 	int e_r_sock;
@@ -800,6 +868,13 @@ struct ma {
 	struct m0_mutex            t_endlock;
 	/** List of completed buffers. */
 	struct m0_tl               t_done;
+	/**
+	 * List of active buffers waiting for a direct copy. See "Direct copy"
+	 * section.
+	 */
+	struct m0_tl               t_direct;
+	/** eventfd(2) used to wake the poller thread up. */
+	int                        t_wakefd;
 };
 
 /**
@@ -902,6 +977,16 @@ struct buf {
 	struct ep            *b_other;
 	/** Linkage in the list of completed buffers (ma::t_done). */
 	struct m0_tlink       b_linkage;
+	/**
+	 * Linkage in the list of buffers waiting for a direct copy
+	 * (ma::t_direct).
+	 */
+	struct m0_tlink       b_dlinkage;
+	uint64_t              b_dmagix;
+	/** Descriptor of the passive buffer for a direct copy. */
+	struct ndesc          b_nd;
+	/** Result of the direct copy, see ma_direct(). */
+	int                   b_drc;
 	/** Not currently used. */
 	m0_bindex_t           b_offset;
 	/**
@@ -986,6 +1071,12 @@ M0_TL_DESCR_DEFINE(b, "buffers",
 		   M0_NET_SOCK_BUF_MAGIC, M0_NET_SOCK_BUF_HEAD_MAGIC);
 M0_TL_DEFINE(b, static, struct buf);
 
+M0_TL_DESCR_DEFINE(d, "direct",
+		   static, struct buf, b_dlinkage, b_dmagix,
+		   M0_NET_SOCK_BUF_DIRECT_MAGIC,
+		   M0_NET_SOCK_BUF_DIRECT_HEAD_MAGIC);
+M0_TL_DEFINE(d, static, struct buf);
+
 static int  dom_init(struct m0_net_xprt *xprt, struct m0_net_domain *dom);
 static void dom_fini(struct m0_net_domain *dom);
 static int  ma_init(struct m0_net_transfer_mc *ma);
@@ -1019,6 +1110,9 @@ static bool ma_invariant(const struct ma *ma);
 static void ma_event_post (struct ma *ma, enum m0_net_tm_state state);
 static void ma_buf_done   (struct ma *ma);
 static void ma_buf_timeout(struct ma *ma);
+static void ma_direct     (struct ma *ma, struct m0_tl *todo);
+static void ma_direct_done(struct ma *ma, struct m0_tl *todo);
+static void ma_wake       (struct ma *ma);
 static struct buf *ma_recv_buf(struct ma *ma, m0_bcount_t len);
 
 static struct ep *ma_src(struct ma *ma);
@@ -1069,8 +1163,13 @@ static void buf_complete (struct buf *buf);
 
 static int bdesc_create(struct addr *addr, struct buf *buf,
 			struct m0_net_buf_desc *out);
-static int bdesc_encode(const struct bdesc *bd, struct m0_net_buf_desc *out);
-static int bdesc_decode(const struct m0_net_buf_desc *nbd, struct bdesc *out);
+static int bdesc_encode(const struct ndesc *nd, struct m0_net_buf_desc *out);
+static int bdesc_decode(const struct m0_net_buf_desc *nbd, struct ndesc *out);
+
+static bool direct_is_possible(const struct ep *ep, const struct ndesc *nd);
+static int  direct_copy(struct buf *buf);
+static int  direct_io  (pid_t pid, const struct iovec *liv,
+			const struct iovec *riv, int nr, m0_bcount_t nob);
 
 static void mover_init(struct mover *m, struct ma *ma,
 		       const struct mover_op_vec *vop);
@@ -1111,6 +1210,7 @@ static int writer_write   (struct mover *self, struct sock *s);
 static int writer_pk_done (struct mover *self, struct sock *s);
 static int get_idle       (struct mover *self, struct sock *s);
 static int get_pk         (struct mover *self, struct sock *s);
+static int done_pk        (struct mover *self, struct sock *s);
 static void writer_done   (struct mover *self, struct sock *s);
 static void writer_error  (struct mover *w, struct sock *s, int rc);
 
@@ -1132,12 +1232,22 @@ static const struct mover_op_vec stream_reader_op;
 static const struct mover_op_vec dgram_reader_op;
 static const struct mover_op_vec writer_op;
 static const struct mover_op_vec get_op;
+static const struct mover_op_vec done_op;
 
 static const struct pfamily  pf[];
 static const struct socktype stype[];
 
 static const struct m0_format_tag put_tag;
 static const struct m0_format_tag get_tag;
+static const struct m0_format_tag done_tag;
+
+/**
+ * Identifier of the host and pid namespace of this process, 0 if direct copy
+ * is disabled. Set by m0_net_sock_mod_init().
+ */
+static uint64_t sock_host;
+/** Process id, cached by m0_net_sock_mod_init(). */
+static pid_t    sock_pid;
 
 static const struct pfamily pf[] = {
 	[AF_UNIX]  = {
@@ -1225,7 +1335,8 @@ static bool ma_invariant(const struct ma *ma)
 		_0C(m0_forall(i, ARRAY_SIZE(net->ntm_q),
 			m0_tl_forall(m0_net_tm, nb, &net->ntm_q[i],
 				     buf_invariant(nb->nb_xprt_private)))) &&
-		_0C(m0_tl_forall(b, buf, &ma->t_done, buf_invariant(buf)));
+		_0C(m0_tl_forall(b, buf, &ma->t_done, buf_invariant(buf))) &&
+		_0C(m0_tl_forall(d, buf, &ma->t_direct, buf_invariant(buf)));
 }
 
 static bool sock_invariant(const struct sock *s)
@@ -1301,7 +1412,7 @@ static bool ep_invariant(const struct ep *ep)
 static bool mover_invariant(const struct mover *m)
 {
 	return  _0C(m_tlink_is_in(m) == (m->m_ep != NULL)) &&
-		_0C(M0_IN(m->m_op, (&writer_op, &get_op)) ||
+		_0C(M0_IN(m->m_op, (&writer_op, &get_op, &done_op)) ||
 		    m0_exists(i, ARRAY_SIZE(stype),
 			      stype[i].st_reader == m->m_op));
 }
@@ -1342,6 +1453,8 @@ static void poller(struct ma *ma)
 {
 	enum { EV_NR = 256 };
 	struct epoll_event ev[EV_NR] = {};
+	struct m0_tl       todo;
+	struct buf        *buf;
 	int                nr;
 	int                i;
 	/*
@@ -1360,8 +1473,12 @@ static void poller(struct ma *ma)
 	 * Because of this, we do not assert ma states here.
 	 */
 	ma_event_post(ma, M0_NET_TM_STARTED);
+	/* Buffers, direct copy of which has been done outside of the lock. */
+	d_tlist_init(&todo);
 	while (1) {
-		nr = epoll_wait(ma->t_epollfd, ev, ARRAY_SIZE(ev), 1000);
+		/* Do not sleep if direct copies are waiting for completion. */
+		nr = epoll_wait(ma->t_epollfd, ev, ARRAY_SIZE(ev),
+				d_tlist_is_empty(&todo) ? 1000 : 0);
 		if (nr == -1) {
 			M0_LOG(M0_DEBUG, "epoll: %i.", -errno);
 			M0_ASSERT(errno == EINTR);
@@ -1400,9 +1517,21 @@ static void poller(struct ma *ma)
 		if (ma->t_shutdown)
 			break;
 		M0_ASSERT(ma_is_locked(ma) && ma_invariant(ma));
+		/*
+		 * Start writers for the direct copies before anything else, so
+		 * that these buffers can be completed (and finalised) below.
+		 */
+		ma_direct_done(ma, &todo);
 		for (i = 0; i < nr; ++i) {
 			struct sock *s = ev[i].data.ptr;
 
+			if (s == NULL) { /* ma_wake(). */
+				uint64_t cnt;
+
+				if (read(ma->t_wakefd, &cnt, sizeof cnt) < 0)
+					M0_LOG(M0_DEBUG, "wake: %i.", -errno);
+				continue;
+			}
 			if (s->s_sm.sm_state == S_DELETED)
 				continue;
 			if (sock_event(s, ev[i].events))
@@ -1427,8 +1556,18 @@ static void poller(struct ma *ma)
 		 */
 		ma_prune(ma);
 		M0_ASSERT(ma_invariant(ma));
+		m0_tl_teardown(d, &ma->t_direct, buf)
+			d_tlist_add_tail(&todo, buf);
 		ma_unlock(ma);
+		ma_direct(ma, &todo);
 	}
+	/*
+	 * ma__fini() holds the ma lock and waits for this thread, nobody else
+	 * touches the list.
+	 */
+	m0_tl_teardown(d, &todo, buf)
+		;
+	d_tlist_fini(&todo);
 }
 
 /**
@@ -1458,11 +1597,13 @@ static int ma_init(struct m0_net_transfer_mc *net)
 	M0_ALLOC_PTR(ma);
 	if (ma != NULL) {
 		ma->t_epollfd = -1;
+		ma->t_wakefd = -1;
 		ma->t_shutdown = false;
 		net->ntm_xprt_private = ma;
 		ma->t_ma = net;
 		s_tlist_init(&ma->t_deathrow);
 		b_tlist_init(&ma->t_done);
+		d_tlist_init(&ma->t_direct);
 		m0_mutex_init(&ma->t_endlock);
 		result = 0;
 	} else
@@ -1491,6 +1632,7 @@ static void ma_prune(struct ma *ma)
 static void ma__fini(struct ma *ma)
 {
 	struct m0_net_end_point *net;
+	struct buf              *buf;
 
 	M0_PRE(ma_is_locked(ma));
 	if (!ma->t_shutdown) {
@@ -1517,8 +1659,15 @@ static void ma__fini(struct ma *ma)
 			close(ma->t_epollfd);
 			ma->t_epollfd = -1;
 		}
+		if (ma->t_wakefd >= 0) {
+			close(ma->t_wakefd);
+			ma->t_wakefd = -1;
+		}
 		ma_buf_done(ma);
 		ma_prune(ma);
+		m0_tl_teardown(d, &ma->t_direct, buf)
+			;
+		d_tlist_fini(&ma->t_direct);
 		b_tlist_fini(&ma->t_done);
 		s_tlist_fini(&ma->t_deathrow);
 		m0_mutex_fini(&ma->t_endlock);
@@ -1561,7 +1710,7 @@ static int ma_start(struct m0_net_transfer_mc *net, const char *name)
 	M0_PRE(net->ntm_state == M0_NET_TM_STARTING);
 
 	/*
-	 * - initialise epoll
+	 * - initialise epoll and the wake-up eventfd
 	 *
 	 * - parse the address and create the source endpoint
 	 *
@@ -1574,10 +1723,18 @@ static int ma_start(struct m0_net_transfer_mc *net, const char *name)
 	 * event (outside of ma lock).
 	 */
 	ma->t_epollfd = epoll_create(1);
-	if (ma->t_epollfd >= 0) {
-		struct ep *ep;
-
-		result = ep_find(ma, name, &ep);
+	ma->t_wakefd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (ma->t_epollfd >= 0 && ma->t_wakefd >= 0) {
+		struct epoll_event ev = {
+			.events   = EPOLLIN,
+			.data.ptr = NULL /* See poller(). */
+		};
+		struct ep         *ep;
+
+		result = epoll_ctl(ma->t_epollfd, EPOLL_CTL_ADD, ma->t_wakefd,
+				   &ev) == 0 ? 0 : -errno;
+		if (result == 0)
+			result = ep_find(ma, name, &ep);
 		if (result == 0) {
 			result = sock_init(-1, ep, NULL, EPOLLET);
 			if (result == 0) {
@@ -1700,6 +1857,72 @@ static void ma_buf_done(struct ma *ma)
 	M0_POST(ma_invariant(ma));
 }
 
+/**
+ * Copies data for the buffers taken from ma::t_direct.
+ *
+ * This is called by the poller thread without the ma lock. The buffers cannot
+ * be completed while they are on the "todo" list: completion call-backs are
+ * only invoked by the poller thread (buf_done()). See "Direct copy" section.
+ */
+static void ma_direct(struct ma *ma, struct m0_tl *todo)
+{
+	struct buf *buf;
+
+	M0_PRE(!ma_is_locked(ma));
+	m0_tl_for(d, todo, buf) {
+		buf->b_drc = direct_copy(buf);
+	} m0_tl_endfor;
+}
+
+/**
+ * Starts the writers of the buffers, direct copy of which has been attempted
+ * by ma_direct().
+ *
+ * A writer either sends the DONE packet or, if the copy failed, falls back to
+ * the GET packet.
+ */
+static void ma_direct_done(struct ma *ma, struct m0_tl *todo)
+{
+	struct buf *buf;
+
+	M0_PRE(ma_is_locked(ma) && ma_invariant(ma));
+	m0_tl_teardown(d, todo, buf) {
+		struct ep    *ep = buf->b_other;
+		struct mover *w  = &buf->b_writer;
+		int           result;
+
+		buf->b_other = NULL;
+		if (M0_IN(buf->b_drc, (-EPERM, -ENOSYS)))
+			ep->e_nodirect = true;
+		if (M0_FI_ENABLED("fallback"))
+			buf->b_drc = -EOPNOTSUPP;
+		if (b_tlink_is_in(buf)) {
+			/* Cancelled during the copy, see ma_buf_done(). */
+			result = 0;
+		} else if (buf->b_drc == 0) {
+			buf->b_length = buf->b_nd.nd_length;
+			w->m_op = &done_op;
+			result = ep_add(ep, w);
+		} else if (M0_FI_ENABLED("direct_only")) {
+			result = buf->b_drc;
+		} else
+			result = ep_add(ep, w);
+		if (result != 0)
+			buf_done(buf, result);
+		EP_PUT(ep, buf);
+	}
+	M0_POST(ma_invariant(ma));
+}
+
+/** Wakes the poller thread up. */
+static void ma_wake(struct ma *ma)
+{
+	uint64_t one = 1;
+
+	if (write(ma->t_wakefd, &one, sizeof one) != sizeof one)
+		M0_LOG(M0_ERROR, "wake: %i.", -errno);
+}
+
 /**
  * Finds a buffer on M0_NET_QT_MSG_RECV queue, ready to receive "len" bytes of
  * data.
@@ -1759,6 +1982,7 @@ static int buf_register(struct m0_net_buffer *nb)
 		nb->nb_xprt_private = b;
 		b->b_buf = nb;
 		b_tlink_init(b);
+		d_tlink_init(b);
 		return M0_RC(0);
 	} else
 		return M0_ERR(-ENOMEM);
@@ -1795,6 +2019,7 @@ static int buf_add(struct m0_net_buffer *nb)
 	struct mover *w    = &buf->b_writer;
 	struct bdesc *peer = &buf->b_peer;
 	int           qt   = nb->nb_qtype;
+	struct ndesc  nd;
 	int           result;
 	//printf("add: %p[%i]\n", buf, qt);
 	M0_PRE(ma_is_locked(ma) && ma_invariant(ma) && buf_invariant(buf));
@@ -1826,12 +2051,25 @@ static int buf_add(struct m0_net_buffer *nb)
 		break;
 	case M0_NET_QT_ACTIVE_BULK_RECV: /* For active buffers, decode the */
 	case M0_NET_QT_ACTIVE_BULK_SEND: /* passive buffer descriptor. */
-		result = bdesc_decode(&nb->nb_desc, peer);
+		result = bdesc_decode(&nb->nb_desc, &nd);
 		if (result == 0) {
 			struct ep *ep; /* Passive peer end-point. */
+			*peer = nd.nd_bd;
 			result = ep_create(ma, &peer->bd_addr, NULL, &ep);
 			if (result == 0) {
-				result = ep_add(ep, w);
+				if (qt == M0_NET_QT_ACTIVE_BULK_RECV &&
+				    direct_is_possible(ep, &nd)) {
+					/*
+					 * The writer is started by
+					 * ma_direct_done() after the copy.
+					 */
+					buf->b_nd    = nd;
+					buf->b_other = ep;
+					EP_GET(ep, buf);
+					d_tlist_add_tail(&ma->t_direct, buf);
+					ma_wake(ma);
+				} else
+					result = ep_add(ep, w);
 				EP_PUT(ep, find);
 			}
 		}
@@ -1929,7 +2167,7 @@ static int32_t get_max_buffer_segments(const struct m0_net_domain *dom)
  */
 static m0_bcount_t get_max_buffer_desc_size(const struct m0_net_domain *dom)
 {
-	return sizeof(struct bdesc);
+	return sizeof(struct ndesc);
 }
 
 /** Processes a "readable" event for a socket. */
@@ -2849,6 +3087,14 @@ static void buf_fini(struct buf *buf)
 {
 	mover_fini(&buf->b_writer);
 	b_tlink_fini(buf);
+	if (d_tlink_is_in(buf))
+		d_tlist_del(buf);
+	d_tlink_fini(buf);
+	/*
+	 * Invalidate the cookie before the completion call-back returns the
+	 * buffer to the user. direct_copy() relies on this.
+	 */
+	buf->b_cookie = 0;
 	if (buf->b_done.b_words > 0)
 		m0_bitmap_fini(&buf->b_done);
 	if (buf->b_other != NULL) {
@@ -2932,19 +3178,29 @@ static void buf_complete(struct buf *buf)
 static int bdesc_create(struct addr *addr, struct buf *buf,
 			struct m0_net_buf_desc *out)
 {
-	struct bdesc bd = { .bd_addr = *addr };
+	struct m0_net_buffer *nb = buf->b_buf;
+	struct ndesc          nd = {
+		.nd_bd     = { .bd_addr = *addr },
+		.nd_host   = sock_host,
+		.nd_pid    = sock_host != 0 &&
+			     nb->nb_qtype == M0_NET_QT_PASSIVE_BULK_SEND ?
+			     sock_pid : 0,
+		.nd_vec    = (uint64_t)&nb->nb_buffer,
+		.nd_length = nb->nb_qtype == M0_NET_QT_PASSIVE_BULK_SEND ?
+			     nb->nb_length : m0_vec_count(&nb->nb_buffer.ov_vec)
+	};
 
-	m0_cookie_init(&bd.bd_cookie, &buf->b_cookie);
-	return bdesc_encode(&bd, out);
+	m0_cookie_init(&nd.nd_bd.bd_cookie, &buf->b_cookie);
+	return bdesc_encode(&nd, out);
 }
 
-static int bdesc_encode(const struct bdesc *bd, struct m0_net_buf_desc *out)
+static int bdesc_encode(const struct ndesc *nd, struct m0_net_buf_desc *out)
 {
 	m0_bcount_t len;
 	int         result;
 
 	/* Cannot pass &out->nbd_len below, as it is 32 bits. */
-	result = m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(bdesc_xc, (void *)bd),
+	result = m0_xcode_obj_enc_to_buf(&M0_XCODE_OBJ(ndesc_xc, (void *)nd),
 					 (void **)&out->nbd_data, &len);
 	if (result == 0)
 		out->nbd_len = len;
@@ -2953,12 +3209,171 @@ static int bdesc_encode(const struct bdesc *bd, struct m0_net_buf_desc *out)
 	return M0_RC(result);
 }
 
-static int bdesc_decode(const struct m0_net_buf_desc *nbd, struct bdesc *out)
+static int bdesc_decode(const struct m0_net_buf_desc *nbd, struct ndesc *out)
 {
-	return m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(bdesc_xc, out),
+	return m0_xcode_obj_dec_from_buf(&M0_XCODE_OBJ(ndesc_xc, out),
 					 nbd->nbd_data, nbd->nbd_len);
 }
 
+enum {
+	/** Maximal number of segments in a passive buffer copied directly. */
+	DIRECT_SEG_MAX = 1 << 16,
+	/** Maximal number of iovec elements in a process_vm_*(2) call. */
+	DIRECT_IOV_NR  = 128
+};
+
+/**
+ * Returns true iff the data of the passive buffer with the given descriptor
+ * can be copied directly. See "Direct copy" section.
+ */
+static bool direct_is_possible(const struct ep *ep, const struct ndesc *nd)
+{
+	/* "direct_only" makes ma_direct_done() fail if the copy fails. */
+	return (nd->nd_pid != 0 && nd->nd_host == sock_host &&
+		!ep->e_nodirect) || M0_FI_ENABLED("direct_only");
+}
+
+/**
+ * Copies data from the passive buffer in another process on the same host into
+ * an active receive buffer.
+ *
+ * This is called without the ma lock and only accesses the memory of the
+ * active buffer and of the remote process. buf::b_nd is the descriptor of the
+ * passive buffer.
+ *
+ * Returns 0 iff the data have been copied. Otherwise, the usual packet
+ * protocol should be used. See "Direct copy" section.
+ */
+static int direct_copy(struct buf *buf)
+{
+	struct m0_net_buffer   *nb    = buf->b_buf;
+	const struct ndesc     *nd    = &buf->b_nd;
+	struct iovec            liv[DIRECT_IOV_NR];
+	struct iovec            riv[DIRECT_IOV_NR];
+	struct m0_bufvec        rv;
+	struct m0_bufvec_cursor lcur;
+	struct m0_bufvec_cursor rcur;
+	m0_bcount_t            *count = NULL;
+	void                  **addr  = NULL;
+	uint64_t                gen;
+	m0_bcount_t             nob   = nd->nd_length;
+	m0_bcount_t             left;
+	uint32_t                nr;
+	int                     result;
+
+	M0_PRE(nb->nb_qtype == M0_NET_QT_ACTIVE_BULK_RECV);
+	if (nob > m0_vec_count(&nb->nb_buffer.ov_vec))
+		return M0_ERR(-EMSGSIZE);
+	/* Check that the passive buffer is still queued, fetch its bufvec. */
+	liv[0] = (struct iovec){ .iov_base = &gen, .iov_len = sizeof gen };
+	liv[1] = (struct iovec){ .iov_base = &rv,  .iov_len = sizeof rv };
+	riv[0] = (struct iovec){
+		.iov_base = (void *)nd->nd_bd.bd_cookie.co_addr,
+		.iov_len  = sizeof gen
+	};
+	riv[1] = (struct iovec){
+		.iov_base = (void *)nd->nd_vec,
+		.iov_len  = sizeof rv
+	};
+	result = direct_io(nd->nd_pid, liv, riv, 2, sizeof gen + sizeof rv);
+	if (result != 0)
+		return result;
+	if (gen != nd->nd_bd.bd_cookie.co_generation)
+		return M0_ERR(-ESTALE);
+	nr = rv.ov_vec.v_nr;
+	if (nr == 0 || nr > DIRECT_SEG_MAX)
+		return M0_ERR(-E2BIG);
+	M0_ALLOC_ARR(count, nr);
+	M0_ALLOC_ARR(addr, nr);
+	if (count == NULL || addr == NULL) {
+		result = M0_ERR(-ENOMEM);
+		goto out;
+	}
+	liv[0] = (struct iovec){ .iov_base = count,
+				 .iov_len  = nr * sizeof count[0] };
+	liv[1] = (struct iovec){ .iov_base = addr,
+				 .iov_len  = nr * sizeof addr[0] };
+	riv[0] = (struct iovec){ .iov_base = rv.ov_vec.v_count,
+				 .iov_len  = liv[0].iov_len };
+	riv[1] = (struct iovec){ .iov_base = rv.ov_buf,
+				 .iov_len  = liv[1].iov_len };
+	result = direct_io(nd->nd_pid, liv, riv, 2,
+			   liv[0].iov_len + liv[1].iov_len);
+	if (result != 0)
+		goto out;
+	/* Local copy of the remote bufvec, addresses are in the remote peer. */
+	rv.ov_vec.v_count = count;
+	rv.ov_buf         = addr;
+	if (m0_vec_count(&rv.ov_vec) < nob) {
+		result = M0_ERR(-EPROTO);
+		goto out;
+	}
+	m0_bufvec_cursor_init(&lcur, &nb->nb_buffer);
+	m0_bufvec_cursor_init(&rcur, &rv);
+	for (left = nob; result == 0 && left > 0; ) {
+		m0_bcount_t total = 0;
+		int         i;
+
+		for (i = 0; i < DIRECT_IOV_NR && total < left; ++i) {
+			m0_bcount_t frag;
+
+			m0_bufvec_cursor_move(&lcur, 0);
+			m0_bufvec_cursor_move(&rcur, 0);
+			frag = min3(m0_bufvec_cursor_step(&lcur),
+				    m0_bufvec_cursor_step(&rcur), left - total);
+			liv[i] = (struct iovec){
+				.iov_base = m0_bufvec_cursor_addr(&lcur),
+				.iov_len  = frag
+			};
+			riv[i] = (struct iovec){
+				.iov_base = m0_bufvec_cursor_addr(&rcur),
+				.iov_len  = frag
+			};
+			m0_bufvec_cursor_move(&lcur, frag);
+			m0_bufvec_cursor_move(&rcur, frag);
+			total += frag;
+		}
+		result = direct_io(nd->nd_pid, liv, riv, i, total);
+		left -= total;
+	}
+	if (result == 0) {
+		/*
+		 * Check that the passive buffer has not been completed (and
+		 * returned to its user) while the data were copied.
+		 */
+		liv[0] = (struct iovec){
+			.iov_base = &gen,
+			.iov_len  = sizeof gen
+		};
+		riv[0] = (struct iovec){
+			.iov_base = (void *)nd->nd_bd.bd_cookie.co_addr,
+			.iov_len  = sizeof gen
+		};
+		result = direct_io(nd->nd_pid, liv, riv, 1, sizeof gen);
+		if (result == 0 && gen != nd->nd_bd.bd_cookie.co_generation)
+			result = M0_ERR(-ESTALE);
+	}
+out:
+	m0_free(addr);
+	m0_free(count);
+	return result;
+}
+
+/**
+ * Executes a process_vm_readv(2) call, which is expected to transfer exactly
+ * "nob" bytes.
+ */
+static int direct_io(pid_t pid, const struct iovec *liv,
+		     const struct iovec *riv, int nr, m0_bcount_t nob)
+{
+	ssize_t rc;
+
+	rc = process_vm_readv(pid, liv, nr, riv, nr, 0);
+	if (rc < 0)
+		return M0_ERR(-errno);
+	return rc == nob ? 0 : M0_ERR(-EIO);
+}
+
 static void mover_init(struct mover *m, struct ma *ma,
 		       const struct mover_op_vec *vop)
 {
@@ -3077,7 +3492,7 @@ static bool mover_is_reader(const struct mover *m)
 
 static bool mover_is_writer(const struct mover *m)
 {
-	return M0_IN(m->m_op, (&writer_op, &get_op));
+	return M0_IN(m->m_op, (&writer_op, &get_op, &done_op));
 }
 
 /**
@@ -3250,6 +3665,7 @@ static int pk_header_done(struct mover *m)
 	struct ma           *ma = ep_ma(m->m_sock->s_ep);
 	int                  result;
 	bool                 isget;
+	bool                 isdone;
 	bool                 hassrc;
 	bool                 hasdst;
 	struct buf          *buf = NULL;
@@ -3263,8 +3679,9 @@ static int pk_header_done(struct mover *m)
 	if (result != 0)
 		return M0_ERR(result);
 	m0_format_header_unpack(&tag, &p->p_header);
-	isget = memcmp(&tag, &get_tag, sizeof tag) == 0;
-	if (!isget && memcmp(&tag, &put_tag, sizeof tag) != 0)
+	isget  = memcmp(&tag, &get_tag, sizeof tag) == 0;
+	isdone = memcmp(&tag, &done_tag, sizeof tag) == 0;
+	if (!isget && !isdone && memcmp(&tag, &put_tag, sizeof tag) != 0)
 		return M0_ERR(-EPROTO);
 	if (p->p_idx >= p->p_nr)
 		return M0_ERR(-EPROTO);
@@ -3274,7 +3691,7 @@ static int pk_header_done(struct mover *m)
 		return M0_ERR(-EPROTO);
 	if (p->p_idx == 0 && p->p_offset != 0)
 		return M0_ERR(-EPROTO);
-	if (p->p_idx == p->p_nr - 1 &&
+	if (!isdone && p->p_idx == p->p_nr - 1 &&
 	    p->p_offset + p->p_size != p->p_totalsize)
 		return M0_ERR(-EPROTO);
 	if (!ep_eq(ma_src(ma), &p->p_dst.bd_addr))
@@ -3313,6 +3730,19 @@ static int pk_header_done(struct mover *m)
 			buf_done(buf, result);
 		return R_IDLE;
 	}
+	if (isdone) {
+		/* The data have been copied directly, see direct_copy(). */
+		if (p->p_idx != 0 || p->p_nr != 1 || p->p_size != 0 ||
+		    p->p_offset != 0 || !hasdst)
+			return M0_ERR(-EPROTO);
+		if (buf->b_buf->nb_qtype != M0_NET_QT_PASSIVE_BULK_SEND)
+			return M0_ERR(-EPERM);
+		if (p->p_totalsize != buf->b_buf->nb_length)
+			return M0_ERR(-EPROTO);
+		buf->b_peer = p->p_src;
+		buf_done(buf, 0);
+		return R_IDLE;
+	}
 	if (!hasdst) {
 		/* Select a buffer from the receive queue. */
 		buf = ma_recv_buf(ma, p->p_totalsize);
@@ -3673,6 +4103,24 @@ static void get_done(struct mover *w, struct sock *s)
 	ep_del(w);
 }
 
+/**
+ * Fills DONE packet, prepares on-wire representation.
+ *
+ * The packet carries the number of bytes copied by direct_copy().
+ */
+static int done_pk(struct mover *cmd, struct sock *s)
+{
+	pk_header_init(cmd, s);
+	m0_format_header_pack(&cmd->m_pk.p_header, &done_tag);
+	cmd->m_nob = 0;
+	cmd->m_pk.p_nr = 1;
+	cmd->m_pk.p_totalsize = cmd->m_buf->b_length;
+	cmd->m_pk.p_size = 0;
+	pk_encode(cmd);
+	cmd->m_sock = s;
+	return R_HEADER;
+}
+
 static struct m0_sm_state_descr sock_conf_state[] = {
 	[S_INIT] = {
 		.sd_name = "init",
@@ -3829,10 +4277,28 @@ static const struct mover_op_vec get_op = {
 	}
 };
 
+/**
+ * Writer for an active buffer, which data have been copied directly.
+ *
+ * The buffer completes when the DONE packet is written.
+ */
+static const struct mover_op_vec done_op = {
+	.v_name  = "done",
+	.v_done  = &writer_done,
+	.v_error = &writer_error,
+	.v_op    = {
+		[R_IDLE]     = { [M_WRITE] = { &get_idle, true } },
+		[R_PK]       = { [M_WRITE] = { &done_pk, false } },
+		[R_HEADER]   = { [M_WRITE] = { &writer_write, true } },
+		[R_PK_DONE]  = { [M_WRITE] = { &writer_pk_done, false } }
+	}
+};
+
 enum {
-	M0_NET_SOCK_PROTO_VERSION = 1,
+	M0_NET_SOCK_PROTO_VERSION = 2,
 	M0_NET_SOCK_PROTO_PUT     = 0x1,
-	M0_NET_SOCK_PROTO_GET     = 0x2
+	M0_NET_SOCK_PROTO_GET     = 0x2,
+	M0_NET_SOCK_PROTO_DONE    = 0x3
 };
 
 static const struct m0_format_tag put_tag = {
@@ -3847,6 +4313,12 @@ static const struct m0_format_tag get_tag = {
 	.ot_footer_offset = offsetof(struct packet, p_footer)
 };
 
+static const struct m0_format_tag done_tag = {
+	.ot_version       = M0_NET_SOCK_PROTO_VERSION,
+	.ot_type          = M0_NET_SOCK_PROTO_DONE,
+	.ot_footer_offset = offsetof(struct packet, p_footer)
+};
+
 static const struct m0_net_xprt_ops xprt_ops = {
 	.xo_dom_init                    = &dom_init,
 	.xo_dom_fini                    = &dom_fini,
@@ -3888,9 +4360,38 @@ struct m0_net_xprt m0_net_lnet_xprt = {
 };
 #endif
 
+/**
+ * Returns identifier of the host and pid namespace of this process.
+ *
+ * Pids in buffer descriptors are only meaningful for processes with the same
+ * identifier. Returns 0 if the identifier cannot be determined or direct copy
+ * is disabled.
+ */
+static uint64_t sock_host_id(void)
+{
+	char        boot[64] = {};
+	struct stat ns;
+	ssize_t     nob;
+	int         fd;
+
+	if (getenv("M0_NET_SOCK_NODIRECT") != NULL)
+		return 0;
+	fd = open("/proc/sys/kernel/random/boot_id", O_RDONLY);
+	if (fd < 0)
+		return 0;
+	nob = read(fd, boot, sizeof boot - 1);
+	close(fd);
+	if (nob <= 0 || stat("/proc/self/ns/pid", &ns) != 0)
+		return 0;
+	return (m0_hash_fnc_fnv1(boot, nob) ^ m0_hash(ns.st_ino)) ?: 1;
+}
+
 M0_INTERNAL int m0_net_sock_mod_init(void)
 {
 	int result;
+
+	sock_host = sock_host_id();
+	sock_pid  = getpid();
 	/*
 	 * Ignore SIGPIPE that a write to socket gets when RST is received.
 	 *
@@ -31,6 +31,10 @@
  * @{
  */
 
+struct m0_net_xprt;
+
+/** Transport using BSD sockets. */
+extern const struct m0_net_xprt m0_net_sock_xprt;
 
 /** @} end of netsock group */
 #endif /* __MOTR_NET_SOCK_SOCK_H__ */
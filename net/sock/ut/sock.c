@@ -0,0 +1,231 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "net/net.h"
+#include "net/sock/sock.h"     /* m0_net_sock_xprt */
+#include "lib/finject.h"
+#include "lib/semaphore.h"
+#include "lib/memory.h"
+#include "lib/misc.h"          /* M0_SET0 */
+#include "lib/vec.h"
+#include "ut/ut.h"
+
+enum {
+	SEG_NR   = 4,
+	SEG_SIZE = 4096,
+	NOB      = SEG_NR * SEG_SIZE - 100
+};
+
+static const char *ep_addr[] = {
+	"0@lo:12345:33:901",
+	"0@lo:12345:33:902"
+};
+
+static struct m0_net_domain      dom;
+static struct m0_net_transfer_mc tm[2];
+static struct m0_net_buffer      nb[2];
+static struct m0_semaphore       done[2];
+static int                       status[2];
+static m0_bcount_t               length[2];
+
+static void tm_event_cb(const struct m0_net_tm_event *ev)
+{
+}
+
+static const struct m0_net_tm_callbacks tm_cb = {
+	.ntc_event_cb = &tm_event_cb
+};
+
+static void buf_cb(const struct m0_net_buffer_event *ev)
+{
+	int idx = ev->nbe_buffer == &nb[0] ? 0 : 1;
+
+	status[idx] = ev->nbe_status;
+	length[idx] = ev->nbe_length;
+	m0_semaphore_up(&done[idx]);
+}
+
+static const struct m0_net_buffer_callbacks buf_cbs = {
+	.nbc_cb = {
+		[M0_NET_QT_PASSIVE_BULK_SEND] = &buf_cb,
+		[M0_NET_QT_ACTIVE_BULK_RECV]  = &buf_cb
+	}
+};
+
+static void tm_wait(struct m0_net_transfer_mc *t, enum m0_net_tm_state state)
+{
+	struct m0_clink clink;
+
+	m0_clink_init(&clink, NULL);
+	m0_clink_add_lock(&t->ntm_chan, &clink);
+	while (t->ntm_state != state)
+		m0_chan_wait(&clink);
+	m0_clink_del_lock(&clink);
+	m0_clink_fini(&clink);
+}
+
+static int sock_ut_init(void)
+{
+	int i;
+	int rc;
+
+	rc = m0_net_domain_init(&dom, (struct m0_net_xprt *)&m0_net_sock_xprt);
+	M0_ASSERT(rc == 0);
+	for (i = 0; i < ARRAY_SIZE(tm); ++i) {
+		tm[i].ntm_callbacks = &tm_cb;
+		rc = m0_net_tm_init(&tm[i], &dom);
+		M0_ASSERT(rc == 0);
+		rc = m0_net_tm_start(&tm[i], ep_addr[i]);
+		M0_ASSERT(rc == 0);
+		tm_wait(&tm[i], M0_NET_TM_STARTED);
+		rc = m0_bufvec_alloc(&nb[i].nb_buffer, SEG_NR, SEG_SIZE);
+		M0_ASSERT(rc == 0);
+		rc = m0_net_buffer_register(&nb[i], &dom);
+		M0_ASSERT(rc == 0);
+		nb[i].nb_callbacks = &buf_cbs;
+		m0_semaphore_init(&done[i], 0);
+	}
+	return 0;
+}
+
+static int sock_ut_fini(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(tm); ++i) {
+		m0_semaphore_fini(&done[i]);
+		m0_net_buffer_deregister(&nb[i], &dom);
+		m0_bufvec_free(&nb[i].nb_buffer);
+		M0_SET0(&nb[i]);
+		M0_ASSERT(m0_net_tm_stop(&tm[i], true) == 0);
+		tm_wait(&tm[i], M0_NET_TM_STOPPED);
+		m0_net_tm_fini(&tm[i]);
+	}
+	m0_net_domain_fini(&dom);
+	return 0;
+}
+
+static void fill(struct m0_bufvec *bv, char seed)
+{
+	int i;
+	int j;
+
+	for (i = 0; i < bv->ov_vec.v_nr; ++i) {
+		for (j = 0; j < bv->ov_vec.v_count[i]; ++j)
+			((char *)bv->ov_buf[i])[j] = seed + i * 7 + j;
+	}
+}
+
+static bool check(const struct m0_bufvec *bv, char seed, m0_bcount_t nob)
+{
+	int i;
+	int j;
+
+	for (i = 0; i < bv->ov_vec.v_nr; ++i) {
+		const char *data = bv->ov_buf[i];
+
+		for (j = 0; j < bv->ov_vec.v_count[i] && nob > 0; ++j, --nob) {
+			if (data[j] != (char)(seed + i * 7 + j))
+				return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Transfers the data of a passive send buffer in tm[0] to an active receive
+ * buffer in tm[1]. Both peers run in this process, so the transfer is a
+ * same-host transfer.
+ */
+static void bulk_transfer(char seed)
+{
+	int i;
+	int rc;
+
+	fill(&nb[0].nb_buffer, seed);
+	nb[0].nb_qtype  = M0_NET_QT_PASSIVE_BULK_SEND;
+	nb[0].nb_length = NOB;
+	rc = m0_net_buffer_add(&nb[0], &tm[0]);
+	M0_UT_ASSERT(rc == 0);
+
+	fill(&nb[1].nb_buffer, ~seed);
+	nb[1].nb_qtype  = M0_NET_QT_ACTIVE_BULK_RECV;
+	nb[1].nb_length = m0_vec_count(&nb[1].nb_buffer.ov_vec);
+	rc = m0_net_desc_copy(&nb[0].nb_desc, &nb[1].nb_desc);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_net_buffer_add(&nb[1], &tm[1]);
+	M0_UT_ASSERT(rc == 0);
+
+	for (i = 0; i < ARRAY_SIZE(nb); ++i)
+		m0_semaphore_down(&done[i]);
+	M0_UT_ASSERT(status[0] == 0);
+	M0_UT_ASSERT(status[1] == 0);
+	M0_UT_ASSERT(length[1] == NOB);
+	M0_UT_ASSERT(check(&nb[1].nb_buffer, seed, NOB));
+	for (i = 0; i < ARRAY_SIZE(nb); ++i)
+		m0_net_desc_free(&nb[i].nb_desc);
+}
+
+/** The data are copied with process_vm_readv(2). */
+static void test_direct(void)
+{
+	/* Fail the active buffer if the direct copy was not done. */
+	m0_fi_enable("direct_is_possible", "direct_only");
+	m0_fi_enable("ma_direct_done", "direct_only");
+	bulk_transfer('d');
+	m0_fi_disable("ma_direct_done", "direct_only");
+	m0_fi_disable("direct_is_possible", "direct_only");
+}
+
+/** The direct copy is not used, the data are sent through the socket. */
+static void test_direct_fallback(void)
+{
+	m0_fi_enable("ma_direct_done", "fallback");
+	bulk_transfer('f');
+	m0_fi_disable("ma_direct_done", "fallback");
+	/* Direct copy still works after the fallback. */
+	test_direct();
+}
+
+struct m0_ut_suite m0_net_sock_ut = {
+	.ts_name  = "net-sock-ut",
+	.ts_init  = &sock_ut_init,
+	.ts_fini  = &sock_ut_fini,
+	.ts_tests = {
+		{ "direct",          &test_direct },
+		{ "direct-fallback", &test_direct_fallback },
+		{ NULL, NULL }
+	}
+};
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
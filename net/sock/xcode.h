@@ -91,6 +91,31 @@ struct bdesc {
 	struct m0_cookie bd_cookie;
 } M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
 
+/**
+ * Network buffer descriptor.
+ *
+ * This is what is stored in generic m0_net_buf_desc: the buffer descriptor
+ * together with the location of the buffer memory in the address space of the
+ * passive peer. The latter is used by a peer on the same host to copy data
+ * directly, bypassing the socket.
+ *
+ * @see bdesc_create(), bdesc_decode(), direct_copy()
+ */
+struct ndesc {
+	struct bdesc nd_bd;
+	/** Identifier of the host and pid namespace, see sock_host_id(). */
+	uint64_t     nd_host;
+	/** Process id of the passive peer, 0 if direct copy is not allowed. */
+	uint32_t     nd_pid;
+	/** Address of the passive buffer bufvec in the passive peer. */
+	uint64_t     nd_vec;
+	/**
+	 * Number of bytes in the passive buffer: data size for a passive send
+	 * buffer, capacity for a passive receive buffer.
+	 */
+	uint64_t     nd_length;
+} M0_XCA_RECORD M0_XCA_DOMAIN(rpc);
+
 /** Packet header. */
 struct packet {
 	/** Format header, contains opcode (GET vs. PUT). */
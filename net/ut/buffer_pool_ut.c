@@ -25,6 +25,7 @@
 #include "lib/misc.h"  /* M0_SET0 */
 #include "lib/thread.h"/* M0_THREAD_INIT */
 #include "lib/time.h"  /* m0_nanosleep */
+#include "lib/ub.h"
 #include "net/lnet/lnet.h"
 #include "net/buffer_pool.h"
 #include "net/net_internal.h"
@@ -32,6 +33,7 @@
 static void notempty(struct m0_net_buffer_pool *bp);
 static void low(struct m0_net_buffer_pool *bp);
 static void buffers_get_put(int rc);
+static void buffers_cache_get_put(int rc);
 
 static struct m0_net_buffer_pool bp;
 static struct m0_chan		 buf_chan;
@@ -160,6 +162,72 @@ static void test_get_put_multiple(void)
 	m0_net_buffer_pool_unlock(&bp);
 }
 
+static void test_cache_get_put(void)
+{
+	struct m0_net_buffer *nb[2];
+	struct m0_tl	      held;
+	uint32_t	      free = bp.nbp_free;
+	enum {
+		COLOUR = 2,
+	};
+
+	/* Refill of the empty cache. */
+	nb[0] = m0_net_buffer_pool_cache_get(&bp, COLOUR);
+	M0_UT_ASSERT(nb[0] != NULL);
+	M0_UT_ASSERT(nb[0]->nb_pool == &bp);
+	M0_UT_ASSERT(bp.nbp_free < free - 1);
+	M0_UT_ASSERT(bp.nbp_free >= bp.nbp_threshold);
+	/* Cache hit doesn't touch the pool. */
+	free = bp.nbp_free;
+	nb[1] = m0_net_buffer_pool_cache_get(&bp, COLOUR);
+	M0_UT_ASSERT(nb[1] != NULL && nb[1] != nb[0]);
+	M0_UT_ASSERT(bp.nbp_free == free);
+	M0_UT_ASSERT(bp.nbp_caches[COLOUR].nbc_hit == 1);
+	m0_net_buffer_pool_cache_put(&bp, nb[1], COLOUR);
+	m0_net_buffer_pool_cache_put(&bp, nb[0], COLOUR);
+
+	/* Locked get takes cached buffers when the pool is empty. */
+	m0_net_tm_tlist_init(&held);
+	m0_net_buffer_pool_lock(&bp);
+	while ((nb[0] = m0_net_buffer_pool_get(&bp, COLOUR - 1)) != NULL)
+		m0_net_tm_tlist_add(&held, nb[0]);
+	M0_UT_ASSERT(bp.nbp_free == 0);
+	M0_UT_ASSERT(m0_net_tm_tlist_length(&held) == bp.nbp_buf_nr);
+	m0_net_buffer_pool_unlock(&bp);
+	M0_UT_ASSERT(m0_net_buffer_pool_cache_get(&bp, COLOUR) == NULL);
+	m0_net_buffer_pool_lock(&bp);
+	m0_tl_teardown(m0_net_tm, &held, nb[0])
+		m0_net_buffer_pool_put(&bp, nb[0], COLOUR - 1);
+	M0_UT_ASSERT(bp.nbp_free == bp.nbp_buf_nr);
+	M0_UT_ASSERT(m0_net_buffer_pool_invariant(&bp));
+	m0_net_buffer_pool_unlock(&bp);
+	m0_net_tm_tlist_fini(&held);
+}
+
+static void test_cache_get_put_multiple(void)
+{
+	int		  i;
+	int		  rc;
+	const int	  nr_client_threads = 10;
+	struct m0_thread *client_thread;
+
+	M0_ALLOC_ARR(client_thread, nr_client_threads);
+	M0_UT_ASSERT(client_thread != NULL);
+	for (i = 0; i < nr_client_threads; i++) {
+		rc = M0_THREAD_INIT(&client_thread[i], int, NULL,
+				    &buffers_cache_get_put,
+				    i % 2 == 0 ? M0_BUFFER_ANY_COLOUR : i % 3,
+				    "client_%d", i);
+		M0_ASSERT(rc == 0);
+	}
+	for (i = 0; i < nr_client_threads; i++)
+		m0_thread_join(&client_thread[i]);
+	m0_free(client_thread);
+	m0_net_buffer_pool_lock(&bp);
+	M0_UT_ASSERT(m0_net_buffer_pool_invariant(&bp));
+	m0_net_buffer_pool_unlock(&bp);
+}
+
 static void test_fini(void)
 {
 	m0_net_buffer_pool_lock(&bp);
@@ -194,6 +262,23 @@ static void buffers_get_put(int rc)
 	m0_clink_fini(&buf_link);
 }
 
+static void buffers_cache_get_put(int colour)
+{
+	struct m0_net_buffer *nb;
+	struct m0_clink       buf_link;
+	int                   i;
+
+	m0_clink_init(&buf_link, NULL);
+	m0_clink_add_lock(&buf_chan, &buf_link);
+	for (i = 0; i < 100; ++i) {
+		while ((nb = m0_net_buffer_pool_cache_get(&bp, colour)) == NULL)
+			m0_chan_wait(&buf_link);
+		m0_net_buffer_pool_cache_put(&bp, nb, colour);
+	}
+	m0_clink_del_lock(&buf_link);
+	m0_clink_fini(&buf_link);
+}
+
 static void notempty(struct m0_net_buffer_pool *bp)
 {
 	m0_chan_signal(&buf_chan);
@@ -215,12 +300,128 @@ struct m0_ut_suite buffer_pool_ut = {
 		{ "buffer_pool_grow",              test_grow },
 		{ "buffer_pool_prune",             test_prune },
 		{ "buffer_pool_get_put_multiple",  test_get_put_multiple },
+		{ "buffer_pool_cache_get_put",     test_cache_get_put },
+		{ "buffer_pool_cache_multiple",    test_cache_get_put_multiple },
 		{ "buffer_pool_fini",              test_fini },
 		{ NULL,                            NULL }
 	}
 };
 M0_EXPORTED(buffer_pool_ut);
 
+enum {
+	UB_COLOURS = 32,
+	UB_ITER    = 10,
+	UB_OPS     = 10000,
+	UB_BUF_NR  = UB_COLOURS * 4,
+};
+
+static struct m0_net_buffer_pool ub_bp;
+static struct m0_thread          ub_threads[UB_COLOURS];
+static bool                      ub_cached;
+
+static void ub_notempty(struct m0_net_buffer_pool *bp)
+{
+}
+
+static const struct m0_net_buffer_pool_ops ub_ops = {
+	.nbpo_not_empty	      = ub_notempty,
+	.nbpo_below_threshold = ub_notempty,
+};
+
+static void ub_worker(int colour)
+{
+	struct m0_net_buffer *nb;
+	int                   i;
+
+	for (i = 0; i < UB_OPS; ++i) {
+		if (ub_cached) {
+			nb = m0_net_buffer_pool_cache_get(&ub_bp, colour);
+			M0_ASSERT(nb != NULL);
+			m0_net_buffer_pool_cache_put(&ub_bp, nb, colour);
+		} else {
+			m0_net_buffer_pool_lock(&ub_bp);
+			nb = m0_net_buffer_pool_get(&ub_bp, colour);
+			m0_net_buffer_pool_unlock(&ub_bp);
+			M0_ASSERT(nb != NULL);
+			m0_net_buffer_pool_lock(&ub_bp);
+			m0_net_buffer_pool_put(&ub_bp, nb, colour);
+			m0_net_buffer_pool_unlock(&ub_bp);
+		}
+	}
+}
+
+/** Every thread gets and puts buffers of its own colour (locality). */
+static void ub_run(bool cached)
+{
+	int i;
+	int rc;
+
+	ub_cached = cached;
+	for (i = 0; i < UB_COLOURS; ++i) {
+		rc = M0_THREAD_INIT(&ub_threads[i], int, NULL, &ub_worker, i,
+				    "ub_bp_%d", i);
+		M0_ASSERT(rc == 0);
+	}
+	for (i = 0; i < UB_COLOURS; ++i) {
+		m0_thread_join(&ub_threads[i]);
+		m0_thread_fini(&ub_threads[i]);
+	}
+}
+
+static void ub_locked(int i)
+{
+	ub_run(false);
+}
+
+static void ub_cache(int i)
+{
+	ub_run(true);
+}
+
+static int ub_init(const char *opts)
+{
+	int rc;
+
+	M0_ALLOC_PTR(ub_bp.nbp_ndom);
+	M0_ASSERT(ub_bp.nbp_ndom != NULL);
+	rc = m0_net_domain_init(ub_bp.nbp_ndom, &m0_net_lnet_xprt);
+	M0_ASSERT(rc == 0);
+	ub_bp.nbp_ops = &ub_ops;
+	rc = m0_net_buffer_pool_init(&ub_bp, ub_bp.nbp_ndom,
+				     M0_NET_BUFFER_POOL_THRESHOLD, 1, 4096,
+				     UB_COLOURS, 12, false);
+	M0_ASSERT(rc == 0);
+	m0_net_buffer_pool_lock(&ub_bp);
+	rc = m0_net_buffer_pool_provision(&ub_bp, UB_BUF_NR);
+	m0_net_buffer_pool_unlock(&ub_bp);
+	M0_ASSERT(rc == UB_BUF_NR);
+	return 0;
+}
+
+static void ub_fini(void)
+{
+	m0_net_buffer_pool_fini(&ub_bp);
+	m0_net_domain_fini(ub_bp.nbp_ndom);
+	m0_free(ub_bp.nbp_ndom);
+}
+
+struct m0_ub_set m0_net_buffer_pool_ub = {
+	.us_name = "net-buffer-pool-ub",
+	.us_init = ub_init,
+	.us_fini = ub_fini,
+	.us_run  = {
+		{ .ub_name  = "locked-32",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_locked },
+
+		{ .ub_name  = "cache-32",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_cache },
+
+		{ .ub_name  = NULL }
+	}
+};
+
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
@@ -205,9 +205,7 @@ m0_reqh_mdpool_service_index_to_session(const struct m0_reqh *reqh,
 	src.sa_group = m0_fid_hash(gob_fid);
 	src.sa_unit = index;
 
-	m0_mutex_lock(&pi->pi_mutex);
 	m0_fd_fwd_map(pi, &src, &tgt);
-	m0_mutex_unlock(&pi->pi_mutex);
 	M0_ASSERT(tgt.ta_obj < mds_nr);
 	idx = md_pv->pv_mach.pm_state->pst_devices_array[tgt.ta_obj].
 		pd_sdev_idx;
@@ -50,6 +50,8 @@ enum m0_avi_rpc_labels {
         M0_AVI_RPC_BULK_ATTR_BUF_NR,
         M0_AVI_RPC_BULK_ATTR_BYTES,
         M0_AVI_RPC_BULK_ATTR_SEG_NR,
+
+	M0_AVI_RPC_FRM_PACKET,
 } M0_XCA_ENUM;
 
 /** @} end of rpc group */
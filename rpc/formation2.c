@@ -27,8 +27,11 @@
 #include "lib/tlist.h"
 #include "motr/magic.h"
 #include "lib/finject.h"       /* M0_FI_ENABLED */
+#include "lib/arith.h"         /* min64u */
+#include "addb2/addb2.h"
 #include "reqh/reqh.h"
 
+#include "rpc/addb2.h"
 #include "rpc/rpc_internal.h"
 
 /**
@@ -47,6 +50,11 @@ static void __itemq_insert(struct m0_tl *q, struct m0_rpc_item *new_item);
 static void __itemq_remove(struct m0_rpc_item *item);
 static void frm_balance(struct m0_rpc_frm *frm);
 static bool frm_is_ready(const struct m0_rpc_frm *frm);
+static bool frm_is_corked(const struct m0_rpc_frm *frm);
+static void frm_cork_timer_arm(struct m0_rpc_frm *frm);
+static void frm_adapt_item(struct m0_rpc_frm *frm, struct m0_rpc_item *item);
+static void frm_adapt_packet(struct m0_rpc_frm *frm,
+			     struct m0_rpc_packet *p);
 static void frm_fill_packet(struct m0_rpc_frm *frm, struct m0_rpc_packet *p);
 static void frm_fill_packet_from_item_sources(struct m0_rpc_frm    *frm,
 					      struct m0_rpc_packet *p);
@@ -178,6 +186,7 @@ M0_INTERNAL void m0_rpc_frm_constraints_get_defaults(struct
 	c->fc_max_nr_segments          = 128;
 	c->fc_max_packet_size          = 4096;
 	c->fc_max_nr_bytes_accumulated = 4096;
+	c->fc_max_cork_delay           = 0;
 
 	M0_LEAVE();
 }
@@ -212,6 +221,7 @@ M0_INTERNAL void m0_rpc_frm_init(struct m0_rpc_frm *frm,
 
 	for_each_itemq_in_frm(q, frm)
 		itemq_tlist_init(q);
+	m0_sm_timer_init(&frm->f_cork_timer);
 
 	frm->f_state = FRM_IDLE;
 
@@ -229,6 +239,9 @@ M0_INTERNAL void m0_rpc_frm_fini(struct m0_rpc_frm *frm)
 
 	drop_all_items(frm);
 	M0_ASSERT(frm->f_state == FRM_IDLE);
+	if (m0_sm_timer_is_armed(&frm->f_cork_timer))
+		m0_sm_timer_cancel(&frm->f_cork_timer);
+	m0_sm_timer_fini(&frm->f_cork_timer);
 	for_each_itemq_in_frm(q, frm)
 		itemq_tlist_fini(q);
 
@@ -289,6 +302,7 @@ static void frm_insert(struct m0_rpc_frm *frm, struct m0_rpc_item *item)
 	m0_rpc_item_get(item);
 	__itemq_insert(q, item);
 
+	frm_adapt_item(frm, item);
 	M0_CNT_INC(frm->f_nr_items);
 	frm->f_nr_bytes_accumulated += m0_rpc_item_size(item);
 	item->ri_frm = frm;
@@ -426,7 +440,7 @@ static void frm_balance(struct m0_rpc_frm *frm)
 		return;
 
 	while (frm_is_ready(frm)) {
-		M0_ALLOC_PTR(p);
+		p = m0_rpc_packet_alloc();
 		if (p == NULL) {
 			M0_LOG(M0_ERROR, "Error: packet allocation failed");
 			break;
@@ -436,11 +450,12 @@ static void frm_balance(struct m0_rpc_frm *frm)
 		if (m0_rpc_packet_is_empty(p)) {
 			/* See FRM_BALANCE_NOTE_1 at the end of this function */
 			m0_rpc_packet_fini(p);
-			m0_free(p);
+			m0_rpc_packet_free(p);
 			break;
 		}
 		++packet_count;
 		item_count += p->rp_ow.poh_nr_items;
+		frm_adapt_packet(frm, p);
 		rc = frm_packet_ready(frm, p);
 		if (rc == 0) {
 			++frm->f_nr_packets_enqed;
@@ -452,6 +467,12 @@ static void frm_balance(struct m0_rpc_frm *frm)
 				frm->f_state = FRM_BUSY;
 		}
 	}
+	if (!itemq_tlist_is_empty(&frm->f_itemq[FRMQ_URGENT]) &&
+	    frm_is_corked(frm)) {
+		if (frm->f_adapt.fa_corked == 0)
+			frm->f_adapt.fa_corked = m0_time_now();
+		frm_cork_timer_arm(frm);
+	}
 
 	M0_POST_EX(frm_invariant(frm));
 	M0_LEAVE("formed %d packet(s) [%d items]", packet_count, item_count);
@@ -483,10 +504,133 @@ static bool frm_is_ready(const struct m0_rpc_frm *frm)
 
 	c = &frm->f_constraints;
 	return frm->f_nr_packets_enqed < c->fc_max_nr_packets_enqed &&
-	       (has_urgent_items ||
+	       ((has_urgent_items && !frm_is_corked(frm)) ||
 		frm->f_nr_bytes_accumulated >= c->fc_max_nr_bytes_accumulated);
 }
 
+static m0_time_t frm_ewma(m0_time_t avg, m0_time_t sample)
+{
+	return avg == 0 ? sample :
+		avg - avg / M0_RPC_FRM_EWMA + sample / M0_RPC_FRM_EWMA;
+}
+
+/**
+   Returns the number of bytes expected to arrive while a packet is in flight.
+ */
+static m0_bcount_t frm_batch_size(const struct m0_rpc_frm *frm)
+{
+	const struct m0_rpc_frm_adapt *a = &frm->f_adapt;
+
+	return min64u(frm->f_constraints.fc_max_nr_bytes_accumulated,
+		      a->fa_size * (a->fa_latency / max64u(a->fa_arrival, 1)));
+}
+
+/**
+   Returns true iff urgent items should be held back to be sent together with
+   the items expected to arrive soon.
+
+   Items are held only while there are packets in flight, whose completion
+   runs formation again. They are held if, judging by the moving averages,
+   more items arrive before an in-flight packet completes, and only until the
+   expected batch (frm_batch_size()) has been accumulated or
+   m0_rpc_frm_constraints::fc_max_cork_delay passes. The delay is enforced by
+   m0_rpc_frm::f_cork_timer, which runs formation again when it expires. When
+   items arrive slower than packets complete, nothing is gained by waiting and
+   items are sent immediately.
+ */
+static bool frm_is_corked(const struct m0_rpc_frm *frm)
+{
+	const struct m0_rpc_frm_adapt *a     = &frm->f_adapt;
+	m0_time_t                      delay =
+		frm->f_constraints.fc_max_cork_delay;
+
+	return  delay != 0 && frm->f_nr_packets_enqed > 0 &&
+		a->fa_latency != 0 && a->fa_latency <= delay &&
+		a->fa_arrival < a->fa_latency &&
+		frm->f_nr_bytes_accumulated < frm_batch_size(frm) &&
+		(a->fa_corked == 0 || m0_time_now() < a->fa_corked + delay);
+}
+
+static void frm_cork_timer_cb(struct m0_sm_timer *timer)
+{
+	struct m0_rpc_frm *frm = container_of(timer, struct m0_rpc_frm,
+					      f_cork_timer);
+
+	M0_ENTRY("frm: %p", frm);
+	M0_PRE(frm_rmachine_is_locked(frm));
+	frm_balance(frm);
+	M0_LEAVE();
+}
+
+/**
+   Arms m0_rpc_frm::f_cork_timer to expire when the current cork does.
+
+   A timer still armed for an earlier cork expires no later than the current
+   one, and formation re-arms the timer if items are still corked then. If the
+   timer cannot be started, corked items are released by completion of the
+   in-flight packets, see frm_is_corked().
+ */
+static void frm_cork_timer_arm(struct m0_rpc_frm *frm)
+{
+	struct m0_rpc_machine *machine = frm_rmachine(frm);
+	struct m0_sm_timer    *timer   = &frm->f_cork_timer;
+	int                    rc;
+
+	M0_PRE(frm_rmachine_is_locked(frm));
+	M0_PRE(frm->f_adapt.fa_corked != 0);
+
+	if (m0_sm_timer_is_armed(timer) || machine->rm_stopping)
+		return;
+	m0_sm_timer_fini(timer);
+	m0_sm_timer_init(timer);
+	rc = m0_sm_timer_start(timer, &machine->rm_sm_grp, &frm_cork_timer_cb,
+			       frm->f_adapt.fa_corked +
+			       frm->f_constraints.fc_max_cork_delay);
+	if (rc != 0)
+		M0_LOG(M0_ERROR, "frm: %p cork timer: rc=%d", frm, rc);
+}
+
+/** Updates arrival statistics of adaptive formation. */
+static void frm_adapt_item(struct m0_rpc_frm *frm, struct m0_rpc_item *item)
+{
+	struct m0_rpc_frm_adapt *a     = &frm->f_adapt;
+	m0_time_t                delay = frm->f_constraints.fc_max_cork_delay;
+	m0_time_t                now;
+
+	if (delay == 0)
+		return;
+	now = m0_time_now();
+	/*
+	 * Clamp the interval, so that the average recovers quickly when a
+	 * burst follows an idle period.
+	 */
+	if (a->fa_last != 0)
+		a->fa_arrival = frm_ewma(a->fa_arrival,
+					 min64u(now - a->fa_last, 2 * delay));
+	a->fa_last = now;
+	a->fa_size = frm_ewma(a->fa_size, m0_rpc_item_size(item));
+}
+
+/** Accounts a packet about to be submitted to the network. */
+static void frm_adapt_packet(struct m0_rpc_frm *frm, struct m0_rpc_packet *p)
+{
+	struct m0_rpc_frm_adapt *a     = &frm->f_adapt;
+	m0_time_t                delay = 0;
+
+	p->rp_formed = m0_time_now();
+	if (a->fa_corked != 0) {
+		delay = p->rp_formed - a->fa_corked;
+		a->fa_corked = 0;
+		if (m0_sm_timer_is_armed(&frm->f_cork_timer))
+			m0_sm_timer_cancel(&frm->f_cork_timer);
+	}
+	a->fa_nr_packets++;
+	a->fa_nr_items += p->rp_ow.poh_nr_items;
+	a->fa_delay    += delay;
+	M0_ADDB2_ADD(M0_AVI_RPC_FRM_PACKET, (uint64_t)frm,
+		     p->rp_ow.poh_nr_items, p->rp_size, delay);
+}
+
 /**
    Adds RPC items in packet p, taking the constraints into account.
 
@@ -640,6 +784,8 @@ static void frm_remove(struct m0_rpc_frm *frm, struct m0_rpc_item *item)
 	M0_CNT_DEC(frm->f_nr_items);
 	frm->f_nr_bytes_accumulated -= m0_rpc_item_size(item);
 	M0_ASSERT(frm->f_nr_bytes_accumulated >= 0);
+	if (frm->f_nr_items == 0)
+		frm->f_adapt.fa_corked = 0;
 
 	if (frm_is_idle(frm))
 		frm->f_state = FRM_IDLE;
@@ -709,6 +855,12 @@ M0_INTERNAL void m0_rpc_frm_packet_done(struct m0_rpc_packet *p)
 	M0_CNT_DEC(frm->f_nr_packets_enqed);
 	M0_LOG(M0_DEBUG, "nr_packets_enqed: %llu",
 		(unsigned long long)frm->f_nr_packets_enqed);
+	if (frm->f_constraints.fc_max_cork_delay != 0 && p->rp_formed != 0) {
+		struct m0_rpc_frm_adapt *a = &frm->f_adapt;
+
+		a->fa_latency = frm_ewma(a->fa_latency,
+					 m0_time_now() - p->rp_formed);
+	}
 
 	if (frm_is_idle(frm))
 		frm->f_state = FRM_IDLE;
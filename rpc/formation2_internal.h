@@ -59,8 +59,24 @@
    - max_nr_bytes_accumulated:
    - max_nr_segments
    - max_nr_packets_enqed
+   - max_cork_delay
    @see m0_rpc_frm_constraints for more information.
 
+   Adaptive formation:
+     Urgent items are normally sent immediately, which under a burst of
+     small items results in many small packets. When
+     m0_rpc_frm_constraints::fc_max_cork_delay is not 0, formation tracks
+     moving averages of item inter-arrival time, item size and network
+     completion latency of packets (m0_rpc_frm_adapt). While there are
+     packets in flight and more items are expected to arrive before an
+     in-flight packet completes, urgent items are held back ("corked"), until
+     the expected batch is accumulated, a packet completes or
+     fc_max_cork_delay passes. This is similar to Nagle's algorithm and TCP
+     auto-corking. Both packet completion (m0_rpc_frm_packet_done()) and
+     expiry of the cork timer (m0_rpc_frm::f_cork_timer) run formation again,
+     so the added latency is bounded by fc_max_cork_delay.
+     @see frm_is_corked()
+
    It is important to note that Formation has something to do only on
    "outgoing path".
 
@@ -76,6 +92,8 @@
 
 #include "lib/types.h"
 #include "lib/tlist.h"
+#include "lib/time.h"
+#include "sm/sm.h"
 
 /* Imports */
 struct m0_rpc_packet;
@@ -116,6 +134,21 @@ struct m0_rpc_frm_constraints {
 	   form RPC packet out of them.
 	 */
 	m0_bcount_t fc_max_nr_bytes_accumulated;
+
+	/**
+	   Maximal time for which adaptive formation holds urgent items, waiting
+	   for more items to batch with them. Corking is also disabled when the
+	   network completion latency exceeds this value. 0 disables adaptive
+	   formation.
+	 */
+	m0_time_t   fc_max_cork_delay;
+};
+
+enum {
+	/** Default value of m0_rpc_frm_constraints::fc_max_cork_delay. */
+	M0_RPC_FRM_CORK_DELAY = M0_TIME_ONE_MSEC / 2,
+	/** Weight of a new sample in moving averages is 1/M0_RPC_FRM_EWMA. */
+	M0_RPC_FRM_EWMA       = 8
 };
 
 /**
@@ -153,6 +186,31 @@ enum m0_rpc_frm_itemq_type {
 	FRMQ_NR_QUEUES
 };
 
+/**
+   State of adaptive formation and formation statistics.
+
+   Averages are exponentially weighted moving averages, 0 when no sample has
+   been taken yet.
+ */
+struct m0_rpc_frm_adapt {
+	/** Average interval between item arrivals. */
+	m0_time_t   fa_arrival;
+	/** Average on-wire item size. */
+	m0_bcount_t fa_size;
+	/** Average network completion latency of a packet. */
+	m0_time_t   fa_latency;
+	/** Arrival time of the last item. */
+	m0_time_t   fa_last;
+	/** Time since when urgent items are corked, 0 if they are not. */
+	m0_time_t   fa_corked;
+	/** Total number of items sent. */
+	uint64_t    fa_nr_items;
+	/** Total number of packets sent. */
+	uint64_t    fa_nr_packets;
+	/** Total latency added by corking, summed over packets. */
+	m0_time_t   fa_delay;
+};
+
 /**
    Formation state machine.
 
@@ -162,6 +220,7 @@ enum m0_rpc_frm_itemq_type {
    - RPC item is posted for sending
    - RPC packet has been sent or packet sending is failed
    - deadline timer of WAITING item is expired
+   - cork timer (m0_rpc_frm::f_cork_timer) is expired
 
    Events that formation machine triggers for rest of RPC are:
    - Packet is ready for sending
@@ -227,6 +286,15 @@ struct m0_rpc_frm {
 	/** Limits that formation should respect */
 	struct m0_rpc_frm_constraints  f_constraints;
 
+	/** Adaptive formation state and statistics. */
+	struct m0_rpc_frm_adapt        f_adapt;
+
+	/**
+	   Releases corked items once m0_rpc_frm_constraints::fc_max_cork_delay
+	   passes, see frm_cork_timer_arm().
+	 */
+	struct m0_sm_timer             f_cork_timer;
+
 	const struct m0_rpc_frm_ops   *f_ops;
 
 	/** FRM_MAGIC */
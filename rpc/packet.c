@@ -29,6 +29,7 @@
 #include "lib/errno.h"
 #include "lib/finject.h"
 #include "lib/memory.h"
+#include "lib/slab.h"
 #include "motr/magic.h"
 #include "xcode/xcode.h"
 #include "rpc/rpc_internal.h"
@@ -131,11 +132,35 @@ M0_INTERNAL void m0_rpc_packet_fini(struct m0_rpc_packet *p)
 	M0_LEAVE();
 }
 
+/** Cache of packets allocated by m0_rpc_packet_alloc(). */
+static struct m0_slab packet_slab;
+
+M0_INTERNAL void m0_rpc_packet_module_init(void)
+{
+	m0_slab_init(&packet_slab, "rpc-packet", sizeof(struct m0_rpc_packet),
+		     NULL, NULL);
+}
+
+M0_INTERNAL void m0_rpc_packet_module_fini(void)
+{
+	m0_slab_fini(&packet_slab);
+}
+
+M0_INTERNAL struct m0_rpc_packet *m0_rpc_packet_alloc(void)
+{
+	return m0_slab_alloc(&packet_slab);
+}
+
+M0_INTERNAL void m0_rpc_packet_free(struct m0_rpc_packet *packet)
+{
+	m0_slab_free(&packet_slab, packet);
+}
+
 M0_INTERNAL void m0_rpc_packet_discard(struct m0_rpc_packet *packet)
 {
 	m0_rpc_packet_remove_all_items(packet);
 	m0_rpc_packet_fini(packet);
-	m0_free(packet);
+	m0_rpc_packet_free(packet);
 }
 
 M0_INTERNAL void m0_rpc_packet_add_item(struct m0_rpc_packet *p,
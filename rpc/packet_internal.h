@@ -27,6 +27,7 @@
 
 #include "lib/vec.h"
 #include "lib/tlist.h"
+#include "lib/time.h"
 #include "rpc/onwire.h"
 
 /**
@@ -63,6 +64,9 @@ struct m0_rpc_packet {
 	struct m0_rpc_frm                 *rp_frm;
 
 	struct m0_rpc_machine             *rp_rmachine;
+
+	/** Time when formation submitted the packet to the network. */
+	m0_time_t                          rp_formed;
 };
 
 M0_INTERNAL m0_bcount_t m0_rpc_packet_onwire_header_size(void);
@@ -84,6 +88,18 @@ M0_INTERNAL void m0_rpc_packet_fini(struct m0_rpc_packet *packet);
 /** Removes all items from the packet, finalises and frees it. */
 M0_INTERNAL void m0_rpc_packet_discard(struct m0_rpc_packet *packet);
 
+/**
+ * Allocates a packet from the packet cache (lib/slab.h). The packet is
+ * initialised with m0_rpc_packet_init() and freed by
+ * m0_rpc_packet_discard() or m0_rpc_packet_free().
+ */
+M0_INTERNAL struct m0_rpc_packet *m0_rpc_packet_alloc(void);
+/** Frees a finalised packet allocated by m0_rpc_packet_alloc(). */
+M0_INTERNAL void m0_rpc_packet_free(struct m0_rpc_packet *packet);
+
+M0_INTERNAL void m0_rpc_packet_module_init(void);
+M0_INTERNAL void m0_rpc_packet_module_fini(void);
+
 /**
    @pre  !packet_item_tlink_is_in(item)
    @post m0_rpc_packet_is_carrying_item(packet, item)
@@ -712,6 +712,7 @@ static int rpc_chan_create(struct m0_rpc_chan **chan,
 				constraints.fc_max_packet_size;
 	constraints.fc_max_nr_segments =
 				m0_net_domain_get_max_buffer_segments(ndom);
+	constraints.fc_max_cork_delay = M0_RPC_FRM_CORK_DELAY;
 
 	m0_rpc_frm_init(&ch->rc_frm, &constraints, &m0_rpc_frm_default_ops);
 	rpc_chan_tlink_init_at(ch, &machine->rm_chans);
@@ -23,31 +23,85 @@
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_UT
 #include "lib/trace.h"
 
-#include "lib/ub.h"         /* m0_ub_set */
-#include "lib/misc.h"       /* M0_IN, M0_BITS */
-#include "lib/string.h"     /* strlen, m0_strdup */
-#include "lib/memory.h"     /* m0_free */
-#include "fop/fop.h"        /* m0_fop_alloc */
-#include "net/bulk_mem.h"   /* m0_net_bulk_mem_xprt */
-#include "net/lnet/lnet.h"  /* m0_net_lnet_xprt */
-#include "ut/cs_service.h"  /* m0_cs_default_stypes */
-#include "ut/misc.h"        /* M0_UT_PATH */
-#include "rpc/rpclib.h"     /* m0_rpc_server_ctx, m0_rpc_client_ctx */
-#include "rpc/session.h"    /* m0_rpc_session_timedwait */
+#include <stdlib.h>            /* qsort */
+#include <sys/resource.h>      /* getrusage */
+
+#include "lib/ub.h"            /* m0_ub_set */
+#include "lib/misc.h"          /* M0_IN, M0_BITS */
+#include "lib/string.h"        /* strlen, m0_strdup */
+#include "lib/memory.h"        /* m0_free */
+#include "lib/semaphore.h"     /* m0_semaphore */
+#include "lib/vec.h"           /* m0_bufvec_alloc */
+#include "fop/fop.h"           /* m0_fop_alloc */
+#include "net/net.h"           /* m0_net_buffer */
+#include "net/bulk_mem.h"      /* m0_net_bulk_mem_xprt */
+#include "net/lnet/lnet.h"     /* m0_net_lnet_xprt */
+#include "ut/cs_service.h"     /* m0_cs_default_stypes */
+#include "ut/misc.h"           /* M0_UT_PATH */
+#include "rpc/rpclib.h"        /* m0_rpc_server_ctx, m0_rpc_client_ctx */
+#include "rpc/session.h"       /* m0_rpc_session_timedwait */
+#include "rpc/rpc_machine_internal.h" /* m0_rpc_chan */
+#include "rpc/formation2_internal.h"  /* m0_rpc_frm_adapt */
 #include "rpc/ub/fops.h"
 
+/**
+ * @page rpc-ub RPC and network benchmarks
+ *
+ * The "rpc-ub" set of m0ub runs an rpc server and nr_conns clients in a
+ * single process, connected over a loopback transport (xprt=0 is bulk-mem,
+ * xprt=1 is lnet, i.e. whatever transport backs the "lnet" name in this
+ * build). Benchmarks:
+ *
+ * - "ping": nr_pings sequential round trips of a msg_len fop over the first
+ *   connection. Reports latency percentiles.
+ *
+ * - "run": every client posts nr_msgs fops, at most nr_inflight rpcs in
+ *   flight per connection. Reports fops per second, processor time per fop
+ *   and the average number of items per packet.
+ *
+ * - "bulk": nr_bulk transfers of buf_size bytes made of seg_size segments
+ *   between two transfer machines, nr_bufs transfers at a time, bypassing
+ *   rpc. Reports GB/s.
+ *
+ * Each round of a benchmark prints one line of key=value pairs starting
+ * with "rpc-ub:", which includes the values of all arguments. Sweeps
+ * (concurrency, message or buffer size) are done by running m0ub once per
+ * point and collecting these lines, e.g.
+ *
+ * @code
+ * for n in 1 2 4 8 16 32 64; do
+ *         m0ub -t rpc-ub -r 5 -o nr_conns=$n,nr_inflight=100,deadline_ms=1
+ * done | grep '^rpc-ub: bench=run'
+ * @endcode
+ *
+ * then plotting ops_per_sec and cpu_us_per_op ("run"), p50_us, p90_us and
+ * p99_us ("ping") or gb_per_sec ("bulk") against the swept argument.
+ *
+ * Processor time is taken from getrusage() of the whole process, so it
+ * includes the server.
+ */
+
 /* ----------------------------------------------------------------
  * CLI arguments
  * ---------------------------------------------------------------- */
 
-/* X(name, defval, max) */
-#define ARGS                     \
-	X(nr_conns,    2, 10000) \
-	X(nr_msgs,  1000,  5000) \
-	X(msg_len,    32,  8192)
+/* X(name, defval, min, max) */
+#define ARGS                                 \
+	X(xprt,           0,    0,         1) \
+	X(nr_conns,       2,    1,     10000) \
+	X(nr_inflight,   10,    1,      1000) \
+	X(nr_msgs,     1000,    1,      5000) \
+	X(msg_len,       32,    1,      8192) \
+	X(deadline_ms, 1000,    0,     10000) \
+	X(cork,           1,    0,         1) \
+	X(nr_pings,   10000,    1,   1000000) \
+	X(nr_bulk,      100,    1,    100000) \
+	X(nr_bufs,        8,    1,       256) \
+	X(buf_size, 262144,  4096, 1u << 30) \
+	X(seg_size,   4096,  4096, 1u << 30)
 
 struct args {
-#define X(name, defval, max)  unsigned int a_ ## name;
+#define X(name, defval, min, max)  unsigned int a_ ## name;
 	ARGS
 #undef X
 };
@@ -57,17 +111,17 @@ static struct args g_args;
 /** Assigns default values to the arguments. */
 static void args_init(struct args *args)
 {
-#define X(name, defval, max)  args->a_ ## name = defval;
+#define X(name, defval, min, max)  args->a_ ## name = defval;
 	ARGS
 #undef X
 }
 
 static int args_check_limits(const struct args *args)
 {
-#define X(name, defval, max) \
-	&& 0 < args->a_ ## name && args->a_ ## name <= max
+#define X(name, defval, min, max) \
+	&& min <= args->a_ ## name && args->a_ ## name <= max
 
-	if (true ARGS)
+	if (true ARGS && args->a_buf_size % args->a_seg_size == 0)
 		return 0;
 #undef X
 
@@ -94,11 +148,12 @@ static void args_help(void)
 {
 	fprintf(stderr, "Expecting a comma-separated list of parameter"
 		" specifications:\n");
-#define X(name, defval, max) \
-	fprintf(stderr, "  %s=NUM\t(default = %u, ulimit = %u)\n", \
-		#name, defval, max);
+#define X(name, defval, min, max) \
+	fprintf(stderr, "  %s=NUM\t(default = %u, range = [%u, %u])\n", \
+		#name, defval, min, max);
 	ARGS
 #undef X
+	fprintf(stderr, "buf_size must be a multiple of seg_size.\n");
 }
 
 static int args_parse(const char *src, struct args *dest)
@@ -109,7 +164,7 @@ static int args_parse(const char *src, struct args *dest)
 	char *s;
 	char *token;
 	const struct match match_tbl[] = {
-#define X(name, defval, max) { #name "=%u", &dest->a_ ## name },
+#define X(name, defval, min, max) { #name "=%u", &dest->a_ ## name },
 		ARGS
 #undef X
 		{ NULL, NULL }
@@ -129,6 +184,14 @@ static int args_parse(const char *src, struct args *dest)
 	return args_check_limits(dest);
 }
 
+/** Prints the values of all arguments, as a part of a result line. */
+static void args_print(const struct args *args)
+{
+#define X(name, defval, min, max) printf(" " #name "=%u", args->a_ ## name);
+	ARGS
+#undef X
+}
+
 #undef ARGS
 
 /* ----------------------------------------------------------------
@@ -137,23 +200,43 @@ static int args_parse(const char *src, struct args *dest)
 
 enum {
 	CLIENT_COB_DOM_ID  = 16,
-	MAX_RPCS_IN_FLIGHT = 10, /* XXX CONFIGUREME */
 	MAX_RETRIES        = 500,
 	MIN_RECV_QUEUE_LEN = 200
 };
 
-/* #define UB_USE_LNET_XPORT */
-#ifdef UB_USE_LNET_XPORT
-#  define CLIENT_ENDPOINT_FMT  "0@lo:12345:34:%d"
-#  define SERVER_ENDPOINT_ADDR "0@lo:12345:32:1"
-#  define SERVER_ENDPOINT      "lnet:" SERVER_ENDPOINT_ADDR
-static struct m0_net_xprt *g_xprt = &m0_net_lnet_xprt;
-#else
-#  define CLIENT_ENDPOINT_FMT  "127.0.0.1:%d"
-#  define SERVER_ENDPOINT_ADDR "127.0.0.1:1"
-#  define SERVER_ENDPOINT      "bulk-mem:" SERVER_ENDPOINT_ADDR
-static struct m0_net_xprt *g_xprt = &m0_net_bulk_mem_xprt;
-#endif
+/** Loopback transport and end-points the benchmarks run over. */
+struct ub_xprt {
+	const char         *ux_name;
+	struct m0_net_xprt *ux_xprt;
+	/** Format of a client end-point address, "%d" is the client index. */
+	const char         *ux_client_fmt;
+	const char         *ux_server_addr;
+	const char         *ux_server_ep;
+	/** Format of the address of a "bulk" transfer machine. */
+	const char         *ux_bulk_fmt;
+};
+
+static const struct ub_xprt ub_xprts[] = {
+	{
+		.ux_name        = "bulk-mem",
+		.ux_xprt        = &m0_net_bulk_mem_xprt,
+		.ux_client_fmt  = "127.0.0.1:%d",
+		.ux_server_addr = "127.0.0.1:1",
+		.ux_server_ep   = "bulk-mem:127.0.0.1:1",
+		.ux_bulk_fmt    = "127.0.0.2:%d"
+	},
+	{
+		.ux_name        = "lnet",
+		.ux_xprt        = &m0_net_lnet_xprt,
+		.ux_client_fmt  = "0@lo:12345:34:%d",
+		.ux_server_addr = "0@lo:12345:32:1",
+		.ux_server_ep   = "lnet:0@lo:12345:32:1",
+		.ux_bulk_fmt    = "0@lo:12345:36:%d"
+	}
+};
+
+static const struct ub_xprt *g_ux;
+static struct m0_net_xprt   *g_xprt;
 
 struct ub_rpc_client {
 	struct m0_rpc_client_ctx rc_ctx;
@@ -165,12 +248,18 @@ static struct ub_rpc_client *g_clients;
 
 M0_BASSERT(MIN_RECV_QUEUE_LEN == 200);
 
+enum {
+	/* Indices of the end-point arguments in g_argv[]. */
+	ARGV_EP   = 14,
+	ARGV_ADDR = 16
+};
+
 #define NAME(ext) "rpc-ub" ext
 static char *g_argv[] = {
 	NAME(""), "-Q", "200" /* MIN_RECV_QUEUE_LEN */, "-w", "10",
 	"-T", "AD", "-D", NAME(".db"), "-S", NAME(".stob"),
 	"-A", "linuxstob:"NAME(".addb-stob"),
-	"-e", SERVER_ENDPOINT, "-H", SERVER_ENDPOINT_ADDR,
+	"-e", NULL /* ARGV_EP */, "-H", NULL /* ARGV_ADDR */,
 	"-f", M0_UT_CONF_PROCESS,
 	"-c", M0_UT_PATH("conf.xc")
 };
@@ -194,11 +283,17 @@ static const struct m0_rpc_item_ops ub_item_ops = {
  * RPC client and server operations
  * ---------------------------------------------------------------- */
 
+static struct m0_rpc_frm *client_frm(struct ub_rpc_client *client)
+{
+	return &client->rc_ctx.rcx_connection.c_rpcchan->rc_frm;
+}
+
 static void _client_start(struct ub_rpc_client *client, uint32_t cob_dom_id,
 			  const char *ep)
 {
-	int rc;
-	struct m0_fid process_fid = M0_FID_TINIT('r', 2, 1);
+	int                    rc;
+	struct m0_fid          process_fid = M0_FID_TINIT('r', 2, 1);
+	struct m0_rpc_machine *mach = &client->rc_ctx.rcx_rpc_machine;
 
 	rc = m0_net_domain_init(&client->rc_net_dom, g_xprt);
 	M0_ASSERT(rc == 0);
@@ -206,8 +301,8 @@ static void _client_start(struct ub_rpc_client *client, uint32_t cob_dom_id,
 	client->rc_ctx = (struct m0_rpc_client_ctx){
 		.rcx_net_dom               = &client->rc_net_dom,
 		.rcx_local_addr            = m0_strdup(ep),
-		.rcx_remote_addr           = SERVER_ENDPOINT_ADDR,
-		.rcx_max_rpcs_in_flight    = MAX_RPCS_IN_FLIGHT,
+		.rcx_remote_addr           = g_ux->ux_server_addr,
+		.rcx_max_rpcs_in_flight    = g_args.a_nr_inflight,
 		.rcx_recv_queue_min_length = MIN_RECV_QUEUE_LEN,
 		.rcx_fid                   = &process_fid,
 	};
@@ -215,6 +310,11 @@ static void _client_start(struct ub_rpc_client *client, uint32_t cob_dom_id,
 	if (rc != 0)
 		M0_LOG(M0_FATAL, "rc=%d", rc);
 	M0_ASSERT(rc == 0);
+
+	m0_rpc_machine_lock(mach);
+	client_frm(client)->f_constraints.fc_max_cork_delay =
+		g_args.a_cork ? M0_RPC_FRM_CORK_DELAY : 0;
+	m0_rpc_machine_unlock(mach);
 }
 
 static void _client_stop(struct ub_rpc_client *client)
@@ -234,7 +334,15 @@ static int _start(const char *opts)
 	char ep[40];
 
 	args_init(&g_args);
-	rc = args_parse(opts, &g_args) ?: m0_rpc_server_start(&g_sctx);
+	rc = args_parse(opts, &g_args);
+	if (rc != 0)
+		return rc;
+
+	g_ux   = &ub_xprts[g_args.a_xprt];
+	g_xprt = g_ux->ux_xprt;
+	g_argv[ARGV_EP]   = (char *)g_ux->ux_server_ep;
+	g_argv[ARGV_ADDR] = (char *)g_ux->ux_server_addr;
+	rc = m0_rpc_server_start(&g_sctx);
 	if (rc != 0)
 		return rc;
 
@@ -245,7 +353,7 @@ static int _start(const char *opts)
 	}
 
 	for (i = 0; i < g_args.a_nr_conns; ++i) {
-		snprintf(ep, sizeof ep, CLIENT_ENDPOINT_FMT,
+		snprintf(ep, sizeof ep, g_ux->ux_client_fmt,
 			 2 + i); /* 1 is server EP, so we start from 2 */
 		_client_start(&g_clients[i], CLIENT_COB_DOM_ID + i, ep);
 	}
@@ -285,13 +393,12 @@ static void ub_item_replied(struct m0_rpc_item *item)
 	M0_UB_ASSERT(m0_buf_eq(&resp->ur_data, &req->uq_data));
 }
 
-static void fop_send(struct m0_rpc_session *session, size_t msg_id)
+static struct m0_fop *fop_alloc(struct m0_rpc_session *session, size_t msg_id)
 {
 	struct m0_fop      *fop;
 	struct ub_req      *req;
 	struct m0_rpc_item *item;
 	char               *data;
-	int                 rc;
 
 	M0_PRE(g_args.a_msg_len > 0);
 
@@ -307,10 +414,20 @@ static void fop_send(struct m0_rpc_session *session, size_t msg_id)
 
 	item = &fop->f_item;
 	item->ri_nr_sent_max = MAX_RETRIES;
-	item->ri_ops         = &ub_item_ops;
-	item->ri_session     = session;
-	item->ri_deadline    = m0_time_from_now(1, 0);
-	item->ri_prio        = M0_RPC_ITEM_PRIO_MID; /* XXX CONFIGUREME */
+	return fop;
+}
+
+static void fop_send(struct m0_rpc_session *session, size_t msg_id)
+{
+	struct m0_fop      *fop = fop_alloc(session, msg_id);
+	struct m0_rpc_item *item = &fop->f_item;
+	int                 rc;
+
+	item->ri_ops      = &ub_item_ops;
+	item->ri_session  = session;
+	item->ri_deadline = g_args.a_deadline_ms == 0 ? 0 :
+		m0_time_from_now(0, g_args.a_deadline_ms * M0_TIME_ONE_MSEC);
+	item->ri_prio     = M0_RPC_ITEM_PRIO_MID; /* XXX CONFIGUREME */
 
 	rc = m0_rpc_post(item);
 	M0_UB_ASSERT(rc == 0);
@@ -318,7 +435,42 @@ static void fop_send(struct m0_rpc_session *session, size_t msg_id)
 }
 
 /* ----------------------------------------------------------------
- * Benchmark
+ * Result reporting
+ * ---------------------------------------------------------------- */
+
+/** Processor time (user and system) consumed by the process. */
+static m0_time_t cpu_time(void)
+{
+	struct rusage ru;
+	int           rc;
+
+	rc = getrusage(RUSAGE_SELF, &ru);
+	M0_UB_ASSERT(rc == 0);
+	return m0_time(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec,
+		       (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000);
+}
+
+/** Converts time interval to microseconds. */
+static double usec(m0_time_t t)
+{
+	return (double)t / 1000;
+}
+
+/** Starts a result line, finished with result_end(). */
+static void result_start(const char *bench)
+{
+	printf("rpc-ub: bench=%s xprt_name=%s", bench, g_ux->ux_name);
+	args_print(&g_args);
+}
+
+static void result_end(void)
+{
+	printf("\n");
+	fflush(stdout);
+}
+
+/* ----------------------------------------------------------------
+ * Benchmarks
  * ---------------------------------------------------------------- */
 
 static struct m0_rpc_session *_session(unsigned int i)
@@ -327,14 +479,39 @@ static struct m0_rpc_session *_session(unsigned int i)
 	return &g_clients[i].rc_ctx.rcx_session;
 }
 
+/** Sums formation statistics over the clients. */
+static void frm_stats(uint64_t *nr_items, uint64_t *nr_packets)
+{
+	struct m0_rpc_machine *mach;
+	int                    k;
+
+	*nr_items = *nr_packets = 0;
+	for (k = 0; k < g_args.a_nr_conns; ++k) {
+		mach = &g_clients[k].rc_ctx.rcx_rpc_machine;
+		m0_rpc_machine_lock(mach);
+		*nr_items   += client_frm(&g_clients[k])->f_adapt.fa_nr_items;
+		*nr_packets += client_frm(&g_clients[k])->f_adapt.fa_nr_packets;
+		m0_rpc_machine_unlock(mach);
+	}
+}
+
 static void run(int iter M0_UNUSED)
 {
-	int n;
-	int k;
-	int rc;
+	int       n;
+	int       k;
+	int       rc;
+	uint64_t  nr_ops = (uint64_t)g_args.a_nr_msgs * g_args.a_nr_conns;
+	uint64_t  items[2];
+	uint64_t  packets[2];
+	m0_time_t start;
+	m0_time_t cpu;
+	m0_time_t elapsed;
 
 	M0_PRE(g_args.a_nr_msgs > 0 && g_args.a_nr_conns > 0);
 
+	frm_stats(&items[0], &packets[0]);
+	cpu   = cpu_time();
+	start = m0_time_now();
 	/* @todo: For some reason the following error may occur here:
 	   motr: NOTICE : [rpc/slot.c:584:m0_rpc_slot_reply_received] < rc=-71.
 	   Needs investigation!
@@ -351,6 +528,278 @@ static void run(int iter M0_UNUSED)
 					      M0_TIME_NEVER);
 		M0_UB_ASSERT(rc == 0);
 	}
+	elapsed = m0_time_sub(m0_time_now(), start);
+	cpu     = m0_time_sub(cpu_time(), cpu);
+	frm_stats(&items[1], &packets[1]);
+
+	result_start("run");
+	printf(" ops=%"PRIu64" sec=%.6f ops_per_sec=%.1f cpu_us_per_op=%.3f"
+	       " items_per_packet=%.2f", nr_ops,
+	       usec(elapsed) / 1000000, nr_ops * 1000000 / usec(elapsed),
+	       usec(cpu) / nr_ops,
+	       packets[1] == packets[0] ? 0.0 :
+	       (double)(items[1] - items[0]) / (packets[1] - packets[0]));
+	result_end();
+}
+
+static m0_time_t *g_lat;
+
+static void ping_init(void)
+{
+	M0_ALLOC_ARR(g_lat, g_args.a_nr_pings);
+	M0_UB_ASSERT(g_lat != NULL);
+}
+
+static void ping_fini(void)
+{
+	m0_free(g_lat);
+}
+
+static int lat_cmp(const void *a, const void *b)
+{
+	return M0_3WAY(*(const m0_time_t *)a, *(const m0_time_t *)b);
+}
+
+/** Returns p-th percentile of the sorted latencies. */
+static double lat_pct(double p)
+{
+	uint64_t nr = g_args.a_nr_pings;
+
+	return usec(g_lat[min64u(nr * p / 100, nr - 1)]);
+}
+
+static void ping(int iter M0_UNUSED)
+{
+	struct m0_rpc_session *session = _session(0);
+	struct m0_fop         *fop;
+	m0_time_t              start;
+	m0_time_t              cpu;
+	m0_time_t              total = 0;
+	uint64_t               nr = g_args.a_nr_pings;
+	uint64_t               i;
+	int                    rc;
+
+	cpu = cpu_time();
+	for (i = 0; i < nr; ++i) {
+		fop   = fop_alloc(session, i);
+		start = m0_time_now();
+		rc = m0_rpc_post_sync(fop, session, &ub_item_ops, 0);
+		g_lat[i] = m0_time_sub(m0_time_now(), start);
+		M0_UB_ASSERT(rc == 0);
+		m0_fop_put_lock(fop);
+		total += g_lat[i];
+	}
+	cpu = m0_time_sub(cpu_time(), cpu);
+	qsort(g_lat, nr, sizeof g_lat[0], &lat_cmp);
+
+	result_start("ping");
+	printf(" ops=%"PRIu64" avg_us=%.2f p50_us=%.2f p90_us=%.2f"
+	       " p99_us=%.2f p999_us=%.2f max_us=%.2f cpu_us_per_op=%.3f",
+	       nr, usec(total) / nr, lat_pct(50), lat_pct(90), lat_pct(99),
+	       lat_pct(99.9), usec(g_lat[nr - 1]), usec(cpu) / nr);
+	result_end();
+}
+
+/**
+ * Bulk transfers between two transfer machines in different domains: the
+ * "dst" machine posts passive receive buffers, the "src" machine sends into
+ * them.
+ */
+struct ub_bulk_tm {
+	struct m0_net_domain       ut_dom;
+	struct m0_net_transfer_mc  ut_tm;
+	struct m0_net_buffer      *ut_bufs;
+};
+
+static struct ub_bulk_tm         g_src;
+static struct ub_bulk_tm         g_dst;
+/** End-point of g_src in g_dst. */
+static struct m0_net_end_point  *g_src_ep;
+/** Signalled on completion of every buffer operation. */
+static struct m0_semaphore       g_bulk_done;
+
+static void bulk_tm_event_cb(const struct m0_net_tm_event *ev)
+{
+}
+
+static const struct m0_net_tm_callbacks bulk_tm_cbs = {
+	.ntc_event_cb = bulk_tm_event_cb
+};
+
+static void bulk_buf_cb(const struct m0_net_buffer_event *ev)
+{
+	if (ev->nbe_status != 0)
+		M0_LOG(M0_FATAL, "status=%d", ev->nbe_status);
+	M0_UB_ASSERT(ev->nbe_status == 0);
+	m0_semaphore_up(&g_bulk_done);
+}
+
+static const struct m0_net_buffer_callbacks bulk_buf_cbs = {
+	.nbc_cb = {
+		[M0_NET_QT_PASSIVE_BULK_RECV] = bulk_buf_cb,
+		[M0_NET_QT_ACTIVE_BULK_SEND]  = bulk_buf_cb
+	}
+};
+
+static void bulk_tm_init(struct ub_bulk_tm *ut, int id)
+{
+	struct m0_net_domain *dom = &ut->ut_dom;
+	struct m0_clink       clink;
+	struct m0_net_buffer *nb;
+	char                  addr[40];
+	int                   i;
+	int                   rc;
+
+	rc = m0_net_domain_init(dom, g_xprt);
+	M0_UB_ASSERT(rc == 0);
+	if (g_args.a_buf_size > m0_net_domain_get_max_buffer_size(dom) ||
+	    g_args.a_seg_size >
+	    m0_net_domain_get_max_buffer_segment_size(dom) ||
+	    g_args.a_buf_size / g_args.a_seg_size >
+	    m0_net_domain_get_max_buffer_segments(dom)) {
+		fprintf(stderr, "buf_size or seg_size exceeds the limits of %s"
+			" (%"PRIu64" bytes, %"PRIu64" bytes per segment)\n",
+			g_ux->ux_name, m0_net_domain_get_max_buffer_size(dom),
+			m0_net_domain_get_max_buffer_segment_size(dom));
+		M0_UB_ASSERT(false);
+	}
+
+	ut->ut_tm = (struct m0_net_transfer_mc) {
+		.ntm_callbacks = &bulk_tm_cbs,
+		.ntm_state     = M0_NET_TM_UNDEFINED
+	};
+	rc = m0_net_tm_init(&ut->ut_tm, dom);
+	M0_UB_ASSERT(rc == 0);
+	snprintf(addr, sizeof addr, g_ux->ux_bulk_fmt, id);
+	m0_clink_init(&clink, NULL);
+	m0_clink_add_lock(&ut->ut_tm.ntm_chan, &clink);
+	rc = m0_net_tm_start(&ut->ut_tm, addr);
+	M0_UB_ASSERT(rc == 0);
+	while (!M0_IN(ut->ut_tm.ntm_state, (M0_NET_TM_STARTED,
+					    M0_NET_TM_FAILED)))
+		m0_chan_wait(&clink);
+	m0_clink_del_lock(&clink);
+	m0_clink_fini(&clink);
+	M0_UB_ASSERT(ut->ut_tm.ntm_state == M0_NET_TM_STARTED);
+
+	M0_ALLOC_ARR(ut->ut_bufs, g_args.a_nr_bufs);
+	M0_UB_ASSERT(ut->ut_bufs != NULL);
+	for (i = 0; i < g_args.a_nr_bufs; ++i) {
+		nb = &ut->ut_bufs[i];
+		rc = m0_bufvec_alloc(&nb->nb_buffer,
+				     g_args.a_buf_size / g_args.a_seg_size,
+				     g_args.a_seg_size);
+		M0_UB_ASSERT(rc == 0);
+		nb->nb_callbacks = &bulk_buf_cbs;
+		rc = m0_net_buffer_register(nb, dom);
+		M0_UB_ASSERT(rc == 0);
+	}
+}
+
+static void bulk_tm_fini(struct ub_bulk_tm *ut)
+{
+	struct m0_clink clink;
+	int             i;
+	int             rc;
+
+	for (i = 0; i < g_args.a_nr_bufs; ++i) {
+		m0_net_buffer_deregister(&ut->ut_bufs[i], &ut->ut_dom);
+		m0_bufvec_free(&ut->ut_bufs[i].nb_buffer);
+	}
+	m0_free(ut->ut_bufs);
+
+	m0_clink_init(&clink, NULL);
+	m0_clink_add_lock(&ut->ut_tm.ntm_chan, &clink);
+	rc = m0_net_tm_stop(&ut->ut_tm, false);
+	M0_UB_ASSERT(rc == 0);
+	while (!M0_IN(ut->ut_tm.ntm_state, (M0_NET_TM_STOPPED,
+					    M0_NET_TM_FAILED)))
+		m0_chan_wait(&clink);
+	m0_clink_del_lock(&clink);
+	m0_clink_fini(&clink);
+	m0_net_tm_fini(&ut->ut_tm);
+	m0_net_domain_fini(&ut->ut_dom);
+}
+
+static void bulk_init(void)
+{
+	int rc;
+
+	m0_semaphore_init(&g_bulk_done, 0);
+	bulk_tm_init(&g_src, 1);
+	bulk_tm_init(&g_dst, 2);
+	rc = m0_net_end_point_create(&g_src_ep, &g_dst.ut_tm,
+				     g_src.ut_tm.ntm_ep->nep_addr);
+	M0_UB_ASSERT(rc == 0);
+}
+
+static void bulk_fini(void)
+{
+	m0_net_end_point_put(g_src_ep);
+	bulk_tm_fini(&g_dst);
+	bulk_tm_fini(&g_src);
+	m0_semaphore_fini(&g_bulk_done);
+}
+
+/** Transfers the contents of nr source buffers into destination buffers. */
+static void bulk_batch(int nr)
+{
+	struct m0_net_buffer *src;
+	struct m0_net_buffer *dst;
+	int                   i;
+	int                   rc;
+
+	for (i = 0; i < nr; ++i) {
+		dst = &g_dst.ut_bufs[i];
+		dst->nb_qtype  = M0_NET_QT_PASSIVE_BULK_RECV;
+		dst->nb_ep     = g_src_ep;
+		dst->nb_length = g_args.a_buf_size;
+		dst->nb_offset = 0;
+		rc = m0_net_buffer_add(dst, &g_dst.ut_tm);
+		M0_UB_ASSERT(rc == 0);
+
+		src = &g_src.ut_bufs[i];
+		rc = m0_net_desc_copy(&dst->nb_desc, &src->nb_desc);
+		M0_UB_ASSERT(rc == 0);
+		src->nb_qtype  = M0_NET_QT_ACTIVE_BULK_SEND;
+		src->nb_length = g_args.a_buf_size;
+		src->nb_offset = 0;
+		rc = m0_net_buffer_add(src, &g_src.ut_tm);
+		M0_UB_ASSERT(rc == 0);
+	}
+	for (i = 0; i < 2 * nr; ++i)
+		m0_semaphore_down(&g_bulk_done);
+	for (i = 0; i < nr; ++i) {
+		m0_net_desc_free(&g_src.ut_bufs[i].nb_desc);
+		m0_net_desc_free(&g_dst.ut_bufs[i].nb_desc);
+	}
+}
+
+static void bulk(int iter M0_UNUSED)
+{
+	uint64_t  left = g_args.a_nr_bulk;
+	uint64_t  nob = left * g_args.a_buf_size;
+	m0_time_t start;
+	m0_time_t cpu;
+	m0_time_t elapsed;
+	int       nr;
+
+	cpu   = cpu_time();
+	start = m0_time_now();
+	while (left > 0) {
+		nr = min64u(left, g_args.a_nr_bufs);
+		bulk_batch(nr);
+		left -= nr;
+	}
+	elapsed = m0_time_sub(m0_time_now(), start);
+	cpu     = m0_time_sub(cpu_time(), cpu);
+
+	result_start("bulk");
+	printf(" ops=%u bytes=%"PRIu64" sec=%.6f gb_per_sec=%.3f"
+	       " cpu_us_per_op=%.3f", g_args.a_nr_bulk, nob,
+	       usec(elapsed) / 1000000, nob / usec(elapsed) / 1000,
+	       usec(cpu) / g_args.a_nr_bulk);
+	result_end();
 }
 
 struct m0_ub_set m0_rpc_ub = {
@@ -358,9 +807,19 @@ struct m0_ub_set m0_rpc_ub = {
 	.us_init = _start,
 	.us_fini = _stop,
 	.us_run  = {
+		{ .ub_name  = "ping",
+		  .ub_iter  = 1,
+		  .ub_init  = ping_init,
+		  .ub_fini  = ping_fini,
+		  .ub_round = ping },
 		{ .ub_name  = "run",
 		  .ub_iter  = 1,
 		  .ub_round = run },
+		{ .ub_name  = "bulk",
+		  .ub_iter  = 1,
+		  .ub_init  = bulk_init,
+		  .ub_fini  = bulk_fini,
+		  .ub_round = bulk },
 		{ .ub_name = NULL }  /* terminator */
 	}
 };
@@ -648,6 +648,113 @@ static void frm_test8(void)
 	M0_LEAVE();
 }
 
+static void frm_adaptive_test(void)
+{
+	/*
+	 * Items arriving faster than packets complete are corked while a
+	 * packet is in flight and are sent together when it completes.
+	 */
+	enum { N = 4 };
+	struct m0_rpc_frm_constraints saved = frm->f_constraints;
+	struct m0_rpc_item           *items[N + 1];
+	struct m0_rpc_packet         *p;
+	int                           i;
+
+	M0_SET0(&frm->f_adapt);
+	frm->f_constraints.fc_max_cork_delay = M0_TIME_ONE_SECOND;
+	flags_reset();
+	items[0] = new_item(TIMEDOUT, NORMAL);
+	m0_rpc_frm_enq_item(frm, items[0]);
+	/* Nothing is in flight: the item is sent immediately. */
+	M0_UT_ASSERT(packet_ready_called);
+	check_frm(FRM_BUSY, 0, 1);
+	/* Pretend that the network is slow compared to item arrival. */
+	frm->f_adapt.fa_latency = M0_TIME_ONE_SECOND / 2;
+	flags_reset();
+	for (i = 1; i <= N; ++i) {
+		items[i] = new_item(TIMEDOUT, NORMAL);
+		m0_rpc_frm_enq_item(frm, items[i]);
+		M0_UT_ASSERT(!packet_ready_called);
+		check_frm(FRM_BUSY, i, 1);
+	}
+	M0_UT_ASSERT(frm->f_adapt.fa_corked != 0);
+	p = packet_stack_pop();
+	M0_UT_ASSERT(m0_rpc_packet_is_carrying_item(p, items[0]));
+	m0_rpc_frm_packet_done(p);
+	m0_rpc_packet_discard(p);
+	/* Completion uncorks the queue, all items go in one packet. */
+	M0_UT_ASSERT(packet_ready_called);
+	p = packet_stack_pop();
+	M0_UT_ASSERT(packet_stack_is_empty());
+	M0_UT_ASSERT(m0_forall(j, N, m0_rpc_packet_is_carrying_item(p,
+							items[j + 1])));
+	check_frm(FRM_BUSY, 0, 1);
+	M0_UT_ASSERT(frm->f_adapt.fa_nr_packets == 2);
+	M0_UT_ASSERT(frm->f_adapt.fa_nr_items == N + 1);
+	M0_UT_ASSERT(frm->f_adapt.fa_corked == 0);
+	M0_UT_ASSERT(frm->f_adapt.fa_delay > 0);
+	m0_rpc_frm_packet_done(p);
+	m0_rpc_packet_discard(p);
+	check_frm(FRM_IDLE, 0, 0);
+	for (i = 0; i <= N; ++i) {
+		m0_rpc_item_fini(items[i]);
+		m0_free(items[i]);
+	}
+	frm->f_constraints = saved;
+}
+
+static void frm_cork_timer_test(void)
+{
+	/*
+	 * Corked items are sent once fc_max_cork_delay passes, even if the
+	 * in-flight packet does not complete.
+	 */
+	struct m0_rpc_frm_constraints saved = frm->f_constraints;
+	struct m0_rpc_item           *items[2];
+	struct m0_rpc_packet         *p;
+	m0_time_t                     delay = M0_TIME_ONE_MSEC * 100;
+	int                           i;
+
+	M0_SET0(&frm->f_adapt);
+	frm->f_constraints.fc_max_cork_delay = delay;
+	flags_reset();
+	items[0] = new_item(TIMEDOUT, NORMAL);
+	m0_rpc_frm_enq_item(frm, items[0]);
+	M0_UT_ASSERT(packet_ready_called);
+	check_frm(FRM_BUSY, 0, 1);
+	frm->f_adapt.fa_latency = delay / 2;
+	flags_reset();
+	items[1] = new_item(TIMEDOUT, NORMAL);
+	m0_rpc_frm_enq_item(frm, items[1]);
+	M0_UT_ASSERT(!packet_ready_called);
+	M0_UT_ASSERT(frm->f_adapt.fa_corked != 0);
+	M0_UT_ASSERT(m0_sm_timer_is_armed(&frm->f_cork_timer));
+	/* Let RPC worker process the timer AST. */
+	for (i = 0; i < 100 && !packet_ready_called; ++i) {
+		m0_rpc_machine_unlock(&rmachine);
+		m0_nanosleep(delay, NULL);
+		m0_rpc_machine_lock(&rmachine);
+	}
+	M0_UT_ASSERT(packet_ready_called);
+	M0_UT_ASSERT(frm->f_adapt.fa_corked == 0);
+	M0_UT_ASSERT(!m0_sm_timer_is_armed(&frm->f_cork_timer));
+	check_frm(FRM_BUSY, 0, 2);
+	p = packet_stack_pop();
+	M0_UT_ASSERT(m0_rpc_packet_is_carrying_item(p, items[1]));
+	m0_rpc_frm_packet_done(p);
+	m0_rpc_packet_discard(p);
+	p = packet_stack_pop();
+	M0_UT_ASSERT(m0_rpc_packet_is_carrying_item(p, items[0]));
+	m0_rpc_frm_packet_done(p);
+	m0_rpc_packet_discard(p);
+	check_frm(FRM_IDLE, 0, 0);
+	for (i = 0; i < ARRAY_SIZE(items); ++i) {
+		m0_rpc_item_fini(items[i]);
+		m0_free(items[i]);
+	}
+	frm->f_constraints = saved;
+}
+
 static void frm_fini_test(void)
 {
 	m0_rpc_frm_fini(frm);
@@ -667,6 +774,8 @@ struct m0_ut_suite frm_ut = {
 		{ "frm-test6",    frm_test6    },
 		{ "frm-test7",    frm_test7    },
 		{ "frm-test8",    frm_test8    },
+		{ "frm-adaptive", frm_adaptive_test },
+		{ "frm-cork-timer", frm_cork_timer_test },
 		{ "frm-fini",     frm_fini_test},
 		{ NULL,           NULL         }
 	}
@@ -50,6 +50,8 @@
  */
 static struct m0_sm_ast eoq;
 
+static void sm_wheel_fini(struct m0_sm_group *grp);
+
 M0_INTERNAL void m0_sm_group_init(struct m0_sm_group *grp)
 {
 	M0_SET0(grp);
@@ -64,6 +66,8 @@ M0_INTERNAL void m0_sm_group_init(struct m0_sm_group *grp)
 
 M0_INTERNAL void m0_sm_group_fini(struct m0_sm_group *grp)
 {
+	if (grp->s_wheel != NULL)
+		sm_wheel_fini(grp);
 	M0_PRE(grp->s_forkq == &eoq);
 
 	if (m0_clink_is_armed(&grp->s_clink))
@@ -490,7 +494,7 @@ M0_INTERNAL void m0_sm_move(struct m0_sm *mach, int32_t rc, int state)
  *                              INIT
  *                                 |
  *                         +-----+ | m0_sm_timer_start()
- *          sm_timer_top() |     | |
+ *      sm_wheel_advance() |     | |
  *                         |     V V
  *                         +----ARMED
  *                               | |
@@ -508,32 +512,278 @@ enum timer_state {
 };
 
 /**
-    Timer call-back for a state machine timer.
+ * Timer wheel.
+ *
+ * Deadlines of the group timers are measured in ticks of
+ * 2^SM_WHEEL_TICK_SHIFT nanoseconds. The wheel has SM_WHEEL_LEVEL_NR levels of
+ * SM_WHEEL_SLOT_NR slots. Consider a deadline and the current tick of the
+ * wheel (m0_sm_wheel::sw_now) as numbers in base SM_WHEEL_SLOT_NR: a timer is
+ * at the level of the highest digit where they differ, in the slot given by
+ * this digit of the deadline. When the wheel reaches the tick where a digit
+ * becomes equal to a slot (all lower digits being 0), the timers of the slot
+ * are moved to the lower levels. Level 0 timers expire when the wheel reaches
+ * their slot. Timers beyond the last level wait in the overflow slot until
+ * the last level wraps around.
+ *
+ * Everything is done under the group lock. A single m0_timer is started for
+ * the next tick when something happens in the wheel. It posts an AST, which
+ * advances the wheel to the current time and posts the ASTs of expired
+ * timers. Deadlines are rounded up to ticks, so that timers are never early.
+ */
+enum {
+	/** A tick is ~65us. */
+	SM_WHEEL_TICK_SHIFT = 16,
+	SM_WHEEL_SLOT_SHIFT = 6,
+	SM_WHEEL_SLOT_NR    = 1 << SM_WHEEL_SLOT_SHIFT,
+	SM_WHEEL_LEVEL_NR   = 5,
+	/** Index of the overflow slot in m0_sm_wheel::sw_slot[]. */
+	SM_WHEEL_OVERFLOW   = SM_WHEEL_LEVEL_NR * SM_WHEEL_SLOT_NR,
+};
 
-    @see m0_sm_timer_start().
+struct m0_sm_wheel {
+	struct m0_sm_group *sw_grp;
+	/** The wheel is advanced up to this tick. */
+	uint64_t            sw_now;
+	/** Tick sw_timer is started for, UINT64_MAX if none. */
+	uint64_t            sw_armed;
+	/** Bitmaps of non-empty slots, per level. */
+	uint64_t            sw_busy[SM_WHEEL_LEVEL_NR];
+	/** Slots of all levels, followed by the overflow slot. */
+	struct m0_tl        sw_slot[SM_WHEEL_OVERFLOW + 1];
+	struct m0_timer     sw_timer;
+	struct m0_sm_ast    sw_ast;
+	/** sw_ast is posted and hasn't run yet. */
+	int64_t             sw_posted;
+};
+
+M0_TL_DESCR_DEFINE(sm_timer, "sm timers", static, struct m0_sm_timer,
+		   tr_linkage, tr_magic, M0_SM_TIMER_MAGIC,
+		   M0_SM_TIMER_HEAD_MAGIC);
+M0_TL_DEFINE(sm_timer, static, struct m0_sm_timer);
+
+static uint64_t sm_wheel_tick(m0_time_t time)
+{
+	return (time >> SM_WHEEL_TICK_SHIFT) +
+	       !!(time & (M0_BITS(SM_WHEEL_TICK_SHIFT) - 1));
+}
+
+static uint32_t sm_wheel_shift(uint32_t level)
+{
+	return level * SM_WHEEL_SLOT_SHIFT;
+}
+
+static bool sm_wheel_is_empty(const struct m0_sm_wheel *w)
+{
+	return m0_forall(i, SM_WHEEL_LEVEL_NR, w->sw_busy[i] == 0) &&
+	       sm_timer_tlist_is_empty(&w->sw_slot[SM_WHEEL_OVERFLOW]);
+}
+
+static void sm_wheel_insert(struct m0_sm_wheel *w, struct m0_sm_timer *timer)
+{
+	uint64_t diff = timer->tr_expire ^ w->sw_now;
+	uint32_t level;
+	uint32_t slot;
+
+	M0_PRE(timer->tr_expire > w->sw_now);
+
+	for (level = 0; level < SM_WHEEL_LEVEL_NR &&
+	     (diff >> sm_wheel_shift(level + 1)) != 0; ++level)
+		;
+	if (level == SM_WHEEL_LEVEL_NR) {
+		slot = SM_WHEEL_OVERFLOW;
+	} else {
+		slot = (timer->tr_expire >> sm_wheel_shift(level)) &
+		       (SM_WHEEL_SLOT_NR - 1);
+		w->sw_busy[level] |= M0_BITS(slot);
+		slot += level * SM_WHEEL_SLOT_NR;
+	}
+	timer->tr_slot = slot;
+	sm_timer_tlist_add_tail(&w->sw_slot[slot], timer);
+}
+
+static void sm_wheel_del(struct m0_sm_wheel *w, struct m0_sm_timer *timer)
+{
+	uint32_t slot = timer->tr_slot;
+
+	sm_timer_tlist_del(timer);
+	if (slot != SM_WHEEL_OVERFLOW &&
+	    sm_timer_tlist_is_empty(&w->sw_slot[slot]))
+		w->sw_busy[slot / SM_WHEEL_SLOT_NR] &=
+			~M0_BITS(slot % SM_WHEEL_SLOT_NR);
+}
+
+/** Returns the next tick when timers expire or move, UINT64_MAX if none. */
+static uint64_t sm_wheel_next(const struct m0_sm_wheel *w)
+{
+	uint64_t next = UINT64_MAX;
+	uint64_t busy;
+	uint64_t base;
+	uint32_t shift;
+	uint32_t level;
+
+	for (level = 0; level < SM_WHEEL_LEVEL_NR; ++level) {
+		busy = w->sw_busy[level];
+		if (busy == 0)
+			continue;
+		shift = sm_wheel_shift(level);
+		base  = w->sw_now >> (shift + SM_WHEEL_SLOT_SHIFT)
+				  << (shift + SM_WHEEL_SLOT_SHIFT);
+		next  = min64u(next, base |
+			       (uint64_t)m0_log2(busy & -busy) << shift);
+	}
+	if (!sm_timer_tlist_is_empty(&w->sw_slot[SM_WHEEL_OVERFLOW])) {
+		shift = sm_wheel_shift(SM_WHEEL_LEVEL_NR);
+		next  = min64u(next, ((w->sw_now >> shift) + 1) << shift);
+	}
+	M0_POST(next > w->sw_now);
+	return next;
+}
+
+/* Moves timers of the slot to the lower levels, posts ASTs of expired ones. */
+static void sm_wheel_cascade(struct m0_sm_wheel *w, uint32_t slot)
+{
+	struct m0_sm_timer *timer;
+	struct m0_tl        todo;
+
+	if (sm_timer_tlist_is_empty(&w->sw_slot[slot]))
+		return;
+	sm_timer_tlist_init(&todo);
+	m0_tl_teardown(sm_timer, &w->sw_slot[slot], timer)
+		sm_timer_tlist_add_tail(&todo, timer);
+	if (slot != SM_WHEEL_OVERFLOW)
+		w->sw_busy[slot / SM_WHEEL_SLOT_NR] &=
+			~M0_BITS(slot % SM_WHEEL_SLOT_NR);
+	m0_tl_teardown(sm_timer, &todo, timer) {
+		if (timer->tr_expire <= w->sw_now)
+			m0_sm_ast_post(w->sw_grp, &timer->tr_ast);
+		else
+			sm_wheel_insert(w, timer);
+	}
+	sm_timer_tlist_fini(&todo);
+}
+
+static void sm_wheel_advance(struct m0_sm_wheel *w, uint64_t now)
+{
+	uint64_t next;
+	uint32_t shift;
+	uint32_t level;
+
+	while ((next = sm_wheel_next(w)) <= now) {
+		w->sw_now = next;
+		shift = sm_wheel_shift(SM_WHEEL_LEVEL_NR);
+		if ((next & (M0_BITS(shift) - 1)) == 0)
+			sm_wheel_cascade(w, SM_WHEEL_OVERFLOW);
+		for (level = SM_WHEEL_LEVEL_NR; level-- > 0; ) {
+			shift = sm_wheel_shift(level);
+			if ((next & (M0_BITS(shift) - 1)) == 0)
+				sm_wheel_cascade(w, level * SM_WHEEL_SLOT_NR +
+						 ((next >> shift) &
+						  (SM_WHEEL_SLOT_NR - 1)));
+		}
+	}
+	w->sw_now = max64u(w->sw_now, now);
+}
+
+/** Starts the m0_timer for the next wheel event, unless it's earlier. */
+static void sm_wheel_arm(struct m0_sm_wheel *w)
+{
+	uint64_t next = sm_wheel_next(w);
+
+	if (next < w->sw_armed) {
+		if (m0_timer_is_started(&w->sw_timer))
+			m0_timer_stop(&w->sw_timer);
+		m0_timer_start(&w->sw_timer, next << SM_WHEEL_TICK_SHIFT);
+		w->sw_armed = next;
+	}
+}
+
+/**
+    Timer call-back of the group timer wheel.
 */
-static unsigned long sm_timer_top(unsigned long data)
+static unsigned long sm_wheel_top(unsigned long data)
 {
-	struct m0_sm_timer *timer = (void *)data;
+	struct m0_sm_wheel *w = (void *)data;
 
-	M0_PRE(M0_IN(timer->tr_state, (ARMED, DONE)));
 	/*
-	 * no synchronisation or memory barriers are needed here: it's OK to
-	 * occasionally post the AST when the timer is already cancelled,
-	 * because the ast call-back, synchronised with the cancellation by
-	 * the group lock, will sort this out.
+	 * The wheel AST can still be in the queue, if it was posted before
+	 * the timer was restarted.
 	 */
-	if (timer->tr_state == ARMED)
-		m0_sm_ast_post(timer->tr_grp, &timer->tr_ast);
+	if (m0_atomic64_cas(&w->sw_posted, 0, 1))
+		m0_sm_ast_post(w->sw_grp, &w->sw_ast);
 	return 0;
 }
 
+/**
+    AST call-back of the group timer wheel.
+*/
+static void sm_wheel_bottom(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct m0_sm_wheel *w = container_of(ast, struct m0_sm_wheel, sw_ast);
+
+	M0_PRE(grp_is_locked(grp));
+
+	if (m0_timer_is_started(&w->sw_timer))
+		m0_timer_stop(&w->sw_timer);
+	w->sw_armed = UINT64_MAX;
+	m0_atomic64_cas(&w->sw_posted, 1, 0);
+	sm_wheel_advance(w, m0_time_now() >> SM_WHEEL_TICK_SHIFT);
+	sm_wheel_arm(w);
+}
+
+static int sm_wheel_init(struct m0_sm_group *grp)
+{
+	struct m0_sm_wheel *w;
+	int                 result;
+	int                 i;
+
+	M0_ALLOC_PTR(w);
+	if (w == NULL)
+		return M0_ERR(-ENOMEM);
+	result = m0_timer_init(&w->sw_timer, M0_TIMER_HARD, NULL,
+			       sm_wheel_top, (unsigned long)w);
+	if (result != 0) {
+		m0_free(w);
+		return M0_ERR(result);
+	}
+	for (i = 0; i < ARRAY_SIZE(w->sw_slot); ++i)
+		sm_timer_tlist_init(&w->sw_slot[i]);
+	w->sw_grp         = grp;
+	w->sw_now         = m0_time_now() >> SM_WHEEL_TICK_SHIFT;
+	w->sw_armed       = UINT64_MAX;
+	w->sw_ast.sa_cb   = sm_wheel_bottom;
+	grp->s_wheel      = w;
+	return 0;
+}
+
+static void sm_wheel_fini(struct m0_sm_group *grp)
+{
+	struct m0_sm_wheel *w = grp->s_wheel;
+	int                 i;
+
+	M0_PRE(sm_wheel_is_empty(w));
+
+	if (m0_timer_is_started(&w->sw_timer))
+		m0_timer_stop(&w->sw_timer);
+	m0_timer_fini(&w->sw_timer);
+	/* The timer could fire after the last timer had been cancelled. */
+	if (w->sw_ast.sa_next != NULL) {
+		m0_sm_group_lock(grp);
+		m0_sm_ast_cancel(grp, &w->sw_ast);
+		m0_sm_group_unlock(grp);
+	}
+	for (i = 0; i < ARRAY_SIZE(w->sw_slot); ++i)
+		sm_timer_tlist_fini(&w->sw_slot[i]);
+	m0_free(w);
+	grp->s_wheel = NULL;
+}
+
 static void timer_done(struct m0_sm_timer *timer)
 {
 	M0_ASSERT(timer->tr_state == ARMED);
 
 	timer->tr_state = DONE;
-	m0_timer_stop(&timer->tr_timer);
+	if (sm_timer_tlink_is_in(timer))
+		sm_wheel_del(timer->tr_grp->s_wheel, timer);
 }
 
 /**
@@ -557,6 +807,7 @@ M0_INTERNAL void m0_sm_timer_init(struct m0_sm_timer *timer)
 	M0_SET0(timer);
 	timer->tr_state     = INIT;
 	timer->tr_ast.sa_cb = sm_timer_bottom;
+	sm_timer_tlink_init(timer);
 }
 
 M0_INTERNAL void m0_sm_timer_fini(struct m0_sm_timer *timer)
@@ -564,10 +815,7 @@ M0_INTERNAL void m0_sm_timer_fini(struct m0_sm_timer *timer)
 	M0_PRE(M0_IN(timer->tr_state, (INIT, DONE)));
 	M0_PRE(timer->tr_ast.sa_next == NULL);
 
-	if (timer->tr_state == DONE) {
-		M0_ASSERT(!m0_timer_is_started(&timer->tr_timer));
-		m0_timer_fini(&timer->tr_timer);
-	}
+	sm_timer_tlink_fini(timer);
 }
 
 M0_INTERNAL int m0_sm_timer_start(struct m0_sm_timer *timer,
@@ -575,7 +823,8 @@ M0_INTERNAL int m0_sm_timer_start(struct m0_sm_timer *timer,
 				  void (*cb)(struct m0_sm_timer *),
 				  m0_time_t deadline)
 {
-	int result;
+	struct m0_sm_wheel *w;
+	int                 result;
 
 	M0_PRE(grp_is_locked(group));
 	M0_PRE(timer->tr_state == INIT);
@@ -584,23 +833,34 @@ M0_INTERNAL int m0_sm_timer_start(struct m0_sm_timer *timer,
 	/*
 	 * This is how timer is implemented:
 	 *
-	 *    - a timer is armed (with sm_timer_top() call-back);
+	 *    - the timer is added to the group timer wheel;
 	 *
-	 *    - when the timer fires off, an AST to the state machine group is
-	 *      posted from the timer call-back;
+	 *    - when the wheel reaches the deadline, an AST to the state
+	 *      machine group is posted;
 	 *
 	 *    - the AST invokes user-supplied call-back.
 	 */
-
-	result = m0_timer_init(&timer->tr_timer, M0_TIMER_HARD, NULL,
-			       sm_timer_top, (unsigned long)timer);
-	if (result == 0) {
-		timer->tr_state = ARMED;
-		timer->tr_grp   = group;
-		timer->tr_cb    = cb;
-		m0_timer_start(&timer->tr_timer, deadline);
+	if (group->s_wheel == NULL) {
+		result = sm_wheel_init(group);
+		if (result != 0)
+			return result;
 	}
-	return result;
+	w = group->s_wheel;
+	timer->tr_state  = ARMED;
+	timer->tr_grp    = group;
+	timer->tr_cb     = cb;
+	timer->tr_expire = sm_wheel_tick(deadline);
+	/* Don't let an idle wheel lag behind, see sm_wheel_insert(). */
+	if (sm_wheel_is_empty(w))
+		w->sw_now = max64u(w->sw_now,
+				   m0_time_now() >> SM_WHEEL_TICK_SHIFT);
+	if (timer->tr_expire <= w->sw_now) {
+		m0_sm_ast_post(group, &timer->tr_ast);
+	} else {
+		sm_wheel_insert(w, timer);
+		sm_wheel_arm(w);
+	}
+	return 0;
 }
 
 M0_INTERNAL void m0_sm_timer_cancel(struct m0_sm_timer *timer)
@@ -611,10 +871,9 @@ M0_INTERNAL void m0_sm_timer_cancel(struct m0_sm_timer *timer)
 	if (timer->tr_state == ARMED) {
 		timer_done(timer);
 		/*
-		 * Once timer_done() returned, the timer call-back
-		 * (sm_timer_top()) is guaranteed to be never executed, so the
-		 * ast won't be posted. Hence, it is safe to remove it, if it
-		 * is here.
+		 * Once timer_done() returned, the timer is not in the wheel and
+		 * its ast won't be posted. Hence, it is safe to remove it, if
+		 * it is here.
 		 */
 		m0_sm_ast_cancel(timer->tr_grp, &timer->tr_ast);
 	}
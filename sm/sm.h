@@ -276,6 +276,7 @@ struct m0_sm_ast;
 struct m0_sm_addb2_stats;
 struct m0_sm_group_addb2;
 struct m0_sm_ast_wait;
+struct m0_sm_wheel;
 
 /* import */
 struct m0_timer;
@@ -517,6 +518,11 @@ struct m0_sm_group {
 	struct m0_sm_ast         *s_forkq;
 	struct m0_chan            s_chan;
 	struct m0_sm_group_addb2 *s_addb2;
+	/**
+	 * Timer wheel of the group's m0_sm_timer-s. Allocated by the first
+	 * m0_sm_timer_start().
+	 */
+	struct m0_sm_wheel       *s_wheel;
 };
 
 /**
@@ -607,10 +613,13 @@ M0_INTERNAL const char *m0_sm_conf_state_name(const struct m0_sm_conf *conf,
  *
  * A state machine timer is associated with a state machine group and executes
  * a specified call-back after a specified deadline and under the group lock.
+ *
+ * Timers of a group are kept in a hierarchical timer wheel (see sm.c), which
+ * uses a single m0_timer for all of them. Starting and cancelling a timer
+ * doesn't make system calls, unless the timer is the earliest one.
  */
 struct m0_sm_timer {
 	struct m0_sm_group *tr_grp;
-	struct m0_timer     tr_timer;
 	struct m0_sm_ast    tr_ast;
 	/** Call-back to be executed after timer expiration. */
 	void              (*tr_cb)(struct m0_sm_timer *);
@@ -618,6 +627,13 @@ struct m0_sm_timer {
 	 * Timer state from enum timer_state (sm.c).
 	 */
 	int                 tr_state;
+	/** Deadline, in ticks of the timer wheel. */
+	uint64_t            tr_expire;
+	/** Slot of the timer wheel the timer is in. */
+	uint32_t            tr_slot;
+	/** Linkage to the timer wheel slot. */
+	struct m0_tlink     tr_linkage;
+	uint64_t            tr_magic;
 };
 
 M0_INTERNAL void m0_sm_timer_init(struct m0_sm_timer *timer);
@@ -354,6 +354,86 @@ static void timeout(void)
 	m0_sm_group_unlock(&G);
 }
 
+enum { WHEEL_TIMER_NR = 64 };
+
+struct wheel_timer {
+	struct m0_sm_timer wt_timer;
+	m0_time_t          wt_deadline;
+	bool               wt_fired;
+};
+
+static struct wheel_timer wheel_timers[WHEEL_TIMER_NR];
+static int                wheel_fired;
+
+static void wheel_timer_cb(struct m0_sm_timer *timer)
+{
+	struct wheel_timer *wt = container_of(timer, struct wheel_timer,
+					      wt_timer);
+
+	M0_UT_ASSERT(!wt->wt_fired);
+	M0_UT_ASSERT(m0_time_now() >= wt->wt_deadline);
+	wt->wt_fired = true;
+	++wheel_fired;
+}
+
+/**
+   Unit test for the group timer wheel.
+
+   Starts timers with deadlines from the past to hours ahead, so that all
+   levels of the wheel are used, and cancels some of them. Checks that timers
+   fire no earlier than their deadlines and that cancelled timers don't fire.
+ */
+static void timer_wheel(void)
+{
+	struct m0_sm_group  grp;
+	struct wheel_timer *wt;
+	m0_time_t           now = m0_time_now();
+	int                 expected = 0;
+	int                 result;
+	int                 i;
+
+	m0_sm_group_init(&grp);
+	wheel_fired = 0;
+	m0_sm_group_lock(&grp);
+	for (i = 0; i < WHEEL_TIMER_NR; ++i) {
+		wt = &wheel_timers[i];
+		M0_SET0(wt);
+		if (i == 0)
+			wt->wt_deadline = now - M0_TIME_ONE_MSEC;
+		else if (i == 1)
+			wt->wt_deadline = M0_TIME_NEVER;
+		else if (i % 2 == 1)
+			wt->wt_deadline = now + ((m0_time_t)M0_TIME_ONE_SECOND <<
+						 (i / 2));
+		else
+			wt->wt_deadline = now + i * M0_TIME_ONE_MSEC;
+		m0_sm_timer_init(&wt->wt_timer);
+		result = m0_sm_timer_start(&wt->wt_timer, &grp, wheel_timer_cb,
+					   wt->wt_deadline);
+		M0_UT_ASSERT(result == 0);
+		if (i % 4 == 2)
+			m0_sm_timer_cancel(&wt->wt_timer);
+		else if (i % 2 == 0)
+			++expected;
+	}
+	while (wheel_fired < expected) {
+		m0_sm_group_unlock(&grp);
+		m0_chan_timedwait(&grp.s_clink,
+				  m0_time_from_now(0, M0_TIME_ONE_MSEC));
+		m0_sm_group_lock(&grp);
+		M0_UT_ASSERT(m0_time_now() < m0_time_add(now,
+					m0_time(10, 0)));
+	}
+	for (i = 0; i < WHEEL_TIMER_NR; ++i) {
+		wt = &wheel_timers[i];
+		M0_UT_ASSERT(wt->wt_fired == (i % 4 == 0));
+		m0_sm_timer_cancel(&wt->wt_timer);
+		m0_sm_timer_fini(&wt->wt_timer);
+	}
+	m0_sm_group_unlock(&grp);
+	m0_sm_group_fini(&grp);
+}
+
 struct story {
 	struct m0_sm cain;
 	struct m0_sm abel;
@@ -648,6 +728,7 @@ struct m0_ut_suite sm_ut = {
 		{ "transition", transition },
 		{ "ast",        ast_test },
 		{ "timeout",    timeout },
+		{ "timer-wheel", timer_wheel },
 		{ "group",      group },
 		{ "chain",      chain },
 		{ "wait",       ast_wait },
@@ -656,6 +737,122 @@ struct m0_ut_suite sm_ut = {
 };
 M0_EXPORTED(sm_ut);
 
+enum { SM_UB_TIMER_NR = 10000 };
+
+static struct m0_sm_group sm_ub_grp;
+static struct m0_sm_timer sm_ub_timers[SM_UB_TIMER_NR];
+static m0_time_t          sm_ub_now;
+
+static void sm_ub_timer_cb(struct m0_sm_timer *timer)
+{
+	M0_IMPOSSIBLE("Benchmark timers are cancelled before they expire.");
+}
+
+static int sm_ub_init(const char *opts)
+{
+	m0_sm_group_init(&sm_ub_grp);
+	return 0;
+}
+
+static void sm_ub_fini(void)
+{
+	m0_sm_group_fini(&sm_ub_grp);
+}
+
+/** Deadlines are spread from 1 second to 11 seconds ahead. */
+static void sm_ub_start(int i)
+{
+	int result;
+
+	result = m0_sm_timer_start(&sm_ub_timers[i], &sm_ub_grp,
+				   &sm_ub_timer_cb, sm_ub_now +
+				   M0_TIME_ONE_SECOND + i * M0_TIME_ONE_MSEC);
+	M0_UT_ASSERT(result == 0);
+}
+
+static void sm_ub_cancel(int i)
+{
+	m0_sm_timer_cancel(&sm_ub_timers[i]);
+}
+
+static void sm_ub_start_cancel(int i)
+{
+	sm_ub_start(i);
+	sm_ub_cancel(i);
+}
+
+static void sm_ub_init_all(void)
+{
+	int i;
+
+	m0_sm_group_lock(&sm_ub_grp);
+	sm_ub_now = m0_time_now();
+	for (i = 0; i < SM_UB_TIMER_NR; ++i)
+		m0_sm_timer_init(&sm_ub_timers[i]);
+}
+
+static void sm_ub_init_start_all(void)
+{
+	int i;
+
+	sm_ub_init_all();
+	for (i = 0; i < SM_UB_TIMER_NR; ++i)
+		sm_ub_start(i);
+}
+
+static void sm_ub_fini_all(void)
+{
+	int i;
+
+	for (i = 0; i < SM_UB_TIMER_NR; ++i)
+		m0_sm_timer_fini(&sm_ub_timers[i]);
+	m0_sm_group_unlock(&sm_ub_grp);
+}
+
+static void sm_ub_cancel_fini_all(void)
+{
+	int i;
+
+	for (i = 0; i < SM_UB_TIMER_NR; ++i)
+		sm_ub_cancel(i);
+	sm_ub_fini_all();
+}
+
+/*
+ * Cost of starting and cancelling m0_sm_timers of a single group, with up to
+ * SM_UB_TIMER_NR timers armed at a time:
+ *
+ * init-<start>-cancel-fini
+ * init-start-<cancel>-fini
+ * init-<start-cancel>-fini
+ */
+const struct m0_ub_set m0_sm_timer_ub = {
+	.us_name = "sm-timer-ub",
+	.us_init = sm_ub_init,
+	.us_fini = sm_ub_fini,
+	.us_run  = {
+		{ .ub_name  = "init-<start>-cancel-fini",
+		  .ub_iter  = SM_UB_TIMER_NR,
+		  .ub_init  = sm_ub_init_all,
+		  .ub_round = sm_ub_start,
+		  .ub_fini  = sm_ub_cancel_fini_all },
+
+		{ .ub_name  = "init-start-<cancel>-fini",
+		  .ub_iter  = SM_UB_TIMER_NR,
+		  .ub_init  = sm_ub_init_start_all,
+		  .ub_round = sm_ub_cancel,
+		  .ub_fini  = sm_ub_fini_all },
+
+		{ .ub_name  = "init-<start-cancel>-fini",
+		  .ub_iter  = SM_UB_TIMER_NR,
+		  .ub_init  = sm_ub_init_all,
+		  .ub_round = sm_ub_start_cancel,
+		  .ub_fini  = sm_ub_fini_all },
+
+		{ .ub_name = NULL }
+	}
+};
+
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
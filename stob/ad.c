@@ -394,6 +394,11 @@ static int stob_ad_domain_init(struct m0_stob_type *type,
 	M0_ALLOC_PTR(dom);
 	if (dom == NULL)
 		return M0_ERR(-ENOMEM);
+	/*
+	 * sad_bstore, sad_be_seg, sad_babshift and sad_magix are set here and
+	 * never captured, keep the domain resident.
+	 */
+	m0_be_seg_pin(seg, adom, sizeof *adom);
 
 	m0_stob_domain__dom_id_make(&dom->sd_id,
 				    m0_stob_type_id_get(type),
@@ -421,6 +426,7 @@ static int stob_ad_domain_init(struct m0_stob_type *type,
 		if (balloc_inited)
 			ballroom->ab_ops->bo_fini(ballroom);
 		m0_be_emap_fini(&adom->sad_adata);
+		m0_be_seg_unpin(seg, adom, sizeof *adom);
 		m0_free(dom);
 	} else {
 		m0_stob_ad_domain_bob_init(adom);
@@ -447,6 +453,7 @@ static void stob_ad_domain_fini(struct m0_stob_domain *dom)
 	m0_be_emap_fini(&adom->sad_adata);
 	m0_stob_put(adom->sad_bstore);
 	m0_stob_ad_domain_bob_fini(adom);
+	m0_be_seg_unpin(adom->sad_be_seg, adom, sizeof *adom);
 	m0_free(dom);
 }
 
@@ -613,19 +620,195 @@ static int stob_ad_domain_destroy(struct m0_stob_type *type,
 	return M0_RC(rc);
 }
 
+/**
+ * @name Extent cache
+ *
+ * @see m0_stob_ad_ecache
+ *
+ * @{
+ */
+
+static struct m0_stob_ad_ecache *stob_ad_ecache(struct m0_stob *stob)
+{
+	return &stob_ad_stob2ad(stob)->ad_ecache;
+}
+
+/** Returns the index of the first cached segment ending after off. */
+static uint32_t ecache_find(const struct m0_stob_ad_ecache *ec,
+			    m0_bindex_t off)
+{
+	uint32_t lo = 0;
+	uint32_t hi = ec->ec_nr;
+	uint32_t mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (ec->ec_segs[mid].es_ext.e_end <= off)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/** Returns the cached segment containing off, or NULL. */
+static struct stob_ad_ecache_seg *ecache_lookup(struct m0_stob_ad_ecache *ec,
+						m0_bindex_t off)
+{
+	struct stob_ad_ecache_seg *es;
+	uint32_t                   i = ecache_find(ec, off);
+
+	if (i == ec->ec_nr)
+		return NULL;
+	es = &ec->ec_segs[i];
+	if (!m0_ext_is_in(&es->es_ext, off))
+		return NULL;
+	es->es_used = ++ec->ec_clock;
+	return es;
+}
+
+static void ecache_remove(struct m0_stob_ad_ecache *ec, uint32_t from,
+			  uint32_t to)
+{
+	M0_PRE(from <= to && to <= ec->ec_nr);
+	memmove(&ec->ec_segs[from], &ec->ec_segs[to],
+		(ec->ec_nr - to) * sizeof ec->ec_segs[0]);
+	ec->ec_nr -= to - from;
+}
+
+/** Drops all cached segments overlapping ext. */
+static void ecache_cut(struct m0_stob_ad_ecache *ec, const struct m0_ext *ext)
+{
+	uint32_t i = ecache_find(ec, ext->e_start);
+	uint32_t j;
+
+	for (j = i; j < ec->ec_nr &&
+		    ec->ec_segs[j].es_ext.e_start < ext->e_end; ++j)
+		;
+	ecache_remove(ec, i, j);
+}
+
+static void ecache_insert(struct m0_stob_ad_ecache *ec,
+			  const struct m0_ext *ext, uint64_t val)
+{
+	uint32_t lru;
+	uint32_t i;
+
+	M0_PRE(val < AET_MIN || val == AET_HOLE);
+
+	ecache_cut(ec, ext);
+	if (ec->ec_nr == ARRAY_SIZE(ec->ec_segs)) {
+		for (lru = 0, i = 1; i < ec->ec_nr; ++i) {
+			if (ec->ec_segs[i].es_used < ec->ec_segs[lru].es_used)
+				lru = i;
+		}
+		ecache_remove(ec, lru, lru + 1);
+	}
+	i = ecache_find(ec, ext->e_start);
+	memmove(&ec->ec_segs[i + 1], &ec->ec_segs[i],
+		(ec->ec_nr - i) * sizeof ec->ec_segs[0]);
+	ec->ec_segs[i] = (struct stob_ad_ecache_seg) {
+		.es_ext  = *ext,
+		.es_val  = val,
+		.es_used = ++ec->ec_clock
+	};
+	ec->ec_nr++;
+}
+
+/**
+ * Returns the current generation of the cache, to be sampled before the
+ * extent map is accessed.
+ */
+static uint64_t stob_ad_ecache_gen(struct m0_stob *stob)
+{
+	struct m0_stob_ad_ecache *ec = stob_ad_ecache(stob);
+	uint64_t                  gen;
+
+	m0_mutex_lock(&ec->ec_lock);
+	gen = ec->ec_gen;
+	m0_mutex_unlock(&ec->ec_lock);
+	return gen;
+}
+
+/** Caches a segment looked up in the extent map. */
+static void stob_ad_ecache_add(struct m0_stob *stob, uint64_t gen,
+			       const struct m0_be_emap_seg *seg)
+{
+	struct m0_stob_ad_ecache *ec = stob_ad_ecache(stob);
+
+	if (seg->ee_val >= AET_MIN && seg->ee_val != AET_HOLE)
+		return;
+	m0_mutex_lock(&ec->ec_lock);
+	if (ec->ec_gen == gen)
+		ecache_insert(ec, &seg->ee_ext, seg->ee_val);
+	m0_mutex_unlock(&ec->ec_lock);
+}
+
+/**
+ * Records that ext has been mapped to val in the extent map. If the map could
+ * have been updated by somebody else since gen was sampled, the overlapping
+ * segments are only dropped.
+ */
+static void stob_ad_ecache_update(struct m0_stob *stob, uint64_t gen,
+				  const struct m0_ext *ext, uint64_t val)
+{
+	struct m0_stob_ad_ecache *ec = stob_ad_ecache(stob);
+
+	m0_mutex_lock(&ec->ec_lock);
+	if (ec->ec_gen == gen)
+		ecache_insert(ec, ext, val);
+	else
+		ecache_cut(ec, ext);
+	ec->ec_gen++;
+	m0_mutex_unlock(&ec->ec_lock);
+}
+
+/** Drops all cached segments. */
+static void stob_ad_ecache_drop(struct m0_stob *stob)
+{
+	struct m0_stob_ad_ecache *ec = stob_ad_ecache(stob);
+
+	m0_mutex_lock(&ec->ec_lock);
+	ec->ec_nr = 0;
+	ec->ec_gen++;
+	m0_mutex_unlock(&ec->ec_lock);
+}
+
+M0_INTERNAL void m0_stob_ad_ecache_stats(struct m0_stob *stob,
+					 uint64_t *hits, uint64_t *misses)
+{
+	struct m0_stob_ad_ecache *ec = stob_ad_ecache(stob);
+
+	m0_mutex_lock(&ec->ec_lock);
+	*hits   = ec->ec_hits;
+	*misses = ec->ec_misses;
+	m0_mutex_unlock(&ec->ec_lock);
+}
+
+/** @} end of extent cache */
+
 static struct m0_stob *stob_ad_alloc(struct m0_stob_domain *dom,
 				     const struct m0_fid *stob_fid)
 {
 	struct m0_stob_ad *adstob;
 
 	M0_ALLOC_PTR(adstob);
-	return adstob == NULL ? NULL : &adstob->ad_stob;
+	if (adstob == NULL)
+		return NULL;
+	m0_mutex_init(&adstob->ad_ecache.ec_lock);
+	return &adstob->ad_stob;
 }
 
 static void stob_ad_free(struct m0_stob_domain *dom,
 			 struct m0_stob *stob)
 {
 	struct m0_stob_ad *adstob = stob_ad_stob2ad(stob);
+
+	M0_LOG(M0_DEBUG, FID_F" extent cache: hits=%llu misses=%llu",
+	       FID_P(m0_stob_fid_get(stob)),
+	       (unsigned long long)adstob->ad_ecache.ec_hits,
+	       (unsigned long long)adstob->ad_ecache.ec_misses);
+	m0_mutex_fini(&adstob->ad_ecache.ec_lock);
 	m0_free(adstob);
 }
 
@@ -683,6 +866,7 @@ static int stob_ad_create(struct m0_stob *stob,
 	M0_PRE(dtx != NULL);
 	prefix = M0_UINT128(stob_fid->f_container, stob_fid->f_key);
 	M0_LOG(M0_DEBUG, U128X_F, U128_P(&prefix));
+	stob_ad_ecache_drop(stob);
 	return M0_BE_OP_SYNC_RET(op,
 				 m0_be_emap_obj_insert(&adom->sad_adata,
 						       &dtx->tx_betx, &op,
@@ -788,9 +972,11 @@ static int ext_punch(struct m0_stob *stob, struct m0_dtx *tx,
 	struct m0_be_emap_cursor  it = {};
 	struct m0_be_op          *it_op;
 	struct m0_ext            *ext;
+	uint64_t                  gen;
 	int                       rc;
 
 	adom = stob_ad_domain2ad(m0_stob_dom_get(stob));
+	gen  = stob_ad_ecache_gen(stob);
 	rc = stob_ad_cursor(adom, stob, todo->e_start, &it);
 	if (rc != 0)
 		return M0_ERR(rc);
@@ -852,6 +1038,10 @@ static int ext_punch(struct m0_stob *stob, struct m0_dtx *tx,
 	M0_ASSERT(m0_be_op_is_done(it_op));
 	rc = m0_be_emap_op_rc(&it);
 	m0_be_op_fini(it_op);
+	if (rc == 0)
+		stob_ad_ecache_update(stob, gen, todo, AET_HOLE);
+	else
+		stob_ad_ecache_drop(stob);
 	return M0_RC(rc);
 }
 
@@ -873,6 +1063,7 @@ static int stob_ad_destroy(struct m0_stob *stob, struct m0_dtx *tx)
 
 	adom   = stob_ad_domain2ad(m0_stob_dom_get(stob));
 	prefix = M0_UINT128(fid->f_container, fid->f_key);
+	stob_ad_ecache_drop(stob);
 	rc = M0_BE_OP_SYNC_RET(op,
 			       m0_be_emap_obj_delete(&adom->sad_adata,
 						     &tx->tx_betx, &op,
@@ -1244,17 +1435,22 @@ static int stob_ad_vec_alloc(struct m0_stob *obj,
  * @note memset() could become a bottleneck here.
  *
  * @note cursors and fragment sizes are measured in blocks.
+ *
+ * Segments visited by the first pass are added to the extent cache, unless
+ * its generation changed from gen.
  */
 static int stob_ad_read_prepare(struct m0_stob_io        *io,
 				struct m0_stob_ad_domain *adom,
 				struct m0_vec_cursor     *src,
 				struct m0_vec_cursor     *dst,
-				struct m0_be_emap_caret  *car)
+				struct m0_be_emap_caret  *car,
+				uint64_t                  gen)
 {
 	struct m0_be_emap_cursor *it;
 	struct m0_be_emap_seg    *seg;
 	struct m0_stob_io        *back;
 	struct m0_stob_ad_io     *aio = io->si_stob_private;
+	struct m0_ext             cached = {};
 	uint32_t                  frags;
 	uint32_t                  frags_not_empty;
 	uint32_t                  bshift;
@@ -1308,6 +1504,10 @@ static int stob_ad_read_prepare(struct m0_stob_io        *io,
 			return M0_RC(eomap);
 		M0_ASSERT(eomap == 0);
 		M0_ASSERT(m0_ext_is_in(&seg->ee_ext, off));
+		if (!m0_ext_equal(&seg->ee_ext, &cached)) {
+			stob_ad_ecache_add(io->si_obj, gen, seg);
+			cached = seg->ee_ext;
+		}
 
 		frag_size = min3(m0_vec_cursor_step(src),
 				 m0_vec_cursor_step(dst),
@@ -1399,6 +1599,104 @@ static int stob_ad_read_prepare(struct m0_stob_io        *io,
 	return M0_RC(rc);
 }
 
+/**
+ * Constructs back IO for read from the extent cache, in the same two passes
+ * as stob_ad_read_prepare(), without looking the extent map up.
+ *
+ * Returns -ENOENT, having constructed nothing, if some part of the IO is not
+ * covered by the cache. In this case *gen is the generation of the cache to be
+ * passed to stob_ad_read_prepare().
+ */
+static int stob_ad_read_prepare_cached(struct m0_stob_io        *io,
+				       struct m0_stob_ad_domain *adom,
+				       uint64_t                 *gen)
+{
+	struct m0_stob_ad_ecache  *ec   = stob_ad_ecache(io->si_obj);
+	struct m0_stob_ad_io      *aio  = io->si_stob_private;
+	struct m0_stob_io         *back = &aio->ai_back;
+	struct stob_ad_ecache_seg *es;
+	struct m0_vec_cursor       src;
+	struct m0_vec_cursor       dst;
+	uint32_t                   frags;
+	uint32_t                   frags_not_empty;
+	uint32_t                   bshift;
+	uint32_t                   idx;
+	uint32_t                   i;
+	m0_bcount_t                frag_size; /* measured in blocks */
+	m0_bindex_t                off;       /* measured in blocks */
+	void                      *buf;
+	bool                       eosrc;
+	int                        rc;
+
+	M0_PRE(io->si_opcode == SIO_READ);
+
+	bshift = m0_stob_block_shift(adom->sad_bstore);
+	m0_mutex_lock(&ec->ec_lock);
+	m0_vec_cursor_init(&src, &io->si_user.ov_vec);
+	m0_vec_cursor_init(&dst, &io->si_stob.iv_vec);
+	frags = frags_not_empty = 0;
+	do {
+		off = io->si_stob.iv_index[dst.vc_seg] + dst.vc_offset;
+		es  = ecache_lookup(ec, off);
+		if (es == NULL)
+			break;
+		frag_size = min3(m0_vec_cursor_step(&src),
+				 m0_vec_cursor_step(&dst),
+				 es->es_ext.e_end - off);
+		frags++;
+		if (es->es_val < AET_MIN)
+			frags_not_empty++;
+		eosrc = m0_vec_cursor_move(&src, frag_size);
+		m0_vec_cursor_move(&dst, frag_size);
+	} while (!eosrc);
+
+	if (es == NULL) {
+		ec->ec_misses++;
+		*gen = ec->ec_gen;
+		m0_mutex_unlock(&ec->ec_lock);
+		return -ENOENT;
+	}
+	ec->ec_hits++;
+
+	rc = stob_ad_vec_alloc(io->si_obj, back, frags_not_empty);
+	if (rc != 0) {
+		m0_mutex_unlock(&ec->ec_lock);
+		return M0_RC(rc);
+	}
+
+	m0_vec_cursor_init(&src, &io->si_user.ov_vec);
+	m0_vec_cursor_init(&dst, &io->si_stob.iv_vec);
+	for (idx = i = 0; i < frags; ++i) {
+		buf = io->si_user.ov_buf[src.vc_seg] + src.vc_offset;
+		off = io->si_stob.iv_index[dst.vc_seg] + dst.vc_offset;
+		es  = ecache_lookup(ec, off);
+		M0_ASSERT(es != NULL);
+		frag_size = min3(m0_vec_cursor_step(&src),
+				 m0_vec_cursor_step(&dst),
+				 es->es_ext.e_end - off);
+		if (es->es_val == AET_HOLE) {
+			if (io->si_flags & SIF_NOHOLE) {
+				rc = M0_ERR(-EIO);
+				break;
+			}
+			memset(stob_ad_addr_open(buf, bshift),
+			       0, frag_size << bshift);
+			io->si_count += frag_size;
+		} else {
+			back->si_user.ov_vec.v_count[idx] = frag_size;
+			back->si_user.ov_buf[idx] = buf;
+			back->si_stob.iv_index[idx] = es->es_val +
+				(off - es->es_ext.e_start);
+			idx++;
+		}
+		m0_vec_cursor_move(&src, frag_size);
+		m0_vec_cursor_move(&dst, frag_size);
+	}
+	m0_mutex_unlock(&ec->ec_lock);
+	M0_ASSERT(ergo(rc == 0, idx == frags_not_empty));
+	return M0_RC(rc);
+}
+
 /**
    A linked list of allocated extents.
  */
@@ -1564,11 +1862,13 @@ static int stob_ad_write_map_ext(struct m0_stob_io *io,
 		.e_start = off,
 		.e_end   = off + m0_ext_length(ext)
 	};
+	uint64_t               gen;
 	m0_ext_init(&todo);
 
 	M0_ENTRY("ext="EXT_F" val=0x%llx", EXT_P(&todo),
 		 (unsigned long long)ext->e_start);
 
+	gen = stob_ad_ecache_gen(io->si_obj);
 	result = M0_BE_OP_SYNC_RET_WITH(
 			&it.ec_op,
 			m0_be_emap_lookup(orig->ec_map, &orig->ec_seg.ee_pre,
@@ -1640,6 +1940,10 @@ static int stob_ad_write_map_ext(struct m0_stob_io *io,
 	result = it.ec_op.bo_u.u_emap.e_rc;
 	m0_be_op_fini(&it.ec_op);
 	m0_be_emap_close(&it);
+	if (result == 0 && rc == 0)
+		stob_ad_ecache_update(io->si_obj, gen, &todo, ext->e_start);
+	else
+		stob_ad_ecache_drop(io->si_obj);
 
 	return M0_RC(result ?: rc);
 }
@@ -1881,6 +2185,7 @@ static int stob_ad_io_launch_prepare(struct m0_stob_io *io)
 	struct m0_stob_ad_domain *adom;
 	struct m0_stob_ad_io     *aio  = io->si_stob_private;
 	struct m0_stob_io        *back = &aio->ai_back;
+	uint64_t                  gen = 0;
 	int                       rc;
 
 	M0_PRE(io->si_stob.iv_vec.v_nr > 0);
@@ -1897,18 +2202,23 @@ static int stob_ad_io_launch_prepare(struct m0_stob_io *io)
 
 	M0_ADDB2_ADD(M0_AVI_STOB_IO_REQ, io->si_id, M0_AVI_AD_PREPARE);
 	adom = stob_ad_domain2ad(m0_stob_dom_get(io->si_obj));
-	rc = stob_ad_cursors_init(io, adom, &it, &src, &dst, &map);
-	if (rc != 0)
-		return M0_RC(rc);
-
 	back->si_opcode   = io->si_opcode;
 	back->si_flags    = io->si_flags;
 	back->si_fol_frag = io->si_fol_frag;
 	back->si_id       = io->si_id;
 
+	if (io->si_opcode == SIO_READ) {
+		rc = stob_ad_read_prepare_cached(io, adom, &gen);
+		if (rc != -ENOENT)
+			return M0_RC(rc);
+	}
+	rc = stob_ad_cursors_init(io, adom, &it, &src, &dst, &map);
+	if (rc != 0)
+		return M0_RC(rc);
+
 	switch (io->si_opcode) {
 	case SIO_READ:
-		rc = stob_ad_read_prepare(io, adom, &src, &dst, &map);
+		rc = stob_ad_read_prepare(io, adom, &src, &dst, &map, gen);
 		break;
 	case SIO_WRITE:
 		rc = stob_ad_write_prepare(io, adom, &src, &map);
@@ -2034,6 +2344,7 @@ static int stob_ad_rec_frag_undo_redo_op(struct m0_fol_frag *frag,
 	struct m0_stob_ad_domain *adom = stob_ad_domain2ad(dom);
 	struct m0_be_emap_seg    *old_data = arp->arp_seg.ps_old_data;
 	struct m0_be_emap_cursor  it;
+	struct m0_stob           *stob;
 	int		          i;
 	int		          rc = 0;
 
@@ -2060,6 +2371,11 @@ static int stob_ad_rec_frag_undo_redo_op(struct m0_fol_frag *frag,
 			m0_be_emap_close(&it);
 		}
 	}
+	/* The extent map was changed behind the back of the extent cache. */
+	if (m0_stob_lookup_by_key(dom, &arp->arp_stob_id.si_fid, &stob) == 0) {
+		stob_ad_ecache_drop(stob);
+		m0_stob_put(stob);
+	}
 	return M0_RC(rc);
 }
 
@@ -27,6 +27,7 @@
 
 #include "be/extmap.h"		/* m0_be_emap */
 #include "fid/fid.h"		/* m0_fid */
+#include "lib/mutex.h"		/* m0_mutex */
 #include "lib/types.h"		/* m0_bcount_t */
 #include "stob/domain.h"	/* m0_stob_domain */
 #include "stob/io.h"		/* m0_stob_io */
@@ -190,8 +191,51 @@ enum stob_ad_allocation_extent_type {
 	AET_HOLE
 };
 
+enum {
+	/** Maximal number of extent map segments cached per AD stob. */
+	STOB_AD_ECACHE_NR = 32,
+};
+
+/** Extent map segment cached in memory. */
+struct stob_ad_ecache_seg {
+	/** Extent in AD stob name-space. */
+	struct m0_ext es_ext;
+	/** Start of the extent in the underlying stob or AET_HOLE. */
+	uint64_t      es_val;
+	/** Value of m0_stob_ad_ecache::ec_clock at the last use. */
+	uint64_t      es_used;
+};
+
+/**
+   Bounded in-memory cache of extent map segments of an AD stob.
+
+   Segments are sorted by offset and do not overlap. They are added from
+   extent map lookups made by reads and from extent map updates made by
+   writes and punches; every update drops the cached segments it overlaps.
+   When the cache is full, the least recently used segment is evicted.
+
+   A read mapped entirely by cached segments takes only ec_lock and does not
+   open an extent map cursor.
+
+   ec_gen is incremented by every update. A segment is added only if ec_gen
+   did not change since before the extent map was accessed, so that a segment
+   replaced concurrently is never cached.
+ */
+struct m0_stob_ad_ecache {
+	struct m0_mutex           ec_lock;
+	uint32_t                  ec_nr;
+	uint64_t                  ec_gen;
+	uint64_t                  ec_clock;
+	/** Number of reads mapped by the cache. */
+	uint64_t                  ec_hits;
+	/** Number of reads which had to look the extent map up. */
+	uint64_t                  ec_misses;
+	struct stob_ad_ecache_seg ec_segs[STOB_AD_ECACHE_NR];
+};
+
 struct m0_stob_ad {
-	struct m0_stob          ad_stob;
+	struct m0_stob           ad_stob;
+	struct m0_stob_ad_ecache ad_ecache;
 };
 
 struct m0_stob_ad_io {
@@ -239,6 +283,13 @@ M0_INTERNAL void m0_stob_ad_balloc_clear(struct m0_stob_io *io);
  */
 M0_INTERNAL m0_bcount_t m0_stob_ad_spares_calc(m0_bcount_t grp);
 
+/**
+ * Returns numbers of reads of an AD stob mapped by its extent cache (hits)
+ * and mapped by the extent map (misses).
+ */
+M0_INTERNAL void m0_stob_ad_ecache_stats(struct m0_stob *stob,
+					 uint64_t *hits, uint64_t *misses);
+
 /** @} end group stobad */
 
 /* __MOTR_STOB_AD_INTERNAL_H__ */
@@ -340,7 +340,8 @@ static void test_write(int nr, struct m0_dtx *tx)
 	m0_stob_io_fini(&io);
 }
 
-static void test_read(int nr)
+/** Reads nr extents of stob_vc[] blocks, count blocks in total. */
+static void stob_read(int nr, m0_bcount_t count)
 {
 	int rc;
 
@@ -365,7 +366,7 @@ static void test_read(int nr)
 	m0_chan_wait(&clink);
 
 	M0_ASSERT(io.si_rc == 0);
-	M0_ASSERT(io.si_count == (buf_size * nr) >> block_shift);
+	M0_ASSERT(io.si_count == count);
 
 	m0_clink_del_lock(&clink);
 	m0_clink_fini(&clink);
@@ -373,6 +374,11 @@ static void test_read(int nr)
 	m0_stob_io_fini(&io);
 }
 
+static void test_read(int nr)
+{
+	stob_read(nr, (buf_size * nr) >> block_shift);
+}
+
 static void test_punch(int nr)
 {
 	struct m0_sm_group *grp = m0_be_ut_backend_sm_group_lookup(&ut_be);
@@ -493,6 +499,51 @@ static void test_ad(void)
 	}
 }
 
+/**
+   Extent cache test.
+ */
+static void test_ad_ecache(void)
+{
+	uint64_t hits0;
+	uint64_t misses0;
+	uint64_t hits;
+	uint64_t misses;
+	int      i;
+
+	/* Just written extents are cached. */
+	init_vecs();
+	test_write(NR, NULL);
+	m0_stob_ad_ecache_stats(obj_fore, &hits0, &misses0);
+	test_read(NR);
+	m0_stob_ad_ecache_stats(obj_fore, &hits, &misses);
+	M0_UT_ASSERT(hits == hits0 + 1 && misses == misses0);
+	for (i = 0; i < NR; ++i)
+		M0_UT_ASSERT(memcmp(user_buf[i], read_buf[i], buf_size) == 0);
+
+	/* Holes are cached after the first lookup. */
+	for (i = 0; i < NR; ++i)
+		stob_vi[i] = (buf_size * (2 * i + 4 * NR)) >> block_shift;
+	test_read(NR);
+	m0_stob_ad_ecache_stats(obj_fore, &hits, &misses);
+	M0_UT_ASSERT(hits == hits0 + 1 && misses == misses0 + 1);
+	test_read(NR);
+	m0_stob_ad_ecache_stats(obj_fore, &hits, &misses);
+	M0_UT_ASSERT(hits == hits0 + 2 && misses == misses0 + 1);
+	for (i = 0; i < NR; ++i)
+		M0_UT_ASSERT(memcmp(zero_buf[i], read_buf[i], buf_size) == 0);
+
+	/* Overwrite replaces cached extents. */
+	for (i = 0; i < NR; ++i)
+		memset(user_buf[i], 'x' + i, buf_size);
+	test_write(NR, NULL);
+	test_read(NR);
+	m0_stob_ad_ecache_stats(obj_fore, &hits, &misses);
+	M0_UT_ASSERT(hits == hits0 + 3 && misses == misses0 + 1);
+	for (i = 0; i < NR; ++i)
+		M0_UT_ASSERT(memcmp(user_buf[i], read_buf[i], buf_size) == 0);
+	init_vecs();
+}
+
 /**
    PUNCH test.
  */
@@ -557,6 +608,7 @@ void m0_stob_ut_adieu_ad(void)
 	rc = test_ad_init(false);
 	M0_ASSERT(rc == 0);
 	test_ad();
+	test_ad_ecache();
 	test_ad_rw_unordered();
 	test_ad_undo();
 	rc = test_ad_fini();
@@ -579,6 +631,20 @@ static void ub_read(int i)
 	test_read(NR - 1);
 }
 
+/** Reads 4K at a random offset within the range written by ub_write(). */
+static void ub_read_random(int i)
+{
+	static uint64_t seed = 42;
+	m0_bcount_t     nob  = max64u(MIN_BUF_SIZE >> block_shift, 1);
+	m0_bcount_t     span = (buf_size * 2 * (NR - 1)) >> block_shift;
+
+	user_vc[0] = stob_vc[0] = nob;
+	stob_vi[0] = m0_rnd(span / nob, &seed) * nob;
+	stob_read(1, nob);
+	user_vc[0] = stob_vc[0] = buf_size >> block_shift;
+	stob_vi[0] = buf_size >> block_shift;
+}
+
 static int ub_init(const char *opts M0_UNUSED)
 {
 	return test_ad_init(false);
@@ -608,6 +674,10 @@ struct m0_ub_set m0_ad_ub = {
 		  .ub_iter = UB_ITER,
 		  .ub_round = ub_read },
 
+		{ .ub_name = "read-random-4k",
+		  .ub_iter = UB_ITER * 10,
+		  .ub_round = ub_read_random },
+
 		{ .ub_name = NULL }
 	}
 };
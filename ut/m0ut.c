@@ -70,6 +70,7 @@ extern struct m0_ut_suite ut_suite_io_pargrp;
 extern struct m0_ut_suite ut_suite_io_req;
 extern struct m0_ut_suite ut_suite_io_req_fop;
 extern struct m0_ut_suite ut_suite_sync;
+extern struct m0_ut_suite ut_suite_cache;
 extern struct m0_ut_suite ut_suite_idx;
 extern struct m0_ut_suite ut_suite_idx_dix;
 extern struct m0_ut_suite ut_suite_mt_idx_dix;
@@ -118,6 +119,7 @@ extern struct m0_ut_suite ha_state_ut;
 extern struct m0_ut_suite ios_bufferpool_ut;
 extern struct m0_ut_suite isc_api_ut;
 extern struct m0_ut_suite isc_service_ut;
+extern struct m0_ut_suite isc_scan_ut;
 extern struct m0_ut_suite item_ut;
 extern struct m0_ut_suite item_source_ut;
 extern struct m0_ut_suite layout_ut;
@@ -129,6 +131,7 @@ extern struct m0_ut_suite m0_net_bulk_mem_ut;
 extern struct m0_ut_suite m0_net_lnet_ut;
 extern struct m0_ut_suite m0_net_misc_ut;
 extern struct m0_ut_suite m0_net_module_ut;
+extern struct m0_ut_suite m0_net_sock_ut;
 extern struct m0_ut_suite m0_net_test_ut;
 extern struct m0_ut_suite m0_net_tm_prov_ut;
 extern struct m0_ut_suite m0d_ut;
@@ -202,6 +205,7 @@ static void tests_add(struct m0_ut_module *m)
 	m0_ut_add(m, &ut_suite_io_req, true);
 	m0_ut_add(m, &ut_suite_io_req_fop, true);
 	m0_ut_add(m, &ut_suite_sync, true);
+	m0_ut_add(m, &ut_suite_cache, true);
 	m0_ut_add(m, &ut_suite_idx, true);
 	m0_ut_add(m, &ut_suite_idx_dix, true);
 	m0_ut_add(m, &ut_suite_mt_idx_dix, true);
@@ -245,6 +249,7 @@ static void tests_add(struct m0_ut_module *m)
 	m0_ut_add(m, &ios_bufferpool_ut, true);
 	m0_ut_add(m, &isc_api_ut, true);
 	m0_ut_add(m, &isc_service_ut, true);
+	m0_ut_add(m, &isc_scan_ut, true);
 	m0_ut_add(m, &item_ut, true);
 	m0_ut_add(m, &item_source_ut, true);
 	m0_ut_add(m, &layout_ut, true);
@@ -256,6 +261,7 @@ static void tests_add(struct m0_ut_module *m)
 	m0_ut_add(m, &m0_net_lnet_ut, true);
 	m0_ut_add(m, &m0_net_misc_ut, true);
 	m0_ut_add(m, &m0_net_module_ut, true);
+	m0_ut_add(m, &m0_net_sock_ut, true);
 	m0_ut_add(m, &m0_net_test_ut, true);
 	m0_ut_add(m, &m0_net_tm_prov_ut, true);
 	m0_ut_add(m, &m0d_ut, true);
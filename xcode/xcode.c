@@ -446,7 +446,7 @@ M0_INTERNAL void *m0_xcode_alloc(struct m0_xcode_cursor *it, size_t nob)
 	return m0_alloc(nob);
 }
 
-static void __xcode_free(struct m0_xcode_cursor *it)
+M0_INTERNAL void m0_xcode_free_default(struct m0_xcode_cursor *it)
 {
 	struct m0_xcode_cursor_frame *top = m0_xcode_cursor_top(it);
 	size_t                        nob = 0;
@@ -479,7 +479,7 @@ M0_INTERNAL void m0_xcode_free(struct m0_xcode_ctx *ctx)
 
 	it = &ctx->xcx_it;
 	if (ctx->xcx_free == NULL)
-		ctx->xcx_free = __xcode_free;
+		ctx->xcx_free = m0_xcode_free_default;
 	while (m0_xcode_next(it) > 0) {
 		struct m0_xcode_cursor_frame *top    = m0_xcode_cursor_top(it);
 		size_t                        nob    = 0;
@@ -766,6 +766,11 @@ M0_INTERNAL int m0_xcode_print(const struct m0_xcode_obj *obj,
 
 M0_INTERNAL void m0_xcode_free_obj(struct m0_xcode_obj *obj);
 M0_INTERNAL void m0_xcode_free(struct m0_xcode_ctx *ctx);
+/**
+ * Default m0_xcode_ctx::xcx_free(), freeing the (sub-)object the cursor is at
+ * with m0_free(). Custom xcx_free() implementations can fall back to it.
+ */
+M0_INTERNAL void m0_xcode_free_default(struct m0_xcode_cursor *it);
 M0_INTERNAL int m0_xcode_cmp(const struct m0_xcode_obj *o0,
 			     const struct m0_xcode_obj *o1);
 M0_INTERNAL int m0_xcode_dup(struct m0_xcode_ctx *dest,